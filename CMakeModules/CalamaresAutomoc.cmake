@@ -30,6 +30,10 @@
 #
 #   If the global variable CALAMARES_AUTORCC_OPTIONS is set, adds that
 #   to the options passed to rcc for each of the named rcfiles.
+#
+#   If the Qt Quick Compiler is available (and QML is enabled), the named
+#   rcfiles are compiled with it instead, so that the QML files in them
+#   are compiled at build-time rather than parsed when they are loaded.
 
 function(calamares_automoc TARGET)
     set_target_properties( ${TARGET} PROPERTIES AUTOMOC TRUE )
@@ -49,6 +53,12 @@ endfunction()
 
 function(calamares_autorcc TARGET)
     set_target_properties( ${TARGET} PROPERTIES AUTORCC TRUE )
+    if ( WITH_QML AND Qt5QuickCompiler_FOUND AND ARGN )
+        set_source_files_properties( ${ARGN} PROPERTIES SKIP_AUTORCC TRUE )
+        qtquick_compiler_add_resources( _compiled_rcc ${ARGN} OPTIONS ${CALAMARES_AUTORCC_OPTIONS} )
+        target_sources( ${TARGET} PRIVATE ${_compiled_rcc} )
+        return()
+    endif()
     if ( CALAMARES_AUTORCC_OPTIONS )
         foreach(S ${ARGN})
             set_property(SOURCE ${S} PROPERTY AUTORCC_OPTIONS "${CALAMARES_AUTORCC_OPTIONS}")
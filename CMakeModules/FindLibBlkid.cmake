@@ -0,0 +1,50 @@
+# === This file is part of Calamares - <https://calamares.io> ===
+#
+#   SPDX-FileCopyrightText: 2026 agent <agent@local>
+#   SPDX-License-Identifier: BSD-2-Clause
+#
+###
+#
+# Locate libblkid (part of util-linux)
+#   https://github.com/util-linux/util-linux
+#
+# This module defines
+#  LibBlkid_FOUND
+#  LibBlkid_LIBRARIES, where to find the library
+#  LibBlkid_INCLUDE_DIRS, where to find blkid/blkid.h
+#
+find_package(PkgConfig)
+include(FindPackageHandleStandardArgs)
+
+if(PkgConfig_FOUND)
+    pkg_search_module(pc_blkid QUIET blkid)
+else()
+    # It's just possible that the find_path and find_library will
+    # find it **anyway**, so let's pretend it was there.
+    set(pc_blkid_FOUND ON)
+endif()
+
+find_path(LibBlkid_INCLUDE_DIR
+    NAMES blkid/blkid.h
+    PATHS ${pc_blkid_INCLUDE_DIRS}
+)
+find_library(LibBlkid_LIBRARY
+    NAMES blkid
+    PATHS ${pc_blkid_LIBRARY_DIRS}
+)
+if(pc_blkid_FOUND)
+    set(LibBlkid_LIBRARIES ${LibBlkid_LIBRARY})
+    set(LibBlkid_INCLUDE_DIRS ${LibBlkid_INCLUDE_DIR})
+endif()
+
+find_package_handle_standard_args(LibBlkid DEFAULT_MSG
+    LibBlkid_INCLUDE_DIRS
+    LibBlkid_LIBRARIES
+)
+mark_as_advanced(LibBlkid_INCLUDE_DIRS LibBlkid_LIBRARIES)
+
+set_package_properties(
+    LibBlkid PROPERTIES
+    DESCRIPTION "Block device identification library"
+    URL "https://github.com/util-linux/util-linux"
+)
@@ -0,0 +1,104 @@
+#! /usr/bin/env python3
+#
+#   SPDX-FileCopyrightText: 2026 agent <agent@local>
+#   SPDX-License-Identifier: BSD-2-Clause
+#
+# Runs a QtTest benchmark executable (e.g. libcalamaresbenchmarks
+# from a build directory configured with -DBUILD_BENCHMARKS=ON), or reads the XML output of an earlier
+# run, and writes the results as JSON:
+#
+#   { "benchYamlToVariant:large": { "metric": "WalltimeMilliseconds",
+#       "value": 1.25, "iterations": 64 }, ... }
+#
+# The value is per iteration. With --baseline, the results are compared
+# with an earlier JSON file, and the exit code is 1 if any benchmark
+# got slower by more than the --tolerance (in percent).
+#
+# This is a Python3 script.
+import argparse
+import json
+import subprocess
+import sys
+import tempfile
+import xml.etree.ElementTree as ET
+
+
+def parse_results(xml_data):
+    """
+    Returns a dictionary of benchmark results from QtTest
+    XML output; the keys are "function" or "function:tag".
+    """
+    results = dict()
+    root = ET.fromstring(xml_data)
+    for function in root.iter("TestFunction"):
+        for result in function.iter("BenchmarkResult"):
+            key = function.get("name")
+            if result.get("tag"):
+                key = key + ":" + result.get("tag")
+            results[key] = {
+                "metric": result.get("metric"),
+                "value": float(result.get("value")),
+                "iterations": int(result.get("iterations")),
+                }
+    return results
+
+
+def compare(results, baseline, tolerance):
+    """
+    Returns a list of messages, one for each benchmark in @p results
+    that is more than @p tolerance percent slower than the @p baseline.
+    """
+    regressions = []
+    for key, result in sorted(results.items()):
+        old = baseline.get(key)
+        if old is None or old["metric"] != result["metric"] or old["value"] <= 0:
+            continue
+        change = 100.0 * (result["value"] - old["value"]) / old["value"]
+        if change > tolerance:
+            regressions.append("{!s} {:.4g} -> {:.4g} {!s} (+{:.1f}%)".format(
+                key, old["value"], result["value"], result["metric"], change))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Calamares benchmarks as JSON")
+    parser.add_argument("source", help="benchmark executable, or XML file with -x")
+    parser.add_argument("-x", "--xml", action="store_true", help="source is XML output, not an executable")
+    parser.add_argument("-o", "--output", help="write JSON here (default stdout)")
+    parser.add_argument("-b", "--baseline", help="earlier JSON results to compare with")
+    parser.add_argument("-t", "--tolerance", type=float, default=10.0, help="allowed slowdown, in percent")
+    args = parser.parse_args()
+
+    if args.xml:
+        with open(args.source, "r") as f:
+            xml_data = f.read()
+    else:
+        # The log goes to stdout as well, so QtTest writes to a file
+        with tempfile.NamedTemporaryFile(suffix=".xml") as f:
+            p = subprocess.run([args.source, "-o", f.name + ",xml"], stdout=subprocess.DEVNULL)
+            if p.returncode != 0:
+                sys.stderr.write("Benchmark {!s} failed ({!s}).\n".format(args.source, p.returncode))
+                return 1
+            xml_data = f.read().decode("utf-8")
+    results = parse_results(xml_data)
+
+    text = json.dumps(results, indent=2, sort_keys=True)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text + "\n")
+    else:
+        print(text)
+
+    if args.baseline:
+        with open(args.baseline, "r") as f:
+            baseline = json.load(f)
+        regressions = compare(results, baseline, args.tolerance)
+        for r in regressions:
+            sys.stderr.write("Slower: " + r + "\n")
+        if regressions:
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
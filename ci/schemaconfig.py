@@ -0,0 +1,238 @@
+#! /usr/bin/env python3
+#
+# SPDX-FileCopyrightText: 2026 agent <agent@local>
+# SPDX-License-Identifier: BSD-2-Clause
+#
+usage = """
+Generates a C++ struct, and a function that fills it in from
+a configuration map, from the schema of a Calamares module.
+
+Usage:
+    schemaconfig.py <schema> <name> [<header>]
+    schemaconfig.py -c <header>
+
+The <schema> is a module's *.schema.yaml, and <name> is the name of
+the generated struct. The header is written to <header>, or to
+stdout if it is not given. With -c, the header is checked against
+the schema it was generated from (the header names the schema and
+struct): exits with value 1 if the header is out of date.
+
+Each property of the schema becomes a member of the struct, with
+the default from the schema; keys like "dbus-symlink" become member
+names like dbusSymlink. For each property there is also a bool
+(e.g. hasDbusSymlink) that is set if the key was in the map with
+a value of the right type. The generated load() reads the map in
+a single pass, and warns about (and returns false for) values of
+the wrong type, unknown keys (if the schema does not allow them)
+and missing required keys.
+
+Dependencies for this tool are: py-yaml.
+"""
+
+import os
+import re
+import sys
+
+import yaml
+
+# From JSON-schema type to C++ type, a check on a QVariant v of that
+# type, and how to get the value of that type out of v.
+types = {
+    "boolean": ("bool", "v.type() == QVariant::Bool", "v.toBool()"),
+    "string": ("QString", "v.type() == QVariant::String", "v.toString()"),
+    "integer": ("qint64",
+                "( v.type() == QVariant::Int || v.type() == QVariant::LongLong )",
+                "v.toLongLong()"),
+    "number": ("double",
+               "( v.type() == QVariant::Int || v.type() == QVariant::LongLong || v.type() == QVariant::Double )",
+               "v.toDouble()"),
+    "object": ("QVariantMap", "v.type() == QVariant::Map", "v.toMap()"),
+    "array": ("QVariantList", "v.type() == QVariant::List", "v.toList()"),
+    "stringlist": ("QStringList", "v.canConvert( QMetaType::QStringList )", "v.toStringList()"),
+}
+
+
+def member_name(key, prefix=""):
+    words = [w for w in re.split("[^A-Za-z0-9]+", key) if w]
+    if prefix:
+        words = [prefix] + words
+    return words[0] + "".join(w[0].upper() + w[1:] for w in words[1:])
+
+
+def property_type(schema):
+    t = schema.get("type", None)
+    if t == "array" and schema.get("items", {}).get("type", None) == "string":
+        return "stringlist"
+    if t in types:
+        return t
+    return None
+
+
+def cpp_default(t, value):
+    if value is None:
+        return ""
+    if t == "boolean":
+        return " = {!s}".format("true" if value else "false")
+    if t in ("integer", "number"):
+        return " = {!s}".format(value)
+    if t == "string":
+        return " = QStringLiteral( {!s} )".format(cpp_string(value))
+    return ""
+
+
+def cpp_string(s):
+    return '"' + s.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def spdx_lines(schema_file):
+    """
+    The SPDX lines of the schema, with the copyright of this script
+    added: the generated code is from both.
+    """
+    with open(schema_file, "r") as f:
+        lines = [l[1:].strip() for l in f.readlines() if l.startswith("# SPDX-")]
+    with open(__file__, "r") as f:
+        own = [l[1:].strip() for l in f.readlines() if l.startswith("# SPDX-FileCopyrightText:")]
+    copyrights = [l for l in lines if l.startswith("SPDX-FileCopyrightText:")]
+    return copyrights + [l for l in own if l not in copyrights] + [l for l in lines if l not in copyrights]
+
+
+def generate(schema_file, name):
+    with open(schema_file, "r") as f:
+        schema = yaml.safe_load(f)
+    properties = schema.get("properties", {})
+    required = schema.get("required", [])
+    strict = schema.get("additionalProperties", True) is False
+    schema_name = os.path.basename(schema_file)
+    guard = schema_name.split(".")[0].upper() + "_" + name.upper() + "_H"
+
+    out = []
+    out.append("/* === This file is part of Calamares - <https://calamares.io> ===")
+    out.append(" *")
+    for l in spdx_lines(schema_file):
+        out.append(" *   " + l)
+    out.append(" *")
+    out.append(" *   Calamares is Free Software: see the License-Identifier above.")
+    out.append(" *")
+    out.append(" */")
+    out.append("")
+    out.append("/* Generated by ci/schemaconfig.py from {!s} as {!s}".format(schema_name, name))
+    out.append(" *")
+    out.append(" * Do not edit this file: edit the schema and run the script again.")
+    out.append(" */")
+    out.append("")
+    out.append("#ifndef " + guard)
+    out.append("#define " + guard)
+    out.append("")
+    out.append('#include "utils/Logger.h"')
+    out.append("")
+    out.append("#include <QString>")
+    out.append("#include <QStringList>")
+    out.append("#include <QVariantList>")
+    out.append("#include <QVariantMap>")
+    out.append("")
+    out.append("struct " + name)
+    out.append("{")
+    for key, p in properties.items():
+        t = property_type(p)
+        if t is None:
+            continue
+        out.append("    {!s} {!s}{!s};".format(types[t][0], member_name(key), cpp_default(t, p.get("default", None))))
+    out.append("")
+    for key, p in properties.items():
+        if property_type(p) is None:
+            continue
+        out.append("    bool {!s} = false;".format(member_name(key, "has")))
+    out.append("")
+    out.append("    /** @brief Reads the configuration from @p map in a single pass")
+    out.append("     *")
+    out.append("     * Values of the wrong type are ignored, so the member keeps its default.")
+    out.append("     * Returns @c false (after logging a warning) if there are values of")
+    out.append("     * the wrong type, unknown keys, or missing required keys.")
+    out.append("     */")
+    out.append("    bool load( const QVariantMap& map );")
+    out.append("};")
+    out.append("")
+    out.append("inline bool")
+    out.append(name + "::load( const QVariantMap& map )")
+    out.append("{")
+    out.append("    bool ok = true;")
+    out.append("    for ( auto it = map.cbegin(); it != map.cend(); ++it )")
+    out.append("    {")
+    out.append("        const QString& key = it.key();")
+    out.append("        const QVariant& v = it.value();")
+    first = True
+    for key, p in properties.items():
+        t = property_type(p)
+        out.append("        {!s}if ( key == QLatin1String( {!s} ) )".format("" if first else "else ", cpp_string(key)))
+        first = False
+        out.append("        {")
+        if t is None:
+            out.append("            // Not checked, and not stored")
+            out.append("            (void)v;")
+        else:
+            out.append("            if ( {!s} )".format(types[t][1]))
+            out.append("            {")
+            out.append("                {!s} = {!s};".format(member_name(key), types[t][2]))
+            out.append("                {!s} = true;".format(member_name(key, "has")))
+            out.append("            }")
+            out.append("            else")
+            out.append("            {")
+            out.append('                cWarning() << "Configuration key" << key << "should be of type {!s}.";'.format(p["type"]))
+            out.append("                ok = false;")
+            out.append("            }")
+        out.append("        }")
+    if strict:
+        out.append("        {!s}".format("else" if properties else "if ( true )"))
+        out.append("        {")
+        out.append('            cWarning() << "Unknown configuration key" << key;')
+        out.append("            ok = false;")
+        out.append("        }")
+    out.append("    }")
+    for key in required:
+        if key in properties and property_type(properties[key]) is not None:
+            out.append("    if ( !{!s} )".format(member_name(key, "has")))
+        else:
+            out.append("    if ( !map.contains( QStringLiteral( {!s} ) ) )".format(cpp_string(key)))
+        out.append("    {")
+        out.append('        cWarning() << "Missing required configuration key" << {!s};'.format(cpp_string(key)))
+        out.append("        ok = false;")
+        out.append("    }")
+    out.append("    return ok;")
+    out.append("}")
+    out.append("")
+    out.append("#endif")
+    return "\n".join(out) + "\n"
+
+
+def check(header):
+    with open(header, "r") as f:
+        text = f.read()
+    m = re.search(r"Generated by ci/schemaconfig.py from (\S+) as (\S+)", text)
+    if not m:
+        sys.stderr.write("{!s} was not generated by schemaconfig.py\n".format(header))
+        return 2
+    schema_file = os.path.join(os.path.dirname(header), m.group(1))
+    if generate(schema_file, m.group(2)) != text:
+        sys.stderr.write("{!s} is out of date with {!s}\n".format(header, schema_file))
+        return 1
+    return 0
+
+
+def main():
+    if len(sys.argv) == 3 and sys.argv[1] == "-c":
+        return check(sys.argv[2])
+    if len(sys.argv) not in (3, 4):
+        print(usage)
+        return 2
+    text = generate(sys.argv[1], sys.argv[2])
+    if len(sys.argv) == 4:
+        with open(sys.argv[3], "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -18,15 +18,23 @@
 #include "JobQueue.h"
 #include "Settings.h"
 #include "ViewManager.h"
+#include "geoip/Prefetch.h"
+#include "modulesystem/Module.h"
 #include "modulesystem/ModuleManager.h"
+#include "network/Manager.h"
 #include "utils/CalamaresUtilsGui.h"
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/Dirs.h"
+#include "utils/HardwareInfo.h"
 #include "utils/Logger.h"
+#include "utils/PageCache.h"
 #ifdef WITH_QML
 #include "utils/Qml.h"
 #endif
 #include "utils/Retranslator.h"
+#include "utils/Trace.h"
+#include "utils/Variant.h"
+#include "utils/Yaml.h"
 #include "viewpages/ViewStep.h"
 
 #include <QDesktopWidget>
@@ -65,6 +73,7 @@ CalamaresApplication::CalamaresApplication( int& argc, char* argv[] )
 void
 CalamaresApplication::init()
 {
+    CalamaresUtils::Trace::Span span( "CalamaresApplication::init" );
     Logger::setupLogfile();
     cDebug() << "Calamares version:" << CALAMARES_VERSION;
     cDebug() << Logger::SubEntry
@@ -75,10 +84,20 @@ CalamaresApplication::init()
         cError() << "Must create Calamares::Settings before the application.";
         ::exit( 1 );
     }
+    {
+        const QString cacheDirectory = Calamares::Settings::instance()->networkCacheDirectory();
+        if ( !cacheDirectory.isEmpty() )
+        {
+            CalamaresUtils::Network::Manager::instance().setCacheDirectory( cacheDirectory );
+        }
+    }
     initQmlPath();
     initBranding();
 
-    CalamaresUtils::installTranslator();
+    {
+        CalamaresUtils::Trace::Span span( "installTranslator" );
+        CalamaresUtils::installTranslator();
+    }
 
     setQuitOnLastWindowClosed( false );
     setWindowIcon( QIcon( Calamares::Branding::instance()->imagePath( Calamares::Branding::ProductIcon ) ) );
@@ -93,6 +112,7 @@ CalamaresApplication::init()
 
 CalamaresApplication::~CalamaresApplication()
 {
+    CalamaresUtils::Trace::save();
     Logger::CDebug( Logger::LOGVERBOSE ) << "Shutting down Calamares...";
     Logger::CDebug( Logger::LOGVERBOSE ) << Logger::SubEntry << "Finished shutdown.";
 }
@@ -154,6 +174,7 @@ CalamaresApplication::initQmlPath()
 void
 CalamaresApplication::initBranding()
 {
+    CalamaresUtils::Trace::Span span( "CalamaresApplication::initBranding" );
     QString brandingComponentName = Calamares::Settings::instance()->brandingComponentName();
     if ( brandingComponentName.simplified().isEmpty() )
     {
@@ -163,18 +184,33 @@ CalamaresApplication::initBranding()
 
     QString brandingDescriptorSubpath = QString( "branding/%1/branding.desc" ).arg( brandingComponentName );
     QStringList brandingFileCandidatesByPriority = brandingFileCandidates( isDebug(), brandingDescriptorSubpath );
+    // A bundle next to the component directory is preferred over that directory
+    const QStringList brandingBundleCandidates
+        = brandingFileCandidates( isDebug(), QString( "branding/%1.rcc" ).arg( brandingComponentName ) );
 
     QFileInfo brandingFile;
     bool found = false;
 
-    foreach ( const QString& path, brandingFileCandidatesByPriority )
+    for ( int i = 0; !found && i < brandingFileCandidatesByPriority.count(); ++i )
     {
-        QFileInfo pathFi( path );
+        QFileInfo bundleFi( brandingBundleCandidates.value( i ) );
+        if ( bundleFi.exists() && bundleFi.isReadable() )
+        {
+            const QString descriptor
+                = Calamares::Branding::openBundle( bundleFi.absoluteFilePath(), brandingComponentName );
+            if ( !descriptor.isEmpty() )
+            {
+                brandingFile = QFileInfo( descriptor );
+                found = true;
+                break;
+            }
+        }
+
+        QFileInfo pathFi( brandingFileCandidatesByPriority.at( i ) );
         if ( pathFi.exists() && pathFi.isReadable() )
         {
             brandingFile = pathFi;
             found = true;
-            break;
         }
     }
 
@@ -202,6 +238,14 @@ CalamaresApplication::initModuleManager()
 {
     m_moduleManager = new Calamares::ModuleManager( Calamares::Settings::instance()->modulesSearchPaths(), this );
     connect( m_moduleManager, &Calamares::ModuleManager::initDone, this, &CalamaresApplication::initView );
+    if ( CalamaresUtils::Trace::isEnabled() )
+    {
+        // This is the last part of startup
+        connect( m_moduleManager, &Calamares::ModuleManager::requirementsComplete, this, []() {
+            CalamaresUtils::Trace::instant( "requirements complete" );
+            CalamaresUtils::Trace::save();
+        } );
+    }
     m_moduleManager->init();
 }
 
@@ -245,6 +289,7 @@ centerWindowOnScreen( QWidget* w )
 void
 CalamaresApplication::initView()
 {
+    CalamaresUtils::Trace::Span span( "CalamaresApplication::initView" );
     cDebug() << "STARTUP: initModuleManager: all modules init done";
     initJobQueue();
     cDebug() << "STARTUP: initJobQueue done";
@@ -264,10 +309,55 @@ CalamaresApplication::initView()
 }
 
 
+/** @brief Starts reading the unpackfs images into the page cache
+ *
+ * The user spends a while on the pages before the installation,
+ * while the (possibly slow) installation medium sits idle; reading
+ * the images now makes the unpackfs job faster later. Instances
+ * of unpackfs switch it on with *warmPageCache: true*.
+ */
+static void
+warmUnpackSources( Calamares::ModuleManager* manager )
+{
+    QStringList paths;
+    for ( const auto& key : manager->loadedInstanceKeys() )
+    {
+        Calamares::Module* module
+            = key.module() == QStringLiteral( "unpackfs" ) ? manager->moduleInstance( key ) : nullptr;
+        if ( !module )
+        {
+            continue;
+        }
+        const QVariantMap config = module->configurationMap();
+        if ( !CalamaresUtils::getBool( config, QStringLiteral( "warmPageCache" ), false ) )
+        {
+            continue;
+        }
+        for ( const auto& entry : config.value( QStringLiteral( "unpack" ) ).toList() )
+        {
+            const QVariantMap unpack = entry.toMap();
+            // Images, not plain files or directories that are copied as-is,
+            // nor images that are only received during the installation.
+            if ( CalamaresUtils::getString( unpack, QStringLiteral( "sourcefs" ) ) != QStringLiteral( "file" )
+                 && !unpack.contains( QStringLiteral( "receive" ) ) )
+            {
+                paths.append( CalamaresUtils::getString( unpack, QStringLiteral( "source" ) ) );
+            }
+        }
+    }
+    CalamaresUtils::PageCache::warmInBackground( paths );
+}
+
 void
 CalamaresApplication::initViewSteps()
 {
+    CalamaresUtils::Trace::Span span( "CalamaresApplication::initViewSteps" );
     cDebug() << "STARTUP: loadModules for all modules done";
+    if ( !m_yamlCacheFile.isEmpty() )
+    {
+        ::exit( CalamaresUtils::saveYamlCache( m_yamlCacheFile ) ? EXIT_SUCCESS : EXIT_FAILURE );
+    }
+    warmUnpackSources( m_moduleManager );
     m_moduleManager->checkRequirements();
     if ( Calamares::Branding::instance()->windowMaximize() )
     {
@@ -279,6 +369,7 @@ CalamaresApplication::initViewSteps()
         m_mainwindow->show();
     }
 
+    CalamaresUtils::Trace::instant( "window shown" );
     cDebug() << "STARTUP: Window now visible and ProgressTreeView populated";
     cDebug() << Logger::SubEntry << Calamares::ViewManager::instance()->viewSteps().count() << "view steps loaded.";
     Calamares::ViewManager::instance()->onInitComplete();
@@ -297,4 +388,27 @@ CalamaresApplication::initJobQueue()
     Calamares::JobQueue* jobQueue = new Calamares::JobQueue( this );
     new CalamaresUtils::System( Calamares::Settings::instance()->doChroot(), this );
     Calamares::Branding::instance()->setGlobals( jobQueue->globalStorage() );
+    const QString jobTimings = Calamares::Settings::instance()->jobTimingsFile();
+    if ( !jobTimings.isEmpty() )
+    {
+        jobQueue->loadTimingProfile( jobTimings );
+    }
+    const QString checkpoints = Calamares::Settings::instance()->jobCheckpointDirectory();
+    if ( !checkpoints.isEmpty() )
+    {
+        jobQueue->setCheckpointDirectory( checkpoints );
+    }
+    jobQueue->setTuning(
+        CalamaresUtils::SystemTuning::Profile::fromMap( Calamares::Settings::instance()->execTuning() ) );
+
+    // Read the hardware facts while the modules load
+    CalamaresUtils::HardwareInfo::prefetch( jobQueue->globalStorage() );
+
+    // Global storage exists now, and modules are not loaded yet,
+    // so this is the earliest point at which GeoIP results are usable.
+    const auto geoip = Calamares::Settings::instance()->geoipConfiguration();
+    if ( !geoip.isEmpty() )
+    {
+        CalamaresUtils::GeoIP::Prefetch::instance().start( geoip );
+    }
 }
@@ -45,6 +45,12 @@ public:
      */
     CalamaresWindow* mainWindow();
 
+    /** @brief Save the YAML cache to @p filename once modules are loaded, and quit
+     *
+     * This is used to generate the YAML cache (e.g. when building an ISO).
+     */
+    void setGenerateYamlCache( const QString& filename ) { m_yamlCacheFile = filename; }
+
 private slots:
     void initView();
     void initViewSteps();
@@ -59,6 +65,7 @@ private:
 
     CalamaresWindow* m_mainwindow;
     Calamares::ModuleManager* m_moduleManager;
+    QString m_yamlCacheFile;  ///< If set, save the YAML cache here and quit
 };
 
 #endif  // CALAMARESAPPLICATION_H
@@ -121,7 +121,10 @@ getWidgetSidebar( Calamares::DebugWindowManager* debug,
     }
     logoLabel->setAlignment( Qt::AlignCenter );
     logoLabel->setFixedSize( 80, 80 );
-    logoLabel->setPixmap( branding->image( Calamares::Branding::ProductLogo, logoLabel->size() ) );
+    logoLabel->setPixmap( branding->image( Calamares::Branding::ProductLogo,
+                                           logoLabel->size(),
+                                           logoLabel,
+                                           [logoLabel]( const QPixmap& logo ) { logoLabel->setPixmap( logo ); } ) );
     logoLayout->addWidget( logoLabel );
     logoLayout->addStretch();
 
@@ -249,8 +252,7 @@ getQmlSidebar( Calamares::DebugWindowManager* debug,
                Qt::Orientation o,
                int desiredWidth )
 {
-    CalamaresUtils::registerQmlModels();
-    QQuickWidget* w = new QQuickWidget( parent );
+    QQuickWidget* w = new QQuickWidget( CalamaresUtils::qmlEngine(), parent );
     if ( debug )
     {
         w->engine()->rootContext()->setContextProperty( "debug", debug );
@@ -269,8 +271,7 @@ getQmlNavigation( Calamares::DebugWindowManager* debug,
                   Qt::Orientation o,
                   int desiredWidth )
 {
-    CalamaresUtils::registerQmlModels();
-    QQuickWidget* w = new QQuickWidget( parent );
+    QQuickWidget* w = new QQuickWidget( CalamaresUtils::qmlEngine(), parent );
     if ( debug )
     {
         w->engine()->rootContext()->setContextProperty( "debug", debug );
@@ -499,11 +500,17 @@ CalamaresWindow::ensureSize( QSize size )
 void
 CalamaresWindow::closeEvent( QCloseEvent* event )
 {
-    if ( ( !m_viewManager ) || m_viewManager->confirmCancelInstallation() )
+    if ( !m_viewManager )
     {
         event->accept();
         qApp->quit();
     }
+    else if ( m_viewManager->confirmCancelInstallation() )
+    {
+        // The window stays until running jobs have stopped
+        event->ignore();
+        m_viewManager->cancelAndQuit();
+    }
     else
     {
         event->ignore();
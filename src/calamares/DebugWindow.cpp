@@ -20,6 +20,7 @@
 #include "modulesystem/Module.h"
 #include "modulesystem/ModuleManager.h"
 #include "utils/Logger.h"
+#include "utils/MemoryAccounting.h"
 #include "utils/Paste.h"
 #include "utils/Retranslator.h"
 
@@ -32,6 +33,7 @@
 
 #include <QSplitter>
 #include <QStringListModel>
+#include <QTimer>
 #include <QTreeView>
 #include <QWidget>
 
@@ -67,6 +69,81 @@ dumpWidgetTree( QDebug& deb, const QWidget* widget, int depth )
     }
 }
 
+/// @brief Size in MiB for display, e.g. "12.5 MiB"
+static QString
+mebibytes( qint64 bytes )
+{
+    return QStringLiteral( "%1 MiB" ).arg( double( bytes ) / ( 1024 * 1024 ), 0, 'f', 1 );
+}
+
+/// @brief PSS of a MemoryUsage map, or RSS if the kernel does not tell PSS
+static QString
+proportional( const QVariantMap& usage )
+{
+    const qint64 pss = usage.value( "pss" ).toLongLong();
+    return mebibytes( pss ? pss : usage.value( "rss" ).toLongLong() );
+}
+
+/** @brief Fills the memory page from the memory report
+ *
+ * Global storage is measured only @p withGlobalStorage (when the page
+ * is opened, not on every refresh); otherwise the last size is shown.
+ */
+static void
+showMemoryReport( Calamares::Ui::DebugWindow* ui, bool withGlobalStorage )
+{
+    static qint64 s_globalStorageSize = 0;
+
+    const QVariantMap report = CalamaresUtils::MemoryAccounting::report( withGlobalStorage );
+    const QVariantMap process = report.value( "process" ).toMap();
+    if ( withGlobalStorage )
+    {
+        s_globalStorageSize = process.value( "globalStorage" ).toLongLong();
+    }
+    ui->memoryProcessLabel->setText(
+        QStringLiteral( "RSS %1, PSS %2, anonymous %3, swap %4; image cache %5, global storage %6" )
+            .arg( mebibytes( process.value( "rss" ).toLongLong() ),
+                  mebibytes( process.value( "pss" ).toLongLong() ),
+                  mebibytes( process.value( "anonymous" ).toLongLong() ),
+                  mebibytes( process.value( "swap" ).toLongLong() ),
+                  mebibytes( process.value( "imageCache" ).toLongLong() ),
+                  mebibytes( s_globalStorageSize ) ) );
+
+    const QVariantList modules = report.value( "modules" ).toList();
+    // Keep the rows (and the selection) when nothing was added
+    while ( ui->memoryView->topLevelItemCount() > modules.count() )
+    {
+        delete ui->memoryView->takeTopLevelItem( ui->memoryView->topLevelItemCount() - 1 );
+    }
+    for ( int i = 0; i < modules.count(); ++i )
+    {
+        const QVariantMap m = modules.at( i ).toMap();
+        auto* item = ui->memoryView->topLevelItem( i );
+        if ( !item )
+        {
+            item = new QTreeWidgetItem( ui->memoryView );
+        }
+        const QString name = m.value( "name" ).toString();
+        const QString module = m.value( "module" ).toString();
+        item->setText( 0, name.isEmpty() ? module : QStringLiteral( "%1 (%2)" ).arg( name, module ) );
+        item->setText( 1, proportional( m.value( "load" ).toMap() ) );
+        item->setText( 2, proportional( m.value( "widget" ).toMap() ) );
+        item->setText( 3,
+                       m.value( "activations" ).toInt() ? proportional( m.value( "activation" ).toMap() )
+                                                        : QString() );
+        QStringList held;
+        const QVariantMap step = m.value( "step" ).toMap();
+        for ( auto it = step.cbegin(); it != step.cend(); ++it )
+        {
+            // Keys that are not counts are sizes
+            held.append( QStringLiteral( "%1 %2" ).arg(
+                it.key(),
+                it.key().endsWith( "Objects" ) ? it.value().toString() : mebibytes( it.value().toLongLong() ) ) );
+        }
+        item->setText( 4, held.join( ", " ) );
+    }
+}
+
 namespace Calamares
 {
 
@@ -81,14 +158,14 @@ DebugWindow::DebugWindow()
 
     m_ui->setupUi( this );
 
+    // The model is lazy: only what is expanded in the view is looked at,
+    // so GlobalStorage is not expanded here (it can be large).
     m_ui->globalStorageView->setModel( m_globals_model.get() );
-    m_ui->globalStorageView->expandAll();
 
-    // Do above when the GS changes, too
-    connect( gs, &GlobalStorage::changed, this, [=] {
+    // Update only the keys that change
+    connect( gs, &GlobalStorage::keyChanged, this, [=]( const QString& key ) {
         m_globals = JobQueue::instance()->globalStorage()->data();
-        m_globals_model->reload();
-        m_ui->globalStorageView->expandAll();
+        m_globals_model->reloadKey( key );
     } );
 
     // JobQueue page
@@ -194,6 +271,23 @@ DebugWindow::DebugWindow()
                  }
              } );
 
+    // Memory page, live while it is shown
+    QTimer* memoryTimer = new QTimer( this );
+    memoryTimer->setInterval( 2000 );
+    connect( memoryTimer, &QTimer::timeout, this, [ this ]() {
+        if ( m_ui->tabWidget->currentWidget() == m_ui->memoryTab )
+        {
+            showMemoryReport( m_ui, false );
+        }
+    } );
+    connect( m_ui->tabWidget, &QTabWidget::currentChanged, this, [ this ]() {
+        if ( m_ui->tabWidget->currentWidget() == m_ui->memoryTab )
+        {
+            showMemoryReport( m_ui, true );
+        }
+    } );
+    memoryTimer->start();
+
     // Tools page
     connect( m_ui->crashButton, &QPushButton::clicked, this, [] { ::crash(); } );
     connect( m_ui->reloadStylesheetButton, &QPushButton::clicked, []() {
@@ -9,78 +9,166 @@
 
 #include "VariantModel.h"
 
-static void
-overallLength( const QVariant& item, quintptr& c, quintptr parent, VariantModel::IndexVector* skiplist )
+#include <algorithm>
+
+/// @brief Does the variant @p v have children in the model?
+static inline bool
+isContainer( const QVariant& v )
 {
-    if ( skiplist )
-    {
-        skiplist->append( parent );
-    }
+    return v.canConvert< QVariantList >() || v.canConvert< QVariantMap >();
+}
 
-    parent = c++;
-    if ( item.canConvert< QVariantList >() )
+/// @brief How many children would @p v have (without making them)
+static int
+childCount( const QVariant& v )
+{
+    if ( v.canConvert< QVariantList >() )
     {
-        for ( const auto& subitem : item.toList() )
-        {
-            overallLength( subitem, c, parent, skiplist );
-        }
+        return v.toList().count();
     }
-    else if ( item.canConvert< QVariantMap >() )
+    else if ( v.canConvert< QVariantMap >() )
     {
-        for ( const auto& subitem : item.toMap() )
-        {
-            overallLength( subitem, c, parent, skiplist );
-        }
+        return v.toMap().count();
     }
+    return 0;
 }
 
-static quintptr
-findNth( const VariantModel::IndexVector& skiplist, quintptr value, int n )
+VariantModel::VariantModel( const QVariant* p )
+    : m_p( p )
 {
-    constexpr const quintptr invalid_index = static_cast< quintptr >( -1 );
+    reload();
+}
+
+VariantModel::~VariantModel() {}
 
-    if ( n < 0 )
+void
+VariantModel::fetch( Node* n )
+{
+    n->children.clear();
+    n->fetched = true;
+
+    auto add = [ n ]( const QVariant& key, const QVariant& value ) {
+        auto child = std::make_unique< Node >();
+        child->key = key;
+        child->value = value;
+        child->parent = n;
+        child->row = int( n->children.size() );
+        n->children.push_back( std::move( child ) );
+    };
+
+    if ( n->value.canConvert< QVariantList >() )
     {
-        return invalid_index;
+        const auto list = n->value.toList();
+        n->children.reserve( std::size_t( list.count() ) );
+        for ( int i = 0; i < list.count(); ++i )
+        {
+            add( i, list.at( i ) );
+        }
     }
-
-    int index = static_cast< int >( value );
-    while ( ( n >= 0 ) && ( index < skiplist.count() ) )
+    else if ( n->value.canConvert< QVariantMap >() )
     {
-        if ( skiplist[ index ] == value )
+        const auto map = n->value.toMap();
+        n->children.reserve( std::size_t( map.count() ) );
+        for ( auto it = map.cbegin(); it != map.cend(); ++it )
         {
-            if ( --n < 0 )
-            {
-                // It's bigger than 0
-                return static_cast< quintptr >( index );
-            }
+            add( it.key(), it.value() );
         }
-        index++;
     }
-    return invalid_index;
 }
 
-
-VariantModel::VariantModel( const QVariant* p )
-    : m_p( p )
+void
+VariantModel::reload()
 {
-    reload();
+    beginResetModel();
+    m_root = std::make_unique< Node >();
+    m_root->value = *m_p;
+    fetch( m_root.get() );  // The top level is always there
+    endResetModel();
 }
 
-VariantModel::~VariantModel() {}
+void
+VariantModel::refetch( Node* n, const QModelIndex& index )
+{
+    if ( !n->children.empty() )
+    {
+        beginRemoveRows( index, 0, int( n->children.size() ) - 1 );
+        n->children.clear();
+        endRemoveRows();
+    }
+    // If it was looked at before, the new children are shown right away
+    if ( n->fetched && childCount( n->value ) > 0 )
+    {
+        beginInsertRows( index, 0, childCount( n->value ) - 1 );
+        fetch( n );
+        endInsertRows();
+    }
+    else
+    {
+        n->fetched = false;
+    }
+}
 
 void
-VariantModel::reload()
+VariantModel::reloadKey( const QString& key )
 {
-    constexpr const quintptr invalid_index = static_cast< quintptr >( -1 );
+    if ( !m_root || !m_p->canConvert< QVariantMap >() || !m_root->value.canConvert< QVariantMap >() )
+    {
+        reload();
+        return;
+    }
+
+    const QVariantMap map = m_p->toMap();
+    m_root->value = *m_p;
+
+    // The rows are in the order of QVariantMap, sorted by key
+    auto& children = m_root->children;
+    auto it = std::lower_bound( children.begin(),
+                                children.end(),
+                                key,
+                                []( const std::unique_ptr< Node >& n, const QString& k ) {
+                                    return n->key.toString() < k;
+                                } );
+    const int row = int( std::distance( children.begin(), it ) );
+    const bool exists = it != children.end() && ( *it )->key.toString() == key;
+    auto renumber = [ &children ]( int from ) {
+        for ( int i = from; i < int( children.size() ); ++i )
+        {
+            children[ std::size_t( i ) ]->row = i;
+        }
+    };
 
-    quintptr x = 0;
-    m_rows.clear();  // Start over
-    if ( m_rows.capacity() < 64 )
+    auto value = map.constFind( key );
+    if ( exists && value != map.constEnd() )
+    {
+        Node* n = it->get();
+        n->value = value.value();
+        refetch( n, createIndex( row, 0, n ) );
+        emit dataChanged( createIndex( row, 0, n ), createIndex( row, 1, n ) );
+    }
+    else if ( exists )
+    {
+        beginRemoveRows( QModelIndex(), row, row );
+        children.erase( it );
+        renumber( row );
+        endRemoveRows();
+    }
+    else if ( value != map.constEnd() )
     {
-        m_rows.reserve( 64 );  // Start reasonably-sized
+        beginInsertRows( QModelIndex(), row, row );
+        auto child = std::make_unique< Node >();
+        child->key = key;
+        child->value = value.value();
+        child->parent = m_root.get();
+        children.insert( it, std::move( child ) );
+        renumber( row );
+        endInsertRows();
     }
-    overallLength( *m_p, x, invalid_index, &m_rows );
+}
+
+VariantModel::Node*
+VariantModel::node( const QModelIndex& index ) const
+{
+    return index.isValid() ? static_cast< Node* >( index.internalPointer() ) : m_root.get();
 }
 
 int
@@ -92,61 +180,74 @@ VariantModel::columnCount( const QModelIndex& ) const
 int
 VariantModel::rowCount( const QModelIndex& index ) const
 {
-    quintptr p = index.isValid() ? index.internalId() : 0;
-    return m_rows.count( p );
+    if ( index.column() > 0 )
+    {
+        return 0;
+    }
+    const Node* n = node( index );
+    return n ? int( n->children.size() ) : 0;
 }
 
-QModelIndex
-VariantModel::index( int row, int column, const QModelIndex& parent ) const
+bool
+VariantModel::hasChildren( const QModelIndex& index ) const
 {
-    quintptr p = 0;
-
-    if ( parent.isValid() )
+    if ( index.column() > 0 )
     {
-        if ( inRange( parent ) )
-        {
-            p = parent.internalId();
-        }
+        return false;
+    }
+    const Node* n = node( index );
+    if ( !n )
+    {
+        return false;
     }
+    return n->fetched ? !n->children.empty() : ( isContainer( n->value ) && childCount( n->value ) > 0 );
+}
 
-    return createIndex( row, column, findNth( m_rows, p, row ) );
+bool
+VariantModel::canFetchMore( const QModelIndex& index ) const
+{
+    const Node* n = node( index );
+    return n && !n->fetched && index.column() <= 0 && childCount( n->value ) > 0;
 }
 
-static inline quintptr
-deref( const VariantModel::IndexVector& v, quintptr i )
+void
+VariantModel::fetchMore( const QModelIndex& index )
 {
-    return v[ static_cast< int >( i ) ];
+    if ( !canFetchMore( index ) )
+    {
+        return;
+    }
+    Node* n = node( index );
+    beginInsertRows( index, 0, childCount( n->value ) - 1 );
+    fetch( n );
+    endInsertRows();
 }
 
 QModelIndex
-VariantModel::parent( const QModelIndex& index ) const
+VariantModel::index( int row, int column, const QModelIndex& parent ) const
 {
-    if ( !index.isValid() || !inRange( index ) )
+    const Node* n = node( parent );
+    if ( !n || row < 0 || row >= int( n->children.size() ) || column < 0 || column > 1 )
     {
         return QModelIndex();
     }
+    return createIndex( row, column, n->children[ std::size_t( row ) ].get() );
+}
 
-    quintptr p = deref( m_rows, index.internalId() );
-    if ( p == 0 )
+QModelIndex
+VariantModel::parent( const QModelIndex& index ) const
+{
+    if ( !index.isValid() )
     {
         return QModelIndex();
     }
 
-    if ( !inRange( p ) )
+    const Node* p = static_cast< Node* >( index.internalPointer() )->parent;
+    if ( !p || p == m_root.get() )
     {
         return QModelIndex();
     }
-    quintptr p_pid = deref( m_rows, p );
-    int row = 0;
-    for ( int i = static_cast< int >( p_pid ); i < static_cast< int >( p ); ++i )
-    {
-        if ( m_rows[ i ] == p_pid )
-        {
-            row++;
-        }
-    }
-
-    return createIndex( row, index.column(), p );
+    return createIndex( p->row, 0, const_cast< Node* >( p ) );
 }
 
 QVariant
@@ -167,56 +268,9 @@ VariantModel::data( const QModelIndex& index, int role ) const
         return QVariant();
     }
 
-    if ( !inRange( index ) )
-    {
-        return QVariant();
-    }
-
-    const QVariant thing = underlying( parent( index ) );
-
-    if ( !thing.isValid() )
-    {
-        return QVariant();
-    }
-
-    if ( thing.canConvert< QVariantMap >() )
-    {
-        QVariantMap the_map = thing.toMap();
-        const auto key = the_map.keys().at( index.row() );
-        if ( index.column() == 0 )
-        {
-            return key;
-        }
-        else
-        {
-            return the_map[ key ];
-        }
-    }
-    else if ( thing.canConvert< QVariantList >() )
-    {
-        if ( index.column() == 0 )
-        {
-            return index.row();
-        }
-        else
-        {
-            QVariantList the_list = thing.toList();
-            return the_list.at( index.row() );
-        }
-    }
-    else
-    {
-        if ( index.column() == 0 )
-        {
-            return QVariant();
-        }
-        else
-        {
-            return thing;
-        }
-    }
+    const Node* n = node( index );
+    return index.column() == 0 ? n->key : n->value;
 }
-
 QVariant
 VariantModel::headerData( int section, Qt::Orientation orientation, int role ) const
 {
@@ -245,27 +299,3 @@ VariantModel::headerData( int section, Qt::Orientation orientation, int role ) c
         return QVariant();
     }
 }
-
-const QVariant
-VariantModel::underlying( const QModelIndex& index ) const
-{
-    if ( !index.isValid() )
-    {
-        return *m_p;
-    }
-
-    const auto& thing = underlying( parent( index ) );
-    if ( thing.canConvert< QVariantMap >() )
-    {
-        const auto& the_map = thing.toMap();
-        return the_map[ the_map.keys()[ index.row() ] ];
-    }
-    else if ( thing.canConvert< QVariantList >() )
-    {
-        return thing.toList()[ index.row() ];
-    }
-    else
-    {
-        return thing;
-    }
-}
@@ -12,7 +12,9 @@
 
 #include <QAbstractItemModel>
 #include <QVariantMap>
-#include <QVector>
+
+#include <memory>
+#include <vector>
 
 /** @brief A model that operates directly on a QVariant
  *
@@ -23,28 +25,27 @@
  * the model will get you a tree-like model of the
  * VariantMap's data structure.
  *
- * Take care of object lifetimes and that the underlying
- * QVariant does not change during use. If the QVariant
- * **does** change, call reload() to re-build the internal
- * representation of the tree.
+ * The tree is built lazily: only the top level is there at
+ * first, and the children of a node are added when a view
+ * asks for them (see fetchMore(), which a QTreeView calls when
+ * a node is expanded). So a large QVariant costs nothing until
+ * it is looked at.
+ *
+ * Take care of object lifetimes. Each node keeps its own (implicitly
+ * shared) copy of its value, so the model is not affected when the
+ * QVariant changes. If the QVariant **does** change, call reload()
+ * to re-build the tree, or reloadKey() if only one key of a
+ * QVariantMap changed.
  */
 class VariantModel : public QAbstractItemModel
 {
     Q_OBJECT
 public:
-    /** @brief Auxiliary data
-     *
-     * The nodes of the tree are enumerated into a vector
-     * (of length equal to the number of nodes in the tree + 1)
-     * which are used to do index and parent calculations.
-     */
-    using IndexVector = QVector< quintptr >;
-
     /** @brief Constructor
      *
      * The QVariant's lifetime is **not** affected by the model,
      * so take care that the QVariant lives at least as long as
-     * the model). Also, don't change the QVariant underneath the model.
+     * the model).
      */
     VariantModel( const QVariant* p );
 
@@ -53,12 +54,24 @@ public:
     /** @brief Re-build the internal tree
      *
      * Call this when the underlying variant is changed, which
-     * might impact how the tree is laid out.
+     * might impact how the tree is laid out. This resets the model.
      */
     void reload();
 
+    /** @brief Update one top-level @p key
+     *
+     * When the underlying variant is a QVariantMap, and only the
+     * value of @p key changed (or it was added or removed), this
+     * updates just that row and its children. Other rows, and
+     * which of them are expanded in a view, are not affected.
+     */
+    void reloadKey( const QString& key );
+
     int columnCount( const QModelIndex& index ) const override;
     int rowCount( const QModelIndex& index ) const override;
+    bool hasChildren( const QModelIndex& index ) const override;
+    bool canFetchMore( const QModelIndex& index ) const override;
+    void fetchMore( const QModelIndex& index ) override;
 
     QModelIndex index( int row, int column, const QModelIndex& parent ) const override;
     QModelIndex parent( const QModelIndex& index ) const override;
@@ -66,39 +79,30 @@ public:
     QVariant headerData( int section, Qt::Orientation orientation, int role ) const override;
 
 private:
-    const QVariant* const m_p;
-
-    /** @brief Tree representation of the variant.
-     *
-     * At index 0 in the vector , we store -1 to indicate the root.
-     *
-     * Then we enumerate all the elements in the tree (by traversing
-     * the variant and using QVariantMap and QVariantList as having
-     * children, and everything else being a leaf node) and at the index
-     * for a child, store the index of its parent. This means that direct
-     * children of the root store a 0 in their indexes, children of the first
-     * child of the root store a 1, and we can "pointer chase" from an index
-     * through parents back to index 0.
-     *
-     * Because of this structure, the value stored at index i must be
-     * less than i (except for index 0, which is special). This makes it
-     * slightly easier to search for a given value *p*, because we can start
-     * at index *p* (or even *p+1*).
-     *
-     * Given an index *i* into the vector corresponding to a child, we know the
-     * parent, but can also count which row this child should have, by counting
-     * *other* indexes before *i* with the same parent (and by the ordering
-     * of values, we can start counting at index *parent-index*).
+    /** @brief A node in the tree
      *
+     * The key is the map key, or the list index, of the
+     * value in its parent. The children are only there once
+     * fetched is set.
      */
-    IndexVector m_rows;
+    struct Node
+    {
+        QVariant key;
+        QVariant value;
+        Node* parent = nullptr;
+        int row = 0;
+        bool fetched = false;
+        std::vector< std::unique_ptr< Node > > children;
+    };
 
-    /// @brief Implementation of walking an index through the variant-tree
-    const QVariant underlying( const QModelIndex& index ) const;
+    const QVariant* const m_p;
+    std::unique_ptr< Node > m_root;
 
-    /// @brief Helpers for range-checking
-    inline bool inRange( quintptr p ) const { return p < static_cast< quintptr >( m_rows.count() ); }
-    inline bool inRange( const QModelIndex& index ) const { return inRange( index.internalId() ); }
+    Node* node( const QModelIndex& index ) const;
+    /// @brief Creates the children of @p n (just one level)
+    static void fetch( Node* n );
+    /// @brief Replaces the children of @p n, which has changed, in the model
+    void refetch( Node* n, const QModelIndex& index );
 };
 
 #endif
@@ -33,7 +33,7 @@ Rectangle {
             id: logo;
             width: 80;
             height: width;  // square
-            source: "file:/" + Branding.imagePath(Branding.ProductLogo);
+            source: Branding.imageUrl(Branding.ProductLogo);
             sourceSize.width: width;
             sourceSize.height: height;
         }
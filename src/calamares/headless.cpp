@@ -0,0 +1,362 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+/*
+ * This executable runs an installation without a window: for
+ * mass deployment, where the answers that the user would give
+ * in the UI are known in advance.
+ *
+ * The same settings.conf and module configurations are used as
+ * for the GUI, but only the *exec* (and *prepare*) phases run;
+ * view modules in those phases need widgets, so a sequence that
+ * has them is refused. Whatever the view modules would have put
+ * in global storage has to be preloaded, from YAML or JSON files.
+ * Progress goes to stdout, as text or as one JSON object per line.
+ */
+
+#include "CalamaresConfig.h"
+#include "CalamaresVersionX.h"
+#include "GlobalStorage.h"
+#include "JobQueue.h"
+#include "Settings.h"
+#include "modulesystem/Module.h"
+#include "modulesystem/ModuleManager.h"
+#include "utils/CalamaresUtilsSystem.h"
+#include "utils/Dirs.h"
+#include "utils/Logger.h"
+
+#ifdef WITH_PYTHON
+#include "PythonJob.h"
+#endif
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <cstdio>
+
+struct HeadlessConfig
+{
+    QString m_settings;  ///< Path to settings.conf; empty to search for it
+    QStringList m_globalYaml;
+    QStringList m_globalJson;
+    bool m_json = false;
+    bool m_debug = false;
+};
+
+/// @brief The -D level, as in the GUI: errors only if not given
+static unsigned int
+debug_level( QCommandLineParser& parser, QCommandLineOption& levelOption )
+{
+    if ( !parser.isSet( levelOption ) )
+    {
+        return Logger::LOGERROR;
+    }
+
+    bool ok = true;
+    int l = parser.value( levelOption ).toInt( &ok );
+    if ( !ok || ( l < 0 ) )
+    {
+        return Logger::LOGVERBOSE;
+    }
+    return static_cast< unsigned int >( l );  // l >= 0
+}
+
+static HeadlessConfig
+handle_args( QCoreApplication& a )
+{
+    QCommandLineOption debugOption( QStringList { "d", "debug" },
+                                    "Also look for settings and modules in the current directory." );
+    QCommandLineOption debugLevelOption(
+        QStringLiteral( "D" ), "Verbose output for debugging purposes (0-8).", QStringLiteral( "level" ) );
+    QCommandLineOption configOption(
+        QStringList { "c", "config" }, "Configuration directory to use, for testing purposes.", "config" );
+    QCommandLineOption xdgOption( QStringList { "X", "xdg-config" }, "Use XDG_{CONFIG,DATA}_DIRS as well." );
+    QCommandLineOption globalOption( QStringList { "g", "global" },
+                                     QStringLiteral( "Global settings document (YAML), may be repeated" ),
+                                     QStringLiteral( "global" ) );
+    QCommandLineOption globalJsonOption( QStringList { "G", "global-json" },
+                                         QStringLiteral( "Global settings document (JSON), may be repeated" ),
+                                         QStringLiteral( "global" ) );
+    QCommandLineOption jsonOption( QStringList { "j", "json" },
+                                   QStringLiteral( "Report progress as one JSON object per line" ) );
+    QCommandLineOption profilePythonOption(
+        QStringLiteral( "profile-python" ),
+        QStringLiteral( "Profile the Python modules, writing collapsed stacks to the log directory" ) );
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Calamares installation without a user interface" );
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOption( debugOption );
+    parser.addOption( debugLevelOption );
+    parser.addOption( configOption );
+    parser.addOption( xdgOption );
+    parser.addOption( globalOption );
+    parser.addOption( globalJsonOption );
+    parser.addOption( jsonOption );
+#ifdef WITH_PYTHON
+    parser.addOption( profilePythonOption );
+#endif
+    parser.addPositionalArgument( "settings", "Path of settings.conf (optional)", "[settings]" );
+
+    parser.process( a );
+
+    Logger::setupLogLevel( parser.isSet( debugOption ) ? Logger::LOGVERBOSE : debug_level( parser, debugLevelOption ) );
+    if ( parser.isSet( configOption ) )
+    {
+        CalamaresUtils::setAppDataDir( QDir( parser.value( configOption ) ) );
+    }
+    if ( parser.isSet( xdgOption ) )
+    {
+        CalamaresUtils::setXdgDirs();
+    }
+#ifdef WITH_PYTHON
+    if ( parser.isSet( profilePythonOption ) )
+    {
+        Calamares::PythonJob::setProfileDirectory( CalamaresUtils::appLogDir().absolutePath() );
+    }
+#endif
+
+    const QStringList args = parser.positionalArguments();
+    if ( args.count() > 1 )
+    {
+        parser.showHelp( 1 );
+    }
+
+    HeadlessConfig config;
+    config.m_settings = args.isEmpty() ? QString() : args.first();
+    config.m_globalYaml = parser.values( globalOption );
+    config.m_globalJson = parser.values( globalJsonOption );
+    config.m_json = parser.isSet( jsonOption );
+    config.m_debug = parser.isSet( debugOption );
+    return config;
+}
+
+/// @brief Writes @p event to stdout, as JSON or as text
+static void
+report( const HeadlessConfig& config, const QJsonObject& event )
+{
+    if ( config.m_json )
+    {
+        const QByteArray line = QJsonDocument( event ).toJson( QJsonDocument::Compact );
+        std::fprintf( stdout, "%s\n", line.constData() );
+    }
+    else
+    {
+        const QString type = event.value( "event" ).toString();
+        if ( type == QStringLiteral( "progress" ) )
+        {
+            std::fprintf( stdout,
+                          "[%3d%%] %s\n",
+                          qRound( event.value( "percent" ).toDouble() * 100 ),
+                          qPrintable( event.value( "message" ).toString() ) );
+        }
+        else if ( type == QStringLiteral( "failed" ) )
+        {
+            std::fprintf( stdout,
+                          "Installation failed: %s\n%s\n",
+                          qPrintable( event.value( "message" ).toString() ),
+                          qPrintable( event.value( "details" ).toString() ) );
+        }
+        else if ( type == QStringLiteral( "finished" ) )
+        {
+            const bool ok = event.value( "ok" ).toBool();
+            std::fprintf( stdout, "%s\n", ok ? "Installation done." : "Installation stopped." );
+        }
+        else if ( type == QStringLiteral( "slow" ) )
+        {
+            std::fprintf( stdout,
+                          "%s is taking longer than expected (%d seconds so far).\n",
+                          qPrintable( event.value( "job" ).toString() ),
+                          event.value( "seconds" ).toInt() );
+        }
+        else if ( type == QStringLiteral( "error" ) )
+        {
+            std::fprintf( stdout, "Error: %s\n", qPrintable( event.value( "message" ).toString() ) );
+        }
+    }
+    std::fflush( stdout );
+}
+
+/** @brief Loads the job modules of the sequence and starts the queue
+ *
+ * This is the headless counterpart of ModuleManager::loadModules() and
+ * the ExecutionViewStep: *show* phases are skipped. View modules in the
+ * other phases would need widgets to create their jobs, so a sequence
+ * with any of them is refused. Returns an exit code: 0 if the queue
+ * was started, 78 for a sequence with view modules, 1 if any job
+ * module failed to load.
+ */
+static int
+start_jobs( const HeadlessConfig& config, Calamares::ModuleManager* moduleManager )
+{
+    using Calamares::ModuleSystem::Action;
+
+    QStringList viewModules;
+    for ( const auto& modulePhase : Calamares::Settings::instance()->modulesSequence() )
+    {
+        if ( modulePhase.first == Action::Show )
+        {
+            continue;
+        }
+        for ( const auto& instanceKey : modulePhase.second )
+        {
+            if ( moduleManager->moduleDescriptor( instanceKey ).type() == Calamares::Module::Type::View )
+            {
+                viewModules.append( instanceKey.toString() );
+            }
+        }
+    }
+    if ( !viewModules.isEmpty() )
+    {
+        const QString message
+            = QStringLiteral( "View modules cannot run without a user interface: %1" ).arg( viewModules.join( ", " ) );
+        cError() << message;
+        report( config, QJsonObject { { "event", "error" }, { "message", message } } );
+        return 78;  // EX_CONFIG on FreeBSD
+    }
+
+    auto* queue = Calamares::JobQueue::instance();
+    QStringList failedModules;
+    for ( const auto& modulePhase : Calamares::Settings::instance()->modulesSequence() )
+    {
+        if ( modulePhase.first == Action::Show )
+        {
+            continue;
+        }
+        for ( const auto& instanceKey : modulePhase.second )
+        {
+            if ( !moduleManager->loadModule( instanceKey ) )
+            {
+                failedModules.append( instanceKey.toString() );
+                continue;
+            }
+
+            if ( modulePhase.first == Action::Prepare )
+            {
+                queue->prepare( moduleManager->instanceJobs( instanceKey ) );
+            }
+            else
+            {
+                queue->enqueue( moduleManager->instanceWeight( instanceKey ),
+                                moduleManager->instanceJobs( instanceKey ) );
+            }
+        }
+    }
+
+    if ( !failedModules.isEmpty() )
+    {
+        const QString message = QStringLiteral( "Modules failed to load: %1" ).arg( failedModules.join( ", " ) );
+        cError() << message;
+        report( config, QJsonObject { { "event", "error" }, { "message", message } } );
+        return 1;
+    }
+    queue->start();
+    return 0;
+}
+
+int
+main( int argc, char* argv[] )
+{
+    QCoreApplication a( argc, argv );
+    a.setOrganizationDomain( QStringLiteral( CALAMARES_ORGANIZATION_DOMAIN ) );
+    a.setApplicationName( QStringLiteral( CALAMARES_APPLICATION_NAME ) );
+    a.setApplicationVersion( QStringLiteral( CALAMARES_VERSION ) );
+
+    const HeadlessConfig config = handle_args( a );
+    Logger::setupLogfile();
+    cDebug() << "Calamares (headless) version:" << CALAMARES_VERSION;
+
+    if ( config.m_settings.isEmpty() )
+    {
+        Calamares::Settings::init( config.m_debug );
+    }
+    else
+    {
+        Calamares::Settings::init( config.m_settings );
+    }
+    if ( !Calamares::Settings::instance() || !Calamares::Settings::instance()->isValid() )
+    {
+        cError() << "Calamares has invalid settings, shutting down.";
+        return 78;  // EX_CONFIG on FreeBSD
+    }
+
+    auto* queue = new Calamares::JobQueue( &a );
+    new CalamaresUtils::System( Calamares::Settings::instance()->doChroot(), &a );
+    const QString jobTimings = Calamares::Settings::instance()->jobTimingsFile();
+    if ( !jobTimings.isEmpty() )
+    {
+        queue->loadTimingProfile( jobTimings );
+    }
+    const QString checkpoints = Calamares::Settings::instance()->jobCheckpointDirectory();
+    if ( !checkpoints.isEmpty() )
+    {
+        queue->setCheckpointDirectory( checkpoints );
+    }
+    queue->setTuning(
+        CalamaresUtils::SystemTuning::Profile::fromMap( Calamares::Settings::instance()->execTuning() ) );
+
+    auto* gs = queue->globalStorage();
+    for ( const auto& path : config.m_globalYaml )
+    {
+        if ( !gs->loadYaml( path ) )
+        {
+            cError() << "Could not load global storage from" << path;
+            return 1;
+        }
+    }
+    for ( const auto& path : config.m_globalJson )
+    {
+        if ( !gs->loadJson( path ) )
+        {
+            cError() << "Could not load global storage from" << path;
+            return 1;
+        }
+    }
+
+    bool failed = false;
+    QObject::connect( queue, &Calamares::JobQueue::progress, &a, [ &config ]( qreal percent, const QString& message ) {
+        report( config, QJsonObject { { "event", "progress" }, { "percent", percent }, { "message", message } } );
+    } );
+    QObject::connect( queue,
+                      &Calamares::JobQueue::failed,
+                      &a,
+                      [ &config, &failed ]( const QString& message, const QString& details ) {
+                          failed = true;
+                          report( config,
+                                  QJsonObject {
+                                      { "event", "failed" }, { "message", message }, { "details", details } } );
+                      } );
+    QObject::connect( queue, &Calamares::JobQueue::jobSlow, &a, [ &config ]( const QString& name, int seconds ) {
+        if ( !name.isEmpty() )
+        {
+            report( config, QJsonObject { { "event", "slow" }, { "job", name }, { "seconds", seconds } } );
+        }
+    } );
+    QObject::connect( queue, &Calamares::JobQueue::finished, &a, [ &config, &failed, &a ]() {
+        report( config, QJsonObject { { "event", "finished" }, { "ok", !failed } } );
+        a.exit( failed ? 1 : 0 );
+    } );
+
+    auto* moduleManager = new Calamares::ModuleManager( Calamares::Settings::instance()->modulesSearchPaths(), &a );
+    QObject::connect( moduleManager, &Calamares::ModuleManager::initDone, &a, [ &config, moduleManager, &a ]() {
+        const int exitCode = start_jobs( config, moduleManager );
+        if ( exitCode )
+        {
+            a.exit( exitCode );
+        }
+    } );
+    moduleManager->init();
+
+    return a.exec();
+}
@@ -11,10 +11,17 @@
 
 #include "CalamaresApplication.h"
 
+#include "CalamaresConfig.h"
 #include "Settings.h"
 #include "utils/Dirs.h"
 #include "utils/Logger.h"
 #include "utils/Retranslator.h"
+#include "utils/Trace.h"
+#include "utils/Yaml.h"
+
+#ifdef WITH_PYTHON
+#include "PythonJob.h"
+#endif
 
 #ifndef WITH_KF5DBus
 #include "3rdparty/kdsingleapplicationguard/kdsingleapplicationguard.h"
@@ -78,6 +85,19 @@ handle_args( CalamaresApplication& a )
     QCommandLineOption configOption(
         QStringList { "c", "config" }, "Configuration directory to use, for testing purposes.", "config" );
     QCommandLineOption xdgOption( QStringList { "X", "xdg-config" }, "Use XDG_{CONFIG,DATA}_DIRS as well." );
+    QCommandLineOption yamlCacheOption(
+        QStringLiteral( "yaml-cache" ), "Use pre-parsed YAML files from the given cache file.", "file" );
+    QCommandLineOption generateYamlCacheOption(
+        QStringLiteral( "generate-yaml-cache" ),
+        "Load all the modules, then write the given YAML cache file and exit.",
+        "file" );
+    QCommandLineOption traceOption( QStringLiteral( "trace-startup" ),
+                                    "Write a trace (Chrome trace-event JSON) of startup to the log directory." );
+    QCommandLineOption structuredLogOption( QStringLiteral( "structured-log" ),
+                                            "Also write a machine-readable (JSON lines) log." );
+    QCommandLineOption profilePythonOption(
+        QStringLiteral( "profile-python" ),
+        "Profile the Python modules, writing collapsed stacks (for flame graphs) to the log directory." );
 
     QCommandLineParser parser;
     parser.setApplicationDescription( "Distribution-independent installer framework" );
@@ -89,6 +109,13 @@ handle_args( CalamaresApplication& a )
     parser.addOption( configOption );
     parser.addOption( xdgOption );
     parser.addOption( debugTxOption );
+    parser.addOption( structuredLogOption );
+    parser.addOption( traceOption );
+#ifdef WITH_PYTHON
+    parser.addOption( profilePythonOption );
+#endif
+    parser.addOption( yamlCacheOption );
+    parser.addOption( generateYamlCacheOption );
 
     parser.process( a );
 
@@ -102,6 +129,30 @@ handle_args( CalamaresApplication& a )
         CalamaresUtils::setXdgDirs();
     }
     CalamaresUtils::setAllowLocalTranslation( parser.isSet( debugOption ) || parser.isSet( debugTxOption ) );
+    if ( parser.isSet( traceOption ) )
+    {
+        CalamaresUtils::Trace::enable( CalamaresUtils::appLogDir().filePath( "startup-trace.json" ) );
+    }
+    if ( parser.isSet( structuredLogOption ) )
+    {
+        Logger::setupStructuredLog();
+    }
+#ifdef WITH_PYTHON
+    if ( parser.isSet( profilePythonOption ) )
+    {
+        Calamares::PythonJob::setProfileDirectory( CalamaresUtils::appLogDir().absolutePath() );
+    }
+#endif
+    if ( parser.isSet( generateYamlCacheOption ) )
+    {
+        // Start from an empty cache, so that everything is parsed fresh
+        CalamaresUtils::loadYamlCache( QString() );
+        a.setGenerateYamlCache( parser.value( generateYamlCacheOption ) );
+    }
+    else if ( parser.isSet( yamlCacheOption ) )
+    {
+        CalamaresUtils::loadYamlCache( parser.value( yamlCacheOption ) );
+    }
 
     return parser.isSet( debugOption );
 }
@@ -155,7 +206,10 @@ main( int argc, char* argv[] )
     }
 #endif
 
-    Calamares::Settings::init( is_debug );
+    {
+        CalamaresUtils::Trace::Span span( "Settings::init" );
+        Calamares::Settings::init( is_debug );
+    }
     if ( !Calamares::Settings::instance() || !Calamares::Settings::instance()->isValid() )
     {
         qCritical() << "Calamares has invalid settings, shutting down.";
@@ -91,34 +91,36 @@ ProgressTreeDelegate::paintViewStep( QPainter* painter,
         }
     }
 
+    const QString text = index.data().toString();
+    font.setPointSize( fittedFontSize( font, text, textRect.width() ) );
+    painter->setFont( font );
+    painter->fillRect( option.rect, painter->brush().color() );
+    painter->drawText( textRect, Qt::AlignHCenter | Qt::AlignVCenter | Qt::TextSingleLine, text );
+}
 
-    // Draw the text at least once. If it doesn't fit, then shrink the font
-    // being used by 1 pt on each iteration, up to a maximum of maximumShrink
-    // times. On each loop, we'll have to blank out the rectangle again, so this
-    // is an expensive (in terms of drawing operations) thing to do.
-    //
-    // (The loop uses <= because the counter is incremented at the start).
-    static constexpr int const maximumShrink = 4;
-    int shrinkSteps = 0;
-    do
+int
+ProgressTreeDelegate::fittedFontSize( QFont font, const QString& text, int width ) const
+{
+    const auto key = qMakePair( text, width );
+    auto it = m_fontSizes.constFind( key );
+    if ( it != m_fontSizes.constEnd() )
     {
-        painter->fillRect( option.rect, painter->brush().color() );
-        shrinkSteps++;
-
-        QRectF boundingBox;
-        painter->drawText(
-            textRect, Qt::AlignHCenter | Qt::AlignVCenter | Qt::TextSingleLine, index.data().toString(), &boundingBox );
+        return it.value();
+    }
 
-        // The extra check here is to avoid the changing-font-size if we're not going to use
-        // it in the next iteration of the loop anyway.
-        if ( ( shrinkSteps <= maximumShrink ) && ( boundingBox.width() > textRect.width() ) )
-        {
-            font.setPointSize( item_fontsize() - shrinkSteps );
-            painter->setFont( font );
-        }
-        else
+    // If the text doesn't fit, then shrink the font by 1 pt on each
+    // iteration, up to a maximum of maximumShrink times.
+    static constexpr int const maximumShrink = 4;
+    int pointSize = item_fontsize();
+    for ( int shrinkSteps = 0; shrinkSteps <= maximumShrink; ++shrinkSteps )
+    {
+        pointSize = item_fontsize() - shrinkSteps;
+        font.setPointSize( pointSize );
+        if ( QFontMetrics( font ).boundingRect( text ).width() <= width )
         {
             break;  // It fits
         }
-    } while ( shrinkSteps <= maximumShrink );
+    }
+    m_fontSizes.insert( key, pointSize );
+    return pointSize;
 }
@@ -11,6 +11,10 @@
 #ifndef PROGRESSTREEDELEGATE_H
 #define PROGRESSTREEDELEGATE_H
 
+#include <QFont>
+#include <QHash>
+#include <QPair>
+#include <QString>
 #include <QStyledItemDelegate>
 
 /**
@@ -29,6 +33,14 @@ protected:
 
 private:
     void paintViewStep( QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index ) const;
+    /** @brief Point size that makes @p text fit in @p width
+     *
+     * The results are remembered by text (so, per language) and width,
+     * so that painting a row does not have to measure it again.
+     */
+    int fittedFontSize( QFont font, const QString& text, int width ) const;
+
+    mutable QHash< QPair< QString, int >, int > m_fontSizes;
 };
 
 #endif  // PROGRESSTREEDELEGATE_H
@@ -45,12 +45,7 @@ ProgressTreeView::setModel( QAbstractItemModel* model )
         return;
     }
 
+    // The ViewManager model signals dataChanged() for the rows that
+    // change when the current step changes, so no full repaints here.
     QListView::setModel( model );
-
-    connect(
-        Calamares::ViewManager::instance(),
-        &Calamares::ViewManager::currentStepChanged,
-        this,
-        [this]() { viewport()->update(); },
-        Qt::UniqueConnection );
 }
@@ -43,11 +43,20 @@
 #include <QCommandLineOption>
 #include <QCommandLineParser>
 #include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
 #include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QLabel>
 #include <QMainWindow>
+#include <QSaveFile>
 #include <QThread>
+#include <QTimer>
 
+#include <chrono>
+#include <functional>
 #include <memory>
 
 struct ModuleConfig
@@ -56,6 +65,11 @@ struct ModuleConfig
     QString configFile() const { return m_jobConfig; }
     QString language() const { return m_language; }
     QString globalConfigFile() const { return m_globalConfig; }
+    QString globalJsonFile() const { return m_globalJson; }
+    /// @brief Where to write timings; empty if not benchmarking
+    QString benchmarkFile() const { return m_benchmark; }
+    /// @brief Where to write page-transition timings; empty if not measuring
+    QString responsivenessFile() const { return m_responsiveness; }
 
     QString m_module;
     QString m_jobConfig;
@@ -64,6 +78,11 @@ struct ModuleConfig
     QString m_branding;
     bool m_ui;
     bool m_pythonInjection;
+    QString m_globalJson;
+    QString m_benchmark;
+    /// @brief Modules (with optional ":job.yaml") to run when benchmarking
+    QStringList m_modules;
+    QString m_responsiveness;
 };
 
 static ModuleConfig
@@ -88,6 +107,16 @@ handle_args( QCoreApplication& a )
                                  QStringLiteral( "Enable UI" ) );
     QCommandLineOption slideshowOption( QStringList() << QStringLiteral( "s" ) << QStringLiteral( "slideshow" ),
                                         QStringLiteral( "Run slideshow module" ) );
+    QCommandLineOption globalJsonOption( QStringList() << QStringLiteral( "G" ) << QStringLiteral( "global-json" ),
+                                         QStringLiteral( "Global storage document (JSON, as saved by Calamares)" ),
+                                         "global.json" );
+    QCommandLineOption benchmarkOption( QStringList() << QStringLiteral( "B" ) << QStringLiteral( "benchmark" ),
+                                        QStringLiteral( "Run all the (job) modules in order, write timings to file" ),
+                                        "timings.json" );
+    QCommandLineOption responsivenessOption(
+        QStringList() << QStringLiteral( "R" ) << QStringLiteral( "responsiveness" ),
+        QStringLiteral( "Show the (view) modules in order, write page-transition timings to file" ),
+        "transitions.json" );
     QCommandLineParser parser;
     parser.setApplicationDescription( "Calamares module tester" );
     parser.addHelpOption();
@@ -100,6 +129,9 @@ handle_args( QCoreApplication& a )
     parser.addOption( brandOption );
     parser.addOption( uiOption );
     parser.addOption( slideshowOption );
+    parser.addOption( globalJsonOption );
+    parser.addOption( benchmarkOption );
+    parser.addOption( responsivenessOption );
 #ifdef WITH_PYTHON
     QCommandLineOption pythonOption( QStringList() << QStringLiteral( "P" ) << QStringLiteral( "no-injected-python" ),
                                      QStringLiteral( "Do not disable potentially-harmful Python commands" ) );
@@ -117,7 +149,7 @@ handle_args( QCoreApplication& a )
         cError() << "Missing <module> path.\n";
         parser.showHelp();
     }
-    else if ( args.size() > 2 )
+    else if ( args.size() > 2 && !parser.isSet( benchmarkOption ) && !parser.isSet( responsivenessOption ) )
     {
         cError() << "More than one <module> path.\n";
         parser.showHelp();
@@ -137,14 +169,22 @@ handle_args( QCoreApplication& a )
             pythonInjection = false;
         }
 #endif
+        if ( parser.isSet( benchmarkOption ) || parser.isSet( responsivenessOption ) )
+        {
+            // All the positional arguments are modules
+            jobSettings.clear();
+        }
         return ModuleConfig { parser.isSet( slideshowOption ) ? QStringLiteral( "-" ) : args.first(),
                               jobSettings,
                               parser.value( globalOption ),
                               parser.value( langOption ),
                               parser.value( brandOption ),
                               parser.isSet( slideshowOption ) || parser.isSet( uiOption ),
-                              pythonInjection
-        };
+                              pythonInjection,
+                              parser.value( globalJsonOption ),
+                              parser.value( benchmarkOption ),
+                              args,
+                              parser.value( responsivenessOption ) };
     }
 }
 
@@ -365,6 +405,12 @@ is_slideshow_option( const char* s )
     return !qstrcmp( s, "--slideshow" ) || !qstrcmp( s, "-s" );
 }
 
+static bool
+is_responsiveness_option( const char* s )
+{
+    return !qstrcmp( s, "--responsiveness" ) || !qstrcmp( s, "-R" );
+}
+
 /** @brief Create the right kind of QApplication
  *
  * Does primitive parsing of argv[] to find the --ui option and returns
@@ -379,7 +425,12 @@ createApplication( int& argc, char* argv[] )
 {
     for ( int i = 1; i < argc; ++i )
     {
-        if ( is_slideshow_option( argv[ i ] ) || is_ui_option( argv[ i ] ) )
+        if ( is_responsiveness_option( argv[ i ] ) && qEnvironmentVariableIsEmpty( "QT_QPA_PLATFORM" ) )
+        {
+            // Measuring does not need a screen; the pages are still laid out and painted
+            qputenv( "QT_QPA_PLATFORM", "offscreen" );
+        }
+        if ( is_slideshow_option( argv[ i ] ) || is_ui_option( argv[ i ] ) || is_responsiveness_option( argv[ i ] ) )
         {
             auto* aw = new QApplication( argc, argv );
             aw->setQuitOnLastWindowClosed( true );
@@ -429,6 +480,295 @@ libcalamares.utils.debug('pre-script for testing purposes injected')
 )%";
 #endif
 
+/** @brief Runs the jobs of all the modules in @p config, with timings
+ *
+ * The modules are loaded and their jobs are run in the order given,
+ * like the exec phase of Calamares does; as there, the first failing
+ * job stops the run. View modules are skipped,
+ * since their jobs depend on what is done in the UI. The time each
+ * job takes, and the total time, are written to the benchmark file
+ * as JSON. Returns the process exit code.
+ */
+static int
+run_benchmark( const ModuleConfig& config )
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration< double, std::milli >;
+
+    QJsonArray modules;
+    bool failed = false;
+    const auto start = Clock::now();
+    for ( const QString& entry : config.m_modules )
+    {
+        if ( failed )
+        {
+            break;
+        }
+
+        // A module may be followed by :job.yaml for its configuration
+        ModuleConfig moduleConfig = config;
+        const int colon = entry.indexOf( ':' );
+        moduleConfig.m_module = colon > 0 ? entry.left( colon ) : entry;
+        moduleConfig.m_jobConfig = colon > 0 ? entry.mid( colon + 1 ) : QString();
+
+        const auto loadStart = Clock::now();
+        std::unique_ptr< Calamares::Module > m( load_module( moduleConfig ) );
+        if ( !m )
+        {
+            cError() << "Could not load module" << moduleConfig.moduleName();
+            return 1;
+        }
+        if ( m->type() == Calamares::Module::Type::View )
+        {
+            cWarning() << "Skipping view module" << m->name();
+            continue;
+        }
+        m->loadSelf();
+        if ( !m->isLoaded() )
+        {
+            cError() << "Module" << moduleConfig.moduleName() << "could not be loaded.";
+            return 1;
+        }
+        const Calamares::JobList jobList = m->jobs();
+        const Milliseconds loadTime = Clock::now() - loadStart;
+
+        QJsonArray jobs;
+        for ( const auto& p : jobList )
+        {
+            cDebug() << "Benchmark" << m->name() << "job" << p->prettyName();
+            const auto jobStart = Clock::now();
+            const Calamares::JobResult r = p->exec();
+            const Milliseconds jobTime = Clock::now() - jobStart;
+            jobs.append( QJsonObject { { "name", p->prettyName() },
+                                       { "ms", jobTime.count() },
+                                       { "ok", bool( r ) } } );
+            if ( !r )
+            {
+                cError() << "Job" << p->prettyName() << "failed" << r.message() << r.details();
+                failed = true;
+                break;
+            }
+        }
+        modules.append( QJsonObject { { "module", m->name() }, { "load-ms", loadTime.count() }, { "jobs", jobs } } );
+    }
+    const Milliseconds total = Clock::now() - start;
+
+    QJsonObject results { { "modules", modules }, { "total-ms", total.count() }, { "ok", !failed } };
+    // Not a half-written file, which a later comparison would read
+    QSaveFile f( config.benchmarkFile() );
+    if ( !f.open( QIODevice::WriteOnly ) || f.write( QJsonDocument( results ).toJson() ) < 0 || !f.commit() )
+    {
+        cError() << "Could not write benchmark results to" << config.benchmarkFile();
+        return 1;
+    }
+    cDebug() << "Benchmark total" << total.count() << "ms" << ( failed ? "(failed)" : "" );
+    return failed ? 1 : 0;
+}
+
+/** @brief Watches the event loop for stalls
+ *
+ * A timer fires every few milliseconds; when the time between two
+ * timeouts is much longer than that, the event loop was busy (or
+ * blocked) in between. Each such gap is a stall. At 60 frames per
+ * second, a stall of N frame-times means N-1 frames were not drawn.
+ */
+class StallMonitor : public QObject
+{
+public:
+    static constexpr int intervalMs = 4;
+    static constexpr int stallMs = 50;  ///< Gaps shorter than this are not stalls
+    static constexpr double frameMs = 1000.0 / 60;
+
+    explicit StallMonitor( QObject* parent )
+        : QObject( parent )
+    {
+        m_timer.setTimerType( Qt::PreciseTimer );
+        m_timer.setInterval( intervalMs );
+        connect( &m_timer, &QTimer::timeout, this, &StallMonitor::tick );
+    }
+
+    /// @brief Forgets the stalls so far, and starts watching
+    void start()
+    {
+        m_stalls = QJsonArray();
+        m_longest = 0;
+        m_droppedFrames = 0;
+        m_last.start();
+        m_timer.start();
+    }
+    /// @brief Stops watching; the gap up to now counts as well
+    void stop()
+    {
+        tick();
+        m_timer.stop();
+    }
+
+    QJsonArray stalls() const { return m_stalls; }
+    qint64 longest() const { return m_longest; }
+    int droppedFrames() const { return m_droppedFrames; }
+
+private:
+    void tick()
+    {
+        const qint64 gap = m_last.restart();
+        if ( gap >= stallMs )
+        {
+            m_stalls.append( gap );
+            m_longest = qMax( m_longest, gap );
+            m_droppedFrames += int( gap / frameMs ) - 1;
+        }
+    }
+
+    QTimer m_timer;
+    QElapsedTimer m_last;
+    QJsonArray m_stalls;
+    qint64 m_longest = 0;
+    int m_droppedFrames = 0;
+};
+
+/** @brief Runs the event loop for @p ms milliseconds */
+static void
+settle( int ms )
+{
+    QEventLoop loop;
+    QTimer::singleShot( ms, &loop, &QEventLoop::quit );
+    loop.exec();
+}
+
+/** @brief Shows the view modules in @p config, with transition timings
+ *
+ * The modules are loaded as view steps in the order given (each may be
+ * followed by ":job.yaml"), shown in a window (offscreen, unless
+ * QT_QPA_PLATFORM says otherwise), and the ViewManager is driven
+ * with next() to the last page and then back() to the first. For each
+ * transition, the time the call takes and the event-loop stalls until
+ * the page has settled are written to the results file as JSON.
+ *
+ * A page where next is not enabled (e.g. the users page without a
+ * user name) ends the forward run; preload global storage with
+ * --global-json to get past such pages. Returns the process exit code.
+ */
+static int
+run_responsiveness( const ModuleConfig& config, QMainWindow* mw )
+{
+    static constexpr int settleMs = 500;
+
+    (void)new Calamares::Branding( config.m_branding );
+    auto* modulemanager = new Calamares::ModuleManager( QStringList(), nullptr );
+    auto* vm = Calamares::ViewManager::instance( mw );
+
+    QJsonArray loads;
+    for ( const QString& entry : config.m_modules )
+    {
+        ModuleConfig moduleConfig = config;
+        const int colon = entry.indexOf( ':' );
+        moduleConfig.m_module = colon > 0 ? entry.left( colon ) : entry;
+        moduleConfig.m_jobConfig = colon > 0 ? entry.mid( colon + 1 ) : QString();
+
+        QElapsedTimer loadTimer;
+        loadTimer.start();
+        Calamares::Module* m = load_module( moduleConfig );
+        if ( !m )
+        {
+            cError() << "Could not load module" << moduleConfig.moduleName();
+            return 1;
+        }
+        if ( m->type() != Calamares::Module::Type::View )
+        {
+            cWarning() << "Skipping job module" << m->name();
+            delete m;
+            continue;
+        }
+        modulemanager->addModule( m );
+        m->loadSelf();
+        if ( !m->isLoaded() )
+        {
+            cError() << "Module" << moduleConfig.moduleName() << "could not be loaded.";
+            return 1;
+        }
+        loads.append( QJsonObject { { "module", m->name() }, { "load-ms", loadTimer.elapsed() } } );
+    }
+    if ( vm->viewSteps().isEmpty() )
+    {
+        cError() << "No view modules to show.";
+        return 1;
+    }
+
+    vm->onInitComplete();
+    mw->setCentralWidget( vm->centralWidget() );
+    mw->show();
+    settle( settleMs );
+
+    StallMonitor monitor( nullptr );
+    QJsonArray transitions;
+    auto measure = [ & ]( const char* direction, const std::function< void() >& f ) {
+        const int from = vm->currentStepIndex();
+        const QString fromName = vm->currentStep() ? vm->currentStep()->prettyName() : QString();
+        monitor.start();
+        QElapsedTimer callTimer;
+        callTimer.start();
+        f();
+        const qint64 callMs = callTimer.elapsed();
+        settle( settleMs );
+        monitor.stop();
+        const QString toName = vm->currentStep() ? vm->currentStep()->prettyName() : QString();
+        cDebug() << "Transition" << direction << fromName << "->" << toName << callMs << "ms";
+        transitions.append( QJsonObject { { "direction", direction },
+                                          { "from", fromName },
+                                          { "from-index", from },
+                                          { "to", toName },
+                                          { "to-index", vm->currentStepIndex() },
+                                          { "ms", callMs },
+                                          { "stalls-ms", monitor.stalls() },
+                                          { "longest-stall-ms", monitor.longest() },
+                                          { "dropped-frames", monitor.droppedFrames() } } );
+    };
+
+    // Pages with sub-pages (e.g. partitioning) also take next() and back()
+    // without moving to another step; give up on a page after a few of those.
+    static constexpr int maxSubPages = 8;
+    const int last = vm->viewSteps().count() - 1;
+    bool blocked = false;
+    int stuck = 0;
+    while ( vm->currentStepIndex() < last )
+    {
+        if ( !vm->nextEnabled() || stuck >= maxSubPages )
+        {
+            cWarning() << "Can not go next from" << vm->currentStep()->prettyName();
+            blocked = true;
+            break;
+        }
+        const int before = vm->currentStepIndex();
+        measure( "next", [ vm ]() { vm->next(); } );
+        stuck = vm->currentStepIndex() == before ? stuck + 1 : 0;
+    }
+    stuck = 0;
+    while ( vm->currentStepIndex() > 0 )
+    {
+        if ( !vm->backEnabled() || stuck >= maxSubPages )
+        {
+            cWarning() << "Can not go back from" << vm->currentStep()->prettyName();
+            blocked = true;
+            break;
+        }
+        const int before = vm->currentStepIndex();
+        measure( "back", [ vm ]() { vm->back(); } );
+        stuck = vm->currentStepIndex() == before ? stuck + 1 : 0;
+    }
+
+    QJsonObject results { { "modules", loads },
+                          { "transitions", transitions },
+                          { "blocked", blocked },
+                          { "platform", QGuiApplication::platformName() } };
+    QSaveFile f( config.responsivenessFile() );
+    if ( !f.open( QIODevice::WriteOnly ) || f.write( QJsonDocument( results ).toJson() ) < 0 || !f.commit() )
+    {
+        cError() << "Could not write transition timings to" << config.responsivenessFile();
+        return 1;
+    }
+    return 0;
+}
+
 int
 main( int argc, char* argv[] )
 {
@@ -451,6 +791,11 @@ main( int argc, char* argv[] )
     {
         gs->loadYaml( module.globalConfigFile() );
     }
+    if ( !module.globalJsonFile().isEmpty() && !gs->loadJson( module.globalJsonFile() ) )
+    {
+        cError() << "Could not load global storage from" << module.globalJsonFile();
+        return 1;
+    }
     if ( !module.language().isEmpty() )
     {
         QVariantMap vm;
@@ -468,6 +813,22 @@ main( int argc, char* argv[] )
     CalamaresUtils::initQmlModulesDir();  // don't care if failed
 #endif
 
+    if ( !module.benchmarkFile().isEmpty() )
+    {
+        const int r = run_benchmark( module );
+        delete aw;
+        return r;
+    }
+    if ( !module.responsivenessFile().isEmpty() )
+    {
+        mw = new QMainWindow();
+        mw->installEventFilter( CalamaresUtils::Retranslator::instance() );
+        const int r = run_responsiveness( module, mw );
+        delete mw;
+        delete aw;
+        return r;
+    }
+
     cDebug() << "Calamares module-loader testing" << module.moduleName();
     Calamares::Module* m = load_module( module );
     if ( !m )
@@ -0,0 +1,321 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+/** @file Benchmarks for the hot paths in libcalamares
+ *
+ * These are not correctness tests (see the various Tests.cpp for those),
+ * although each benchmark checks that it computed something sensible.
+ * Run them through `ci/benchmarks.py` to get the results as JSON,
+ * or to compare them with an earlier run.
+ */
+
+#include "GlobalStorage.h"
+#include "locale/TimeZone.h"
+#include "locale/TranslationsModel.h"
+#include "utils/Entropy.h"
+#include "utils/Logger.h"
+#include "utils/String.h"
+#include "utils/Yaml.h"
+
+#include <QtTest/QtTest>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+class LibCalamaresBenchmarks : public QObject
+{
+    Q_OBJECT
+public:
+    LibCalamaresBenchmarks() {}
+    ~LibCalamaresBenchmarks() override {}
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void benchYamlToVariant_data();
+    void benchYamlToVariant();
+
+    void benchRemoveDiacritics();
+    void benchRemoveDiacriticsTyping();
+    void benchObscure();
+    void benchTruncateMultiLine();
+
+    void benchLoggerEnabled();
+    void benchLoggerDisabled();
+
+    void benchGlobalStorage_data();
+    void benchGlobalStorage();
+
+    void benchZonesByName();
+    void benchZonesByLocation();
+
+    void benchTranslationByLocale();
+    void benchTranslationByCountry();
+
+    void benchEntropy_data();
+    void benchEntropy();
+};
+
+void
+LibCalamaresBenchmarks::initTestCase()
+{
+    Logger::setupLogLevel( Logger::LOGWARNING );
+}
+
+void
+LibCalamaresBenchmarks::benchYamlToVariant_data()
+{
+    QTest::addColumn< int >( "groups" );
+
+    QTest::newRow( "small" ) << 10;
+    QTest::newRow( "large" ) << 1000;
+}
+
+void
+LibCalamaresBenchmarks::benchYamlToVariant()
+{
+    QFETCH( int, groups );
+
+    // Mappings, sequences and all the kinds of scalars
+    std::string yaml;
+    for ( int g = 0; g < groups; ++g )
+    {
+        yaml += "- name: \"Group " + std::to_string( g ) + "\"\n";
+        yaml += "  weight: " + std::to_string( g ) + "\n  ratio: 0.5\n  selected: on\n  packages:\n";
+        for ( int p = 0; p < 10; ++p )
+        {
+            yaml += "    - package-" + std::to_string( p ) + "\n";
+        }
+    }
+    const YAML::Node doc = YAML::Load( yaml );
+
+    QVariant v;
+    QBENCHMARK
+    {
+        v = CalamaresUtils::yamlToVariant( doc );
+    }
+    QCOMPARE( v.toList().count(), groups );
+}
+
+void
+LibCalamaresBenchmarks::benchRemoveDiacritics()
+{
+    const QString s = QStringLiteral( "Ærøskøbing, Besançon, Kraków, Malmö and Zürich in Straße" );
+    QString r;
+    QBENCHMARK
+    {
+        r = CalamaresUtils::removeDiacritics( s );
+    }
+    QVERIFY( r.startsWith( "AEr" ) );
+}
+
+void
+LibCalamaresBenchmarks::benchRemoveDiacriticsTyping()
+{
+    // Like the users page, which does this for each keystroke in the full name
+    const QString s = QStringLiteral( "Stanisław Żółkiewski-Ørsted Ðurđević Şahin Wałęsa" );
+    int length = 0;
+    QBENCHMARK
+    {
+        length = 0;
+        for ( int i = 1; i <= s.length(); ++i )
+        {
+            length += CalamaresUtils::removeDiacritics( s.left( i ) ).length();
+        }
+    }
+    QVERIFY( length > s.length() );
+}
+
+void
+LibCalamaresBenchmarks::benchObscure()
+{
+    const QString s = QStringLiteral( "correct horse battery staple" );
+    QString r;
+    QBENCHMARK
+    {
+        r = CalamaresUtils::obscure( CalamaresUtils::obscure( s ) );
+    }
+    QCOMPARE( r, s );
+}
+
+void
+LibCalamaresBenchmarks::benchTruncateMultiLine()
+{
+    // Something like the output of a failed command
+    QString s;
+    for ( int i = 0; i < 500; ++i )
+    {
+        s.append( QStringLiteral( "Line %1 of the output of some command that failed\n" ).arg( i ) );
+    }
+
+    QString r;
+    QBENCHMARK
+    {
+        r = CalamaresUtils::truncateMultiLine( s );
+    }
+    QVERIFY( r.length() < s.length() );
+}
+
+void
+LibCalamaresBenchmarks::benchLoggerEnabled()
+{
+    Logger::setupLogLevel( Logger::LOGDEBUG );
+    int i = 0;
+    QBENCHMARK
+    {
+        cDebug() << "Benchmark message" << ++i << QStringLiteral( "with a QString" );
+    }
+    Logger::flush();
+    Logger::setupLogLevel( Logger::LOGWARNING );
+    QVERIFY( i > 0 );
+}
+
+void
+LibCalamaresBenchmarks::benchLoggerDisabled()
+{
+    int evaluated = 0;
+    QBENCHMARK
+    {
+        cDebug() << "Benchmark message" << ++evaluated;
+    }
+    QCOMPARE( evaluated, 0 );
+}
+
+void
+LibCalamaresBenchmarks::benchGlobalStorage_data()
+{
+    QTest::addColumn< int >( "readers" );
+
+    QTest::newRow( "alone" ) << 0;
+    QTest::newRow( "contended" ) << 4;
+}
+
+void
+LibCalamaresBenchmarks::benchGlobalStorage()
+{
+    QFETCH( int, readers );
+
+    Calamares::GlobalStorage gs;
+    for ( int i = 0; i < 100; ++i )
+    {
+        gs.insert( QStringLiteral( "key%1" ).arg( i ), i );
+    }
+
+    // Other threads read while this one writes, like the jobs
+    // do while the UI updates settings.
+    std::atomic< bool > done { false };
+    std::vector< std::thread > threads;
+    for ( int t = 0; t < readers; ++t )
+    {
+        threads.emplace_back( [ &gs, &done, t ]() {
+            const QString key = QStringLiteral( "key%1" ).arg( t );
+            while ( !done )
+            {
+                (void)gs.value( key );
+            }
+        } );
+    }
+
+    const QString key = QStringLiteral( "key50" );
+    int i = 0;
+    QBENCHMARK
+    {
+        gs.insert( key, ++i );
+        (void)gs.value( key );
+    }
+
+    done = true;
+    for ( auto& t : threads )
+    {
+        t.join();
+    }
+    QCOMPARE( gs.value( key ).toInt(), i );
+}
+
+void
+LibCalamaresBenchmarks::benchZonesByName()
+{
+    const CalamaresUtils::Locale::ZonesModel zones;
+    const CalamaresUtils::Locale::TimeZoneData* zone = nullptr;
+    QBENCHMARK
+    {
+        zone = zones.find( QStringLiteral( "Europe" ), QStringLiteral( "Amsterdam" ) );
+    }
+    QVERIFY( zone );
+}
+
+void
+LibCalamaresBenchmarks::benchZonesByLocation()
+{
+    const CalamaresUtils::Locale::ZonesModel zones;
+    const CalamaresUtils::Locale::TimeZoneData* zone = nullptr;
+    QBENCHMARK
+    {
+        zone = zones.find( -26.15, 28.00 );
+    }
+    QVERIFY( zone );
+    QCOMPARE( zone->zone(), QStringLiteral( "Johannesburg" ) );
+}
+
+void
+LibCalamaresBenchmarks::benchTranslationByLocale()
+{
+    const auto* translations = CalamaresUtils::Locale::availableTranslations();
+    const QLocale locale( QStringLiteral( "nl_NL" ) );
+    int row = -1;
+    QBENCHMARK
+    {
+        row = translations->find( locale );
+    }
+    QVERIFY( row >= 0 );
+}
+
+void
+LibCalamaresBenchmarks::benchTranslationByCountry()
+{
+    const auto* translations = CalamaresUtils::Locale::availableTranslations();
+    int row = -1;
+    QBENCHMARK
+    {
+        row = translations->find( QStringLiteral( "DE" ) );
+    }
+    QVERIFY( row >= 0 );
+}
+
+void
+LibCalamaresBenchmarks::benchEntropy_data()
+{
+    QTest::addColumn< int >( "size" );
+
+    QTest::newRow( "salt" ) << 16;
+    QTest::newRow( "keyfile" ) << 2048;
+}
+
+void
+LibCalamaresBenchmarks::benchEntropy()
+{
+    QFETCH( int, size );
+
+    QByteArray data;
+    CalamaresUtils::EntropySource source = CalamaresUtils::EntropySource::None;
+    QBENCHMARK
+    {
+        source = CalamaresUtils::getEntropy( size, data );
+    }
+    QVERIFY( source != CalamaresUtils::EntropySource::None );
+    QCOMPARE( data.size(), size );
+}
+
+QTEST_GUILESS_MAIN( LibCalamaresBenchmarks )
+
+#include "utils/moc-warnings.h"
+
+#include "Benchmarks.moc"
@@ -12,38 +12,55 @@
 #include "GlobalStorage.h"
 
 #include "utils/Logger.h"
-#include "utils/Units.h"
 #include "utils/Yaml.h"
 
+#include <QDataStream>
 #include <QFile>
 #include <QJsonDocument>
+#include <QLocale>
 #include <QMutexLocker>
-
-using namespace CalamaresUtils::Units;
+#include <QSaveFile>
 
 namespace Calamares
 {
 
-class GlobalStorage::ReadLock : public QMutexLocker
-{
-public:
-    ReadLock( const GlobalStorage* gs )
-        : QMutexLocker( &gs->m_mutex )
-    {
-    }
-};
-
+/** @brief Serializes writers and publishes modifications
+ *
+ * A WriteLock holds the mutex and has its own working copy of
+ * the data, which writers modify through map() and note
+ * modified keys with touch(). When the lock goes out of scope,
+ * the working copy is published as the new version of the data,
+ * and then -- after releasing the mutex, so that slots may
+ * access the storage again -- the change signals are emitted.
+ */
 class GlobalStorage::WriteLock : public QMutexLocker
 {
 public:
     WriteLock( GlobalStorage* gs )
         : QMutexLocker( &gs->m_mutex )
         , m_gs( gs )
+        , m_map( *gs->snapshot() )
     {
     }
-    ~WriteLock() { m_gs->changed(); }
+    ~WriteLock()
+    {
+        std::atomic_store( &m_gs->m_map, std::make_shared< const QVariantMap >( std::move( m_map ) ) );
+        m_gs->m_version++;
+        unlock();
+        for ( const auto& k : m_keys )
+        {
+            m_gs->keyChanged( k );
+        }
+        m_gs->changed();
+    }
+
+    QVariantMap& map() { return m_map; }
+    void touch( const QString& key ) { m_keys.append( key ); }
 
+private:
     GlobalStorage* m_gs;
+    QVariantMap m_map;
+    QStringList m_keys;
 };
 
 GlobalStorage::GlobalStorage( QObject* parent )
@@ -55,16 +72,14 @@ GlobalStorage::GlobalStorage( QObject* parent )
 bool
 GlobalStorage::contains( const QString& key ) const
 {
-    ReadLock l( this );
-    return m.contains( key );
+    return snapshot()->contains( key );
 }
 
 
 int
 GlobalStorage::count() const
 {
-    ReadLock l( this );
-    return m.count();
+    return snapshot()->count();
 }
 
 
@@ -72,15 +87,15 @@ void
 GlobalStorage::insert( const QString& key, const QVariant& value )
 {
     WriteLock l( this );
-    m.insert( key, value );
+    l.map().insert( key, value );
+    l.touch( key );
 }
 
 
 QStringList
 GlobalStorage::keys() const
 {
-    ReadLock l( this );
-    return m.keys();
+    return snapshot()->keys();
 }
 
 
@@ -88,7 +103,11 @@ int
 GlobalStorage::remove( const QString& key )
 {
     WriteLock l( this );
-    int nItems = m.remove( key );
+    int nItems = l.map().remove( key );
+    if ( nItems )
+    {
+        l.touch( key );
+    }
     return nItems;
 }
 
@@ -96,14 +115,13 @@ GlobalStorage::remove( const QString& key )
 QVariant
 GlobalStorage::value( const QString& key ) const
 {
-    ReadLock l( this );
-    return m.value( key );
+    return snapshot()->value( key );
 }
 
 void
 GlobalStorage::debugDump() const
 {
-    ReadLock l( this );
+    const auto m = *snapshot();
     cDebug() << "GlobalStorage" << Logger::Pointer( this ) << m.count() << "items";
     for ( auto it = m.cbegin(); it != m.cend(); ++it )
     {
@@ -111,19 +129,187 @@ GlobalStorage::debugDump() const
     }
 }
 
+/// @brief Writes @p indent levels of (four-space) indentation to @p f
+static void
+writeJsonIndent( QIODevice& f, int indent )
+{
+    static const QByteArray spaces( 64, ' ' );
+    for ( int i = 4 * indent; i > 0; i -= spaces.size() )
+    {
+        f.write( spaces.constData(), qMin( i, spaces.size() ) );
+    }
+}
+
+/// @brief Writes @p s as a quoted, escaped, JSON string to @p f
+static void
+writeJsonString( QIODevice& f, const QString& s )
+{
+    const QByteArray utf8 = s.toUtf8();
+    QByteArray out;
+    out.reserve( utf8.size() + 2 );
+    out.append( '"' );
+    for ( const char c : utf8 )
+    {
+        switch ( c )
+        {
+        case '"':
+            out.append( "\\\"" );
+            break;
+        case '\\':
+            out.append( "\\\\" );
+            break;
+        case '\n':
+            out.append( "\\n" );
+            break;
+        case '\r':
+            out.append( "\\r" );
+            break;
+        case '\t':
+            out.append( "\\t" );
+            break;
+        default:
+            if ( uchar( c ) < 0x20 )
+            {
+                out.append( "\\u00" );
+                out.append( QByteArray::number( uchar( c ), 16 ).rightJustified( 2, '0' ) );
+            }
+            else
+            {
+                out.append( c );
+            }
+        }
+    }
+    out.append( '"' );
+    f.write( out );
+}
+
+static void writeJsonValue( QIODevice& f, const QVariant& v, int indent );
+
+/// @brief Writes the pairs from @p begin to @p end as a JSON object
+template < typename Iterator >
+static void
+writeJsonObject( QIODevice& f, Iterator begin, Iterator end, int indent )
+{
+    if ( begin == end )
+    {
+        f.write( "{}" );
+        return;
+    }
+    f.write( "{\n" );
+    for ( auto it = begin; it != end; )
+    {
+        writeJsonIndent( f, indent + 1 );
+        writeJsonString( f, it.key() );
+        f.write( ": " );
+        writeJsonValue( f, it.value(), indent + 1 );
+        f.write( ++it == end ? "\n" : ",\n" );
+    }
+    writeJsonIndent( f, indent );
+    f.write( "}" );
+}
+
+/** @brief Writes @p v as JSON to @p f
+ *
+ * The conversions are like the ones QJsonValue::fromVariant() does,
+ * but nothing but the current string is held in memory. Integers are
+ * written exactly; QJsonValue makes them doubles, which loses
+ * precision above 2^53.
+ */
+static void
+writeJsonValue( QIODevice& f, const QVariant& v, int indent )
+{
+    switch ( v.userType() )
+    {
+    case QMetaType::UnknownType:
+    case QMetaType::Nullptr:
+        f.write( "null" );
+        break;
+    case QMetaType::Bool:
+        f.write( v.toBool() ? "true" : "false" );
+        break;
+    case QMetaType::Int:
+    case QMetaType::Long:
+    case QMetaType::LongLong:
+    case QMetaType::Short:
+        f.write( QByteArray::number( v.toLongLong() ) );
+        break;
+    case QMetaType::UInt:
+    case QMetaType::ULong:
+    case QMetaType::ULongLong:
+    case QMetaType::UShort:
+        f.write( QByteArray::number( v.toULongLong() ) );
+        break;
+    case QMetaType::Float:
+    case QMetaType::Double:
+    {
+        const double d = v.toDouble();
+        // JSON has no NaN or infinity, QJsonValue makes them null
+        f.write( qIsFinite( d ) ? QByteArray::number( d, 'g', QLocale::FloatingPointShortest ) : "null" );
+        break;
+    }
+    case QMetaType::QVariantMap:
+    {
+        const QVariantMap m = v.toMap();
+        writeJsonObject( f, m.cbegin(), m.cend(), indent );
+        break;
+    }
+    case QMetaType::QVariantHash:
+    {
+        // Sorted, as a QJsonObject would be
+        const QVariantHash h = v.toHash();
+        QVariantMap m;
+        for ( auto it = h.cbegin(); it != h.cend(); ++it )
+        {
+            m.insert( it.key(), it.value() );
+        }
+        writeJsonObject( f, m.cbegin(), m.cend(), indent );
+        break;
+    }
+    case QMetaType::QVariantList:
+    case QMetaType::QStringList:
+    {
+        const QVariantList l = v.toList();
+        if ( l.isEmpty() )
+        {
+            f.write( "[]" );
+            break;
+        }
+        f.write( "[\n" );
+        for ( int i = 0; i < l.count(); ++i )
+        {
+            writeJsonIndent( f, indent + 1 );
+            writeJsonValue( f, l.at( i ), indent + 1 );
+            f.write( i + 1 < l.count() ? ",\n" : "\n" );
+        }
+        writeJsonIndent( f, indent );
+        f.write( "]" );
+        break;
+    }
+    default:
+        if ( v.canConvert< QString >() )
+        {
+            writeJsonString( f, v.toString() );
+        }
+        else
+        {
+            f.write( "null" );
+        }
+    }
+}
+
 bool
 GlobalStorage::saveJson( const QString& filename ) const
 {
-    ReadLock l( this );
-    QFile f( filename );
-    if ( !f.open( QFile::WriteOnly ) )
+    const auto m = snapshot();
+    QSaveFile f( filename );
+    if ( !f.open( QIODevice::WriteOnly ) )
     {
         return false;
     }
 
-    f.write( QJsonDocument::fromVariant( m ).toJson() );
-    f.close();
-    return true;
+    writeJsonObject( f, m->cbegin(), m->cend(), 0 );
+    f.write( "\n" );
+    return f.commit();
 }
 
 bool
@@ -136,7 +322,7 @@ GlobalStorage::loadJson( const QString& filename )
     }
 
     QJsonParseError e;
-    QJsonDocument d = QJsonDocument::fromJson( f.read( 1_MiB ), &e );
+    QJsonDocument d = QJsonDocument::fromJson( f.readAll(), &e );
     if ( d.isNull() )
     {
         cWarning() << filename << e.errorString();
@@ -150,22 +336,74 @@ GlobalStorage::loadJson( const QString& filename )
         WriteLock l( this );
         // Do **not** use method insert() here, because it would
         //   recursively lock the mutex, leading to deadlock. Also,
-        //   that would emit changed() for each key.
+        //   that would publish a new version for each key.
         auto map = d.toVariant().toMap();
         for ( auto i = map.constBegin(); i != map.constEnd(); ++i )
         {
-            m.insert( i.key(), *i );
+            l.map().insert( i.key(), *i );
+            l.touch( i.key() );
         }
         return true;
     }
     return false;
 }
 
+static const char s_binaryMagic[] = "Calamares GlobalStorage 1";
+
+bool
+GlobalStorage::saveBinary( const QString& filename ) const
+{
+    const auto m = snapshot();
+    QSaveFile f( filename );
+    if ( !f.open( QIODevice::WriteOnly ) )
+    {
+        return false;
+    }
+    QDataStream s( &f );
+    s.setVersion( QDataStream::Qt_5_9 );
+    s << QByteArray( s_binaryMagic ) << *m;
+    return s.status() == QDataStream::Ok && f.commit();
+}
+
+bool
+GlobalStorage::loadBinary( const QString& filename )
+{
+    QFile f( filename );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        return false;
+    }
+    QDataStream s( &f );
+    s.setVersion( QDataStream::Qt_5_9 );
+    QByteArray magic;
+    s >> magic;
+    if ( magic != s_binaryMagic )
+    {
+        cWarning() << filename << "is not a GlobalStorage file.";
+        return false;
+    }
+    QVariantMap map;
+    s >> map;
+    if ( s.status() != QDataStream::Ok )
+    {
+        cWarning() << filename << "could not be read.";
+        return false;
+    }
+
+    WriteLock l( this );
+    // Like loadJson(), do not use insert() here.
+    for ( auto i = map.constBegin(); i != map.constEnd(); ++i )
+    {
+        l.map().insert( i.key(), *i );
+        l.touch( i.key() );
+    }
+    return true;
+}
+
 bool
 GlobalStorage::saveYaml( const QString& filename ) const
 {
-    ReadLock l( this );
-    return CalamaresUtils::saveYaml( filename, m );
+    return CalamaresUtils::saveYaml( filename, *snapshot() );
 }
 
 bool
@@ -178,10 +416,11 @@ GlobalStorage::loadYaml( const QString& filename )
         WriteLock l( this );
         // Do **not** use method insert() here, because it would
         //   recursively lock the mutex, leading to deadlock. Also,
-        //   that would emit changed() for each key.
+        //   that would publish a new version for each key.
         for ( auto i = map.constBegin(); i != map.constEnd(); ++i )
         {
-            m.insert( i.key(), *i );
+            l.map().insert( i.key(), *i );
+            l.touch( i.key() );
         }
         return true;
     }
@@ -17,6 +17,9 @@
 #include <QString>
 #include <QVariantMap>
 
+#include <atomic>
+#include <memory>
+
 namespace Calamares
 {
 
@@ -41,6 +44,13 @@ namespace Calamares
  * have asynchronous tasks like GeoIP lookups, the storage itself also
  * has locking. All methods are thread-safe, use data() to make a snapshot
  * copy for use outside of the thread-safe API.
+ *
+ * The data is kept as an immutable, shared map. Readers take a reference
+ * to the current map -- an atomic operation, no mutex involved --
+ * and writers (which are serialized by a mutex) publish a modified copy.
+ * Since QVariantMap is implicitly shared, the copy shares all the
+ * unmodified values with the previous version. Each published version
+ * increments version().
  */
 class GlobalStorage : public QObject
 {
@@ -87,6 +97,10 @@ public:
      * the user module sets a slightly-obscured password in global storage,
      * and this JSON file will contain that password in-the-only-slightly-
      * obscured form.
+     *
+     * The JSON is written as it is generated, without building
+     * a document of the entire storage in memory first. The file
+     * is replaced only when all of it has been written.
      */
     bool saveJson( const QString& filename ) const;
 
@@ -111,11 +125,35 @@ public:
      */
     bool loadYaml( const QString& filename );
 
+    /** @brief write in a compact binary form to the given filename
+     *
+     * This keeps the types of the values (unlike JSON, which makes
+     * all numbers into doubles) and is much faster to load again
+     * with loadBinary(). The format is only meant for Calamares
+     * itself. See saveJson() for caveats.
+     */
+    bool saveBinary( const QString& filename ) const;
+
+    /** @brief Adds the keys from the given binary file
+     *
+     * Reads a file written by saveBinary(); otherwise like loadJson().
+     */
+    bool loadBinary( const QString& filename );
+
     /** @brief Make a complete copy of the data
      *
-     * Provides a snapshot of the data at a given time.
+     * Provides a snapshot of the data at a given time. This is
+     * cheap, since the map is implicitly shared.
+     */
+    QVariantMap data() const { return *snapshot(); }
+
+    /** @brief The current version of the store
+     *
+     * The version is incremented each time the store is modified,
+     * so comparing versions is a cheap way to find out if anything
+     * has changed since an earlier look at the store.
      */
-    QVariantMap data() const { return m; }
+    quint64 version() const { return m_version.load(); }
 
 public Q_SLOTS:
     /** @brief Does the store contain the given key?
@@ -154,12 +192,24 @@ signals:
      * is already present.
      */
     void changed();
+    /** @brief Emitted when the value for @p key changes
+     *
+     * This is emitted (once per key) after a modification of the
+     * store, before changed() is emitted. Loading from a file
+     * emits this for every key that was loaded.
+     */
+    void keyChanged( const QString& key );
 
 private:
-    class ReadLock;
     class WriteLock;
-    QVariantMap m;
-    mutable QMutex m_mutex;
+    using MapPointer = std::shared_ptr< const QVariantMap >;
+
+    /// @brief The current (immutable) data, without taking the mutex
+    MapPointer snapshot() const { return std::atomic_load( &m_map ); }
+
+    MapPointer m_map = std::make_shared< const QVariantMap >();
+    std::atomic< quint64 > m_version { 0 };
+    mutable QMutex m_mutex;  ///< Serializes writers
 };
 
 }  // namespace Calamares
@@ -9,6 +9,10 @@
 
 #include "Job.h"
 
+#include "utils/Executor.h"
+
+#include <algorithm>
+
 namespace Calamares
 {
 
@@ -109,4 +113,91 @@ Job::prettyStatusMessage() const
 }
 
 
+void
+Job::setResources( const QStringList& reads, const QStringList& writes )
+{
+    m_readResources = reads;
+    m_writeResources = writes;
+}
+
+static bool
+intersects( const QStringList& l0, const QStringList& l1 )
+{
+    return std::any_of( l0.cbegin(), l0.cend(), [&l1]( const QString& s ) { return l1.contains( s ); } );
+}
+
+bool
+Job::conflictsWith( const Job& other ) const
+{
+    if ( !hasResources() || !other.hasResources() )
+    {
+        return true;
+    }
+    return intersects( m_writeResources, other.m_readResources )
+        || intersects( m_writeResources, other.m_writeResources )
+        || intersects( m_readResources, other.m_writeResources );
+}
+
+
+bool
+Job::runsOnJobThread() const
+{
+    return false;
+}
+
+bool
+Job::isCancelled() const
+{
+    // The JobQueue sets the cancellation for the job it runs
+    return CalamaresUtils::Executor::currentCancellation().isCancelled();
+}
+
+void
+Job::beginPhase( const QString& name, qreal weight )
+{
+    m_phaseStart = m_inPhase ? qMin( 1.0, m_phaseStart + m_phaseWeight ) : 0.0;
+    m_phaseWeight = qBound( 0.0, weight, 1.0 - m_phaseStart );
+    m_phase = name;
+    m_inPhase = true;
+    emit progress( m_phaseStart );
+}
+
+void
+Job::setPhaseProgress( qreal percent )
+{
+    emit progress( overallProgress( percent ) );
+}
+
+qreal
+Job::overallProgress( qreal percent ) const
+{
+    if ( !m_inPhase )
+    {
+        return percent;
+    }
+    return m_phaseStart + m_phaseWeight * qBound( 0.0, percent, 1.0 );
+}
+
+void
+Job::clearPhases()
+{
+    m_phase = QString();
+    m_inPhase = false;
+    m_phaseStart = 0.0;
+    m_phaseWeight = 1.0;
+}
+
+void
+Job::addStatistic( const QString& key, const QVariant& value )
+{
+    m_statistics.insert( key, value );
+}
+
+void
+Job::clearStatistics()
+{
+    m_statistics.clear();
+}
+
+
 }  // namespace Calamares
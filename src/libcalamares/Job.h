@@ -16,6 +16,8 @@
 #include <QList>
 #include <QObject>
 #include <QSharedPointer>
+#include <QStringList>
+#include <QVariantMap>
 
 namespace Calamares
 {
@@ -131,11 +133,129 @@ public:
     bool isEmergency() const { return m_emergency; }
     void setEmergency( bool e ) { m_emergency = e; }
 
+    /** @brief The module instance this job comes from
+     *
+     * This is used to tag log messages from the job; it is set
+     * when the job is queued for execution and may be empty.
+     */
+    QString moduleInstance() const { return m_moduleInstance; }
+    void setModuleInstance( const QString& instance ) { m_moduleInstance = instance; }
+
+    /** @brief Resources that this job reads
+     *
+     * Resources are free-form strings, by convention either a path
+     * in the target system (e.g. "/etc/machine-id") or a GlobalStorage
+     * key prefixed with "gs:" (e.g. "gs:rootMountPoint"). The JobQueue
+     * uses these to decide which jobs can run concurrently.
+     */
+    QStringList readResources() const { return m_readResources; }
+    /// @brief Resources that this job writes (see readResources())
+    QStringList writeResources() const { return m_writeResources; }
+    /** @brief Declare what this job reads and writes
+     *
+     * A job that has not declared any resources (this is the default)
+     * is run on its own: all the jobs before it must be finished before
+     * it starts, and no job after it starts until it is done. This is
+     * the traditional, strictly-sequential behavior of the JobQueue.
+     *
+     * A job with declared resources may be run concurrently with other
+     * jobs that have declared resources, as long as they do not conflict.
+     * Two jobs conflict if one of them writes a resource that the other
+     * one reads or writes.
+     */
+    void setResources( const QStringList& reads, const QStringList& writes );
+    /// @brief Has this job declared any resources?
+    bool hasResources() const { return !m_readResources.isEmpty() || !m_writeResources.isEmpty(); }
+    /** @brief Does this job conflict with @p other?
+     *
+     * Jobs without declared resources conflict with all other jobs.
+     */
+    bool conflictsWith( const Job& other ) const;
+
+    /** @brief Must this job run on the JobQueue's own thread?
+     *
+     * Jobs may run on a worker thread when they have declared resources
+     * (see setResources()). Some jobs -- for instance, ones that use
+     * the embedded Python interpreter -- have thread-affinity requirements
+     * and need to run on the JobQueue's thread regardless. Those jobs
+     * may still run while other jobs are running on worker threads.
+     *
+     * The default implementation returns @c false.
+     */
+    virtual bool runsOnJobThread() const;
+
+    /** @brief Has the installation been cancelled?
+     *
+     * Jobs that take long should check this regularly from exec()
+     * (e.g. between steps), and return an error when it is set.
+     * Commands run through System::runCommand() are stopped already.
+     * Emergency jobs, which run after a cancellation, are never
+     * cancelled themselves.
+     */
+    bool isCancelled() const;
+
+    /** @brief Start a phase of this job
+     *
+     * A job that does its work in phases (e.g. one per image,
+     * or one per kind of operation) can report progress for each
+     * phase separately. The phase takes up @p weight (between 0 and 1)
+     * of the whole job, starting where the previous phase ended;
+     * the weights of all the phases should add up to (at most) 1.
+     * Starting a phase ends the previous one, and reports progress
+     * for the start of the phase.
+     *
+     * While a phase with a non-empty @p name is running, the name
+     * is shown as the job's status instead of prettyStatusMessage().
+     *
+     * Call this from exec(), i.e. from the thread the job runs in.
+     */
+    void beginPhase( const QString& name, qreal weight );
+    /** @brief Report progress ( between 0 and 1 ) in the current phase
+     *
+     * Without a phase, this is the same as reporting @p percent
+     * progress for the whole job.
+     */
+    void setPhaseProgress( qreal percent );
+    /// @brief Progress of the whole job when the current phase is @p percent done
+    qreal overallProgress( qreal percent ) const;
+    /// @brief The name of the current phase; empty if there is none
+    QString currentPhase() const { return m_phase; }
+    /** @brief Forget all the phases
+     *
+     * This is called by the JobQueue before the job runs.
+     */
+    void clearPhases();
+
+    /** @brief Adds @p value, under @p key, to the statistics of this run
+     *
+     * The JobQueue adds these to the statistics it keeps of the job
+     * (see JobQueue::finish() and *jobStatistics* in GlobalStorage),
+     * for what only the job knows, e.g. how many packages it had to
+     * download. Call this from exec(), i.e. from the thread the job
+     * runs in.
+     */
+    void addStatistic( const QString& key, const QVariant& value );
+    /// @brief The statistics added by the job, since clearStatistics()
+    QVariantMap statistics() const { return m_statistics; }
+    /** @brief Forget the statistics
+     *
+     * This is called by the JobQueue before the job runs.
+     */
+    void clearStatistics();
+
 signals:
     void progress( qreal percent );
 
 private:
     bool m_emergency = false;
+    QString m_phase;
+    bool m_inPhase = false;
+    qreal m_phaseStart = 0.0;  ///< Job progress when the current phase started
+    qreal m_phaseWeight = 1.0;  ///< Part of the job for the current phase
+    QString m_moduleInstance;
+    QStringList m_readResources;
+    QStringList m_writeResources;
+    QVariantMap m_statistics;
 };
 
 using job_ptr = QSharedPointer< Job >;
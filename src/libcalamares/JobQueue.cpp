@@ -13,14 +13,37 @@
 #include "CalamaresConfig.h"
 #include "GlobalStorage.h"
 #include "Job.h"
+#include "utils/Dirs.h"
+#include "utils/Executor.h"
 #include "utils/Logger.h"
+#include "utils/ResourceUsage.h"
 
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QRunnable>
+#include <QSaveFile>
 #include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+#include <QWaitCondition>
+#include <QtConcurrent/QtConcurrentRun>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <memory>
 
+#include <unistd.h>
+
 namespace Calamares
 {
 
@@ -45,6 +68,95 @@ struct WeightedJob
 };
 using WeightedJobList = QList< WeightedJob >;
 
+/** @brief Key for the timing profile of a job
+ *
+ * Jobs are identified by their module instance and their position
+ * among the jobs of that instance. This does not depend on the
+ * (translated) name of the job.
+ */
+static QString
+profileKey( const QString& moduleInstance, int moduleJob )
+{
+    return moduleInstance + '#' + QString::number( moduleJob );
+}
+
+/** @brief Runs a @p job from a prepare phase, see JobQueue::prepare()
+ *
+ * Failure is not fatal, so it is only logged. The module instance of
+ * a job that succeeds is added to *preparedJobs* in @p storage.
+ */
+static void
+runPrepareJob( const job_ptr& job, GlobalStorage* storage )
+{
+    Logger::LogContext logContext( job->moduleInstance() );
+    cDebug() << "Preparing job" << job->prettyName();
+    QElapsedTimer timer;
+    timer.start();
+    const auto result = job->exec();
+    if ( !result )
+    {
+        cWarning() << "Prepare job" << job->prettyName() << "failed:" << result.message() << result.details();
+        return;
+    }
+    cDebug() << "Prepare job" << job->prettyName() << "took" << timer.elapsed() << "ms.";
+    if ( storage )
+    {
+        QStringList prepared = storage->value( QStringLiteral( "preparedJobs" ) ).toStringList();
+        prepared.append( job->moduleInstance() );
+        storage->insert( QStringLiteral( "preparedJobs" ), prepared );
+    }
+}
+
+/// @brief Contents of the file @p path in /proc, or empty if it can not be read
+static QByteArray
+readProcFile( const QString& path )
+{
+    QFile f( path );
+    return f.open( QFile::ReadOnly ) ? f.readAll() : QByteArray();
+}
+
+/** @brief Logs the processes below @p pid, recursively
+ *
+ * For each process: its command line, state, where in the kernel
+ * it waits, and its kernel stack (which can only be read by root).
+ * A job that hangs usually waits for one of these.
+ */
+static void
+logChildProcesses( qint64 pid, int depth = 1 )
+{
+    const QString procDir = QStringLiteral( "/proc/%1/task" ).arg( pid );
+    for ( const auto& task : QDir( procDir ).entryList( QDir::Dirs | QDir::NoDotAndDotDot ) )
+    {
+        const QByteArray children = readProcFile( procDir + '/' + task + QStringLiteral( "/children" ) );
+        for ( const auto& child : children.split( ' ' ) )
+        {
+            const qint64 childPid = child.trimmed().toLongLong();
+            if ( childPid <= 0 )
+            {
+                continue;
+            }
+            const QString childDir = QStringLiteral( "/proc/%1/" ).arg( childPid );
+            const QByteArray stat = readProcFile( childDir + QStringLiteral( "stat" ) );
+            // The state follows the command name, which is in parentheses
+            const int close = stat.lastIndexOf( ')' );
+            const QString state = close > 0 ? QString::fromLatin1( stat.mid( close + 2, 1 ) ) : QString();
+            QByteArray cmdline = readProcFile( childDir + QStringLiteral( "cmdline" ) );
+            cmdline.replace( '\0', ' ' );
+            cWarning() << Logger::SubEntry << QString( depth * 2, ' ' ) << childPid << state
+                       << QString::fromLocal8Bit( cmdline.trimmed() ) << "waiting in"
+                       << QString::fromLatin1( readProcFile( childDir + QStringLiteral( "wchan" ) ) );
+            for ( const auto& frame : readProcFile( childDir + QStringLiteral( "stack" ) ).split( '\n' ) )
+            {
+                if ( !frame.isEmpty() )
+                {
+                    cWarning() << Logger::SubEntry << QString( depth * 2 + 2, ' ' ) << QString::fromLatin1( frame );
+                }
+            }
+            logChildProcesses( childPid, depth + 1 );
+        }
+    }
+}
+
 class JobThread : public QThread
 {
     Q_OBJECT
@@ -52,8 +164,12 @@ public:
     JobThread( JobQueue* queue )
         : QThread( queue )
         , m_queue( queue )
-        , m_jobIndex( 0 )
     {
+        // Roughly display refresh rate
+        m_progressTimer.setInterval( 16 );
+        connect( &m_progressTimer, &QTimer::timeout, this, &JobThread::deliverProgress );
+        m_watchdogTimer.setInterval( 1000 );
+        connect( &m_watchdogTimer, &QTimer::timeout, this, &JobThread::checkWatchdog );
     }
 
     ~JobThread() override;
@@ -105,47 +221,160 @@ public:
         }
     }
 
+    /** @brief Sets the prepare jobs to finish before the queue runs
+     *
+     * Only call this while the queue is not running.
+     */
+    void setPrepared( const QFuture< void >& prepared, const JobList& deferred )
+    {
+        m_prepared = prepared;
+        m_deferredPrepareJobs = deferred;
+    }
+
+    /** @brief Stops the jobs, as soon as they can
+     *
+     * Only emergency jobs start after this, with a cancellation of
+     * their own (which is never cancelled).
+     */
+    void cancel()
+    {
+        m_cancellation.cancel();
+        QMutexLocker slock( &m_scheduleMutex );
+        recordCancellation();
+    }
+
+    /// @brief A new cancellation for the next run; only call this while not running
+    void resetCancellation() { m_cancellation = CalamaresUtils::Executor::Cancellation(); }
+
     void run() override
     {
+        // The results of the prepare jobs are for the jobs in the queue
+        m_prepared.waitForFinished();
+        for ( const auto& job : qAsConst( m_deferredPrepareJobs ) )
+        {
+            runPrepareJob( job, m_queue->globalStorage() );
+        }
+        m_deferredPrepareJobs.clear();
+
         QMutexLocker rlock( &m_runMutex );
-        bool failureEncountered = false;
-        QString message;  ///< Filled in with errors
-        QString details;
+        const int jobCount = m_runningJobs->count();
+        {
+            QMutexLocker plock( &m_progressMutex );
+            m_jobProgress = QVector< qreal >( jobCount, 0.0 );
+            m_jobTime = QVector< qreal >( jobCount, -1.0 );
+            m_expectedTime = QVector< qreal >( jobCount, -1.0 );
+            m_moduleJob = QVector< int >( jobCount, 0 );
+            m_jobStarted = QVector< qint64 >( jobCount, -1 );
+            m_lastProgress = QVector< qint64 >( jobCount, -1 );
+            m_watchdogReports = QVector< int >( jobCount, 0 );
+            QHash< QString, int > jobsPerModule;
+            for ( int index = 0; index < jobCount; ++index )
+            {
+                const QString module = m_runningJobs->at( index ).job->moduleInstance();
+                m_moduleJob[ index ] = jobsPerModule[ module ]++;
+                m_expectedTime[ index ] = m_profile.value( profileKey( module, m_moduleJob[ index ] ), -1.0 );
+            }
+            m_queueTimer.start();
+            m_latestRemaining.store( estimateRemaining() );
+        }
+        {
+            QMutexLocker slock( &m_scheduleMutex );
+            m_failureEncountered = false;
+            m_message.clear();
+            m_details.clear();
+            m_statistics.clear();
+        }
+
+        const auto dependencies = computeDependencies();
+        QVector< JobState > state( jobCount, JobState::Waiting );
+        m_jobSucceeded = QVector< bool >( jobCount, false );
+        const int resumed = resumeFromCheckpoint();
+        for ( int index = 0; index < resumed; ++index )
+        {
+            state[ index ] = JobState::Done;
+            m_jobSucceeded[ index ] = true;
+            QMutexLocker plock( &m_progressMutex );
+            m_jobProgress[ index ] = 1.0;
+        }
+        m_checkpointedJobs = resumed;
 
-        m_jobIndex = 0;
-        for ( const auto& jobitem : *m_runningJobs )
+        QMutexLocker slock( &m_scheduleMutex );
+        m_jobState = &state;
+        int remaining = jobCount;
+        while ( remaining > 0 )
         {
-            if ( failureEncountered && !jobitem.job->isEmergency() )
+            // In case the queue was cancelled before the failure state was reset
+            if ( m_cancellation.isCancelled() )
             {
-                cDebug() << "Skipping non-emergency job" << jobitem.job->prettyName();
+                recordCancellation();
             }
-            else
+            bool ranInline = false;
+            bool anyRunning = false;
+            for ( int index = 0; index < jobCount && !ranInline; ++index )
             {
-                cDebug() << "Starting" << ( failureEncountered ? "EMERGENCY JOB" : "job" ) << jobitem.job->prettyName()
-                         << '(' << ( m_jobIndex + 1 ) << '/' << m_runningJobs->count() << ')';
-                emitProgress( 0.0 );  // 0% for *this job*
-                connect( jobitem.job.data(), &Job::progress, this, &JobThread::emitProgress );
-                auto result = jobitem.job->exec();
-                if ( !failureEncountered && !result )
+                if ( state[ index ] == JobState::Running )
                 {
-                    // so this is the first failure
-                    failureEncountered = true;
-                    message = result.message();
-                    details = result.details();
+                    anyRunning = true;
                 }
-                QThread::msleep( 16 );  // Very brief rest before reporting the job as complete
-                emitProgress( 1.0 );  // 100% for *this job*
+                if ( state[ index ] != JobState::Waiting
+                     || !std::all_of( dependencies[ index ].cbegin(),
+                                      dependencies[ index ].cend(),
+                                      [&state]( int d ) { return state[ d ] == JobState::Done; } ) )
+                {
+                    continue;
+                }
+
+                const auto& jobitem = m_runningJobs->at( index );
+                if ( m_failureEncountered && !jobitem.job->isEmergency() )
+                {
+                    cDebug() << "Skipping non-emergency job" << jobitem.job->prettyName();
+                    state[ index ] = JobState::Done;
+                    QMutexLocker plock( &m_progressMutex );
+                    m_jobProgress[ index ] = 1.0;
+                }
+                else if ( !jobitem.job->hasResources() || jobitem.job->runsOnJobThread() )
+                {
+                    state[ index ] = JobState::Running;
+                    slock.unlock();
+                    runJob( index );
+                    slock.relock();
+                    state[ index ] = JobState::Done;
+                    ranInline = true;
+                }
+                else
+                {
+                    state[ index ] = JobState::Running;
+                    anyRunning = true;
+                    m_pool.start( new JobRunnable( this, index ) );
+                }
+            }
+            if ( !ranInline && anyRunning )
+            {
+                m_jobDone.wait( &m_scheduleMutex );
             }
-            m_jobIndex++;
+            remaining = std::count_if(
+                state.cbegin(), state.cend(), []( JobState s ) { return s != JobState::Done; } );
         }
-        if ( failureEncountered )
+        m_jobState = nullptr;
+        slock.unlock();
+        m_pool.waitForDone();
+
+        if ( m_failureEncountered )
         {
+            // No more estimates, since the rest of the jobs were skipped
+            m_latestRemaining.store( -1 );
+            m_progressDirty.store( true );
             QMetaObject::invokeMethod(
-                m_queue, "failed", Qt::QueuedConnection, Q_ARG( QString, message ), Q_ARG( QString, details ) );
+                m_queue, "failed", Qt::QueuedConnection, Q_ARG( QString, m_message ), Q_ARG( QString, m_details ) );
         }
         else
         {
-            emitProgress( 1.0 );
+            emitProgress( jobCount, 1.0 );
+        }
+        {
+            // The watchdog looks at the running jobs as long as they're started
+            QMutexLocker plock( &m_progressMutex );
+            m_jobStarted.clear();
         }
         m_runningJobs->clear();
         QMetaObject::invokeMethod( m_queue, "finish", Qt::QueuedConnection );
@@ -166,20 +395,302 @@ public:
     }
 
 private:
-    /* This is called **only** from run(), while m_runMutex is
-     * already locked, so we can use the m_runningJobs member safely.
+    enum class JobState
+    {
+        Waiting,
+        Running,
+        Done
+    };
+
+    /** @brief Runs one job (by index) on a worker thread from the pool
+     *
+     * When the job is done, the scheduler in run() is woken up.
+     */
+    class JobRunnable : public QRunnable
+    {
+    public:
+        JobRunnable( JobThread* thread, int index )
+            : m_thread( thread )
+            , m_index( index )
+        {
+        }
+
+        void run() override
+        {
+            m_thread->runJob( m_index );
+            QMutexLocker slock( &m_thread->m_scheduleMutex );
+            ( *m_thread->m_jobState )[ m_index ] = JobState::Done;
+            m_thread->m_jobDone.wakeAll();
+        }
+
+    private:
+        JobThread* m_thread;
+        int m_index;
+    };
+
+    /// @brief Records the cancellation as the failure, unless there is one already; call under the schedule mutex
+    void recordCancellation()
+    {
+        if ( !m_failureEncountered )
+        {
+            cWarning() << "The installation is cancelled.";
+            m_failureEncountered = true;
+            m_message = tr( "The installation was cancelled." );
+            m_details.clear();
+        }
+    }
+
+    /** @brief Calculates which (earlier) jobs each job needs to wait for
+     *
+     * A job depends on every earlier job that it conflicts with; jobs
+     * without declared resources conflict with everything, so they act
+     * as a barrier in the queue.
+     */
+    QVector< QVector< int > > computeDependencies() const
+    {
+        const int jobCount = m_runningJobs->count();
+        QVector< QVector< int > > dependencies( jobCount );
+        int concurrent = 0;
+        for ( int index = 0; index < jobCount; ++index )
+        {
+            const auto& job = m_runningJobs->at( index ).job;
+            for ( int earlier = 0; earlier < index; ++earlier )
+            {
+                if ( job->conflictsWith( *( m_runningJobs->at( earlier ).job ) ) )
+                {
+                    dependencies[ index ].append( earlier );
+                }
+            }
+            if ( dependencies[ index ].count() < index )
+            {
+                concurrent++;
+            }
+        }
+        if ( concurrent > 0 )
+        {
+            cDebug() << concurrent << "jobs may run concurrently with earlier jobs.";
+        }
+        return dependencies;
+    }
+
+    /** @brief Runs the job at @p index
+     *
+     * This is called from run() and from JobRunnable, so it may be
+     * called from multiple threads at once. Failures are recorded
+     * under the schedule mutex.
+     */
+    void runJob( int index )
+    {
+        const auto& jobitem = m_runningJobs->at( index );
+        bool emergency = false;
+        {
+            // A job on another thread may be failing right now
+            QMutexLocker slock( &m_scheduleMutex );
+            emergency = m_failureEncountered;
+        }
+        Logger::LogContext logContext( jobitem.job->moduleInstance(), index + 1 );
+        cDebug() << "Starting" << ( emergency ? "EMERGENCY JOB" : "job" ) << jobitem.job->prettyName() << '('
+                 << ( index + 1 ) << '/' << m_runningJobs->count() << ')';
+        jobitem.job->clearPhases();
+        jobitem.job->clearStatistics();
+        if ( m_jobNice != 0 || m_jobIoPriority >= 0 )
+        {
+            // Jobs run on this thread or in the pool; either way, the commands they start inherit it
+            CalamaresUtils::SystemTuning::setThreadPriority( m_jobNice, m_jobIoPriority );
+        }
+        // Emergency jobs clean up after a failure (or cancellation), so they are not cancelled themselves
+        CalamaresUtils::Executor::CancellationScope cancellationScope(
+            emergency ? CalamaresUtils::Executor::Cancellation() : m_cancellation );
+        {
+            QMutexLocker plock( &m_progressMutex );
+            m_jobStarted[ index ] = m_queueTimer.elapsed();
+        }
+        emitProgress( index, 0.0 );  // 0% for *this job*
+        QElapsedTimer timer;
+        timer.start();
+        const auto usageBefore = CalamaresUtils::ResourceUsage::sample();
+        auto connection = connect(
+            jobitem.job.data(),
+            &Job::progress,
+            this,
+            [ this, index ]( qreal percentage ) { emitProgress( index, percentage ); },
+            Qt::DirectConnection );
+        auto result = jobitem.job->exec();
+        disconnect( connection );
+
+        const auto usage = CalamaresUtils::ResourceUsage::sample().delta( usageBefore );
+        // What the job adds itself can not replace what is measured here
+        QVariantMap statistics = jobitem.job->statistics();
+        const QVariantMap measured = usage.toMap();
+        for ( auto it = measured.cbegin(); it != measured.cend(); ++it )
+        {
+            statistics.insert( it.key(), it.value() );
+        }
+        statistics.insert( QStringLiteral( "index" ), index + 1 );
+        statistics.insert( QStringLiteral( "name" ), jobitem.job->prettyName() );
+        statistics.insert( QStringLiteral( "module" ), jobitem.job->moduleInstance() );
+        statistics.insert( QStringLiteral( "moduleJob" ), m_moduleJob.at( index ) );
+        statistics.insert( QStringLiteral( "wallTime" ), timer.elapsed() );
+        statistics.insert( QStringLiteral( "success" ), bool( result ) );
+        statistics.insert( QStringLiteral( "emergency" ), emergency );
+        cDebug() << "Job" << jobitem.job->prettyName() << "took" << timer.elapsed() << "ms," << usage.userTime
+                 << "ms user CPU," << ( usage.childUserTime + usage.childSystemTime ) << "ms CPU in child processes.";
+
+        QMutexLocker slock( &m_scheduleMutex );
+        m_statistics.append( statistics );
+        m_jobSucceeded[ index ] = bool( result );
+        if ( !result )
+        {
+            if ( !m_failureEncountered )
+            {
+                // so this is the first failure
+                m_failureEncountered = true;
+                m_message = result.message();
+                m_details = result.details();
+            }
+        }
+        slock.unlock();
+        if ( result && !emergency )
+        {
+            writeCheckpoint();
+        }
+        {
+            QMutexLocker plock( &m_progressMutex );
+            m_jobTime[ index ] = timer.elapsed();
+        }
+        emitProgress( index, 1.0 );  // 100% for *this job*
+    }
+
+    /// @brief The profileKey() of each job in m_runningJobs, up to @p count
+    QStringList jobKeys( int count ) const
+    {
+        QStringList keys;
+        for ( int index = 0; index < count; ++index )
+        {
+            keys.append( profileKey( m_runningJobs->at( index ).job->moduleInstance(), m_moduleJob.at( index ) ) );
+        }
+        return keys;
+    }
+
+    /** @brief Finds the jobs that completed in an earlier run, and restores GlobalStorage
+     *
+     * The jobs at the start of the queue that are listed (in order) in the
+     * checkpoint are done already. If there are any, GlobalStorage is
+     * restored to what it was after the last of them. Returns the number of
+     * jobs to skip. Call this from run() before any job starts.
+     */
+    int resumeFromCheckpoint()
+    {
+        if ( m_checkpointDirectory.isEmpty() )
+        {
+            return 0;
+        }
+        const QDir dir( m_checkpointDirectory );
+        QFile f( dir.filePath( QStringLiteral( "checkpoint.json" ) ) );
+        if ( !f.open( QFile::ReadOnly ) )
+        {
+            return 0;
+        }
+        const QJsonObject checkpoint = QJsonDocument::fromJson( f.readAll() ).object();
+        const QStringList done = checkpoint.value( QStringLiteral( "jobs" ) ).toVariant().toStringList();
+        const QStringList keys = jobKeys( m_runningJobs->count() );
+        int resumed = 0;
+        while ( resumed < keys.count() && resumed < done.count() && keys.at( resumed ) == done.at( resumed ) )
+        {
+            ++resumed;
+        }
+        if ( resumed > 0 )
+        {
+            if ( !m_queue->globalStorage()->loadBinary( dir.filePath( QStringLiteral( "globalstorage.bin" ) ) ) )
+            {
+                cWarning() << "Checkpoint in" << m_checkpointDirectory << "has no GlobalStorage, not resuming.";
+                return 0;
+            }
+            cDebug() << "Resuming after" << resumed << "jobs that completed before, last one"
+                     << m_runningJobs->at( resumed - 1 ).job->prettyName();
+        }
+        return resumed;
+    }
+
+    /** @brief Records the jobs that have completed
+     *
+     * Jobs may complete out of order when they run concurrently,
+     * so the checkpoint lists the jobs from the start of the queue
+     * up to the first one that has not completed successfully, and
+     * GlobalStorage as it is now. Called from runJob().
      */
-    void emitProgress( qreal percentage ) const
+    void writeCheckpoint()
+    {
+        if ( m_checkpointDirectory.isEmpty() )
+        {
+            return;
+        }
+        QMutexLocker clock( &m_checkpointMutex );
+        int completed = 0;
+        {
+            QMutexLocker slock( &m_scheduleMutex );
+            completed = m_checkpointedJobs;
+            while ( completed < m_jobSucceeded.count() && m_jobSucceeded.at( completed ) )
+            {
+                ++completed;
+            }
+            if ( completed == m_checkpointedJobs )
+            {
+                return;
+            }
+            m_checkpointedJobs = completed;
+        }
+
+        const QDir dir( m_checkpointDirectory );
+        // GlobalStorage first, so that the jobs listed never run ahead of it
+        if ( !m_queue->globalStorage()->saveBinary( dir.filePath( QStringLiteral( "globalstorage.bin" ) ) ) )
+        {
+            cWarning() << "Could not write checkpoint to" << m_checkpointDirectory;
+            return;
+        }
+        QSaveFile f( dir.filePath( QStringLiteral( "checkpoint.json" ) ) );
+        QJsonObject checkpoint;
+        checkpoint.insert( QStringLiteral( "jobs" ), QJsonArray::fromStringList( jobKeys( completed ) ) );
+        if ( !f.open( QFile::WriteOnly ) || f.write( QJsonDocument( checkpoint ).toJson() ) < 0 || !f.commit() )
+        {
+            cWarning() << "Could not write checkpoint to" << f.fileName();
+        }
+    }
+
+    /* This is called from runJob() -- possibly from multiple threads
+     * -- and from run() itself, while m_runMutex is already locked,
+     * so m_runningJobs is safe to use. The overall progress
+     * is the weighted sum of the progress of each job, which works
+     * out the same as the cumulative weight when jobs run in sequence.
+     *
+     * Passing an @p index past the end of the list is the "all done" report.
+     */
+    void emitProgress( int index, qreal percentage )
     {
         percentage = qBound( 0.0, percentage, 1.0 );
 
         QString message;
         qreal progress = 0.0;
-        if ( m_jobIndex < m_runningJobs->count() )
+        if ( index < m_runningJobs->count() )
         {
-            const auto& jobitem = m_runningJobs->at( m_jobIndex );
-            progress = ( jobitem.cumulative + jobitem.weight * percentage ) / m_overallQueueWeight;
-            message = jobitem.job->prettyStatusMessage();
+            const auto& jobitem = m_runningJobs->at( index );
+            {
+                QMutexLocker plock( &m_progressMutex );
+                m_jobProgress[ index ] = percentage;
+                m_lastProgress[ index ] = m_queueTimer.elapsed();
+                for ( int i = 0; i < m_jobProgress.count(); ++i )
+                {
+                    progress += m_runningJobs->at( i ).weight * m_jobProgress.at( i );
+                }
+                m_latestRemaining.store( estimateRemaining( progress ) );
+            }
+            progress = qBound( 0.0, progress / m_overallQueueWeight, 1.0 );
+            // A named phase of the job says best what it is doing
+            message = jobitem.job->currentPhase();
+            if ( message.isEmpty() )
+            {
+                message = jobitem.job->prettyStatusMessage();
+            }
             // In progress reports at the start of a job (e.g. when the queue
             // starts the job, or if the job itself reports 0.0) be more
             // accepting in what gets reported: jobs with no status fall
@@ -197,23 +708,304 @@ private:
         {
             progress = 1.0;
             message = tr( "Done" );
+            m_latestRemaining.store( 0 );
         }
-        QMetaObject::invokeMethod(
-            m_queue, "progress", Qt::QueuedConnection, Q_ARG( qreal, progress ), Q_ARG( QString, message ) );
+        postProgress( progress, message );
     }
 
+    /** @brief Estimates the time (in seconds) the running jobs still need
+     *
+     * Jobs in the timing profile are expected to take as long as they
+     * did before, scaled by how long the profiled jobs that are done
+     * took this time compared to before. Other jobs are expected to take
+     * as long as the queue has taken so far per unit of weight. The
+     * @p doneWeight is the weight of the work done so far.
+     *
+     * Call this with m_progressMutex held.
+     */
+    int estimateRemaining( qreal doneWeight = 0.0 ) const
+    {
+        qreal profiledBefore = 0.0;
+        qreal profiledNow = 0.0;
+        for ( int i = 0; i < m_jobTime.count(); ++i )
+        {
+            if ( m_jobTime.at( i ) >= 0 && m_expectedTime.at( i ) > 0 )
+            {
+                profiledBefore += m_expectedTime.at( i );
+                profiledNow += m_jobTime.at( i );
+            }
+        }
+        const qreal scale = profiledBefore > 0 ? profiledNow / profiledBefore : 1.0;
+        const qint64 elapsed = m_queueTimer.isValid() ? m_queueTimer.elapsed() : 0;
+        const qreal msPerWeight = doneWeight > 0 ? elapsed / doneWeight : -1.0;
+
+        qreal remaining = 0.0;
+        for ( int i = 0; i < m_jobProgress.count(); ++i )
+        {
+            const qreal left = 1.0 - m_jobProgress.at( i );
+            if ( left <= 0 )
+            {
+                continue;
+            }
+            if ( m_expectedTime.at( i ) > 0 )
+            {
+                remaining += left * m_expectedTime.at( i ) * scale;
+            }
+            else if ( msPerWeight >= 0 )
+            {
+                remaining += left * m_runningJobs->at( i ).weight * msPerWeight;
+            }
+            else
+            {
+                return -1;
+            }
+        }
+        return int( std::ceil( remaining / 1000.0 ) );
+    }
+
+    /** @brief Hands progress over to the GUI thread
+     *
+     * This never blocks and never posts events: the latest progress
+     * value (and latest non-empty message) are stored in atomic slots,
+     * and a timer in the GUI thread picks them up at display refresh
+     * rate (see deliverProgress()). Intermediate values are dropped.
+     * An empty @p message does not replace a pending message, so
+     * status messages are not lost by coalescing.
+     */
+    void postProgress( qreal progress, const QString& message )
+    {
+        m_latestProgress.store( progress );
+        if ( !message.isEmpty() )
+        {
+            delete m_latestMessage.exchange( new QString( message ) );
+        }
+        m_progressDirty.store( true );
+    }
+
+public:
+    /** @brief Called in the GUI thread, emits the latest progress from the queue
+     *
+     * Does nothing if there has not been any progress since the
+     * previous call.
+     */
+    void deliverProgress()
+    {
+        if ( !m_progressDirty.exchange( false ) )
+        {
+            return;
+        }
+        const qreal progress = m_latestProgress.load();
+        std::unique_ptr< QString > message( m_latestMessage.exchange( nullptr ) );
+        emit m_queue->progress( progress, message ? *message : QString() );
+        const int remaining = m_latestRemaining.load();
+        if ( remaining != m_deliveredRemaining )
+        {
+            m_deliveredRemaining = remaining;
+            emit m_queue->remainingTimeChanged( remaining );
+        }
+    }
+
+    /// @brief The most-recently delivered estimate, see JobQueue::remainingTime()
+    int remainingTime() const { return m_deliveredRemaining; }
+
+    /** @brief Sets the timing profile for estimates
+     *
+     * Only call this while the queue is not running.
+     */
+    void setProfile( const QHash< QString, qreal >& profile )
+    {
+        QMutexLocker plock( &m_progressMutex );
+        m_profile = profile;
+    }
+
+    /** @brief Sets the directory for checkpoints, see JobQueue::setCheckpointDirectory()
+     *
+     * Only call this while the queue is not running.
+     */
+    void setCheckpointDirectory( const QString& directory ) { m_checkpointDirectory = directory; }
+
+    /** @brief Sets the priority of the threads that run jobs, see JobQueue::setTuning()
+     *
+     * Only call this while the queue is not running.
+     */
+    void setJobPriority( int nice, int ioPriority )
+    {
+        m_jobNice = nice;
+        m_jobIoPriority = ioPriority;
+    }
+
+    /// @brief Did the most recent run() complete without failures?
+    bool succeeded() const
+    {
+        QMutexLocker slock( &m_scheduleMutex );
+        return !m_failureEncountered;
+    }
+
+    /// @brief Start (or stop, flushing the last progress) the GUI-side progress and watchdog timers
+    void setProgressTimerActive( bool active )
+    {
+        if ( active )
+        {
+            m_progressTimer.start();
+            m_watchdogTimer.start();
+        }
+        else
+        {
+            m_progressTimer.stop();
+            m_watchdogTimer.stop();
+            deliverProgress();
+            if ( !m_slowJob.isEmpty() )
+            {
+                m_slowJob.clear();
+                emit m_queue->jobSlow( QString(), 0 );
+            }
+        }
+    }
+
+    /// @brief Sets the watchdog limits, see JobQueue::setWatchdogLimits()
+    void setWatchdogLimits( qint64 slowMs, qint64 stallMs )
+    {
+        QMutexLocker plock( &m_progressMutex );
+        m_watchdogSlowMs = slowMs;
+        m_watchdogStallMs = stallMs;
+        m_watchdogTimer.setInterval( int( qBound( qint64( 10 ), std::min( slowMs, stallMs ) / 4, qint64( 1000 ) ) ) );
+    }
+
+    /** @brief Called in the GUI thread, checks for jobs that take too long
+     *
+     * A job with a timing profile is late when it takes twice as long
+     * as before (and at least the slow limit); a job without one is late
+     * when it reports no progress for the stall limit. Each time a
+     * job is late by twice as much (again), the child processes are
+     * logged; JobQueue::jobSlow() is emitted when the slow job changes.
+     */
+    void checkWatchdog()
+    {
+        QString slowJob;
+        int slowSeconds = 0;
+        QList< QPair< QString, qint64 > > late;  // Names and running time (ms) of newly late jobs
+        {
+            QMutexLocker plock( &m_progressMutex );
+            if ( !m_queueTimer.isValid() )
+            {
+                return;
+            }
+            const qint64 now = m_queueTimer.elapsed();
+            for ( int i = 0; i < m_jobStarted.count(); ++i )
+            {
+                if ( m_jobStarted.at( i ) < 0 || m_jobTime.at( i ) >= 0 )
+                {
+                    continue;  // Not running
+                }
+                const qint64 running = now - m_jobStarted.at( i );
+                const qreal expected = m_expectedTime.at( i );
+                const qint64 overdue = expected > 0 ? running : now - m_lastProgress.at( i );
+                const qint64 limit = expected > 0 ? std::max( qint64( 2 * expected ), m_watchdogSlowMs )
+                                                  : m_watchdogStallMs;
+                if ( overdue <= limit )
+                {
+                    if ( expected <= 0 )
+                    {
+                        // Progress resumed, so it's not stalled any more
+                        m_watchdogReports[ i ] = 0;
+                    }
+                    continue;
+                }
+                const QString name = m_runningJobs->at( i ).job->prettyName();
+                if ( overdue > ( limit << m_watchdogReports.at( i ) ) )
+                {
+                    m_watchdogReports[ i ]++;
+                    late.append( qMakePair( name, running ) );
+                }
+                if ( slowJob.isEmpty() )
+                {
+                    slowJob = name;
+                    slowSeconds = int( running / 1000 );
+                }
+            }
+        }
+
+        for ( const auto& job : qAsConst( late ) )
+        {
+            cWarning() << "Job" << job.first << "is taking longer than expected," << job.second
+                       << "ms so far. Processes:";
+            logChildProcesses( QCoreApplication::applicationPid() );
+        }
+        if ( slowJob != m_slowJob || !late.isEmpty() )
+        {
+            m_slowJob = slowJob;
+            emit m_queue->jobSlow( slowJob, slowSeconds );
+        }
+    }
+
+    /** @brief Statistics for each job that ran in the most recent run()
+     *
+     * Each entry is a map with the name and index of the job, its
+     * wall-clock time, success, and the ResourceUsage (see there) of
+     * the job. Entries are in the order that the jobs finished.
+     */
+    QVariantList statistics() const
+    {
+        QMutexLocker slock( &m_scheduleMutex );
+        return m_statistics;
+    }
+
+private:
     mutable QMutex m_runMutex;
     mutable QMutex m_enqueMutex;
+    mutable QMutex m_scheduleMutex;  ///< Protects job states, statistics and failure information
+    QWaitCondition m_jobDone;  ///< Signalled (with m_scheduleMutex) when a worker finishes a job
+    QMutex m_progressMutex;  ///< Protects m_jobProgress
 
     std::unique_ptr< WeightedJobList > m_runningJobs = std::make_unique< WeightedJobList >();
     std::unique_ptr< WeightedJobList > m_queuedJobs = std::make_unique< WeightedJobList >();
 
     JobQueue* m_queue;
-    int m_jobIndex = 0;  ///< Index into m_runningJobs
+    QFuture< void > m_prepared;  ///< Background prepare jobs, see setPrepared()
+    JobList m_deferredPrepareJobs;  ///< Prepare jobs to run on this thread, first
+    QThreadPool m_pool;  ///< Worker threads for jobs with declared resources
+    QVector< JobState >* m_jobState = nullptr;  ///< State of each job in m_runningJobs, while running
+    QVector< qreal > m_jobProgress;  ///< Progress (0..1) of each job in m_runningJobs
+    QVector< qreal > m_jobTime;  ///< Wall-clock time (ms) of each finished job, or -1
+    QVector< qreal > m_expectedTime;  ///< Time (ms) from the profile for each job, or -1
+    QVector< int > m_moduleJob;  ///< Position of each job among the jobs of its module instance
+    QHash< QString, qreal > m_profile;  ///< Wall-clock time (ms) by profileKey()
+    QElapsedTimer m_queueTimer;  ///< Started when run() starts
     qreal m_overallQueueWeight = 0.0;  ///< cumulation when **all** the jobs are done
+
+    std::atomic< qreal > m_latestProgress { 0.0 };  ///< Most-recent overall progress
+    std::atomic< QString* > m_latestMessage { nullptr };  ///< Most-recent non-empty message, owned
+    std::atomic< bool > m_progressDirty { false };  ///< Is there progress not yet delivered?
+    std::atomic< int > m_latestRemaining { -1 };  ///< Most-recent estimate, seconds
+    int m_deliveredRemaining = -1;  ///< Estimate last emitted (GUI thread only)
+    QTimer m_progressTimer;  ///< In the GUI thread, calls deliverProgress()
+    QVector< qint64 > m_jobStarted;  ///< When (ms in m_queueTimer) each job started, or -1
+    QVector< qint64 > m_lastProgress;  ///< When (ms in m_queueTimer) each job last reported progress
+    QVector< int > m_watchdogReports;  ///< How often each job was reported late
+    qint64 m_watchdogSlowMs = 30000;  ///< Jobs with a profile are never late before this
+    qint64 m_watchdogStallMs = 300000;  ///< Jobs without a profile are late after this without progress
+    QTimer m_watchdogTimer;  ///< In the GUI thread, calls checkWatchdog()
+    QString m_slowJob;  ///< Most recent slow job reported (GUI thread only)
+
+    QString m_checkpointDirectory;  ///< Empty if there are no checkpoints
+    QMutex m_checkpointMutex;  ///< Serializes writeCheckpoint()
+    QVector< bool > m_jobSucceeded;  ///< Did each job in m_runningJobs complete successfully?
+    int m_checkpointedJobs = 0;  ///< Jobs at the start of m_runningJobs that are in the checkpoint
+
+    int m_jobNice = 0;  ///< Nice value for the threads that run jobs, see setJobPriority()
+    int m_jobIoPriority = -1;  ///< Best-effort I/O priority for those threads, or -1
+
+    CalamaresUtils::Executor::Cancellation m_cancellation;  ///< For the jobs of this run, see cancel()
+    bool m_failureEncountered = false;
+    QString m_message;  ///< Filled in with errors
+    QString m_details;
+    QVariantList m_statistics;  ///< See statistics()
 };
 
-JobThread::~JobThread() {}
+JobThread::~JobThread()
+{
+    delete m_latestMessage.exchange( nullptr );
+}
 
 
 JobQueue* JobQueue::s_instance = nullptr;
@@ -241,12 +1033,26 @@ JobQueue::JobQueue( QObject* parent )
 
 JobQueue::~JobQueue()
 {
+    if ( !m_checkpointDirectory.isEmpty() && m_succeeded )
+    {
+        // The installation is done, so the next one starts from scratch
+        const QDir dir( m_checkpointDirectory );
+        QFile::remove( dir.filePath( QStringLiteral( "checkpoint.json" ) ) );
+        QFile::remove( dir.filePath( QStringLiteral( "globalstorage.bin" ) ) );
+    }
     if ( m_thread->isRunning() )
     {
-        m_thread->terminate();
-        if ( !m_thread->wait( 300 ) )
+        // The ViewManager cancels the jobs, and waits for them, before it
+        // quits; this is the last resort, so it does not hold up quitting long.
+        m_thread->cancel();
+        if ( !m_thread->wait( 1000 ) )
         {
-            cError() << "Could not terminate job thread (expect a crash now).";
+            cWarning() << "Jobs did not stop after cancelling, terminating the job thread.";
+            m_thread->terminate();
+            if ( !m_thread->wait( 300 ) )
+            {
+                cError() << "Could not terminate job thread (expect a crash now).";
+            }
         }
         delete m_thread;
     }
@@ -261,11 +1067,54 @@ JobQueue::start()
 {
     Q_ASSERT( !m_thread->isRunning() );
     m_thread->finalize();
+    m_thread->setPrepared( m_prepared, m_deferredPrepareJobs );
+    m_deferredPrepareJobs.clear();
+    m_thread->resetCancellation();
+    m_thread->setProgressTimerActive( true );
+    if ( !m_tuning.isEmpty() && !m_tuner )
+    {
+        m_tuner = std::make_unique< CalamaresUtils::SystemTuning::Tuner >();
+        m_tuner->apply( m_tuning, qint64( sysconf( _SC_PHYS_PAGES ) ) * qint64( sysconf( _SC_PAGESIZE ) ) );
+    }
     m_finished = false;
     m_thread->start();
 }
 
 
+void
+JobQueue::prepare( const JobList& jobs )
+{
+    JobList early;
+    for ( const auto& job : jobs )
+    {
+        if ( job->runsOnJobThread() )
+        {
+            cDebug() << "Prepare job" << job->prettyName() << "runs when the queue starts.";
+            m_deferredPrepareJobs.append( job );
+        }
+        else
+        {
+            early.append( job );
+        }
+    }
+    if ( early.isEmpty() )
+    {
+        return;
+    }
+
+    // After the prepare jobs that were started earlier
+    const QFuture< void > previous = m_prepared;
+    GlobalStorage* storage = m_storage;
+    m_prepared = QtConcurrent::run( [previous, early, storage]() {
+        QFuture< void > earlier = previous;
+        earlier.waitForFinished();
+        for ( const auto& job : early )
+        {
+            runPrepareJob( job, storage );
+        }
+    } );
+}
+
 void
 JobQueue::enqueue( int moduleWeight, const JobList& jobs )
 {
@@ -277,6 +1126,23 @@ JobQueue::enqueue( int moduleWeight, const JobList& jobs )
 void
 JobQueue::finish()
 {
+    m_thread->setProgressTimerActive( false );
+
+    // Statistics accumulate over all the exec phases
+    QVariantList statistics = m_storage->value( QStringLiteral( "jobStatistics" ) ).toList();
+    statistics.append( m_thread->statistics() );
+    m_storage->insert( QStringLiteral( "jobStatistics" ), statistics );
+
+    // A later run reads this for its estimates, so never leave half a file
+    QSaveFile f( CalamaresUtils::appLogDir().filePath( QStringLiteral( "job-statistics.json" ) ) );
+    if ( !f.open( QFile::WriteOnly ) || f.write( QJsonDocument::fromVariant( statistics ).toJson() ) < 0
+         || !f.commit() )
+    {
+        cWarning() << "Could not write job statistics to" << f.fileName();
+    }
+
+    m_succeeded = m_thread->succeeded();
+    m_tuner.reset();  // Restores the system settings
     m_finished = true;
     emit finished();
     emit queueChanged( m_thread->queuedJobs() );
@@ -288,6 +1154,95 @@ JobQueue::globalStorage() const
     return m_storage;
 }
 
+bool
+JobQueue::loadTimingProfile( const QString& filename )
+{
+    QFile f( filename );
+    if ( !f.open( QFile::ReadOnly ) )
+    {
+        cWarning() << "Could not read job timings from" << filename;
+        return false;
+    }
+    const QJsonDocument doc = QJsonDocument::fromJson( f.readAll() );
+    if ( !doc.isArray() )
+    {
+        cWarning() << "Job timings in" << filename << "are not a list.";
+        return false;
+    }
+
+    // A job that ran more than once (e.g. in different exec phases)
+    // is expected to take its average time.
+    QHash< QString, qreal > total;
+    QHash< QString, int > count;
+    for ( const auto& v : doc.array().toVariantList() )
+    {
+        const auto m = v.toMap();
+        if ( !m.contains( QStringLiteral( "module" ) ) || !m.contains( QStringLiteral( "wallTime" ) ) )
+        {
+            continue;
+        }
+        const QString key = profileKey( m.value( QStringLiteral( "module" ) ).toString(),
+                                        m.value( QStringLiteral( "moduleJob" ) ).toInt() );
+        total[ key ] += m.value( QStringLiteral( "wallTime" ) ).toDouble();
+        count[ key ]++;
+    }
+    QHash< QString, qreal > profile;
+    for ( auto it = total.constBegin(); it != total.constEnd(); ++it )
+    {
+        profile.insert( it.key(), it.value() / count.value( it.key() ) );
+    }
+    cDebug() << "Loaded timings for" << profile.count() << "jobs from" << filename;
+    m_thread->setProfile( profile );
+    return true;
+}
+
+void
+JobQueue::setTuning( const CalamaresUtils::SystemTuning::Profile& profile )
+{
+    Q_ASSERT( !m_thread->isRunning() );
+    m_tuning = profile;
+    m_thread->setJobPriority( profile.jobNice, profile.jobIoPriority );
+}
+
+bool
+JobQueue::setCheckpointDirectory( const QString& directory )
+{
+    Q_ASSERT( !m_thread->isRunning() );
+    QDir dir( directory );
+    if ( !dir.mkpath( QStringLiteral( "." ) ) )
+    {
+        cWarning() << "Could not create checkpoint directory" << directory;
+        return false;
+    }
+    // GlobalStorage may hold passwords
+    QFile::setPermissions( dir.absolutePath(), QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner );
+    m_checkpointDirectory = dir.absolutePath();
+    m_thread->setCheckpointDirectory( m_checkpointDirectory );
+    return true;
+}
+
+void
+JobQueue::cancel()
+{
+    if ( m_thread->isRunning() )
+    {
+        m_thread->cancel();
+    }
+}
+
+void
+JobQueue::setWatchdogLimits( int slowMs, int stallMs )
+{
+    Q_ASSERT( !m_thread->isRunning() );
+    m_thread->setWatchdogLimits( std::max( slowMs, 1 ), std::max( stallMs, 1 ) );
+}
+
+int
+JobQueue::remainingTime() const
+{
+    return m_thread->remainingTime();
+}
+
 }  // namespace Calamares
 
 #include "utils/moc-warnings.h"
@@ -12,8 +12,13 @@
 
 #include "DllMacro.h"
 #include "Job.h"
+#include "utils/SystemTuning.h"
 
+#include <QFuture>
 #include <QObject>
+#include <QString>
+
+#include <memory>
 
 namespace Calamares
 {
@@ -23,6 +28,8 @@ class JobThread;
 class DLLEXPORT JobQueue : public QObject
 {
     Q_OBJECT
+    Q_PROPERTY( int remainingTime READ remainingTime NOTIFY remainingTimeChanged )
+
 public:
     explicit JobQueue( QObject* parent = nullptr );
     ~JobQueue() override;
@@ -58,9 +65,93 @@ public:
      * finished() is emitted.
      */
     void start();
+    /** @brief Stops the running jobs, as soon as they can
+     *
+     * This counts as a failure: the rest of the jobs are skipped,
+     * except for emergency jobs, which run to clean up (e.g. to
+     * unmount the target system). Commands that the jobs run through
+     * System::runCommand() are stopped right away (see Job::isCancelled()
+     * for jobs that do work of their own). failed() and finished() are
+     * emitted as usual once everything has stopped.
+     */
+    void cancel();
+
+    /** @brief Runs @p jobs early, before the queue starts
+     *
+     * These are the jobs from a *prepare* phase of the sequence: they
+     * have no effect on the target system, and leave their results
+     * (e.g. benchmarks or downloads) in GlobalStorage for the jobs that
+     * run later. They run one after the other, in the background; start()
+     * waits for them before it runs anything else. Jobs that must run
+     * on the job thread (see Job::runsOnJobThread()) can not run early,
+     * so they run at the start of the next start() instead.
+     *
+     * A prepare job that fails does not fail the installation: the
+     * failure is logged, and the later jobs must cope without the
+     * results. The module instances of the prepare jobs that succeeded
+     * are listed in GlobalStorage key *preparedJobs*.
+     */
+    void prepare( const JobList& jobs );
 
     bool isRunning() const { return !m_finished; }
 
+    /** @brief Loads the timings of an earlier run, for estimates
+     *
+     * The @p filename is a `job-statistics.json` written by an earlier
+     * run of Calamares (see finish()). When jobs from the same module
+     * instances run again, their earlier wall-clock time is used to
+     * estimate the remaining time, corrected by how fast the jobs
+     * that already finished were compared to their earlier time.
+     * Returns @c true if the file could be read.
+     */
+    bool loadTimingProfile( const QString& filename );
+
+    /** @brief Records completed jobs in @p directory, and resumes from there
+     *
+     * After each job completes successfully, the list of jobs (from the
+     * start of the queue) that have completed and a snapshot of
+     * GlobalStorage (see GlobalStorage::saveBinary()) are written to
+     * @p directory. When the queue starts and the same jobs are at the
+     * start of it, they are skipped, and GlobalStorage is restored from
+     * the snapshot: the installation resumes with the first job that
+     * did not complete. The checkpoint is removed when the JobQueue is
+     * destroyed after a successful run.
+     *
+     * Jobs that are skipped do not run again, so whatever they did
+     * outside of GlobalStorage (e.g. mounting filesystems) must still
+     * be in place. Returns @c false if the directory cannot be created.
+     */
+    bool setCheckpointDirectory( const QString& directory );
+
+    /** @brief Tunes the live system with @p profile while the queue runs
+     *
+     * The profile is applied when the queue starts, and undone when
+     * it finishes (or when the JobQueue is destroyed). The threads that
+     * run jobs get the job priority of the profile; the thread that
+     * calls start() (the UI thread) gets its UI priority.
+     * See CalamaresUtils::SystemTuning for details.
+     */
+    void setTuning( const CalamaresUtils::SystemTuning::Profile& profile );
+
+    /** @brief Sets when the watchdog considers a job late
+     *
+     * A job that has a timing profile (see loadTimingProfile()) is late
+     * when it takes twice as long as it did before, but not before
+     * @p slowMs milliseconds (default 30 seconds). A job without a profile
+     * is late after @p stallMs milliseconds (default 5 minutes) without
+     * reporting progress. For late jobs, the processes that Calamares
+     * has started are logged, and jobSlow() is emitted.
+     */
+    void setWatchdogLimits( int slowMs, int stallMs );
+
+    /** @brief Estimated time until the queue is done, in seconds
+     *
+     * This combines the timing profile (if any) with the rate at which
+     * the queue has made progress so far. Returns -1 if there is no
+     * estimate (e.g. nothing has been done yet, and there is no profile).
+     */
+    int remainingTime() const;
+
 signals:
     /** @brief Report progress of the whole queue, with a status message
      *
@@ -92,11 +183,27 @@ signals:
      */
     void queueChanged( const QStringList& jobNames );
 
+    /// @brief The estimate of remainingTime() has changed
+    void remainingTimeChanged( int seconds );
+
+    /** @brief A job is taking longer than expected
+     *
+     * The job @p prettyName has been running for @p seconds, and is
+     * late according to the watchdog (see setWatchdogLimits()). An
+     * empty @p prettyName means that no job is late (any more).
+     */
+    void jobSlow( const QString& prettyName, int seconds );
+
 public slots:
     /** @brief Implementation detail
      *
      * This is a private implementation detail for the job thread,
      * which should not be called by other core.
+     *
+     * When the queue finishes, the timing and resource-usage statistics
+     * of the jobs are stored in GlobalStorage (key *jobStatistics*, a list
+     * of maps, one for each job that ran) and written as JSON to
+     * `job-statistics.json` next to the session log.
      */
     void finish();
 
@@ -105,7 +212,13 @@ private:
 
     JobThread* m_thread;
     GlobalStorage* m_storage;
+    QFuture< void > m_prepared;  ///< The prepare jobs that run in the background
+    JobList m_deferredPrepareJobs;  ///< Prepare jobs that need the job thread
+    QString m_checkpointDirectory;
+    CalamaresUtils::SystemTuning::Profile m_tuning;
+    std::unique_ptr< CalamaresUtils::SystemTuning::Tuner > m_tuner;  ///< While running with a tuning profile
     bool m_finished = true;  ///< Initially, not running
+    bool m_succeeded = false;  ///< Did the most recent run complete without failures?
 };
 
 }  // namespace Calamares
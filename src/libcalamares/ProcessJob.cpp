@@ -56,16 +56,14 @@ ProcessJob::exec()
 {
     using CalamaresUtils::System;
 
+    // Simple commands run without a shell in between
+    const QStringList args = System::commandArguments( m_command );
     if ( m_runInChroot )
         return CalamaresUtils::System::instance()
-            ->targetEnvCommand( { m_command }, m_workingPath, QString(), m_timeoutSec )
+            ->targetEnvCommand( args, m_workingPath, QString(), m_timeoutSec )
             .explainProcess( m_command, m_timeoutSec );
     else
-        return System::runCommand( System::RunLocation::RunInHost,
-                                   { "/bin/sh", "-c", m_command },
-                                   m_workingPath,
-                                   QString(),
-                                   m_timeoutSec )
+        return System::runCommand( System::RunLocation::RunInHost, args, m_workingPath, QString(), m_timeoutSec )
             .explainProcess( m_command, m_timeoutSec );
 }
 
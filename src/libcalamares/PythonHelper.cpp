@@ -16,6 +16,7 @@
 
 #include <QDir>
 #include <QFileInfo>
+#include <QHash>
 
 namespace bp = boost::python;
 
@@ -269,6 +270,24 @@ Helper::createCleanNamespace()
 }
 
 
+boost::python::object
+Helper::compiledScript( const QString& path, const QString& name )
+{
+    const QDateTime modified = QFileInfo( path ).lastModified();
+    auto it = m_compiledScripts.constFind( path );
+    if ( it != m_compiledScripts.constEnd() && it->modified == modified )
+    {
+        return it->code;
+    }
+
+    const bp::str moduleName( name.toStdString() );
+    bp::object loader = bp::import( "importlib.machinery" )
+                            .attr( "SourceFileLoader" )( moduleName, bp::str( path.toLocal8Bit().data() ) );
+    bp::object code = loader.attr( "get_code" )( moduleName );
+    m_compiledScripts.insert( path, CompiledScript { modified, code } );
+    return code;
+}
+
 QString
 Helper::handleLastError()
 {
@@ -446,6 +465,64 @@ GlobalStoragePythonWrapper::remove( const std::string& key )
 }
 
 
+/** @brief Copies lists and dicts, sharing everything else
+ *
+ * Values from GS are cached as Python objects, but Python modules
+ * may modify what they get (e.g. fstab appends to *partitions*),
+ * so each caller gets its own containers. The (immutable) strings
+ * and numbers in them are shared with the cache, and those are
+ * the expensive part of a conversion.
+ */
+static bp::object
+copyContainers( const bp::object& o )
+{
+    if ( PyList_Check( o.ptr() ) )
+    {
+        bp::list copy;
+        const auto length = bp::len( o );
+        for ( decltype( bp::len( o ) ) i = 0; i < length; ++i )
+        {
+            copy.append( copyContainers( o[ i ] ) );
+        }
+        return std::move( copy );
+    }
+    if ( PyDict_Check( o.ptr() ) )
+    {
+        bp::dict copy;
+        const bp::list items = bp::extract< bp::dict >( o )().items();
+        const auto length = bp::len( items );
+        for ( decltype( bp::len( items ) ) i = 0; i < length; ++i )
+        {
+            copy[ items[ i ][ 0 ] ] = copyContainers( items[ i ][ 1 ] );
+        }
+        return std::move( copy );
+    }
+    return o;
+}
+
+/** @brief Converted GS values, by key
+ *
+ * The cache keeps the QVariant that was converted, along with the
+ * Python object. QVariant payloads are implicitly shared, so if the
+ * value in GS is still the same, its data pointer is the same; for
+ * simple values that are stored inline, comparing is cheap.
+ *
+ * This is only used from the job thread, which holds the GIL.
+ * It is never freed, so that no Python objects are released
+ * after the interpreter is gone.
+ */
+struct CachedValue
+{
+    QVariant variant;
+    bp::object object;
+};
+static QHash< QString, CachedValue >&
+valueCache()
+{
+    static auto* cache = new QHash< QString, CachedValue >;
+    return *cache;
+}
+
 bp::object
 GlobalStoragePythonWrapper::value( const std::string& key ) const
 {
@@ -454,7 +531,15 @@ GlobalStoragePythonWrapper::value( const std::string& key ) const
     {
         cWarning() << "Unknown GS key" << key.c_str();
     }
-    return CalamaresPython::variantToPyObject( m_gs->value( gsKey ) );
+    const QVariant v = m_gs->value( gsKey );
+
+    auto& cache = valueCache();
+    auto it = cache.find( gsKey );
+    if ( it == cache.end() || !( it->variant.constData() == v.constData() || it->variant == v ) )
+    {
+        it = cache.insert( gsKey, CachedValue { v, CalamaresPython::variantToPyObject( v ) } );
+    }
+    return copyContainers( it->object );
 }
 
 }  // namespace CalamaresPython
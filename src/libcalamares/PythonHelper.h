@@ -14,6 +14,8 @@
 #include "PythonJob.h"
 #include "utils/BoostPython.h"
 
+#include <QDateTime>
+#include <QHash>
 #include <QStringList>
 
 namespace Calamares
@@ -43,6 +45,19 @@ class Helper : public QObject
 public:
     boost::python::dict createCleanNamespace();
 
+    /** @brief Gets the compiled code for the script at @p path
+     *
+     * Compiled code is kept for the lifetime of the interpreter, and
+     * re-used as long as the script file is not modified. Compilation
+     * goes through Python's SourceFileLoader, so byte-compiled files
+     * in `__pycache__` next to the script are used (and written, if
+     * the directory is writable). Distributions can byte-compile the
+     * modules at packaging time to benefit from this.
+     *
+     * The @p name is used as the module name for the loader.
+     */
+    boost::python::object compiledScript( const QString& path, const QString& name );
+
     QString handleLastError();
 
     static Helper* instance();
@@ -54,6 +69,13 @@ private:
     boost::python::object m_mainModule;
     boost::python::object m_mainNamespace;
 
+    struct CompiledScript
+    {
+        QDateTime modified;
+        boost::python::object code;
+    };
+    QHash< QString, CompiledScript > m_compiledScripts;
+
     QStringList m_pythonPaths;
 };
 
@@ -67,6 +89,12 @@ public:
     void insert( const std::string& key, const boost::python::api::object& value );
     boost::python::list keys() const;
     int remove( const std::string& key );
+    /** @brief The value for @p key, as a Python object
+     *
+     * Conversions are cached for as long as the value in GS stays
+     * the same, so repeated reads of large values (e.g. *partitions*)
+     * are cheap. Each call returns its own lists and dicts.
+     */
     boost::python::api::object value( const std::string& key ) const;
 
     // This is a helper for scripts that do not go through
@@ -18,12 +18,97 @@
 #include "utils/Logger.h"
 
 #include <QDir>
+#include <QFileInfo>
 
 static const char* s_preScript = nullptr;
+static QString s_profileDirectory;
+
+/* Python code for profiling a job, see PythonJob::setProfileDirectory().
+ *
+ * The functions in libcalamares.utils that run commands (or mount) are
+ * wrapped in Python functions, so that the time spent in them shows up
+ * as frames of their own. The profiler itself keeps the time spent in
+ * each call stack, and writes them in the "collapsed stacks" format
+ * of flamegraph.pl (which speedscope and others read, too).
+ */
+static const char s_profileScript[] = R"%(
+import sys
+import time
+import libcalamares
+import libcalamares.utils
+
+def _wrap(function):
+    def wrapper(*args, **kwargs):
+        # The profiler names this frame after the function
+        return function(*args, **kwargs)
+    return wrapper
+
+_wrapper_code = _wrap(None).__code__
+
+def wrap_utils():
+    if getattr(libcalamares.utils, "_calamares_profiled", False):
+        return
+    for name in ("mount", "create_swapfile", "target_env_call", "check_target_env_call",
+                 "check_target_env_output", "check_target_env_process_output",
+                 "target_env_call_batch", "check_target_env_call_batch"):
+        if hasattr(libcalamares.utils, name):
+            setattr(libcalamares.utils, name, _wrap(getattr(libcalamares.utils, name)))
+    libcalamares.utils._calamares_profiled = True
+
+class Profiler:
+    def __init__(self):
+        self.stacks = {}
+        self.stack = []
+        self.last = time.perf_counter()
+
+    def event(self, frame, event, arg):
+        now = time.perf_counter()
+        if self.stack:
+            key = ";".join(self.stack)
+            self.stacks[key] = self.stacks.get(key, 0.0) + now - self.last
+        self.last = now
+        if event == "call":
+            code = frame.f_code
+            if code is _wrapper_code:
+                name = "libcalamares.utils." + getattr(frame.f_locals["function"], "__name__", "?")
+            else:
+                name = "{} ({}:{})".format(code.co_name, code.co_filename.rsplit("/", 1)[-1], code.co_firstlineno)
+            self.stack.append(name.replace(";", ","))
+        elif event == "c_call":
+            name = "{}.{}".format(getattr(arg, "__module__", None) or "builtins", getattr(arg, "__qualname__", "?"))
+            self.stack.append(name.replace(";", ","))
+        elif self.stack:
+            self.stack.pop()
+
+    def write(self, path):
+        with open(path, "w") as f:
+            for stack, seconds in sorted(self.stacks.items()):
+                f.write("{} {}\n".format(stack, int(seconds * 1000000)))
+        total = sum(self.stacks.values())
+        waiting = sum(t for s, t in self.stacks.items() if "libcalamares.utils." in s)
+        own = {}
+        for stack, seconds in self.stacks.items():
+            frame = stack.rsplit(";", 1)[-1]
+            own[frame] = own.get(frame, 0.0) + seconds
+        libcalamares.utils.debug("Profile {}: {:.3f}s, of which {:.3f}s in libcalamares.utils calls".format(
+            path, total, waiting))
+        for frame, seconds in sorted(own.items(), key=lambda i: i[1], reverse=True)[:5]:
+            libcalamares.utils.debug(" .. {:.3f}s in {}".format(seconds, frame))
+
+def profile_run(run, path):
+    profiler = Profiler()
+    sys.setprofile(profiler.event)
+    try:
+        return run()
+    finally:
+        sys.setprofile(None)
+        profiler.write(path)
+)%";
 
 namespace bp = boost::python;
 
 BOOST_PYTHON_FUNCTION_OVERLOADS( mount_overloads, CalamaresPython::mount, 2, 4 );
+BOOST_PYTHON_FUNCTION_OVERLOADS( create_swapfile_overloads, CalamaresPython::create_swapfile, 2, 3 );
 BOOST_PYTHON_FUNCTION_OVERLOADS( target_env_call_str_overloads, CalamaresPython::target_env_call, 1, 3 );
 BOOST_PYTHON_FUNCTION_OVERLOADS( target_env_call_list_overloads, CalamaresPython::target_env_call, 1, 3 );
 BOOST_PYTHON_FUNCTION_OVERLOADS( check_target_env_call_str_overloads, CalamaresPython::check_target_env_call, 1, 3 );
@@ -36,6 +121,15 @@ BOOST_PYTHON_FUNCTION_OVERLOADS( check_target_env_output_list_overloads,
                                  CalamaresPython::check_target_env_output,
                                  1,
                                  3 );
+BOOST_PYTHON_FUNCTION_OVERLOADS( check_target_env_process_output_overloads,
+                                 CalamaresPython::check_target_env_process_output,
+                                 2,
+                                 4 );
+BOOST_PYTHON_FUNCTION_OVERLOADS( target_env_call_batch_overloads, CalamaresPython::target_env_call_batch, 1, 5 );
+BOOST_PYTHON_FUNCTION_OVERLOADS( check_target_env_call_batch_overloads,
+                                 CalamaresPython::check_target_env_call_batch,
+                                 1,
+                                 5 );
 BOOST_PYTHON_MODULE( libcalamares )
 {
     bp::object package = bp::scope();
@@ -56,7 +150,25 @@ BOOST_PYTHON_MODULE( libcalamares )
               &CalamaresPython::PythonJobInterface::setprogress,
               bp::args( "progress" ),
               "Reports the progress status of this job to Calamares, "
-              "as a real number between 0 and 1." );
+              "as a real number between 0 and 1. During a phase (see "
+              "begin_phase()) this is the progress of the phase." )
+        .def( "begin_phase",
+              &CalamaresPython::PythonJobInterface::begin_phase,
+              bp::args( "name", "weight" ),
+              "Starts a phase of this job, which takes up weight (a real "
+              "number between 0 and 1) of the whole job. A non-empty name "
+              "is shown as status while the phase runs." )
+        .def( "cancelled",
+              &CalamaresPython::PythonJobInterface::cancelled,
+              "Returns True if the installation has been cancelled. A job "
+              "that takes long should check this regularly, and return an "
+              "error when it is set." )
+        .def( "add_statistic",
+              &CalamaresPython::PythonJobInterface::add_statistic,
+              bp::args( "key", "value" ),
+              "Adds value (e.g. a number) under key to the statistics that "
+              "Calamares keeps of this job, in GlobalStorage *jobStatistics* "
+              "and job-statistics.json." );
 
     bp::class_< CalamaresPython::GlobalStoragePythonWrapper >( "GlobalStorage",
                                                                bp::init< Calamares::GlobalStorage* >() )
@@ -88,6 +200,13 @@ BOOST_PYTHON_MODULE( libcalamares )
                               "-1 = QProcess crash\n"
                               "-2 = QProcess cannot start\n"
                               "-3 = bad arguments" ) );
+    bp::def( "create_swapfile",
+             &CalamaresPython::create_swapfile,
+             create_swapfile_overloads( bp::args( "path", "size", "nocow" ),
+                                        "Creates a swapfile of size bytes at path, with fallocate, and writes "
+                                        "the swap header (like mkswap). If nocow is True, the file is marked "
+                                        "No_COW first (like chattr +C), as btrfs needs.\n"
+                                        "Returns 0 on success, or an errno value." ) );
     bp::def(
         "target_env_call",
         static_cast< int ( * )( const std::string&, const std::string&, int ) >( &CalamaresPython::target_env_call ),
@@ -137,6 +256,30 @@ BOOST_PYTHON_MODULE( libcalamares )
                                                      "Runs the specified command in the chroot of the target system.\n"
                                                      "Returns the program's standard output, and raises a "
                                                      "subprocess.CalledProcessError if something went wrong." ) );
+    bp::def( "check_target_env_process_output",
+             &CalamaresPython::check_target_env_process_output,
+             check_target_env_process_output_overloads(
+                 bp::args( "args", "callback", "stdin", "timeout" ),
+                 "Runs the specified command in the chroot of the target system.\n"
+                 "Calls the callback with each line of the program's standard output, "
+                 "while it runs. Returns 0, or raises a subprocess.CalledProcessError "
+                 "if something went wrong." ) );
+    bp::def( "target_env_call_batch",
+             &CalamaresPython::target_env_call_batch,
+             target_env_call_batch_overloads(
+                 bp::args( "commands", "callback", "workers", "stdin", "timeout" ),
+                 "Runs each of the commands (strings or lists of strings) in the chroot "
+                 "of the target system, up to workers (0 for one per CPU) at a time.\n"
+                 "If callback is not None, it is called with the index of the command "
+                 "and each line of its standard output, while the commands run.\n"
+                 "Returns a list of the exit codes of the commands, in order." ) );
+    bp::def( "check_target_env_call_batch",
+             &CalamaresPython::check_target_env_call_batch,
+             check_target_env_call_batch_overloads(
+                 bp::args( "commands", "callback", "workers", "stdin", "timeout" ),
+                 "Runs each of the commands like target_env_call_batch().\n"
+                 "Returns 0 if all of them exited successfully, or raises a "
+                 "subprocess.CalledProcessError for the first one that failed." ) );
     bp::def( "obscure",
              &CalamaresPython::obscure,
              bp::args( "s" ),
@@ -144,6 +287,10 @@ BOOST_PYTHON_MODULE( libcalamares )
              "Returns a string, generated using a simple symmetric encryption.\n"
              "Applying the function to a string obscured by this function will result "
              "in the original string." );
+    bp::def( "stop_target_shells",
+             &CalamaresPython::stop_target_shells,
+             "Stops the persistent shells in the target, which keep it busy.\n"
+             "Call this before unmounting the target." );
 
 
     bp::def( "gettext_languages",
@@ -185,6 +332,13 @@ PythonJob::prettyName() const
 }
 
 
+bool
+PythonJob::runsOnJobThread() const
+{
+    return true;
+}
+
+
 QString
 PythonJob::prettyStatusMessage() const
 {
@@ -249,9 +403,21 @@ PythonJob::exec()
             bp::exec( s_preScript, scriptNamespace, scriptNamespace );
         }
 
+        bp::object profileRun;
+        if ( !s_profileDirectory.isEmpty() )
+        {
+            // Before the script runs, so that it imports the wrapped functions
+            bp::dict profileNamespace = CalamaresPython::Helper::instance()->createCleanNamespace();
+            bp::exec( s_profileScript, profileNamespace, profileNamespace );
+            profileNamespace[ "wrap_utils" ]();
+            profileRun = profileNamespace[ "profile_run" ];
+        }
+
         cDebug() << "Job file" << scriptFI.absoluteFilePath();
-        bp::object execResult
-            = bp::exec_file( scriptFI.absoluteFilePath().toLocal8Bit().data(), scriptNamespace, scriptNamespace );
+        bp::object code
+            = CalamaresPython::Helper::instance()->compiledScript( scriptFI.absoluteFilePath(), prettyName() );
+        bp::object execResult(
+            bp::handle<>( PyEval_EvalCode( code.ptr(), scriptNamespace.ptr(), scriptNamespace.ptr() ) ) );
         bp::object entryPoint = scriptNamespace[ "run" ];
 
         m_d->m_prettyStatusMessage = scriptNamespace.get( "pretty_status_message", bp::object() );
@@ -277,7 +443,19 @@ PythonJob::exec()
         }
         emit progress( 0 );
 
-        bp::object runResult = entryPoint();
+        bp::object runResult;
+        if ( profileRun.is_none() )
+        {
+            runResult = entryPoint();
+        }
+        else
+        {
+            const QString instance
+                = moduleInstance().isEmpty() ? QFileInfo( m_workingPath ).fileName() : moduleInstance();
+            const QString file = QStringLiteral( "python-profile-%1.collapsed" ).arg( instance );
+            const QString path = QDir( s_profileDirectory ).filePath( file );
+            runResult = profileRun( entryPoint, path.toStdString() );
+        }
 
         if ( runResult.is_none() )
         {
@@ -333,4 +511,14 @@ PythonJob::setInjectedPreScript( const char* preScript )
     cDebug() << "Python pre-script set to" << Logger::Pointer( preScript );
 }
 
+void
+PythonJob::setProfileDirectory( const QString& directory )
+{
+    s_profileDirectory = directory;
+    if ( !directory.isEmpty() )
+    {
+        cDebug() << "Python jobs are profiled into" << directory;
+    }
+}
+
 }  // namespace Calamares
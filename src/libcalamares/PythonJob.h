@@ -40,6 +40,8 @@ public:
     QString prettyName() const override;
     QString prettyStatusMessage() const override;
     JobResult exec() override;
+    /// @brief Python jobs share the interpreter, so they stay on the JobQueue thread
+    bool runsOnJobThread() const override;
 
     /** @brief Sets the pre-run Python code for all PythonJobs
      *
@@ -54,6 +56,21 @@ public:
      */
     static void setInjectedPreScript( const char* script );
 
+    /** @brief Profiles the Python code of all PythonJobs
+     *
+     * When @p directory is not empty, the run() of each PythonJob is
+     * profiled, and the time spent in each call stack is written to
+     * `python-profile-<instance>.collapsed` in @p directory, as input
+     * for flamegraph.pl (or speedscope). Calls to the functions of
+     * libcalamares.utils that run commands are frames of their own,
+     * so that waiting for commands is separate from running Python code.
+     * A summary goes to the log. Only the job's own thread is profiled.
+     *
+     * Profiling makes Python code a lot slower; pass an empty directory
+     * to switch it off (the default).
+     */
+    static void setProfileDirectory( const QString& directory );
+
 private:
     struct Private;
 
@@ -14,16 +14,67 @@
 #include "JobQueue.h"
 #include "PythonHelper.h"
 #include "partition/Mount.h"
+#include "partition/Swap.h"
 #include "utils/CalamaresUtilsSystem.h"
+#include "utils/Executor.h"
 #include "utils/Logger.h"
 #include "utils/String.h"
 
 #include <QCoreApplication>
 #include <QDir>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
 #include <QStandardPaths>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <atomic>
+#include <vector>
 
 namespace bp = boost::python;
 
+/** @brief Lets other Python threads run while this one waits in C++
+ *
+ * Use this around calls that block (e.g. waiting for a process), so that
+ * Python modules that use threads are not all held up. Nothing may touch
+ * Python while the GIL is released; see ScopedGILReacquire for callbacks.
+ */
+class ScopedGILRelease
+{
+public:
+    ScopedGILRelease()
+        : m_state( PyEval_SaveThread() )
+    {
+    }
+    ~ScopedGILRelease() { PyEval_RestoreThread( m_state ); }
+
+    ScopedGILRelease( const ScopedGILRelease& ) = delete;
+    ScopedGILRelease& operator=( const ScopedGILRelease& ) = delete;
+
+private:
+    friend class ScopedGILReacquire;
+    PyThreadState* m_state;
+};
+
+/// @brief Takes the GIL back for a while, within a ScopedGILRelease (e.g. to call a callback)
+class ScopedGILReacquire
+{
+public:
+    explicit ScopedGILReacquire( ScopedGILRelease& released )
+        : m_released( released )
+    {
+        PyEval_RestoreThread( m_released.m_state );
+    }
+    ~ScopedGILReacquire() { m_released.m_state = PyEval_SaveThread(); }
+
+    ScopedGILReacquire( const ScopedGILReacquire& ) = delete;
+    ScopedGILReacquire& operator=( const ScopedGILReacquire& ) = delete;
+
+private:
+    ScopedGILRelease& m_released;
+};
+
 static int
 _handle_check_target_env_call_error( const CalamaresUtils::ProcessResult& ec, const QString& cmd )
 {
@@ -55,12 +106,24 @@ mount( const std::string& device_path,
        const std::string& filesystem_name,
        const std::string& options )
 {
-    return CalamaresUtils::Partition::mount( QString::fromStdString( device_path ),
-                                             QString::fromStdString( mount_point ),
-                                             QString::fromStdString( filesystem_name ),
-                                             QString::fromStdString( options ) );
+    const QString device = QString::fromStdString( device_path );
+    const QString mountPoint = QString::fromStdString( mount_point );
+    const QString fs = QString::fromStdString( filesystem_name );
+    const QString opts = QString::fromStdString( options );
+
+    // Mounting does not touch Python, so let other Python threads
+    // run meanwhile (e.g. the mount module mounts in parallel).
+    ScopedGILRelease released;
+    return CalamaresUtils::Partition::mount( device, mountPoint, fs, opts );
 }
 
+int
+create_swapfile( const std::string& path, long long size, bool nocow )
+{
+    const QString p = QString::fromStdString( path );
+    ScopedGILRelease released;
+    return CalamaresUtils::Partition::createSwapFile( p, size, nocow );
+}
 
 static inline QStringList
 _bp_list_to_qstringlist( const bp::list& args )
@@ -76,10 +139,12 @@ _bp_list_to_qstringlist( const bp::list& args )
 static inline CalamaresUtils::ProcessResult
 _target_env_command( const QStringList& args, const std::string& stdin, int timeout )
 {
+    const QString input = QString::fromStdString( stdin );
+    ScopedGILRelease released;
     // Since Python doesn't give us the type system for distinguishing
     // seconds from other integral types, massage to seconds here.
     return CalamaresUtils::System::instance()->targetEnvCommand(
-        args, QString(), QString::fromStdString( stdin ), std::chrono::seconds( timeout ) );
+        args, QString(), input, std::chrono::seconds( timeout ) );
 }
 
 int
@@ -136,6 +201,211 @@ check_target_env_output( const bp::list& args, const std::string& stdin, int tim
     return ec.second.toStdString();
 }
 
+int
+check_target_env_process_output( const bp::list& args,
+                                 const bp::object& callback,
+                                 const std::string& stdin,
+                                 int timeout )
+{
+    using CalamaresUtils::System;
+
+    const QStringList list = _bp_list_to_qstringlist( args );
+    const QString input = QString::fromStdString( stdin );
+    bool callbackFailed = false;
+    CalamaresUtils::ProcessResult ec( 0, QString() );
+    {
+        // Only the callback needs the GIL
+        ScopedGILRelease released;
+        ec = System::runCommandStreaming(
+            System::RunLocation::RunInTarget,
+            list,
+            [ &callback, &callbackFailed, &released ]( System::OutputChannel channel, const QString& line ) {
+                if ( channel != System::OutputChannel::StdOut )
+                {
+                    return true;
+                }
+                const std::string l = line.toStdString();
+                ScopedGILReacquire python( released );
+                try
+                {
+                    callback( l );
+                }
+                catch ( const bp::error_already_set& )
+                {
+                    // The Python exception stays set, and is raised below
+                    callbackFailed = true;
+                    return false;
+                }
+                return true;
+            },
+            QString(),
+            input,
+            std::chrono::seconds( timeout ) );
+    }
+    if ( callbackFailed )
+    {
+        bp::throw_error_already_set();
+    }
+    return _handle_check_target_env_call_error( ec, list.join( ' ' ) );
+}
+
+/// @brief Converts a list of commands (each a string or a list of strings)
+static QList< QStringList >
+_bp_list_to_commands( const bp::list& commands )
+{
+    QList< QStringList > list;
+    for ( int i = 0; i < bp::len( commands ); ++i )
+    {
+        bp::extract< std::string > command( commands[ i ] );
+        if ( command.check() )
+        {
+            list.append( QStringList { QString::fromStdString( command() ) } );
+        }
+        else
+        {
+            list.append( _bp_list_to_qstringlist( bp::extract< bp::list >( commands[ i ] ) ) );
+        }
+    }
+    return list;
+}
+
+/** @brief Runs @p commands in a thread pool, passing output lines to @p callback
+ *
+ * The commands run in worker threads, which do not touch Python at all:
+ * output lines are queued, and handed to the @p callback from this
+ * (the job) thread while waiting for the commands to finish. Other
+ * Python threads may run while this one waits. If the
+ * callback raises, the commands that are still running are cancelled,
+ * and the error is raised once all of them have stopped.
+ */
+static std::vector< CalamaresUtils::ProcessResult >
+_target_env_batch( const QList< QStringList >& commands,
+                   const bp::object& callback,
+                   int workers,
+                   const std::string& stdin,
+                   int timeout )
+{
+    using CalamaresUtils::System;
+
+    const auto location
+        = System::instance()->doChroot() ? System::RunLocation::RunInTarget : System::RunLocation::RunInHost;
+    const QString input = QString::fromStdString( stdin );
+    const bool wantLines = !callback.is_none();
+
+    std::vector< CalamaresUtils::ProcessResult > results( std::size_t( commands.count() ),
+                                                          CalamaresUtils::ProcessResult( 0, QString() ) );
+    QMutex linesMutex;
+    QList< QPair< int, QString > > lines;
+    std::atomic< bool > cancelled { false };
+
+    // The workers stop their commands when the job is cancelled
+    const auto cancellation = CalamaresUtils::Executor::currentCancellation();
+    QThreadPool pool;
+    if ( workers > 0 )
+    {
+        pool.setMaxThreadCount( workers );
+    }
+    cDebug() << "Running" << commands.count() << "commands with" << pool.maxThreadCount() << "workers.";
+    for ( int i = 0; i < commands.count(); ++i )
+    {
+        // The token goes along by value; the pool threads have no scope of their own
+        QtConcurrent::run( &pool, [&, i, cancellation]() {
+            CalamaresUtils::Executor::CancellationScope scope( cancellation );
+            results[ std::size_t( i ) ] = System::runCommandStreaming(
+                location,
+                commands.at( i ),
+                [&, i]( System::OutputChannel channel, const QString& line ) {
+                    if ( wantLines && channel == System::OutputChannel::StdOut )
+                    {
+                        QMutexLocker l( &linesMutex );
+                        lines.append( qMakePair( i, line ) );
+                    }
+                    return !cancelled;
+                },
+                QString(),
+                input,
+                std::chrono::seconds( timeout ) );
+        } );
+    }
+
+    bool callbackFailed = false;
+    auto deliver = [&]() {
+        QList< QPair< int, QString > > pending;
+        {
+            QMutexLocker l( &linesMutex );
+            pending.swap( lines );
+        }
+        for ( const auto& line : qAsConst( pending ) )
+        {
+            if ( callbackFailed )
+            {
+                break;
+            }
+            try
+            {
+                callback( line.first, line.second.toStdString() );
+            }
+            catch ( const bp::error_already_set& )
+            {
+                // The Python exception stays set, and is raised below
+                callbackFailed = true;
+                cancelled = true;
+            }
+        }
+    };
+    // The workers don't need the GIL, only deliver() does
+    auto wait = [ &pool ]() {
+        ScopedGILRelease released;
+        return pool.waitForDone( 50 );
+    };
+    while ( !wait() )
+    {
+        deliver();
+    }
+    deliver();
+
+    if ( callbackFailed )
+    {
+        bp::throw_error_already_set();
+    }
+    return results;
+}
+
+bp::list
+target_env_call_batch( const bp::list& commands,
+                       const bp::object& callback,
+                       int workers,
+                       const std::string& stdin,
+                       int timeout )
+{
+    bp::list exitCodes;
+    for ( const auto& r : _target_env_batch( _bp_list_to_commands( commands ), callback, workers, stdin, timeout ) )
+    {
+        exitCodes.append( r.first );
+    }
+    return exitCodes;
+}
+
+int
+check_target_env_call_batch( const bp::list& commands,
+                             const bp::object& callback,
+                             int workers,
+                             const std::string& stdin,
+                             int timeout )
+{
+    const auto list = _bp_list_to_commands( commands );
+    const auto results = _target_env_batch( list, callback, workers, stdin, timeout );
+    for ( int i = 0; i < list.count(); ++i )
+    {
+        const auto& r = results.at( std::size_t( i ) );
+        if ( r.first )
+        {
+            return _handle_check_target_env_call_error( r, list.at( i ).join( ' ' ) );
+        }
+    }
+    return 0;
+}
+
 static const char output_prefix[] = "[PYTHON JOB]:";
 
 void
@@ -166,16 +436,40 @@ PythonJobInterface::setprogress( qreal progress )
 {
     if ( progress >= 0.0 && progress <= 1.0 )
     {
-        m_parent->emitProgress( progress );
+        m_parent->emitProgress( m_parent->overallProgress( progress ) );
     }
 }
 
+void
+PythonJobInterface::begin_phase( const std::string& name, qreal weight )
+{
+    m_parent->beginPhase( QString::fromStdString( name ), weight );
+}
+
+bool
+PythonJobInterface::cancelled() const
+{
+    return m_parent->isCancelled();
+}
+
+void
+PythonJobInterface::add_statistic( const std::string& key, const boost::python::object& value )
+{
+    m_parent->addStatistic( QString::fromStdString( key ), variantFromPyObject( value ) );
+}
+
 std::string
 obscure( const std::string& string )
 {
     return CalamaresUtils::obscure( QString::fromStdString( string ) ).toStdString();
 }
 
+void
+stop_target_shells()
+{
+    CalamaresUtils::System::stopTargetShells();
+}
+
 static QStringList
 _gettext_languages()
 {
@@ -28,6 +28,8 @@ int mount( const std::string& device_path,
            const std::string& filesystem_name = std::string(),
            const std::string& options = std::string() );
 
+int create_swapfile( const std::string& path, long long size, bool nocow = false );
+
 int target_env_call( const std::string& command, const std::string& stdin = std::string(), int timeout = 0 );
 
 int target_env_call( const boost::python::list& args, const std::string& stdin = std::string(), int timeout = 0 );
@@ -42,8 +44,50 @@ check_target_env_output( const std::string& command, const std::string& stdin =
 std::string
 check_target_env_output( const boost::python::list& args, const std::string& stdin = std::string(), int timeout = 0 );
 
+/** @brief Runs @p args in the target system, calling @p callback for each line of output
+ *
+ * The @p callback is called with each line (a string, without the newline)
+ * that the command writes to standard output, while the command runs.
+ * Returns 0 or raises a subprocess.CalledProcessError, like check_target_env_call().
+ * An exception from the callback stops the command, and is raised again.
+ */
+int check_target_env_process_output( const boost::python::list& args,
+                                     const boost::python::object& callback,
+                                     const std::string& stdin = std::string(),
+                                     int timeout = 0 );
+
+/** @brief Runs all the @p commands in the target system, several at a time
+ *
+ * Each entry of @p commands is a string or a list of strings, like the
+ * argument to target_env_call(). At most @p workers commands run at
+ * the same time (0 means: as many as there are CPUs), each with the
+ * given @p stdin and @p timeout. If @p callback is not None, it is called
+ * (in the job thread) with the index of the command and a line of its
+ * standard output, while the commands run.
+ *
+ * Returns a list with the exit code of each command, in order.
+ */
+boost::python::list target_env_call_batch( const boost::python::list& commands,
+                                           const boost::python::object& callback = boost::python::object(),
+                                           int workers = 0,
+                                           const std::string& stdin = std::string(),
+                                           int timeout = 0 );
+/** @brief Like target_env_call_batch(), but raises for the first command that failed
+ *
+ * All the commands are run; then a subprocess.CalledProcessError is raised
+ * for the first command (in order) that failed. Returns 0 otherwise.
+ */
+int check_target_env_call_batch( const boost::python::list& commands,
+                                 const boost::python::object& callback = boost::python::object(),
+                                 int workers = 0,
+                                 const std::string& stdin = std::string(),
+                                 int timeout = 0 );
+
 std::string obscure( const std::string& string );
 
+/// @brief Stops the persistent shells in the target, see System::stopTargetShells()
+void stop_target_shells();
+
 boost::python::object gettext_path();
 
 boost::python::list gettext_languages();
@@ -63,6 +107,9 @@ public:
     boost::python::dict configuration;
 
     void setprogress( qreal progress );
+    void begin_phase( const std::string& name, qreal weight );
+    bool cancelled() const;
+    void add_statistic( const std::string& key, const boost::python::object& value );
 
 private:
     Calamares::PythonJob* m_parent;
@@ -60,6 +60,22 @@ requireBool( const YAML::Node& config, const char* key, bool d )
     }
 }
 
+/** @brief Helper function to grab an optional bool out of the config, silently using @p d if not present. */
+static bool
+optionalBool( const YAML::Node& config, const char* key, bool d )
+{
+    auto v = config[ key ];
+    return hasValue( v ) ? v.as< bool >() : d;
+}
+
+/** @brief Helper function to grab an optional QString out of the config, silently using an empty string. */
+static QString
+optionalString( const YAML::Node& config, const char* key )
+{
+    auto v = config[ key ];
+    return hasValue( v ) ? QString::fromStdString( v.as< std::string >() ) : QString();
+}
+
 namespace Calamares
 {
 
@@ -95,6 +111,9 @@ InstanceDescription::fromSettings( const QVariantMap& m )
         {
             r.m_configFileName = c;
         }
+
+        r.m_readResources = m.value( "reads" ).toStringList();
+        r.m_writeResources = m.value( "writes" ).toStringList();
     }
     return r;
 }
@@ -207,6 +226,10 @@ interpretSequence( const YAML::Node& node, Settings::ModuleSequence& moduleSeque
             {
                 thisAction = ModuleSystem::Action::Exec;
             }
+            else if ( thisActionS == "prepare" )
+            {
+                thisAction = ModuleSystem::Action::Prepare;
+            }
             else
             {
                 cDebug() << "Unknown action in *sequence*" << thisActionS;
@@ -317,6 +340,20 @@ Settings::setConfiguration( const QByteArray& ba, const QString& explainName )
         m_disableCancelDuringExec = requireBool( config, "disable-cancel-during-exec", false );
         m_hideBackAndNextDuringExec = requireBool( config, "hide-back-and-next-during-exec", false );
         m_quitAtEnd = requireBool( config, "quit-at-end", false );
+        m_persistentTargetShell = optionalBool( config, "persistent-target-shell", false );
+        m_lazyJobPlugins = optionalBool( config, "lazy-job-plugins", false );
+        m_releasePagesDuringExec = optionalBool( config, "release-pages-during-exec", false );
+        m_networkCacheDirectory = optionalString( config, "network-cache" );
+        m_jobTimingsFile = optionalString( config, "job-timings" );
+        m_jobCheckpointDirectory = optionalString( config, "job-checkpoints" );
+        if ( config[ "geoip" ] && config[ "geoip" ].IsMap() )
+        {
+            m_geoipConfiguration = CalamaresUtils::yamlMapToVariant( config[ "geoip" ] );
+        }
+        if ( config[ "exec-tuning" ] && config[ "exec-tuning" ].IsMap() )
+        {
+            m_execTuning = CalamaresUtils::yamlMapToVariant( config[ "exec-tuning" ] );
+        }
 
         reconcileInstancesAndSequence();
     }
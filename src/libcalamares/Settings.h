@@ -20,6 +20,7 @@
 
 #include <QObject>
 #include <QStringList>
+#include <QVariantMap>
 
 
 namespace Calamares
@@ -64,10 +65,21 @@ public:
     int weight() const { return m_weight < 0 ? 1 : m_weight; }
     bool explicitWeight() const { return m_weight > 0; }
 
+    /** @brief Resources read by the jobs of this instance
+     *
+     * Set from the *reads* key in the *instances* section; these
+     * are applied to the jobs of the module (see Job::setResources()).
+     */
+    QStringList readResources() const { return m_readResources; }
+    /// @brief Resources written by the jobs of this instance (*writes* key)
+    QStringList writeResources() const { return m_writeResources; }
+
 private:
     InstanceKey m_instanceKey;
     QString m_configFileName;
     int m_weight = 0;
+    QStringList m_readResources;
+    QStringList m_writeResources;
 };
 
 class DLLEXPORT Settings : public QObject
@@ -162,6 +174,64 @@ public:
     /** @brief Is quit-at-end set? (Quit automatically when done) */
     bool quitAtEnd() const { return m_quitAtEnd; }
 
+    /** @brief Is persistent-target-shell set?
+     *
+     * When set, commands in the target system are run through
+     * a long-lived shell in the chroot, instead of starting a
+     * new chroot for each command.
+     */
+    bool persistentTargetShell() const { return m_persistentTargetShell; }
+
+    /** @brief Is lazy-job-plugins set?
+     *
+     * When set, the plugins for C++ job modules are not loaded at
+     * startup, but only when their jobs are queued for execution.
+     */
+    bool lazyJobPlugins() const { return m_lazyJobPlugins; }
+
+    /** @brief Is release-pages-during-exec set?
+     *
+     * If so, when an exec phase starts, the pages before it (which
+     * can not be shown again) let go of their widgets, and the image
+     * caches are emptied, to leave more memory for the jobs.
+     */
+    bool releasePagesDuringExec() const { return m_releasePagesDuringExec; }
+
+    /** @brief Directory for the on-disk cache of network requests
+     *
+     * This is empty if network-cache is not set, in which
+     * case nothing downloaded is kept across runs.
+     */
+    QString networkCacheDirectory() const { return m_networkCacheDirectory; }
+
+    /** @brief Job statistics of an earlier run, for time estimates
+     *
+     * This is the *job-timings* file from settings.conf (empty if not
+     * set), see JobQueue::loadTimingProfile().
+     */
+    QString jobTimingsFile() const { return m_jobTimingsFile; }
+
+    /** @brief Directory for job checkpoints, to resume failed installations
+     *
+     * This is the *job-checkpoints* directory from settings.conf (empty
+     * if not set), see JobQueue::setCheckpointDirectory().
+     */
+    QString jobCheckpointDirectory() const { return m_jobCheckpointDirectory; }
+
+    /** @brief Configuration for the application-wide GeoIP lookup
+     *
+     * This is the *geoip* map from settings.conf (empty if not set);
+     * it has the same format as the *geoip* map in the locale module.
+     */
+    QVariantMap geoipConfiguration() const { return m_geoipConfiguration; }
+
+    /** @brief How to tune the live system while the jobs run
+     *
+     * This is the *exec-tuning* map from settings.conf (empty if not set),
+     * see CalamaresUtils::SystemTuning::Profile and JobQueue::setTuning().
+     */
+    QVariantMap execTuning() const { return m_execTuning; }
+
 private:
     static Settings* s_instance;
 
@@ -171,6 +241,11 @@ private:
     ModuleSequence m_modulesSequence;
 
     QString m_brandingComponentName;
+    QString m_networkCacheDirectory;
+    QString m_jobTimingsFile;
+    QString m_jobCheckpointDirectory;
+    QVariantMap m_geoipConfiguration;
+    QVariantMap m_execTuning;
 
     // bools are initialized here according to default setting
     bool m_debug;
@@ -181,6 +256,9 @@ private:
     bool m_disableCancelDuringExec = false;
     bool m_hideBackAndNextDuringExec = false;
     bool m_quitAtEnd = false;
+    bool m_persistentTargetShell = false;
+    bool m_lazyJobPlugins = false;
+    bool m_releasePagesDuringExec = false;
 };
 
 }  // namespace Calamares
@@ -13,10 +13,13 @@
 #include "JobQueue.h"
 #include "Settings.h"
 #include "modulesystem/InstanceKey.h"
+#include "utils/CalamaresUtilsSystem.h"
 #include "utils/Logger.h"
 
+#include <QJsonDocument>
 #include <QObject>
 #include <QSignalSpy>
+#include <QTemporaryDir>
 #include <QtTest/QtTest>
 
 class TestLibCalamares : public QObject
@@ -28,9 +31,11 @@ public:
 
 private Q_SLOTS:
     void testGSModify();
+    void testGSKeyChanged();
     void testGSLoadSave();
     void testGSLoadSave2();
     void testGSLoadSaveYAMLStringList();
+    void testGSLoadSaveNested();
 
     void testInstanceKey();
     void testInstanceDescription();
@@ -38,6 +43,12 @@ private Q_SLOTS:
     void testSettings();
 
     void testJobQueue();
+    void testJobQueueConcurrent();
+    void testJobQueueCheckpoint();
+    void testJobQueuePrepare();
+    void testJobQueueWatchdog();
+    void testJobQueueCancel();
+    void testJobPhases();
 };
 
 void
@@ -66,6 +77,33 @@ TestLibCalamares::testGSModify()
     QCOMPARE( spy.count(), 2 );  // one insert, one remove
 }
 
+void
+TestLibCalamares::testGSKeyChanged()
+{
+    Calamares::GlobalStorage gs;
+    QSignalSpy spy( &gs, &Calamares::GlobalStorage::keyChanged );
+
+    const auto v0 = gs.version();
+    gs.insert( "derp", 17 );
+    const auto snapshot = gs.data();
+    gs.insert( "dorp", 18 );
+    QVERIFY( gs.version() > v0 );
+    QCOMPARE( spy.count(), 2 );
+    QCOMPARE( spy.at( 0 ).first().toString(), QStringLiteral( "derp" ) );
+    QCOMPARE( spy.at( 1 ).first().toString(), QStringLiteral( "dorp" ) );
+
+    // The snapshot is not affected by later changes
+    QCOMPARE( snapshot.count(), 1 );
+    QCOMPARE( gs.count(), 2 );
+
+    // Removing a non-existent key changes no key
+    gs.remove( "cow" );
+    QCOMPARE( spy.count(), 2 );
+    gs.remove( "derp" );
+    QCOMPARE( spy.count(), 3 );
+    QCOMPARE( spy.at( 2 ).first().toString(), QStringLiteral( "derp" ) );
+}
+
 void
 TestLibCalamares::testGSLoadSave()
 {
@@ -176,6 +214,61 @@ TestLibCalamares::testGSLoadSaveYAMLStringList()
     QCOMPARE( gs2.value( "dwarfs" ).toString(), QStringLiteral( "<QStringList>" ) );  // .. they're gone
 }
 
+void
+TestLibCalamares::testGSLoadSaveNested()
+{
+    Calamares::GlobalStorage gs;
+    const QString jsonfilename( "gs.test-nested.json" );
+    const QString binaryfilename( "gs.test-nested.bin" );
+
+    QVariantMap partition;
+    partition.insert( "device", "/dev/sda1" );
+    partition.insert( "size", 1024LL * 1024 * 1024 * 16 );
+    partition.insert( "claimed", true );
+    partition.insert( "fraction", 0.25 );
+    partition.insert( "label", QString( "tab\there \"quoted\" \\ and \x01" ) );
+    partition.insert( "features", QVariantMap() );
+    gs.insert( "partitions", QVariantList { partition, partition } );
+    gs.insert( "empty", QVariantList() );
+    gs.insert( "nothing", QVariant() );
+    gs.insert( "dwarfs", QStringList { "dopey", "sneezy" } );
+
+    // Same as what Qt's own JSON writer would say
+    QVERIFY( gs.saveJson( jsonfilename ) );
+    QFile f( jsonfilename );
+    QVERIFY( f.open( QIODevice::ReadOnly ) );
+    QJsonParseError e;
+    QJsonDocument d = QJsonDocument::fromJson( f.readAll(), &e );
+    QCOMPARE( e.error, QJsonParseError::NoError );
+    QCOMPARE( d, QJsonDocument::fromVariant( gs.data() ) );
+
+    Calamares::GlobalStorage gs2;
+    QVERIFY( gs2.loadJson( jsonfilename ) );
+    QCOMPARE( gs2.count(), gs.count() );
+
+    // Integers are exact, where a double is not
+    Calamares::GlobalStorage gsBig;
+    gsBig.insert( "big", ( 1LL << 53 ) + 1 );
+    QVERIFY( gsBig.saveJson( jsonfilename ) );
+    QFile fBig( jsonfilename );
+    QVERIFY( fBig.open( QIODevice::ReadOnly ) );
+    QVERIFY( fBig.readAll().contains( "9007199254740993" ) );
+
+    // Binary keeps the types, too
+    QVERIFY( gs.saveBinary( binaryfilename ) );
+    Calamares::GlobalStorage gs3;
+    gs3.insert( "derp", 17 );
+    QVERIFY( gs3.loadBinary( binaryfilename ) );
+    QCOMPARE( gs3.count(), gs.count() + 1 );
+    QCOMPARE( gs3.value( "partitions" ), gs.value( "partitions" ) );
+    QCOMPARE( gs3.value( "partitions" ).toList().first().toMap().value( "size" ).type(), QVariant::LongLong );
+    QCOMPARE( gs3.value( "dwarfs" ).type(), QVariant::StringList );
+
+    // Not binary, and not there
+    QVERIFY( !gs3.loadBinary( jsonfilename ) );
+    QVERIFY( !gs3.loadBinary( "gs.test-missing.bin" ) );
+}
+
 void
 TestLibCalamares::testInstanceKey()
 {
@@ -558,7 +651,19 @@ TestLibCalamares::testJobQueue()
         // 90% by the job itself
         // 100% by the queue at job end
         // 100% by the queue at queue end
-        QCOMPARE( spy_progress.count(), 5 );
+        //
+        // Progress is coalesced, so reports that come in quick succession
+        // (0% and 50%, 90% and the two 100%s) may be delivered as one.
+        QVERIFY( spy_progress.count() >= 2 );
+        QVERIFY( spy_progress.count() <= 5 );
+        QCOMPARE( spy_progress.last().first().toReal(), 1.0 );
+
+        const auto statistics = q.globalStorage()->value( "jobStatistics" ).toList();
+        QCOMPARE( statistics.count(), 1 );
+        const auto jobStatistics = statistics.first().toMap();
+        QCOMPARE( jobStatistics.value( "name" ).toString(), QStringLiteral( "DummyJob" ) );
+        QVERIFY( jobStatistics.value( "success" ).toBool() );
+        QVERIFY( jobStatistics.value( "wallTime" ).toLongLong() >= MAX_TEST_SLEEP * 1000 );
     }
 
     {
@@ -590,7 +695,11 @@ TestLibCalamares::testJobQueue()
         // 4 more for the next job
         // 4 more for the next job
         // 100% by the queue at queue end
-        QCOMPARE( spy_progress.count(), 13 );
+        //
+        // With coalescing, at least the reports on either side of
+        // each job's sleep are delivered separately.
+        QVERIFY( spy_progress.count() >= 4 );
+        QVERIFY( spy_progress.count() <= 13 );
 
         /* Consider how progress will be reported:
          *
@@ -629,6 +738,267 @@ TestLibCalamares::testJobQueue()
     }
 }
 
+void
+TestLibCalamares::testJobQueueConcurrent()
+{
+    {
+        DummyJob j0( nullptr );
+        DummyJob j1( nullptr );
+        QVERIFY( !j0.hasResources() );
+        QVERIFY( j0.conflictsWith( j1 ) );  // Undeclared conflicts with everything
+
+        j0.setResources( { "/etc/hostname" }, { "/etc/machine-id" } );
+        QVERIFY( j0.conflictsWith( j1 ) );
+        j1.setResources( { "/etc/hostname" }, { "/etc/adjtime" } );
+        QVERIFY( !j0.conflictsWith( j1 ) );  // Both only read hostname
+        QVERIFY( !j1.conflictsWith( j0 ) );
+        j1.setResources( { "/etc/machine-id" }, {} );
+        QVERIFY( j0.conflictsWith( j1 ) );  // j0 writes what j1 reads
+        QVERIFY( j1.conflictsWith( j0 ) );
+    }
+
+    // Two non-conflicting jobs run side-by-side, so together they take
+    // about as long as one job.
+    {
+        Calamares::JobQueue q;
+        auto* j0 = new DummyJob( nullptr );
+        j0->setResources( {}, { "gs:derp" } );
+        auto* j1 = new DummyJob( nullptr );
+        j1->setResources( {}, { "gs:dorp" } );
+        q.enqueue( 8, Calamares::JobList() << Calamares::job_ptr( j0 ) << Calamares::job_ptr( j1 ) );
+
+        QSignalSpy spy_progress( &q, &Calamares::JobQueue::progress );
+        QSignalSpy spy_finished( &q, &Calamares::JobQueue::finished );
+        QSignalSpy spy_failed( &q, &Calamares::JobQueue::failed );
+
+        QElapsedTimer timer;
+        timer.start();
+        QEventLoop loop;
+        connect( &q, &Calamares::JobQueue::finished, &loop, &QEventLoop::quit );
+        QTimer::singleShot( 3 * MAX_TEST_DURATION, &loop, &QEventLoop::quit );
+        q.start();
+        loop.exec();
+        QVERIFY( !q.isRunning() );
+        QCOMPARE( spy_finished.count(), 1 );
+        QCOMPARE( spy_failed.count(), 0 );
+        QVERIFY( timer.elapsed() < MAX_TEST_DURATION.count() );
+        QCOMPARE( spy_progress.last().first().toReal(), 1.0 );
+    }
+}
+
+
+/// @brief Counts how often it runs, and stores its name in GS
+class CountingJob : public Calamares::Job
+{
+public:
+    CountingJob( const QString& name, bool fail )
+        : Calamares::Job( nullptr )
+        , m_name( name )
+        , m_fail( fail )
+    {
+        setModuleInstance( name );
+    }
+    ~CountingJob() override;
+
+    QString prettyName() const override { return m_name; }
+    Calamares::JobResult exec() override
+    {
+        s_runs.append( m_name );
+        if ( m_fail )
+        {
+            return Calamares::JobResult::error( m_name );
+        }
+        Calamares::JobQueue::instanceGlobalStorage()->insert( m_name, true );
+        return Calamares::JobResult::ok();
+    }
+
+    static QStringList s_runs;
+
+private:
+    QString m_name;
+    bool m_fail;
+};
+
+QStringList CountingJob::s_runs;
+
+CountingJob::~CountingJob() {}
+
+void
+TestLibCalamares::testJobQueueCheckpoint()
+{
+    QTemporaryDir tempRoot( QDir::tempPath() + QStringLiteral( "/test-checkpoint-XXXXXX" ) );
+    QVERIFY( tempRoot.isValid() );
+    const QString checkpoints = tempRoot.filePath( QStringLiteral( "checkpoints" ) );
+
+    auto runQueue = [ & ]( bool failSecond ) {
+        Calamares::JobQueue q;
+        QVERIFY( q.setCheckpointDirectory( checkpoints ) );
+        for ( const auto& name : QStringList { "one", "two", "three" } )
+        {
+            const bool fail = failSecond && name == QStringLiteral( "two" );
+            q.enqueue( 1, Calamares::JobList() << Calamares::job_ptr( new CountingJob( name, fail ) ) );
+        }
+
+        QSignalSpy spy_failed( &q, &Calamares::JobQueue::failed );
+        QEventLoop loop;
+        connect( &q, &Calamares::JobQueue::finished, &loop, &QEventLoop::quit );
+        QTimer::singleShot( MAX_TEST_DURATION, &loop, &QEventLoop::quit );
+        q.start();
+        loop.exec();
+        QVERIFY( !q.isRunning() );
+        QCOMPARE( spy_failed.count(), failSecond ? 1 : 0 );
+        if ( !failSecond )
+        {
+            // Restored from the checkpoint, since "one" did not run again
+            QVERIFY( q.globalStorage()->value( QStringLiteral( "one" ) ).toBool() );
+            QVERIFY( q.globalStorage()->value( QStringLiteral( "three" ) ).toBool() );
+        }
+    };
+
+    CountingJob::s_runs.clear();
+    runQueue( true );
+    QCOMPARE( CountingJob::s_runs, QStringList( { "one", "two" } ) );
+    QVERIFY( QFile::exists( QDir( checkpoints ).filePath( "checkpoint.json" ) ) );
+
+    // Everything after the failure runs
+    CountingJob::s_runs.clear();
+    runQueue( false );
+    QCOMPARE( CountingJob::s_runs, QStringList( { "two", "three" } ) );
+    // .. and after success, the next run starts from scratch
+    QVERIFY( !QFile::exists( QDir( checkpoints ).filePath( "checkpoint.json" ) ) );
+
+    CountingJob::s_runs.clear();
+    runQueue( false );
+    QCOMPARE( CountingJob::s_runs, QStringList( { "one", "two", "three" } ) );
+}
+
+void
+TestLibCalamares::testJobQueuePrepare()
+{
+    CountingJob::s_runs.clear();
+    Calamares::JobQueue q;
+    q.prepare( Calamares::JobList() << Calamares::job_ptr( new CountingJob( "early", false ) )
+                                    << Calamares::job_ptr( new CountingJob( "broken", true ) ) );
+    q.prepare( Calamares::JobList() << Calamares::job_ptr( new CountingJob( "later", false ) ) );
+    q.enqueue( 1, Calamares::JobList() << Calamares::job_ptr( new CountingJob( "exec", false ) ) );
+
+    QSignalSpy spy_failed( &q, &Calamares::JobQueue::failed );
+    QEventLoop loop;
+    connect( &q, &Calamares::JobQueue::finished, &loop, &QEventLoop::quit );
+    QTimer::singleShot( MAX_TEST_DURATION, &loop, &QEventLoop::quit );
+    q.start();
+    loop.exec();
+    QVERIFY( !q.isRunning() );
+
+    // Prepare jobs run in order, before the queue, and failing is not fatal
+    QCOMPARE( spy_failed.count(), 0 );
+    QCOMPARE( CountingJob::s_runs, QStringList( { "early", "broken", "later", "exec" } ) );
+    QCOMPARE( q.globalStorage()->value( "preparedJobs" ).toStringList(), QStringList( { "early", "later" } ) );
+    QVERIFY( q.globalStorage()->value( "later" ).toBool() );
+}
+
+void
+TestLibCalamares::testJobQueueWatchdog()
+{
+    Calamares::JobQueue q;
+    // DummyJob reports progress, then sleeps for seconds
+    q.setWatchdogLimits( 100, 200 );
+    q.enqueue( 1, Calamares::JobList() << Calamares::job_ptr( new DummyJob( this ) ) );
+
+    QSignalSpy spy_slow( &q, &Calamares::JobQueue::jobSlow );
+    QEventLoop loop;
+    connect( &q, &Calamares::JobQueue::finished, &loop, &QEventLoop::quit );
+    QTimer::singleShot( MAX_TEST_DURATION, &loop, &QEventLoop::quit );
+    q.start();
+    loop.exec();
+    QVERIFY( !q.isRunning() );
+
+    // Reported late (maybe more than once), and no longer when done
+    QVERIFY( spy_slow.count() >= 2 );
+    QCOMPARE( spy_slow.first().first().toString(), QStringLiteral( "DummyJob" ) );
+    QVERIFY( spy_slow.last().first().toString().isEmpty() );
+}
+
+/// @brief Runs a command that takes (much) longer than the test
+class SleepingJob : public Calamares::Job
+{
+public:
+    SleepingJob()
+        : Calamares::Job( nullptr )
+    {
+    }
+    ~SleepingJob() override;
+
+    QString prettyName() const override { return QStringLiteral( "SleepingJob" ); }
+    Calamares::JobResult exec() override
+    {
+        auto r = CalamaresUtils::System::runCommand( CalamaresUtils::System::RunLocation::RunInHost,
+                                                     { QStringLiteral( "sleep" ), QStringLiteral( "30" ) } );
+        return r.explainProcess( QStringLiteral( "sleep" ), std::chrono::seconds( 0 ) );
+    }
+};
+
+SleepingJob::~SleepingJob() {}
+
+void
+TestLibCalamares::testJobQueueCancel()
+{
+    CountingJob::s_runs.clear();
+    Calamares::JobQueue q;
+    auto emergency = Calamares::job_ptr( new CountingJob( "cleanup", false ) );
+    emergency->setEmergency( true );
+    q.enqueue( 1,
+               Calamares::JobList() << Calamares::job_ptr( new SleepingJob() )
+                                    << Calamares::job_ptr( new CountingJob( "skipped", false ) ) << emergency );
+
+    QSignalSpy spy_failed( &q, &Calamares::JobQueue::failed );
+    QEventLoop loop;
+    connect( &q, &Calamares::JobQueue::finished, &loop, &QEventLoop::quit );
+    QTimer::singleShot( MAX_TEST_DURATION, &loop, &QEventLoop::quit );
+    QTimer::singleShot( 200, &q, &Calamares::JobQueue::cancel );
+    QElapsedTimer timer;
+    timer.start();
+    q.start();
+    loop.exec();
+
+    // The sleep is stopped, so the queue is done long before the command would be
+    QVERIFY( !q.isRunning() );
+    QVERIFY( timer.elapsed() < MAX_TEST_DURATION.count() );
+    QCOMPARE( spy_failed.count(), 1 );
+    QCOMPARE( spy_failed.first().first().toString(), QStringLiteral( "The installation was cancelled." ) );
+    // Only the emergency job ran after the cancel
+    QCOMPARE( CountingJob::s_runs, QStringList { "cleanup" } );
+}
+
+void
+TestLibCalamares::testJobPhases()
+{
+    DummyJob job( this );
+    QSignalSpy spy( &job, &Calamares::Job::progress );
+
+    // Without phases, progress is for the whole job
+    QCOMPARE( job.overallProgress( 0.5 ), 0.5 );
+    QVERIFY( job.currentPhase().isEmpty() );
+
+    job.beginPhase( QStringLiteral( "first" ), 0.25 );
+    QCOMPARE( job.currentPhase(), QStringLiteral( "first" ) );
+    QCOMPARE( spy.count(), 1 );
+    QCOMPARE( spy.last().first().toReal(), 0.0 );
+    job.setPhaseProgress( 0.5 );
+    QCOMPARE( spy.last().first().toReal(), 0.125 );
+
+    // Unnamed, and more weight than is left
+    job.beginPhase( QString(), 1.0 );
+    QVERIFY( job.currentPhase().isEmpty() );
+    QCOMPARE( spy.last().first().toReal(), 0.25 );
+    job.setPhaseProgress( 0.5 );
+    QCOMPARE( spy.last().first().toReal(), 0.625 );
+    job.setPhaseProgress( 1.0 );
+    QCOMPARE( spy.last().first().toReal(), 1.0 );
+
+    job.clearPhases();
+    QCOMPARE( job.overallProgress( 0.5 ), 0.5 );
+}
 
 QTEST_GUILESS_MAIN( TestLibCalamares )
 
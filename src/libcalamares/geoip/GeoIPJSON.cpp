@@ -47,12 +47,8 @@ selectMap( const QVariantMap& m, const QStringList& l, int index )
     }
     else
     {
-        bool success = false;  // bogus
-        if ( m.contains( attributeName ) )
-        {
-            return selectMap( CalamaresUtils::getSubMap( m, attributeName, success ), l, index + 1 );
-        }
-        return QString();
+        const auto* subMap = CalamaresUtils::subMap( m, attributeName );
+        return subMap ? selectMap( *subMap, l, index + 1 ) : QString();
     }
 }
 
@@ -15,9 +15,11 @@
 #include "GeoIPXML.h"
 #endif
 #include "Handler.h"
+#include "Prefetch.h"
 
 #include "network/Manager.h"
 
+#include <QTcpServer>
 #include <QtTest/QtTest>
 
 QTEST_GUILESS_MAIN( GeoIPTests )
@@ -187,6 +189,91 @@ GeoIPTests::testSplitTZ()
 }
 
 
+void
+GeoIPTests::testProviders()
+{
+    using namespace CalamaresUtils::GeoIP;
+
+    QVariantMap fixed { { "style", "fixed" }, { "url", "http://example.com" }, { "selector", "Europe/Amsterdam" } };
+    QVariantMap bogus { { "style", "bogus" }, { "url", "http://example.com" }, { "selector", "" } };
+    QVariantMap json { { "style", "json" }, { "url", "https://geoip.kde.org/v1/calamares" }, { "selector", "" } };
+
+    // Unusable styles are dropped
+    {
+        Handler h( bogus );
+        QVERIFY( !h.isValid() );
+        QCOMPARE( h.type(), Handler::Type::None );
+        QCOMPARE( h.providers().count(), 0 );
+    }
+    // The top-level provider comes first, then the list
+    {
+        QVariantMap config = json;
+        config.insert( "providers", QVariantList { bogus, fixed } );
+        Handler h( config );
+        QVERIFY( h.isValid() );
+        QCOMPARE( h.providers().count(), 2 );
+        QCOMPARE( h.type(), Handler::Type::JSON );
+        QCOMPARE( h.providers().at( 1 ).type, Handler::Type::Fixed );
+        QCOMPARE( h.providers().at( 1 ).selector, QStringLiteral( "Europe/Amsterdam" ) );
+    }
+    // An unusable top-level is OK if the list has something
+    {
+        QVariantMap config { { "style", "none" }, { "url", "" }, { "selector", "" } };
+        config.insert( "providers", QVariantList { fixed } );
+        Handler h( config );
+        QVERIFY( h.isValid() );
+        QCOMPARE( h.type(), Handler::Type::Fixed );
+        QCOMPARE( h.url(), QStringLiteral( "http://example.com" ) );
+    }
+}
+
+void
+GeoIPTests::testFixedFallback()
+{
+    using namespace CalamaresUtils::GeoIP;
+
+    // A URL on localhost where nothing listens, so the fetch fails
+    QTcpServer server;
+    QVERIFY( server.listen( QHostAddress::LocalHost ) );
+    const QString url = QStringLiteral( "http://127.0.0.1:%1/" ).arg( server.serverPort() );
+    server.close();
+
+    Handler h( QStringLiteral( "fixed" ), url, QStringLiteral( "America/Vancouver" ) );
+    QVERIFY( h.isValid() );
+    auto tz = h.get();
+    QCOMPARE( tz.first, QStringLiteral( "America" ) );
+    QCOMPARE( tz.second, QStringLiteral( "Vancouver" ) );
+    QCOMPARE( h.getRaw(), QStringLiteral( "America/Vancouver" ) );
+
+    // Together with a provider that fails, too
+    QVariantMap config { { "style", "json" }, { "url", url }, { "selector", "" } };
+    config.insert( "providers",
+                   QVariantList { QVariantMap {
+                       { "style", "fixed" }, { "url", url }, { "selector", "Europe/Amsterdam" } } } );
+    Handler both( config );
+    QCOMPARE( both.providers().count(), 2 );
+    tz = both.get();
+    QCOMPARE( tz.first, QStringLiteral( "Europe" ) );
+    QCOMPARE( tz.second, QStringLiteral( "Amsterdam" ) );
+}
+
+void
+GeoIPTests::testPrefetchUnconfigured()
+{
+    using namespace CalamaresUtils::GeoIP;
+
+    auto& prefetch = Prefetch::instance();
+    QCOMPARE( prefetch.state(), Prefetch::State::Idle );
+
+    // Nothing usable, so nothing is started
+    prefetch.start( QVariantMap { { "style", "bogus" }, { "url", "http://example.com" }, { "selector", "" } } );
+    QCOMPARE( prefetch.state(), Prefetch::State::Idle );
+    QVERIFY( !prefetch.timezone().isValid() );
+    QVERIFY( prefetch.countryCode().isEmpty() );
+    QCOMPARE( Prefetch::globalStorageKey(), QStringLiteral( "geoip" ) );
+}
+
+
 #define CHECK_GET( t, selector, url ) \
     { \
         auto tz = GeoIP##t( selector ) \
@@ -30,6 +30,9 @@ private Q_SLOTS:
     void testXMLalt();
     void testXMLbad();
     void testSplitTZ();
+    void testProviders();
+    void testFixedFallback();
+    void testPrefetchUnconfigured();
 
     void testGet();
 };
@@ -17,10 +17,18 @@
 
 #include "Settings.h"
 #include "network/Manager.h"
+#include "utils/Executor.h"
 #include "utils/Logger.h"
 #include "utils/NamedEnum.h"
 #include "utils/Variant.h"
 
+#include <QEventLoop>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QNetworkReply>
+
+#include <functional>
 #include <memory>
 
 static const NamedEnumTable< CalamaresUtils::GeoIP::Handler::Type >&
@@ -47,42 +55,60 @@ namespace CalamaresUtils
 namespace GeoIP
 {
 
-Handler::Handler()
-    : m_type( Type::None )
+Handler::Handler() {}
+
+Handler::Handler( const QString& implementation, const QString& url, const QString& selector )
 {
+    addProvider( implementation, url, selector );
 }
 
-Handler::Handler( const QString& implementation, const QString& url, const QString& selector )
-    : m_type( Type::None )
-    , m_url( url )
-    , m_selector( selector )
+Handler::Handler( const QVariantMap& configuration )
+{
+    addProvider( CalamaresUtils::getString( configuration, "style" ),
+                 CalamaresUtils::getString( configuration, "url" ),
+                 CalamaresUtils::getString( configuration, "selector" ) );
+    const auto providers = configuration.value( "providers" ).toList();
+    for ( const auto& p : providers )
+    {
+        const auto map = p.toMap();
+        addProvider( CalamaresUtils::getString( map, "style" ),
+                     CalamaresUtils::getString( map, "url" ),
+                     CalamaresUtils::getString( map, "selector" ) );
+    }
+}
+
+Handler::~Handler() {}
+
+void
+Handler::addProvider( const QString& implementation, const QString& url, const QString& selector )
 {
     bool ok = false;
-    m_type = handlerTypes().find( implementation, ok );
+    Type type = handlerTypes().find( implementation, ok );
     if ( !ok )
     {
         cWarning() << "GeoIP style" << implementation << "is not recognized.";
+        return;
     }
-    else if ( m_type == Type::None )
+    else if ( type == Type::None )
     {
         cWarning() << "GeoIP style *none* does not do anything.";
+        return;
     }
-    else if ( m_type == Type::Fixed && Calamares::Settings::instance()
+    else if ( type == Type::Fixed && Calamares::Settings::instance()
               && !Calamares::Settings::instance()->debugMode() )
     {
         cWarning() << "GeoIP style *fixed* is not recommended for production.";
     }
 #if !defined( QT_XML_LIB )
-    else if ( m_type == Type::XML )
+    else if ( type == Type::XML )
     {
-        m_type = Type::None;
         cWarning() << "GeoIP style *xml* is not supported in this version of Calamares.";
+        return;
     }
 #endif
+    m_providers.append( Provider { type, url, selector } );
 }
 
-Handler::~Handler() {}
-
 static std::unique_ptr< Interface >
 create_interface( Handler::Type t, const QString& selector )
 {
@@ -104,32 +130,146 @@ create_interface( Handler::Type t, const QString& selector )
     __builtin_unreachable();
 }
 
-static RegionZonePair
-do_query( Handler::Type type, const QString& url, const QString& selector )
+/** @brief The data downloaded (successfully) from each URL in this session
+ *
+ * GeoIP data doesn't change while Calamares runs, and more than one module
+ * may ask the same provider (e.g. *welcome* and *locale*).
+ */
+static QMutex s_repliesMutex;
+static QHash< QString, QByteArray > s_replies;
+
+/** @brief Ask all the @p providers at once, returns the first valid answer
+ *
+ * Each reply is passed to @p interpret, along with the interface for its
+ * provider; the first result for which @p valid returns @c true wins, and
+ * the outstanding requests are aborted. If none wins, a fixed provider
+ * (if there is one) gives the answer. Runs a local event loop for the
+ * requests (on the calling thread's network access manager).
+ */
+template < typename T >
+static T
+do_race( const QVector< Handler::Provider >& providers,
+         const std::function< T( Interface&, const QByteArray& ) >& interpret,
+         const std::function< bool( const T& ) >& valid )
 {
-    const auto interface = create_interface( type, selector );
-    if ( !interface )
+    std::vector< std::unique_ptr< Interface > > interfaces;
+    interfaces.reserve( providers.count() );
+    for ( const auto& p : providers )
     {
-        return RegionZonePair();
+        interfaces.push_back( create_interface( p.type, p.selector ) );
+    }
+
+    // Data from earlier in the session needs no network at all
+    {
+        QMutexLocker lock( &s_repliesMutex );
+        for ( int i = 0; i < providers.count(); ++i )
+        {
+            auto it = s_replies.constFind( providers.at( i ).url );
+            if ( interfaces[ i ] && it != s_replies.constEnd() )
+            {
+                T result = interpret( *interfaces[ i ], it.value() );
+                if ( valid( result ) )
+                {
+                    return result;
+                }
+            }
+        }
     }
 
     using namespace CalamaresUtils::Network;
-    return interface->processReply(
-        CalamaresUtils::Network::Manager::instance().synchronousGet( url, { RequestOptions::FakeUserAgent } ) );
-}
+    const RequestOptions options( RequestOptions::FakeUserAgent | RequestOptions::AllowHttp2 );
 
-static QString
-do_raw_query( Handler::Type type, const QString& url, const QString& selector )
-{
-    const auto interface = create_interface( type, selector );
-    if ( !interface )
+    QEventLoop loop;
+    T result {};
+    bool done = false;
+    int pending = 0;
+    QVector< QNetworkReply* > replies;
+    for ( int i = 0; i < providers.count(); ++i )
     {
-        return QString();
+        if ( !interfaces[ i ] )
+        {
+            continue;
+        }
+        auto* reply = Manager::instance().asynchronousGet( providers.at( i ).url, options );
+        if ( !reply )
+        {
+            continue;
+        }
+        replies.append( reply );
+        pending++;
+        QObject::connect( reply, &QNetworkReply::finished, &loop, [ &, reply, i ]() {
+            pending--;
+            if ( !done && reply->error() == QNetworkReply::NoError )
+            {
+                const QByteArray data = reply->readAll();
+                T r = interpret( *interfaces[ i ], data );
+                if ( valid( r ) )
+                {
+                    cDebug() << "GeoIP provider" << providers.at( i ).url << "answered first.";
+                    result = r;
+                    done = true;
+                    QMutexLocker lock( &s_repliesMutex );
+                    s_replies.insert( providers.at( i ).url, data );
+                }
+            }
+            if ( done || pending <= 0 )
+            {
+                loop.quit();
+            }
+        } );
+    }
+    if ( pending > 0 )
+    {
+        loop.exec();
     }
 
-    using namespace CalamaresUtils::Network;
-    return interface->rawReply(
-        CalamaresUtils::Network::Manager::instance().synchronousGet( url, { RequestOptions::FakeUserAgent } ) );
+    for ( auto* reply : replies )
+    {
+        reply->disconnect( &loop );
+        if ( reply->isRunning() )
+        {
+            reply->abort();
+        }
+        reply->deleteLater();
+    }
+    if ( done )
+    {
+        return result;
+    }
+
+    // A fixed provider does not look at the data, so it answers even
+    // when its URL could not be fetched (as it did before the race).
+    for ( int i = 0; i < providers.count(); ++i )
+    {
+        if ( interfaces[ i ] && providers.at( i ).type == Handler::Type::Fixed )
+        {
+            T r = interpret( *interfaces[ i ], QByteArray() );
+            if ( valid( r ) )
+            {
+                cDebug() << "GeoIP falls back to fixed provider" << providers.at( i ).selector;
+                return r;
+            }
+        }
+    }
+    return result;
+}
+
+static RegionZonePair
+do_query( const QVector< Handler::Provider >& providers )
+{
+    return do_race< RegionZonePair >(
+        providers,
+        []( Interface& i, const QByteArray& data ) { return i.processReply( data ); },
+        []( const RegionZonePair& r ) { return r.isValid(); } );
+}
+
+static QString
+do_raw_query( const QVector< Handler::Provider >& providers )
+{
+    return do_race< QString >(
+        providers,
+        []( Interface& i, const QByteArray& data ) { return i.rawReply( data ); },
+        []( const QString& s ) { return !s.isEmpty(); } );
 }
 
 RegionZonePair
@@ -139,18 +279,16 @@ Handler::get() const
     {
         return RegionZonePair();
     }
-    return do_query( m_type, m_url, m_selector );
+    return do_query( m_providers );
 }
 
 
 QFuture< RegionZonePair >
 Handler::query() const
 {
-    Handler::Type type = m_type;
-    QString url = m_url;
-    QString selector = m_selector;
-
-    return QtConcurrent::run( [=] { return do_query( type, url, selector ); } );
+    auto providers = m_providers;
+    return CalamaresUtils::Executor::run(
+        CalamaresUtils::Executor::Lane::Interactive, "geoip-query", [ = ] { return do_query( providers ); } );
 }
 
 QString
@@ -160,18 +298,16 @@ Handler::getRaw() const
     {
         return QString();
     }
-    return do_raw_query( m_type, m_url, m_selector );
+    return do_raw_query( m_providers );
 }
 
 
 QFuture< QString >
 Handler::queryRaw() const
 {
-    Handler::Type type = m_type;
-    QString url = m_url;
-    QString selector = m_selector;
-
-    return QtConcurrent::run( [=] { return do_raw_query( type, url, selector ); } );
+    auto providers = m_providers;
+    return CalamaresUtils::Executor::run(
+        CalamaresUtils::Executor::Lane::Interactive, "geoip-query", [ = ] { return do_raw_query( providers ); } );
 }
 
 }  // namespace GeoIP
@@ -14,6 +14,7 @@
 
 #include <QString>
 #include <QVariantMap>
+#include <QVector>
 #include <QtConcurrent/QtConcurrentRun>
 
 namespace CalamaresUtils
@@ -28,6 +29,12 @@ namespace GeoIP
  * synchronous API and will return an invalid zone pair on
  * error or if the configuration is not understood. For an
  * async API, use query().
+ *
+ * A handler may have more than one provider (GeoIP source). All the
+ * providers are asked at once; the first valid answer is used and
+ * the other requests are cancelled. Downloaded data is remembered
+ * for the rest of the session, so asking again (e.g. from another
+ * module, with the same URL) does not go over the network.
  */
 class DLLEXPORT Handler
 {
@@ -40,6 +47,14 @@ public:
         Fixed  // Returns selector string verbatim
     };
 
+    /// @brief One GeoIP source: how to interpret what data from where
+    struct Provider
+    {
+        Type type;
+        QString url;
+        QString selector;
+    };
+
     /** @brief An unconfigured handler; this always returns errors. */
     Handler();
     /** @brief A handler for a specific GeoIP source.
@@ -49,9 +64,19 @@ public:
      * is used to select something from the data returned by the @url.
      */
     Handler( const QString& implementation, const QString& url, const QString& selector );
+    /** @brief A handler for the GeoIP sources in a configuration map
+     *
+     * The map has keys *style*, *url* and *selector* for one source,
+     * like the constructor above, and an optional key *providers*
+     * with a list of maps with the same keys, which are added after it.
+     */
+    explicit Handler( const QVariantMap& configuration );
 
     ~Handler();
 
+    /// @brief Adds another source; see the constructor for the parameters
+    void addProvider( const QString& implementation, const QString& url, const QString& selector );
+
     /** @brief Synchronously get the GeoIP result.
      *
      * If the Handler is valid, then do the actual fetching and interpretation
@@ -70,15 +95,18 @@ public:
     /// @brief Like query, but don't interpret the contents
     QFuture< QString > queryRaw() const;
 
-    bool isValid() const { return m_type != Type::None; }
-    Type type() const { return m_type; }
-    QString url() const { return m_url; }
-    QString selector() const { return m_selector; }
+    bool isValid() const { return !m_providers.isEmpty(); }
+    /// @brief The type of the first provider (None if there are none)
+    Type type() const { return isValid() ? m_providers.first().type : Type::None; }
+    /// @brief The URL of the first provider
+    QString url() const { return isValid() ? m_providers.first().url : QString(); }
+    /// @brief The selector of the first provider
+    QString selector() const { return isValid() ? m_providers.first().selector : QString(); }
+    /// @brief All the (valid) providers, in configuration order
+    const QVector< Provider >& providers() const { return m_providers; }
 
 private:
-    Type m_type;
-    const QString m_url;
-    const QString m_selector;
+    QVector< Provider > m_providers;
 };
 
 }  // namespace GeoIP
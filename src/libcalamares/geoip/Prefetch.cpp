@@ -0,0 +1,145 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "Prefetch.h"
+
+#include "GlobalStorage.h"
+#include "Handler.h"
+#include "JobQueue.h"
+#include "locale/TimeZone.h"
+#include "network/Manager.h"
+#include "utils/Executor.h"
+#include "utils/Logger.h"
+
+#include <QFutureWatcher>
+#include <QPair>
+
+namespace CalamaresUtils
+{
+namespace GeoIP
+{
+
+using PrefetchResult = QPair< RegionZonePair, QString >;
+
+struct Prefetch::Private
+{
+    std::unique_ptr< Handler > handler;
+    QFutureWatcher< PrefetchResult > watcher;
+};
+
+Prefetch::Prefetch()
+    : QObject( nullptr )
+    , d( std::make_unique< Private >() )
+{
+    connect( &d->watcher, &QFutureWatcher< PrefetchResult >::finished, this, [this]() {
+        const auto result = d->watcher.result();
+        m_timezone = result.first;
+        m_countryCode = result.second;
+        cDebug() << "GeoIP prefetch result" << m_timezone << m_countryCode;
+        store();
+        // A retry only updates the results
+        if ( m_state != State::Finished )
+        {
+            m_state = State::Finished;
+            emit finished();
+        }
+    } );
+}
+
+Prefetch::~Prefetch() {}
+
+Prefetch&
+Prefetch::instance()
+{
+    static auto* p = new Prefetch();
+    return *p;
+}
+
+QString
+Prefetch::globalStorageKey()
+{
+    return QStringLiteral( "geoip" );
+}
+
+void
+Prefetch::start( const QVariantMap& configuration )
+{
+    if ( m_state != State::Idle )
+    {
+        return;
+    }
+
+    auto handler = std::make_unique< Handler >( configuration );
+    if ( !handler->isValid() )
+    {
+        cWarning() << "GeoIP prefetch has no usable providers.";
+        return;
+    }
+    d->handler = std::move( handler );
+    m_state = State::Running;
+
+    // A lookup that failed, maybe for lack of network, is tried again
+    // when the network comes up. The state stays Finished meanwhile,
+    // since finished() has been emitted already.
+    connect( &CalamaresUtils::Network::Manager::instance(),
+             &CalamaresUtils::Network::Manager::hasInternetChanged,
+             this,
+             [this]( bool hasInternet ) {
+                 if ( hasInternet && m_state == State::Finished && !m_timezone.isValid() && !d->watcher.isRunning() )
+                 {
+                     query();
+                 }
+             } );
+    query();
+}
+
+void
+Prefetch::query()
+{
+    auto lookup = [ handler = *d->handler ]() {
+        const RegionZonePair timezone = handler.get();
+        QString country;
+        if ( timezone.isValid() )
+        {
+            const CalamaresUtils::Locale::ZonesModel zones;
+            const auto* zone = zones.find( timezone.first, timezone.second );
+            if ( zone )
+            {
+                country = zone->country();
+            }
+        }
+        return PrefetchResult( timezone, country );
+    };
+    d->watcher.setFuture(
+        CalamaresUtils::Executor::run( CalamaresUtils::Executor::Lane::Interactive, "geoip-prefetch", lookup ) );
+}
+
+void
+Prefetch::store()
+{
+    auto* jobQueue = Calamares::JobQueue::instance();
+    auto* gs = jobQueue ? jobQueue->globalStorage() : nullptr;
+    if ( !gs )
+    {
+        // No JobQueue (e.g. in tests); timezone() and countryCode() still work
+        return;
+    }
+    if ( !m_timezone.isValid() )
+    {
+        gs->remove( globalStorageKey() );
+        return;
+    }
+    gs->insert( globalStorageKey(),
+                QVariantMap { { QStringLiteral( "region" ), m_timezone.first },
+                              { QStringLiteral( "zone" ), m_timezone.second },
+                              { QStringLiteral( "country" ), m_countryCode } } );
+}
+
+}  // namespace GeoIP
+}  // namespace CalamaresUtils
@@ -0,0 +1,97 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef GEOIP_PREFETCH_H
+#define GEOIP_PREFETCH_H
+
+#include "DllMacro.h"
+#include "Interface.h"
+
+#include <QObject>
+#include <QVariantMap>
+
+#include <memory>
+
+namespace CalamaresUtils
+{
+namespace GeoIP
+{
+
+/** @brief One application-wide GeoIP lookup, started early
+ *
+ * When settings.conf has a *geoip* section, Calamares starts a lookup
+ * as soon as the network is up, long before any module page is shown.
+ * The result is stored in GlobalStorage (see globalStorageKey()) as a map
+ * with keys *region*, *zone* and *country*, and modules that would do
+ * their own lookup can use it instead of waiting for the network.
+ *
+ * Typical module code checks state(): when it is Finished, use
+ * timezone() or countryCode() directly; when it is Running, connect to
+ * finished(); when Idle, there is no prefetch and the module should
+ * do its own lookup (if configured).
+ */
+class DLLEXPORT Prefetch : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class State
+    {
+        Idle,  ///< No prefetch configured (or not started yet)
+        Running,  ///< Waiting for network or for the lookup itself
+        Finished  ///< Done; the results may still be invalid
+    };
+
+    static Prefetch& instance();
+    ~Prefetch() override;
+
+    /** @brief Start the lookup with the given @p configuration
+     *
+     * The configuration map is the same as the *geoip* map in the
+     * locale and welcome modules. If the map is not usable, nothing
+     * happens and the state stays Idle. Calling start() on a prefetch
+     * that is already running or finished does nothing.
+     */
+    void start( const QVariantMap& configuration );
+
+    State state() const { return m_state; }
+    /// @brief Timezone found by the lookup (invalid if not found or not finished)
+    RegionZonePair timezone() const { return m_timezone; }
+    /// @brief Country of the timezone found (empty if not found or not finished)
+    QString countryCode() const { return m_countryCode; }
+
+    /// @brief The GlobalStorage key where results are stored
+    static QString globalStorageKey();
+
+signals:
+    /** @brief Emitted once, when the lookup is done (even if it found nothing)
+     *
+     * If the lookup found nothing, it is tried again when the network
+     * comes up. A retry that finds something updates timezone(),
+     * countryCode() and GlobalStorage, but does not emit finished() again.
+     */
+    void finished();
+
+private:
+    Prefetch();
+
+    void query();
+    void store();
+
+    struct Private;
+    std::unique_ptr< Private > d;
+
+    State m_state = State::Idle;
+    RegionZonePair m_timezone;
+    QString m_countryCode;
+};
+
+}  // namespace GeoIP
+}  // namespace CalamaresUtils
+#endif
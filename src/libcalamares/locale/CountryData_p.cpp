@@ -50,7 +50,7 @@ struct CountryData
 
 static constexpr int const country_data_size = 198;
 
-static const CountryData country_data_table[] = {
+static constexpr const CountryData country_data_table[] = {
 { QLocale::Language::Catalan, QLocale::Country::Andorra, 'A', 'D' },
 { QLocale::Language::Arabic, QLocale::Country::UnitedArabEmirates, 'A', 'E' },
 { QLocale::Language::Persian, QLocale::Country::Afghanistan, 'A', 'F' },
@@ -17,60 +17,95 @@ namespace CalamaresUtils
 namespace Locale
 {
 
-struct TwoChar
+/** @brief Perfect hash of a two-letter (upper-case) country code
+ *
+ * There are only 26 * 26 such codes, so each gets its own slot;
+ * anything else has no slot (-1).
+ */
+static constexpr int country_code_slots = 26 * 26;
+
+static constexpr int
+codeSlot( char cc1, char cc2 )
+{
+    return ( 'A' <= cc1 && cc1 <= 'Z' && 'A' <= cc2 && cc2 <= 'Z' ) ? ( cc1 - 'A' ) * 26 + ( cc2 - 'A' ) : -1;
+}
+
+/// @brief Index into country_data_table, by code slot and by country
+struct CountryIndex
+{
+    short byCode[ country_code_slots ];
+    short byCountry[ QLocale::Country::LastCountry + 1 ];
+};
+
+/** @brief Build the indexes, at compile-time
+ *
+ * Like a linear search of the table, this keeps the **first**
+ * entry for a given code or country.
+ */
+static constexpr CountryIndex
+makeCountryIndex()
 {
-    TwoChar( const QString& code )
-        : cc1( 0 )
-        , cc2( 0 )
+    CountryIndex index {};
+    for ( auto& i : index.byCode )
+    {
+        i = -1;
+    }
+    for ( auto& i : index.byCountry )
+    {
+        i = -1;
+    }
+    for ( int i = 0; i < country_data_size; ++i )
     {
-        if ( code.length() == 2 )
+        const auto& d = country_data_table[ i ];
+        const int slot = codeSlot( d.cc1, d.cc2 );
+        if ( slot >= 0 && index.byCode[ slot ] < 0 )
         {
-            cc1 = code[ 0 ].toLatin1();
-            cc2 = code[ 1 ].toLatin1();
+            index.byCode[ slot ] = short( i );
+        }
+        if ( index.byCountry[ d.c ] < 0 )
+        {
+            index.byCountry[ d.c ] = short( i );
         }
     }
+    return index;
+}
 
-    char cc1;
-    char cc2;
-};
+static constexpr CountryIndex country_index = makeCountryIndex();
+static_assert( country_index.byCode[ codeSlot( 'N', 'L' ) ] >= 0, "The Netherlands are missing from CountryData" );
 
 static const CountryData*
-lookup( TwoChar c )
+lookup( const QString& code )
 {
-    if ( !c.cc1 )
+    if ( code.length() != 2 )
     {
         return nullptr;
     }
-
-    const CountryData* p
-        = std::find_if( country_data_table, country_data_table + country_data_size, [c = c]( const CountryData& d ) {
-              return ( d.cc1 == c.cc1 ) && ( d.cc2 == c.cc2 );
-          } );
-    if ( p == country_data_table + country_data_size )
+    const int slot = codeSlot( code[ 0 ].toLatin1(), code[ 1 ].toLatin1() );
+    if ( slot < 0 || country_index.byCode[ slot ] < 0 )
     {
         return nullptr;
     }
-    return p;
+    return country_data_table + country_index.byCode[ slot ];
 }
 
 QLocale::Country
 countryForCode( const QString& code )
 {
-    const CountryData* p = lookup( TwoChar( code ) );
+    const CountryData* p = lookup( code );
     return p ? p->c : QLocale::Country::AnyCountry;
 }
 
 QLocale::Language
 languageForCountry( const QString& code )
 {
-    const CountryData* p = lookup( TwoChar( code ) );
+    const CountryData* p = lookup( code );
     return p ? p->l : QLocale::Language::AnyLanguage;
 }
 
 QPair< QLocale::Country, QLocale::Language >
 countryData( const QString& code )
 {
-    const CountryData* p = lookup( TwoChar( code ) );
+    const CountryData* p = lookup( code );
     return p ? qMakePair( p->c, p->l ) : qMakePair( QLocale::Country::AnyCountry, QLocale::Language::AnyLanguage );
 }
 
@@ -84,14 +119,11 @@ countryLocale( const QString& code )
 QLocale::Language
 languageForCountry( QLocale::Country country )
 {
-    const CountryData* p = std::find_if( country_data_table,
-                                         country_data_table + country_data_size,
-                                         [c = country]( const CountryData& d ) { return d.c == c; } );
-    if ( p == country_data_table + country_data_size )
+    if ( country < 0 || country > QLocale::Country::LastCountry || country_index.byCountry[ country ] < 0 )
     {
         return QLocale::Language::AnyLanguage;
     }
-    return p->l;
+    return country_data_table[ country_index.byCountry[ country ] ].l;
 }
 
 }  // namespace Locale
@@ -20,6 +20,8 @@
 
 #include <QtTest/QtTest>
 
+#include <cmath>
+
 class LocaleTests : public QObject
 {
     Q_OBJECT
@@ -49,6 +51,7 @@ private Q_SLOTS:
     void testLocationLookup_data();
     void testLocationLookup();
     void testLocationLookup2();
+    void testLocationLookupIndex();
 
     // Global Storage updates
     void testGSUpdates();
@@ -85,6 +88,13 @@ LocaleTests::testLanguageModelCount()
 
     // Belgium speaks Dutch as well
     QCOMPARE( m->find( "BE" ), dutch );
+
+    // Sort keys are precomputed from the native name
+    QCOMPARE( m->sortKey( dutch ), m->locale( dutch ).label().toCaseFolded() );
+    QCOMPARE( m->data( m->index( dutch, 0 ), CalamaresUtils::Locale::TranslationsModel::SortKeyRole ).toString(),
+              m->sortKey( dutch ) );
+    QVERIFY( m->sortKey( -1 ).isEmpty() );
+    QVERIFY( m->sortKey( m->rowCount( QModelIndex() ) ).isEmpty() );
 }
 
 void
@@ -246,6 +256,14 @@ LocaleTests::testTranslatableConfig2()
     CalamaresUtils::Locale::TranslatedString ts3( map, "front" );
     QVERIFY( ts3.isEmpty() );
     QCOMPARE( ts3.count(), 1 );  // The empty string
+
+    // Repeated lookups give the same string, until the locale changes
+    QCOMPARE( ts1.get(), QStringLiteral( "description (no language)" ) );
+    QCOMPARE( ts1.get(), QStringLiteral( "description (no language)" ) );
+    QLocale::setDefault( QLocale( QStringLiteral( "nl" ) ) );
+    QCOMPARE( ts1.get(), QStringLiteral( "description (language nl)" ) );
+    QLocale::setDefault( QLocale( QStringLiteral( "en_US" ) ) );
+    QCOMPARE( ts1.get(), QStringLiteral( "description (no language)" ) );
 }
 
 void
@@ -372,6 +390,27 @@ LocaleTests::testComplexZones()
     QVERIFY( !names.contains( "New York" ) );
     QVERIFY( !names.contains( "Prague" ) );
     QVERIFY( names.contains( "Abidjan" ) );
+
+    // Each zone is in exactly one region
+    RegionsModel regions;
+    int total = 0;
+    for ( int i = 0; i < regions.rowCount( QModelIndex() ); ++i )
+    {
+        const QString region = regions.data( regions.index( i ), RegionsModel::KeyRole ).toString();
+        europe.setRegion( region );
+        QVERIFY( europe.rowCount() > 0 );
+        for ( int j = 0; j < europe.rowCount(); ++j )
+        {
+            QCOMPARE( europe.data( europe.index( j, 0 ), ZonesModel::RegionRole ).toString(), region );
+        }
+        total += europe.rowCount();
+    }
+    QCOMPARE( total, zones.rowCount( QModelIndex() ) );
+
+    europe.setRegion( "Atlantis" );
+    QCOMPARE( europe.rowCount(), 0 );
+    europe.setRegion( QString() );
+    QCOMPARE( europe.rowCount(), zones.rowCount( QModelIndex() ) );
 }
 
 void
@@ -425,7 +464,8 @@ LocaleTests::testLocationLookup_data()
 
     QTest::newRow( "London" ) << 50.0 << 0.0 << QString( "London" );
     QTest::newRow( "Tarawa E" ) << 0.0 << 179.0 << QString( "Tarawa" );
-    QTest::newRow( "Tarawa W" ) << 0.0 << -179.0 << QString( "Tarawa" );
+    // Just across the date line; further east, Kanton is closer
+    QTest::newRow( "Tarawa W" ) << 0.0 << -179.9 << QString( "Tarawa" );
 
     QTest::newRow( "Johannesburg" ) << -26.0 << 28.0 << QString( "Johannesburg" );  // South Africa
     QTest::newRow( "Maseru" ) << -29.0 << 27.0 << QString( "Maseru" );  // Lesotho
@@ -479,6 +519,39 @@ LocaleTests::testLocationLookup2()
     QCOMPARE( trunc( altzone->latitude() * 1000.0 ), -29466 );
 }
 
+void
+LocaleTests::testLocationLookupIndex()
+{
+    const CalamaresUtils::Locale::ZonesModel zones;
+
+    for ( double latitude = -85.0; latitude < 90.0; latitude += 5.0 )
+    {
+        for ( double longitude = -180.0; longitude < 180.0; longitude += 5.0 )
+        {
+            // Great-circle distance (haversine), radius doesn't matter
+            auto distance = [ = ]( const CalamaresUtils::Locale::TimeZoneData* zone ) -> double {
+                const double toRad = M_PI / 180.0;
+                const double dLat = ( zone->latitude() - latitude ) * toRad;
+                const double dLon = ( zone->longitude() - longitude ) * toRad;
+                const double a = std::sin( dLat / 2 ) * std::sin( dLat / 2 )
+                    + std::cos( latitude * toRad ) * std::cos( zone->latitude() * toRad ) * std::sin( dLon / 2 )
+                        * std::sin( dLon / 2 );
+                return 2 * std::atan2( std::sqrt( a ), std::sqrt( 1 - a ) );
+            };
+
+            const auto* indexed = zones.find( latitude, longitude );
+            const auto* scanned = zones.find( distance );
+            QVERIFY( indexed );
+            QVERIFY( scanned );
+            if ( indexed != scanned )
+            {
+                // Only ties are allowed to differ
+                QVERIFY( std::abs( distance( indexed ) - distance( scanned ) ) < 1e-9 );
+            }
+        }
+    }
+}
+
 void
 LocaleTests::testGSUpdates()
 {
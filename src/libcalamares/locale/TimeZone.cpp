@@ -12,11 +12,19 @@
 
 #include "locale/TranslatableString.h"
 #include "utils/Logger.h"
+#include "utils/Retranslator.h"
 #include "utils/String.h"
 
 #include <QFile>
+#include <QHash>
 #include <QString>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
 static const char TZ_DATA_FILE[] = "/usr/share/zoneinfo/zone.tab";
 
 namespace CalamaresUtils
@@ -196,6 +204,124 @@ static const char altZones[] =
      */
     "ZA -3230+02259 Africa/Johannesburg\n";
 
+/** @brief A 3-d tree of zone locations, for nearest-zone lookups
+ *
+ * Locations are stored as points on the unit sphere. The straight-line
+ * (chord) distance between two such points orders the same as the
+ * great-circle distance, so the nearest point in 3-d space is also the
+ * nearest location on the globe, and there is no special-casing of
+ * the poles or of longitude wrap-around.
+ *
+ * The tree is implicit: each range of the vector has its median (on
+ * the axis for that depth) in the middle, smaller values before it.
+ */
+class ZoneIndex
+{
+public:
+    using Point = std::array< double, 3 >;
+
+    void build( const ZoneVector& zones )
+    {
+        m_nodes.clear();
+        m_nodes.reserve( zones.count() );
+        for ( const auto* z : zones )
+        {
+            m_nodes.push_back( { toPoint( z->latitude(), z->longitude() ), z } );
+        }
+        build( 0, int( m_nodes.size() ), 0 );
+    }
+
+    /** @brief The nearest zone to the given location
+     *
+     * Returns the zone (nullptr if there are none) and the squared
+     * chord distance to it, for comparison with other results.
+     */
+    QPair< const TimeZoneData*, double > nearest( double latitude, double longitude ) const
+    {
+        const TimeZoneData* best = nullptr;
+        double bestDistance = std::numeric_limits< double >::infinity();
+        search( 0, int( m_nodes.size() ), 0, toPoint( latitude, longitude ), best, bestDistance );
+        return qMakePair( best, bestDistance );
+    }
+
+private:
+    struct Node
+    {
+        Point p;
+        const TimeZoneData* zone;
+    };
+    std::vector< Node > m_nodes;
+
+    static Point toPoint( double latitude, double longitude )
+    {
+        const double lat = latitude * M_PI / 180.0;
+        const double lon = longitude * M_PI / 180.0;
+        return { std::cos( lat ) * std::cos( lon ), std::cos( lat ) * std::sin( lon ), std::sin( lat ) };
+    }
+
+    static double distance2( const Point& a, const Point& b )
+    {
+        const double dx = a[ 0 ] - b[ 0 ];
+        const double dy = a[ 1 ] - b[ 1 ];
+        const double dz = a[ 2 ] - b[ 2 ];
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    void build( int begin, int end, int depth )
+    {
+        if ( end - begin <= 1 )
+        {
+            return;
+        }
+        const int axis = depth % 3;
+        const int mid = begin + ( end - begin ) / 2;
+        std::nth_element( m_nodes.begin() + begin,
+                          m_nodes.begin() + mid,
+                          m_nodes.begin() + end,
+                          [ axis ]( const Node& l, const Node& r ) { return l.p[ axis ] < r.p[ axis ]; } );
+        build( begin, mid, depth + 1 );
+        build( mid + 1, end, depth + 1 );
+    }
+
+    void search( int begin, int end, int depth, const Point& q, const TimeZoneData*& best, double& bestDistance ) const
+    {
+        if ( begin >= end )
+        {
+            return;
+        }
+        const int axis = depth % 3;
+        const int mid = begin + ( end - begin ) / 2;
+        const Node& n = m_nodes[ mid ];
+
+        const double d = distance2( n.p, q );
+        if ( d < bestDistance )
+        {
+            best = n.zone;
+            bestDistance = d;
+        }
+
+        // Search the side of the splitting plane that q is on first;
+        // the other side only if it is closer than the best so far.
+        const double diff = q[ axis ] - n.p[ axis ];
+        if ( diff < 0 )
+        {
+            search( begin, mid, depth + 1, q, best, bestDistance );
+            if ( diff * diff < bestDistance )
+            {
+                search( mid + 1, end, depth + 1, q, best, bestDistance );
+            }
+        }
+        else
+        {
+            search( mid + 1, end, depth + 1, q, best, bestDistance );
+            if ( diff * diff < bestDistance )
+            {
+                search( begin, mid, depth + 1, q, best, bestDistance );
+            }
+        }
+    }
+};
+
 class Private : public QObject
 {
     Q_OBJECT
@@ -203,6 +329,42 @@ public:
     RegionVector m_regions;
     ZoneVector m_zones;  ///< The official timezones and locations
     ZoneVector m_altZones;  ///< Extra locations for zones
+    ZoneIndex m_zoneIndex;  ///< Nearest-location index of m_zones
+    ZoneIndex m_altZoneIndex;  ///< Nearest-location index of m_altZones
+    QHash< QString, QPair< int, int > > m_regionRanges;  ///< [begin, end) of each region in m_zones
+
+    /** @brief Translated names, for the translation in m_namesLanguage
+     *
+     * The models ask for names each time a view paints; translating
+     * is a lookup in the translators, so names are kept until the
+     * translation changes. Use translateNames() before reading them.
+     */
+    QStringList m_regionNames;
+    QStringList m_zoneNames;
+    QString m_namesLanguage;
+
+    void translateNames()
+    {
+        const QString language = CalamaresUtils::translatorLocaleName().name;
+        if ( language == m_namesLanguage && m_zoneNames.count() == m_zones.count()
+             && m_regionNames.count() == m_regions.count() )
+        {
+            return;
+        }
+        m_namesLanguage = language;
+        m_regionNames.clear();
+        m_regionNames.reserve( m_regions.count() );
+        for ( const auto* r : qAsConst( m_regions ) )
+        {
+            m_regionNames.append( r->tr() );
+        }
+        m_zoneNames.clear();
+        m_zoneNames.reserve( m_zones.count() );
+        for ( const auto* z : qAsConst( m_zones ) )
+        {
+            m_zoneNames.append( z->tr() );
+        }
+    }
 
     Private()
     {
@@ -235,10 +397,22 @@ public:
             return lhs->region() < rhs->region();
         } );
 
-        for ( auto* z : m_zones )
+        for ( int i = 0; i < m_zones.count(); ++i )
         {
-            z->setParent( this );
+            m_zones[ i ]->setParent( this );
+            auto it = m_regionRanges.find( m_zones[ i ]->region() );
+            if ( it == m_regionRanges.end() )
+            {
+                m_regionRanges.insert( m_zones[ i ]->region(), qMakePair( i, i + 1 ) );
+            }
+            else
+            {
+                it.value().second = i + 1;  // Sorted by region, so always the end of the range
+            }
         }
+
+        m_zoneIndex.build( m_zones );
+        m_altZoneIndex.build( m_altZones );
     }
 };
 
@@ -274,7 +448,8 @@ RegionsModel::data( const QModelIndex& index, int role ) const
     const auto& region = m_private->m_regions[ index.row() ];
     if ( role == NameRole )
     {
-        return region->tr();
+        m_private->translateNames();
+        return m_private->m_regionNames.at( index.row() );
     }
     if ( role == KeyRole )
     {
@@ -292,11 +467,12 @@ RegionsModel::roleNames() const
 QString
 RegionsModel::tr( const QString& region ) const
 {
-    for ( const auto* p : m_private->m_regions )
+    for ( int i = 0; i < m_private->m_regions.count(); ++i )
     {
-        if ( p->key() == region )
+        if ( m_private->m_regions[ i ]->key() == region )
         {
-            return p->tr();
+            m_private->translateNames();
+            return m_private->m_regionNames.at( i );
         }
     }
     return region;
@@ -328,7 +504,8 @@ ZonesModel::data( const QModelIndex& index, int role ) const
     switch ( role )
     {
     case NameRole:
-        return zone->tr();
+        m_private->translateNames();
+        return m_private->m_zoneNames.at( index.row() );
     case KeyRole:
         return zone->key();
     case RegionRole:
@@ -347,12 +524,15 @@ ZonesModel::roleNames() const
 const TimeZoneData*
 ZonesModel::find( const QString& region, const QString& zone ) const
 {
-    for ( const auto* p : m_private->m_zones )
+    // m_zones is sorted by region, then zone (see Private)
+    const auto& zones = m_private->m_zones;
+    auto it = std::lower_bound(
+        zones.cbegin(), zones.cend(), qMakePair( region, zone ), []( const TimeZoneData* p, const auto& key ) {
+            return p->region() == key.first ? p->zone() < key.second : p->region() < key.first;
+        } );
+    if ( it != zones.cend() && ( *it )->region() == region && ( *it )->zone() == zone )
     {
-        if ( p->region() == region && p->zone() == zone )
-        {
-            return p;
-        }
+        return *it;
     }
     return nullptr;
 }
@@ -394,34 +574,16 @@ ZonesModel::find( const std::function< double( const TimeZoneData* ) >& distance
 const TimeZoneData*
 ZonesModel::find( double latitude, double longitude ) const
 {
-    /* This is a somewhat derpy way of finding "closest",
-     * in that it considers one degree of separation
-     * either N/S or E/W equal to any other; this obviously
-     * falls apart at the poles.
-     */
-    auto distance = [&]( const TimeZoneData* zone ) -> double {
-        // Latitude doesn't wrap around: there is nothing north of 90
-        double latitudeDifference = abs( zone->latitude() - latitude );
-
-        // Longitude **does** wrap around, so consider the case of -178 and 178
-        //   which differ by 4 degrees.
-        double westerly = qMin( zone->longitude(), longitude );
-        double easterly = qMax( zone->longitude(), longitude );
-        double longitudeDifference = 0.0;
-        if ( westerly < 0.0 && !( easterly < 0.0 ) )
-        {
-            // Only if they're different signs can we have wrap-around.
-            longitudeDifference = qMin( abs( westerly - easterly ), abs( 360.0 + westerly - easterly ) );
-        }
-        else
-        {
-            longitudeDifference = abs( westerly - easterly );
-        }
-
-        return latitudeDifference + longitudeDifference;
-    };
+    const auto official = m_private->m_zoneIndex.nearest( latitude, longitude );
+    const auto alt = m_private->m_altZoneIndex.nearest( latitude, longitude );
 
-    return find( distance );
+    // As in find() with a distance function, alternative spots are
+    // re-found by name, so that this returns pointers into m_zones.
+    if ( alt.first && alt.second < official.second )
+    {
+        return find( alt.first->region(), alt.first->zone() );
+    }
+    return official.first;
 }
 
 QObject*
@@ -469,6 +631,8 @@ RegionalZonesModel::setRegion( const QString& r )
     if ( r != m_region )
     {
         m_region = r;
+        m_range = r.isEmpty() ? qMakePair( 0, m_private->m_zones.count() )
+                              : m_private->m_regionRanges.value( r, qMakePair( 0, 0 ) );
         invalidateFilter();
         emit regionChanged( r );
     }
@@ -482,13 +646,8 @@ RegionalZonesModel::filterAcceptsRow( int sourceRow, const QModelIndex& ) const
         return true;
     }
 
-    if ( sourceRow < 0 || sourceRow >= m_private->m_zones.count() )
-    {
-        return false;
-    }
-
-    const auto& zone = m_private->m_zones[ sourceRow ];
-    return ( zone->m_region == m_region );
+    // The zones are sorted by region, so each region is one range
+    return m_range.first <= sourceRow && sourceRow < m_range.second;
 }
 
 
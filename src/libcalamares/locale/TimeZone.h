@@ -28,6 +28,7 @@
 
 #include <QAbstractListModel>
 #include <QObject>
+#include <QPair>
 #include <QSortFilterProxyModel>
 #include <QVariant>
 
@@ -50,6 +51,8 @@ class TimeZoneData : public QObject, TranslatableString
     Q_PROPERTY( QString zone READ zone CONSTANT )
     Q_PROPERTY( QString name READ tr CONSTANT )
     Q_PROPERTY( QString countryCode READ country CONSTANT )
+    Q_PROPERTY( double latitude READ latitude CONSTANT )
+    Q_PROPERTY( double longitude READ longitude CONSTANT )
 
 public:
     TimeZoneData( const QString& region,
@@ -187,10 +190,11 @@ public Q_SLOTS:
 
     /** @brief Look up TZ data based on the location.
      *
-     * Returns the nearest zone to the given lat and lon. This is a
-     * convenience function for calling find(), below, with a standard
-     * distance function based on the distance between the given
-     * location (lat and lon) and each zone's given location.
+     * Returns the nearest zone to the given lat and lon, measured
+     * as great-circle distance to each zone's given location. This
+     * gives the same result as find(), below, with a great-circle
+     * distance function, but uses an index built once for all of
+     * the zones, so it does not need to look at each zone.
      */
     const TimeZoneData* find( double latitude, double longitude ) const;
 
@@ -227,6 +231,7 @@ signals:
 private:
     Private* m_private;
     QString m_region;
+    QPair< int, int > m_range;  ///< [begin, end) of m_region in the source model
 };
 
 
@@ -13,11 +13,13 @@
 #include "TranslationsModel.h"
 
 #include "utils/Logger.h"
+#include "utils/Retranslator.h"
 #include "utils/Variant.h"
 
 #include <QCoreApplication>
 #include <QRegularExpression>
 #include <QRegularExpressionMatch>
+#include <QThread>
 
 namespace CalamaresUtils
 {
@@ -68,6 +70,25 @@ TranslatedString::get() const
 
 QString
 TranslatedString::get( const QLocale& locale ) const
+{
+    // The cache is not shared between threads; jobs just do the lookup
+    if ( !QCoreApplication::instance() || QThread::currentThread() != QCoreApplication::instance()->thread() )
+    {
+        return resolve( locale );
+    }
+
+    const int generation = CalamaresUtils::translationGeneration();
+    if ( m_resolved.generation != generation || !( m_resolved.locale == locale ) )
+    {
+        m_resolved.value = resolve( locale );
+        m_resolved.locale = locale;
+        m_resolved.generation = generation;
+    }
+    return m_resolved.value;
+}
+
+QString
+TranslatedString::resolve( const QLocale& locale ) const
 {
     // TODO: keep track of special cases like sr@latin and ca@valencia
     QString localeName = locale.name();
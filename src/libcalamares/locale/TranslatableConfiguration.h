@@ -87,16 +87,35 @@ public:
      */
     bool isEmpty() const { return m_strings[ QString() ].isEmpty(); }
 
-    /// @brief Gets the string in the current locale
+    /** @brief Gets the string in the current locale
+     *
+     * The string is looked up once for each locale and translation:
+     * asking again (e.g. each time a view paints) returns the same
+     * string until the locale or the translations change. Calls
+     * from threads other than the main thread do not use that, and
+     * look up the string each time.
+     */
     QString get() const;
 
     /// @brief Gets the string from the given locale
     QString get( const QLocale& ) const;
 
 private:
+    /// @brief Looks up the string for @p locale (this is what get() caches)
+    QString resolve( const QLocale& locale ) const;
+
     // Maps locale name to human-readable string, "" is English
     QMap< QString, QString > m_strings;
     const char* m_context = nullptr;
+
+    /// @brief The most recent get(), and what it was for
+    struct Resolved
+    {
+        QLocale locale;
+        int generation = -1;  ///< translationGeneration() at the time
+        QString value;
+    };
+    mutable Resolved m_resolved;
 };
 }  // namespace Locale
 }  // namespace CalamaresUtils
@@ -26,10 +26,13 @@ TranslationsModel::TranslationsModel( const QStringList& locales, QObject* paren
 {
     Q_ASSERT( locales.count() > 0 );
     m_locales.reserve( locales.count() );
+    m_sortKeys.reserve( locales.count() );
 
     for ( const auto& l : locales )
     {
-        m_locales.push_back( new Translation( { l }, Translation::LabelFormat::IfNeededWithCountry, this ) );
+        auto* t = new Translation( { l }, Translation::LabelFormat::IfNeededWithCountry, this );
+        m_locales.push_back( t );
+        m_sortKeys.append( t->label().toCaseFolded() );
     }
 }
 
@@ -44,7 +47,7 @@ TranslationsModel::rowCount( const QModelIndex& ) const
 QVariant
 TranslationsModel::data( const QModelIndex& index, int role ) const
 {
-    if ( ( role != LabelRole ) && ( role != EnglishLabelRole ) )
+    if ( ( role != LabelRole ) && ( role != EnglishLabelRole ) && ( role != SortKeyRole ) )
     {
         return QVariant();
     }
@@ -61,6 +64,8 @@ TranslationsModel::data( const QModelIndex& index, int role ) const
         return locale->label();
     case EnglishLabelRole:
         return locale->englishLabel();
+    case SortKeyRole:
+        return m_sortKeys.at( index.row() );
     default:
         return QVariant();
     }
@@ -69,7 +74,17 @@ TranslationsModel::data( const QModelIndex& index, int role ) const
 QHash< int, QByteArray >
 TranslationsModel::roleNames() const
 {
-    return { { LabelRole, "label" }, { EnglishLabelRole, "englishLabel" } };
+    return { { LabelRole, "label" }, { EnglishLabelRole, "englishLabel" }, { SortKeyRole, "sortKey" } };
+}
+
+QString
+TranslationsModel::sortKey( int row ) const
+{
+    if ( ( row < 0 ) || ( row >= m_sortKeys.count() ) )
+    {
+        return QString();
+    }
+    return m_sortKeys.at( row );
 }
 
 const Translation&
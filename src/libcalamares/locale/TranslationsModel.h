@@ -32,7 +32,8 @@ public:
     enum
     {
         LabelRole = Qt::DisplayRole,
-        EnglishLabelRole = Qt::UserRole + 1
+        EnglishLabelRole = Qt::UserRole + 1,
+        SortKeyRole = Qt::UserRole + 2  ///< Case-folded native name, for sorting
     };
 
     TranslationsModel( const QStringList& locales, QObject* parent = nullptr );
@@ -53,6 +54,15 @@ public:
     /// @brief Returns all of the locale Ids (e.g. en_US) put into this model.
     const QStringList& localeIds() const { return m_localeIds; }
 
+    /** @brief Gets the sort key for entry #n
+     *
+     * The key is the case-folded native name of the translation, computed
+     * once when the model is constructed so that sorting and filtering
+     * proxies do not re-derive it for every comparison. Out-of-range
+     * rows have an empty key.
+     */
+    QString sortKey( int row ) const;
+
     /** @brief Searches for an item that matches @p predicate
      *
      * Returns the row number of the first match, or -1 if there isn't one.
@@ -67,6 +77,7 @@ public:
 private:
     QVector< Translation* > m_locales;
     QStringList m_localeIds;
+    QStringList m_sortKeys;
 };
 
 /** @brief Returns a model with all available translations.
@@ -20,7 +20,8 @@ namespace ModuleSystem
 enum class Action : char
 {
     Show,
-    Exec
+    Exec,
+    Prepare  ///< Exec-phase jobs that run early, in the background (see JobQueue::prepare())
 };
 
 }  // namespace ModuleSystem
@@ -0,0 +1,127 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "DependencyGraph.h"
+
+#include <algorithm>
+
+namespace Calamares
+{
+namespace ModuleSystem
+{
+
+void
+DependencyGraph::add( const QString& name, const QStringList& required )
+{
+    if ( m_required.contains( name ) )
+    {
+        for ( const auto& r : m_required.value( name ) )
+        {
+            m_requiredBy[ r ].removeAll( name );
+        }
+    }
+    QStringList unique = required;
+    unique.removeDuplicates();
+    for ( const auto& r : qAsConst( unique ) )
+    {
+        m_requiredBy[ r ].append( name );
+    }
+    m_required.insert( name, unique );
+}
+
+QList< DependencyGraph::Removal >
+DependencyGraph::removeUnmet()
+{
+    auto missingOf = [ this ]( const QString& name ) {
+        QStringList missing;
+        for ( const auto& r : m_required.value( name ) )
+        {
+            if ( !m_required.contains( r ) )
+            {
+                missing.append( r );
+            }
+        }
+        return missing;
+    };
+
+    // Start with the nodes that require missing ones; each removal
+    // only needs a look at the nodes that require the removed one.
+    QStringList pending;
+    for ( auto it = m_requiredBy.cbegin(); it != m_requiredBy.cend(); ++it )
+    {
+        if ( !m_required.contains( it.key() ) )
+        {
+            pending.append( it.value() );
+        }
+    }
+
+    QList< Removal > removed;
+    for ( int i = 0; i < pending.count(); ++i )
+    {
+        const QString name = pending.at( i );
+        if ( !m_required.contains( name ) )
+        {
+            continue;  // Already removed, by way of another requirement
+        }
+        removed.append( Removal { name, missingOf( name ) } );
+        for ( const auto& r : m_required.take( name ) )
+        {
+            m_requiredBy[ r ].removeAll( name );
+        }
+        pending.append( m_requiredBy.value( name ) );
+    }
+    return removed;
+}
+
+QList< QStringList >
+DependencyGraph::layers() const
+{
+    // Kahn's algorithm, one layer at a time
+    QHash< QString, int > unmet;
+    unmet.reserve( m_required.count() );
+    QStringList layer;
+    auto isMissing = [ this ]( const QString& r ) { return !m_required.contains( r ); };
+    for ( auto it = m_required.cbegin(); it != m_required.cend(); ++it )
+    {
+        const auto& required = it.value();
+        if ( std::any_of( required.cbegin(), required.cend(), isMissing ) )
+        {
+            continue;  // Can never be done
+        }
+        unmet.insert( it.key(), required.count() );
+        if ( required.isEmpty() )
+        {
+            layer.append( it.key() );
+        }
+    }
+
+    QList< QStringList > layers;
+    while ( !layer.isEmpty() )
+    {
+        layer.sort();
+        QStringList next;
+        for ( const auto& name : qAsConst( layer ) )
+        {
+            for ( const auto& dependent : m_requiredBy.value( name ) )
+            {
+                auto it = unmet.find( dependent );
+                if ( it != unmet.end() && --it.value() == 0 )
+                {
+                    next.append( dependent );
+                }
+            }
+        }
+        layers.append( layer );
+        layer = next;
+    }
+    return layers;
+}
+
+}  // namespace ModuleSystem
+}  // namespace Calamares
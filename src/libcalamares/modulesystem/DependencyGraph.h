@@ -0,0 +1,75 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef MODULESYSTEM_DEPENDENCYGRAPH_H
+#define MODULESYSTEM_DEPENDENCYGRAPH_H
+
+#include "DllMacro.h"
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+namespace Calamares
+{
+namespace ModuleSystem
+{
+
+/** @brief Which modules require which other modules
+ *
+ * Each node (a module name) lists what it requires; the graph keeps the
+ * reverse edges as well, so that removing a node finds the nodes that
+ * require it without a scan over all of them. Requirements may name
+ * modules that are not in the graph: those are missing.
+ */
+class DLLEXPORT DependencyGraph
+{
+public:
+    /// @brief A node that was removed, and what it required that was missing
+    struct Removal
+    {
+        QString name;
+        QStringList missing;
+    };
+
+    /// @brief Adds (or replaces) node @p name, which requires @p required
+    void add( const QString& name, const QStringList& required );
+
+    bool contains( const QString& name ) const { return m_required.contains( name ); }
+    int count() const { return m_required.count(); }
+
+    /** @brief Removes the nodes that have missing requirements
+     *
+     * Removing a node makes it missing for the nodes that require it,
+     * so those are removed too, and so on. This takes time linear in
+     * the size of the graph. Returns the removed nodes in the order
+     * they were removed.
+     */
+    QList< Removal > removeUnmet();
+
+    /** @brief The nodes in groups, by the order they can be done in
+     *
+     * The first group has the nodes that require nothing (in the graph);
+     * each later group has the nodes that require only nodes in earlier
+     * groups. The nodes in a group do not depend on each other, so they
+     * can be done at the same time. Nodes with missing requirements,
+     * and nodes in a cycle, are not in any group.
+     */
+    QList< QStringList > layers() const;
+
+private:
+    QHash< QString, QStringList > m_required;  ///< What each node requires
+    QHash< QString, QStringList > m_requiredBy;  ///< Reverse edges; keys may be missing nodes
+};
+
+}  // namespace ModuleSystem
+}  // namespace Calamares
+
+#endif
@@ -22,7 +22,13 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
 #include <QString>
+#include <QtConcurrent/QtConcurrent>
+
+#include <exception>
 
 static const char EMERGENCY[] = "emergency";
 
@@ -86,40 +92,140 @@ moduleConfigurationCandidates( bool assumeBuildDir, const QString& moduleName, c
     return paths;
 }
 
-void
-Module::loadConfigurationFile( const QString& configFileName )  //throws YAML::Exception
+/** @brief Finds and parses the configuration file for a module
+ *
+ * Returns @c true if a configuration (map) was loaded into @p map.
+ * This does not touch any Module, so it can be called from any thread.
+ */
+static bool
+readConfigurationFile( bool assumeBuildDir,
+                       const QString& moduleName,
+                       const QString& configFileName,
+                       QVariantMap& map )  //throws YAML::Exception
 {
-    QStringList configCandidates
-        = moduleConfigurationCandidates( Settings::instance()->debugMode(), name(), configFileName );
+    QStringList configCandidates = moduleConfigurationCandidates( assumeBuildDir, moduleName, configFileName );
     for ( const QString& path : configCandidates )
     {
-        QFile configFile( path );
-        if ( configFile.exists() && configFile.open( QFile::ReadOnly | QFile::Text ) )
+        QFileInfo configFile( path );
+        if ( configFile.exists() && configFile.isReadable() )
         {
-            QByteArray ba = configFile.readAll();
-
-            YAML::Node doc = YAML::Load( ba.constData() );
-            if ( doc.IsNull() )
+            QVariant doc = CalamaresUtils::loadYamlDocument( path );
+            if ( doc.isNull() )
             {
                 cDebug() << "Found empty module configuration" << path;
                 // Special case: empty config files are valid,
                 // but aren't a map.
-                return;
+                return false;
             }
-            if ( !doc.IsMap() )
+            if ( doc.type() != QVariant::Map )
             {
                 cWarning() << "Bad module configuration format" << path;
-                return;
+                return false;
             }
 
             cDebug() << "Loaded module configuration" << path;
-            m_configurationMap = CalamaresUtils::yamlMapToVariant( doc );
-            m_emergency = m_maybe_emergency && m_configurationMap.contains( EMERGENCY )
-                && m_configurationMap[ EMERGENCY ].toBool();
+            map = doc.toMap();
+            return true;
+        }
+    }
+    cDebug() << "No config file for" << moduleName << "found anywhere at" << Logger::DebugList( configCandidates );
+    return false;
+}
+
+/** @brief Configuration that was read by preloadConfigurationFiles()
+ *
+ * If reading the file threw an exception, that is kept in @c error
+ * and re-thrown when the module picks up the configuration.
+ */
+struct PreloadedConfiguration
+{
+    QVariantMap map;
+    bool loaded = false;
+    std::exception_ptr error;
+};
+
+static QMutex s_preloadMutex;
+static QHash< QString, PreloadedConfiguration > s_preloaded;
+
+static QString
+preloadKey( const QString& moduleName, const QString& configFileName )
+{
+    return moduleName + '/' + configFileName;
+}
+
+void
+Module::preloadConfigurationFiles( const QList< QPair< QString, QString > >& configFiles )
+{
+    const bool assumeBuildDir = Settings::instance()->debugMode();
+
+    QList< QFuture< void > > futures;
+    for ( const auto& p : configFiles )
+    {
+        const QString key = preloadKey( p.first, p.second );
+        {
+            QMutexLocker lock( &s_preloadMutex );
+            if ( s_preloaded.contains( key ) )
+            {
+                continue;
+            }
+            s_preloaded.insert( key, PreloadedConfiguration() );
+        }
+        futures.append( QtConcurrent::run( [ = ]() {
+            PreloadedConfiguration c;
+            try
+            {
+                c.loaded = readConfigurationFile( assumeBuildDir, p.first, p.second, c.map );
+            }
+            catch ( ... )
+            {
+                c.error = std::current_exception();
+            }
+            QMutexLocker lock( &s_preloadMutex );
+            s_preloaded.insert( key, c );
+        } ) );
+    }
+    for ( auto& f : futures )
+    {
+        f.waitForFinished();
+    }
+}
+
+void
+Module::loadConfigurationFile( const QString& configFileName )  //throws YAML::Exception
+{
+    {
+        QMutexLocker lock( &s_preloadMutex );
+        auto it = s_preloaded.find( preloadKey( name(), configFileName ) );
+        if ( it != s_preloaded.end() )
+        {
+            PreloadedConfiguration c = it.value();
+            s_preloaded.erase( it );
+            lock.unlock();
+            if ( c.error )
+            {
+                std::rethrow_exception( c.error );
+            }
+            if ( c.loaded )
+            {
+                setConfigurationMap( c.map );
+            }
             return;
         }
     }
-    cDebug() << "No config file for" << name() << "found anywhere at" << Logger::DebugList( configCandidates );
+
+    QVariantMap map;
+    if ( readConfigurationFile( Settings::instance()->debugMode(), name(), configFileName, map ) )
+    {
+        setConfigurationMap( map );
+    }
+}
+
+void
+Module::setConfigurationMap( const QVariantMap& configurationMap )
+{
+    m_configurationMap = configurationMap;
+    m_emergency = m_maybe_emergency && m_configurationMap.contains( EMERGENCY )
+        && m_configurationMap[ EMERGENCY ].toBool();
 }
 
 
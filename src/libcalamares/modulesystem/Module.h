@@ -19,6 +19,8 @@
 #include "modulesystem/InstanceKey.h"
 #include "modulesystem/Requirement.h"
 
+#include <QList>
+#include <QPair>
 #include <QStringList>
 #include <QVariant>
 
@@ -97,6 +99,17 @@ public:
      */
     QVariantMap configurationMap();
 
+    /** @brief Read and parse configuration files ahead of time
+     *
+     * Each pair in @p configFiles is a module name and the name of
+     * a configuration file (as passed to moduleFromDescriptor()).
+     * The files are found and parsed on a thread pool; this call
+     * returns when they are all done. A module that is created later
+     * with one of those names picks up the parsed configuration
+     * instead of reading the file itself.
+     */
+    static void preloadConfigurationFiles( const QList< QPair< QString, QString > >& configFiles );
+
     /**
      * @brief typeString returns a user-visible string for the module's type.
      * @return the type string.
@@ -154,6 +167,7 @@ protected:
 
 private:
     void loadConfigurationFile( const QString& configFileName );  //throws YAML::Exception
+    void setConfigurationMap( const QVariantMap& configurationMap );
 
     QString m_directory;
     ModuleSystem::InstanceKey m_key;
@@ -13,18 +13,31 @@
 #include "modulesystem/Module.h"
 #include "modulesystem/Requirement.h"
 #include "modulesystem/RequirementsModel.h"
+#include "utils/Executor.h"
 #include "utils/Logger.h"
+#include "utils/Trace.h"
 
 #include <QFuture>
 #include <QFutureWatcher>
 #include <QTimer>
-#include <QtConcurrent/QtConcurrent>
 
 #include <algorithm>
 
 namespace Calamares
 {
 
+/** @brief Runs the checks of one module (in a worker thread)
+ *
+ * The results are handed back through the future, so that the
+ * model is only ever modified from the GUI thread.
+ */
+static RequirementsList
+checkRequirements( Module* m )
+{
+    CalamaresUtils::Trace::Span span( m->instanceKey().toString(), "requirements" );
+    return m->checkRequirements();
+}
+
 RequirementsChecker::RequirementsChecker( QVector< Module* > modules, RequirementsModel* model, QObject* parent )
     : QObject( parent )
     , m_modules( std::move( modules ) )
@@ -48,10 +61,15 @@ RequirementsChecker::run()
     for ( const auto& module : m_modules )
     {
         Watcher* watcher = new Watcher( this );
-        watcher->setFuture( QtConcurrent::run( this, &RequirementsChecker::addCheckedRequirements, module ) );
         watcher->setObjectName( module->name() );
         m_watchers.append( watcher );
-        connect( watcher, &Watcher::finished, this, &RequirementsChecker::finished );
+        connect( watcher, &Watcher::finished, this, [ this, watcher, module ]() {
+            addCheckedRequirements( module, watcher->result() );
+            finished();
+        } );
+        watcher->setFuture( CalamaresUtils::Executor::run( CalamaresUtils::Executor::Lane::Interactive,
+                                                           "requirements",
+                                                           [ module ]() { return checkRequirements( module ); } ) );
     }
 
     QTimer::singleShot( 0, this, &RequirementsChecker::finished );
@@ -82,9 +100,8 @@ RequirementsChecker::finished()
 }
 
 void
-RequirementsChecker::addCheckedRequirements( Module* m )
+RequirementsChecker::addCheckedRequirements( Module* m, const RequirementsList& l )
 {
-    RequirementsList l = m->checkRequirements();
     if ( l.count() > 0 )
     {
         cDebug() << "Got" << l.count() << "requirement results from" << m->name();
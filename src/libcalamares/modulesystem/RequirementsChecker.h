@@ -26,7 +26,9 @@ class RequirementsModel;
 /** @brief A manager-class that checks all the module requirements
  *
  * Asynchronously checks the requirements for each module, and
- * emits progress signals as appropriate.
+ * emits progress signals as appropriate. The results of each module
+ * are added to the model (in the GUI thread) as soon as that module
+ * is done, so the model fills up while slower checks are still running.
  */
 class RequirementsChecker : public QObject
 {
@@ -40,9 +42,6 @@ public Q_SLOTS:
     /// @brief Start checking all the requirements
     void run();
 
-    /// @brief Called when requirements are reported by a module
-    void addCheckedRequirements( Module* );
-
     /// @brief Called when all requirements have been checked
     void finished();
 
@@ -56,9 +55,12 @@ signals:
     void done();
 
 private:
+    /// @brief Called (in the GUI thread) when a module's checks are done
+    void addCheckedRequirements( Module* m, const RequirementsList& l );
+
     QVector< Module* > m_modules;
 
-    using Watcher = QFutureWatcher< void >;
+    using Watcher = QFutureWatcher< RequirementsList >;
     QVector< Watcher* > m_watchers;
 
     RequirementsModel* m_model;
@@ -25,6 +25,28 @@ RequirementsModel::addRequirementsList( const Calamares::RequirementsList& requi
     emit endResetModel();
 }
 
+void
+RequirementsModel::updateRequirement( const QString& name, bool satisfied )
+{
+    QMutexLocker l( &m_addLock );
+    bool changed = false;
+    for ( int i = 0; i < m_requirements.count(); ++i )
+    {
+        auto& r = m_requirements[ i ];
+        if ( r.name == name && r.satisfied != satisfied )
+        {
+            r.satisfied = satisfied;
+            changed = true;
+            emit dataChanged( index( i ), index( i ) );
+        }
+    }
+    if ( changed )
+    {
+        cDebug() << "Requirement" << name << "is now" << ( satisfied ? "satisfied" : "not satisfied" );
+        changeRequirementsList();
+    }
+}
+
 void
 RequirementsModel::changeRequirementsList()
 {
@@ -69,6 +69,16 @@ public:
     ///@brief Debugging tool, describe the checking-state
     void describe() const;
 
+    /** @brief Change the satisfied-state of requirement @p name
+     *
+     * A module that keeps watching its requirements after they are
+     * checked (e.g. power, which may be plugged in later) can call this
+     * to update the model live. All the entries named @p name are updated;
+     * emits dataChanged() for them, and the satisfied-signals as needed.
+     * Call this from the GUI thread.
+     */
+    void updateRequirement( const QString& name, bool satisfied );
+
 signals:
     void satisfiedRequirementsChanged( bool value );
     void satisfiedMandatoryChanged( bool value );
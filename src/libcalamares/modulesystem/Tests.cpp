@@ -8,6 +8,7 @@
  *
  */
 
+#include "modulesystem/DependencyGraph.h"
 #include "modulesystem/Descriptor.h"
 #include "modulesystem/InstanceKey.h"
 
@@ -33,6 +34,9 @@ private Q_SLOTS:
     void testBadFromStringCases();
 
     void testBasicDescriptor();
+
+    void testDependencyRemoval();
+    void testDependencyLayers();
 };
 
 void
@@ -170,6 +174,67 @@ ModuleSystemTests::testBasicDescriptor()
     }
 }
 
+void
+ModuleSystemTests::testDependencyRemoval()
+{
+    using Calamares::ModuleSystem::DependencyGraph;
+
+    DependencyGraph g;
+    g.add( "welcome", {} );
+    g.add( "partition", { "welcome" } );
+    g.add( "mount", { "partition" } );
+    g.add( "unpackfs", { "mount", "missing" } );
+    g.add( "bootloader", { "unpackfs", "mount", "mount" } );
+    g.add( "umount", { "bootloader" } );
+    QCOMPARE( g.count(), 6 );
+
+    const auto removed = g.removeUnmet();
+    QCOMPARE( removed.count(), 3 );
+    QCOMPARE( removed.at( 0 ).name, QStringLiteral( "unpackfs" ) );
+    QCOMPARE( removed.at( 0 ).missing, QStringList { "missing" } );
+    QCOMPARE( removed.at( 1 ).name, QStringLiteral( "bootloader" ) );
+    QCOMPARE( removed.at( 1 ).missing, QStringList { "unpackfs" } );
+    QCOMPARE( removed.at( 2 ).name, QStringLiteral( "umount" ) );
+    QCOMPARE( removed.at( 2 ).missing, QStringList { "bootloader" } );
+
+    QCOMPARE( g.count(), 3 );
+    QVERIFY( g.contains( "mount" ) );
+    QVERIFY( !g.contains( "umount" ) );
+    // Nothing left to remove
+    QVERIFY( g.removeUnmet().isEmpty() );
+}
+
+void
+ModuleSystemTests::testDependencyLayers()
+{
+    using Calamares::ModuleSystem::DependencyGraph;
+
+    DependencyGraph g;
+    g.add( "welcome", {} );
+    g.add( "locale", {} );
+    g.add( "keyboard", { "locale" } );
+    g.add( "partition", { "welcome" } );
+    g.add( "users", { "locale", "partition", "locale" } );
+    g.add( "summary", { "users", "keyboard" } );
+    // These never get a layer
+    g.add( "ouroboros", { "ouroboros" } );
+    g.add( "broken", { "missing" } );
+
+    const auto layers = g.layers();
+    QCOMPARE( layers.count(), 4 );
+    QCOMPARE( layers.at( 0 ), QStringList( { "locale", "welcome" } ) );
+    QCOMPARE( layers.at( 1 ), QStringList( { "keyboard", "partition" } ) );
+    QCOMPARE( layers.at( 2 ), QStringList { "users" } );
+    QCOMPARE( layers.at( 3 ), QStringList { "summary" } );
+
+    // Replacing a node replaces its edges
+    g.add( "users", { "welcome" } );
+    const auto relayered = g.layers();
+    QCOMPARE( relayered.count(), 3 );
+    QCOMPARE( relayered.at( 1 ), QStringList( { "keyboard", "partition", "users" } ) );
+    QCOMPARE( relayered.at( 2 ), QStringList { "summary" } );
+}
+
 
 QTEST_GUILESS_MAIN( ModuleSystemTests )
 
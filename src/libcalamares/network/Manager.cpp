@@ -11,16 +11,21 @@
 
 #include "utils/Logger.h"
 
+#include <QDir>
 #include <QEventLoop>
+#include <QHash>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QNetworkAccessManager>
+#include <QNetworkDiskCache>
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QThread>
 #include <QTimer>
 
 #include <algorithm>
+#include <functional>
+#include <memory>
 
 namespace CalamaresUtils
 {
@@ -31,8 +36,10 @@ RequestOptions::applyToRequest( QNetworkRequest* request ) const
 {
 #if QT_VERSION < QT_VERSION_CHECK( 5, 15, 0 )
     constexpr const auto RedirectPolicyAttribute = QNetworkRequest::FollowRedirectsAttribute;
+    constexpr const auto Http2AllowedAttribute = QNetworkRequest::HTTP2AllowedAttribute;
 #else
     constexpr const auto RedirectPolicyAttribute = QNetworkRequest::RedirectPolicyAttribute;
+    constexpr const auto Http2AllowedAttribute = QNetworkRequest::Http2AllowedAttribute;
 #endif
 
     if ( m_flags & Flag::FollowRedirect )
@@ -41,6 +48,13 @@ RequestOptions::applyToRequest( QNetworkRequest* request ) const
         request->setAttribute( RedirectPolicyAttribute, true );
     }
 
+    if ( m_flags & Flag::AllowHttp2 )
+    {
+        // Allows multiplexing the requests to one host over one connection;
+        // Qt falls back to HTTP/1.1 if the server doesn't do HTTP/2.
+        request->setAttribute( Http2AllowedAttribute, true );
+    }
+
     if ( m_flags & Flag::FakeUserAgent )
     {
         // Not everybody likes the default User Agent used by this class (looking at you,
@@ -63,11 +77,26 @@ public slots:
 
 public:
     QVector< QUrl > m_hasInternetUrls;
+    RequestOptions::milliseconds m_hasInternetTimeout = RequestOptions::milliseconds( -1 );
     bool m_hasInternet = false;
-    int m_lastCheckedUrlIndex = -1;
+    /// Holds the disk caches of all the NAMs; empty for no cache
+    QString m_cacheDirectory;
+    /// Which subdirectory of m_cacheDirectory each NAM's cache uses
+    QHash< QNetworkAccessManager*, int > m_cacheSlots;
 
     Private();
 
+    /** @brief Gives @p nam a disk cache, if there is a cache directory
+     *
+     * A QNetworkDiskCache is not thread-safe, and does not expect anyone
+     * else in its directory, so each NAM has its own subdirectory (the
+     * first one that is not in use, so that they are re-used when
+     * Calamares starts again).
+     */
+    void attachCache( QNetworkAccessManager* nam );
+    /// @brief Removes the disk cache of @p nam, freeing its subdirectory
+    void detachCache( QNetworkAccessManager* nam );
+
     QNetworkAccessManager* nam();
 };
 
@@ -104,12 +133,46 @@ Manager::Private::nam()
 
     // Need a new NAM for this thread
     QNetworkAccessManager* nam = new QNetworkAccessManager();
+    attachCache( nam );
     m_perThreadNams.append( qMakePair( thread, nam ) );
     QObject::connect( thread, &QThread::finished, this, &Manager::Private::cleanupNam );
 
     return nam;
 }
 
+void
+Manager::Private::attachCache( QNetworkAccessManager* nam )
+{
+    if ( m_cacheDirectory.isEmpty() )
+    {
+        return;
+    }
+    int slot = m_cacheSlots.value( nam, -1 );
+    if ( slot < 0 )
+    {
+        const auto used = m_cacheSlots.values();
+        slot = 0;
+        while ( used.contains( slot ) )
+        {
+            ++slot;
+        }
+        m_cacheSlots.insert( nam, slot );
+    }
+    // The NAM takes ownership of the cache. Requests use the default
+    // PreferNetwork load-control, so stale entries are revalidated
+    // (If-None-Match, If-Modified-Since) rather than downloaded again.
+    auto* cache = new QNetworkDiskCache();
+    cache->setCacheDirectory( QDir( m_cacheDirectory ).filePath( QString::number( slot ) ) );
+    nam->setCache( cache );
+}
+
+void
+Manager::Private::detachCache( QNetworkAccessManager* nam )
+{
+    m_cacheSlots.remove( nam );
+    nam->setCache( nullptr );
+}
+
 void
 Manager::Private::cleanupNam()
 {
@@ -123,6 +186,7 @@ Manager::Private::cleanupNam()
         if ( n.first == thread )
         {
             cleanupFound = true;
+            m_cacheSlots.remove( n.second );
             delete n.second;
             break;
         }
@@ -155,65 +219,9 @@ Manager::hasInternet()
     return d->m_hasInternet;
 }
 
-bool
-Manager::checkHasInternet()
-{
-    if ( d->m_hasInternetUrls.empty() )
-    {
-        return false;
-    }
-    // It's possible that access was switched off (see below, if the check
-    // fails) so we want to turn it back on first. Otherwise all the
-    // checks will fail **anyway**, defeating the point of the checks.
-#if ( QT_VERSION < QT_VERSION_CHECK( 5, 15, 0 ) )
-    if ( !d->m_hasInternet )
-    {
-        d->nam()->setNetworkAccessible( QNetworkAccessManager::Accessible );
-    }
-#endif
-    if ( d->m_lastCheckedUrlIndex < 0 )
-    {
-        d->m_lastCheckedUrlIndex = 0;
-    }
-    int attempts = 0;
-    do
-    {
-        // Start by pinging the same one as last time
-        d->m_hasInternet = synchronousPing( d->m_hasInternetUrls.at( d->m_lastCheckedUrlIndex ) );
-        // if it's not responding, **then** move on to the next one,
-        // and wrap around if needed
-        if ( !d->m_hasInternet )
-        {
-            if ( ++( d->m_lastCheckedUrlIndex ) >= d->m_hasInternetUrls.size() )
-            {
-                d->m_lastCheckedUrlIndex = 0;
-            }
-        }
-        // keep track of how often we've tried, because there's no point in
-        // going around more than once.
-        attempts++;
-    } while ( !d->m_hasInternet && ( attempts < d->m_hasInternetUrls.size() ) );
-
-
-// For earlier Qt versions (< 5.15.0), set the accessibility flag to
-// NotAccessible if synchronous ping has failed, so that any module
-// using Qt's networkAccessible method to determine whether or not
-// internet connection is actually available won't get confused.
-#if ( QT_VERSION < QT_VERSION_CHECK( 5, 15, 0 ) )
-    if ( !d->m_hasInternet )
-    {
-        d->nam()->setNetworkAccessible( QNetworkAccessManager::NotAccessible );
-    }
-#endif
-
-    emit hasInternetChanged( d->m_hasInternet );
-    return d->m_hasInternet;
-}
-
 void
 Manager::setCheckHasInternetUrl( const QUrl& url )
 {
-    d->m_lastCheckedUrlIndex = -1;
     d->m_hasInternetUrls.clear();
     if ( url.isValid() )
     {
@@ -224,7 +232,6 @@ Manager::setCheckHasInternetUrl( const QUrl& url )
 void
 Manager::setCheckHasInternetUrl( const QVector< QUrl >& urls )
 {
-    d->m_lastCheckedUrlIndex = -1;
     d->m_hasInternetUrls = urls;
     auto it = std::remove_if(
         d->m_hasInternetUrls.begin(), d->m_hasInternetUrls.end(), []( const QUrl& u ) { return !u.isValid(); } );
@@ -234,6 +241,40 @@ Manager::setCheckHasInternetUrl( const QVector< QUrl >& urls )
     }
 }
 
+void
+Manager::setCacheDirectory( const QString& path )
+{
+    QMutexLocker lock( namMutex() );
+    if ( path == d->m_cacheDirectory )
+    {
+        return;
+    }
+    if ( !path.isEmpty() && !QDir().mkpath( path ) )
+    {
+        cWarning() << "Could not create network cache directory" << path;
+        return;
+    }
+    cDebug() << "Network cache in" << path;
+    d->m_cacheDirectory = path;
+    for ( const auto& n : qAsConst( d->m_perThreadNams ) )
+    {
+        if ( path.isEmpty() )
+        {
+            d->detachCache( n.second );
+        }
+        else
+        {
+            d->attachCache( n.second );
+        }
+    }
+}
+
+void
+Manager::setCheckHasInternetTimeout( RequestOptions::milliseconds timeout )
+{
+    d->m_hasInternetTimeout = timeout;
+}
+
 void
 Manager::addCheckHasInternetUrl( const QUrl& url )
 {
@@ -255,15 +296,31 @@ Manager::getCheckInternetUrls() const
  * including the timeout setting. A timeout will cause the reply
  * to abort. The reply is **not** scheduled for deletion.
  *
+ * If @p postData is not nullptr, this is a POST of that data,
+ * of type @p contentType, instead of a GET.
+ *
  * On failure, returns nullptr (e.g. bad URL, timeout).
  */
 static QNetworkReply*
-asynchronousRun( QNetworkAccessManager* nam, const QUrl& url, const RequestOptions& options )
+asynchronousRun( QNetworkAccessManager* nam,
+                 const QUrl& url,
+                 const RequestOptions& options,
+                 const QByteArray& contentType = QByteArray(),
+                 const QByteArray* postData = nullptr )
 {
     QNetworkRequest request = QNetworkRequest( url );
     options.applyToRequest( &request );
 
-    QNetworkReply* reply = nam->get( request );
+    QNetworkReply* reply = nullptr;
+    if ( postData )
+    {
+        request.setHeader( QNetworkRequest::ContentTypeHeader, contentType );
+        reply = nam->post( request, *postData );
+    }
+    else
+    {
+        reply = nam->get( request );
+    }
     QTimer* timer = nullptr;
 
     // Bail out early if the request is bad
@@ -285,6 +342,160 @@ asynchronousRun( QNetworkAccessManager* nam, const QUrl& url, const RequestOptio
     return reply;
 }
 
+/** @brief Pings all the @p urls at once, calls @p done with the result
+ *
+ * All the requests are started immediately, on the same network access
+ * manager (so that connections to the same host are shared). The first
+ * reply that returns data wins: the other requests are aborted and
+ * @p done is called with the index of the winning URL. If none of them
+ * return data, @p done is called with -1.
+ *
+ * @p done may be called before this function returns, if all the
+ * requests fail immediately.
+ */
+static void
+concurrentPing( QNetworkAccessManager* nam,
+                const QVector< QUrl >& urls,
+                const RequestOptions& options,
+                const std::function< void( int ) >& done )
+{
+    struct State
+    {
+        QVector< QNetworkReply* > replies;
+        int pending = 0;
+        bool finished = false;
+    };
+    auto state = std::make_shared< State >();
+    state->replies.fill( nullptr, urls.count() );
+
+    auto finish = [ state, done ]( int index ) {
+        state->finished = true;
+        for ( auto* r : qAsConst( state->replies ) )
+        {
+            if ( r && r->isRunning() )
+            {
+                r->abort();
+            }
+        }
+        done( index );
+    };
+
+    for ( int i = 0; i < urls.count(); ++i )
+    {
+        auto* reply = asynchronousRun( nam, urls.at( i ), options );
+        if ( !reply )
+        {
+            continue;
+        }
+        state->replies[ i ] = reply;
+        state->pending++;
+        QObject::connect( reply, &QNetworkReply::finished, reply, [ state, finish, reply, i ]() {
+            reply->deleteLater();
+            state->replies[ i ] = nullptr;
+            state->pending--;
+            if ( state->finished )
+            {
+                return;
+            }
+            if ( reply->error() == QNetworkReply::NoError && reply->bytesAvailable() )
+            {
+                finish( i );
+            }
+            else if ( state->pending <= 0 )
+            {
+                finish( -1 );
+            }
+        } );
+    }
+
+    if ( state->pending <= 0 && !state->finished )
+    {
+        finish( -1 );
+    }
+}
+
+void
+Manager::setHasInternet( bool hasInternet )
+{
+    d->m_hasInternet = hasInternet;
+// For earlier Qt versions (< 5.15.0), set the accessibility flag to
+// NotAccessible if the pings have failed, so that any module
+// using Qt's networkAccessible method to determine whether or not
+// internet connection is actually available won't get confused.
+#if ( QT_VERSION < QT_VERSION_CHECK( 5, 15, 0 ) )
+    if ( !d->m_hasInternet )
+    {
+        d->nam()->setNetworkAccessible( QNetworkAccessManager::NotAccessible );
+    }
+#endif
+    emit hasInternetChanged( d->m_hasInternet );
+}
+
+/** @brief Prepares the network access manager for a connectivity check
+ *
+ * It's possible that access was switched off (see setHasInternet(), if
+ * the check fails) so we want to turn it back on first. Otherwise all
+ * the checks will fail **anyway**, defeating the point of the checks.
+ */
+static void
+enableForCheck( QNetworkAccessManager* nam, bool hasInternet )
+{
+#if ( QT_VERSION < QT_VERSION_CHECK( 5, 15, 0 ) )
+    if ( !hasInternet )
+    {
+        nam->setNetworkAccessible( QNetworkAccessManager::Accessible );
+    }
+#else
+    Q_UNUSED( nam )
+    Q_UNUSED( hasInternet )
+#endif
+}
+
+bool
+Manager::checkHasInternet()
+{
+    if ( d->m_hasInternetUrls.empty() )
+    {
+        return false;
+    }
+    auto* nam = d->nam();
+    enableForCheck( nam, d->m_hasInternet );
+
+    QEventLoop loop;
+    bool done = false;
+    int winner = -1;
+    concurrentPing(
+        nam, d->m_hasInternetUrls, RequestOptions( RequestOptions::Flags(), d->m_hasInternetTimeout ), [ & ]( int i ) {
+            done = true;
+            winner = i;
+            loop.quit();
+        } );
+    if ( !done )
+    {
+        loop.exec();
+    }
+
+    setHasInternet( winner >= 0 );
+    return d->m_hasInternet;
+}
+
+void
+Manager::asynchronousCheckHasInternet()
+{
+    if ( d->m_hasInternetUrls.empty() )
+    {
+        setHasInternet( false );
+        return;
+    }
+    auto* nam = d->nam();
+    enableForCheck( nam, d->m_hasInternet );
+
+    concurrentPing( nam,
+                    d->m_hasInternetUrls,
+                    RequestOptions( RequestOptions::Flags(), d->m_hasInternetTimeout ),
+                    [ this ]( int i ) { setHasInternet( i >= 0 ); } );
+}
+
 /** @brief Does a request synchronously, returns the request itself
  *
  * The extra options for the request are taken from @p options,
@@ -360,6 +571,15 @@ Manager::asynchronousGet( const QUrl& url, const CalamaresUtils::Network::Reques
     return asynchronousRun( d->nam(), url, options );
 }
 
+QNetworkReply*
+Manager::asynchronousPost( const QUrl& url,
+                           const QByteArray& contentType,
+                           const QByteArray& data,
+                           const CalamaresUtils::Network::RequestOptions& options )
+{
+    return asynchronousRun( d->nam(), url, options, contentType, &data );
+}
+
 QDebug&
 operator<<( QDebug& s, const CalamaresUtils::Network::RequestStatus& e )
 {
@@ -36,6 +36,7 @@ public:
     enum Flag
     {
         FollowRedirect = 0x1,
+        AllowHttp2 = 0x2,  ///< Use HTTP/2 (multiplexed requests) if the server supports it
         FakeUserAgent = 0x100
     };
     Q_DECLARE_FLAGS( Flags, Flag )
@@ -133,6 +134,23 @@ public:
     /// @brief What URLs are used to check for internet connectivity?
     QVector< QUrl > getCheckInternetUrls() const;
 
+    /** @brief Keep downloaded data in an on-disk HTTP cache in @p path
+     *
+     * The directory is created if needed; an empty @p path switches
+     * the cache off (which is the default). Each thread's network
+     * access manager has a cache of its own, in a numbered subdirectory
+     * of @p path. Set this early, before other threads make requests:
+     * the network access managers of other threads are not thread-safe.
+     */
+    void setCacheDirectory( const QString& path );
+
+    /** @brief Set the timeout for each ping of the "is there internet" check.
+     *
+     * A non-positive @p timeout means "no timeout", which is the default.
+     * Since all the URLs are pinged at once, the check takes at most @p timeout.
+     */
+    void setCheckHasInternetTimeout( RequestOptions::milliseconds timeout );
+
     /** @brief Do a network request asynchronously.
      *
      * Returns a pointer to the reply-from-the-request.
@@ -140,14 +158,31 @@ public:
      * The caller is responsible for cleaning up the reply (eventually).
      */
     QNetworkReply* asynchronousGet( const QUrl& url, const RequestOptions& options = RequestOptions() );
+    /** @brief POST @p data (of type @p contentType) to @p url, asynchronously
+     *
+     * Like asynchronousGet(), the caller cleans up the reply.
+     */
+    QNetworkReply* asynchronousPost( const QUrl& url,
+                                     const QByteArray& contentType,
+                                     const QByteArray& data,
+                                     const RequestOptions& options = RequestOptions() );
 
 public Q_SLOTS:
     /** @brief Do an explicit check for internet connectivity.
      *
-     * This **may** do a ping to the configured check URL, but can also
-     * use other mechanisms.
+     * This **may** do a ping to the configured check URLs, but can also
+     * use other mechanisms. All the URLs are pinged concurrently, and
+     * the first one to return data wins. This blocks (spinning an
+     * event loop) until there is a result.
      */
     bool checkHasInternet();
+    /** @brief Start a check for internet connectivity, without waiting
+     *
+     * Like checkHasInternet(), but returns immediately; the result is
+     * reported through hasInternetChanged(). The network requests are
+     * handled by the event loop of the calling thread.
+     */
+    void asynchronousCheckHasInternet();
     /** @brief Is there internet connectivity?
      *
      * This returns the result of the last explicit check, or if there
@@ -166,6 +201,9 @@ signals:
     void hasInternetChanged( bool );
 
 private:
+    /// @brief Record the result of a connectivity check and emit the signal
+    void setHasInternet( bool hasInternet );
+
     class Private;
     std::unique_ptr< Private > d;
 };
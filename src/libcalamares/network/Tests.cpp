@@ -12,10 +12,47 @@
 #include "Manager.h"
 #include "utils/Logger.h"
 
+#include <QTcpServer>
+#include <QTcpSocket>
 #include <QtTest/QtTest>
 
 QTEST_GUILESS_MAIN( NetworkTests )
 
+/** @brief A local HTTP server that answers every request with "OK"
+ *
+ * So that the tests of the connectivity check do not depend on
+ * the real network.
+ */
+static void
+serveOk( QTcpServer& server )
+{
+    QObject::connect( &server, &QTcpServer::newConnection, &server, [ &server ]() {
+        while ( QTcpSocket* socket = server.nextPendingConnection() )
+        {
+            QObject::connect( socket, &QTcpSocket::readyRead, socket, [ socket ]() {
+                socket->readAll();
+                socket->write( "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: close\r\n\r\nOK" );
+                socket->disconnectFromHost();
+            } );
+            QObject::connect( socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater );
+        }
+    } );
+}
+
+/// @brief A URL on localhost where nothing listens
+static QUrl
+closedUrl()
+{
+    QTcpServer server;
+    if ( !server.listen( QHostAddress::LocalHost ) )
+    {
+        return QUrl();
+    }
+    const auto port = server.serverPort();
+    server.close();
+    return QUrl( QStringLiteral( "http://127.0.0.1:%1/" ).arg( port ) );
+}
+
 NetworkTests::NetworkTests() {}
 
 NetworkTests::~NetworkTests() {}
@@ -145,3 +182,45 @@ NetworkTests::testCheckMultiUrl()
         QCOMPARE( nam.getCheckInternetUrls().count(), 1 );
     }
 }
+
+void
+NetworkTests::testCheckAsynchronous()
+{
+    using namespace CalamaresUtils::Network;
+    Logger::setupLogLevel( Logger::LOGVERBOSE );
+    auto& nam = Manager::instance();
+
+    QTcpServer server;
+    QVERIFY( server.listen( QHostAddress::LocalHost ) );
+    serveOk( server );
+    const QUrl good( QStringLiteral( "http://127.0.0.1:%1/" ).arg( server.serverPort() ) );
+    const QUrl bad = closedUrl();
+    QVERIFY( bad.isValid() );
+
+    QSignalSpy spy( &nam, &Manager::hasInternetChanged );
+    {
+        // No URLs at all reports immediately
+        nam.setCheckHasInternetUrl( QVector< QUrl >() );
+        nam.asynchronousCheckHasInternet();
+        QCOMPARE( spy.count(), 1 );
+        QCOMPARE( spy.takeFirst().at( 0 ).toBool(), false );
+    }
+    {
+        // One good URL among bad ones is enough; they are tried at once
+        nam.setCheckHasInternetUrl( { bad, good, bad } );
+        nam.asynchronousCheckHasInternet();
+        QVERIFY( spy.wait( 30000 ) );
+        QCOMPARE( spy.count(), 1 );
+        QCOMPARE( spy.takeFirst().at( 0 ).toBool(), true );
+        QVERIFY( nam.hasInternet() );
+    }
+    {
+        // And only bad ones is no internet
+        nam.setCheckHasInternetUrl( { bad, bad } );
+        nam.asynchronousCheckHasInternet();
+        QVERIFY( spy.wait( 30000 ) );
+        QCOMPARE( spy.count(), 1 );
+        QCOMPARE( spy.takeFirst().at( 0 ).toBool(), false );
+        QVERIFY( !nam.hasInternet() );
+    }
+}
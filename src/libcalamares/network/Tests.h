@@ -27,6 +27,7 @@ private Q_SLOTS:
 
     void testCheckUrl();
     void testCheckMultiUrl();
+    void testCheckAsynchronous();
 };
 
 #endif
@@ -10,6 +10,8 @@
 
 #include "utils/Logger.h"
 
+#include <QMutex>
+#include <QMutexLocker>
 #include <QtDBus>
 
 #include <optional>
@@ -21,7 +23,7 @@ namespace Partition
 
 struct AutoMountInfo
 {
-    bool wasSolidModuleAutoLoaded = false;
+    std::optional< bool > wasSolidModuleAutoLoaded;  ///< Unset if KDED did not answer (in time)
 };
 
 static inline QDBusMessage
@@ -52,29 +54,86 @@ enableSolidAutoMount( QDBusConnection& dbus, bool enable )
     }
 }
 
-static void
-querySolidAutoMount( QDBusConnection& dbus, AutoMountInfo& info )
-{
-    const auto moduleName = QVariant( QStringLiteral( "device_automounter" ) );
+/// @brief How long to wait for KDED to answer, in milliseconds
+static constexpr int queryTimeout = 1000;
 
-    // Find previous setting; this **does** need to block
+/** @brief What KDED said about the automounter the first time it was asked
+ *
+ * Calamares changes the setting, so only the first answer is
+ * interesting (and asking again could mean waiting again). If
+ * there was no answer, the setting is unknown.
+ */
+static QMutex s_queryMutex;
+static std::optional< bool > s_wasAutoLoaded;
+static bool s_queryDone = false;
+static bool s_queryStarted = false;
+
+static QDBusMessage
+isAutoloadedCall()
+{
     auto msg = kdedCall( QStringLiteral( "isModuleAutoloaded" ) );
-    msg.setArguments( { moduleName } );
-    std::optional< bool > result;
-    QDBusMessage r = dbus.call( msg, QDBus::Block );
-    if ( r.type() == QDBusMessage::ReplyMessage )
+    msg.setArguments( { QVariant( QStringLiteral( "device_automounter" ) ) } );
+    return msg;
+}
+
+/// @brief Remembers the answer in @p call, unless there is one already; returns the remembered answer
+static std::optional< bool >
+storeQueryReply( const QDBusPendingCall& call )
+{
+    QDBusPendingReply< bool > reply = call;
+    if ( reply.isError() )
+    {
+        // No KDED, or it is too slow: then it is not known what to restore
+        cDebug() << "Could not query the automounter:" << reply.error().message();
+    }
+
+    QMutexLocker lock( &s_queryMutex );
+    if ( !s_queryDone )
     {
-        auto arg = r.arguments();
-        if ( arg.length() == 1 )
+        s_queryDone = true;
+        if ( reply.isValid() )
         {
-            auto v = arg.at( 0 );
-            if ( v.isValid() && v.type() == QVariant::Bool )
-            {
-                result = v.toBool();
-            }
+            s_wasAutoLoaded = reply.value();
         }
     }
-    info.wasSolidModuleAutoLoaded = result.has_value() ? result.value() : false;
+    return s_wasAutoLoaded;
+}
+
+static std::optional< bool >
+querySolidAutoMount( QDBusConnection& dbus )
+{
+    {
+        QMutexLocker lock( &s_queryMutex );
+        if ( s_queryDone )
+        {
+            return s_wasAutoLoaded;
+        }
+    }
+
+    // Find previous setting; this **does** need to wait, but not for long
+    QDBusPendingCall call = dbus.asyncCall( isAutoloadedCall(), queryTimeout );
+    call.waitForFinished();
+    return storeQueryReply( call );
+}
+
+void
+automountPrefetch()
+{
+    {
+        QMutexLocker lock( &s_queryMutex );
+        if ( s_queryDone || s_queryStarted )
+        {
+            return;
+        }
+        s_queryStarted = true;
+    }
+
+    QDBusConnection dbus = QDBusConnection::sessionBus();
+    auto* watcher = new QDBusPendingCallWatcher( dbus.asyncCall( isAutoloadedCall(), queryTimeout ) );
+    QObject::connect( watcher, &QDBusPendingCallWatcher::finished, [ watcher ]() {
+        storeQueryReply( *watcher );
+        watcher->deleteLater();
+    } );
 }
 
 std::shared_ptr< AutoMountInfo >
@@ -82,7 +141,7 @@ automountDisable( bool disable )
 {
     auto u = std::make_shared< AutoMountInfo >();
     QDBusConnection dbus = QDBusConnection::sessionBus();
-    querySolidAutoMount( dbus, *u );
+    u->wasSolidModuleAutoLoaded = querySolidAutoMount( dbus );
     enableSolidAutoMount( dbus, !disable );
     return u;
 }
@@ -91,8 +150,14 @@ automountDisable( bool disable )
 void
 automountRestore( const std::shared_ptr< AutoMountInfo >& t )
 {
+    if ( !t->wasSolidModuleAutoLoaded.has_value() )
+    {
+        // Turning it on could be wrong, and it is off now anyway
+        cDebug() << "The previous automount setting is not known, not restoring it.";
+        return;
+    }
     QDBusConnection dbus = QDBusConnection::sessionBus();
-    enableSolidAutoMount( dbus, t->wasSolidModuleAutoLoaded );
+    enableSolidAutoMount( dbus, t->wasSolidModuleAutoLoaded.value() );
 }
 
 }  // namespace Partition
@@ -38,10 +38,22 @@ struct AutoMountInfo;
  */
 DLLEXPORT std::shared_ptr< AutoMountInfo > automountDisable( bool disable = true );
 
+/** @brief Start finding out the automount settings
+ *
+ * automountDisable() needs to know the current settings, so that they
+ * can be restored later. Asking for them can take a while (up to a
+ * second; without an answer by then, automountRestore() restores
+ * nothing) and the answer is remembered, so call this ahead of
+ * time -- from a thread with an event loop -- to have the answer
+ * ready when it is needed.
+ */
+DLLEXPORT void automountPrefetch();
+
 /** @brief Restore automount settings
  *
  * Pass the value returned from automountDisable() to restore the
- * previous settings.
+ * previous settings. If they were not known (KDED did not answer
+ * in time), nothing is changed.
  */
 DLLEXPORT void automountRestore( const std::shared_ptr< AutoMountInfo >& t );
 
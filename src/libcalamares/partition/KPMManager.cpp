@@ -19,6 +19,8 @@
 #endif
 
 
+#include <QMutex>
+#include <QMutexLocker>
 #include <QObject>
 
 
@@ -44,6 +46,8 @@ static bool s_kpm_loaded = false;
  * to the InternalManager so we can hand it out in getInternal().
  */
 static std::weak_ptr< InternalManager > s_backend;
+/// @brief Guards s_backend (and the loading of the backend), for KPMManagers made on other threads
+static QMutex s_backendMutex;
 
 InternalManager::InternalManager()
 {
@@ -88,6 +92,7 @@ InternalManager::~InternalManager()
 std::shared_ptr< InternalManager >
 getInternal()
 {
+    QMutexLocker lock( &s_backendMutex );
     if ( s_backend.expired() )
     {
         auto p = std::make_shared< InternalManager >();
@@ -11,18 +11,285 @@
 
 #include "Mount.h"
 
-#include "partition/Sync.h"
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/Logger.h"
+#include "utils/String.h"
 
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QTemporaryDir>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mount.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+
 namespace CalamaresUtils
 {
 namespace Partition
 {
 
+namespace
+{
+/// @brief Mount options as mount(2) takes them
+struct MountOptions
+{
+    unsigned long flags = 0;
+    QStringList data;  ///< Filesystem-specific options
+    bool direct = true;  ///< The options can be handled without mount(8)
+};
+
+struct MountFlag
+{
+    const char* name;
+    unsigned long flag;
+    bool set;
+};
+
+const MountFlag mountFlags[] = {
+    { "ro", MS_RDONLY, true },
+    { "rw", MS_RDONLY, false },
+    { "nosuid", MS_NOSUID, true },
+    { "suid", MS_NOSUID, false },
+    { "nodev", MS_NODEV, true },
+    { "dev", MS_NODEV, false },
+    { "noexec", MS_NOEXEC, true },
+    { "exec", MS_NOEXEC, false },
+    { "sync", MS_SYNCHRONOUS, true },
+    { "async", MS_SYNCHRONOUS, false },
+    { "dirsync", MS_DIRSYNC, true },
+    { "noatime", MS_NOATIME, true },
+    { "atime", MS_NOATIME, false },
+    { "nodiratime", MS_NODIRATIME, true },
+    { "diratime", MS_NODIRATIME, false },
+    { "relatime", MS_RELATIME, true },
+    { "norelatime", MS_RELATIME, false },
+    { "strictatime", MS_STRICTATIME, true },
+};
+
+MountOptions
+parseOptions( const QString& options )
+{
+    MountOptions r;
+    // Options like --bind, and options that need mount(8), such as
+    // loop and user, are left to mount(8).
+    if ( options.startsWith( '-' ) )
+    {
+        r.direct = false;
+        return r;
+    }
+    static const QStringList mount8Options { "loop", "bind", "rbind", "move", "remount", "user", "users", "owner",
+                                             "group", "offset", "sizelimit", "helper" };
+    // These only mean something to mount(8) or in fstab, not to the kernel
+    static const QStringList ignoredOptions { "defaults", "auto", "noauto", "nofail", "_netdev" };
+    for ( const auto& o : options.split( ',', SplitSkipEmptyParts ) )
+    {
+        const QString name = o.section( '=', 0, 0 );
+        if ( mount8Options.contains( name ) || name.startsWith( QStringLiteral( "x-" ), Qt::CaseInsensitive ) )
+        {
+            r.direct = false;
+            return r;
+        }
+        if ( ignoredOptions.contains( o ) )
+        {
+            continue;
+        }
+        const auto* flag = std::find_if( std::begin( mountFlags ),
+                                         std::end( mountFlags ),
+                                         [ &o ]( const MountFlag& f ) { return o == QLatin1String( f.name ); } );
+        if ( flag == std::end( mountFlags ) )
+        {
+            r.data.append( o );
+        }
+        else if ( flag->set )
+        {
+            r.flags |= flag->flag;
+        }
+        else
+        {
+            r.flags &= ~flag->flag;
+        }
+    }
+    return r;
+}
+
+/** @brief Mounts with mount(2), returns @c true on success
+ *
+ * If this fails, for whatever reason, mount(8) gets a go; it
+ * knows about loop devices, helpers like mount.ntfs, and it
+ * produces the exit codes that callers expect for real failures.
+ * Without a filesystem type, it is left to mount(8) as well, which
+ * probes the device with libblkid.
+ */
+bool
+mountDirect( const QString& devicePath,
+             const QString& mountPoint,
+             const QString& filesystemName,
+             const QString& options )
+{
+    if ( filesystemName.isEmpty() || filesystemName == QStringLiteral( "auto" ) )
+    {
+        return false;
+    }
+    const MountOptions o = parseOptions( options );
+    if ( !o.direct )
+    {
+        return false;
+    }
+
+    const QByteArray device = QFile::encodeName( devicePath );
+    const QByteArray target = QFile::encodeName( mountPoint );
+    const QByteArray data = o.data.join( ',' ).toUtf8();
+    if ( ::mount( device.constData(),
+                  target.constData(),
+                  filesystemName.toLatin1().constData(),
+                  o.flags,
+                  data.isEmpty() ? nullptr : data.constData() )
+         == 0 )
+    {
+        return true;
+    }
+    const int error = errno;
+    cDebug() << "mount(2) of" << devicePath << "failed:" << std::strerror( error );
+    return false;
+}
+
+/// @brief Decodes the octal escapes (e.g. \040 for space) in /proc/self/mounts
+QString
+decodeMountPath( const QByteArray& field )
+{
+    QByteArray path;
+    path.reserve( field.length() );
+    for ( int i = 0; i < field.length(); ++i )
+    {
+        if ( field.at( i ) == '\\' && i + 3 < field.length() )
+        {
+            bool ok = false;
+            const int c = field.mid( i + 1, 3 ).toInt( &ok, 8 );
+            if ( ok )
+            {
+                path.append( char( c ) );
+                i += 3;
+                continue;
+            }
+        }
+        path.append( field.at( i ) );
+    }
+    return QFile::decodeName( path );
+}
+
+/// @brief The mount points at, or below, @p mountPoint, deepest first
+QStringList
+mountsBelow( const QString& mountPoint )
+{
+    QStringList mounts;
+    QFile f( QStringLiteral( "/proc/self/mounts" ) );
+    if ( f.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        const QString prefix = mountPoint.endsWith( '/' ) ? mountPoint : mountPoint + '/';
+        for ( const auto& line : f.readAll().split( '\n' ) )
+        {
+            const auto fields = line.split( ' ' );
+            if ( fields.count() < 2 )
+            {
+                continue;
+            }
+            const QString path = decodeMountPath( fields.at( 1 ) );
+            if ( ( path == mountPoint || path.startsWith( prefix ) ) && !mounts.contains( path ) )
+            {
+                mounts.append( path );
+            }
+        }
+    }
+    // Longer paths are deeper
+    std::stable_sort( mounts.begin(), mounts.end(), []( const QString& a, const QString& b ) {
+        return a.length() > b.length();
+    } );
+    return mounts;
+}
+
+/** @brief Writes out the data of the filesystem at @p mountPoint
+ *
+ * Only that filesystem is synced, and only if it can have been
+ * written to. The kernel does this when unmounting as well,
+ * but a lazy unmount, or one that fails, would leave the data.
+ */
+void
+syncWritable( const QByteArray& mountPoint )
+{
+    struct statvfs s;
+    if ( statvfs( mountPoint.constData(), &s ) == 0 && !( s.f_flag & ST_RDONLY ) )
+    {
+        const int fd = ::open( mountPoint.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+        if ( fd >= 0 )
+        {
+            syncfs( fd );
+            ::close( fd );
+        }
+    }
+}
+
+/** @brief Unmounts with umount2(2), returns @c true on success
+ *
+ * Like mountDirect(), the caller runs umount(8) if this fails.
+ */
+bool
+unmountDirect( const QString& path, const QStringList& options )
+{
+    bool recursive = false;
+    int flags = 0;
+    for ( const auto& o : options )
+    {
+        if ( o == QStringLiteral( "-R" ) || o == QStringLiteral( "--recursive" ) )
+        {
+            recursive = true;
+        }
+        else if ( o == QStringLiteral( "-l" ) || o == QStringLiteral( "--lazy" ) )
+        {
+            flags |= MNT_DETACH;
+        }
+        else if ( o == QStringLiteral( "-f" ) || o == QStringLiteral( "--force" ) )
+        {
+            flags |= MNT_FORCE;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    // A device (rather than a mount point) is left to umount(8) to look up
+    const QFileInfo fi( path );
+    if ( !fi.isDir() )
+    {
+        return false;
+    }
+    const QString mountPoint = fi.canonicalFilePath();
+    const QStringList targets = recursive ? mountsBelow( mountPoint ) : QStringList { mountPoint };
+    if ( targets.isEmpty() )
+    {
+        return false;
+    }
+    for ( const auto& t : targets )
+    {
+        const QByteArray target = QFile::encodeName( t );
+        syncWritable( target );
+        if ( ::umount2( target.constData(), flags ) != 0 )
+        {
+            const int error = errno;
+            cDebug() << "umount2(2) of" << t << "failed:" << std::strerror( error );
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace
+
 int
 mount( const QString& devicePath, const QString& mountPoint, const QString& filesystemName, const QString& options )
 {
@@ -51,6 +318,11 @@ mount( const QString& devicePath, const QString& mountPoint, const QString& file
         }
     }
 
+    if ( mountDirect( devicePath, mountPoint, filesystemName, options ) )
+    {
+        return 0;
+    }
+
     QStringList args = { "mount" };
 
     if ( !filesystemName.isEmpty() )
@@ -71,17 +343,48 @@ mount( const QString& devicePath, const QString& mountPoint, const QString& file
     args << devicePath << mountPoint;
 
     auto r = CalamaresUtils::System::runCommand( args, std::chrono::seconds( 10 ) );
-    sync();
     return r.getExitCode();
 }
 
 int
 unmount( const QString& path, const QStringList& options )
 {
-    auto r
-        = CalamaresUtils::System::runCommand( QStringList { "umount" } << options << path, std::chrono::seconds( 10 ) );
-    sync();
-    return r.getExitCode();
+    int exitCode = 0;
+    if ( !unmountDirect( path, options ) )
+    {
+        auto r = CalamaresUtils::System::runCommand( QStringList { "umount" } << options << path,
+                                                     std::chrono::seconds( 10 ) );
+        exitCode = r.getExitCode();
+    }
+
+    // udev handles the events of the unmount (e.g. it re-reads the device);
+    // callers go on to change the device, so wait for it, as before.
+    auto r = CalamaresUtils::System::runCommand( { "udevadm", "settle" }, std::chrono::seconds( 10 ) );
+    if ( r.getExitCode() != 0 )
+    {
+        cWarning() << "Could not settle disks after unmounting" << path;
+    }
+    return exitCode;
+}
+
+QString
+mountedDevice( const QString& mountPoint )
+{
+    QString device;
+    QFile f( QStringLiteral( "/proc/self/mounts" ) );
+    if ( f.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        for ( const auto& line : f.readAll().split( '\n' ) )
+        {
+            const auto fields = line.split( ' ' );
+            // Later mounts hide earlier ones, so the last match wins
+            if ( fields.count() >= 2 && decodeMountPath( fields.at( 1 ) ) == mountPoint )
+            {
+                device = decodeMountPath( fields.at( 0 ) );
+            }
+        }
+    }
+    return device;
 }
 
 struct TemporaryMount::Private
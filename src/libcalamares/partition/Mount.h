@@ -25,14 +25,20 @@ namespace Partition
 {
 
 /**
- * Runs the mount utility with the specified parameters.
+ * Mounts a filesystem with the specified parameters.
+ *
+ * This uses mount(2) directly when it can. Mounts without a
+ * filesystem type (mount(8) probes the device for it), options that
+ * need mount(8) (e.g. loop or --bind), and mounts that fail, are
+ * passed on to the mount utility.
+ *
  * @param devicePath the path of the partition to mount.
  * @param mountPoint the full path of the target mount point.
  * @param filesystemName the name of the filesystem (optional).
  * @param options any additional options as passed to mount -o (optional).
  *          If @p options starts with a dash (-) then it is passed unchanged
  *          and no -o option is added; this is used in handling --bind mounts.
- * @returns the program's exit code, or:
+ * @returns 0 on success, otherwise the mount program's exit code, or:
  *             Crashed = QProcess crash
  *             FailedToStart = QProcess cannot start
  *             NoWorkingDirectory = bad arguments
@@ -44,12 +50,24 @@ DLLEXPORT int mount( const QString& devicePath,
 
 /** @brief Unmount the given @p path (device or mount point).
  *
- * Runs umount(8) in the host system.
+ * Uses umount2(2) for mount points (the options -R, -l and -f are
+ * understood), and runs umount(8) in the host system otherwise,
+ * or if that fails. A filesystem that is mounted read-write is
+ * synced first; nothing else is synced. Afterwards, this waits
+ * for udev to settle.
  *
- * @returns the program's exit code, or special codes like mount().
+ * @returns 0 on success, otherwise the program's exit code, or special codes like mount().
  */
 DLLEXPORT int unmount( const QString& path, const QStringList& options = QStringList() );
 
+/** @brief The device that is mounted at @p mountPoint
+ *
+ * This is what /proc/self/mounts lists for the mount point, which
+ * may be a path like /dev/sda1 or something else entirely (e.g.
+ * "tmpfs"). Returns an empty string if nothing is mounted there.
+ */
+DLLEXPORT QString mountedDevice( const QString& mountPoint );
+
 class DLLEXPORT TemporaryMount
 {
 public:
@@ -75,7 +75,8 @@ findPartitionByCurrentMountPoint( const QList< Device* >& devices, const QString
 Partition*
 findPartitionByPath( const QList< Device* >& devices, const QString& path )
 {
-    if ( path.simplified().isEmpty() )
+    const QString simplePath = path.simplified();
+    if ( simplePath.isEmpty() )
     {
         return nullptr;
     }
@@ -84,7 +85,7 @@ findPartitionByPath( const QList< Device* >& devices, const QString& path )
     {
         for ( auto it = PartitionIterator::begin( device ); it != PartitionIterator::end( device ); ++it )
         {
-            if ( ( *it )->partitionPath() == path.simplified() )
+            if ( ( *it )->partitionPath() == simplePath )
             {
                 return *it;
             }
@@ -60,6 +60,8 @@ Partition* findPartitionByCurrentMountPoint( const QList< Device* >& devices, co
 /**
  * Iterates on all devices and partitions and returns a pointer to the Partition object
  * for the given path, or nullptr if a Partition for the given path cannot be found.
+ *
+ * To look up many paths on the same devices, use a PartitionSnapshot.
  */
 Partition* findPartitionByPath( const QList< Device* >& devices, const QString& path );
 
@@ -128,7 +128,7 @@ PartitionSize::toBytes( qint64 totalSectors, qint64 sectorSize ) const
         }
         else
         {
-            return totalSectors * value() / 100;
+            return totalSectors * sectorSize * value() / 100;
         }
     case SizeUnit::Byte:
     case SizeUnit::KB:
@@ -182,32 +182,8 @@ PartitionSize::toBytes( qint64 totalBytes ) const
 qint64
 PartitionSize::toBytes() const
 {
-    if ( !isValid() )
-    {
-        return -1;
-    }
-
-    switch ( m_unit )
-    {
-    case SizeUnit::None:
-    case SizeUnit::Percent:
-        return -1;
-    case SizeUnit::Byte:
-        return value();
-    case SizeUnit::KB:
-        return CalamaresUtils::KBtoBytes( static_cast< unsigned long long >( value() ) );
-    case SizeUnit::KiB:
-        return CalamaresUtils::KiBtoBytes( static_cast< unsigned long long >( value() ) );
-    case SizeUnit::MB:
-        return CalamaresUtils::MBtoBytes( static_cast< unsigned long long >( value() ) );
-    case SizeUnit::MiB:
-        return CalamaresUtils::MiBtoBytes( static_cast< unsigned long long >( value() ) );
-    case SizeUnit::GB:
-        return CalamaresUtils::GBtoBytes( static_cast< unsigned long long >( value() ) );
-    case SizeUnit::GiB:
-        return CalamaresUtils::GiBtoBytes( static_cast< unsigned long long >( value() ) );
-    }
-    __builtin_unreachable();
+    const qint64 bytes = unitBytes( m_unit );
+    return ( isValid() && bytes ) ? value() * bytes : -1;
 }
 
 bool
@@ -99,6 +99,35 @@ public:
      */
     qint64 toBytes() const;
 
+    /** @brief Number of bytes in one @p unit
+     *
+     * Returns 0 for units that are not a fixed size (None, Percent).
+     */
+    static constexpr qint64 unitBytes( const SizeUnit unit )
+    {
+        switch ( unit )
+        {
+        case SizeUnit::None:
+        case SizeUnit::Percent:
+            return 0;
+        case SizeUnit::Byte:
+            return 1;
+        case SizeUnit::KB:
+            return CalamaresUtils::KBtoBytes( 1ULL );
+        case SizeUnit::KiB:
+            return CalamaresUtils::KiBtoBytes( 1ULL );
+        case SizeUnit::MB:
+            return CalamaresUtils::MBtoBytes( 1ULL );
+        case SizeUnit::MiB:
+            return CalamaresUtils::MiBtoBytes( 1ULL );
+        case SizeUnit::GB:
+            return CalamaresUtils::GBtoBytes( 1ULL );
+        case SizeUnit::GiB:
+            return CalamaresUtils::GiBtoBytes( 1ULL );
+        }
+        return 0;
+    }
+
     /** @brief Are the units comparable?
      *
      * None units cannot be compared with anything. Percentages can
@@ -0,0 +1,84 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "PartitionSnapshot.h"
+
+#include "PartitionIterator.h"
+#include "PartitionQuery.h"
+
+#include <kpmcore/core/device.h>
+#include <kpmcore/core/partition.h>
+
+namespace CalamaresUtils
+{
+namespace Partition
+{
+
+PartitionSnapshot::PartitionSnapshot( const QList< ::Device* >& devices )
+{
+    for ( auto* device : devices )
+    {
+        for ( auto it = PartitionIterator::begin( device ); it != PartitionIterator::end( device ); ++it )
+        {
+            ::Partition* p = *it;
+            Entry e;
+            e.partition = p;
+            e.device = device;
+            e.path = p->partitionPath();
+            e.mountPoint = p->mountPoint();
+            e.firstSector = p->firstSector();
+            e.lastSector = p->lastSector();
+            e.isFreeSpace = isPartitionFreeSpace( p );
+            e.isNew = isPartitionNew( p );
+            // Like findPartitionByPath(), the first one wins
+            if ( !e.path.isEmpty() && !m_byPath.contains( e.path ) )
+            {
+                m_byPath.insert( e.path, m_entries.count() );
+            }
+            m_entries.append( e );
+        }
+    }
+}
+
+const PartitionSnapshot::Entry*
+PartitionSnapshot::findByPath( const QString& path ) const
+{
+    const auto it = m_byPath.constFind( path.simplified() );
+    return it == m_byPath.constEnd() ? nullptr : &m_entries.at( it.value() );
+}
+
+const PartitionSnapshot::Entry*
+PartitionSnapshot::findByCurrentMountPoint( const QString& mountPoint ) const
+{
+    for ( const auto& e : m_entries )
+    {
+        if ( e.mountPoint == mountPoint )
+        {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+QList< ::Partition* >
+PartitionSnapshot::find( const std::function< bool( const Entry& ) >& criterion ) const
+{
+    QList< ::Partition* > results;
+    for ( const auto& e : m_entries )
+    {
+        if ( criterion( e ) )
+        {
+            results.append( e.partition );
+        }
+    }
+    return results;
+}
+
+}  // namespace Partition
+}  // namespace CalamaresUtils
@@ -0,0 +1,82 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+/*
+ * NOTE: this functionality is only available when Calamares is compiled
+ *       with KPMcore support.
+ */
+
+#ifndef PARTITION_PARTITIONSNAPSHOT_H
+#define PARTITION_PARTITIONSNAPSHOT_H
+
+#include "DllMacro.h"
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+class Device;
+class Partition;
+
+namespace CalamaresUtils
+{
+namespace Partition
+{
+
+/** @brief The partitions of some devices, as a flat list
+ *
+ * Going through the partitions with PartitionIterator walks the
+ * partition tree, and asking for the path or mount point of a
+ * partition asks KPMcore, each time. A snapshot does both once, so
+ * it is cheaper for looking up many partitions on the same devices.
+ *
+ * The snapshot does not notice changes to the devices: make a new
+ * one after a partition has been created, removed or changed. The
+ * Partition pointers still belong to the devices.
+ */
+class DLLEXPORT PartitionSnapshot
+{
+public:
+    struct Entry
+    {
+        ::Partition* partition = nullptr;
+        ::Device* device = nullptr;
+        QString path;  ///< partitionPath()
+        QString mountPoint;  ///< Where it is mounted at the time of the snapshot
+        qint64 firstSector = 0;
+        qint64 lastSector = 0;
+        bool isFreeSpace = false;
+        bool isNew = false;  ///< Planned by the installer
+    };
+
+    explicit PartitionSnapshot( const QList< ::Device* >& devices );
+
+    /// @brief All the partitions, in the order PartitionIterator visits them
+    const QVector< Entry >& entries() const { return m_entries; }
+    int count() const { return m_entries.count(); }
+
+    /// @brief The partition with the given @p path (e.g. "/dev/sda1"), or nullptr
+    const Entry* findByPath( const QString& path ) const;
+    /// @brief The first partition (already) mounted on @p mountPoint, or nullptr
+    const Entry* findByCurrentMountPoint( const QString& mountPoint ) const;
+    /// @brief The partitions for which @p criterion is true
+    QList< ::Partition* > find( const std::function< bool( const Entry& ) >& criterion ) const;
+
+private:
+    QVector< Entry > m_entries;
+    QHash< QString, int > m_byPath;
+};
+
+}  // namespace Partition
+}  // namespace CalamaresUtils
+
+#endif  // PARTITION_PARTITIONSNAPSHOT_H
@@ -0,0 +1,155 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "Swap.h"
+
+#include "utils/Entropy.h"
+#include "utils/Logger.h"
+
+#include <QByteArray>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef Q_OS_LINUX
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+namespace CalamaresUtils
+{
+namespace Partition
+{
+
+/** @brief The first page of a swap area, as in linux/swap.h
+ *
+ * The info starts after 1024 bytes of boot bits; the magic is
+ * in the last 10 bytes of the page.
+ */
+static QByteArray
+swapHeader( int pageSize, quint32 lastPage )
+{
+    QByteArray page( pageSize, '\0' );
+    auto put32 = [ &page ]( int offset, quint32 v ) { std::memcpy( page.data() + offset, &v, sizeof( v ) ); };
+    put32( 1024, 1 );  // version
+    put32( 1028, lastPage );
+    put32( 1032, 0 );  // nr_badpages
+
+    QByteArray uuid;
+    CalamaresUtils::getEntropy( 16, uuid );
+    uuid[ 6 ] = char( ( uuid[ 6 ] & 0x0f ) | 0x40 );  // Version 4 (random)
+    uuid[ 8 ] = char( ( uuid[ 8 ] & 0x3f ) | 0x80 );  // Variant 1
+    std::memcpy( page.data() + 1036, uuid.constData(), 16 );
+
+    std::memcpy( page.data() + pageSize - 10, "SWAPSPACE2", 10 );
+    return page;
+}
+
+/// @brief Write zeroes to the first @p size bytes of @p fd
+static int
+writeZeroes( int fd, qint64 size )
+{
+    const QByteArray zeroes( 1 << 20, '\0' );
+    for ( qint64 written = 0; written < size; )
+    {
+        const auto chunk = std::min< qint64 >( zeroes.size(), size - written );
+        const auto r = ::write( fd, zeroes.constData(), std::size_t( chunk ) );
+        if ( r < 0 && errno == EINTR )
+        {
+            continue;
+        }
+        if ( r <= 0 )
+        {
+            return r < 0 ? errno : ENOSPC;
+        }
+        written += r;
+    }
+    return 0;
+}
+
+int
+createSwapFile( const QString& path, qint64 sizeB, bool noCow )
+{
+    const int pageSize = int( sysconf( _SC_PAGESIZE ) );
+    const qint64 pages = sizeB / pageSize;
+    if ( pages < 10 )
+    {
+        cWarning() << "Swapfile" << path << "of" << sizeB << "bytes is too small.";
+        return EINVAL;
+    }
+    sizeB = pages * pageSize;
+
+    const QByteArray name = path.toLocal8Bit();
+    int fd = ::open( name.constData(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600 );
+    if ( fd < 0 )
+    {
+        const int e = errno;
+        cWarning() << "Cannot create swapfile" << path << std::strerror( e );
+        return e;
+    }
+    // The file may have existed already, with another mode
+    ::fchmod( fd, 0600 );
+
+    auto fail = [ fd, &path ]( const char* what, int e ) {
+        cWarning() << "Cannot" << what << "swapfile" << path << std::strerror( e );
+        ::close( fd );
+        return e;
+    };
+
+#ifdef Q_OS_LINUX
+    if ( noCow )
+    {
+        // This only works while the file is empty
+        int flags = 0;
+        if ( ::ioctl( fd, FS_IOC_GETFLAGS, &flags ) != 0 )
+        {
+            return fail( "get attributes of", errno );
+        }
+        flags |= FS_NOCOW_FL;
+        if ( ::ioctl( fd, FS_IOC_SETFLAGS, &flags ) != 0 )
+        {
+            return fail( "set No_COW on", errno );
+        }
+    }
+#else
+    Q_UNUSED( noCow )
+#endif
+
+    int r = ::posix_fallocate( fd, 0, sizeB );
+    if ( r == EOPNOTSUPP || r == EINVAL )
+    {
+        cDebug() << "Swapfile" << path << "cannot be allocated, writing it instead.";
+        r = writeZeroes( fd, sizeB );
+    }
+    if ( r )
+    {
+        return fail( "allocate", r );
+    }
+
+    const QByteArray header = swapHeader( pageSize, quint32( pages - 1 ) );
+    if ( ::pwrite( fd, header.constData(), std::size_t( header.size() ), 0 ) != ssize_t( header.size() ) )
+    {
+        return fail( "write header of", errno ? errno : EIO );
+    }
+    if ( ::fsync( fd ) != 0 )
+    {
+        return fail( "sync", errno );
+    }
+    ::close( fd );
+    cDebug() << "Swapfile" << path << "created," << sizeB << "bytes.";
+    return 0;
+}
+
+}  // namespace Partition
+}  // namespace CalamaresUtils
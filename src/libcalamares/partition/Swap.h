@@ -0,0 +1,39 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef PARTITION_SWAP_H
+#define PARTITION_SWAP_H
+
+#include "DllMacro.h"
+
+#include <QString>
+
+namespace CalamaresUtils
+{
+namespace Partition
+{
+
+/** @brief Creates a swapfile at @p path of (about) @p sizeB bytes
+ *
+ * The file is created with mode 0600 and allocated with fallocate(2),
+ * and gets the same swap header that mkswap(8) writes (version 1,
+ * with a random UUID). The size is rounded down to whole pages. If
+ * @p noCow is set, the file is marked No_COW before it is allocated,
+ * which is what btrfs needs for a swapfile (this also turns off
+ * compression for it); this is what `chattr +C` does.
+ *
+ * If the filesystem does not support fallocate(), the file is written
+ * with zeroes instead. Returns 0 on success, or an errno value.
+ */
+DLLEXPORT int createSwapFile( const QString& path, qint64 sizeB, bool noCow = false );
+
+}  // namespace Partition
+}  // namespace CalamaresUtils
+
+#endif
@@ -13,6 +13,22 @@
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/Logger.h"
 
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
 void
 CalamaresUtils::Partition::sync()
 {
@@ -33,3 +49,239 @@ CalamaresUtils::Partition::sync()
 
     CalamaresUtils::System::runCommand( { "sync" }, std::chrono::seconds( 10 ) );
 }
+
+namespace
+{
+/// @brief Kernel events come from the kernel, udev sends events when it is done with them
+enum class EventSource
+{
+    Kernel,
+    Udev
+};
+
+struct UEvent
+{
+    quint64 seqnum = 0;
+    QByteArray devpath;  ///< e.g. /devices/pci0000:00/.../block/sda/sda1
+    bool isBlock = false;
+};
+
+/** @brief Reads the KEY=VALUE properties of a uevent
+ *
+ * Kernel events start with "action@devpath"; udev events have a
+ * header (from libudev) that says where the properties are.
+ */
+bool
+parseEvent( const char* buffer, ssize_t length, EventSource source, UEvent& event )
+{
+    const char* properties = buffer;
+    ssize_t size = length;
+    if ( source == EventSource::Udev )
+    {
+        // char prefix[8] = "libudev", then big-endian magic 0xfeedcafe,
+        // header size, properties offset and properties length.
+        if ( length < 24 || std::strncmp( buffer, "libudev", 8 ) != 0 )
+        {
+            return false;
+        }
+        quint32 offset = 0;
+        quint32 propertiesLength = 0;
+        std::memcpy( &offset, buffer + 16, sizeof( offset ) );
+        std::memcpy( &propertiesLength, buffer + 20, sizeof( propertiesLength ) );
+        if ( qint64( offset ) + qint64( propertiesLength ) > length )
+        {
+            return false;
+        }
+        properties = buffer + offset;
+        size = propertiesLength;
+    }
+
+    for ( ssize_t i = 0; i < size; )
+    {
+        const char* p = properties + i;
+        const size_t l = strnlen( p, size_t( size - i ) );
+        if ( std::strncmp( p, "SEQNUM=", 7 ) == 0 )
+        {
+            event.seqnum = QByteArray( p + 7, int( l ) - 7 ).toULongLong();
+        }
+        else if ( std::strncmp( p, "DEVPATH=", 8 ) == 0 )
+        {
+            event.devpath = QByteArray( p + 8, int( l ) - 8 );
+        }
+        else if ( std::strncmp( p, "SUBSYSTEM=block", 16 ) == 0 )
+        {
+            event.isBlock = true;
+        }
+        i += ssize_t( l ) + 1;
+    }
+    return event.seqnum > 0;
+}
+
+/// @brief Kernel name of @p device, e.g. "dm-3" for /dev/mapper/vg-root
+QByteArray
+kernelName( const QString& device )
+{
+    const QFileInfo fi( device );
+    const QString canonical = fi.canonicalFilePath();
+    return QFile::encodeName( ( canonical.isEmpty() ? fi.fileName() : QFileInfo( canonical ).fileName() ) );
+}
+
+/// @brief Does @p devpath name one of the @p names, or a partition of it?
+bool
+isAbout( const QByteArray& devpath, const QList< QByteArray >& names )
+{
+    for ( const auto& name : names )
+    {
+        const QByteArray component = '/' + name;
+        if ( devpath.endsWith( component ) || devpath.contains( component + '/' ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief Writes out, and drops, the buffers of block device @p name
+void
+flushDevice( const QByteArray& name )
+{
+    // Read-only, since closing a device that was open for writing
+    // makes udev look at it again.
+    const int fd = ::open( QByteArray( "/dev/" + name ).constData(), O_RDONLY | O_CLOEXEC );
+    if ( fd >= 0 )
+    {
+        ::fsync( fd );
+        ::ioctl( fd, BLKFLSBUF, 0 );
+        ::close( fd );
+    }
+}
+}  // namespace
+
+struct CalamaresUtils::Partition::Syncer::Private
+{
+    QList< QByteArray > names;
+    int socket = -1;
+
+    void wait();
+};
+
+void
+CalamaresUtils::Partition::Syncer::Private::wait()
+{
+    static constexpr int timeout = 10000;  // ms, like udevadm settle
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QSet< quint64 > pending;  // Kernel events about our devices
+    QSet< quint64 > processed;  // Events that udev is done with
+    char buffer[ 8192 ];
+    while ( true )
+    {
+        // Read everything there is, then see what is left to wait for
+        while ( true )
+        {
+            struct sockaddr_nl sender;
+            socklen_t senderSize = sizeof( sender );
+            const ssize_t r = ::recvfrom( socket,
+                                          buffer,
+                                          sizeof( buffer ) - 1,
+                                          0,
+                                          reinterpret_cast< struct sockaddr* >( &sender ),
+                                          &senderSize );
+            if ( r < 0 )
+            {
+                if ( errno == EINTR )
+                {
+                    continue;
+                }
+                break;
+            }
+            buffer[ r ] = 0;
+            UEvent event;
+            const EventSource source = sender.nl_pid == 0 ? EventSource::Kernel : EventSource::Udev;
+            if ( !parseEvent( buffer, r, source, event ) )
+            {
+                continue;
+            }
+            if ( source == EventSource::Udev )
+            {
+                processed.insert( event.seqnum );
+            }
+            else if ( event.isBlock && isAbout( event.devpath, names ) )
+            {
+                pending.insert( event.seqnum );
+            }
+        }
+        pending.subtract( processed );
+        if ( pending.isEmpty() )
+        {
+            return;
+        }
+
+        const int remaining = timeout - int( timer.elapsed() );
+        struct pollfd p = { socket, POLLIN, 0 };
+        if ( remaining <= 0 || ::poll( &p, 1, remaining ) == 0 )
+        {
+            cWarning() << "Timed out waiting for udev on" << names << "with" << pending.count() << "events left";
+            return;
+        }
+    }
+}
+
+CalamaresUtils::Partition::Syncer::Syncer() {}
+
+CalamaresUtils::Partition::Syncer::Syncer( const QStringList& devices )
+    : m_d( std::make_unique< Private >() )
+{
+    for ( const auto& d : devices )
+    {
+        m_d->names.append( kernelName( d ) );
+    }
+
+    // Without udev running, there is nothing to wait for
+    if ( !QFile::exists( QStringLiteral( "/run/udev/control" ) ) )
+    {
+        return;
+    }
+
+    m_d->socket = ::socket( AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT );
+    if ( m_d->socket < 0 )
+    {
+        m_d.reset();
+        return;
+    }
+    // Events are only read when the Syncer is destroyed, so make room for plenty
+    const int bufferSize = 4 * 1024 * 1024;
+    ::setsockopt( m_d->socket, SOL_SOCKET, SO_RCVBUFFORCE, &bufferSize, sizeof( bufferSize ) );
+
+    struct sockaddr_nl address;
+    std::memset( &address, 0, sizeof( address ) );
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = 1 | 2;  // Kernel events, and udev events
+    if ( ::bind( m_d->socket, reinterpret_cast< struct sockaddr* >( &address ), sizeof( address ) ) < 0 )
+    {
+        cDebug() << "Can not listen to udev events:" << std::strerror( errno );
+        ::close( m_d->socket );
+        m_d.reset();
+    }
+}
+
+CalamaresUtils::Partition::Syncer::~Syncer()
+{
+    if ( !m_d )
+    {
+        sync();
+        return;
+    }
+
+    for ( const auto& name : qAsConst( m_d->names ) )
+    {
+        flushDevice( name );
+    }
+    if ( m_d->socket >= 0 )
+    {
+        m_d->wait();
+        ::close( m_d->socket );
+    }
+}
@@ -13,6 +13,10 @@
 
 #include "DllMacro.h"
 
+#include <QStringList>
+
+#include <memory>
+
 namespace CalamaresUtils
 {
 namespace Partition
@@ -28,10 +32,30 @@ namespace Partition
  */
 DLLEXPORT void sync();
 
-/** @brief RAII class for calling sync() */
-struct DLLEXPORT Syncer
+/** @brief RAII class for calling sync()
+ *
+ * A default-constructed Syncer calls sync() when it is destroyed.
+ *
+ * Given a list of devices (e.g. "/dev/sda", or "/dev/dm-3"), it
+ * starts listening for udev events when it is constructed: then
+ * the destructor flushes just those devices, and waits (at most ten
+ * seconds) for udev to finish the events about them, and about their
+ * partitions, that happened in the meantime. Other activity on the
+ * system does not hold it up. If there is no way to listen to udev,
+ * it falls back to sync().
+ */
+class DLLEXPORT Syncer
 {
-    ~Syncer() { sync(); }
+public:
+    Syncer();
+    explicit Syncer( const QStringList& devices );
+    Syncer( const Syncer& ) = delete;
+    Syncer& operator=( const Syncer& ) = delete;
+    ~Syncer();
+
+private:
+    struct Private;
+    std::unique_ptr< Private > m_d;
 };
 
 }  // namespace Partition
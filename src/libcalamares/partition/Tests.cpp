@@ -10,13 +10,19 @@
 
 #include "Global.h"
 #include "PartitionSize.h"
+#include "Swap.h"
 
 #include "GlobalStorage.h"
 #include "utils/Logger.h"
 
 #include <QObject>
+#include <QTemporaryDir>
 #include <QtTest/QtTest>
 
+#include <cstring>
+
+#include <unistd.h>
+
 using SizeUnit = CalamaresUtils::Partition::SizeUnit;
 using PartitionSize = CalamaresUtils::Partition::PartitionSize;
 
@@ -37,8 +43,11 @@ private Q_SLOTS:
 
     void testUnitNormalisation_data();
     void testUnitNormalisation();
+    void testPercentSizes();
 
     void testFilesystemGS();
+
+    void testSwapFile();
 };
 
 PartitionServiceTests::PartitionServiceTests() {}
@@ -158,6 +167,23 @@ PartitionServiceTests::testUnitNormalisation()
     QCOMPARE( PartitionSize( v, u1 ).toBytes(), bytes );
 }
 
+void
+PartitionServiceTests::testPercentSizes()
+{
+    static_assert( PartitionSize::unitBytes( SizeUnit::Percent ) == 0, "Percent is not a size" );
+    static_assert( PartitionSize::unitBytes( SizeUnit::MB ) == 1000000, "MB is a million bytes" );
+    static_assert( PartitionSize::unitBytes( SizeUnit::GiB ) == 1073741824, "GiB is 2^30 bytes" );
+
+    // 1000 sectors of 512 bytes
+    const PartitionSize half( 50, SizeUnit::Percent );
+    QCOMPARE( half.toSectors( 1000, 512 ), 500_qi );
+    QCOMPARE( half.toBytes( 1000, 512 ), 256000_qi );
+    QCOMPARE( half.toBytes( 512000 ), 256000_qi );
+
+    const PartitionSize all( 100, SizeUnit::Percent );
+    QCOMPARE( all.toBytes( 1000, 512 ), 512000_qi );
+}
+
 void
 PartitionServiceTests::testFilesystemGS()
 {
@@ -218,6 +244,36 @@ PartitionServiceTests::testFilesystemGS()
     QVERIFY( !isFilesystemUsedGS( &gs, "ext4" ) );
 }
 
+void
+PartitionServiceTests::testSwapFile()
+{
+    using CalamaresUtils::Partition::createSwapFile;
+
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString path = dir.filePath( QStringLiteral( "swapfile" ) );
+    const qint64 pageSize = sysconf( _SC_PAGESIZE );
+
+    QVERIFY( createSwapFile( path, 9 * pageSize ) != 0 );  // Too small
+
+    // Rounded down to whole pages
+    QCOMPARE( createSwapFile( path, 64 * pageSize + 100 ), 0 );
+    QFileInfo fi( path );
+    QCOMPARE( fi.size(), 64 * pageSize );
+    QCOMPARE( fi.permissions() & ( QFileDevice::ReadOther | QFileDevice::ReadGroup ), QFileDevice::Permissions() );
+
+    QFile f( path );
+    QVERIFY( f.open( QIODevice::ReadOnly ) );
+    const QByteArray header = f.read( pageSize );
+    QCOMPARE( header.right( 10 ), QByteArray( "SWAPSPACE2" ) );
+    quint32 version = 0, lastPage = 0;
+    std::memcpy( &version, header.constData() + 1024, sizeof( version ) );
+    std::memcpy( &lastPage, header.constData() + 1028, sizeof( lastPage ) );
+    QCOMPARE( version, 1u );
+    QCOMPARE( lastPage, 63u );
+    QVERIFY( header.mid( 1036, 16 ) != QByteArray( 16, '\0' ) );  // UUID
+    QCOMPARE( header.left( 1024 ), QByteArray( 1024, '\0' ) );
+}
 
 QTEST_GUILESS_MAIN( PartitionServiceTests )
 
@@ -14,24 +14,29 @@
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 #include "Settings.h"
+#include "utils/Executor.h"
+#include "utils/HardwareInfo.h"
 #include "utils/Logger.h"
 
 #include <QCoreApplication>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
 #include <QProcess>
 #include <QRegularExpression>
+#include <QSet>
+#include <QThread>
+#include <QUuid>
 
-#ifdef Q_OS_LINUX
-#include <sys/sysinfo.h>
-#endif
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+
+#include <signal.h>
+#include <unistd.h>
 
-#ifdef Q_OS_FREEBSD
-// clang-format off
-// these includes need to stay in-order (that's a FreeBSD thing)
-#include <sys/types.h>
-#include <sys/sysctl.h>
-// clang-format on
-#endif
 
 /** @brief When logging commands, don't log everything.
  *
@@ -109,17 +114,19 @@ System::instance()
 }
 
 
-ProcessResult
-System::runCommand( System::RunLocation location,
-                    const QStringList& args,
-                    const QString& workingPath,
-                    const QString& stdInput,
-                    std::chrono::seconds timeoutSec )
+/** @brief Prepares @p process to run @p args in @p location
+ *
+ * Sets the program, arguments and working directory; returns 0 if
+ * the process is ready to start, or an error code (a ProcessResult::Code)
+ * if not. Does not start the process.
+ */
+static int
+prepareProcess( System::RunLocation location, const QStringList& args, const QString& workingPath, QProcess& process )
 {
     if ( args.isEmpty() )
     {
         cWarning() << "Cannot run an empty program list";
-        return ProcessResult::Code::FailedToStart;
+        return static_cast< int >( ProcessResult::Code::FailedToStart );
     }
 
     Calamares::GlobalStorage* gs
@@ -128,7 +135,7 @@ System::runCommand( System::RunLocation location,
     if ( ( location == System::RunLocation::RunInTarget ) && ( !gs || !gs->contains( "rootMountPoint" ) ) )
     {
         cWarning() << "No rootMountPoint in global storage, while RunInTarget is specified";
-        return ProcessResult::Code::NoWorkingDirectory;
+        return static_cast< int >( ProcessResult::Code::NoWorkingDirectory );
     }
 
     QString program;
@@ -140,7 +147,7 @@ System::runCommand( System::RunLocation location,
         if ( !QDir( destDir ).exists() )
         {
             cWarning() << "rootMountPoint points to a dir which does not exist";
-            return ProcessResult::Code::NoWorkingDirectory;
+            return static_cast< int >( ProcessResult::Code::NoWorkingDirectory );
         }
 
         program = "chroot";
@@ -151,10 +158,8 @@ System::runCommand( System::RunLocation location,
         program = "env";
     }
 
-    QProcess process;
     process.setProgram( program );
     process.setArguments( arguments );
-    process.setProcessChannelMode( QProcess::MergedChannels );
 
     if ( !workingPath.isEmpty() )
     {
@@ -165,11 +170,448 @@ System::runCommand( System::RunLocation location,
         else
         {
             cWarning() << "Invalid working directory:" << workingPath;
-            return ProcessResult::Code::NoWorkingDirectory;
+            return static_cast< int >( ProcessResult::Code::NoWorkingDirectory );
         }
     }
 
     cDebug() << "Running" << program << RedactedList( arguments );
+    return 0;
+}
+
+/** @brief A QProcess that starts the command in a process group of its own
+ *
+ * Commands start processes of their own (e.g. chroot starts the command,
+ * and scripts start all kinds of things); stopProcessGroup() stops them
+ * all, not just the one started by QProcess.
+ *
+ * A process group of its own is not in the foreground of the terminal,
+ * and would be stopped when it reads from it; so when the input comes
+ * from a terminal (with QProcess::ForwardedInputChannel), the command
+ * stays in the group of Calamares.
+ */
+class GroupProcess : public QProcess
+{
+protected:
+    void setupChildProcess() override
+    {
+        // The channels are set up already, so this is the input of the command
+        if ( !::isatty( STDIN_FILENO ) )
+        {
+            ::setpgid( 0, 0 );
+        }
+    }
+};
+
+/// @brief Sends @p signal to the group of @p pid, if it leads a group (see GroupProcess), or to @p pid
+static void
+signalGroup( pid_t pid, bool ownGroup, int signal )
+{
+    ::kill( ownGroup ? -pid : pid, signal );
+}
+
+/// @brief Is @p pid the leader of a process group (see GroupProcess)?
+static bool
+isGroupLeader( pid_t pid )
+{
+    return pid > 0 && ::getpgid( pid ) == pid;
+}
+
+/** @brief Stops all the processes in the group of @p process
+ *
+ * They get a moment to exit after SIGTERM, then they are killed.
+ */
+static void
+stopProcessGroup( QProcess& process )
+{
+    const auto pid = static_cast< pid_t >( process.processId() );
+    if ( pid > 0 )
+    {
+        // Before it exits, since the group is gone with its last process
+        const bool ownGroup = isGroupLeader( pid );
+        signalGroup( pid, ownGroup, SIGTERM );
+        process.waitForFinished( 500 );
+        // Kill what is left of the group, even if the command itself has exited
+        if ( ownGroup )
+        {
+            signalGroup( pid, ownGroup, SIGKILL );
+        }
+    }
+    process.kill();
+    process.waitForFinished();
+}
+
+/** @brief A long-lived shell in the target system
+ *
+ * Commands are written to the standard input of a shell that runs in the
+ * chroot, one at a time; each command is followed by printing a marker
+ * line with the exit code of the command, so that the output of each
+ * command can be picked out. This saves starting chroot (and a new
+ * process environment) for each command.
+ *
+ * There is one shell per thread, since a QProcess must be used from
+ * the thread that created it. If the shell dies (or a command times
+ * out, in which case the shell is killed), it is started again for
+ * the next command. The shells of all the threads can be killed from
+ * any thread with stopAll(), which works on the process ids only.
+ */
+class TargetShell
+{
+public:
+    TargetShell();
+    ~TargetShell();
+
+    ProcessResult run( const QString& root, const QStringList& args, std::chrono::seconds timeoutSec );
+
+    /// @brief Kills the shells of all the threads, and waits for them to exit
+    static void stopAll();
+
+private:
+    bool ensureRunning( const QString& root );
+    void stop();
+    void reset();
+
+    std::unique_ptr< GroupProcess > m_process;
+    QString m_root;
+    QByteArray m_marker;
+    std::atomic< qint64 > m_pid { 0 };  ///< Of the running shell, for stopAll()
+    std::atomic< bool > m_killed { false };  ///< Set by stopAll()
+};
+
+/// @brief The shells of all the threads, for TargetShell::stopAll()
+static QMutex&
+shellsMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+static QSet< TargetShell* >&
+shells()
+{
+    static QSet< TargetShell* > s;
+    return s;
+}
+
+TargetShell::TargetShell()
+{
+    QMutexLocker lock( &shellsMutex() );
+    shells().insert( this );
+}
+
+TargetShell::~TargetShell()
+{
+    {
+        QMutexLocker lock( &shellsMutex() );
+        shells().remove( this );
+    }
+    stop();
+}
+
+void
+TargetShell::reset()
+{
+    m_pid = 0;
+    m_process.reset();
+}
+
+void
+TargetShell::stop()
+{
+    if ( m_process )
+    {
+        m_process->closeWriteChannel();
+        if ( !m_process->waitForFinished( 1000 ) )
+        {
+            m_process->kill();
+            m_process->waitForFinished();
+        }
+        reset();
+    }
+}
+
+/// @brief Has process @p pid exited (it may be a zombie still)?
+static bool
+hasExited( qint64 pid )
+{
+    QFile f( QStringLiteral( "/proc/%1/stat" ).arg( pid ) );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        return true;
+    }
+    // The state follows the command name, which is in parentheses
+    const QByteArray stat = f.readAll();
+    const int i = stat.lastIndexOf( ')' );
+    return i < 0 || stat.mid( i + 2, 1 ) == "Z";
+}
+
+void
+TargetShell::stopAll()
+{
+    QMutexLocker lock( &shellsMutex() );
+    QList< qint64 > groups;
+    for ( TargetShell* shell : qAsConst( shells() ) )
+    {
+        const qint64 pid = shell->m_pid.exchange( 0 );
+        if ( pid > 0 )
+        {
+            // The owning thread cleans up the QProcess when it next runs a command
+            shell->m_killed = true;
+            ::kill( static_cast< pid_t >( -pid ), SIGTERM );
+            groups.append( pid );
+        }
+    }
+    if ( groups.isEmpty() )
+    {
+        return;
+    }
+    cDebug() << "Stopping" << groups.count() << "persistent shells in the target.";
+
+    QElapsedTimer timer;
+    timer.start();
+    bool killed = false;
+    while ( !std::all_of( groups.cbegin(), groups.cend(), hasExited ) )
+    {
+        if ( !killed && timer.hasExpired( 1000 ) )
+        {
+            for ( const auto pid : qAsConst( groups ) )
+            {
+                ::kill( static_cast< pid_t >( -pid ), SIGKILL );
+            }
+            killed = true;
+        }
+        else if ( timer.hasExpired( 3000 ) )
+        {
+            cWarning() << "Persistent shells in the target did not exit.";
+            return;
+        }
+        QThread::msleep( 10 );
+    }
+}
+
+bool
+TargetShell::ensureRunning( const QString& root )
+{
+    if ( m_killed.exchange( false ) )
+    {
+        stop();
+    }
+    if ( m_process && m_process->state() == QProcess::Running && m_root == root )
+    {
+        return true;
+    }
+    stop();
+
+    m_process = std::make_unique< GroupProcess >();
+    m_process->setProgram( QStringLiteral( "chroot" ) );
+    m_process->setArguments( { root, QStringLiteral( "/bin/sh" ) } );
+    m_process->setProcessChannelMode( QProcess::MergedChannels );
+    m_process->start();
+    if ( !m_process->waitForStarted() )
+    {
+        cWarning() << "Persistent shell in" << root << "failed to start" << m_process->error();
+        reset();
+        return false;
+    }
+    m_pid = m_process->processId();
+    m_root = root;
+    m_marker = QStringLiteral( "calamares-done-%1 " )
+                   .arg( QUuid::createUuid().toString().remove( '{' ).remove( '}' ) )
+                   .toLatin1();
+    return true;
+}
+
+/// @brief Quote @p s for a POSIX shell
+static QString
+shellQuote( QString s )
+{
+    return QChar( '\'' ) + s.replace( '\'', QStringLiteral( "'\\''" ) ) + QChar( '\'' );
+}
+
+ProcessResult
+TargetShell::run( const QString& root, const QStringList& args, std::chrono::seconds timeoutSec )
+{
+    if ( !ensureRunning( root ) )
+    {
+        return ProcessResult::Code::FailedToStart;
+    }
+
+    QStringList quoted;
+    quoted.reserve( args.count() );
+    std::transform( args.cbegin(), args.cend(), std::back_inserter( quoted ), shellQuote );
+    const QByteArray command = QByteArrayLiteral( "( exec " ) + quoted.join( ' ' ).toLocal8Bit()
+        + QByteArrayLiteral( " ) </dev/null 2>&1; printf '\\n%s%d\\n' '" ) + m_marker
+        + QByteArrayLiteral( "' $?\n" );
+    m_process->write( command );
+
+    QByteArray output;
+    QElapsedTimer timer;
+    timer.start();
+    const qint64 timeoutMs = std::chrono::milliseconds( timeoutSec ).count();
+    const auto cancellation = CalamaresUtils::Executor::currentCancellation();
+    while ( true )
+    {
+        while ( m_process->canReadLine() )
+        {
+            const QByteArray line = m_process->readLine();
+            if ( line.startsWith( m_marker ) )
+            {
+                return ProcessResult( line.mid( m_marker.length() ).trimmed().toInt(),
+                                      QString::fromLocal8Bit( output ).trimmed() );
+            }
+            output.append( line );
+        }
+        if ( m_process->state() != QProcess::Running )
+        {
+            cWarning() << "Persistent shell in" << root << "exited. Output so far:\n"
+                       << Logger::NoQuote << output;
+            reset();
+            return ProcessResult::Code::Crashed;
+        }
+        if ( timeoutMs > 0 && timer.hasExpired( timeoutMs ) )
+        {
+            cWarning() << "Process" << args.first() << "timed out after" << timeoutSec.count() << "s. Output so far:\n"
+                       << Logger::NoQuote << output;
+            stopProcessGroup( *m_process );
+            reset();
+            return ProcessResult::Code::TimedOut;
+        }
+        if ( cancellation.isCancelled() )
+        {
+            // The shell goes, too; the next command starts a new one
+            cWarning() << "Process" << args.first() << "cancelled.";
+            stopProcessGroup( *m_process );
+            reset();
+            return ProcessResult( static_cast< int >( ProcessResult::Code::Cancelled ),
+                                  QString::fromLocal8Bit( output ).trimmed() );
+        }
+        m_process->waitForReadyRead( 50 );
+    }
+}
+
+/** @brief Should this command go through the TargetShell?
+ *
+ * Only plain commands (no input, no working directory) in the
+ * target do, and only if the settings say so.
+ */
+static bool
+usePersistentShell( System::RunLocation location, const QString& workingPath, const QString& stdInput )
+{
+    return location == System::RunLocation::RunInTarget && workingPath.isEmpty() && stdInput.isEmpty()
+        && Calamares::Settings::instance() && Calamares::Settings::instance()->persistentTargetShell();
+}
+
+/// @brief Splits a simple @p command into @p words; false if it needs a shell
+static bool
+splitSimpleCommand( const QString& command, QStringList& words )
+{
+    // Characters that mean something to the shell, outside of quotes;
+    // some only in some places, but a shell is not wrong for those.
+    static const QString special = QStringLiteral( "|&;<>()$`\\*?[]{}~#!\n" );
+
+    QString word;
+    bool inWord = false;
+    for ( int i = 0; i < command.length(); ++i )
+    {
+        const QChar c = command.at( i );
+        if ( c == ' ' || c == '\t' )
+        {
+            if ( inWord )
+            {
+                words.append( word );
+                word.clear();
+                inWord = false;
+            }
+        }
+        else if ( c == '\'' || c == '"' )
+        {
+            const int close = command.indexOf( c, i + 1 );
+            if ( close < 0 )
+            {
+                return false;
+            }
+            const QString quoted = command.mid( i + 1, close - i - 1 );
+            if ( c == '"'
+                 && ( quoted.contains( '$' ) || quoted.contains( '`' ) || quoted.contains( '\\' ) ) )
+            {
+                return false;
+            }
+            word.append( quoted );
+            inWord = true;
+            i = close;
+        }
+        else if ( special.contains( c ) )
+        {
+            return false;
+        }
+        else
+        {
+            word.append( c );
+            inWord = true;
+        }
+    }
+    if ( inWord )
+    {
+        words.append( word );
+    }
+    return !words.isEmpty();
+}
+
+QStringList
+System::commandArguments( const QString& command )
+{
+    // Shell keywords and builtins (POSIX, and a few from bash) that have no program of the same name
+    static const QStringList builtins { ".", ":", "alias", "bg", "break", "case", "cd", "command", "continue", "eval",
+                                        "exec", "exit", "export", "fc", "fg", "for", "function", "getopts", "hash",
+                                        "if", "jobs", "local", "read", "readonly", "return", "select", "set", "shift",
+                                        "source", "times", "trap", "type", "ulimit", "umask", "unalias", "unset",
+                                        "until", "wait", "while" };
+
+    QStringList words;
+    // A = in the first word is a variable assignment (e.g. LANG=C ls)
+    if ( splitSimpleCommand( command, words ) && !words.first().contains( '=' )
+         && !builtins.contains( words.first() ) )
+    {
+        return words;
+    }
+    return { QStringLiteral( "/bin/sh" ), QStringLiteral( "-c" ), command };
+}
+
+void
+System::stopTargetShells()
+{
+    TargetShell::stopAll();
+}
+
+ProcessResult
+System::runCommand( System::RunLocation location,
+                    const QStringList& args,
+                    const QString& workingPath,
+                    const QString& stdInput,
+                    std::chrono::seconds timeoutSec )
+{
+    if ( !args.isEmpty() && usePersistentShell( location, workingPath, stdInput ) )
+    {
+        Calamares::GlobalStorage* gs
+            = Calamares::JobQueue::instance() ? Calamares::JobQueue::instance()->globalStorage() : nullptr;
+        const QString destDir = gs ? gs->value( "rootMountPoint" ).toString() : QString();
+        if ( !destDir.isEmpty() && QDir( destDir ).exists() )
+        {
+            static thread_local TargetShell shell;
+            cDebug() << "Running (persistent shell)" << RedactedList( args );
+            auto r = shell.run( destDir, args, timeoutSec );
+            cDebug() << Logger::SubEntry << "Finished. Exit code:" << r.getExitCode();
+            return r;
+        }
+        // Otherwise, fall through to report the trouble in the usual way
+    }
+
+    GroupProcess process;
+    process.setProcessChannelMode( QProcess::MergedChannels );
+    if ( int r = prepareProcess( location, args, workingPath, process ) )
+    {
+        return ProcessResult( r, QString() );
+    }
+
     process.start();
     if ( !process.waitForStarted() )
     {
@@ -183,13 +625,28 @@ System::runCommand( System::RunLocation location,
     }
     process.closeWriteChannel();
 
-    if ( !process.waitForFinished( timeoutSec > std::chrono::seconds::zero()
-                                       ? ( static_cast< int >( std::chrono::milliseconds( timeoutSec ).count() ) )
-                                       : -1 ) )
+    // Waits in short steps, so that a cancelled job stops right away
+    QElapsedTimer timer;
+    timer.start();
+    const qint64 timeoutMs = std::chrono::milliseconds( timeoutSec ).count();
+    const auto cancellation = CalamaresUtils::Executor::currentCancellation();
+    while ( process.state() != QProcess::NotRunning )
     {
-        cWarning() << "Process" << args.first() << "timed out after" << timeoutSec.count() << "s. Output so far:\n"
-                   << Logger::NoQuote << process.readAllStandardOutput();
-        return ProcessResult::Code::TimedOut;
+        if ( timeoutMs > 0 && timer.hasExpired( timeoutMs ) )
+        {
+            stopProcessGroup( process );
+            cWarning() << "Process" << args.first() << "timed out after" << timeoutSec.count()
+                       << "s. Output so far:\n"
+                       << Logger::NoQuote << process.readAllStandardOutput();
+            return ProcessResult::Code::TimedOut;
+        }
+        if ( cancellation.isCancelled() )
+        {
+            stopProcessGroup( process );
+            cWarning() << "Process" << args.first() << "cancelled.";
+            return ProcessResult::Code::Cancelled;
+        }
+        process.waitForFinished( 50 );
     }
 
     QString output = QString::fromLocal8Bit( process.readAllStandardOutput() ).trimmed();
@@ -228,6 +685,102 @@ System::runCommand( System::RunLocation location,
     return ProcessResult( r, output );
 }
 
+ProcessResult
+System::runCommandStreaming( System::RunLocation location,
+                             const QStringList& args,
+                             const OutputHandler& handler,
+                             const QString& workingPath,
+                             const QString& stdInput,
+                             std::chrono::seconds timeoutSec,
+                             int keepLines )
+{
+    GroupProcess process;
+    process.setProcessChannelMode( QProcess::SeparateChannels );
+    if ( int r = prepareProcess( location, args, workingPath, process ) )
+    {
+        return ProcessResult( r, QString() );
+    }
+
+    process.start();
+    if ( !process.waitForStarted() )
+    {
+        cWarning() << "Process" << args.first() << "failed to start" << process.error();
+        return ProcessResult::Code::FailedToStart;
+    }
+
+    if ( !stdInput.isEmpty() )
+    {
+        process.write( stdInput.toLocal8Bit() );
+    }
+    process.closeWriteChannel();
+
+    QStringList tail;
+    bool cancelled = false;
+    // Passes complete lines (or, with @p flush, everything) to the handler
+    auto drain = [ & ]( QProcess::ProcessChannel channel, bool flush ) {
+        process.setReadChannel( channel );
+        const auto outputChannel
+            = channel == QProcess::StandardOutput ? OutputChannel::StdOut : OutputChannel::StdErr;
+        while ( !cancelled && ( process.canReadLine() || ( flush && process.bytesAvailable() > 0 ) ) )
+        {
+            QString line = QString::fromLocal8Bit( process.readLine() );
+            if ( line.endsWith( '\n' ) )
+            {
+                line.chop( 1 );
+            }
+            tail.append( line );
+            if ( tail.count() > keepLines )
+            {
+                tail.removeFirst();
+            }
+            if ( handler && !handler( outputChannel, line ) )
+            {
+                cancelled = true;
+            }
+        }
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+    const qint64 timeoutMs = std::chrono::milliseconds( timeoutSec ).count();
+    const auto cancellation = CalamaresUtils::Executor::currentCancellation();
+    while ( process.state() != QProcess::NotRunning && !cancelled )
+    {
+        process.waitForReadyRead( 50 );
+        drain( QProcess::StandardOutput, false );
+        drain( QProcess::StandardError, false );
+        if ( cancellation.isCancelled() )
+        {
+            cancelled = true;
+        }
+        if ( timeoutMs > 0 && timer.hasExpired( timeoutMs ) )
+        {
+            stopProcessGroup( process );
+            cWarning() << "Process" << args.first() << "timed out after" << timeoutSec.count() << "s.";
+            return ProcessResult( static_cast< int >( ProcessResult::Code::TimedOut ), tail.join( '\n' ) );
+        }
+    }
+    if ( cancelled )
+    {
+        stopProcessGroup( process );
+        cDebug() << Logger::SubEntry << "Cancelled.";
+        return ProcessResult( static_cast< int >( ProcessResult::Code::Cancelled ), tail.join( '\n' ) );
+    }
+    drain( QProcess::StandardOutput, true );
+    drain( QProcess::StandardError, true );
+
+    const QString output = tail.join( '\n' ).trimmed();
+    if ( process.exitStatus() == QProcess::CrashExit )
+    {
+        cWarning() << "Process" << args.first() << "crashed. Output so far:\n" << Logger::NoQuote << output;
+        return ProcessResult::Code::Crashed;
+    }
+
+    auto r = process.exitCode();
+    cDebug() << Logger::SubEntry << "Finished. Exit code:" << r;
+    return ProcessResult( r, output );
+}
+
 /// @brief Cheap check if a path is absolute.
 static inline bool
 isAbsolutePath( const QString& path )
@@ -353,54 +906,15 @@ System::createTargetParentDirs( const QString& filePath ) const
 QPair< quint64, float >
 System::getTotalMemoryB() const
 {
-#ifdef Q_OS_LINUX
-    struct sysinfo i;
-    int r = sysinfo( &i );
-
-    if ( r )
-    {
-        return qMakePair( 0, 0.0 );
-    }
-
-    return qMakePair( quint64( i.mem_unit ) * quint64( i.totalram ), 1.1 );
-#elif defined( Q_OS_FREEBSD )
-    unsigned long memsize;
-    size_t s = sizeof( memsize );
-
-    int r = sysctlbyname( "vm.kmem_size", &memsize, &s, NULL, 0 );
-    if ( r )
-    {
-        return qMakePair( 0, 0.0 );
-    }
-
-    return qMakePair( memsize, 1.01 );
-#else
-    return qMakePair( 0, 0.0 );  // Unsupported
-#endif
+    const auto& info = HardwareInfo::instance();
+    return qMakePair( info.totalMemoryB(), info.totalMemoryFactor() );
 }
 
 
 QString
 System::getCpuDescription() const
 {
-    QString model;
-
-#ifdef Q_OS_LINUX
-    QFile file( "/proc/cpuinfo" );
-    if ( file.open( QIODevice::ReadOnly | QIODevice::Text ) )
-        while ( !file.atEnd() )
-        {
-            QByteArray line = file.readLine();
-            if ( line.startsWith( "model name" ) && ( line.indexOf( ':' ) > 0 ) )
-            {
-                model = QString::fromLatin1( line.right( line.length() - line.indexOf( ':' ) ) );
-                break;
-            }
-        }
-#elif defined( Q_OS_FREEBSD )
-    // This would use sysctl "hw.model", which has a string value
-#endif
-    return model.simplified();
+    return HardwareInfo::instance().cpuModel();
 }
 
 quint64
@@ -445,6 +959,12 @@ ProcessResult::explainProcess( int ec, const QString& command, const QString& ou
             QCoreApplication::translate( "ProcessResult", "Internal error when starting command." ),
             QCoreApplication::translate( "ProcessResult", "Bad parameters for process job call." ) );
 
+    if ( ec == static_cast< int >( ProcessResult::Code::Cancelled ) )
+        return JobResult::error(
+            QCoreApplication::translate( "ProcessResult", "External command was cancelled." ),
+            QCoreApplication::translate( "ProcessResult", "Command <i>%1</i> was cancelled." ).arg( command )
+                + outputMessage );
+
     if ( ec == static_cast< int >( ProcessResult::Code::TimedOut ) )
         return JobResult::error(
             QCoreApplication::translate( "ProcessResult", "External command failed to finish." ),
@@ -20,6 +20,7 @@
 #include <QString>
 
 #include <chrono>
+#include <functional>
 
 namespace CalamaresUtils
 {
@@ -31,7 +32,8 @@ public:
         Crashed = -1,  // Must match special return values from QProcess
         FailedToStart = -2,  // Must match special return values from QProcess
         NoWorkingDirectory = -3,
-        TimedOut = -4
+        TimedOut = -4,
+        Cancelled = -5
     };
 
     /** @brief Implicit one-argument constructor has no output, only a return code */
@@ -156,6 +158,10 @@ public:
      *             FailedToStart = QProcess cannot start
      *             NoWorkingDirectory = bad arguments
      *             TimedOut = QProcess timeout
+     *             Cancelled = the job was cancelled (see Job::isCancelled())
+     *
+     * The command runs in a process group of its own; on timeout or
+     * cancellation, the whole group is stopped.
      */
     static DLLEXPORT ProcessResult runCommand( RunLocation location,
                                                const QStringList& args,
@@ -163,6 +169,62 @@ public:
                                                const QString& stdInput = QString(),
                                                std::chrono::seconds timeoutSec = std::chrono::seconds( 0 ) );
 
+    /** @brief The argument list to run the command line @p command with
+     *
+     * A simple command -- words, possibly quoted with single quotes,
+     * or with double quotes around text without $, ` or \ -- is split
+     * into its words, so that the program runs without a shell in
+     * between. Anything else (pipes, redirections, variables, globs,
+     * shell builtins, ..) comes back as "/bin/sh -c @p command".
+     * Pass the result to runCommand().
+     */
+    static DLLEXPORT QStringList commandArguments( const QString& command );
+
+    /** @brief Stops the persistent shells in the target
+     *
+     * Commands in the target may run through a shell that is chrooted
+     * into the target and kept running (see Settings). That shell keeps
+     * the target busy, so call this before unmounting the target. It
+     * kills the shells of all the threads and waits for them to exit;
+     * the next command in the target starts a new shell.
+     */
+    static DLLEXPORT void stopTargetShells();
+
+    /** @brief Output channel of a process, for streaming output */
+    enum class OutputChannel
+    {
+        StdOut,
+        StdErr
+    };
+
+    /** @brief Handler for streaming output, see runCommandStreaming()
+     *
+     * Called once for each line of output (without the trailing newline)
+     * on the given channel. Return @c false to cancel the command.
+     */
+    using OutputHandler = std::function< bool( OutputChannel, const QString& ) >;
+
+    /** @brief Runs a command, passing output to @p handler line-by-line
+     *
+     * This is like runCommand(), but it does not collect all the output
+     * of the command: standard output and standard error are kept
+     * separate, and each line is passed to @p handler as soon as it is
+     * available. A handler can parse progress from the lines, and
+     * can cancel the command by returning @c false; the command is
+     * then killed and the result code is Cancelled. The same happens
+     * when the job is cancelled (see Job::isCancelled()).
+     *
+     * Only the last @p keepLines lines (of both channels) are kept for
+     * the output in the returned ProcessResult, for explaining errors.
+     */
+    static DLLEXPORT ProcessResult runCommandStreaming( RunLocation location,
+                                                        const QStringList& args,
+                                                        const OutputHandler& handler,
+                                                        const QString& workingPath = QString(),
+                                                        const QString& stdInput = QString(),
+                                                        std::chrono::seconds timeoutSec = std::chrono::seconds( 0 ),
+                                                        int keepLines = 50 );
+
     /** @brief Convenience wrapper for runCommand() in the host
      *
      * Runs the given command-line @p args in the **host** in the current direcory
@@ -316,6 +378,7 @@ public:
      * available is size * guesstimate.
      *
      * If nothing can be found, returns a 0 size and 0 guesstimate.
+     * The size is read once, see HardwareInfo.
      *
      * @return size, guesstimate-factor
      */
@@ -324,7 +387,8 @@ public:
     /**
      * @brief getCpuDescription returns a string describing the CPU.
      *
-     * Returns the value of the "model name" line in /proc/cpuinfo.
+     * Returns the value of the "model name" line in /proc/cpuinfo,
+     * from HardwareInfo.
      */
     DLLEXPORT QString getCpuDescription() const;
 
@@ -0,0 +1,78 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "Checksum.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+namespace CalamaresUtils
+{
+
+static void
+addPath( QCryptographicHash& hash, const QString& root, const QString& path )
+{
+    const QFileInfo fi( root + path );
+    // The name is separated from what follows by a NUL, which is not in names
+    hash.addData( QFile::encodeName( path ) );
+    if ( fi.isSymLink() )
+    {
+        hash.addData( QByteArray( "\0L", 2 ) );
+        hash.addData( QFile::encodeName( fi.symLinkTarget() ) );
+    }
+    else if ( fi.isDir() )
+    {
+        hash.addData( QByteArray( "\0D", 2 ) );
+        const auto entries = QDir( fi.filePath() )
+                                 .entryList( QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot,
+                                             QDir::Name );
+        for ( const auto& entry : entries )
+        {
+            addPath( hash, root, path + '/' + entry );
+        }
+    }
+    else if ( fi.isFile() )
+    {
+        hash.addData( QByteArray( "\0F", 2 ) );
+        hash.addData( QByteArray::number( fi.size() ) );
+        QFile f( fi.filePath() );
+        if ( !f.open( QIODevice::ReadOnly ) || !hash.addData( &f ) )
+        {
+            // Unreadable files never compare equal
+            hash.addData( QByteArray( "\0E", 2 ) );
+            hash.addData( QFile::encodeName( root ) );
+        }
+    }
+    else
+    {
+        hash.addData( QByteArray( "\0-", 2 ) );
+    }
+    hash.addData( QByteArray( "\0", 1 ) );
+}
+
+QByteArray
+filesChecksum( const QString& root, const QStringList& paths )
+{
+    QString prefix = root;
+    while ( prefix.endsWith( '/' ) )
+    {
+        prefix.chop( 1 );
+    }
+
+    QCryptographicHash hash( QCryptographicHash::Sha256 );
+    for ( const auto& path : paths )
+    {
+        addPath( hash, prefix, path.startsWith( '/' ) ? path : ( '/' + path ) );
+    }
+    return hash.result().toHex();
+}
+
+}  // namespace CalamaresUtils
@@ -0,0 +1,36 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef UTILS_CHECKSUM_H
+#define UTILS_CHECKSUM_H
+
+#include "DllMacro.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+namespace CalamaresUtils
+{
+/** @brief Checksum of the contents of files below @p root
+ *
+ * Each of the @p paths is relative to @p root (e.g. "/etc/fstab"
+ * with "/" or the root mount point of the target system). Files
+ * are read; directories are walked recursively, in sorted order.
+ * The names of the files (relative to @p root) are included, and
+ * so is the absence of a path, so the checksum for the same
+ * @p paths below two different roots is the same only if both
+ * have the same files with the same contents.
+ *
+ * Returns a hex-encoded SHA-256 checksum.
+ */
+DLLEXPORT QByteArray filesChecksum( const QString& root, const QStringList& paths );
+}  // namespace CalamaresUtils
+
+#endif
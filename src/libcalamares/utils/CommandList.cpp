@@ -19,8 +19,13 @@
 #include "utils/Variant.h"
 
 #include <QCoreApplication>
+#include <QRunnable>
+#include <QThreadPool>
 #include <QVariantList>
 
+#include <algorithm>
+#include <vector>
+
 namespace CalamaresUtils
 {
 
@@ -109,33 +114,231 @@ CommandList::CommandList::CommandList( const QVariant& v, bool doChroot, std::ch
 
 CommandList::~CommandList() {}
 
-static inline bool
-findInCommands( const CommandList& l, const QString& needle )
+static const QLatin1String rootMagic( "@@ROOT@@" );
+static const QLatin1String userMagic( "@@USER@@" );
+
+void
+CommandLine::compile()
 {
-    for ( CommandList::const_iterator i = l.cbegin(); i != l.cend(); ++i )
-        if ( i->command().contains( needle ) )
+    m_text.clear();
+    m_variables.clear();
+
+    const QString& s = first;
+    int start = 0;
+    for ( int at = s.indexOf( QStringLiteral( "@@" ) ); at >= 0; at = s.indexOf( QStringLiteral( "@@" ), at ) )
+    {
+        int length = 0;
+        if ( s.midRef( at, rootMagic.size() ) == rootMagic )
+        {
+            m_variables.append( Variable::Root );
+            length = rootMagic.size();
+        }
+        else if ( s.midRef( at, userMagic.size() ) == userMagic )
         {
-            return true;
+            m_variables.append( Variable::User );
+            length = userMagic.size();
         }
-    return false;
+        else
+        {
+            ++at;  // Not a variable, look again from one character further on
+            continue;
+        }
+        m_text.append( s.mid( start, at - start ) );
+        at += length;
+        start = at;
+    }
+    m_text.append( s.mid( start ) );
+}
+
+QString
+CommandLine::expand( const QString& root, const QString& user ) const
+{
+    if ( m_variables.isEmpty() )
+    {
+        return first;
+    }
+
+    int length = 0;
+    for ( const auto& t : m_text )
+    {
+        length += t.length();
+    }
+    for ( const auto v : m_variables )
+    {
+        length += v == Variable::Root ? root.length() : user.length();
+    }
+
+    QString s;
+    s.reserve( length );
+    s.append( m_text.first() );
+    for ( int i = 0; i < m_variables.count(); ++i )
+    {
+        s.append( m_variables.at( i ) == Variable::Root ? root : user );
+        s.append( m_text.at( i + 1 ) );
+    }
+    return s;
+}
+
+/** @brief A command after substitutions, ready to run */
+struct ProcessedCommand
+{
+    QString command;
+    std::chrono::seconds timeout;
+    bool suppressResult = false;
+};
+
+static ProcessResult
+runOne( System::RunLocation location, const ProcessedCommand& c )
+{
+    return System::runCommand( location, { "/bin/sh", "-c", c.command }, QString(), QString(), c.timeout );
+}
+
+/** @brief Turns the result @p r of running @p c into a JobResult
+ *
+ * Returns ok() if the command succeeded, or if the command failed
+ * but failures are suppressed.
+ */
+static Calamares::JobResult
+explainOne( const ProcessedCommand& c, const ProcessResult& r )
+{
+    if ( r.getExitCode() != 0 )
+    {
+        if ( c.suppressResult )
+        {
+            cDebug() << "Error code" << r.getExitCode() << "ignored by CommandList configuration.";
+        }
+        else
+        {
+            return r.explainProcess( c.command, c.timeout );
+        }
+    }
+    return Calamares::JobResult::ok();
+}
+
+static Calamares::JobResult
+runSequential( System::RunLocation location, const QList< ProcessedCommand >& commands )
+{
+    for ( const auto& c : commands )
+    {
+        auto result = explainOne( c, runOne( location, c ) );
+        if ( !result )
+        {
+            return result;
+        }
+    }
+    return Calamares::JobResult::ok();
+}
+
+/// @brief Runs one command from a list of commands, storing the result
+class CommandRunnable : public QRunnable
+{
+public:
+    CommandRunnable( System::RunLocation location, const ProcessedCommand& c, ProcessResult& result )
+        : m_location( location )
+        , m_command( c )
+        , m_result( result )
+    {
+    }
+
+    void run() override { m_result = runOne( m_location, m_command ); }
+
+private:
+    System::RunLocation m_location;
+    const ProcessedCommand& m_command;
+    ProcessResult& m_result;
+};
+
+static Calamares::JobResult
+runParallel( System::RunLocation location, const QList< ProcessedCommand >& commands, int workers )
+{
+    std::vector< ProcessResult > results( commands.count(), ProcessResult( 0, QString() ) );
+
+    QThreadPool pool;
+    if ( workers > 0 )
+    {
+        pool.setMaxThreadCount( workers );
+    }
+    cDebug() << "Running" << commands.count() << "commands with" << pool.maxThreadCount() << "workers.";
+    for ( int i = 0; i < commands.count(); ++i )
+    {
+        pool.start( new CommandRunnable( location, commands.at( i ), results[ std::size_t( i ) ] ) );
+    }
+    pool.waitForDone();
+
+    for ( int i = 0; i < commands.count(); ++i )
+    {
+        auto result = explainOne( commands.at( i ), results.at( std::size_t( i ) ) );
+        if ( !result )
+        {
+            return result;
+        }
+    }
+    return Calamares::JobResult::ok();
+}
+
+static Calamares::JobResult
+runBatch( System::RunLocation location, const QList< ProcessedCommand >& commands )
+{
+    // Each command that may not fail reports its index on failure,
+    // on a line of its own, so that the failing command can be explained.
+    static const QString failMarker = QStringLiteral( "@@CALAMARES-COMMAND-FAILED@@" );
+
+    QStringList script;
+    std::chrono::seconds timeout( 0 );
+    for ( int i = 0; i < commands.count(); ++i )
+    {
+        const auto& c = commands.at( i );
+        if ( c.suppressResult )
+        {
+            script.append( QStringLiteral( "( %1 ) || true" ).arg( c.command ) );
+        }
+        else
+        {
+            script.append( QStringLiteral( "( %1 ) || { r=$?; echo; echo %2 %3; exit $r; }" )
+                               .arg( c.command, failMarker, QString::number( i ) ) );
+        }
+        timeout += c.timeout;
+    }
+
+    ProcessedCommand batch { script.join( '\n' ), timeout, false };
+    ProcessResult r = runOne( location, batch );
+    if ( r.getExitCode() == 0 )
+    {
+        return Calamares::JobResult::ok();
+    }
+
+    // Find out which command failed, and explain that one
+    QString output = r.getOutput();
+    const int markerIndex = output.lastIndexOf( failMarker );
+    if ( markerIndex >= 0 )
+    {
+        bool ok = false;
+        const int commandIndex = output.mid( markerIndex + failMarker.length() ).trimmed().toInt( &ok );
+        output.truncate( markerIndex );
+        if ( ok && commandIndex >= 0 && commandIndex < commands.count() )
+        {
+            return explainOne( commands.at( commandIndex ),
+                               ProcessResult( r.getExitCode(), output.trimmed() ) );
+        }
+    }
+    return r.explainProcess( batch.command, timeout );
 }
 
 Calamares::JobResult
 CommandList::run()
 {
-    QLatin1String rootMagic( "@@ROOT@@" );
-    QLatin1String userMagic( "@@USER@@" );
-
     System::RunLocation location = m_doChroot ? System::RunLocation::RunInTarget : System::RunLocation::RunInHost;
 
     /* Figure out the replacement for @@ROOT@@ */
     QString root = QStringLiteral( "/" );
     Calamares::GlobalStorage* gs = Calamares::JobQueue::instance()->globalStorage();
+    const QVariantMap data = gs ? gs->data() : QVariantMap();
 
-    bool needsRootSubstitution = findInCommands( *this, rootMagic );
+    bool needsRootSubstitution
+        = std::any_of( cbegin(), cend(), []( const CommandLine& c ) { return c.needsRoot(); } );
     if ( needsRootSubstitution && ( location == System::RunLocation::RunInHost ) )
     {
-        if ( !gs || !gs->contains( "rootMountPoint" ) )
+        if ( !data.contains( "rootMountPoint" ) )
         {
             cError() << "No rootMountPoint defined.";
             return Calamares::JobResult::error(
@@ -144,11 +347,12 @@ CommandList::run()
                                              "The command runs in the host environment and needs to know the root "
                                              "path, but no rootMountPoint is defined." ) );
         }
-        root = gs->value( "rootMountPoint" ).toString();
+        root = data.value( "rootMountPoint" ).toString();
     }
 
-    bool needsUserSubstitution = findInCommands( *this, userMagic );
-    if ( needsUserSubstitution && ( !gs || !gs->contains( "username" ) ) )
+    bool needsUserSubstitution
+        = std::any_of( cbegin(), cend(), []( const CommandLine& c ) { return c.needsUser(); } );
+    if ( needsUserSubstitution && !data.contains( "username" ) )
     {
         cError() << "No username defined.";
         return Calamares::JobResult::error(
@@ -156,39 +360,65 @@ CommandList::run()
             QCoreApplication::translate( "CommandList",
                                          "The command needs to know the user's name, but no username is defined." ) );
     }
-    QString user = gs->value( "username" ).toString();  // may be blank if unset
+    QString user = data.value( "username" ).toString();  // may be blank if unset
 
+    QList< ProcessedCommand > commands;
     for ( CommandList::const_iterator i = cbegin(); i != cend(); ++i )
     {
-        QString processed_cmd = i->command();
-        processed_cmd.replace( rootMagic, root ).replace( userMagic, user );
-        bool suppress_result = false;
-        if ( processed_cmd.startsWith( '-' ) )
+        ProcessedCommand c;
+        c.command = i->expand( root, user );
+        if ( c.command.startsWith( '-' ) )
         {
-            suppress_result = true;
-            processed_cmd.remove( 0, 1 );  // Drop the -
+            c.suppressResult = true;
+            c.command.remove( 0, 1 );  // Drop the -
         }
+        c.timeout = i->timeout() >= std::chrono::seconds::zero() ? i->timeout() : m_timeout;
+        commands.append( c );
+    }
 
-        QStringList shell_cmd { "/bin/sh", "-c" };
-        shell_cmd << processed_cmd;
+    switch ( m_runMode )
+    {
+    case RunMode::Sequential:
+        return runSequential( location, commands );
+    case RunMode::Parallel:
+        return runParallel( location, commands, m_workers );
+    case RunMode::Batch:
+        return runBatch( location, commands );
+    }
+    __builtin_unreachable();
+}
 
-        std::chrono::seconds timeout = i->timeout() >= std::chrono::seconds::zero() ? i->timeout() : m_timeout;
-        ProcessResult r = System::runCommand( location, shell_cmd, QString(), QString(), timeout );
+QStringList
+CommandList::preview( const QVariantMap& data ) const
+{
+    const bool inHost = !m_doChroot;
+    const QString root = !inHost ? QStringLiteral( "/" )
+        : data.contains( "rootMountPoint" ) ? data.value( "rootMountPoint" ).toString()
+                                            : QString( rootMagic );
+    const QString user = data.contains( "username" ) ? data.value( "username" ).toString() : QString( userMagic );
 
-        if ( r.getExitCode() != 0 )
-        {
-            if ( suppress_result )
-            {
-                cDebug() << "Error code" << r.getExitCode() << "ignored by CommandList configuration.";
-            }
-            else
-            {
-                return r.explainProcess( processed_cmd, timeout );
-            }
-        }
+    QStringList commands;
+    for ( const auto& c : *this )
+    {
+        commands.append( c.expand( root, user ) );
     }
+    return commands;
+}
 
-    return Calamares::JobResult::ok();
+void
+CommandList::setRunMode( RunMode mode, int workers )
+{
+    m_runMode = mode;
+    m_workers = workers;
+}
+
+const NamedEnumTable< CommandList::RunMode >&
+CommandList::runModeNames()
+{
+    static const NamedEnumTable< RunMode > names { { QStringLiteral( "sequential" ), RunMode::Sequential },
+                                                   { QStringLiteral( "parallel" ), RunMode::Parallel },
+                                                   { QStringLiteral( "batch" ), RunMode::Batch } };
+    return names;
 }
 
 void
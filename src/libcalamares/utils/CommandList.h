@@ -12,9 +12,12 @@
 #define UTILS_COMMANDLIST_H
 
 #include "Job.h"
+#include "utils/NamedEnum.h"
 
 #include <QStringList>
 #include <QVariant>
+#include <QVariantMap>
+#include <QVector>
 
 #include <chrono>
 
@@ -38,11 +41,13 @@ struct CommandLine : public QPair< QString, std::chrono::seconds >
     CommandLine( const QString& s )
         : QPair( s, TimeoutNotSet() )
     {
+        compile();
     }
 
     CommandLine( const QString& s, std::chrono::seconds t )
         : QPair( s, t )
     {
+        compile();
     }
 
     QString command() const { return first; }
@@ -50,6 +55,32 @@ struct CommandLine : public QPair< QString, std::chrono::seconds >
     std::chrono::seconds timeout() const { return second; }
 
     bool isValid() const { return !first.isEmpty(); }
+
+    /// @brief Does the command use @@ROOT@@ ?
+    bool needsRoot() const { return m_variables.contains( Variable::Root ); }
+    /// @brief Does the command use @@USER@@ ?
+    bool needsUser() const { return m_variables.contains( Variable::User ); }
+
+    /** @brief The command, with @@ROOT@@ and @@USER@@ replaced
+     *
+     * The command is split into text and variables once, when
+     * the CommandLine is created, so this does not search the
+     * command again.
+     */
+    QString expand( const QString& root, const QString& user ) const;
+
+private:
+    enum class Variable : char
+    {
+        Root,
+        User
+    };
+
+    void compile();
+
+    /// The text around the variables: there is one more than there are variables
+    QStringList m_text;
+    QVector< Variable > m_variables;
 };
 
 /** @brief Abbreviation, used internally. */
@@ -73,8 +104,43 @@ public:
 
     bool doChroot() const { return m_doChroot; }
 
+    /** @brief How to run the commands in the list
+     *
+     * - *Sequential* runs each command in its own shell, one after the
+     *   other, stopping at the first failure. This is the default.
+     * - *Parallel* runs each command in its own shell, with a bounded
+     *   number of commands running at the same time. All the commands
+     *   are run, and the first failure (in list order) is reported.
+     * - *Batch* runs all the commands in a single shell, one after the
+     *   other, stopping at the first failure. The timeout for the
+     *   batch is the sum of the timeouts of the commands.
+     */
+    enum class RunMode
+    {
+        Sequential,
+        Parallel,
+        Batch
+    };
+    static const NamedEnumTable< RunMode >& runModeNames();
+
+    /** @brief Set the run mode, and the number of workers for Parallel
+     *
+     * A @p workers count less than 1 uses the number of CPUs.
+     */
+    void setRunMode( RunMode mode, int workers = 0 );
+    RunMode runMode() const { return m_runMode; }
+
     Calamares::JobResult run();
 
+    /** @brief The commands as they would run, with GlobalStorage @p data
+     *
+     * This substitutes @@ROOT@@ and @@USER@@ like run() does, with
+     * the values from @p data (e.g. GlobalStorage::data()). Variables
+     * that have no value are left as-is. This is for showing the
+     * commands to the user, or in the debug window.
+     */
+    QStringList preview( const QVariantMap& data ) const;
+
     using CommandList_t::at;
     using CommandList_t::cbegin;
     using CommandList_t::cend;
@@ -89,6 +155,8 @@ protected:
 private:
     bool m_doChroot;
     std::chrono::seconds m_timeout;
+    RunMode m_runMode = RunMode::Sequential;
+    int m_workers = 0;
 };
 
 }  // namespace CalamaresUtils
@@ -12,9 +12,95 @@
 #include "Entropy.h"
 
 #include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
 
+#include <algorithm>
+#include <cerrno>
 #include <random>
 
+#ifdef HAVE_GETRANDOM
+#include <sys/random.h>
+#endif
+
+/** @brief Reads up to @p size random bytes from the kernel into @p buffer
+ *
+ * Uses getrandom(2) if it is available, which needs no file
+ * descriptor, and /dev/urandom otherwise. Returns the number
+ * of bytes read.
+ */
+static qint64
+readKernelEntropy( char* buffer, int size )
+{
+    qint64 readSize = 0;
+#ifdef HAVE_GETRANDOM
+    while ( readSize < size )
+    {
+        ssize_t r = getrandom( buffer + readSize, size_t( size - readSize ), 0 );
+        if ( r < 0 )
+        {
+            if ( errno == EINTR )
+            {
+                continue;
+            }
+            break;
+        }
+        readSize += r;
+    }
+    if ( readSize >= size )
+    {
+        return readSize;
+    }
+#endif
+    QFile urandom( "/dev/urandom" );
+    if ( urandom.exists() && urandom.open( QIODevice::ReadOnly ) )
+    {
+        const qint64 r = urandom.read( buffer + readSize, size - readSize );
+        if ( r > 0 )
+        {
+            readSize += r;
+        }
+        urandom.close();
+    }
+    return readSize;
+}
+
+/// @brief Size of the pool of kernel entropy for small requests
+static constexpr int entropyPoolSize = 256;
+/// @brief Requests up to this size are served from the pool
+static constexpr int maxPooledSize = 64;
+
+/** @brief Copies @p size random bytes from a pool into @p buffer
+ *
+ * Salts and machine-ids need only a handful of bytes, so those come
+ * from a pool that is refilled from the kernel when it runs low.
+ * Bytes are handed out once, and wiped from the pool. Returns the
+ * number of bytes copied, which is 0 if the pool could not be refilled.
+ */
+static qint64
+readPooledEntropy( char* buffer, int size )
+{
+    static QMutex mutex;
+    static char pool[ entropyPoolSize ];
+    static int available = 0;
+
+    QMutexLocker lock( &mutex );
+    if ( available < size )
+    {
+        // A partial refill is not mixed with what is left: start over
+        available = readKernelEntropy( pool, entropyPoolSize ) >= entropyPoolSize ? entropyPoolSize : 0;
+        if ( available < size )
+        {
+            return 0;
+        }
+    }
+    available -= size;
+    char* const bytes = pool + available;
+    std::copy( bytes, bytes + size, buffer );
+    std::fill( bytes, bytes + size, 0 );
+    return size;
+}
+
 CalamaresUtils::EntropySource
 CalamaresUtils::getEntropy( int size, QByteArray& b )
 {
@@ -28,14 +114,11 @@ CalamaresUtils::getEntropy( int size, QByteArray& b )
     char* buffer = b.data();
     std::fill( buffer, buffer + size, 0xcb );
 
-    qint64 readSize = 0;
-    QFile urandom( "/dev/urandom" );
-    if ( urandom.exists() && urandom.open( QIODevice::ReadOnly ) )
+    qint64 readSize = size <= maxPooledSize ? readPooledEntropy( buffer, size ) : 0;
+    if ( readSize < size )
     {
-        readSize = urandom.read( buffer, size );
-        urandom.close();
+        readSize = readKernelEntropy( buffer, size );
     }
-
     if ( readSize >= size )
     {
         return EntropySource::URandom;
@@ -86,31 +169,21 @@ CalamaresUtils::getPrintableEntropy( int size, QString& s )
                                        'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z' };
     static_assert( sizeof( salt_chars ) == 64, "Missing salt_chars" );
 
-    // Number of bytes we're going to need
-    int byteSize = ( ( size * 6 ) / 8 ) + 1;
+    // Each 3 random bytes give 4 characters
     QByteArray b;
-    EntropySource r = getEntropy( byteSize, b );
+    EntropySource r = getEntropy( ( ( size + 3 ) / 4 ) * 3, b );
+    const auto* bytes = reinterpret_cast< const unsigned char* >( b.constData() );
 
-    int bitsLeft = 0;
-    int byteOffset = 0;
-    qint64 next = 0;
-    do
+    s.resize( size );
+    QChar* chars = s.data();
+    for ( int i = 0; i < size; i += 4, bytes += 3 )
     {
-        if ( bitsLeft < 6 )
+        const quint32 group = ( quint32( bytes[ 0 ] ) << 16 ) | ( quint32( bytes[ 1 ] ) << 8 ) | bytes[ 2 ];
+        const int count = std::min( 4, size - i );
+        for ( int j = 0; j < count; ++j )
         {
-            next = ( next << 8 ) | b.at( byteOffset++ );
-            bitsLeft += 8;
+            chars[ i + j ] = QLatin1Char( salt_chars[ ( group >> ( 18 - 6 * j ) ) & 0x3fU ] );
         }
-        char c = salt_chars[ next & 0b0111111 ];
-        next >>= 6;
-        bitsLeft -= 6;
-        s.append( c );
-    } while ( ( s.length() < size ) && ( byteOffset < b.size() ) );
-
-    if ( s.length() < size )
-    {
-        // It's incomplete, not really no-entropy
-        return EntropySource::None;
     }
 
     return r;
@@ -22,7 +22,7 @@ namespace CalamaresUtils
 enum class EntropySource
 {
     None,  ///< Buffer is empty, no random data
-    URandom,  ///< Read from /dev/urandom
+    URandom,  ///< Read from the kernel (getrandom(2) or /dev/urandom)
     Twister  ///< Generated by pseudo-random
 };
 
@@ -31,6 +31,10 @@ enum class EntropySource
  * The array is cleared and resized, then filled with 0xcb
  * "just in case", after which it is filled with random
  * bytes from a suitable source. Returns which source was used.
+ *
+ * Small requests (like salts and machine-ids) are served from a
+ * pool of kernel entropy, so they do not each need a system call.
+ * This is thread-safe.
  */
 DLLEXPORT EntropySource getEntropy( int size, QByteArray& b );
 
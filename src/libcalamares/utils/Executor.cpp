@@ -0,0 +1,105 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "Executor.h"
+
+#include "utils/Logger.h"
+
+#include <QThread>
+
+#include <algorithm>
+
+namespace CalamaresUtils
+{
+namespace Executor
+{
+
+Cancellation::Cancellation()
+    : m_cancelled( std::make_shared< std::atomic< bool > >( false ) )
+{
+}
+
+static thread_local const Cancellation* s_current = nullptr;
+
+Cancellation
+currentCancellation()
+{
+    return s_current ? *s_current : Cancellation();
+}
+
+CancellationScope::CancellationScope( const Cancellation& cancellation )
+    : m_cancellation( cancellation )
+    , m_previous( s_current )
+{
+    s_current = &m_cancellation;
+}
+
+CancellationScope::~CancellationScope()
+{
+    s_current = m_previous;
+}
+
+static const char*
+laneName( Lane lane )
+{
+    switch ( lane )
+    {
+    case Lane::Interactive:
+        return "interactive";
+    case Lane::Background:
+        return "background";
+    case Lane::BulkIO:
+        return "bulk-io";
+    }
+    return "unknown";
+}
+
+/** @brief A thread pool for each lane
+ *
+ * Interactive work gets a thread for each processor; it is short,
+ * and should never wait. Background work gets half of those, and
+ * bulk I/O two, since more of that at once only makes the disk seek.
+ * Each lane has at least two threads, so that a task there can wait
+ * for one task in a lower lane that is running already.
+ */
+struct Pools
+{
+    Pools()
+    {
+        const int ideal = std::max( QThread::idealThreadCount(), 1 );
+        pools[ int( Lane::Interactive ) ].setMaxThreadCount( std::max( ideal, 2 ) );
+        pools[ int( Lane::Background ) ].setMaxThreadCount( std::max( ideal / 2, 2 ) );
+        pools[ int( Lane::BulkIO ) ].setMaxThreadCount( 2 );
+    }
+
+    QThreadPool pools[ 3 ];
+};
+
+QThreadPool*
+pool( Lane lane )
+{
+    static Pools p;
+    return &p.pools[ int( lane ) ];
+}
+
+namespace Private
+{
+void
+started( const char* name, Lane lane, qint64 queuedMs )
+{
+    // Anything that waited this long means that the lane is too busy
+    if ( queuedMs > 1000 )
+    {
+        cDebug() << "Task" << name << "waited" << queuedMs << "ms in lane" << laneName( lane );
+    }
+}
+}  // namespace Private
+
+}  // namespace Executor
+}  // namespace CalamaresUtils
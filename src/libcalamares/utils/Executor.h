@@ -0,0 +1,152 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+/** @file Running work in the background, by priority
+ *
+ * Background work in Calamares is of three kinds: results that the user
+ * is waiting for (the GeoIP lookup that picks a timezone, requirements
+ * on the welcome page, the partitioning page reverting a device), work
+ * the user is not waiting for yet, and long disk-heavy work like
+ * os-prober. Each kind has its own lane (a thread pool of its own),
+ * so a slow os-prober never holds up a result that the user sees.
+ *
+ * Use run() instead of a bare QtConcurrent::run(). Tasks are traced
+ * (see Trace.h) under their name, and logged if they waited long
+ * for a thread. A task in one lane may wait for tasks in a lane that
+ * is "lower" (Interactive before Background before BulkIO), but not
+ * the other way around, or tasks in the same lane: that can deadlock
+ * once the lane's threads are all waiting.
+ */
+
+#ifndef UTILS_EXECUTOR_H
+#define UTILS_EXECUTOR_H
+
+#include "DllMacro.h"
+#include "utils/Trace.h"
+
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <atomic>
+#include <memory>
+
+namespace CalamaresUtils
+{
+namespace Executor
+{
+enum class Lane
+{
+    Interactive,  ///< The user is waiting for the result
+    Background,  ///< The user will want the result later
+    BulkIO  ///< Long and disk-heavy, only two at a time
+};
+
+/** @brief A flag to tell tasks that their result is no longer wanted
+ *
+ * Copies share the flag, so a task keeps a copy and checks it
+ * (e.g. between steps) while the code that started it may cancel().
+ * Tasks that are cancelled before they start do not run at all.
+ */
+class DLLEXPORT Cancellation
+{
+public:
+    Cancellation();
+
+    void cancel() { m_cancelled->store( true ); }
+    bool isCancelled() const { return m_cancelled->load(); }
+
+private:
+    std::shared_ptr< std::atomic< bool > > m_cancelled;
+};
+
+/** @brief The cancellation of the work that this thread is doing
+ *
+ * This is the cancellation of the innermost CancellationScope in
+ * this thread: for instance, the JobQueue sets one for each job,
+ * so that System::runCommand() can stop the commands of a job.
+ * Without a scope, this is a cancellation that is never cancelled.
+ */
+DLLEXPORT Cancellation currentCancellation();
+
+/** @brief Sets the currentCancellation() of this thread
+ *
+ * For the lifetime of this object, currentCancellation() in this
+ * thread returns @p cancellation; then the previous one is restored.
+ */
+class DLLEXPORT CancellationScope
+{
+public:
+    explicit CancellationScope( const Cancellation& cancellation );
+    ~CancellationScope();
+
+    CancellationScope( const CancellationScope& ) = delete;
+    CancellationScope& operator=( const CancellationScope& ) = delete;
+
+private:
+    Cancellation m_cancellation;
+    const Cancellation* m_previous;
+};
+
+/// @brief The thread pool of @p lane
+DLLEXPORT QThreadPool* pool( Lane lane );
+
+namespace Private
+{
+/// @brief Logs a task that waited long for a thread in @p lane
+DLLEXPORT void started( const char* name, Lane lane, qint64 queuedMs );
+}  // namespace Private
+
+/** @brief Runs @p f in the thread pool of @p lane
+ *
+ * The @p name is for tracing and logging; it must be a string literal
+ * (or otherwise outlive the task). Returns the future of the result of @p f.
+ */
+template < typename F >
+auto
+run( Lane lane, const char* name, F f ) -> QFuture< decltype( f() ) >
+{
+    QElapsedTimer queued;
+    queued.start();
+    return QtConcurrent::run( pool( lane ), [ lane, name, queued, f ]() {
+        Private::started( name, lane, queued.elapsed() );
+        Trace::Span span( name, "task" );
+        return f();
+    } );
+}
+
+/** @brief Runs @p f( cancellation ) in the thread pool of @p lane
+ *
+ * If the @p cancellation is cancelled before the task starts, @p f is
+ * not called and the result is default-constructed; otherwise @p f
+ * should check it when it can stop early.
+ */
+template < typename F >
+auto
+run( Lane lane, const char* name, const Cancellation& cancellation, F f ) -> QFuture< decltype( f( cancellation ) ) >
+{
+    using R = decltype( f( cancellation ) );
+    QElapsedTimer queued;
+    queued.start();
+    return QtConcurrent::run( pool( lane ), [ lane, name, queued, cancellation, f ]() -> R {
+        if ( cancellation.isCancelled() )
+        {
+            return R();
+        }
+        Private::started( name, lane, queued.elapsed() );
+        Trace::Span span( name, "task" );
+        return f( cancellation );
+    } );
+}
+
+}  // namespace Executor
+}  // namespace CalamaresUtils
+
+#endif
@@ -0,0 +1,162 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "FileCopy.h"
+
+#include "Logger.h"
+#include "Permissions.h"
+#include "Units.h"
+
+#include <QFile>
+
+#include <cerrno>
+
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef HAVE_SENDFILE
+#include <sys/sendfile.h>
+#endif
+
+using namespace CalamaresUtils::Units;
+
+namespace CalamaresUtils
+{
+
+/// @brief How a copy step went
+enum class CopyResult
+{
+    Done,  ///< Everything was copied
+    Failed,  ///< Something went wrong (and the copy is incomplete)
+    Unsupported  ///< This way of copying does not work for these files; nothing was copied
+};
+
+/* The kernel-side copies return 0 at the very start for files that
+ * have no size, but do have contents (in /proc and /sys, for instance).
+ * Nothing was copied, so it is safe to try the next way; for a file
+ * that is really empty, that copies nothing again.
+ */
+
+/// @brief Copies with copy_file_range(2), which may not even move the data
+static CopyResult
+copyRange( int in, int out )
+{
+#ifdef HAVE_COPY_FILE_RANGE
+    bool copiedAny = false;
+    while ( true )
+    {
+        const ssize_t r = copy_file_range( in, nullptr, out, nullptr, 1_GiB, 0 );
+        if ( r > 0 )
+        {
+            copiedAny = true;
+        }
+        else if ( r == 0 )
+        {
+            return copiedAny ? CopyResult::Done : CopyResult::Unsupported;
+        }
+        else if ( errno != EINTR )
+        {
+            // Cross-filesystem copies on older kernels, and some filesystems, say no
+            const bool unsupported = errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP;
+            return ( unsupported && !copiedAny ) ? CopyResult::Unsupported : CopyResult::Failed;
+        }
+    }
+#else
+    Q_UNUSED( in )
+    Q_UNUSED( out )
+    return CopyResult::Unsupported;
+#endif
+}
+
+/// @brief Copies with sendfile(2), which does not need user-space buffers
+static CopyResult
+copySendFile( int in, int out )
+{
+#ifdef HAVE_SENDFILE
+    bool copiedAny = false;
+    while ( true )
+    {
+        const ssize_t r = sendfile( out, in, nullptr, 1_GiB );
+        if ( r > 0 )
+        {
+            copiedAny = true;
+        }
+        else if ( r == 0 )
+        {
+            return copiedAny ? CopyResult::Done : CopyResult::Unsupported;
+        }
+        else if ( errno != EINTR )
+        {
+            const bool unsupported = errno == EINVAL || errno == ENOSYS;
+            return ( unsupported && !copiedAny ) ? CopyResult::Unsupported : CopyResult::Failed;
+        }
+    }
+#else
+    Q_UNUSED( in )
+    Q_UNUSED( out )
+    return CopyResult::Unsupported;
+#endif
+}
+
+static CopyResult
+copyBuffered( QFile& in, QFile& out )
+{
+    QByteArray b;
+    do
+    {
+        b = in.read( 1_MiB );
+        if ( out.write( b ) != b.count() )
+        {
+            return CopyResult::Failed;
+        }
+    } while ( b.count() > 0 );
+    return out.flush() ? CopyResult::Done : CopyResult::Failed;
+}
+
+bool
+copyFile( const QString& source, const QString& destination, CopyPermissions permissions )
+{
+    QFile in( source );
+    if ( !in.open( QIODevice::ReadOnly ) )
+    {
+        cWarning() << "Could not read" << source;
+        return false;
+    }
+
+    QFile out( destination );
+    if ( !out.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        cWarning() << "Could not open" << destination << "for writing; could not copy" << source;
+        return false;
+    }
+
+    CopyResult r = copyRange( in.handle(), out.handle() );
+    if ( r == CopyResult::Unsupported )
+    {
+        r = copySendFile( in.handle(), out.handle() );
+    }
+    if ( r == CopyResult::Unsupported )
+    {
+        r = copyBuffered( in, out );
+    }
+    if ( r != CopyResult::Done )
+    {
+        cWarning() << "Could not copy" << source << "to" << destination;
+        return false;
+    }
+
+    struct stat st;
+    if ( permissions == CopyPermissions::FromSource && fstat( in.handle(), &st ) == 0
+         && !Permissions::apply( destination, int( st.st_mode & 07777 ) ) )
+    {
+        cWarning() << "Could not set mode of" << destination;
+    }
+    return true;
+}
+
+}  // namespace CalamaresUtils
@@ -0,0 +1,46 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef UTILS_FILECOPY_H
+#define UTILS_FILECOPY_H
+
+#include "DllMacro.h"
+
+#include <QString>
+
+namespace CalamaresUtils
+{
+/// @brief What file-access mode a copy gets
+enum class CopyPermissions
+{
+    FromSource,  ///< The mode of the source (see Permissions::apply())
+    Default  ///< The mode of a new file (from the umask), or the mode the destination already had
+};
+
+/** @brief Copies the file @p source to @p destination
+ *
+ * Both paths are in the **host** system. The data is copied by the
+ * kernel where it can (copy_file_range(2), then sendfile(2)), so it
+ * does not pass through a buffer in Calamares; otherwise it is read
+ * and written in chunks. This also happens when the kernel copies
+ * nothing at all, as it does for some files in /proc and /sys that
+ * claim to be empty. An existing @p destination is overwritten.
+ * The file-access mode of @p destination is set by @p permissions.
+ *
+ * A file that grows while it is copied (e.g. the log file) is
+ * copied up to wherever its end is when the copy gets there.
+ *
+ * @return @c true on success
+ */
+DLLEXPORT bool copyFile( const QString& source,
+                         const QString& destination,
+                         CopyPermissions permissions = CopyPermissions::FromSource );
+}  // namespace CalamaresUtils
+
+#endif
@@ -0,0 +1,219 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2014 Teo Mrnjavac <teo@kde.org>
+ *   SPDX-FileCopyrightText: 2017-2020 Adriaan de Groot <groot@kde.org>
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "HardwareInfo.h"
+
+#include "GlobalStorage.h"
+#include "utils/Executor.h"
+#include "utils/Logger.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+
+#ifdef Q_OS_LINUX
+#include <sys/sysinfo.h>
+#endif
+
+#ifdef Q_OS_FREEBSD
+// clang-format off
+// these includes need to stay in-order (that's a FreeBSD thing)
+#include <sys/types.h>
+#include <sys/sysctl.h>
+// clang-format on
+#endif
+
+namespace CalamaresUtils
+{
+
+/// @brief The value after the ':' in a /proc/cpuinfo @p line
+static QString
+cpuinfoValue( const QByteArray& line )
+{
+    return QString::fromLatin1( line.mid( line.indexOf( ':' ) + 1 ) ).simplified();
+}
+
+static bool
+hasBatteryPowerSupply()
+{
+    QDir baseDir( QStringLiteral( "/sys/class/power_supply" ) );
+    if ( !baseDir.exists() )
+    {
+        return false;
+    }
+
+    const auto entries = baseDir.entryList( QDir::AllDirs | QDir::Readable | QDir::NoDotAndDotDot );
+    for ( const auto& item : entries )
+    {
+        QFile typeFile( baseDir.absoluteFilePath( QString( "%1/type" ).arg( item ) ) );
+        if ( typeFile.open( QIODevice::ReadOnly | QIODevice::Text ) && typeFile.readAll().startsWith( "Battery" ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief The first line of file @p name in @p dir, trimmed; empty if it can't be read
+static QByteArray
+sysfsValue( const QDir& dir, const QString& name )
+{
+    QFile f( dir.filePath( name ) );
+    return f.open( QIODevice::ReadOnly ) ? f.readLine().trimmed() : QByteArray();
+}
+
+HardwareInfo::DiskList
+HardwareInfo::readDisks( const QString& root )
+{
+    DiskList disks;
+    QDir blockDir( QDir( root ).filePath( QStringLiteral( "sys/block" ) ) );
+    const auto names = blockDir.entryList( QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name );
+    for ( const QString& name : names )
+    {
+        if ( name.startsWith( QStringLiteral( "loop" ) ) || !blockDir.exists( name + QStringLiteral( "/device" ) ) )
+        {
+            continue;
+        }
+        const QDir dir( blockDir.filePath( name ) );
+        Disk d;
+        d.node = QStringLiteral( "/dev/" ) + name;
+        d.sizeB = sysfsValue( dir, QStringLiteral( "size" ) ).toLongLong() * 512;  // Always 512-byte sectors
+        d.removable = sysfsValue( dir, QStringLiteral( "removable" ) ) == "1";
+        d.readOnly = sysfsValue( dir, QStringLiteral( "ro" ) ) == "1";
+        d.rotational = sysfsValue( dir, QStringLiteral( "queue/rotational" ) ) == "1";
+        d.mediaDrive = name.startsWith( QStringLiteral( "sr" ) ) || name.startsWith( QStringLiteral( "fd" ) );
+        disks.append( d );
+    }
+    return disks;
+}
+
+HardwareInfo::HardwareInfo()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+#ifdef Q_OS_LINUX
+    // Only the first CPU is interesting, so stop at the first empty line
+    QFile cpuinfo( QStringLiteral( "/proc/cpuinfo" ) );
+    if ( cpuinfo.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        while ( !cpuinfo.atEnd() )
+        {
+            const QByteArray line = cpuinfo.readLine();
+            if ( line.trimmed().isEmpty() && !( m_cpuVendor.isEmpty() && m_cpuImplementer.isEmpty() ) )
+            {
+                break;
+            }
+            if ( line.indexOf( ':' ) <= 0 )
+            {
+                continue;
+            }
+            if ( m_cpuModel.isEmpty() && line.startsWith( "model name" ) )
+            {
+                m_cpuModel = cpuinfoValue( line );
+            }
+            else if ( m_cpuVendor.isEmpty() && line.startsWith( "vendor_id" ) )
+            {
+                m_cpuVendor = cpuinfoValue( line );
+            }
+            else if ( m_cpuImplementer.isEmpty() && line.startsWith( "CPU implementer" ) )
+            {
+                m_cpuImplementer = cpuinfoValue( line );
+            }
+        }
+    }
+
+    struct sysinfo i;
+    if ( sysinfo( &i ) == 0 )
+    {
+        m_totalMemoryB = quint64( i.mem_unit ) * quint64( i.totalram );
+        m_totalMemoryFactor = 1.1f;
+    }
+
+    QFile dmiFile( QStringLiteral( "/sys/devices/virtual/dmi/id/product_name" ) );
+    if ( dmiFile.open( QIODevice::ReadOnly ) )
+    {
+        m_productName = QString::fromLocal8Bit( dmiFile.readAll().simplified() );
+    }
+
+    m_hasBattery = hasBatteryPowerSupply();
+    m_isEfi = QDir( QStringLiteral( "/sys/firmware/efi/efivars" ) ).exists();
+    m_disks = readDisks();
+#elif defined( Q_OS_FREEBSD )
+    constexpr const size_t sysctl_buffer_size = 128;
+    char sysctl_buffer[ sysctl_buffer_size ] = {};
+    size_t s = sysctl_buffer_size - 1;
+    if ( sysctlbyname( "hw.model", &sysctl_buffer, &s, NULL, 0 ) == 0 )
+    {
+        m_cpuModel = QString::fromLatin1( sysctl_buffer ).simplified();
+        m_cpuVendor = m_cpuModel;
+    }
+
+    unsigned long memsize;
+    s = sizeof( memsize );
+    if ( sysctlbyname( "vm.kmem_size", &memsize, &s, NULL, 0 ) == 0 )
+    {
+        m_totalMemoryB = memsize;
+        m_totalMemoryFactor = 1.01f;
+    }
+#endif
+
+    cDebug() << "Hardware information read in" << timer.elapsed() << "ms";
+}
+
+const HardwareInfo&
+HardwareInfo::instance()
+{
+    static const HardwareInfo info;
+    return info;
+}
+
+void
+HardwareInfo::prefetch( Calamares::GlobalStorage* gs )
+{
+    Executor::run( Executor::Lane::Background, "hardware-info", [ gs ]() {
+        const auto& info = instance();
+        if ( gs )
+        {
+            gs->insert( globalStorageKey(), info.toMap() );
+        }
+    } );
+}
+
+QString
+HardwareInfo::globalStorageKey()
+{
+    return QStringLiteral( "hardware" );
+}
+
+QVariantMap
+HardwareInfo::toMap() const
+{
+    QVariantList disks;
+    for ( const auto& d : m_disks )
+    {
+        disks.append( QVariantMap { { QStringLiteral( "node" ), d.node },
+                                    { QStringLiteral( "sizeB" ), d.sizeB },
+                                    { QStringLiteral( "removable" ), d.removable },
+                                    { QStringLiteral( "readOnly" ), d.readOnly },
+                                    { QStringLiteral( "rotational" ), d.rotational } } );
+    }
+    return QVariantMap { { QStringLiteral( "cpuModel" ), m_cpuModel },
+                         { QStringLiteral( "cpuVendor" ), m_cpuVendor },
+                         { QStringLiteral( "cpuImplementer" ), m_cpuImplementer },
+                         { QStringLiteral( "memoryB" ), m_totalMemoryB },
+                         { QStringLiteral( "productName" ), m_productName },
+                         { QStringLiteral( "hasBattery" ), m_hasBattery },
+                         { QStringLiteral( "isEfi" ), m_isEfi },
+                         { QStringLiteral( "disks" ), disks } };
+}
+
+}  // namespace CalamaresUtils
@@ -0,0 +1,132 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef UTILS_HARDWAREINFO_H
+#define UTILS_HARDWAREINFO_H
+
+#include "DllMacro.h"
+
+#include <QList>
+#include <QString>
+#include <QVariantMap>
+
+namespace Calamares
+{
+class GlobalStorage;
+}
+
+namespace CalamaresUtils
+{
+/** @brief Facts about the hardware Calamares is running on
+ *
+ * These are read once, the first time instance() is called, and do
+ * not change afterwards. Calamares starts reading them in a background
+ * thread at startup (see prefetch()), so by the time a module asks,
+ * the answer is usually already there.
+ *
+ * The same facts are in GlobalStorage, as a map under the key
+ * globalStorageKey(), for Python modules and contextualprocess.
+ */
+class DLLEXPORT HardwareInfo
+{
+public:
+    /// @brief A disk, as the kernel describes it in /sys/block
+    struct Disk
+    {
+        QString node;  ///< Device node, e.g. /dev/sda
+        qint64 sizeB = 0;
+        bool removable = false;
+        bool readOnly = false;
+        bool rotational = false;
+        bool mediaDrive = false;  ///< A CD / DVD (sr) or floppy (fd) drive
+    };
+    using DiskList = QList< Disk >;
+
+    /** @brief The hardware information
+     *
+     * The first call reads everything (so that call can be slow);
+     * concurrent calls wait for it. This is thread-safe.
+     */
+    static const HardwareInfo& instance();
+
+    /** @brief Read the hardware information in a background thread
+     *
+     * When it is done, toMap() is stored in @p gs (if not @c nullptr).
+     */
+    static void prefetch( Calamares::GlobalStorage* gs );
+
+    /// @brief The key in GlobalStorage, "hardware"
+    static QString globalStorageKey();
+
+    /// @brief The "model name" from /proc/cpuinfo (or hw.model on FreeBSD)
+    QString cpuModel() const { return m_cpuModel; }
+    /** @brief The CPU vendor_id (e.g. "GenuineIntel")
+     *
+     * On ARM, where there is no vendor_id, this is empty and
+     * cpuImplementer() is set instead.
+     */
+    QString cpuVendor() const { return m_cpuVendor; }
+    /// @brief The "CPU implementer" (e.g. "0x41") for ARM CPUs
+    QString cpuImplementer() const { return m_cpuImplementer; }
+    /** @brief The total main memory, in bytes, and a guesstimate factor
+     *
+     * @see CalamaresUtils::System::getTotalMemoryB()
+     */
+    quint64 totalMemoryB() const { return m_totalMemoryB; }
+    float totalMemoryFactor() const { return m_totalMemoryFactor; }
+    /// @brief The DMI product name, simplified; empty if there is none
+    QString productName() const { return m_productName; }
+    /// @brief Is there a battery in /sys/class/power_supply?
+    bool hasBattery() const { return m_hasBattery; }
+    /// @brief Was this system booted with EFI (is there /sys/firmware/efi/efivars)?
+    bool isEfi() const { return m_isEfi; }
+    /** @brief The disks, as they were when the information was read
+     *
+     * This is for quick checks ("is there a disk that is big enough?");
+     * disks that are plugged in later are not in the list. Use
+     * readDisks() for the disks as they are now.
+     */
+    DiskList disks() const { return m_disks; }
+
+    /** @brief Reads the disks from sysfs, below @p root (for tests)
+     *
+     * Only the files in /sys/block are read; the disks themselves
+     * are not opened, so this is quick even with an unresponsive
+     * card reader. Block devices without hardware behind them --
+     * loop, zram, device-mapper -- are left out. Returns an empty
+     * list when there is no sysfs.
+     */
+    static DiskList readDisks( const QString& root = QStringLiteral( "/" ) );
+
+    /** @brief The facts as a map
+     *
+     * Keys are *cpuModel*, *cpuVendor*, *cpuImplementer*, *memoryB*,
+     * *productName*, *hasBattery*, *isEfi* and *disks*. The disks are
+     * a list of maps, with keys *node*, *sizeB*, *removable*, *readOnly*
+     * and *rotational*.
+     */
+    QVariantMap toMap() const;
+
+private:
+    HardwareInfo();
+
+    QString m_cpuModel;
+    QString m_cpuVendor;
+    QString m_cpuImplementer;
+    quint64 m_totalMemoryB = 0;
+    float m_totalMemoryFactor = 0.0;
+    QString m_productName;
+    bool m_hasBattery = false;
+    bool m_isEfi = false;
+    DiskList m_disks;
+};
+
+}  // namespace CalamaresUtils
+
+#endif
@@ -20,22 +20,37 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QMutex>
-#include <QTime>
 #include <QVariant>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <sys/syscall.h>
+#include <unistd.h>
 
 static constexpr const int LOGFILE_SIZE = 1024 * 256;
 
 static std::ofstream logfile;
+static std::ofstream jsonfile;  ///< Structured log, if enabled
+static std::atomic< bool > s_structured { false };
 static unsigned int s_threshold =
 #ifdef QT_NO_DEBUG
     Logger::LOG_DISABLE;
 #else
     Logger::LOGDEBUG;  // Comparison is < in log() function
 #endif
-static QMutex s_mutex;
+static QMutex s_mutex;  // Protects the logfile and std::cout
 
 static const char s_Continuation[] = "\n    ";
 static const char s_SubEntry[] = "    .. ";
@@ -44,6 +59,25 @@ static const char s_SubEntry[] = "    .. ";
 namespace Logger
 {
 
+/** @brief Context for log messages from the current thread
+ *
+ * This is only used for the structured log.
+ */
+struct ThreadContext
+{
+    std::string instance;
+    int jobIndex = -1;
+};
+
+static thread_local ThreadContext s_context;
+
+long
+threadId()
+{
+    static thread_local long tid = syscall( SYS_gettid );
+    return tid;
+}
+
 void
 setupLogLevel( unsigned int level )
 {
@@ -66,31 +100,483 @@ logLevel()
     return s_threshold > 0 ? s_threshold - 1 : 0;
 }
 
+/** @brief Formats timestamps, re-using the result within one second
+ *
+ * This does not use QDate or QTime, because those crash when
+ * logging at exit as Qt tries to use QLocale to format, but
+ * QLocale is on its way out.
+ */
+class Timestamp
+{
+public:
+    void format( std::time_t when )
+    {
+        if ( when != m_when )
+        {
+            std::tm t;
+            localtime_r( &when, &t );
+            std::strftime( m_date, sizeof( m_date ), "%Y-%m-%d", &t );
+            std::strftime( m_time, sizeof( m_time ), "%H:%M:%S", &t );
+            m_when = when;
+        }
+    }
+
+    const char* date() const { return m_date; }
+    const char* time() const { return m_time; }
+
+private:
+    std::time_t m_when = -1;
+    char m_date[ 16 ] = {};
+    char m_time[ 16 ] = {};
+};
+
+/// @brief Appends @p msg to @p out, quoted as a JSON string
 static void
-log( const char* msg, unsigned int debugLevel, bool withTime = true )
+appendJsonString( std::string& out, const char* msg )
 {
-    if ( logLevelEnabled( debugLevel ) )
+    out.push_back( '"' );
+    for ( const char* p = msg; *p; ++p )
     {
+        const unsigned char c = static_cast< unsigned char >( *p );
+        switch ( c )
+        {
+        case '"':
+            out.append( "\\\"" );
+            break;
+        case '\\':
+            out.append( "\\\\" );
+            break;
+        case '\n':
+            out.append( "\\n" );
+            break;
+        case '\t':
+            out.append( "\\t" );
+            break;
+        default:
+            if ( c < 0x20 )
+            {
+                char buf[ 8 ];
+                std::snprintf( buf, sizeof( buf ), "\\u%04x", c );
+                out.append( buf );
+            }
+            else
+            {
+                out.push_back( *p );
+            }
+        }
+    }
+    out.push_back( '"' );
+}
+
+/** @brief Information that goes with a message in the structured log */
+struct StructuredInfo
+{
+    std::int64_t monotonic = 0;  ///< Microseconds since logging started
+    long thread = 0;
+    int jobIndex = -1;
+    const char* instance = nullptr;
+};
+
+/** @brief Writes one message as a JSON object on a line of the structured log
+ *
+ * Call this with s_mutex held.
+ */
+static void
+writeStructured( Timestamp& stamp, unsigned int debugLevel, const StructuredInfo& info, const char* msg )
+{
+    std::string line;
+    line.reserve( 128 );
+    line.append( "{\"t\":" );
+    line.append( std::to_string( info.monotonic / 1000000 ) );
+    char fraction[ 8 ];
+    std::snprintf( fraction, sizeof( fraction ), ".%06d", int( info.monotonic % 1000000 ) );
+    line.append( fraction );
+    line.append( ",\"time\":\"" );
+    line.append( stamp.date() );
+    line.push_back( 'T' );
+    line.append( stamp.time() );
+    line.append( "\",\"level\":" );
+    line.append( std::to_string( debugLevel ) );
+    line.append( ",\"thread\":" );
+    line.append( std::to_string( info.thread ) );
+    if ( info.instance && *info.instance )
+    {
+        line.append( ",\"instance\":" );
+        appendJsonString( line, info.instance );
+    }
+    if ( info.jobIndex >= 0 )
+    {
+        line.append( ",\"job\":" );
+        line.append( std::to_string( info.jobIndex ) );
+    }
+    line.append( ",\"msg\":" );
+    appendJsonString( line, msg );
+    line.append( "}\n" );
+    jsonfile << line;
+}
+
+/** @brief Writes one message to the logfile and std::cout
+ *
+ * Call this with s_mutex held.
+ */
+static void
+writeMessage( Timestamp& stamp, std::time_t when, unsigned int debugLevel, bool withTime, const char* msg )
+{
+    stamp.format( when );
+    if ( logfile.is_open() )
+    {
+        logfile << stamp.date() << " - " << stamp.time() << " [" << debugLevel << "]: " << msg << '\n';
+    }
+    if ( withTime )
+    {
+        std::cout << stamp.time() << " [" << debugLevel << "]: ";
+    }
+    std::cout << msg << '\n';
+}
+
+/** @brief Background writer for log messages
+ *
+ * Messages are placed in a fixed-size ring buffer by any number of
+ * threads; a single writer thread takes them out and writes them to
+ * the log file and std::cout. Placing a message in the ring does not
+ * take a lock, so logging threads do not wait for each other or for
+ * the disk. When the ring is full, the logging thread waits for
+ * space to become available: messages are never dropped.
+ *
+ * The ring is a bounded queue where each slot has a sequence number
+ * that says whether it is free to be written (by a producer) or
+ * ready to be read (by the writer).
+ *
+ * The ring is flushed at exit, and (best-effort) when Calamares
+ * crashes, so that the last messages before a crash end up in
+ * the log file.
+ */
+class LogRing
+{
+public:
+    static LogRing& instance();
+
+    /// @brief Add a message to the ring, waits if the ring is full
+    void post( unsigned int debugLevel, bool withTime, const char* msg );
+    /// @brief Wait until all the messages posted so far are written
+    void flush();
+    /// @brief Write out everything and stop the writer thread
+    void stop();
+    /** @brief Write out whatever is in the ring, from a crash handler
+     *
+     * This does not wait for the writer thread, since that might
+     * be the one that crashed.
+     */
+    void emergencyDrain();
+
+    /// @brief Microseconds since logging started
+    std::int64_t monotonic() const
+    {
+        return std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::steady_clock::now() - m_start )
+            .count();
+    }
+
+private:
+    static constexpr const std::size_t RING_SIZE = 4096;  // Power of two
+    static constexpr const std::size_t RING_MASK = RING_SIZE - 1;
+
+    struct Slot
+    {
+        std::atomic< std::size_t > sequence;
+        std::time_t when;
+        unsigned int debugLevel;
+        bool withTime;
+        std::string message;
+        // Only filled in when the structured log is enabled
+        std::int64_t monotonic;
+        long thread;
+        int jobIndex;
+        std::string instance;
+    };
+
+    LogRing();
+
+    /// @brief Is there a message ready for the writer?
+    bool hasMessage() const;
+    /// @brief Write out all the ready messages, returns false if there were none
+    bool drain();
+    void run();
+
+    Slot m_slots[ RING_SIZE ];
+    std::atomic< std::size_t > m_enqueuePos { 0 };
+    std::size_t m_dequeuePos = 0;  // Only accessed while holding m_draining
+    std::atomic< std::size_t > m_written { 0 };
+    std::atomic_flag m_draining = ATOMIC_FLAG_INIT;
+    Timestamp m_stamp;  // Only accessed while holding m_draining
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;  ///< Wakes up the writer
+    std::condition_variable m_flushed;  ///< Wakes up threads in flush()
+    std::atomic< bool > m_sleeping { false };
+    std::atomic< bool > m_stopped { false };
+    std::thread m_writer;
+    const std::chrono::steady_clock::time_point m_start = std::chrono::steady_clock::now();
+};
+
+LogRing&
+LogRing::instance()
+{
+    // Leaked on purpose, so that logging during static destruction works
+    static LogRing* ring = new LogRing;
+    return *ring;
+}
+
+static void
+stopLogRing()
+{
+    LogRing::instance().stop();
+}
+
+LogRing::LogRing()
+{
+    for ( std::size_t i = 0; i < RING_SIZE; ++i )
+    {
+        m_slots[ i ].sequence.store( i, std::memory_order_relaxed );
+    }
+    m_writer = std::thread( [ this ]() { run(); } );
+    std::atexit( stopLogRing );
+}
+
+void
+LogRing::post( unsigned int debugLevel, bool withTime, const char* msg )
+{
+    const std::time_t when = std::time( nullptr );
+    if ( m_stopped.load() )
+    {
+        // Logging after the writer has stopped, e.g. from static destructors
+        static Timestamp stamp;
         QMutexLocker lock( &s_mutex );
+        writeMessage( stamp, when, debugLevel, withTime, msg );
+        if ( s_structured.load() )
+        {
+            writeStructured( stamp,
+                             debugLevel,
+                             { monotonic(), threadId(), s_context.jobIndex, s_context.instance.c_str() },
+                             msg );
+            jsonfile.flush();
+        }
+        logfile.flush();
+        std::cout.flush();
+        return;
+    }
+
+    std::size_t pos = m_enqueuePos.load( std::memory_order_relaxed );
+    Slot* slot = nullptr;
+    for ( ;; )
+    {
+        slot = &m_slots[ pos & RING_MASK ];
+        const std::size_t seq = slot->sequence.load( std::memory_order_acquire );
+        const auto diff = static_cast< std::ptrdiff_t >( seq ) - static_cast< std::ptrdiff_t >( pos );
+        if ( diff == 0 )
+        {
+            if ( m_enqueuePos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+            {
+                break;
+            }
+        }
+        else if ( diff < 0 )
+        {
+            // Ring is full; make sure the writer is awake and wait for it
+            m_wake.notify_one();
+            std::this_thread::yield();
+            pos = m_enqueuePos.load( std::memory_order_relaxed );
+        }
+        else
+        {
+            pos = m_enqueuePos.load( std::memory_order_relaxed );
+        }
+    }
+
+    slot->when = when;
+    slot->debugLevel = debugLevel;
+    slot->withTime = withTime;
+    slot->message.assign( msg );
+    if ( s_structured.load( std::memory_order_relaxed ) )
+    {
+        slot->monotonic = monotonic();
+        slot->thread = threadId();
+        slot->jobIndex = s_context.jobIndex;
+        slot->instance = s_context.instance;
+    }
+    else
+    {
+        slot->monotonic = -1;
+    }
+    slot->sequence.store( pos + 1, std::memory_order_release );
 
-        // If we don't format the date as a Qt::ISODate then we get a crash when
-        // logging at exit as Qt tries to use QLocale to format, but QLocale is
-        // on its way out.
-        logfile << QDate::currentDate().toString( Qt::ISODate ).toUtf8().data() << " - "
-                << QTime::currentTime().toString().toUtf8().data() << " ["
-                << QString::number( debugLevel ).toUtf8().data() << "]: " << msg << std::endl;
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if ( m_sleeping.load() )
+    {
+        std::lock_guard< std::mutex > lock( m_wakeMutex );
+        m_wake.notify_one();
+    }
+}
 
+bool
+LogRing::hasMessage() const
+{
+    const std::size_t pos = m_written.load( std::memory_order_acquire );
+    return m_slots[ pos & RING_MASK ].sequence.load( std::memory_order_acquire ) == pos + 1;
+}
+
+bool
+LogRing::drain()
+{
+    bool any = false;
+    QMutexLocker lock( &s_mutex );
+    for ( ;; )
+    {
+        Slot& slot = m_slots[ m_dequeuePos & RING_MASK ];
+        if ( slot.sequence.load( std::memory_order_acquire ) != m_dequeuePos + 1 )
+        {
+            break;
+        }
+        writeMessage( m_stamp, slot.when, slot.debugLevel, slot.withTime, slot.message.c_str() );
+        if ( slot.monotonic >= 0 && jsonfile.is_open() )
+        {
+            writeStructured( m_stamp,
+                             slot.debugLevel,
+                             { slot.monotonic, slot.thread, slot.jobIndex, slot.instance.c_str() },
+                             slot.message.c_str() );
+        }
+        slot.sequence.store( m_dequeuePos + RING_SIZE, std::memory_order_release );
+        ++m_dequeuePos;
+        any = true;
+    }
+    if ( any )
+    {
         logfile.flush();
+        if ( jsonfile.is_open() )
+        {
+            jsonfile.flush();
+        }
+        std::cout.flush();
+        m_written.store( m_dequeuePos, std::memory_order_release );
+    }
+    return any;
+}
+
+void
+LogRing::run()
+{
+    while ( !m_stopped.load() )
+    {
+        bool any = false;
+        if ( !m_draining.test_and_set( std::memory_order_acquire ) )
+        {
+            any = drain();
+            m_draining.clear( std::memory_order_release );
+        }
+        if ( any )
+        {
+            std::lock_guard< std::mutex > lock( m_wakeMutex );
+            m_flushed.notify_all();
+        }
+        else
+        {
+            std::unique_lock< std::mutex > lock( m_wakeMutex );
+            m_sleeping.store( true );
+            // The timeout covers a wake-up that slips between the check and the wait
+            m_wake.wait_for( lock, std::chrono::milliseconds( 100 ), [ this ]() {
+                return m_stopped.load() || hasMessage();
+            } );
+            m_sleeping.store( false );
+        }
+    }
+}
+
+void
+LogRing::flush()
+{
+    const std::size_t target = m_enqueuePos.load();
+    std::unique_lock< std::mutex > lock( m_wakeMutex );
+    m_wake.notify_one();
+    while ( !m_stopped.load() && m_written.load() < target )
+    {
+        m_flushed.wait_for( lock, std::chrono::milliseconds( 100 ) );
+    }
+}
+
+void
+LogRing::stop()
+{
+    if ( m_stopped.exchange( true ) )
+    {
+        return;
+    }
+    {
+        std::lock_guard< std::mutex > lock( m_wakeMutex );
+        m_wake.notify_one();
+        m_flushed.notify_all();
+    }
+    if ( m_writer.joinable() )
+    {
+        m_writer.join();
+    }
+    // Pick up anything that was posted while stopping.
+    while ( m_draining.test_and_set( std::memory_order_acquire ) )
+    {
+        std::this_thread::yield();
+    }
+    drain();
+    m_draining.clear( std::memory_order_release );
+}
+
+void
+LogRing::emergencyDrain()
+{
+    // Give the writer a moment to finish, if it is busy writing.
+    for ( int i = 0; i < 100; ++i )
+    {
+        if ( !m_draining.test_and_set( std::memory_order_acquire ) )
+        {
+            if ( s_mutex.tryLock() )
+            {
+                s_mutex.unlock();
+                drain();
+            }
+            m_draining.clear( std::memory_order_release );
+            return;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+}
+
+static void
+crashHandler( int sig )
+{
+    LogRing::instance().emergencyDrain();
+    std::signal( sig, SIG_DFL );
+    std::raise( sig );
+}
 
-        if ( withTime )
+static void
+log( const char* msg, unsigned int debugLevel, bool withTime = true )
+{
+    if ( logLevelEnabled( debugLevel ) )
+    {
+        LogRing& ring = LogRing::instance();
+        ring.post( debugLevel, withTime, msg );
+        if ( debugLevel <= LOGERROR )
         {
-            std::cout << QTime::currentTime().toString().toUtf8().data() << " ["
-                      << QString::number( debugLevel ).toUtf8().data() << "]: ";
+            // Errors are often followed by a crash or exit, so make
+            // sure they are written out before carrying on.
+            ring.flush();
         }
-        std::cout << msg << std::endl;
     }
 }
 
+void
+flush()
+{
+    LogRing::instance().flush();
+}
+
 
 static void
 CalamaresLogHandler( QtMsgType type, const QMessageLogContext&, const QString& msg )
@@ -114,8 +600,12 @@ CalamaresLogHandler( QtMsgType type, const QMessageLogContext&, const QString& m
         log( message, LOGWARNING );
         break;
     case QtCriticalMsg:
+        log( message, LOGERROR );
+        break;
     case QtFatalMsg:
         log( message, LOGERROR );
+        // Qt will abort after this, so stop the writer now
+        LogRing::instance().stop();
         break;
     }
 }
@@ -128,33 +618,50 @@ logFile()
 }
 
 
-void
-setupLogfile()
+QString
+structuredLogFile()
+{
+    return CalamaresUtils::appLogDir().filePath( "session.jsonl" );
+}
+
+/// @brief Keeps only the tail end of the file at @p path if it is too large
+static void
+rollOver( const QString& path )
 {
-    if ( QFileInfo( logFile().toLocal8Bit() ).size() > LOGFILE_SIZE )
+    if ( QFileInfo( path.toLocal8Bit() ).size() > LOGFILE_SIZE )
     {
         QByteArray lc;
         {
-            QFile f( logFile().toLocal8Bit() );
+            QFile f( path.toLocal8Bit() );
             f.open( QIODevice::ReadOnly | QIODevice::Text );
             lc = f.readAll();
             f.close();
         }
 
-        QFile::remove( logFile().toLocal8Bit() );
+        QFile::remove( path.toLocal8Bit() );
 
         {
-            QFile f( logFile().toLocal8Bit() );
+            QFile f( path.toLocal8Bit() );
             f.open( QIODevice::WriteOnly | QIODevice::Text );
-            f.write( lc.right( LOGFILE_SIZE - ( LOGFILE_SIZE / 4 ) ) );
+            lc = lc.right( LOGFILE_SIZE - ( LOGFILE_SIZE / 4 ) );
+            // Don't start with half a line
+            const int newline = lc.indexOf( '\n' );
+            f.write( newline >= 0 ? lc.mid( newline + 1 ) : lc );
             f.close();
         }
     }
+}
+
+void
+setupLogfile()
+{
+    rollOver( logFile() );
 
     // Since the log isn't open yet, this probably only goes to stdout
     cDebug() << "Using log file:" << logFile();
 
-    // Lock while (re-)opening the logfile
+    // Lock while (re-)opening the logfile; the writer thread
+    // takes the same lock while writing.
     {
         QMutexLocker lock( &s_mutex );
         logfile.open( logFile().toLocal8Bit(), std::ios::app );
@@ -166,6 +673,37 @@ setupLogfile()
     }
 
     qInstallMessageHandler( CalamaresLogHandler );
+
+    for ( int sig : { SIGSEGV, SIGABRT, SIGBUS, SIGFPE, SIGILL } )
+    {
+        std::signal( sig, crashHandler );
+    }
+}
+
+void
+setupStructuredLog()
+{
+    rollOver( structuredLogFile() );
+    cDebug() << "Using structured log file:" << structuredLogFile();
+    {
+        QMutexLocker lock( &s_mutex );
+        jsonfile.open( structuredLogFile().toLocal8Bit(), std::ios::app );
+    }
+    s_structured = true;
+}
+
+LogContext::LogContext( const QString& instance, int jobIndex )
+    : m_instance( std::move( s_context.instance ) )
+    , m_jobIndex( s_context.jobIndex )
+{
+    s_context.instance = instance.toStdString();
+    s_context.jobIndex = jobIndex;
+}
+
+LogContext::~LogContext()
+{
+    s_context.instance = std::move( m_instance );
+    s_context.jobIndex = m_jobIndex;
 }
 
 CDebug::CDebug( unsigned int debugLevel, const char* func )
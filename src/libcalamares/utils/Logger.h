@@ -13,12 +13,14 @@
 #ifndef UTILS_LOGGER_H
 #define UTILS_LOGGER_H
 
+#include "CalamaresConfig.h"
 #include "DllMacro.h"
 
 #include <QDebug>
 #include <QSharedPointer>
 
 #include <memory>
+#include <string>
 
 namespace Logger
 {
@@ -108,6 +110,32 @@ DLLEXPORT QString logFile();
  */
 DLLEXPORT void setupLogfile();
 
+/**
+ * @brief The full path of the structured log file.
+ */
+DLLEXPORT QString structuredLogFile();
+
+/**
+ * @brief Start writing the structured log as well.
+ *
+ * The structured log has one JSON object per line, for each
+ * message in the regular log. Each object has the message,
+ * the log level, thread, a timestamp (both in seconds since
+ * logging started, and as the local date and time), and
+ * the module instance and job index, if they are known (see LogContext).
+ * Call this (once) at startup; it does not matter whether the regular
+ * log file has been set up already.
+ */
+DLLEXPORT void setupStructuredLog();
+
+/**
+ * @brief Thread-id (as the kernel knows it) of the calling thread.
+ *
+ * This is what the logs and the trace use for the thread, and what
+ * per-thread system calls like setpriority() take.
+ */
+DLLEXPORT long threadId();
+
 /**
  * @brief Set a log level for future logging.
  *
@@ -125,6 +153,37 @@ DLLEXPORT unsigned int logLevel();
 /** @brief Would the given @p level really be logged? */
 DLLEXPORT bool logLevelEnabled( unsigned int level );
 
+/**
+ * @brief Wait until all the messages logged so far are written.
+ *
+ * Log messages are written to the log file by a background thread,
+ * so they may reach the file some time after the cDebug() statement.
+ * Errors are always flushed. The log is flushed at exit, too.
+ */
+DLLEXPORT void flush();
+
+/**
+ * @brief Sets the context for log messages from this thread
+ *
+ * While a LogContext object exists, messages logged from the
+ * thread that created it are marked in the structured log with
+ * the module @p instance and @p jobIndex. Contexts nest: the
+ * previous context is restored when the object is destroyed.
+ */
+class DLLEXPORT LogContext
+{
+public:
+    explicit LogContext( const QString& instance, int jobIndex = -1 );
+    ~LogContext();
+
+    LogContext( const LogContext& ) = delete;
+    LogContext& operator=( const LogContext& ) = delete;
+
+private:
+    std::string m_instance;  ///< Previous context
+    int m_jobIndex;
+};
+
 /**
  * @brief Row-oriented formatted logging.
  *
@@ -335,9 +394,26 @@ operator<<( CDebug&& s, const Once& o )
 
 }  // namespace Logger
 
-#define cVerbose() Logger::CDebug( Logger::LOGVERBOSE, Q_FUNC_INFO )
-#define cDebug() Logger::CDebug( Logger::LOGDEBUG, Q_FUNC_INFO )
-#define cWarning() Logger::CDebug( Logger::LOGWARNING, Q_FUNC_INFO )
-#define cError() Logger::CDebug( Logger::LOGERROR, Q_FUNC_INFO )
+/* The logging macros check the log level **before** the CDebug object
+ * is constructed, so that nothing that is streamed into a disabled
+ * log level is evaluated. The for-loop runs (at most) once, and unlike
+ * an if-statement, does not meddle with an else that follows it.
+ *
+ * When Calamares is built without WITH_VERBOSE_LOGGING, cVerbose()
+ * statements are still compiled (so they do not bit-rot) but the
+ * compiler removes them entirely.
+ */
+#define CALAMARES_LOG_AT( level, enabled ) \
+    for ( bool calamares_log_once = ( enabled ); calamares_log_once; calamares_log_once = false ) \
+    Logger::CDebug( level, Q_FUNC_INFO )
+
+#ifdef WITH_VERBOSE_LOGGING
+#define cVerbose() CALAMARES_LOG_AT( Logger::LOGVERBOSE, Logger::logLevelEnabled( Logger::LOGVERBOSE ) )
+#else
+#define cVerbose() CALAMARES_LOG_AT( Logger::LOGVERBOSE, false )
+#endif
+#define cDebug() CALAMARES_LOG_AT( Logger::LOGDEBUG, Logger::logLevelEnabled( Logger::LOGDEBUG ) )
+#define cWarning() CALAMARES_LOG_AT( Logger::LOGWARNING, Logger::logLevelEnabled( Logger::LOGWARNING ) )
+#define cError() CALAMARES_LOG_AT( Logger::LOGERROR, Logger::logLevelEnabled( Logger::LOGERROR ) )
 
 #endif
@@ -0,0 +1,224 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "PageCache.h"
+
+#include "HardwareInfo.h"
+#include "Logger.h"
+#include "Units.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#ifdef Q_OS_LINUX
+#include <sys/syscall.h>
+#endif
+
+using namespace CalamaresUtils::Units;
+
+namespace CalamaresUtils
+{
+namespace PageCache
+{
+
+/// @brief How much to read ahead at a time
+static constexpr const qint64 chunkSize = 4_MiB;
+/// @brief Memory pressure (percent of time stalled, over 10 seconds) to back off at
+static constexpr const double maxPressure = 10.0;
+/// @brief How many times to wait for memory pressure to go away
+static constexpr const int maxBackoffs = 6;
+
+/// @brief The thread of warmInBackground(); it is stopped and joined when the application quits
+static std::thread s_warmThread;
+static std::atomic< bool > s_stopWarming { false };
+
+/// @brief MemFree from /proc/meminfo, in bytes, or -1 if unknown
+static qint64
+freeMemoryB()
+{
+    QFile f( QStringLiteral( "/proc/meminfo" ) );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        return -1;
+    }
+    const QByteArray prefix( "MemFree:" );
+    while ( !f.atEnd() )
+    {
+        const QByteArray line = f.readLine();
+        if ( line.startsWith( prefix ) )
+        {
+            // The value is in KiB
+            return line.mid( prefix.length() ).trimmed().split( ' ' ).first().toLongLong() * 1024;
+        }
+    }
+    return -1;
+}
+
+/// @brief The "some avg10" value from /proc/pressure/memory, or 0 if there is no PSI
+static double
+memoryPressure()
+{
+    QFile f( QStringLiteral( "/proc/pressure/memory" ) );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        return 0.0;
+    }
+    // some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+    for ( const auto& field : f.readLine().trimmed().split( ' ' ) )
+    {
+        if ( field.startsWith( "avg10=" ) )
+        {
+            return field.mid( 6 ).toDouble();
+        }
+    }
+    return 0.0;
+}
+
+/// @brief Waits for memory pressure to go away; false if it doesn't, or if @p stop is set meanwhile
+static bool
+waitForLowPressure( const std::atomic< bool >& stop )
+{
+    for ( int i = 0; i < maxBackoffs; ++i )
+    {
+        if ( memoryPressure() < maxPressure )
+        {
+            return true;
+        }
+        // Five seconds, but a quitting application does not wait that long
+        for ( int tick = 0; tick < 50 && !stop; ++tick )
+        {
+            std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+        }
+        if ( stop )
+        {
+            return false;
+        }
+    }
+    return memoryPressure() < maxPressure;
+}
+
+/// @brief Reads [ @p offset, @p offset + @p length ) of @p fd into the page cache
+static bool
+readAhead( int fd, qint64 offset, qint64 length, QByteArray& buffer )
+{
+#ifdef Q_OS_LINUX
+    // Blocks until the data is in the page cache, without copying it out;
+    // not all filesystems support it, though.
+    if ( ::readahead( fd, offset, size_t( length ) ) == 0 )
+    {
+        return true;
+    }
+#endif
+    buffer.resize( int( length ) );
+    return ::pread( fd, buffer.data(), size_t( length ), offset ) >= 0;
+}
+
+/// @brief Implementation of warm(), which stops early when @p stop is set
+static qint64
+warmUnlessStopped( const QString& path, const std::atomic< bool >& stop )
+{
+    const QFileInfo fi( path );
+    if ( !fi.isFile() )
+    {
+        return 0;
+    }
+
+    const int fd = ::open( QFile::encodeName( fi.absoluteFilePath() ).constData(), O_RDONLY | O_CLOEXEC );
+    if ( fd < 0 )
+    {
+        return -1;
+    }
+    const qint64 size = fi.size();
+    ::posix_fadvise( fd, 0, size, POSIX_FADV_SEQUENTIAL );
+
+    // Leave a quarter of the memory free for everything else
+    const qint64 reserve = qint64( HardwareInfo::instance().totalMemoryB() / 4 );
+    QByteArray buffer;
+    qint64 offset = 0;
+    while ( offset < size )
+    {
+        const qint64 freeB = freeMemoryB();
+        if ( stop || ( freeB >= 0 && freeB < reserve + chunkSize ) || !waitForLowPressure( stop ) )
+        {
+            cDebug() << "Stopped warming" << path << "at" << offset << "of" << size << "bytes.";
+            break;
+        }
+        const qint64 length = qMin( chunkSize, size - offset );
+        if ( !readAhead( fd, offset, length, buffer ) )
+        {
+            break;
+        }
+        offset += length;
+    }
+    ::close( fd );
+    return offset;
+}
+
+qint64
+warm( const QString& path )
+{
+    const std::atomic< bool > never { false };
+    return warmUnlessStopped( path, never );
+}
+
+/// @brief Stops the thread of warmInBackground(), and waits for it
+static void
+stopWarming()
+{
+    s_stopWarming = true;
+    if ( s_warmThread.joinable() )
+    {
+        s_warmThread.join();
+    }
+}
+
+void
+warmInBackground( const QStringList& paths )
+{
+    auto* app = QCoreApplication::instance();
+    if ( paths.isEmpty() || !app || s_warmThread.joinable() )
+    {
+        return;
+    }
+    // The thread logs, so it has to stop before main() returns
+    QObject::connect( app, &QCoreApplication::aboutToQuit, stopWarming );
+    s_stopWarming = false;
+    s_warmThread = std::thread( [ paths ]() {
+#ifdef Q_OS_LINUX
+        // Idle priority for this thread only: nice 19 and the idle I/O class.
+        // Only the BFQ I/O scheduler has I/O classes; with the others (e.g.
+        // mq-deadline, or none for NVMe) the reads have normal I/O priority.
+        const auto tid = ::syscall( SYS_gettid );
+        ::setpriority( PRIO_PROCESS, id_t( tid ), 19 );
+        static constexpr const int ioprioWhoProcess = 1;
+        static constexpr const int ioprioIdle = 3 << 13;
+        ::syscall( SYS_ioprio_set, ioprioWhoProcess, 0, ioprioIdle );
+#endif
+        for ( const auto& path : paths )
+        {
+            if ( s_stopWarming )
+            {
+                break;
+            }
+            const qint64 warmed = warmUnlessStopped( path, s_stopWarming );
+            cDebug() << "Warmed page cache for" << path << warmed << "bytes.";
+        }
+    } );
+}
+
+}  // namespace PageCache
+}  // namespace CalamaresUtils
@@ -0,0 +1,50 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef UTILS_PAGECACHE_H
+#define UTILS_PAGECACHE_H
+
+#include "DllMacro.h"
+
+#include <QString>
+#include <QStringList>
+
+namespace CalamaresUtils
+{
+namespace PageCache
+{
+/** @brief Reads the file @p path into the page cache
+ *
+ * This reads ahead in chunks, so that a later read of the file
+ * (e.g. unsquashfs of an image on slow USB media) comes from memory.
+ * It stops early when free memory runs low, and pauses (then gives up)
+ * while the kernel reports memory pressure (PSI). Paths that are
+ * not regular files are ignored.
+ *
+ * @return the number of bytes read ahead, or -1 if the file
+ *      could not be opened.
+ */
+DLLEXPORT qint64 warm( const QString& path );
+
+/** @brief Calls warm() for each of @p paths, in a background thread
+ *
+ * The thread has idle CPU and I/O priority, so it only uses the
+ * disk and processor when nothing else does -- e.g. while the user
+ * is busy with the pages before the installation. The idle I/O
+ * priority only works with the BFQ I/O scheduler, though.
+ *
+ * The thread stops (and is waited for) when the application quits.
+ * This does nothing without a QCoreApplication, or if the thread
+ * is running already.
+ */
+DLLEXPORT void warmInBackground( const QStringList& paths );
+}  // namespace PageCache
+}  // namespace CalamaresUtils
+
+#endif
@@ -9,15 +9,134 @@
 
 #include "Logger.h"
 
-#include <QProcess>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QString>
 #include <QStringList>
 
+#include <fcntl.h>
+#include <grp.h>
+#include <pwd.h>
 #include <sys/stat.h>
+#include <unistd.h>
+
+#include <vector>
 
 namespace CalamaresUtils
 {
 
+struct AccountIds::Files
+{
+    QHash< QString, qint64 > users;
+    QHash< QString, qint64 > groups;
+    QDateTime passwdModified;
+    QDateTime groupModified;
+};
+
+/** @brief Reads the name -> id mapping of an account file
+ *
+ * Both /etc/passwd and /etc/group have the name in the first field,
+ * and the numeric id in the third.
+ */
+static QHash< QString, qint64 >
+readAccounts( const QString& path )
+{
+    QHash< QString, qint64 > accounts;
+    QFile f( path );
+    if ( !f.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        cWarning() << "Could not read accounts from" << path;
+        return accounts;
+    }
+    for ( const auto& line : f.readAll().split( '\n' ) )
+    {
+        const auto fields = line.split( ':' );
+        bool ok = false;
+        const qint64 id = fields.count() >= 3 ? fields.at( 2 ).toLongLong( &ok ) : -1;
+        const QString name = ok ? QString::fromUtf8( fields.at( 0 ) ) : QString();
+        // Like getpwnam(), the first entry for a name wins
+        if ( !name.isEmpty() && !accounts.contains( name ) )
+        {
+            accounts.insert( name, id );
+        }
+    }
+    return accounts;
+}
+
+AccountIds::AccountIds( const QString& root )
+    : m_host( QDir( root ).canonicalPath() == QStringLiteral( "/" ) )
+{
+    static QMutex cacheMutex;
+    static QHash< QString, std::shared_ptr< const Files > > cache;
+
+    const QDir dir( root );
+    const QFileInfo passwd( dir.filePath( QStringLiteral( "etc/passwd" ) ) );
+    const QFileInfo group( dir.filePath( QStringLiteral( "etc/group" ) ) );
+
+    QMutexLocker lock( &cacheMutex );
+    auto& files = cache[ dir.absolutePath() ];
+    if ( !files || files->passwdModified != passwd.lastModified() || files->groupModified != group.lastModified() )
+    {
+        auto f = std::make_shared< Files >();
+        f->passwdModified = passwd.lastModified();
+        f->groupModified = group.lastModified();
+        f->users = readAccounts( passwd.filePath() );
+        f->groups = readAccounts( group.filePath() );
+        files = f;
+    }
+    m_files = files;
+}
+
+AccountIds::~AccountIds() {}
+
+qint64
+AccountIds::userId( const QString& name ) const
+{
+    bool ok = false;
+    const qint64 numeric = name.toLongLong( &ok );
+    if ( ok )
+    {
+        return numeric;
+    }
+    const qint64 id = m_files->users.value( name, -1 );
+    if ( id < 0 && m_host )
+    {
+        // Jobs may run concurrently, so use the re-entrant lookup
+        std::vector< char > buffer( 16384 );
+        struct passwd pwd;
+        struct passwd* pw = nullptr;
+        getpwnam_r( name.toUtf8().constData(), &pwd, buffer.data(), buffer.size(), &pw );
+        return pw ? qint64( pw->pw_uid ) : -1;
+    }
+    return id;
+}
+
+qint64
+AccountIds::groupId( const QString& name ) const
+{
+    bool ok = false;
+    const qint64 numeric = name.toLongLong( &ok );
+    if ( ok )
+    {
+        return numeric;
+    }
+    const qint64 id = m_files->groups.value( name, -1 );
+    if ( id < 0 && m_host )
+    {
+        std::vector< char > buffer( 16384 );
+        struct group grp;
+        struct group* gr = nullptr;
+        getgrnam_r( name.toUtf8().constData(), &grp, buffer.data(), buffer.size(), &gr );
+        return gr ? qint64( gr->gr_gid ) : -1;
+    }
+    return id;
+}
+
 Permissions::Permissions()
     : m_username()
     , m_group()
@@ -92,32 +211,45 @@ Permissions::apply( const QString& path, int mode )
 
 bool
 Permissions::apply( const QString& path, const CalamaresUtils::Permissions& p )
+{
+    return apply( QStringList { path }, p, QStringLiteral( "/" ) );
+}
+
+bool
+Permissions::apply( const QStringList& paths, const CalamaresUtils::Permissions& p, const QString& root )
 {
     if ( !p.isValid() )
     {
         return false;
     }
-    bool r = apply( path, p.value() );
-    if ( r )
+
+    const AccountIds ids( root );
+    const qint64 uid = ids.userId( p.username() );
+    const qint64 gid = ids.groupId( p.group() );
+    if ( uid < 0 || gid < 0 )
     {
-        // We don't use chgrp(2) or chown(2) here because then we need to
-        // go through the users list (which one, target or source?) to get
-        // uid_t and gid_t values to pass to that system call.
-        //
-        // Do a lame cop-out and let the chown(8) utility do the heavy lifting.
-        if ( QProcess::execute( "chown", { p.username() + ':' + p.group(), path } ) )
+        cDebug() << Logger::SubEntry << "Could not find owner" << ( p.username() + ':' + p.group() ) << "in" << root;
+        return false;
+    }
+
+    bool r = true;
+    for ( const auto& path : paths )
+    {
+        const QByteArray name = QFile::encodeName( path );
+        // Changing the owner may clear the set-id bits, so the mode comes after
+        if ( fchownat( AT_FDCWD, name.constData(), uid_t( uid ), gid_t( gid ), 0 ) )
         {
             r = false;
             cDebug() << Logger::SubEntry << "Could not set owner of" << path << "to"
                      << ( p.username() + ':' + p.group() );
         }
-    }
-    if ( r )
-    {
-        /* NOTUSED */ apply( path, p.value() );
+        else if ( fchmodat( AT_FDCWD, name.constData(), mode_t( p.value() ), 0 ) )
+        {
+            r = false;
+            cDebug() << Logger::SubEntry << "Could not set permissions of" << path << "to" << p.octal();
+        }
     }
     return r;
 }
 
-
 }  // namespace CalamaresUtils
@@ -11,10 +11,46 @@
 #include "DllMacro.h"
 
 #include <QString>
+#include <QStringList>
+
+#include <memory>
 
 namespace CalamaresUtils
 {
 
+/** @brief Numeric user- and group-ids from the account files of a system
+ *
+ * This reads `/etc/passwd` and `/etc/group` of the system at @p root
+ * (e.g. the target system's root mount point). The files are read once
+ * and cached for each root, until they are modified (e.g. when the
+ * *users* module has created a user in the target).
+ */
+class DLLEXPORT AccountIds
+{
+public:
+    /** @brief Account ids for the system at @p root
+     *
+     * For the host system ("/"), names that are not in the files
+     * are looked up by the C library as well, which finds accounts
+     * from other sources (e.g. LDAP).
+     */
+    explicit AccountIds( const QString& root = QStringLiteral( "/" ) );
+    ~AccountIds();
+
+    /** @brief The user-id of user @p name, or -1 if there is no such user
+     *
+     * A numeric @p name is an id already, and is returned as-is.
+     */
+    qint64 userId( const QString& name ) const;
+    /// @brief The group-id of group @p name, like userId()
+    qint64 groupId( const QString& name ) const;
+
+private:
+    struct Files;
+    std::shared_ptr< const Files > m_files;
+    bool m_host;
+};
+
 /**
  * @brief The Permissions class takes a QString @p in the form of
  * <user>:<group>:<permissions>, checks it for validity, and makes the three
@@ -78,6 +114,16 @@ public:
      * @return @c true on success of **both** operations
      */
     static bool apply( const QString& path, const Permissions& p );
+    /** @brief Do both chown and chmod on each of @p paths
+     *
+     * The names are looked up once, in the system at @p root (see
+     * AccountIds), and are then applied with system calls to each path.
+     * Pass paths that are relative (or absolute) in the **host** system,
+     * e.g. with System::targetPath() for files in the target.
+     *
+     * @return @c true on success of **both** operations for **all** paths
+     */
+    static bool apply( const QStringList& paths, const Permissions& p, const QString& root );
     /// Convenience method for apply(const QString&, const Permissions& )
     bool apply( const QString& path ) const { return apply( path, *this ); }
 
@@ -0,0 +1,188 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+#include "ResourceUsage.h"
+
+#include <QFile>
+
+#include <sys/resource.h>
+#include <sys/time.h>
+
+namespace CalamaresUtils
+{
+
+static qint64
+milliseconds( const struct timeval& tv )
+{
+    return qint64( tv.tv_sec ) * 1000 + tv.tv_usec / 1000;
+}
+
+/** @brief Reads read_bytes and write_bytes from /proc/self/io
+ *
+ * Leaves the values untouched if the file can't be read.
+ */
+static void
+readProcIO( ResourceUsage& u )
+{
+    QFile f( QStringLiteral( "/proc/self/io" ) );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        return;
+    }
+    // The file is small, and must be read in one go (it's not seekable)
+    const auto lines = f.readAll().split( '\n' );
+    for ( const auto& line : lines )
+    {
+        const auto parts = line.split( ':' );
+        if ( parts.count() != 2 )
+        {
+            continue;
+        }
+        const auto key = parts[ 0 ].trimmed();
+        if ( key == "read_bytes" )
+        {
+            u.bytesRead = parts[ 1 ].trimmed().toLongLong();
+        }
+        else if ( key == "write_bytes" )
+        {
+            u.bytesWritten = parts[ 1 ].trimmed().toLongLong();
+        }
+    }
+}
+
+ResourceUsage
+ResourceUsage::sample()
+{
+    ResourceUsage u;
+    struct rusage r;
+
+#ifdef RUSAGE_THREAD
+    const int who = RUSAGE_THREAD;
+#else
+    const int who = RUSAGE_SELF;
+#endif
+    if ( getrusage( who, &r ) == 0 )
+    {
+        u.userTime = milliseconds( r.ru_utime );
+        u.systemTime = milliseconds( r.ru_stime );
+    }
+    if ( getrusage( RUSAGE_SELF, &r ) == 0 )
+    {
+        u.peakRss = qint64( r.ru_maxrss ) * 1024;  // ru_maxrss is in KiB
+    }
+    if ( getrusage( RUSAGE_CHILDREN, &r ) == 0 )
+    {
+        u.childUserTime = milliseconds( r.ru_utime );
+        u.childSystemTime = milliseconds( r.ru_stime );
+        u.childPeakRss = qint64( r.ru_maxrss ) * 1024;
+    }
+    readProcIO( u );
+    return u;
+}
+
+ResourceUsage
+ResourceUsage::delta( const ResourceUsage& before ) const
+{
+    ResourceUsage u;
+    u.userTime = userTime - before.userTime;
+    u.systemTime = systemTime - before.systemTime;
+    u.childUserTime = childUserTime - before.childUserTime;
+    u.childSystemTime = childSystemTime - before.childSystemTime;
+    u.peakRss = peakRss;
+    u.childPeakRss = childPeakRss;
+    u.bytesRead = bytesRead - before.bytesRead;
+    u.bytesWritten = bytesWritten - before.bytesWritten;
+    return u;
+}
+
+QVariantMap
+ResourceUsage::toMap() const
+{
+    return QVariantMap { { QStringLiteral( "userTime" ), userTime },
+                         { QStringLiteral( "systemTime" ), systemTime },
+                         { QStringLiteral( "childUserTime" ), childUserTime },
+                         { QStringLiteral( "childSystemTime" ), childSystemTime },
+                         { QStringLiteral( "peakRss" ), peakRss },
+                         { QStringLiteral( "childPeakRss" ), childPeakRss },
+                         { QStringLiteral( "bytesRead" ), bytesRead },
+                         { QStringLiteral( "bytesWritten" ), bytesWritten } };
+}
+
+MemoryUsage
+MemoryUsage::sample()
+{
+    for ( const auto* name : { "/proc/self/smaps_rollup", "/proc/self/status" } )
+    {
+        QFile f( QString::fromLatin1( name ) );
+        if ( f.open( QIODevice::ReadOnly ) )
+        {
+            return fromProc( f.readAll() );
+        }
+    }
+    return MemoryUsage();
+}
+
+MemoryUsage
+MemoryUsage::fromProc( const QByteArray& contents )
+{
+    MemoryUsage u;
+    const auto lines = contents.split( '\n' );
+    for ( const auto& line : lines )
+    {
+        const int colon = line.indexOf( ':' );
+        if ( colon < 0 )
+        {
+            continue;
+        }
+        const QByteArray key = line.left( colon );
+        // The values are in KiB, with a "kB" suffix
+        const qint64 value = line.mid( colon + 1 ).simplified().split( ' ' ).first().toLongLong() * 1024;
+        if ( key == "Rss" || key == "VmRSS" )
+        {
+            u.rss = value;
+        }
+        else if ( key == "Pss" )
+        {
+            u.pss = value;
+        }
+        else if ( key == "Anonymous" || key == "RssAnon" )
+        {
+            u.anonymous = value;
+        }
+        else if ( key == "Swap" || key == "VmSwap" )
+        {
+            u.swap = value;
+        }
+    }
+    return u;
+}
+
+MemoryUsage
+MemoryUsage::delta( const MemoryUsage& before ) const
+{
+    MemoryUsage u;
+    u.rss = rss - before.rss;
+    u.pss = pss - before.pss;
+    u.anonymous = anonymous - before.anonymous;
+    u.swap = swap - before.swap;
+    return u;
+}
+
+QVariantMap
+MemoryUsage::toMap() const
+{
+    return QVariantMap { { QStringLiteral( "rss" ), rss },
+                         { QStringLiteral( "pss" ), pss },
+                         { QStringLiteral( "anonymous" ), anonymous },
+                         { QStringLiteral( "swap" ), swap } };
+}
+
+}  // namespace CalamaresUtils
@@ -0,0 +1,94 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+#ifndef UTILS_RESOURCEUSAGE_H
+#define UTILS_RESOURCEUSAGE_H
+
+#include "DllMacro.h"
+
+#include <QVariantMap>
+
+namespace CalamaresUtils
+{
+/** @brief Snapshot of resources used by Calamares (and its children)
+ *
+ * This is a point-in-time sample of CPU time, memory and I/O. Take
+ * a sample before and after some work, and use delta() to find out
+ * what the work cost. CPU times are in milliseconds, memory and I/O
+ * in bytes.
+ *
+ * The "children" values count only child processes that have been
+ * waited-for (e.g. commands run through CalamaresUtils::System).
+ * The I/O counters are for the whole process, including reaped
+ * children, and are zero if /proc/self/io is not available.
+ */
+struct DLLEXPORT ResourceUsage
+{
+    qint64 userTime = 0;  ///< CPU time (user) of the calling thread
+    qint64 systemTime = 0;  ///< CPU time (system) of the calling thread
+    qint64 childUserTime = 0;  ///< CPU time (user) of waited-for children
+    qint64 childSystemTime = 0;  ///< CPU time (system) of waited-for children
+    qint64 peakRss = 0;  ///< Peak resident set size of Calamares itself
+    qint64 childPeakRss = 0;  ///< Largest peak resident set size of any child
+    qint64 bytesRead = 0;  ///< Bytes read from storage
+    qint64 bytesWritten = 0;  ///< Bytes written to storage
+
+    /// @brief Sample the resource usage right now
+    static ResourceUsage sample();
+
+    /** @brief The resources used between @p before and this sample
+     *
+     * The peak values are not differences: they are taken from
+     * this (later) sample, since peaks only ever go up.
+     */
+    ResourceUsage delta( const ResourceUsage& before ) const;
+
+    /// @brief Map with keys like "userTime", for storing in GS or JSON
+    QVariantMap toMap() const;
+};
+
+/** @brief Snapshot of the memory that Calamares uses right now
+ *
+ * Unlike ResourceUsage::peakRss, these are current values, in bytes,
+ * so they go down as well as up. The proportional set size (PSS)
+ * counts shared pages (e.g. of Qt libraries shared with the desktop)
+ * as a fraction, which is what the process really costs on a machine
+ * with little RAM. PSS comes from /proc/self/smaps_rollup, which
+ * older kernels do not have: then it is 0, and the rest comes from
+ * /proc/self/status. Reading smaps_rollup walks the memory map of
+ * the process, so do not sample in a tight loop.
+ */
+struct DLLEXPORT MemoryUsage
+{
+    qint64 rss = 0;  ///< Resident set size
+    qint64 pss = 0;  ///< Proportional set size; 0 if not known
+    qint64 anonymous = 0;  ///< Resident anonymous memory (the heaps, not mapped files)
+    qint64 swap = 0;  ///< Swapped out
+
+    /// @brief Sample the memory usage right now
+    static MemoryUsage sample();
+    /** @brief Reads the values from the contents of a /proc file
+     *
+     * Both the smaps_rollup format (e.g. "Pss:  1234 kB") and the
+     * status format (e.g. "VmRSS:  1234 kB") are understood;
+     * lines with other keys are ignored.
+     */
+    static MemoryUsage fromProc( const QByteArray& contents );
+
+    /// @brief The change since @p before; this may be negative
+    MemoryUsage delta( const MemoryUsage& before ) const;
+
+    /// @brief Map with keys like "rss", for storing in GS or JSON
+    QVariantMap toMap() const;
+};
+
+}  // namespace CalamaresUtils
+
+#endif
@@ -19,6 +19,8 @@
 #include <QEvent>
 #include <QTranslator>
 
+#include <atomic>
+
 namespace
 {
 
@@ -170,6 +172,7 @@ static QTranslator* s_brandingTranslator = nullptr;
 static QTranslator* s_translator = nullptr;
 static QTranslator* s_tztranslator = nullptr;
 static QString s_translatorLocaleName;
+static std::atomic< int > s_translationGeneration { 0 };
 
 void
 installTranslator( const CalamaresUtils::Locale::Translation::Id& locale, const QString& brandingTranslationsPrefix )
@@ -179,6 +182,7 @@ installTranslator( const CalamaresUtils::Locale::Translation::Id& locale, const
     loadSingletonTranslator( BrandingLoader( locale.name, brandingTranslationsPrefix ), s_brandingTranslator );
     loadSingletonTranslator( TZLoader( locale.name ), s_tztranslator );
     loadSingletonTranslator( CalamaresLoader( locale.name ), s_translator );
+    ++s_translationGeneration;
 }
 
 void
@@ -194,6 +198,12 @@ translatorLocaleName()
     return { s_translatorLocaleName };
 }
 
+int
+translationGeneration()
+{
+    return s_translationGeneration;
+}
+
 bool
 loadTranslator( const CalamaresUtils::Locale::Translation::Id& locale, const QString& prefix, QTranslator* translator )
 {
@@ -210,6 +220,7 @@ Retranslator::eventFilter( QObject* obj, QEvent* e )
 {
     if ( e->type() == QEvent::LanguageChange )
     {
+        ++s_translationGeneration;
         emit languageChanged();
     }
     // pass the event on to the base
@@ -223,10 +234,68 @@ Retranslator::instance()
     return &s_instance;
 }
 
+namespace
+{
+/** @brief Calls a retranslate-function for a widget, once it is visible
+ *
+ * Hidden widgets (e.g. the pages of ViewSteps that are not current)
+ * do not need new texts until they are shown. On a change of language,
+ * this calls the function right away for a visible widget, and otherwise
+ * waits for the widget's Show event. This is a child of the widget, so
+ * it goes away with it.
+ */
+class DeferredRetranslation : public QObject
+{
+public:
+    DeferredRetranslation( QObject* widget, std::function< void() > f )
+        : QObject( widget )
+        , m_f( std::move( f ) )
+    {
+        widget->installEventFilter( this );
+    }
+
+    void languageChanged()
+    {
+        if ( parent()->property( "visible" ).toBool() )
+        {
+            m_pending = false;
+            m_f();
+        }
+        else
+        {
+            m_pending = true;
+        }
+    }
+
+protected:
+    bool eventFilter( QObject* obj, QEvent* e ) override
+    {
+        if ( m_pending && obj == parent() && e->type() == QEvent::Show )
+        {
+            m_pending = false;
+            m_f();
+        }
+        return false;
+    }
+
+private:
+    std::function< void() > m_f;
+    bool m_pending = false;
+};
+}  // namespace
+
 void
 Retranslator::attach( QObject* o, std::function< void() > f )
 {
-    connect( instance(), &Retranslator::languageChanged, o, f );
+    if ( o->isWidgetType() )
+    {
+        auto* d = new DeferredRetranslation( o, f );
+        connect( instance(), &Retranslator::languageChanged, d, [ d ]() { d->languageChanged(); } );
+    }
+    else
+    {
+        connect( instance(), &Retranslator::languageChanged, o, f );
+    }
     f();
 }
 
@@ -43,6 +43,14 @@ DLLEXPORT void installTranslator();
  */
 DLLEXPORT CalamaresUtils::Locale::Translation::Id translatorLocaleName();
 
+/** @brief A number that changes each time the translations change
+ *
+ * This changes when a translator is installed, and on each change-of-language
+ * event that the Retranslator sees. Code that keeps translated strings around
+ * can compare it with the number it had when it translated them.
+ */
+DLLEXPORT int translationGeneration();
+
 /** @brief Loads <prefix><locale> translations into the given @p translator
  *
  * This function is not intended for general use: it is for those special
@@ -87,7 +95,12 @@ public:
     /// @brief Gets the global (single) Retranslator object
     static Retranslator* instance();
 
-    /// @brief Helper function for attaching lambdas
+    /** @brief Helper function for attaching lambdas
+     *
+     * Calls @p f now, and again for @p o whenever the language changes.
+     * If @p o is a widget that is hidden at that time, the call is
+     * deferred until the widget is shown.
+     */
     static void attach( QObject* o, std::function< void( void ) > f);
 
 signals:
@@ -128,18 +141,15 @@ private:
 /** @brief Call a slot in this object when language changes
  *
  * Given a slot (in method-function-pointer notation), call that slot when the
- * language changes. This is shorthand for connecting the Retranslator's
- * signal to the given slot.
+ * language changes. This is shorthand for attaching a lambda that calls
+ * the given slot, so (like the other macros) a hidden widget gets the
+ * call when it is shown.
  *
  * NOTE: unlike plain QObject::connect(), the slot is **also** called
  *       immediately after setting up the connection. This allows
  *       setup and translation code to be mixed together.
  */
 #define CALAMARES_RETRANSLATE_SLOT( slotfunc ) \
-    do \
-    { \
-        connect( CalamaresUtils::Retranslator::instance(), &CalamaresUtils::Retranslator::languageChanged, this, slotfunc ); \
-        (this->*slotfunc)(); \
-    } while ( false )
+    CalamaresUtils::Retranslator::attach( this, [=] { ( this->*slotfunc )(); } )
 
 #endif
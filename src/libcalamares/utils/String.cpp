@@ -19,68 +19,142 @@
 
 #include <QStringList>
 
+#include <algorithm>
+#include <array>
+#include <iterator>
+
 namespace CalamaresUtils
 {
+namespace
+{
+struct Diacritic
+{
+    char16_t letter;
+    const char* replacement;  ///< ASCII, at most two characters
+};
+
+// *INDENT-OFF*
+// clang-format off
+/// @brief Extended-Latin characters in U+00A0 .. U+017F, and their ASCII replacement
+constexpr Diacritic denseDiacritics[] = {
+        { u'¥', "Y" }, { u'µ', "u" }, { u'À', "A" }, { u'Á', "A" }, { u'Â', "A" }, { u'Ã', "A" },
+        { u'Ä', "A" }, { u'Å', "AA" }, { u'Æ', "AE" }, { u'Ç', "C" }, { u'È', "E" }, { u'É', "E" },
+        { u'Ê', "E" }, { u'Ë', "E" }, { u'Ì', "I" }, { u'Í', "I" }, { u'Î', "I" }, { u'Ï', "I" },
+        { u'Ð', "D" }, { u'Ñ', "N" }, { u'Ò', "O" }, { u'Ó', "O" }, { u'Ô', "O" }, { u'Õ', "O" },
+        { u'Ö', "E" }, { u'Ø', "OE" }, { u'Ù', "U" }, { u'Ú', "U" }, { u'Û', "U" }, { u'Ü', "E" },
+        { u'Ý', "Y" }, { u'Þ', "TH" }, { u'ß', "s" }, { u'à', "a" }, { u'á', "a" }, { u'â', "a" },
+        { u'ã', "a" }, { u'ä', "e" }, { u'å', "aa" }, { u'æ', "ae" }, { u'ç', "c" }, { u'è', "e" },
+        { u'é', "e" }, { u'ê', "e" }, { u'ë', "e" }, { u'ì', "i" }, { u'í', "i" }, { u'î', "i" },
+        { u'ï', "i" }, { u'ð', "d" }, { u'ñ', "n" }, { u'ò', "o" }, { u'ó', "o" }, { u'ô', "o" },
+        { u'õ', "o" }, { u'ö', "e" }, { u'ø', "oe" }, { u'ù', "u" }, { u'ú', "u" }, { u'û', "u" },
+        { u'ü', "e" }, { u'ý', "y" }, { u'þ', "th" }, { u'ÿ', "y" }, { u'Ā', "A" }, { u'ā', "a" },
+        { u'Ă', "A" }, { u'ă', "a" }, { u'Ą', "A" }, { u'ą', "a" }, { u'Ć', "C" }, { u'ć', "c" },
+        { u'Č', "C" }, { u'č', "c" }, { u'Ď', "D" }, { u'ď', "d" }, { u'Đ', "DJ" }, { u'đ', "dj" },
+        { u'Ē', "E" }, { u'ē', "e" }, { u'Ę', "E" }, { u'ę', "e" }, { u'Ě', "E" }, { u'ě', "e" },
+        { u'Ğ', "G" }, { u'ğ', "g" }, { u'Ī', "I" }, { u'ī', "i" }, { u'İ', "I" }, { u'ı', "i" },
+        { u'Ł', "L" }, { u'ł', "l" }, { u'Ń', "N" }, { u'ń', "n" }, { u'Ň', "N" }, { u'ň', "n" },
+        { u'Ō', "O" }, { u'ō', "o" }, { u'Ő', "O" }, { u'ő', "o" }, { u'Œ', "OE" }, { u'œ', "oe" },
+        { u'Ŕ', "R" }, { u'ŕ', "r" }, { u'Ř', "R" }, { u'ř', "r" }, { u'Ś', "S" }, { u'ś', "s" },
+        { u'Ş', "S" }, { u'ş', "s" }, { u'Š', "S" }, { u'š', "s" }, { u'Ţ', "T" }, { u'ţ', "t" },
+        { u'Ť', "T" }, { u'ť', "t" }, { u'Ū', "U" }, { u'ū', "u" }, { u'Ů', "U" }, { u'ů', "u" },
+        { u'Ű', "U" }, { u'ű', "u" }, { u'Ŵ', "W" }, { u'ŵ', "w" }, { u'Ŷ', "Y" }, { u'ŷ', "y" },
+        { u'Ÿ', "Y" }, { u'Ź', "Z" }, { u'ź', "z" }, { u'Ż', "Z" }, { u'ż', "z" }, { u'Ž', "Z" },
+        { u'ž', "z" },
+};
+/// @brief Other characters and their ASCII replacement, sorted
+constexpr Diacritic sparseDiacritics[] = {
+        { u'Ș', "S" }, { u'ș', "s" }, { u'Ț', "T" }, { u'ț', "t" }, { u'Ẁ', "W" }, { u'ẁ', "w" },
+        { u'Ẃ', "W" }, { u'ẃ', "w" },
+};
+// clang-format on
+// *INDENT-ON*
+
+constexpr char16_t denseFirst = 0x00A0;
+constexpr char16_t denseLast = 0x017F;
+constexpr int maxReplacement = 2;
+
+using DenseTable = std::array< const char*, denseLast - denseFirst + 1 >;
+
+/// @brief The replacement (or @c nullptr) for each character from denseFirst to denseLast
+constexpr DenseTable
+makeDenseTable()
+{
+    DenseTable table {};
+    for ( const auto& d : denseDiacritics )
+    {
+        table[ d.letter - denseFirst ] = d.replacement;
+    }
+    return table;
+}
+
+constexpr DenseTable denseTable = makeDenseTable();
+
+constexpr bool
+isValid()
+{
+    for ( const auto& d : denseDiacritics )
+    {
+        if ( d.letter < denseFirst || d.letter > denseLast || !d.replacement[ 0 ]
+             || ( d.replacement[ 1 ] && d.replacement[ 2 ] ) )
+        {
+            return false;
+        }
+    }
+    for ( std::size_t i = 0; i < sizeof( sparseDiacritics ) / sizeof( Diacritic ); ++i )
+    {
+        const auto& d = sparseDiacritics[ i ];
+        const bool sorted = i == 0 || sparseDiacritics[ i - 1 ].letter < d.letter;
+        if ( ( d.letter >= denseFirst && d.letter <= denseLast ) || !sorted || !d.replacement[ 0 ]
+             || ( d.replacement[ 1 ] && d.replacement[ 2 ] ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert( isValid(), "Diacritics tables must be sorted, and replacements must be 1 or 2 characters" );
+
+/// @brief The replacement for @p c, or @c nullptr if it stays as-is
+inline const char*
+replacementFor( char16_t c )
+{
+    if ( c < denseFirst )
+    {
+        return nullptr;
+    }
+    if ( c <= denseLast )
+    {
+        return denseTable[ c - denseFirst ];
+    }
+    const auto* end = std::end( sparseDiacritics );
+    const auto* it = std::lower_bound(
+        std::begin( sparseDiacritics ), end, c, []( const Diacritic& d, char16_t l ) { return d.letter < l; } );
+    return ( it != end && it->letter == c ) ? it->replacement : nullptr;
+}
+}  // namespace
+
 QString
 removeDiacritics( const QString& string )
 {
-    // *INDENT-OFF*
-    // clang-format off
-    // Map these extended-Latin characters to ASCII; keep the
-    // layout so that one line in *diacriticLetters* corresponds
-    // to one line of replacements in *noDiacriticLetters*.
-    static const QString diacriticLetters = QString::fromUtf8(
-        "ŠŒŽšœžŸ¥µÀ"
-        "ÁÂÃÄÅÆÇÈÉÊ"
-        "ËÌÍÎÏÐÑÒÓÔ"
-        "ÕÖØÙÚÛÜÝßà"
-        "áâãäåæçèéê"
-        "ëìíîïðñòóô"
-        "õöøùúûüýÿÞ"
-        "þČčĆćĐđŠšŽ"
-        "žŞşĞğİıȚțȘ"
-        "șĂăŐőŰűŘřĀ"
-        "āĒēĪīŌōŪūŢ"
-        "ţẀẁẂẃŴŵŶŷĎ"
-        "ďĚěŇňŤťŮůŔ"
-        "ŕĄąĘęŁłŃńŚ"
-        "śŹźŻż"
-    );
-    static const QStringList noDiacriticLetters = {
-        "S", "OE", "Z", "s", "oe", "z", "Y", "Y", "u", "A",
-        "A", "A", "A", "A", "AA", "AE", "C", "E", "E", "E",
-        "E", "I", "I", "I", "I", "D", "N", "O", "O", "O",
-        "O", "E", "OE", "U", "U", "U", "E", "Y", "s", "a",
-        "a", "a", "a", "e", "aa", "ae", "c", "e", "e", "e",
-        "e", "i", "i", "i", "i", "d", "n", "o", "o", "o",
-        "o", "e", "oe", "u", "u", "u", "e", "y", "y", "TH",
-        "th", "C", "c", "C", "c", "DJ", "dj", "S", "s", "Z",
-        "z", "S", "s", "G", "g", "I", "i", "T", "t", "S",
-        "s", "A", "a", "O", "o", "U", "u", "R", "r", "A",
-        "a", "E", "e", "I", "i", "O", "o", "U", "u", "T",
-        "t", "W", "w", "W", "w", "W", "w", "Y", "y", "D",
-        "d", "E", "e", "N", "n", "T", "t", "U", "u", "R",
-        "r", "A", "a", "E", "e", "L", "l", "N", "n", "S",
-        "s", "Z", "z", "Z", "z"
-    };
-    // clang-format on
-    // *INDENT-ON*
-
-    QString output;
+    // Each character is replaced by at most two, so this is the only allocation
+    QString output( string.length() * maxReplacement, Qt::Uninitialized );
+    QChar* out = output.data();
     for ( const QChar& c : string )
     {
-        int i = diacriticLetters.indexOf( c );
-        if ( i < 0 )
+        const char* replacement = replacementFor( c.unicode() );
+        if ( !replacement )
         {
-            output.append( c );
+            *out++ = c;
         }
         else
         {
-            QString replacement = noDiacriticLetters[ i ];
-            output.append( replacement );
+            for ( ; *replacement; ++replacement )
+            {
+                *out++ = QLatin1Char( *replacement );
+            }
         }
     }
-
+    output.resize( int( out - output.constData() ) );
     return output;
 }
 
@@ -0,0 +1,255 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "SystemTuning.h"
+
+#include "Logger.h"
+#include "Units.h"
+#include "Variant.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <cerrno>
+
+#include <sys/resource.h>
+#include <unistd.h>
+#ifdef Q_OS_LINUX
+#include <sys/syscall.h>
+#endif
+
+using namespace CalamaresUtils::Units;
+
+namespace CalamaresUtils
+{
+namespace SystemTuning
+{
+
+Profile
+Profile::fromMap( const QVariantMap& map )
+{
+    Profile p;
+    p.cpuGovernor = getString( map, "cpu-governor" );
+    p.ioScheduler = getString( map, "io-scheduler" );
+    p.dirtyLimits = getBool( map, "dirty-limits", false );
+    p.jobNice = int( qBound( -20LL, getInteger( map, "job-nice", 0 ), 19LL ) );
+    p.jobIoPriority = int( qBound( -1LL, getInteger( map, "job-io-priority", -1 ), 7LL ) );
+    p.uiNice = int( qBound( -20LL, getInteger( map, "ui-nice", 0 ), 19LL ) );
+    return p;
+}
+
+QPair< qint64, qint64 >
+dirtyLimits( qint64 ramB )
+{
+    const qint64 background = qBound( 16_MiB, ramB / 64, 256_MiB );
+    return { background, 4 * background };
+}
+
+QString
+automaticScheduler( bool rotational )
+{
+    return rotational ? QStringLiteral( "mq-deadline" ) : QStringLiteral( "none" );
+}
+
+void
+setThreadPriority( int nice, int ioPriority )
+{
+#ifdef Q_OS_LINUX
+    // On Linux, these are per-thread when given the thread id
+    if ( ::setpriority( PRIO_PROCESS, id_t( Logger::threadId() ), nice ) != 0 )
+    {
+        cWarning() << "Could not set the nice value of the job thread to" << nice;
+    }
+    if ( ioPriority >= 0 )
+    {
+        static constexpr const int ioprioWhoProcess = 1;
+        static constexpr const int ioprioBestEffort = 2 << 13;
+        ::syscall( SYS_ioprio_set, ioprioWhoProcess, 0, ioprioBestEffort | ioPriority );
+    }
+#else
+    Q_UNUSED( nice )
+    Q_UNUSED( ioPriority )
+#endif
+}
+
+/** @brief The current value in the contents of a sysfs or procfs file
+ *
+ * Files that list choices (e.g. a queue/scheduler with "[mq-deadline] none")
+ * mark the current one with brackets; otherwise it is the whole contents.
+ */
+static QByteArray
+currentValue( const QByteArray& contents )
+{
+    const int open = contents.indexOf( '[' );
+    const int close = contents.indexOf( ']', open );
+    if ( open >= 0 && close > open )
+    {
+        return contents.mid( open + 1, close - open - 1 );
+    }
+    return contents.trimmed();
+}
+
+/// @brief The choices listed in @p contents (e.g. "[mq-deadline] none"), without brackets
+static QList< QByteArray >
+choices( const QByteArray& contents )
+{
+    QByteArray plain = contents;
+    plain.replace( '[', ' ' ).replace( ']', ' ' );
+    return plain.simplified().split( ' ' );
+}
+
+Tuner::Tuner( const QString& root )
+    : m_root( root )
+{
+}
+
+Tuner::~Tuner()
+{
+    restore();
+}
+
+QString
+Tuner::path( const QString& relative ) const
+{
+    return QDir( m_root ).filePath( relative );
+}
+
+QByteArray
+Tuner::read( const QString& relative ) const
+{
+    QFile f( path( relative ) );
+    return f.open( QIODevice::ReadOnly ) ? f.readAll() : QByteArray();
+}
+
+bool
+Tuner::write( const QString& relative, const QByteArray& value )
+{
+    const QByteArray original = currentValue( read( relative ) );
+    if ( original == value )
+    {
+        return true;
+    }
+    QFile f( path( relative ) );
+    if ( !f.open( QIODevice::WriteOnly | QIODevice::Truncate ) || f.write( value ) != value.length() )
+    {
+        cDebug() << Logger::SubEntry << "Could not set" << relative << "to" << value;
+        return false;
+    }
+    m_saved.append( { relative, original } );
+    return true;
+}
+
+void
+Tuner::apply( const Profile& profile, qint64 ramB )
+{
+    cDebug() << "Tuning the system for the installation.";
+    if ( !profile.cpuGovernor.isEmpty() )
+    {
+        const QByteArray governor = profile.cpuGovernor.toLatin1();
+        const auto cpus = QDir( path( QStringLiteral( "sys/devices/system/cpu" ) ) )
+                              .entryList( { QStringLiteral( "cpu[0-9]*" ) }, QDir::Dirs );
+        for ( const auto& cpu : cpus )
+        {
+            const QString cpufreq = QStringLiteral( "sys/devices/system/cpu/%1/cpufreq/" ).arg( cpu );
+            if ( choices( read( cpufreq + QStringLiteral( "scaling_available_governors" ) ) ).contains( governor ) )
+            {
+                write( cpufreq + QStringLiteral( "scaling_governor" ), governor );
+            }
+        }
+    }
+
+    if ( !profile.ioScheduler.isEmpty() )
+    {
+        // Only disks with a device behind them, not loop, zram or dm devices
+        const auto disks = QDir( path( QStringLiteral( "sys/block" ) ) ).entryList( QDir::Dirs | QDir::NoDotAndDotDot );
+        for ( const auto& disk : disks )
+        {
+            const QString queue = QStringLiteral( "sys/block/%1/queue/" ).arg( disk );
+            if ( !QFileInfo::exists( path( QStringLiteral( "sys/block/%1/device" ).arg( disk ) ) ) )
+            {
+                continue;
+            }
+            const bool rotational = read( queue + QStringLiteral( "rotational" ) ).trimmed() != "0";
+            const QByteArray scheduler = ( profile.ioScheduler == QStringLiteral( "auto" )
+                                               ? automaticScheduler( rotational )
+                                               : profile.ioScheduler )
+                                             .toLatin1();
+            if ( choices( read( queue + QStringLiteral( "scheduler" ) ) ).contains( scheduler ) )
+            {
+                write( queue + QStringLiteral( "scheduler" ), scheduler );
+            }
+        }
+    }
+
+    if ( profile.dirtyLimits && ramB > 0 )
+    {
+        // Setting the byte limits sets the ratios to 0, so remember those first:
+        // they are restored last, which sets the byte limits to 0 again.
+        for ( const auto& ratio : { QStringLiteral( "proc/sys/vm/dirty_ratio" ),
+                                    QStringLiteral( "proc/sys/vm/dirty_background_ratio" ) } )
+        {
+            const QByteArray value = currentValue( read( ratio ) );
+            if ( !value.isEmpty() && value != "0" )
+            {
+                m_saved.append( { ratio, value } );
+            }
+        }
+        const auto limits = dirtyLimits( ramB );
+        // Background first, so that it is never above the blocking limit
+        write( QStringLiteral( "proc/sys/vm/dirty_background_bytes" ), QByteArray::number( limits.first ) );
+        write( QStringLiteral( "proc/sys/vm/dirty_bytes" ), QByteArray::number( limits.second ) );
+    }
+
+#ifdef Q_OS_LINUX
+    if ( profile.uiNice != 0 && !m_uiNiced )
+    {
+        errno = 0;
+        const int nice = ::getpriority( PRIO_PROCESS, id_t( Logger::threadId() ) );
+        if ( errno == 0 && ::setpriority( PRIO_PROCESS, id_t( Logger::threadId() ), profile.uiNice ) == 0 )
+        {
+            m_uiNiced = true;
+            m_uiNice = nice;
+            m_uiThread = Logger::threadId();
+        }
+    }
+#endif
+    cDebug() << Logger::SubEntry << m_saved.count() << "settings changed.";
+}
+
+void
+Tuner::restore()
+{
+    if ( m_saved.isEmpty() && !m_uiNiced )
+    {
+        return;
+    }
+    cDebug() << "Restoring" << m_saved.count() << "settings after the installation.";
+    while ( !m_saved.isEmpty() )
+    {
+        const auto saved = m_saved.takeLast();
+        QFile f( path( saved.first ) );
+        if ( !f.open( QIODevice::WriteOnly | QIODevice::Truncate ) || f.write( saved.second ) != saved.second.length() )
+        {
+            // e.g. writing 0 to dirty_bytes; restoring the ratio resets that anyway
+            cDebug() << Logger::SubEntry << "Could not restore" << saved.first << "to" << saved.second;
+        }
+    }
+#ifdef Q_OS_LINUX
+    if ( m_uiNiced )
+    {
+        ::setpriority( PRIO_PROCESS, id_t( m_uiThread ), m_uiNice );
+        m_uiNiced = false;
+    }
+#endif
+}
+
+}  // namespace SystemTuning
+}  // namespace CalamaresUtils
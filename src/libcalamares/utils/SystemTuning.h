@@ -0,0 +1,117 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+/** @file Tuning the live system while the jobs run
+ *
+ * The live system is set up for a desktop session, not for writing
+ * a whole operating system to disk: the CPU governor saves power,
+ * the I/O schedulers are the defaults, and the kernel lets a large
+ * part of RAM fill up with dirty pages before it writes them, which
+ * makes the writes to slow disks come in long stalls. An exec-phase
+ * tuning profile changes those while the JobQueue runs, and restores
+ * them afterwards.
+ */
+
+#ifndef UTILS_SYSTEMTUNING_H
+#define UTILS_SYSTEMTUNING_H
+
+#include "DllMacro.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVariantMap>
+
+namespace CalamaresUtils
+{
+namespace SystemTuning
+{
+
+/** @brief What to change while the jobs run
+ *
+ * This is the *exec-tuning* map from settings.conf.
+ */
+struct DLLEXPORT Profile
+{
+    QString cpuGovernor;  ///< For every CPU; empty to leave the governors alone
+    QString ioScheduler;  ///< For every disk; "auto" picks by kind of disk, empty leaves them alone
+    bool dirtyLimits = false;  ///< Limit the dirty pages, by the size of RAM
+    int jobNice = 0;  ///< Nice value of the threads that run jobs (and the commands they start)
+    int jobIoPriority = -1;  ///< Best-effort I/O priority (0-7) of those threads; -1 leaves it
+    int uiNice = 0;  ///< Nice value of the main (UI) thread
+
+    bool isEmpty() const
+    {
+        return cpuGovernor.isEmpty() && ioScheduler.isEmpty() && !dirtyLimits && jobNice == 0
+            && jobIoPriority < 0 && uiNice == 0;
+    }
+
+    static Profile fromMap( const QVariantMap& map );
+};
+
+/** @brief The dirty-page limits (background, and blocking) for @p ramB of RAM
+ *
+ * Writeback starts at 1/64th of the RAM (between 16MiB and 256MiB), and
+ * writers are throttled at four times that. That keeps the writes to
+ * a slow disk steady, instead of in bursts of gigabytes.
+ */
+DLLEXPORT QPair< qint64, qint64 > dirtyLimits( qint64 ramB );
+
+/** @brief The scheduler for "auto": none for solid-state disks, mq-deadline otherwise */
+DLLEXPORT QString automaticScheduler( bool rotational );
+
+/** @brief Sets the nice value and I/O priority of the calling thread
+ *
+ * A @p ioPriority of -1 leaves the I/O priority alone. Processes that
+ * the thread starts inherit both.
+ */
+DLLEXPORT void setThreadPriority( int nice, int ioPriority );
+
+/** @brief Applies a profile, and remembers what it changed
+ *
+ * The files are found below @p root (normally "/"), which is for tests.
+ * Settings that the kernel does not have (e.g. no cpufreq in a VM) or
+ * does not accept are skipped. restore() (or the destructor) writes
+ * back the original values, in reverse order.
+ */
+class DLLEXPORT Tuner
+{
+public:
+    explicit Tuner( const QString& root = QStringLiteral( "/" ) );
+    ~Tuner();
+
+    Tuner( const Tuner& ) = delete;
+    Tuner& operator=( const Tuner& ) = delete;
+
+    /// @brief Applies @p profile, for a machine with @p ramB of RAM; call from the UI thread
+    void apply( const Profile& profile, qint64 ramB );
+    /// @brief Writes back the original values, and the UI thread's nice value
+    void restore();
+
+    /// @brief The number of settings that are changed now
+    int changed() const { return m_saved.count(); }
+
+private:
+    /// @brief Writes @p value to @p path (relative to the root), remembering the old value
+    bool write( const QString& path, const QByteArray& value );
+    QByteArray read( const QString& path ) const;
+    QString path( const QString& relative ) const;
+
+    QString m_root;
+    QList< QPair< QString, QByteArray > > m_saved;  ///< Path and original value, in the order they were changed
+    bool m_uiNiced = false;
+    int m_uiNice = 0;  ///< Original nice value of the UI thread
+    long m_uiThread = 0;  ///< Thread id of the UI thread
+};
+
+}  // namespace SystemTuning
+}  // namespace CalamaresUtils
+
+#endif
@@ -10,22 +10,37 @@
  */
 
 #include "CalamaresUtilsSystem.h"
+#include "Checksum.h"
 #include "Entropy.h"
+#include "Executor.h"
+#include "FileCopy.h"
+#include "HardwareInfo.h"
 #include "Logger.h"
+#include "PageCache.h"
+#include "Permissions.h"
 #include "RAII.h"
+#include "ResourceUsage.h"
 #include "String.h"
+#include "SystemTuning.h"
 #include "Traits.h"
 #include "UMask.h"
+#include "Units.h"
 #include "Variant.h"
 #include "Yaml.h"
 
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 
+#include <QSemaphore>
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 
 #include <QtTest/QtTest>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -40,11 +55,21 @@ public:
 private Q_SLOTS:
     void initTestCase();
     void testDebugLevels();
+    void testDebugConcurrent();
+    void testDebugSkipsArguments();
 
     void testLoadSaveYaml();  // Just settings.conf
     void testLoadSaveYamlExtended();  // Do a find() in the src dir
+    void testYamlCache();
+    void testYamlScalars();
+    void benchYamlToVariant();
 
     void testCommands();
+    void testCommandsStreaming();
+    void testCommandArguments();
+    void testHardwareInfo();
+    void testReadDisks();
+    void testMemoryUsage();
 
     /** @section Test that all the UMask objects work correctly. */
     void testUmask();
@@ -53,6 +78,11 @@ private Q_SLOTS:
     void testEntropy();
     void testPrintableEntropy();
     void testOddSizedPrintable();
+    void testEntropyThreads();
+
+    /** @section Tests the executor lanes. */
+    void testExecutor();
+    void testExecutorCancel();
 
     /** @section Tests the RAII bits. */
     void testBoolSetter();
@@ -65,6 +95,25 @@ private Q_SLOTS:
     void testVariantStringListCode();
     void testVariantStringListYAMLDashed();
     void testVariantStringListYAMLBracketed();
+    void testVariantSubMap();
+
+    /** @section Tests the checksum of files. */
+    void testFilesChecksum();
+
+    /** @section Tests copying files. */
+    void testCopyFile();
+
+    /** @section Tests warming the page cache. */
+    void testPageCache();
+
+    /** @section Tests tuning the system for the installation. */
+    void testSystemTuning();
+
+    /** @section Tests owners and permissions. */
+    void testPermissionsAccounts();
+
+    /** @section Test replacing accented letters. */
+    void testRemoveDiacritics();
 
     /** @section Test smart string truncation. */
     void testStringTruncation();
@@ -104,6 +153,56 @@ LibCalamaresTests::testDebugLevels()
     }
 }
 
+void
+LibCalamaresTests::testDebugConcurrent()
+{
+    Logger::setupLogLevel( Logger::LOGDEBUG );
+
+    // More messages than fit in the ring at once, from several threads
+    std::vector< std::thread > threads;
+    for ( int t = 0; t < 4; ++t )
+    {
+        threads.emplace_back( [ t ]() {
+            for ( int i = 0; i < 1500; ++i )
+            {
+                cDebug() << "Thread" << t << "message" << i;
+            }
+        } );
+    }
+    for ( auto& t : threads )
+    {
+        t.join();
+    }
+    // Must not hang
+    Logger::flush();
+}
+
+void
+LibCalamaresTests::testDebugSkipsArguments()
+{
+    int evaluated = 0;
+    auto count = [ &evaluated ]() { return ++evaluated; };
+
+    Logger::setupLogLevel( Logger::LOGWARNING );
+    cDebug() << "Not logged" << count();
+    cVerbose() << "Not logged" << count();
+    QCOMPARE( evaluated, 0 );
+    cWarning() << "Logged" << count();
+    QCOMPARE( evaluated, 1 );
+
+    // The macros must not swallow an else
+    bool elseTaken = false;
+    if ( evaluated < 0 )
+        cWarning() << "Not reached";
+    else
+        elseTaken = true;
+    QVERIFY( elseTaken );
+
+    Logger::setupLogLevel( Logger::LOGDEBUG );
+    cDebug() << "Logged" << count();
+    QCOMPARE( evaluated, 2 );
+}
+
 void
 LibCalamaresTests::testLoadSaveYaml()
 {
@@ -212,6 +311,89 @@ LibCalamaresTests::testLoadSaveYamlExtended()
     QFile::remove( "out.yaml" );
 }
 
+void
+LibCalamaresTests::testYamlCache()
+{
+    QTemporaryDir tempRoot( QDir::tempPath() + QStringLiteral( "/test-yaml-cache-XXXXXX" ) );
+    QVERIFY( tempRoot.isValid() );
+    const QString yamlFile = tempRoot.filePath( "test.conf" );
+    const QString cacheFile = tempRoot.filePath( "yaml.cache" );
+    {
+        QFile f( yamlFile );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        f.write( "key: value\nlist: [ 1, 2, 3 ]\n" );
+    }
+
+    QVERIFY( !CalamaresUtils::loadYamlCache( cacheFile ) );  // Doesn't exist yet
+    bool ok = false;
+    const auto map = CalamaresUtils::loadYaml( yamlFile, &ok );
+    QVERIFY( ok );
+    QCOMPARE( map.value( "key" ).toString(), QStringLiteral( "value" ) );
+    QVERIFY( CalamaresUtils::saveYamlCache( cacheFile ) );
+
+    QVERIFY( CalamaresUtils::loadYamlCache( cacheFile ) );
+    QCOMPARE( CalamaresUtils::loadYaml( yamlFile, &ok ), map );
+    QVERIFY( ok );
+
+    // Changing the file (and its size) invalidates the entry
+    {
+        QFile f( yamlFile );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        f.write( "key: other\n" );
+    }
+    QCOMPARE( CalamaresUtils::loadYaml( yamlFile, &ok ).value( "key" ).toString(), QStringLiteral( "other" ) );
+}
+
+void
+LibCalamaresTests::testYamlScalars()
+{
+    auto scalar = []( const char* s ) { return CalamaresUtils::yamlScalarToVariant( YAML::Node( s ) ); };
+
+    for ( const char* s : { "true", "True", "TRUE", "on", "On", "ON" } )
+    {
+        QCOMPARE( scalar( s ), QVariant( true ) );
+    }
+    for ( const char* s : { "false", "False", "FALSE", "off", "Off", "OFF" } )
+    {
+        QCOMPARE( scalar( s ), QVariant( false ) );
+    }
+    QCOMPARE( scalar( "42" ), QVariant( 42LL ) );
+    QCOMPARE( scalar( "-17" ), QVariant( -17LL ) );
+    QCOMPARE( scalar( "+3" ), QVariant( 3LL ) );
+    QCOMPARE( scalar( "3.5" ), QVariant( 3.5 ) );
+    QCOMPARE( scalar( "-.25" ), QVariant( -0.25 ) );
+    for ( const char* s : { "tRUE", "onion", "5.", "1.2.3", "-", "+", ".", "12a", "", "0x10" } )
+    {
+        QCOMPARE( scalar( s ), QVariant( QString( s ) ) );
+    }
+}
+
+void
+LibCalamaresTests::benchYamlToVariant()
+{
+    // Something shaped like a (big) netinstall groups file
+    std::string yaml;
+    for ( int g = 0; g < 500; ++g )
+    {
+        yaml += "- name: \"Group " + std::to_string( g ) + "\"\n";
+        yaml += "  description: \"A group of packages\"\n  hidden: false\n  selected: on\n  packages:\n";
+        for ( int p = 0; p < 20; ++p )
+        {
+            yaml += "    - package-" + std::to_string( g ) + "-" + std::to_string( p ) + "\n";
+        }
+    }
+    const YAML::Node doc = YAML::Load( yaml );
+
+    QVariant v;
+    QBENCHMARK
+    {
+        v = CalamaresUtils::yamlToVariant( doc );
+    }
+    QCOMPARE( v.toList().count(), 500 );
+    QCOMPARE( v.toList().first().toMap().value( "packages" ).toList().count(), 20 );
+    QCOMPARE( v.toList().first().toMap().value( "selected" ), QVariant( true ) );
+}
+
 void
 LibCalamaresTests::testCommands()
 {
@@ -239,6 +421,205 @@ LibCalamaresTests::testCommands()
     QVERIFY( r.getOutput().contains( tfn.fileName() ) );
 }
 
+void
+LibCalamaresTests::testCommandsStreaming()
+{
+    using CalamaresUtils::System;
+
+    QStringList out;
+    QStringList err;
+    auto handler = [ &out, &err ]( System::OutputChannel c, const QString& line ) {
+        ( c == System::OutputChannel::StdOut ? out : err ).append( line );
+        return true;
+    };
+    auto r = System::runCommandStreaming(
+        System::RunLocation::RunInHost, { "/bin/sh", "-c", "echo one; echo two >&2; echo three" }, handler );
+    QCOMPARE( r.getExitCode(), 0 );
+    QCOMPARE( out, QStringList( { "one", "three" } ) );
+    QCOMPARE( err, QStringList { "two" } );
+
+    // Only the tail of the output is kept
+    r = System::runCommandStreaming(
+        System::RunLocation::RunInHost, { "/bin/sh", "-c", "seq 1 10" }, nullptr, QString(), QString(), {}, 2 );
+    QCOMPARE( r.getExitCode(), 0 );
+    QCOMPARE( r.getOutput(), QStringLiteral( "9\n10" ) );
+
+    // Cancel after the first line
+    int lines = 0;
+    r = System::runCommandStreaming( System::RunLocation::RunInHost,
+                                     { "/bin/sh", "-c", "echo one; sleep 10; echo two" },
+                                     [ &lines ]( System::OutputChannel, const QString& ) {
+                                         lines++;
+                                         return false;
+                                     } );
+    QCOMPARE( r.getExitCode(), static_cast< int >( CalamaresUtils::ProcessResult::Code::Cancelled ) );
+    QCOMPARE( lines, 1 );
+}
+
+void
+LibCalamaresTests::testCommandArguments()
+{
+    using CalamaresUtils::System;
+    auto shell = []( const QString& command ) { return QStringList { "/bin/sh", "-c", command }; };
+
+    QCOMPARE( System::commandArguments( "ls" ), QStringList { "ls" } );
+    QCOMPARE( System::commandArguments( "  ls   -l\t/tmp " ), QStringList( { "ls", "-l", "/tmp" } ) );
+    QCOMPARE( System::commandArguments( "echo 'a  b' \"c d\"e" ), QStringList( { "echo", "a  b", "c de" } ) );
+    QCOMPARE( System::commandArguments( "echo '$HOME'" ), QStringList( { "echo", "$HOME" } ) );
+    QCOMPARE( System::commandArguments( "mkfs --label=root /dev/sda1" ),
+              QStringList( { "mkfs", "--label=root", "/dev/sda1" } ) );
+    QCOMPARE( System::commandArguments( "echo ''" ), QStringList( { "echo", "" } ) );
+
+    // Everything that needs a shell
+    for ( const char* command : { "",
+                                  "   ",
+                                  "ls | wc",
+                                  "ls > /tmp/x",
+                                  "sleep 1 &",
+                                  "true; false",
+                                  "echo $HOME",
+                                  "echo \"$HOME\"",
+                                  "echo `date`",
+                                  "ls *.conf",
+                                  "ls ~",
+                                  "echo a\\ b",
+                                  "echo 'unterminated",
+                                  "LANG=C ls",
+                                  "cd /tmp",
+                                  "exit 1",
+                                  ":",
+                                  "command -v ls",
+                                  "type ls",
+                                  "readonly x=1",
+                                  "getopts ab opt",
+                                  "hash ls",
+                                  "break",
+                                  "continue",
+                                  "times",
+                                  "echo a # comment",
+                                  "echo one\necho two" } )
+    {
+        QCOMPARE( System::commandArguments( command ), shell( command ) );
+    }
+
+    // And both kinds run
+    QCOMPARE( System::runCommand( System::commandArguments( "echo 'one  two'" ), std::chrono::seconds( 5 ) ).second,
+              QStringLiteral( "one  two" ) );
+    QCOMPARE( System::runCommand( System::commandArguments( "exit 3" ), std::chrono::seconds( 5 ) ).first, 3 );
+    QCOMPARE( System::runCommand( System::commandArguments( "command -v sh" ), std::chrono::seconds( 5 ) ).first, 0 );
+    QCOMPARE( System::runCommand( System::commandArguments( ":" ), std::chrono::seconds( 5 ) ).first, 0 );
+}
+
+void
+LibCalamaresTests::testHardwareInfo()
+{
+    const auto& info = CalamaresUtils::HardwareInfo::instance();
+    QCOMPARE( &info, &CalamaresUtils::HardwareInfo::instance() );
+
+#ifdef Q_OS_LINUX
+    QVERIFY( info.totalMemoryB() > 0 );
+    QVERIFY( !info.cpuVendor().isEmpty() || !info.cpuImplementer().isEmpty() );
+    QVERIFY( !info.cpuModel().startsWith( ':' ) );
+    QCOMPARE( info.isEfi(), QDir( "/sys/firmware/efi/efivars" ).exists() );
+#endif
+
+    Calamares::GlobalStorage gs;
+    CalamaresUtils::HardwareInfo::prefetch( &gs );
+    QTRY_VERIFY( gs.contains( CalamaresUtils::HardwareInfo::globalStorageKey() ) );
+    const auto map = gs.value( CalamaresUtils::HardwareInfo::globalStorageKey() ).toMap();
+    QCOMPARE( map, info.toMap() );
+    QCOMPARE( map.value( "memoryB" ).toULongLong(), info.totalMemoryB() );
+    QCOMPARE( map.value( "isEfi" ).toBool(), info.isEfi() );
+}
+
+void
+LibCalamaresTests::testReadDisks()
+{
+    using Disk = CalamaresUtils::HardwareInfo::Disk;
+
+    QTemporaryDir d;
+    QVERIFY( d.isValid() );
+    QVERIFY( CalamaresUtils::HardwareInfo::readDisks( d.path() ).isEmpty() );  // No sysfs at all
+
+    auto put = [ &d ]( const QString& path, const QByteArray& contents ) {
+        QVERIFY( QDir( d.path() ).mkpath( QFileInfo( path ).path() ) );
+        QFile f( d.filePath( path ) );
+        QVERIFY( f.open( QIODevice::WriteOnly | QIODevice::Truncate ) );
+        f.write( contents );
+    };
+    // A hard disk, a USB stick, a DVD drive, a zram and a loop device
+    put( "sys/block/sda/device/vendor", "ATA\n" );
+    put( "sys/block/sda/size", "1953525168\n" );
+    put( "sys/block/sda/removable", "0\n" );
+    put( "sys/block/sda/ro", "0\n" );
+    put( "sys/block/sda/queue/rotational", "1\n" );
+    put( "sys/block/sdb/device/vendor", "Generic\n" );
+    put( "sys/block/sdb/size", "15728640\n" );
+    put( "sys/block/sdb/removable", "1\n" );
+    put( "sys/block/sdb/ro", "0\n" );
+    put( "sys/block/sdb/queue/rotational", "0\n" );
+    put( "sys/block/sr0/device/vendor", "HL-DT-ST\n" );
+    put( "sys/block/sr0/ro", "1\n" );
+    put( "sys/block/zram0/size", "8388608\n" );
+    put( "sys/block/loop0/device/vendor", "\n" );  // Not really, but loop is skipped by name
+
+    const auto disks = CalamaresUtils::HardwareInfo::readDisks( d.path() );
+    QCOMPARE( disks.count(), 3 );
+    const Disk& sda = disks.at( 0 );
+    QCOMPARE( sda.node, QStringLiteral( "/dev/sda" ) );
+    QCOMPARE( sda.sizeB, 1953525168LL * 512 );
+    QVERIFY( !sda.removable && !sda.readOnly && sda.rotational && !sda.mediaDrive );
+    const Disk& sdb = disks.at( 1 );
+    QCOMPARE( sdb.node, QStringLiteral( "/dev/sdb" ) );
+    QCOMPARE( sdb.sizeB, 8053063680LL );
+    QVERIFY( sdb.removable && !sdb.readOnly && !sdb.rotational && !sdb.mediaDrive );
+    const Disk& sr0 = disks.at( 2 );
+    QCOMPARE( sr0.node, QStringLiteral( "/dev/sr0" ) );
+    QCOMPARE( sr0.sizeB, qint64( 0 ) );  // No size file
+    QVERIFY( sr0.readOnly && sr0.mediaDrive );
+
+#ifdef Q_OS_LINUX
+    const auto& info = CalamaresUtils::HardwareInfo::instance();
+    QCOMPARE( info.disks().count(), info.toMap().value( "disks" ).toList().count() );
+#endif
+}
+
+void
+LibCalamaresTests::testMemoryUsage()
+{
+    using CalamaresUtils::MemoryUsage;
+
+    const auto rollup = MemoryUsage::fromProc( "55d0c9e43000-7ffd8a5fe000 ---p 00000000 00:00 0   [rollup]\n"
+                                               "Rss:              102400 kB\n"
+                                               "Pss:               51200 kB\n"
+                                               "Pss_Anon:          20000 kB\n"
+                                               "Anonymous:         40960 kB\n"
+                                               "Swap:                  8 kB\n" );
+    QCOMPARE( rollup.rss, qint64( 100 ) * 1024 * 1024 );
+    QCOMPARE( rollup.pss, qint64( 50 ) * 1024 * 1024 );
+    QCOMPARE( rollup.anonymous, qint64( 40 ) * 1024 * 1024 );
+    QCOMPARE( rollup.swap, qint64( 8 ) * 1024 );
+
+    const auto status = MemoryUsage::fromProc( "Name:\tcalamares\nVmPeak:\t  900000 kB\nVmRSS:\t   1024 kB\n"
+                                               "RssAnon:\t    512 kB\nVmSwap:\t       0 kB\n" );
+    QCOMPARE( status.rss, qint64( 1024 ) * 1024 );
+    QCOMPARE( status.pss, qint64( 0 ) );
+    QCOMPARE( status.anonymous, qint64( 512 ) * 1024 );
+    QCOMPARE( status.swap, qint64( 0 ) );
+
+    const auto d = status.delta( rollup );
+    QCOMPARE( d.rss, status.rss - rollup.rss );
+    QVERIFY( d.rss < 0 );
+    QCOMPARE( d.toMap().value( "anonymous" ).toLongLong(), status.anonymous - rollup.anonymous );
+
+#ifdef Q_OS_LINUX
+    // This test itself is resident
+    const auto now = MemoryUsage::sample();
+    QVERIFY( now.rss > 0 );
+    QVERIFY( now.anonymous > 0 );
+#endif
+}
+
 void
 LibCalamaresTests::testUmask()
 {
@@ -340,6 +721,119 @@ LibCalamaresTests::testOddSizedPrintable()
     }
 }
 
+void
+LibCalamaresTests::testEntropyThreads()
+{
+    // Small requests come from a shared pool; no two threads may get the same bytes
+    constexpr int threadCount = 8;
+    constexpr int requestCount = 100;
+    std::vector< QList< QByteArray > > results( threadCount );
+    std::vector< std::thread > threads;
+    for ( int t = 0; t < threadCount; ++t )
+    {
+        threads.emplace_back( [ &results, t ]() {
+            for ( int i = 0; i < requestCount; ++i )
+            {
+                QByteArray data;
+                CalamaresUtils::getEntropy( 16, data );
+                results[ t ].append( data );
+            }
+        } );
+    }
+    for ( auto& t : threads )
+    {
+        t.join();
+    }
+
+    QSet< QByteArray > seen;
+    for ( const auto& l : results )
+    {
+        for ( const auto& data : l )
+        {
+            QCOMPARE( data.size(), 16 );
+            QVERIFY( !seen.contains( data ) );
+            seen.insert( data );
+        }
+    }
+    QCOMPARE( seen.count(), threadCount * requestCount );
+}
+
+void
+LibCalamaresTests::testExecutor()
+{
+    namespace Executor = CalamaresUtils::Executor;
+    using Executor::Lane;
+
+    QFuture< int > f = Executor::run( Lane::Background, "test", []() { return 42; } );
+    QCOMPARE( f.result(), 42 );
+
+    // The lanes have separate pools
+    QVERIFY( Executor::pool( Lane::Interactive ) != Executor::pool( Lane::BulkIO ) );
+    QCOMPARE( Executor::pool( Lane::BulkIO )->maxThreadCount(), 2 );
+    QVERIFY( Executor::pool( Lane::Interactive )->maxThreadCount() >= 2 );
+
+    // Interactive tasks run while the bulk lane is full
+    QSemaphore release;
+    QList< QFuture< void > > bulk;
+    for ( int i = 0; i < 2; ++i )
+    {
+        bulk.append( Executor::run( Lane::BulkIO, "test-bulk", [ &release ]() { release.acquire(); } ) );
+    }
+    auto thread = []() { return QThread::currentThread(); };
+    QFuture< QThread* > interactive = Executor::run( Lane::Interactive, "test", thread );
+    QVERIFY( interactive.result() != QThread::currentThread() );
+    release.release( 2 );
+    for ( auto& b : bulk )
+    {
+        b.waitForFinished();
+    }
+}
+
+void
+LibCalamaresTests::testExecutorCancel()
+{
+    namespace Executor = CalamaresUtils::Executor;
+    using Executor::Cancellation;
+    using Executor::Lane;
+
+    // Copies share the flag
+    Cancellation c;
+    Cancellation copy( c );
+    QVERIFY( !copy.isCancelled() );
+    c.cancel();
+    QVERIFY( copy.isCancelled() );
+
+    // Keep the bulk lane busy, so that the cancelled task has not started
+    QSemaphore release;
+    QList< QFuture< void > > bulk;
+    for ( int i = 0; i < 2; ++i )
+    {
+        bulk.append( Executor::run( Lane::BulkIO, "test-bulk", [ &release ]() { release.acquire(); } ) );
+    }
+
+    std::atomic< int > ran { 0 };
+    Cancellation later;
+    Cancellation never;
+    QFuture< int > cancelled = Executor::run( Lane::BulkIO, "test", later, [ &ran ]( const Cancellation& ) {
+        ++ran;
+        return 1;
+    } );
+    QFuture< int > kept = Executor::run( Lane::BulkIO, "test", never, [ &ran ]( const Cancellation& ) {
+        ++ran;
+        return 2;
+    } );
+    later.cancel();
+    release.release( 2 );
+
+    QCOMPARE( cancelled.result(), 0 );
+    QCOMPARE( kept.result(), 2 );
+    QCOMPARE( ran.load(), 1 );
+    for ( auto& b : bulk )
+    {
+        b.waitForFinished();
+    }
+}
+
 void
 LibCalamaresTests::testBoolSetter()
 {
@@ -507,6 +1001,28 @@ LibCalamaresTests::testVariantStringListCode()
     }
 }
 
+void
+LibCalamaresTests::testVariantSubMap()
+{
+    using namespace CalamaresUtils;
+
+    QVariantMap inner { { "key", QStringLiteral( "value" ) } };
+    QVariantMap m { { "inner", inner }, { "string", QStringLiteral( "inner" ) } };
+
+    QVERIFY( !subMap( m, "string" ) );
+    QVERIFY( !subMap( m, "missing" ) );
+    const auto* sub = subMap( m, "inner" );
+    QVERIFY( sub );
+    QCOMPARE( *sub, inner );
+    QCOMPARE( getString( *sub, "key" ), QStringLiteral( "value" ) );
+
+    bool ok = false;
+    QCOMPARE( getSubMap( m, "inner", ok ), inner );
+    QVERIFY( ok );
+    QCOMPARE( getSubMap( m, "string", ok ), QVariantMap() );
+    QVERIFY( !ok );
+}
+
 void
 LibCalamaresTests::testVariantStringListYAMLDashed()
 {
@@ -560,6 +1076,282 @@ strings: [ aap, noot, mies ]
     QVERIFY( !getStringList( m, key ).contains( "lam" ) );
 }
 
+void
+LibCalamaresTests::testFilesChecksum()
+{
+    QTemporaryDir a;
+    QTemporaryDir b;
+    QVERIFY( a.isValid() && b.isValid() );
+    for ( const auto* root : { &a, &b } )
+    {
+        QVERIFY( QDir( root->path() ).mkpath( "etc/conf.d" ) );
+        for ( const auto& name : { "etc/main.conf", "etc/conf.d/one", "etc/conf.d/two" } )
+        {
+            QFile f( root->filePath( name ) );
+            QVERIFY( f.open( QIODevice::WriteOnly ) );
+            f.write( QByteArray( name ) );
+        }
+    }
+
+    const QStringList paths { "/etc/main.conf", "/etc/conf.d", "/etc/missing" };
+    const auto checksum = CalamaresUtils::filesChecksum( a.path(), paths );
+    QCOMPARE( checksum.length(), 64 );
+    QCOMPARE( CalamaresUtils::filesChecksum( b.path() + '/', paths ), checksum );
+    // Path order matters, and relative paths are relative to the root
+    QVERIFY( CalamaresUtils::filesChecksum( a.path(), { "/etc/conf.d", "/etc/main.conf" } ) != checksum );
+    QCOMPARE( CalamaresUtils::filesChecksum( a.path(), { "etc/main.conf", "etc/conf.d", "etc/missing" } ),
+              checksum );
+
+    {
+        // Same size, different contents
+        QFile f( b.filePath( "etc/conf.d/two" ) );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        f.write( QByteArray( "etc/conf.d/TWO" ) );
+    }
+    QVERIFY( CalamaresUtils::filesChecksum( b.path(), paths ) != checksum );
+    QVERIFY( QFile::remove( b.filePath( "etc/conf.d/two" ) ) );
+    QVERIFY( CalamaresUtils::filesChecksum( b.path(), paths ) != checksum );
+
+    {
+        // A file appears where there was none
+        QFile f( a.filePath( "etc/missing" ) );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+    }
+    QVERIFY( CalamaresUtils::filesChecksum( a.path(), paths ) != checksum );
+}
+
+void
+LibCalamaresTests::testPermissionsAccounts()
+{
+    QTemporaryDir root;
+    QVERIFY( root.isValid() );
+    QVERIFY( QDir( root.path() ).mkpath( "etc" ) );
+
+    const QString me = QString::number( getuid() );
+    const QString mine = QString::number( getgid() );
+    auto writeFile = [ &root ]( const char* name, const QByteArray& contents ) {
+        QFile f( QDir( root.path() ).filePath( name ) );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        f.write( contents );
+    };
+    writeFile( "etc/passwd",
+               "root:x:0:0:root:/root:/bin/bash\n"
+               "tester:x:"
+                   + me.toLatin1()
+                   + ":100::/home/tester:/bin/sh\n"
+                     "tester:x:9999:100::/nowhere:/bin/sh\n" );
+    writeFile( "etc/group", "root:x:0:\ntesters:x:" + mine.toLatin1() + ":tester\n" );
+
+    {
+        CalamaresUtils::AccountIds ids( root.path() );
+        QCOMPARE( ids.userId( "root" ), qint64( 0 ) );
+        QCOMPARE( ids.userId( "tester" ), qint64( getuid() ) );  // First one wins
+        QCOMPARE( ids.userId( "nobody-at-all" ), qint64( -1 ) );
+        QCOMPARE( ids.userId( "1234" ), qint64( 1234 ) );
+        QCOMPARE( ids.groupId( "testers" ), qint64( getgid() ) );
+        QCOMPARE( ids.groupId( "tester" ), qint64( -1 ) );
+    }
+
+    // Own user and group, so this works without being root
+    QStringList paths;
+    for ( const char* name : { "a", "b", "c" } )
+    {
+        QFile f( QDir( root.path() ).filePath( name ) );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        paths.append( f.fileName() );
+    }
+    using CalamaresUtils::Permissions;
+    QVERIFY( Permissions::apply( paths, Permissions( "tester:testers:0640" ), root.path() ) );
+    for ( const auto& path : paths )
+    {
+        struct stat st;
+        QCOMPARE( stat( QFile::encodeName( path ).constData(), &st ), 0 );
+        QCOMPARE( int( st.st_mode & 07777 ), 0640 );
+        QCOMPARE( st.st_uid, getuid() );
+    }
+    QVERIFY( !Permissions::apply( paths, Permissions( "nobody-at-all:testers:0640" ), root.path() ) );
+    QVERIFY( !Permissions::apply( paths, Permissions(), root.path() ) );
+
+    // A changed passwd file is read again
+    QTest::qSleep( 1100 );  // Modification times may have 1s resolution
+    writeFile( "etc/passwd", "someone:x:4321:100::/:/bin/sh\n" );
+    CalamaresUtils::AccountIds ids( root.path() );
+    QCOMPARE( ids.userId( "someone" ), qint64( 4321 ) );
+    QCOMPARE( ids.userId( "tester" ), qint64( -1 ) );
+}
+
+void
+LibCalamaresTests::testCopyFile()
+{
+    QTemporaryDir d;
+    QVERIFY( d.isValid() );
+
+    // Larger than one chunk, in case the data goes through a buffer
+    QByteArray data;
+    QVERIFY( CalamaresUtils::getEntropy( 3 * 1024 * 1024 + 17, data ) != CalamaresUtils::EntropySource::None );
+    {
+        QFile f( d.filePath( "source" ) );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        QCOMPARE( f.write( data ), data.length() );
+        f.close();
+        QVERIFY( f.setPermissions( QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup ) );
+    }
+
+    QVERIFY( CalamaresUtils::copyFile( d.filePath( "source" ), d.filePath( "dest" ) ) );
+    {
+        QFile f( d.filePath( "dest" ) );
+        QVERIFY( f.open( QIODevice::ReadOnly ) );
+        QCOMPARE( f.readAll(), data );
+        QCOMPARE( f.permissions() & ( QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup | QFile::ReadOther ),
+                  QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup );
+    }
+
+    {
+        // An existing (longer) destination is overwritten
+        QFile f( d.filePath( "short" ) );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        f.write( "Hello" );
+    }
+    QVERIFY( CalamaresUtils::copyFile( d.filePath( "short" ), d.filePath( "dest" ) ) );
+    QCOMPARE( QFileInfo( d.filePath( "dest" ) ).size(), 5 );
+
+    QVERIFY( !CalamaresUtils::copyFile( d.filePath( "missing" ), d.filePath( "dest2" ) ) );
+    QVERIFY( !QFile::exists( d.filePath( "dest2" ) ) );
+
+    // Without the mode of the source, a new file gets the mode from the umask
+    QVERIFY( QFile::setPermissions( d.filePath( "short" ), QFile::ReadOwner ) );
+    QVERIFY( CalamaresUtils::copyFile(
+        d.filePath( "short" ), d.filePath( "dest3" ), CalamaresUtils::CopyPermissions::Default ) );
+    QVERIFY( QFileInfo( d.filePath( "dest3" ) ).permissions() & QFile::WriteOwner );
+    QCOMPARE( QFileInfo( d.filePath( "dest3" ) ).size(), 5 );
+
+    // Files in /proc have no size, but they do have contents
+    if ( QFileInfo( "/proc/self/status" ).exists() )
+    {
+        QCOMPARE( QFileInfo( "/proc/self/status" ).size(), 0 );
+        QVERIFY( CalamaresUtils::copyFile( "/proc/self/status", d.filePath( "status" ) ) );
+        QVERIFY( QFileInfo( d.filePath( "status" ) ).size() > 0 );
+    }
+}
+
+void
+LibCalamaresTests::testPageCache()
+{
+    QTemporaryDir d;
+    QVERIFY( d.isValid() );
+
+    // More than one chunk, and not a whole number of them
+    QByteArray data( 5 * 1024 * 1024 + 17, 'c' );
+    {
+        QFile f( d.filePath( "image" ) );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        QCOMPARE( f.write( data ), data.length() );
+    }
+
+    // Stops early if memory is tight, but never reads past the end
+    const qint64 warmed = CalamaresUtils::PageCache::warm( d.filePath( "image" ) );
+    QVERIFY( warmed >= 0 );
+    QVERIFY( warmed <= data.length() );
+
+    // Not files, so nothing to do
+    QCOMPARE( CalamaresUtils::PageCache::warm( d.path() ), 0 );
+    QCOMPARE( CalamaresUtils::PageCache::warm( d.filePath( "missing" ) ), 0 );
+}
+
+void
+LibCalamaresTests::testSystemTuning()
+{
+    using namespace CalamaresUtils::SystemTuning;
+    using namespace CalamaresUtils::Units;
+
+    QCOMPARE( dirtyLimits( 512_MiB ), qMakePair( 16_MiB, 64_MiB ) );
+    QCOMPARE( dirtyLimits( 4_GiB ), qMakePair( 64_MiB, 256_MiB ) );
+    QCOMPARE( dirtyLimits( 64_GiB ), qMakePair( 256_MiB, 1024_MiB ) );
+    QCOMPARE( automaticScheduler( true ), QStringLiteral( "mq-deadline" ) );
+    QCOMPARE( automaticScheduler( false ), QStringLiteral( "none" ) );
+
+    QVERIFY( Profile::fromMap( QVariantMap() ).isEmpty() );
+    const Profile profile = Profile::fromMap( QVariantMap { { "cpu-governor", "performance" },
+                                                            { "io-scheduler", "auto" },
+                                                            { "dirty-limits", true },
+                                                            { "job-nice", 40 },
+                                                            { "job-io-priority", 2 } } );
+    QVERIFY( !profile.isEmpty() );
+    QCOMPARE( profile.cpuGovernor, QStringLiteral( "performance" ) );
+    QCOMPARE( profile.jobNice, 19 );  // Clamped
+    QCOMPARE( profile.jobIoPriority, 2 );
+    QCOMPARE( profile.uiNice, 0 );
+
+    // A fake sysfs and procfs, with one CPU, one disk and a loop device
+    QTemporaryDir d;
+    QVERIFY( d.isValid() );
+    auto put = [ &d ]( const QString& path, const QByteArray& contents ) {
+        QVERIFY( QDir( d.path() ).mkpath( QFileInfo( path ).path() ) );
+        QFile f( d.filePath( path ) );
+        QVERIFY( f.open( QIODevice::WriteOnly | QIODevice::Truncate ) );
+        f.write( contents );
+    };
+    auto get = [ &d ]( const QString& path ) {
+        QFile f( d.filePath( path ) );
+        return f.open( QIODevice::ReadOnly ) ? f.readAll().trimmed() : QByteArray();
+    };
+    put( "sys/devices/system/cpu/cpu0/cpufreq/scaling_available_governors", "performance powersave\n" );
+    put( "sys/devices/system/cpu/cpu0/cpufreq/scaling_governor", "powersave\n" );
+    put( "sys/block/sda/device/vendor", "ATA\n" );
+    put( "sys/block/sda/queue/rotational", "0\n" );
+    put( "sys/block/sda/queue/scheduler", "[mq-deadline] none\n" );
+    put( "sys/block/loop0/queue/rotational", "0\n" );
+    put( "sys/block/loop0/queue/scheduler", "[mq-deadline] none\n" );
+    put( "proc/sys/vm/dirty_ratio", "20\n" );
+    put( "proc/sys/vm/dirty_background_ratio", "10\n" );
+    put( "proc/sys/vm/dirty_bytes", "0\n" );
+    put( "proc/sys/vm/dirty_background_bytes", "0\n" );
+
+    {
+        Tuner tuner( d.path() );
+        tuner.apply( profile, 4_GiB );
+        QCOMPARE( get( "sys/devices/system/cpu/cpu0/cpufreq/scaling_governor" ), QByteArray( "performance" ) );
+        QCOMPARE( get( "sys/block/sda/queue/scheduler" ), QByteArray( "none" ) );
+        // Not a disk
+        QCOMPARE( get( "sys/block/loop0/queue/scheduler" ), QByteArray( "[mq-deadline] none" ) );
+        QCOMPARE( get( "proc/sys/vm/dirty_background_bytes" ), QByteArray::number( 64_MiB ) );
+        QCOMPARE( get( "proc/sys/vm/dirty_bytes" ), QByteArray::number( 256_MiB ) );
+        // Governor, scheduler, two ratios and two byte limits
+        QCOMPARE( tuner.changed(), 6 );
+
+        tuner.restore();
+        QCOMPARE( tuner.changed(), 0 );
+        QCOMPARE( get( "sys/devices/system/cpu/cpu0/cpufreq/scaling_governor" ), QByteArray( "powersave" ) );
+        QCOMPARE( get( "sys/block/sda/queue/scheduler" ), QByteArray( "mq-deadline" ) );
+        QCOMPARE( get( "proc/sys/vm/dirty_ratio" ), QByteArray( "20" ) );
+        QCOMPARE( get( "proc/sys/vm/dirty_background_ratio" ), QByteArray( "10" ) );
+
+        // A governor that is not available is left alone
+        Profile other;
+        other.cpuGovernor = QStringLiteral( "ondemand" );
+        tuner.apply( other, 4_GiB );
+        QCOMPARE( tuner.changed(), 0 );
+        QCOMPARE( get( "sys/devices/system/cpu/cpu0/cpufreq/scaling_governor" ), QByteArray( "powersave" ) );
+    }
+}
+
+void
+LibCalamaresTests::testRemoveDiacritics()
+{
+    using CalamaresUtils::removeDiacritics;
+
+    QCOMPARE( removeDiacritics( QString() ), QString() );
+    QCOMPARE( removeDiacritics( QStringLiteral( "plain ASCII, 123" ) ), QStringLiteral( "plain ASCII, 123" ) );
+    // Latin-1 and Latin Extended-A, some to two letters
+    QCOMPARE( removeDiacritics( QStringLiteral( "Ærøskøbing" ) ), QStringLiteral( "AEroeskoebing" ) );
+    QCOMPARE( removeDiacritics( QStringLiteral( "Đorđe Łukasz Œuvre" ) ), QStringLiteral( "DJordje Lukasz OEuvre" ) );
+    QCOMPARE( removeDiacritics( QStringLiteral( "þorn ÿ" ) ), QStringLiteral( "thorn y" ) );
+    // Outside of those ranges
+    QCOMPARE( removeDiacritics( QStringLiteral( "Ștefan Țepeș Ẃẁ" ) ), QStringLiteral( "Stefan Tepes Ww" ) );
+    // Not replaced
+    QCOMPARE( removeDiacritics( QStringLiteral( "¡¿ Ɓ Я 日本" ) ), QStringLiteral( "¡¿ Ɓ Я 日本" ) );
+}
+
 void
 LibCalamaresTests::testStringTruncation()
 {
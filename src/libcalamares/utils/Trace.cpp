@@ -0,0 +1,207 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+#include "Trace.h"
+
+#include "utils/Logger.h"
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSaveFile>
+#include <QVector>
+
+#include <algorithm>
+#include <atomic>
+
+
+namespace CalamaresUtils
+{
+namespace Trace
+{
+
+struct Event
+{
+    QString name;
+    const char* category;
+    char phase;  ///< 'X' is a complete event, 'i' is instant
+    qint64 start;  ///< Microseconds since tracing started
+    qint64 duration;
+    long thread;
+};
+
+static std::atomic< bool > s_enabled { false };
+static QMutex s_mutex;
+static QElapsedTimer s_clock;
+static QString s_filename;
+static QVector< Event > s_events;
+
+static qint64
+now()
+{
+    return s_clock.nsecsElapsed() / 1000;
+}
+
+static void
+record( const QString& name, const char* category, char phase, qint64 start, qint64 duration )
+{
+    QMutexLocker lock( &s_mutex );
+    s_events.append( Event { name, category, phase, start, duration, Logger::threadId() } );
+}
+
+void
+enable( const QString& filename )
+{
+    QMutexLocker lock( &s_mutex );
+    s_filename = filename;
+    s_clock.start();
+    s_enabled = true;
+}
+
+bool
+isEnabled()
+{
+    return s_enabled;
+}
+
+void
+instant( const QString& name, const char* category )
+{
+    if ( s_enabled )
+    {
+        record( name, category, 'i', now(), 0 );
+    }
+}
+
+bool
+save()
+{
+    if ( !s_enabled )
+    {
+        return false;
+    }
+
+    QMutexLocker lock( &s_mutex );
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray events;
+    for ( const auto& e : s_events )
+    {
+        QJsonObject o { { "name", e.name },
+                        { "cat", QString::fromLatin1( e.category ) },
+                        { "ph", QString( QChar( e.phase ) ) },
+                        { "ts", e.start },
+                        { "pid", pid },
+                        { "tid", qint64( e.thread ) } };
+        if ( e.phase == 'X' )
+        {
+            o.insert( "dur", e.duration );
+        }
+        else
+        {
+            o.insert( "s", "t" );  // Instant events are thread-scoped
+        }
+        events.append( o );
+    }
+
+    QSaveFile f( s_filename );
+    if ( !f.open( QIODevice::WriteOnly )
+         || f.write( QJsonDocument( QJsonObject { { "traceEvents", events } } ).toJson( QJsonDocument::Compact ) ) < 0
+         || !f.commit() )
+    {
+        cWarning() << "Could not write trace file" << s_filename;
+        return false;
+    }
+    cDebug() << "Wrote" << s_events.count() << "trace events to" << s_filename;
+    return true;
+}
+
+QVariantMap
+summary( int count )
+{
+    if ( !s_enabled )
+    {
+        return QVariantMap();
+    }
+
+    struct Total
+    {
+        QString name;
+        int count = 0;
+        qint64 duration = 0;
+    };
+    QVector< Total > totals;
+    QHash< QString, int > indexOf;
+    QVariantList instants;
+    {
+        QMutexLocker lock( &s_mutex );
+        for ( const auto& e : qAsConst( s_events ) )
+        {
+            if ( e.phase != 'X' )
+            {
+                instants.append( QVariantMap { { "name", e.name }, { "at", e.start / 1000 } } );
+                continue;
+            }
+            auto it = indexOf.find( e.name );
+            if ( it == indexOf.end() )
+            {
+                it = indexOf.insert( e.name, totals.count() );
+                totals.append( Total { e.name, 0, 0 } );
+            }
+            totals[ it.value() ].count++;
+            totals[ it.value() ].duration += e.duration;
+        }
+    }
+
+    std::stable_sort( totals.begin(),
+                      totals.end(),
+                      []( const Total& a, const Total& b ) { return a.duration > b.duration; } );
+    QVariantList spans;
+    for ( int i = 0; i < totals.count() && i < count; ++i )
+    {
+        const auto& t = totals.at( i );
+        spans.append( QVariantMap { { "name", t.name }, { "count", t.count }, { "duration", t.duration / 1000 } } );
+    }
+    return QVariantMap { { "spans", spans }, { "instants", instants } };
+}
+
+Span::Span( const char* name, const char* category )
+    : m_category( category )
+{
+    if ( s_enabled )
+    {
+        m_name = QString::fromUtf8( name );
+        m_start = now();
+    }
+}
+
+Span::Span( const QString& name, const char* category )
+    : m_category( category )
+{
+    if ( s_enabled )
+    {
+        m_name = name;
+        m_start = now();
+    }
+}
+
+Span::~Span()
+{
+    if ( m_start >= 0 )
+    {
+        record( m_name, m_category, 'X', m_start, now() - m_start );
+    }
+}
+
+}  // namespace Trace
+}  // namespace CalamaresUtils
@@ -0,0 +1,84 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+#ifndef UTILS_TRACE_H
+#define UTILS_TRACE_H
+
+#include "DllMacro.h"
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QVariantMap>
+
+namespace CalamaresUtils
+{
+/** @brief Timing of (startup) activities, as a Chrome trace
+ *
+ * Tracing is off unless enable() is called; when it is off,
+ * a Span costs only a check of a flag. When tracing is on, each
+ * Span records a "complete" event with its name, start time,
+ * duration and thread. save() writes the events in the Chrome
+ * trace-event JSON format, which can be loaded into
+ * chrome://tracing or https://ui.perfetto.dev .
+ */
+namespace Trace
+{
+/** @brief Start tracing, later writing the trace to @p filename
+ *
+ * Time 0 in the trace is when this is called.
+ */
+DLLEXPORT void enable( const QString& filename );
+/// @brief Is tracing enabled?
+DLLEXPORT bool isEnabled();
+/** @brief Write the events so far to the trace file
+ *
+ * This may be called more than once; each time, the file is
+ * overwritten with all the events so far.
+ */
+DLLEXPORT bool save();
+/// @brief Record an event of zero duration, e.g. "window shown"
+DLLEXPORT void instant( const QString& name, const char* category = "startup" );
+/** @brief A short summary of the events so far
+ *
+ * The map has key *spans*, with the @p count spans that took the most
+ * time in total (spans with the same name are added up), longest
+ * first; each is a map with *name*, *count* and *duration* (in
+ * milliseconds). Key *instants* has all the instant events, with
+ * *name* and *at* (milliseconds since tracing started). The map is
+ * empty if tracing is off.
+ */
+DLLEXPORT QVariantMap summary( int count = 20 );
+
+/** @brief Records the time between construction and destruction
+ *
+ * Create a Span at the start of a function (or block) that
+ * should show up in the trace. Spans may nest and may be
+ * used from any thread.
+ */
+class DLLEXPORT Span
+{
+public:
+    explicit Span( const char* name, const char* category = "startup" );
+    explicit Span( const QString& name, const char* category = "startup" );
+    ~Span();
+
+    Span( const Span& ) = delete;
+    Span& operator=( const Span& ) = delete;
+
+private:
+    QString m_name;
+    const char* m_category;
+    qint64 m_start = -1;  ///< Microseconds, -1 if tracing is off
+};
+
+}  // namespace Trace
+}  // namespace CalamaresUtils
+
+#endif
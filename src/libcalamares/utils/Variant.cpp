@@ -23,16 +23,25 @@
 
 namespace CalamaresUtils
 {
+/** @brief The value for @p key in @p map, or @c nullptr
+ *
+ * This does only one lookup in the map (contains() followed
+ * by value() does two), and does not copy the value.
+ */
+static inline const QVariant*
+findValue( const QVariantMap& map, const QString& key )
+{
+    const auto it = map.constFind( key );
+    return it == map.constEnd() ? nullptr : &it.value();
+}
+
 bool
 getBool( const QVariantMap& map, const QString& key, bool d )
 {
-    if ( map.contains( key ) )
+    const auto* v = findValue( map, key );
+    if ( v && v->type() == QVariant::Bool )
     {
-        auto v = map.value( key );
-        if ( v.type() == QVariant::Bool )
-        {
-            return v.toBool();
-        }
+        return v->toBool();
     }
     return d;
 }
@@ -40,13 +49,10 @@ getBool( const QVariantMap& map, const QString& key, bool d )
 QString
 getString( const QVariantMap& map, const QString& key, const QString& d )
 {
-    if ( map.contains( key ) )
+    const auto* v = findValue( map, key );
+    if ( v && v->type() == QVariant::String )
     {
-        auto v = map.value( key );
-        if ( v.type() == QVariant::String )
-        {
-            return v.toString();
-        }
+        return v->toString();
     }
     return d;
 }
@@ -54,13 +60,10 @@ getString( const QVariantMap& map, const QString& key, const QString& d )
 QStringList
 getStringList( const QVariantMap& map, const QString& key, const QStringList& d )
 {
-    if ( map.contains( key ) )
+    const auto* v = findValue( map, key );
+    if ( v && v->canConvert( QMetaType::QStringList ) )
     {
-        auto v = map.value( key );
-        if ( v.canConvert( QMetaType::QStringList ) )
-        {
-            return v.toStringList();
-        }
+        return v->toStringList();
     }
     return d;
 }
@@ -68,10 +71,10 @@ getStringList( const QVariantMap& map, const QString& key, const QStringList& d
 qint64
 getInteger( const QVariantMap& map, const QString& key, qint64 d )
 {
-    if ( map.contains( key ) )
+    const auto* v = findValue( map, key );
+    if ( v )
     {
-        auto v = map.value( key );
-        return v.toString().toLongLong( nullptr, 0 );
+        return v->toString().toLongLong( nullptr, 0 );
     }
     return d;
 }
@@ -79,10 +82,10 @@ getInteger( const QVariantMap& map, const QString& key, qint64 d )
 quint64
 getUnsignedInteger( const QVariantMap& map, const QString& key, quint64 d )
 {
-    if ( map.contains( key ) )
+    const auto* v = findValue( map, key );
+    if ( v )
     {
-        auto v = map.value( key );
-        return v.toString().toULongLong( nullptr, 0 );
+        return v->toString().toULongLong( nullptr, 0 );
     }
     return d;
 }
@@ -90,16 +93,16 @@ getUnsignedInteger( const QVariantMap& map, const QString& key, quint64 d )
 double
 getDouble( const QVariantMap& map, const QString& key, double d )
 {
-    if ( map.contains( key ) )
+    const auto* v = findValue( map, key );
+    if ( v )
     {
-        auto v = map.value( key );
-        if ( v.type() == QVariant::Int )
+        if ( v->type() == QVariant::Int )
         {
-            return v.toInt();
+            return v->toInt();
         }
-        else if ( v.type() == QVariant::Double )
+        else if ( v->type() == QVariant::Double )
         {
-            return v.toDouble();
+            return v->toDouble();
         }
     }
     return d;
@@ -108,17 +111,21 @@ getDouble( const QVariantMap& map, const QString& key, double d )
 QVariantMap
 getSubMap( const QVariantMap& map, const QString& key, bool& success, const QVariantMap& d )
 {
-    success = false;
-    if ( map.contains( key ) )
+    const auto* v = findValue( map, key );
+    success = v && v->type() == QVariant::Map;
+    // The map is implicitly shared, so this does not copy its contents
+    return success ? v->toMap() : d;
+}
+
+const QVariantMap*
+subMap( const QVariantMap& map, const QString& key )
+{
+    const auto* v = findValue( map, key );
+    if ( v && v->type() == QVariant::Map )
     {
-        auto v = map.value( key );
-        if ( v.type() == QVariant::Map )
-        {
-            success = true;
-            return v.toMap();
-        }
+        return static_cast< const QVariantMap* >( v->constData() );
     }
-    return d;
+    return nullptr;
 }
 
 }  // namespace CalamaresUtils
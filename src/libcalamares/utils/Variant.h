@@ -66,6 +66,20 @@ DLLEXPORT QVariantMap getSubMap( const QVariantMap& map,
                                  const QString& key,
                                  bool& success,
                                  const QVariantMap& d = QVariantMap() );
+
+/** @brief The nested map in @p map with key @p key, without copying
+ *
+ * Returns a pointer to the map stored in @p map, or @c nullptr if there
+ * is no such key or it is not a map-value. The pointer is valid as long
+ * as @p map is not modified or destroyed. This is useful for reading
+ * deeply-nested configuration, e.g.
+ *
+ * ```
+ * const auto* m = subMap( configurationMap, "outer" );
+ * const auto* inner = m ? subMap( *m, "inner" ) : nullptr;
+ * ```
+ */
+DLLEXPORT const QVariantMap* subMap( const QVariantMap& map, const QString& key );
 }  // namespace CalamaresUtils
 
 #endif
@@ -12,12 +12,17 @@
  */
 #include "Yaml.h"
 
+#include "CalamaresVersionX.h"
 #include "utils/Logger.h"
 
 #include <QByteArray>
+#include <QDataStream>
+#include <QDateTime>
 #include <QFile>
 #include <QFileInfo>
-#include <QRegExp>
+#include <QHash>
+#include <QMutex>
+#include <QSaveFile>
 
 void
 operator>>( const YAML::Node& node, QStringList& v )
@@ -31,9 +36,6 @@ operator>>( const YAML::Node& node, QStringList& v )
 namespace CalamaresUtils
 {
 
-const QRegExp _yamlScalarTrueValues = QRegExp( "true|True|TRUE|on|On|ON" );
-const QRegExp _yamlScalarFalseValues = QRegExp( "false|False|FALSE|off|Off|OFF" );
-
 QVariant
 yamlToVariant( const YAML::Node& node )
 {
@@ -56,28 +58,115 @@ yamlToVariant( const YAML::Node& node )
 }
 
 
-QVariant
-yamlScalarToVariant( const YAML::Node& scalarNode )
+/// @brief The kinds of scalar that yamlScalarToVariant() distinguishes
+enum class ScalarKind
 {
-    std::string stdScalar = scalarNode.as< std::string >();
-    QString scalarString = QString::fromStdString( stdScalar );
-    if ( _yamlScalarTrueValues.exactMatch( scalarString ) )
+    True,
+    False,
+    Integer,
+    Double,
+    String
+};
+
+static bool
+isAsciiDigit( char c )
+{
+    return c >= '0' && c <= '9';
+}
+
+/** @brief Classifies the scalar @p s in one pass
+ *
+ * The recognized forms are:
+ *  - true, True, TRUE, on, On, ON
+ *  - false, False, FALSE, off, Off, OFF
+ *  - integers, with an optional sign: `[-+]?[0-9]+`
+ *  - decimals, with an optional sign: `[-+]?[0-9]*\.?[0-9]+`
+ * Anything else is a string.
+ */
+static ScalarKind
+classifyScalar( const std::string& s )
+{
+    if ( s.empty() )
     {
-        return QVariant( true );
+        return ScalarKind::String;
     }
-    if ( _yamlScalarFalseValues.exactMatch( scalarString ) )
+    switch ( s[ 0 ] )
     {
-        return QVariant( false );
+    case 't':
+    case 'T':
+        if ( s == "true" || s == "True" || s == "TRUE" )
+        {
+            return ScalarKind::True;
+        }
+        return ScalarKind::String;
+    case 'f':
+    case 'F':
+        if ( s == "false" || s == "False" || s == "FALSE" )
+        {
+            return ScalarKind::False;
+        }
+        return ScalarKind::String;
+    case 'o':
+    case 'O':
+        if ( s == "on" || s == "On" || s == "ON" )
+        {
+            return ScalarKind::True;
+        }
+        if ( s == "off" || s == "Off" || s == "OFF" )
+        {
+            return ScalarKind::False;
+        }
+        return ScalarKind::String;
+    default:
+        break;
+    }
+
+    std::size_t i = ( s[ 0 ] == '-' || s[ 0 ] == '+' ) ? 1 : 0;
+    std::size_t digits = 0;
+    while ( i < s.size() && isAsciiDigit( s[ i ] ) )
+    {
+        ++i;
+        ++digits;
+    }
+    if ( i == s.size() )
+    {
+        return digits ? ScalarKind::Integer : ScalarKind::String;
     }
-    if ( QRegExp( "[-+]?\\d+" ).exactMatch( scalarString ) )
+    if ( s[ i ] != '.' )
     {
-        return QVariant( scalarString.toLongLong() );
+        return ScalarKind::String;
     }
-    if ( QRegExp( "[-+]?\\d*\\.?\\d+" ).exactMatch( scalarString ) )
+    ++i;
+    std::size_t fractionDigits = 0;
+    while ( i < s.size() && isAsciiDigit( s[ i ] ) )
     {
-        return QVariant( scalarString.toDouble() );
+        ++i;
+        ++fractionDigits;
     }
-    return QVariant( scalarString );
+    // There must be digits after the '.'
+    return ( i == s.size() && fractionDigits ) ? ScalarKind::Double : ScalarKind::String;
+}
+
+QVariant
+yamlScalarToVariant( const YAML::Node& scalarNode )
+{
+    const std::string& stdScalar = scalarNode.Scalar();
+    switch ( classifyScalar( stdScalar ) )
+    {
+    case ScalarKind::True:
+        return QVariant( true );
+    case ScalarKind::False:
+        return QVariant( false );
+    case ScalarKind::Integer:
+        return QVariant(
+            QByteArray::fromRawData( stdScalar.data(), static_cast< int >( stdScalar.size() ) ).toLongLong() );
+    case ScalarKind::Double:
+        return QVariant(
+            QByteArray::fromRawData( stdScalar.data(), static_cast< int >( stdScalar.size() ) ).toDouble() );
+    case ScalarKind::String:
+        return QVariant( QString::fromStdString( stdScalar ) );
+    }
+    __builtin_unreachable();
 }
 
 
@@ -85,9 +174,10 @@ QVariantList
 yamlSequenceToVariant( const YAML::Node& sequenceNode )
 {
     QVariantList vl;
+    vl.reserve( static_cast< int >( sequenceNode.size() ) );
     for ( YAML::const_iterator it = sequenceNode.begin(); it != sequenceNode.end(); ++it )
     {
-        vl << yamlToVariant( *it );
+        vl.append( yamlToVariant( *it ) );
     }
     return vl;
 }
@@ -99,7 +189,9 @@ yamlMapToVariant( const YAML::Node& mapNode )
     QVariantMap vm;
     for ( YAML::const_iterator it = mapNode.begin(); it != mapNode.end(); ++it )
     {
-        vm.insert( QString::fromStdString( it->first.as< std::string >() ), yamlToVariant( it->second ) );
+        const YAML::Node& key = it->first;
+        vm.insert( QString::fromStdString( key.IsScalar() ? key.Scalar() : key.as< std::string >() ),
+                   yamlToVariant( it->second ) );
     }
     return vm;
 }
@@ -172,6 +264,136 @@ explainYamlException( const YAML::Exception& e, const QByteArray& yamlData )
     }
 }
 
+/** @brief One converted YAML file in the YAML cache
+ *
+ * The entry is valid for the file as long as the size and
+ * modification time of the file are unchanged.
+ */
+struct YamlCacheEntry
+{
+    qint64 modified = 0;
+    qint64 size = -1;
+    QVariant contents;
+};
+
+static QDataStream&
+operator<<( QDataStream& s, const YamlCacheEntry& e )
+{
+    return s << e.modified << e.size << e.contents;
+}
+
+static QDataStream&
+operator>>( QDataStream& s, YamlCacheEntry& e )
+{
+    return s >> e.modified >> e.size >> e.contents;
+}
+
+static const char s_yamlCacheMagic[] = "CALAMARES-YAML-CACHE";
+static QMutex s_yamlCacheMutex;
+static QHash< QString, YamlCacheEntry >* s_yamlCache = nullptr;  ///< nullptr if no cache is in use
+
+QVariant
+loadYamlDocument( const QString& filename )
+{
+    QFileInfo fi( filename );
+    const qint64 modified = fi.lastModified().toMSecsSinceEpoch();
+    const qint64 size = fi.size();
+    const QString key = fi.absoluteFilePath();
+
+    {
+        QMutexLocker lock( &s_yamlCacheMutex );
+        if ( s_yamlCache )
+        {
+            auto it = s_yamlCache->constFind( key );
+            if ( it != s_yamlCache->constEnd() && it->modified == modified && it->size == size )
+            {
+                return it->contents;
+            }
+        }
+    }
+
+    QVariant contents;
+    QFile yamlFile( filename );
+    if ( yamlFile.open( QFile::ReadOnly | QFile::Text ) )
+    {
+        QByteArray ba = yamlFile.readAll();
+        YAML::Node doc = YAML::Load( ba.constData() );
+        contents = CalamaresUtils::yamlToVariant( doc );
+
+        QMutexLocker lock( &s_yamlCacheMutex );
+        if ( s_yamlCache )
+        {
+            s_yamlCache->insert( key, YamlCacheEntry { modified, size, contents } );
+        }
+    }
+    return contents;
+}
+
+bool
+loadYamlCache( const QString& filename )
+{
+    QMutexLocker lock( &s_yamlCacheMutex );
+    if ( !s_yamlCache )
+    {
+        s_yamlCache = new QHash< QString, YamlCacheEntry >;
+    }
+
+    QFile f( filename );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        cDebug() << "No YAML cache" << filename;
+        return false;
+    }
+
+    QDataStream s( &f );
+    s.setVersion( QDataStream::Qt_5_9 );
+    QByteArray magic;
+    QString version;
+    s >> magic >> version;
+    if ( magic != s_yamlCacheMagic || version != CALAMARES_VERSION )
+    {
+        cWarning() << "YAML cache" << filename << "is not for this version of Calamares.";
+        return false;
+    }
+    QHash< QString, YamlCacheEntry > entries;
+    s >> entries;
+    if ( s.status() != QDataStream::Ok )
+    {
+        cWarning() << "YAML cache" << filename << "could not be read.";
+        return false;
+    }
+    cDebug() << "Loaded YAML cache" << filename << "with" << entries.count() << "entries.";
+    s_yamlCache->swap( entries );
+    return true;
+}
+
+bool
+saveYamlCache( const QString& filename )
+{
+    QMutexLocker lock( &s_yamlCacheMutex );
+    if ( !s_yamlCache )
+    {
+        return false;
+    }
+
+    QSaveFile f( filename );
+    if ( !f.open( QIODevice::WriteOnly ) )
+    {
+        cWarning() << "Could not write YAML cache" << filename;
+        return false;
+    }
+    QDataStream s( &f );
+    s.setVersion( QDataStream::Qt_5_9 );
+    s << QByteArray( s_yamlCacheMagic ) << QString( CALAMARES_VERSION ) << *s_yamlCache;
+    if ( s.status() != QDataStream::Ok || !f.commit() )
+    {
+        cWarning() << "Could not write YAML cache" << filename;
+        return false;
+    }
+    cDebug() << "Saved YAML cache" << filename << "with" << s_yamlCache->count() << "entries.";
+    return true;
+}
+
 QVariantMap
 loadYaml( const QFileInfo& fi, bool* ok )
 {
@@ -186,19 +408,18 @@ loadYaml( const QString& filename, bool* ok )
         *ok = false;
     }
 
-    QFile yamlFile( filename );
     QVariant yamlContents;
-    if ( yamlFile.exists() && yamlFile.open( QFile::ReadOnly | QFile::Text ) )
+    if ( QFile::exists( filename ) )
     {
-        QByteArray ba = yamlFile.readAll();
         try
         {
-            YAML::Node doc = YAML::Load( ba.constData() );
-            yamlContents = CalamaresUtils::yamlToVariant( doc );
+            yamlContents = loadYamlDocument( filename );
         }
         catch ( YAML::Exception& e )
         {
-            explainYamlException( e, ba, filename );
+            QFile yamlFile( filename );
+            yamlFile.open( QFile::ReadOnly | QFile::Text );
+            explainYamlException( e, yamlFile.readAll(), filename );
             return QVariantMap();
         }
     }
@@ -62,6 +62,30 @@ QVariantMap loadYaml( const QString& filename, bool* ok = nullptr );
 /** Convenience overload. */
 QVariantMap loadYaml( const QFileInfo&, bool* ok = nullptr );
 
+/**
+ * Loads a given @p filename and returns the whole YAML document
+ * converted to a QVariant (which is invalid for an empty document,
+ * and need not be a map). Throws YAML::Exception on malformed data.
+ * Uses the YAML cache, if one is in use (see loadYamlCache()).
+ */
+QVariant loadYamlDocument( const QString& filename );  //throws YAML::Exception
+
+/** @brief Use a cache of already-converted YAML files
+ *
+ * The cache holds the converted (QVariant) contents of YAML files,
+ * along with the size and modification time of each file. Loading
+ * a file that is in the cache and has not changed does not parse
+ * the file at all. Files that are loaded once a cache is in use are
+ * added to the cache; use saveYamlCache() to write it out again.
+ *
+ * Returns @c true if the cache file @p filename was read. The cache is
+ * in use after this call even if the file could not be read, so that
+ * it can be filled and then saved.
+ */
+bool loadYamlCache( const QString& filename );
+/// @brief Writes the YAML cache to @p filename, returns @c true on success
+bool saveYamlCache( const QString& filename );
+
 QVariant yamlToVariant( const YAML::Node& node );
 QVariant yamlScalarToVariant( const YAML::Node& scalarNode );
 QVariantList yamlSequenceToVariant( const YAML::Node& sequenceNode );
@@ -18,6 +18,7 @@
 #include "utils/ImageRegistry.h"
 #include "utils/Logger.h"
 #include "utils/NamedEnum.h"
+#include "utils/Trace.h"
 #include "utils/Units.h"
 #include "utils/Yaml.h"
 
@@ -25,6 +26,7 @@
 #include <QFile>
 #include <QIcon>
 #include <QPixmap>
+#include <QResource>
 #include <QVariantMap>
 
 #include <functional>
@@ -179,6 +181,41 @@ uploadServerFromMap( const QVariantMap& map )
  * documentation for details.
  */
 
+QString
+Branding::openBundle( const QString& bundlePath, const QString& componentName )
+{
+    CalamaresUtils::Trace::Span span( "Branding::openBundle" );
+    QFile file( bundlePath );
+    if ( !file.open( QIODevice::ReadOnly ) )
+    {
+        cWarning() << "Cannot read branding bundle" << bundlePath;
+        return QString();
+    }
+
+    // The data must stay for as long as the resources are registered,
+    // which is the rest of the session.
+    auto* data = new QByteArray( file.readAll() );
+    const QString root = QStringLiteral( "/calamares/branding/%1" ).arg( componentName );
+    const auto* rccData = reinterpret_cast< const uchar* >( data->constData() );
+    if ( data->isEmpty() || !QResource::registerResource( rccData, root ) )
+    {
+        cWarning() << "Branding bundle" << bundlePath << "is not a resource file.";
+        delete data;
+        return QString();
+    }
+
+    const QString descriptor = QStringLiteral( ":%1/branding.desc" ).arg( root );
+    if ( !QFile::exists( descriptor ) )
+    {
+        cWarning() << "Branding bundle" << bundlePath << "has no branding.desc";
+        QResource::unregisterResource( rccData, root );
+        delete data;
+        return QString();
+    }
+    cDebug() << "Using Calamares branding bundle" << bundlePath << "of" << data->size() << "bytes";
+    return descriptor;
+}
+
 Branding::Branding( const QString& brandingFilePath, QObject* parent )
     : QObject( parent )
     , m_descriptorPath( brandingFilePath )
@@ -186,6 +223,7 @@ Branding::Branding( const QString& brandingFilePath, QObject* parent )
     , m_welcomeStyleCalamares( false )
     , m_welcomeExpandingLogo( true )
 {
+    CalamaresUtils::Trace::Span span( "Branding" );
     cDebug() << "Using Calamares branding file at" << brandingFilePath;
 
     QDir componentDir( componentDirectory() );
@@ -283,6 +321,7 @@ Branding::Branding( const QString& brandingFilePath, QObject* parent )
     }
 
     s_instance = this;
+    prefetchImages();
     if ( m_componentName.isEmpty() )
     {
         cWarning() << "Failed to load component from" << brandingFilePath;
@@ -302,6 +341,25 @@ Branding::componentDirectory() const
 }
 
 
+/// @brief URL for QML of the file at @p path, which may be in a bundle
+static QUrl
+fileUrl( const QString& path )
+{
+    if ( path.startsWith( ':' ) )
+    {
+        // QFile sees resources with :, but QML needs the qrc: scheme
+        return QUrl( QStringLiteral( "qrc" ) + path );
+    }
+    return QUrl::fromLocalFile( path );
+}
+
+QUrl
+Branding::slideshowUrl() const
+{
+    return fileUrl( m_slideshowPath );
+}
+
+
 QString
 Branding::string( Branding::StringEntry stringEntry ) const
 {
@@ -322,6 +380,14 @@ Branding::imagePath( Branding::ImageEntry imageEntry ) const
     return m_images.value( s_imageEntryStrings.value( imageEntry ) );
 }
 
+QUrl
+Branding::imageUrl( Branding::ImageEntry imageEntry ) const
+{
+    const auto path = imagePath( imageEntry );
+    // See image() for paths and names from the icon theme
+    return path.contains( '/' ) ? fileUrl( path ) : QUrl();
+}
+
 QPixmap
 Branding::image( Branding::ImageEntry imageEntry, const QSize& size ) const
 {
@@ -342,6 +408,39 @@ Branding::image( Branding::ImageEntry imageEntry, const QSize& size ) const
     }
 }
 
+QPixmap
+Branding::image( Branding::ImageEntry imageEntry,
+                 const QSize& size,
+                 QObject* context,
+                 std::function< void( const QPixmap& ) > ready ) const
+{
+    const auto path = imagePath( imageEntry );
+    if ( path.contains( '/' ) )
+    {
+        return ImageRegistry::instance()->pixmapAsync( path, size, context, ready );
+    }
+    else
+    {
+        // Icons come from the theme, which loads them itself
+        return image( imageEntry, size );
+    }
+}
+
+void
+Branding::prefetchImages() const
+{
+    // Decode all the images at their own size, in parallel, so that
+    // the pages that show them later do not have to wait (much).
+    for ( const auto& key : s_imageEntryStrings )
+    {
+        const auto path = m_images.value( key );
+        if ( path.contains( '/' ) )
+        {
+            ImageRegistry::instance()->prefetch( path );
+        }
+    }
+}
+
 QPixmap
 Branding::image( const QString& imageName, const QSize& size ) const
 {
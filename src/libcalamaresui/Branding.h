@@ -25,6 +25,8 @@
 #include <QStringList>
 #include <QUrl>
 
+#include <functional>
+
 namespace YAML
 {
 class Node;
@@ -158,6 +160,20 @@ public:
 
     static Branding* instance();
 
+    /** @brief Makes the files in the branding bundle @p bundlePath available
+     *
+     * A bundle is a whole branding component packed into a binary
+     * resource file (see calamares_add_branding_bundle() in CMake),
+     * which is read in one go: slow install media then do one
+     * sequential read, rather than one for each image, the stylesheet,
+     * the slideshow and translations. The files are found below
+     * `:/calamares/branding/<componentName>/` afterwards.
+     *
+     * Returns the path of the branding.desc in the bundle, which can
+     * be passed to the constructor, or an empty string on failure.
+     */
+    static QString openBundle( const QString& bundlePath, const QString& componentName );
+
     explicit Branding( const QString& brandingFilePath, QObject* parent = nullptr );
 
     /** @brief Complete path of the branding descriptor file. */
@@ -177,6 +193,11 @@ public:
 
     /** @brief Path to the slideshow QML file, if any. (API == 1 or 2)*/
     QString slideshowPath() const { return m_slideshowPath; }
+    /** @brief URL of the slideshow QML file, for QML
+     *
+     * This is a qrc: URL if the branding comes from a bundle.
+     */
+    QUrl slideshowUrl() const;
     /// @brief List of pathnames of slideshow images, if any. (API == -1)
     QStringList slideshowImages() const { return m_slideshowFilenames; }
     /** @brief Which slideshow API to use for the slideshow?
@@ -188,6 +209,16 @@ public:
     int slideshowAPI() const { return m_slideshowAPI; }
 
     QPixmap image( Branding::ImageEntry imageEntry, const QSize& size ) const;
+    /** @brief The image for @p imageEntry, without waiting for it
+     *
+     * Returns the image if it is loaded already, and otherwise a
+     * placeholder; @p ready is called later with the real image.
+     * See ImageRegistry::pixmapAsync() for details.
+     */
+    QPixmap image( Branding::ImageEntry imageEntry,
+                   const QSize& size,
+                   QObject* context,
+                   std::function< void( const QPixmap& ) > ready ) const;
 
     /** @brief Look up an image in the branding directory or as an icon
      *
@@ -246,6 +277,12 @@ public slots:
 
     QString styleString( StyleEntry styleEntry ) const;
     QString imagePath( ImageEntry imageEntry ) const;
+    /** @brief URL of the image for @p imageEntry, for QML
+     *
+     * This is a qrc: URL if the branding comes from a bundle. It is
+     * empty if the image is a name from the icon theme.
+     */
+    QUrl imageUrl( ImageEntry imageEntry ) const;
 
     PanelSide sidebarSide() const { return m_sidebarSide; }
     PanelSide navigationSide() const { return m_navigationSide; }
@@ -282,6 +319,8 @@ private:
     void initSimpleSettings( const YAML::Node& doc );
     ///@brief Initialize the slideshow settings, above
     void initSlideshowSettings( const YAML::Node& doc );
+    ///@brief Start decoding the images (in the background)
+    void prefetchImages() const;
 
     bool m_welcomeStyleCalamares;
     bool m_welcomeExpandingLogo;
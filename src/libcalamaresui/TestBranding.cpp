@@ -0,0 +1,78 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "Branding.h"
+
+#include "utils/Logger.h"
+
+#include <QFile>
+#include <QtTest/QtTest>
+
+class TestBranding : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestBranding() {}
+    ~TestBranding() override {}
+
+private Q_SLOTS:
+    void initTestCase();
+    void testDirectory();
+    void testBundle();
+};
+
+void
+TestBranding::initTestCase()
+{
+    Logger::setupLogLevel( Logger::LOGDEBUG );
+}
+
+void
+TestBranding::testDirectory()
+{
+    const QString descriptor = QStringLiteral( BUILD_AS_TEST "/../branding/default/branding.desc" );
+    QVERIFY( QFile::exists( descriptor ) );
+
+    Calamares::Branding b( descriptor );
+    QCOMPARE( b.componentName(), QStringLiteral( "default" ) );
+    const QString path = b.imagePath( Calamares::Branding::ProductLogo );
+    QVERIFY( QFile::exists( path ) );
+    QCOMPARE( b.imageUrl( Calamares::Branding::ProductLogo ), QUrl::fromLocalFile( path ) );
+    QCOMPARE( b.imageUrl( Calamares::Branding::ProductLogo ).scheme(), QStringLiteral( "file" ) );
+}
+
+void
+TestBranding::testBundle()
+{
+    QVERIFY( Calamares::Branding::openBundle( QStringLiteral( TEST_BUNDLE ".missing" ), "testbundle" ).isEmpty() );
+
+    const QString descriptor = Calamares::Branding::openBundle( QStringLiteral( TEST_BUNDLE ), "testbundle" );
+    QCOMPARE( descriptor, QStringLiteral( ":/calamares/branding/testbundle/branding.desc" ) );
+
+    Calamares::Branding b( descriptor );
+    QCOMPARE( b.componentName(), QStringLiteral( "testbundle" ) );
+    QCOMPARE( b.componentDirectory(), QStringLiteral( ":/calamares/branding/testbundle" ) );
+    QCOMPARE( b.string( Calamares::Branding::ProductName ), QStringLiteral( "Test Bundle" ) );
+
+    // The image is found in the bundle, and QML gets a qrc: URL for it
+    const QString path = b.imagePath( Calamares::Branding::ProductLogo );
+    QCOMPARE( path, QStringLiteral( ":/calamares/branding/testbundle/squid.png" ) );
+    QVERIFY( QFile::exists( path ) );
+    QCOMPARE( b.imageUrl( Calamares::Branding::ProductLogo ),
+              QUrl( QStringLiteral( "qrc:/calamares/branding/testbundle/squid.png" ) ) );
+    QCOMPARE( b.imageUrl( Calamares::Branding::ProductWelcome ), b.imageUrl( Calamares::Branding::ProductLogo ) );
+    QCOMPARE( b.slideshowImages(), QStringList { path } );
+}
+
+QTEST_GUILESS_MAIN( TestBranding )
+
+#include "utils/moc-warnings.h"
+
+#include "TestBranding.moc"
@@ -17,10 +17,13 @@
 #include "JobQueue.h"
 #include "Settings.h"
 
+#include "utils/ImageRegistry.h"
 #include "utils/Logger.h"
+#include "utils/MemoryAccounting.h"
 #include "utils/Paste.h"
 #include "utils/Retranslator.h"
 #include "utils/String.h"
+#include "utils/Trace.h"
 #include "viewpages/BlankViewStep.h"
 #include "viewpages/ExecutionViewStep.h"
 #include "viewpages/ViewStep.h"
@@ -32,6 +35,8 @@
 #include <QFile>
 #include <QMessageBox>
 #include <QMetaObject>
+#include <QPixmapCache>
+#include <QTimer>
 
 #define UPDATE_BUTTON_PROPERTY( name, value ) \
     do \
@@ -83,6 +88,7 @@ ViewManager::ViewManager( QObject* parent )
     connect( JobQueue::instance(), &JobQueue::finished, this, &ViewManager::next );
 
     CALAMARES_RETRANSLATE_SLOT( &ViewManager::updateButtonLabels );
+    CALAMARES_RETRANSLATE_SLOT( &ViewManager::updateStepNames );
 
 #ifdef PRESERVE_FOR_TRANSLATION_PURPOSES
     tr( "&Yes" );
@@ -119,6 +125,17 @@ ViewManager::addViewStep( ViewStep* step )
 }
 
 
+static void
+setStepMargins( ViewStep* step, Qt::Orientations panelSides )
+{
+    QLayout* layout = step->widget()->layout();
+    if ( layout )
+    {
+        const auto margins = step->widgetMargins( panelSides );
+        layout->setContentsMargins( margins.width(), margins.height(), margins.width(), margins.height() );
+    }
+}
+
 void
 ViewManager::insertViewStep( int before, ViewStep* step )
 {
@@ -127,19 +144,21 @@ ViewManager::insertViewStep( int before, ViewStep* step )
     connect( step, &ViewStep::ensureSize, this, &ViewManager::ensureSize );
     connect( step, &ViewStep::nextStatusChanged, this, &ViewManager::updateNextStatus );
 
-    if ( !step->widget() )
+    if ( step->hasLazyWidget() )
+    {
+        // Keeps the place in the stack until the step is (nearly) shown
+        QWidget* placeholder = new QWidget;
+        m_placeholders.insert( step, placeholder );
+        m_stack->insertWidget( before, placeholder );
+        m_stack->setCurrentIndex( 0 );
+    }
+    else if ( !step->widget() )
     {
         cError() << "ViewStep" << step->moduleInstanceKey() << "has no widget.";
     }
     else
     {
-        QLayout* layout = step->widget()->layout();
-        if ( layout )
-        {
-            const auto margins = step->widgetMargins( m_panelSides );
-            layout->setContentsMargins( margins.width(), margins.height(), margins.width(), margins.height() );
-        }
-
+        setStepMargins( step, m_panelSides );
         m_stack->insertWidget( before, step->widget() );
         m_stack->setCurrentIndex( 0 );
         step->widget()->setFocus();
@@ -147,6 +166,94 @@ ViewManager::insertViewStep( int before, ViewStep* step )
     emit endInsertRows();
 }
 
+void
+ViewManager::releaseSteps( int index )
+{
+    int released = 0;
+    for ( int i = 0; i < index && i < m_steps.count(); ++i )
+    {
+        ViewStep* step = m_steps.at( i );
+        // Lazy steps that were never shown have no widget yet
+        if ( m_placeholders.contains( step ) || qobject_cast< ExecutionViewStep* >( step ) )
+        {
+            continue;
+        }
+        QWidget* w = step->widget();
+        if ( !w || m_stack->indexOf( w ) != i )
+        {
+            continue;
+        }
+
+        m_stack->removeWidget( w );
+        if ( step->releaseWidget() )
+        {
+            // The step will not be shown again, but keep its place in the stack
+            m_stack->insertWidget( i, new QWidget );
+            ++released;
+        }
+        else
+        {
+            m_stack->insertWidget( i, w );
+        }
+    }
+    m_stack->setCurrentIndex( index );
+
+    CalamaresUtils::ImageRegistry::instance()->clear();
+    QPixmapCache::clear();
+    cDebug() << "Released the widgets of" << released << "steps before step" << index;
+}
+
+void
+ViewManager::ensureWidget( int index )
+{
+    if ( index < 0 || index >= m_steps.count() )
+    {
+        return;
+    }
+
+    ViewStep* step = m_steps.at( index );
+    QWidget* placeholder = m_placeholders.take( step );
+    if ( !placeholder )
+    {
+        return;
+    }
+
+    CalamaresUtils::Trace::Span span( "ViewStep::widget" );
+    // Charged to the step, whether it is created for showing it or ahead of time
+    const auto memoryBefore = CalamaresUtils::MemoryUsage::sample();
+    QWidget* w = step->widget();
+    if ( !w )
+    {
+        cError() << "ViewStep" << step->moduleInstanceKey() << "has no widget.";
+        m_placeholders.insert( step, placeholder );
+        return;
+    }
+
+    const bool isCurrent = m_stack->currentWidget() == placeholder;
+    setStepMargins( step, m_panelSides );
+    m_stack->insertWidget( index, w );
+    m_stack->removeWidget( placeholder );
+    delete placeholder;
+    if ( isCurrent )
+    {
+        m_stack->setCurrentIndex( index );
+    }
+    CalamaresUtils::MemoryAccounting::recordWidget( step, memoryBefore );
+}
+
+void
+ViewManager::showStep( int index )
+{
+    ensureWidget( index );
+    m_stack->setCurrentIndex( index );  // Does nothing if out of range
+
+    // Create the next page once the current one is on-screen
+    if ( m_placeholders.contains( m_steps.value( index + 1 ) ) )
+    {
+        QTimer::singleShot( 0, this, [this]() { ensureWidget( m_currentStep + 1 ); } );
+    }
+}
+
 void
 ViewManager::onInstallationFailed( const QString& message, const QString& details )
 {
@@ -157,6 +264,11 @@ ViewManager::onInstallationFailed( const QString& message, const QString& detail
     cError() << "Installation failed:" << message;
     cDebug() << Logger::SubEntry << "- message:" << message;
     cDebug() << Logger::SubEntry << "- details:" << Logger::NoQuote << details;
+    if ( m_cancelling )
+    {
+        // The user asked for this, and Calamares quits when the jobs have stopped
+        return;
+    }
 
     QString heading
         = Calamares::Settings::instance()->isSetupMode() ? tr( "Setup Failed" ) : tr( "Installation Failed" );
@@ -234,15 +346,20 @@ ViewManager::onInitFailed( const QStringList& modules )
 void
 ViewManager::onInitComplete()
 {
+    CalamaresUtils::Trace::Span span( "ViewManager::onInitComplete" );
     m_currentStep = 0;
+    showStep( 0 );
+    // After showStep(), like next() and back(); creating the widget is accounted there
+    const auto memoryBefore = CalamaresUtils::MemoryUsage::sample();
 
     // Tell the first view that it's been shown.
     if ( m_steps.count() > 0 )
     {
         m_steps.first()->onActivate();
+        CalamaresUtils::MemoryAccounting::recordActivation( m_steps.first(), memoryBefore );
     }
 
-    emit currentStepChanged();
+    currentStepChangedFrom( -1 );
 }
 
 void
@@ -357,14 +474,21 @@ ViewManager::next()
 
         m_currentStep++;
 
-        m_stack->setCurrentIndex( m_currentStep );  // Does nothing if out of range
+        showStep( m_currentStep );
         step->onLeave();
+        // After onLeave(), so that what the old step frees there is not counted for the new one
+        const auto memoryBefore = CalamaresUtils::MemoryUsage::sample();
 
         if ( m_currentStep < m_steps.count() )
         {
             m_steps.at( m_currentStep )->onActivate();
+            CalamaresUtils::MemoryAccounting::recordActivation( m_steps.at( m_currentStep ), memoryBefore );
             executing = qobject_cast< ExecutionViewStep* >( m_steps.at( m_currentStep ) ) != nullptr;
-            emit currentStepChanged();
+            currentStepChangedFrom( m_currentStep - 1 );
+            if ( executing && settings->releasePagesDuringExec() )
+            {
+                releaseSteps( m_currentStep );
+            }
         }
         else
         {
@@ -390,6 +514,32 @@ ViewManager::next()
     updateButtonLabels();
 }
 
+void
+ViewManager::currentStepChangedFrom( int previous )
+{
+    emit currentStepChanged();
+    // Not during the page change itself, which should be quick
+    QTimer::singleShot( 0, this, []() { CalamaresUtils::MemoryAccounting::save(); } );
+    // Only the rows of the previous and the new current step look different
+    for ( int row : { previous, m_currentStep } )
+    {
+        if ( 0 <= row && row < m_steps.count() )
+        {
+            const QModelIndex i = index( row );
+            emit dataChanged( i, i, { ProgressTreeItemCurrentIndex } );
+        }
+    }
+}
+
+void
+ViewManager::updateStepNames()
+{
+    if ( !m_steps.isEmpty() )
+    {
+        emit dataChanged( index( 0 ), index( m_steps.count() - 1 ), { Qt::DisplayRole, Qt::ToolTipRole } );
+    }
+}
+
 void
 ViewManager::updateButtonLabels()
 {
@@ -459,10 +609,12 @@ ViewManager::back()
     if ( step->isAtBeginning() && m_currentStep > 0 )
     {
         m_currentStep--;
-        m_stack->setCurrentIndex( m_currentStep );
+        showStep( m_currentStep );
         step->onLeave();
+        const auto memoryBefore = CalamaresUtils::MemoryUsage::sample();
         m_steps.at( m_currentStep )->onActivate();
-        emit currentStepChanged();
+        CalamaresUtils::MemoryAccounting::recordActivation( m_steps.at( m_currentStep ), memoryBefore );
+        currentStepChangedFrom( m_currentStep + 1 );
     }
     else if ( !step->isAtBeginning() )
     {
@@ -487,9 +639,29 @@ void
 ViewManager::quit()
 {
     if ( confirmCancelInstallation() )
+    {
+        cancelAndQuit();
+    }
+}
+
+void
+ViewManager::cancelAndQuit()
+{
+    auto* queue = JobQueue::instance();
+    if ( !queue || !queue->isRunning() )
     {
         qApp->quit();
+        return;
+    }
+    if ( m_cancelling )
+    {
+        return;
     }
+    cDebug() << "Cancelling the jobs; Calamares will quit when they have stopped.";
+    m_cancelling = true;
+    updateCancelEnabled( false );
+    connect( queue, &JobQueue::finished, qApp, &QApplication::quit, Qt::QueuedConnection );
+    queue->cancel();
 }
 
 bool
@@ -15,6 +15,7 @@
 #include "viewpages/ViewStep.h"
 
 #include <QAbstractListModel>
+#include <QHash>
 #include <QList>
 #include <QPushButton>
 #include <QStackedWidget>
@@ -159,9 +160,17 @@ public Q_SLOTS:
     /**
      * @brief Probably quit
      *
-     * Asks for confirmation if necessary. Terminates the application.
+     * Asks for confirmation if necessary. Terminates the application,
+     * see cancelAndQuit().
      */
     void quit();
+    /** @brief Quits, after stopping the jobs if they are running
+     *
+     * Running jobs are cancelled (see JobQueue::cancel()), and the
+     * application quits once the emergency jobs have cleaned up.
+     * This does not ask for confirmation.
+     */
+    void cancelAndQuit();
     bool quitEnabled() const
     {
         return m_quitEnabled;  ///< Is the quit-button to be enabled
@@ -237,7 +246,17 @@ private:
     ~ViewManager() override;
 
     void insertViewStep( int before, ViewStep* step );
+    /// @brief Replaces the placeholder for a lazy step at @p index by its real widget
+    void ensureWidget( int index );
+    /// @brief Shows the step at @p index in the stack, and prefetches the one after
+    void showStep( int index );
+    /// @brief Has the steps before @p index release their widgets, see ViewStep::releaseWidget()
+    void releaseSteps( int index );
     void updateButtonLabels();
+    /// @brief Emits currentStepChanged(), and dataChanged() for the rows that changed
+    void currentStepChangedFrom( int previous );
+    /// @brief Emits dataChanged() for the names of the steps (e.g. after a translation change)
+    void updateStepNames();
     void updateCancelEnabled( bool enabled );
     void updateBackAndNextVisibility( bool visible );
 
@@ -250,6 +269,7 @@ private:
 
     QWidget* m_widget;
     QStackedWidget* m_stack;
+    QHash< ViewStep*, QWidget* > m_placeholders;  ///< For steps that do not have their widget yet
 
     bool m_nextEnabled = false;
     QString m_nextLabel;
@@ -266,6 +286,7 @@ private:
     QString m_quitIcon;
     QString m_quitTooltip;
     bool m_quitVisible = true;
+    bool m_cancelling = false;  ///< Quitting once the cancelled jobs stop, see cancelAndQuit()
 
     Qt::Orientations m_panelSides;
 
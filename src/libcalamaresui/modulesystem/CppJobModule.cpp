@@ -11,10 +11,13 @@
 #include "CppJobModule.h"
 
 #include "CppJob.h"
+#include "Settings.h"
 #include "utils/Logger.h"
 #include "utils/PluginFactory.h"
 
+#include <QCoreApplication>
 #include <QDir>
+#include <QFileInfo>
 #include <QPluginLoader>
 
 namespace Calamares
@@ -35,34 +38,84 @@ CppJobModule::interface() const
 }
 
 
+/** @brief A job that reports that a (lazy) plugin could not be loaded */
+class FailedPluginJob : public Job
+{
+public:
+    FailedPluginJob( const QString& instance, const QString& error )
+        : m_instance( instance )
+        , m_error( error )
+    {
+    }
+
+    QString prettyName() const override { return m_instance; }
+    JobResult exec() override
+    {
+        return JobResult::internalError( QCoreApplication::translate( "CppJobModule", "Could not load module %1." )
+                                             .arg( m_instance ),
+                                         m_error,
+                                         JobResult::InvalidConfiguration );
+    }
+
+private:
+    QString m_instance;
+    QString m_error;
+};
+
+
+bool
+CppJobModule::createJob() const
+{
+    CalamaresPluginFactory* pf = qobject_cast< CalamaresPluginFactory* >( m_loader->instance() );
+    if ( !pf )
+    {
+        cDebug() << "Could not load module:" << m_loader->errorString();
+        return false;
+    }
+
+    CppJob* cppJob = pf->create< Calamares::CppJob >();
+    if ( !cppJob )
+    {
+        cDebug() << "Could not load module:" << m_loader->errorString();
+        return false;
+    }
+    //        cDebug() << "CppJobModule loading self for instance" << instanceKey()
+    //                 << "\nCppJobModule at address" << this
+    //                 << "\nCalamares::PluginFactory at address" << pf
+    //                 << "\nCppJob at address" << cppJob;
+
+    cppJob->setModuleInstanceKey( instanceKey() );
+    cppJob->setConfigurationMap( m_configurationMap );
+    m_job = Calamares::job_ptr( static_cast< Calamares::Job* >( cppJob ) );
+    return true;
+}
+
+
 void
 CppJobModule::loadSelf()
 {
     if ( m_loader )
     {
-        CalamaresPluginFactory* pf = qobject_cast< CalamaresPluginFactory* >( m_loader->instance() );
-        if ( !pf )
+        if ( Settings::instance() && Settings::instance()->lazyJobPlugins() )
         {
-            cDebug() << "Could not load module:" << m_loader->errorString();
+            // Only check that there is something to load; the plugin
+            // itself is loaded when the jobs are needed.
+            if ( !QLibrary::isLibrary( m_loader->fileName() ) || !QFileInfo::exists( m_loader->fileName() ) )
+            {
+                cDebug() << "Could not load module:" << m_loader->fileName() << "is not a plugin.";
+                return;
+            }
+            m_lazy = true;
+            m_loaded = true;
+            cDebug() << "CppJobModule" << instanceKey() << "will be loaded when needed.";
             return;
         }
 
-        CppJob* cppJob = pf->create< Calamares::CppJob >();
-        if ( !cppJob )
+        if ( createJob() )
         {
-            cDebug() << "Could not load module:" << m_loader->errorString();
-            return;
+            m_loaded = true;
+            cDebug() << "CppJobModule" << instanceKey() << "loading complete.";
         }
-        //        cDebug() << "CppJobModule loading self for instance" << instanceKey()
-        //                 << "\nCppJobModule at address" << this
-        //                 << "\nCalamares::PluginFactory at address" << pf
-        //                 << "\nCppJob at address" << cppJob;
-
-        cppJob->setModuleInstanceKey( instanceKey() );
-        cppJob->setConfigurationMap( m_configurationMap );
-        m_job = Calamares::job_ptr( static_cast< Calamares::Job* >( cppJob ) );
-        m_loaded = true;
-        cDebug() << "CppJobModule" << instanceKey() << "loading complete.";
     }
 }
 
@@ -70,6 +123,19 @@ CppJobModule::loadSelf()
 JobList
 CppJobModule::jobs() const
 {
+    if ( m_lazy )
+    {
+        m_lazy = false;
+        if ( createJob() )
+        {
+            cDebug() << "CppJobModule" << instanceKey() << "loading complete.";
+        }
+        else
+        {
+            m_job = Calamares::job_ptr(
+                new FailedPluginJob( instanceKey().toString(), m_loader ? m_loader->errorString() : QString() ) );
+        }
+    }
     return JobList() << m_job;
 }
 
@@ -36,8 +36,13 @@ private:
     explicit CppJobModule();
     ~CppJobModule() override;
 
+    /// @brief Creates the job from the plugin; returns @c false on failure
+    bool createJob() const;
+
     QPluginLoader* m_loader;
-    job_ptr m_job;
+    // These are mutable because a lazy module creates the job in jobs()
+    mutable job_ptr m_job;
+    mutable bool m_lazy = false;  ///< Job not created yet
 
     friend Module* Calamares::moduleFromDescriptor( const ModuleSystem::Descriptor& moduleDescriptor,
                                                     const QString& instanceId,
@@ -12,17 +12,25 @@
 
 #include "ViewManager.h"
 
+#include "JobQueue.h"
 #include "Settings.h"
+#include "modulesystem/DependencyGraph.h"
 #include "modulesystem/Module.h"
 #include "modulesystem/RequirementsChecker.h"
 #include "modulesystem/RequirementsModel.h"
 #include "utils/Logger.h"
+#include "utils/MemoryAccounting.h"
+#include "utils/Trace.h"
 #include "utils/Yaml.h"
 #include "viewpages/ExecutionViewStep.h"
 
 #include <QApplication>
 #include <QDir>
+#include <QFuture>
 #include <QTimer>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
 
 namespace Calamares
 {
@@ -64,6 +72,7 @@ ModuleManager::init()
 void
 ModuleManager::doInit()
 {
+    CalamaresUtils::Trace::Span span( "ModuleManager::doInit" );
     // We start from a list of paths in m_paths. Each of those is a directory that
     // might (should) contain Calamares modules of any type/interface.
     // For each modules search path (directory), it is expected that each module
@@ -71,7 +80,12 @@ ModuleManager::doInit()
     // the module name, and must contain a settings file named module.desc.
     // If at any time the module loading procedure finds something unexpected, it
     // silently skips to the next module or search path. --Teo 6/2014
+    //
+    // Finding the descriptors is done here, but reading and parsing them
+    // is done on the thread pool; the results are collected in search order
+    // so that the first module with a given name still wins.
     Logger::Once deb;
+    QList< QFileInfo > descriptorFiles;
     for ( const QString& path : m_paths )
     {
         QDir currentDir( path );
@@ -97,18 +111,7 @@ ModuleManager::doInit()
                         continue;
                     }
 
-                    bool ok = false;
-                    QVariantMap moduleDescriptorMap = CalamaresUtils::loadYaml( descriptorFileInfo, &ok );
-                    QString moduleName = ok ? moduleDescriptorMap.value( "name" ).toString() : QString();
-
-                    if ( ok && !moduleName.isEmpty() && ( moduleName == currentDir.dirName() )
-                         && !m_availableDescriptorsByModuleName.contains( moduleName ) )
-                    {
-                        auto descriptor
-                            = Calamares::ModuleSystem::Descriptor::fromDescriptorData( moduleDescriptorMap );
-                        descriptor.setDirectory( descriptorFileInfo.absoluteDir().absolutePath() );
-                        m_availableDescriptorsByModuleName.insert( moduleName, descriptor );
-                    }
+                    descriptorFiles.append( descriptorFileInfo );
                 }
                 else
                 {
@@ -121,6 +124,30 @@ ModuleManager::doInit()
             cDebug() << deb << "ModuleManager module search path does not exist:" << path;
         }
     }
+
+    QList< QFuture< QVariantMap > > descriptorMaps;
+    for ( const auto& descriptorFileInfo : descriptorFiles )
+    {
+        descriptorMaps.append( QtConcurrent::run( [ descriptorFileInfo ]() {
+            bool ok = false;
+            QVariantMap moduleDescriptorMap = CalamaresUtils::loadYaml( descriptorFileInfo, &ok );
+            return ok ? moduleDescriptorMap : QVariantMap();
+        } ) );
+    }
+    for ( int i = 0; i < descriptorFiles.count(); ++i )
+    {
+        const QFileInfo& descriptorFileInfo = descriptorFiles.at( i );
+        const QVariantMap moduleDescriptorMap = descriptorMaps[ i ].result();
+        const QString moduleName = moduleDescriptorMap.value( "name" ).toString();
+
+        if ( !moduleName.isEmpty() && ( moduleName == descriptorFileInfo.absoluteDir().dirName() )
+             && !m_availableDescriptorsByModuleName.contains( moduleName ) )
+        {
+            auto descriptor = Calamares::ModuleSystem::Descriptor::fromDescriptorData( moduleDescriptorMap );
+            descriptor.setDirectory( descriptorFileInfo.absoluteDir().absolutePath() );
+            m_availableDescriptorsByModuleName.insert( moduleName, descriptor );
+        }
+    }
     // At this point m_availableDescriptorsByModuleName is filled with
     // the modules that were found in the search paths.
     cDebug() << deb << "Found" << m_availableDescriptorsByModuleName.count() << "modules";
@@ -181,9 +208,122 @@ getConfigFileName( const Settings::InstanceDescriptionList& descriptorList,
     return QString();
 }
 
+Module*
+ModuleManager::loadModule( const ModuleSystem::InstanceKey& instanceKey )
+{
+    if ( !instanceKey.isValid() )
+    {
+        cError() << "Wrong module entry format for module" << instanceKey;
+        return nullptr;
+    }
+
+    ModuleSystem::Descriptor descriptor
+        = m_availableDescriptorsByModuleName.value( instanceKey.module(), ModuleSystem::Descriptor() );
+    if ( !descriptor.isValid() )
+    {
+        cError() << "Module" << instanceKey.toString() << "not found in module search paths."
+                 << Logger::DebugList( m_paths );
+        return nullptr;
+    }
+
+    QString configFileName
+        = getConfigFileName( Settings::instance()->moduleInstances(), instanceKey, descriptor );
+
+    // So now we can assume that the module entry is at least valid,
+    // that we have a descriptor on hand (and therefore that the
+    // module exists), and that the instance is either default or
+    // defined in the custom instances section.
+    // We still don't know whether the config file for the entry
+    // exists and is valid, but that's the only thing that could fail
+    // from this point on. -- Teo 8/2015
+    Module* thisModule = m_loadedModulesByInstanceKey.value( instanceKey, nullptr );
+    if ( thisModule )
+    {
+        if ( thisModule->isLoaded() )
+        {
+            // It's been listed before, don't bother loading again.
+            // This can happen for a module listed twice (e.g. with custom instances)
+            cDebug() << "Module" << instanceKey.toString() << "already loaded.";
+            return thisModule;
+        }
+        // An attempt was made, earlier, and that failed.
+        // This can happen for a module listed twice (e.g. with custom instances)
+        cError() << "Module" << instanceKey.toString() << "exists but not loaded.";
+        return nullptr;
+    }
+
+    CalamaresUtils::Trace::Span moduleSpan( instanceKey.toString(), "module" );
+    const auto memoryBefore = CalamaresUtils::MemoryUsage::sample();
+    thisModule
+        = Calamares::moduleFromDescriptor( descriptor, instanceKey.id(), configFileName, descriptor.directory() );
+    if ( !thisModule )
+    {
+        cError() << "Module" << instanceKey.toString() << "cannot be created from descriptor" << configFileName;
+        return nullptr;
+    }
+
+    if ( !addModule( thisModule ) )
+    {
+        // Error message is already printed
+        return nullptr;
+    }
+    CalamaresUtils::MemoryAccounting::recordLoad( instanceKey, memoryBefore );
+    return thisModule;
+}
+
+JobList
+ModuleManager::instanceJobs( const ModuleSystem::InstanceKey& instanceKey )
+{
+    Module* module = moduleInstance( instanceKey );
+    if ( !module )
+    {
+        return JobList();
+    }
+
+    const auto instanceDescriptors = Settings::instance()->moduleInstances();
+    const auto instanceDescriptor
+        = std::find_if( instanceDescriptors.constBegin(),
+                        instanceDescriptors.constEnd(),
+                        [ = ]( const InstanceDescription& d ) { return d.key() == instanceKey; } );
+    const bool hasResources = instanceDescriptor != instanceDescriptors.constEnd()
+        && ( !instanceDescriptor->readResources().isEmpty() || !instanceDescriptor->writeResources().isEmpty() );
+
+    auto jobs = module->jobs();
+    for ( auto& j : jobs )
+    {
+        j->setModuleInstance( module->instanceKey().toString() );
+        if ( module->isEmergency() )
+        {
+            j->setEmergency( true );
+        }
+        if ( hasResources && !j->hasResources() )
+        {
+            j->setResources( instanceDescriptor->readResources(), instanceDescriptor->writeResources() );
+        }
+    }
+    return jobs;
+}
+
+int
+ModuleManager::instanceWeight( const ModuleSystem::InstanceKey& instanceKey )
+{
+    const auto instanceDescriptors = Settings::instance()->moduleInstances();
+    const auto instanceDescriptor
+        = std::find_if( instanceDescriptors.constBegin(),
+                        instanceDescriptors.constEnd(),
+                        [ = ]( const InstanceDescription& d ) { return d.key() == instanceKey; } );
+    int weight = moduleDescriptor( instanceKey ).weight();
+    if ( instanceDescriptor != instanceDescriptors.constEnd() && instanceDescriptor->explicitWeight() )
+    {
+        weight = instanceDescriptor->weight();
+    }
+    return qBound( 1, weight, 100 );
+}
+
 void
 ModuleManager::loadModules()
 {
+    CalamaresUtils::Trace::Span span( "ModuleManager::loadModules" );
     if ( checkDependencies() )
     {
         cWarning() << "Some installed modules have unmet dependencies.";
@@ -192,76 +332,44 @@ ModuleManager::loadModules()
 
     QStringList failedModules;
     const auto modulesSequence = Settings::instance()->modulesSequence();
+
+    // Parse the configuration files on the thread pool first; creating
+    // the modules themselves (below) must be done in this thread.
+    {
+        QList< QPair< QString, QString > > configFiles;
+        for ( const auto& modulePhase : modulesSequence )
+        {
+            for ( const auto& instanceKey : modulePhase.second )
+            {
+                const auto descriptor = m_availableDescriptorsByModuleName.value( instanceKey.module() );
+                if ( instanceKey.isValid() && descriptor.isValid()
+                     && !m_loadedModulesByInstanceKey.contains( instanceKey ) )
+                {
+                    QString configFileName = getConfigFileName( customInstances, instanceKey, descriptor );
+                    if ( !configFileName.isEmpty() )
+                    {
+                        configFiles.append( qMakePair( instanceKey.module(), configFileName ) );
+                    }
+                }
+            }
+        }
+        CalamaresUtils::Trace::Span preloadSpan( "preloadConfigurationFiles" );
+        Module::preloadConfigurationFiles( configFiles );
+    }
+
     for ( const auto& modulePhase : modulesSequence )
     {
         ModuleSystem::Action currentAction = modulePhase.first;
 
         for ( const auto& instanceKey : modulePhase.second )
         {
-            if ( !instanceKey.isValid() )
-            {
-                cError() << "Wrong module entry format for module" << instanceKey;
-                failedModules.append( instanceKey.toString() );
-                continue;
-            }
-
-            ModuleSystem::Descriptor descriptor
-                = m_availableDescriptorsByModuleName.value( instanceKey.module(), ModuleSystem::Descriptor() );
-            if ( !descriptor.isValid() )
+            Module* thisModule = loadModule( instanceKey );
+            if ( !thisModule )
             {
-                cError() << "Module" << instanceKey.toString() << "not found in module search paths."
-                         << Logger::DebugList( m_paths );
                 failedModules.append( instanceKey.toString() );
                 continue;
             }
 
-            QString configFileName = getConfigFileName( customInstances, instanceKey, descriptor );
-
-            // So now we can assume that the module entry is at least valid,
-            // that we have a descriptor on hand (and therefore that the
-            // module exists), and that the instance is either default or
-            // defined in the custom instances section.
-            // We still don't know whether the config file for the entry
-            // exists and is valid, but that's the only thing that could fail
-            // from this point on. -- Teo 8/2015
-            Module* thisModule = m_loadedModulesByInstanceKey.value( instanceKey, nullptr );
-            if ( thisModule )
-            {
-                if ( thisModule->isLoaded() )
-                {
-                    // It's been listed before, don't bother loading again.
-                    // This can happen for a module listed twice (e.g. with custom instances)
-                    cDebug() << "Module" << instanceKey.toString() << "already loaded.";
-                }
-                else
-                {
-                    // An attempt was made, earlier, and that failed.
-                    // This can happen for a module listed twice (e.g. with custom instances)
-                    cError() << "Module" << instanceKey.toString() << "exists but not loaded.";
-                    failedModules.append( instanceKey.toString() );
-                    continue;
-                }
-            }
-            else
-            {
-                thisModule = Calamares::moduleFromDescriptor(
-                    descriptor, instanceKey.id(), configFileName, descriptor.directory() );
-                if ( !thisModule )
-                {
-                    cError() << "Module" << instanceKey.toString() << "cannot be created from descriptor"
-                             << configFileName;
-                    failedModules.append( instanceKey.toString() );
-                    continue;
-                }
-
-                if ( !addModule( thisModule ) )
-                {
-                    // Error message is already printed
-                    failedModules.append( instanceKey.toString() );
-                    continue;
-                }
-            }
-
             // At this point we most certainly have a pointer to a loaded module in
             // thisModule. We now need to enqueue jobs info into an EVS.
             if ( currentAction == ModuleSystem::Action::Exec )
@@ -273,11 +381,33 @@ ModuleManager::loadModules()
                     evs = new ExecutionViewStep( ViewManager::instance() );
                     ViewManager::instance()->addViewStep( evs );
                 }
+                else
+                {
+                    // This exec phase shares the EVS with an earlier one, so a prepare
+                    // phase in between must start before that EVS, too.
+                    const int evsIndex = ViewManager::instance()->viewSteps().count() - 1;
+                    for ( auto& pending : m_pendingPrepare )
+                    {
+                        if ( pending.first > evsIndex )
+                        {
+                            pending.first = evsIndex;
+                        }
+                    }
+                }
 
                 evs->appendJobModuleInstanceKey( instanceKey );
             }
+            else if ( currentAction == ModuleSystem::Action::Prepare )
+            {
+                m_pendingPrepare.append( qMakePair( ViewManager::instance()->viewSteps().count(), instanceKey ) );
+            }
         }
     }
+    if ( !m_pendingPrepare.isEmpty() )
+    {
+        connect( ViewManager::instance(), &ViewManager::currentStepChanged, this, &ModuleManager::startPreparing );
+        QTimer::singleShot( 0, this, &ModuleManager::startPreparing );
+    }
     if ( !failedModules.isEmpty() )
     {
         ViewManager::instance()->onInitFailed( failedModules );
@@ -289,6 +419,38 @@ ModuleManager::loadModules()
     }
 }
 
+void
+ModuleManager::startPreparing()
+{
+    const auto* viewManager = ViewManager::instance();
+    const int current = viewManager->currentStepIndex();
+    const auto steps = viewManager->viewSteps();
+    for ( auto it = m_pendingPrepare.begin(); it != m_pendingPrepare.end(); )
+    {
+        const int next = it->first;
+        const bool beforeExecution
+            = current + 1 == next && next < steps.count() && qobject_cast< ExecutionViewStep* >( steps.at( next ) );
+        if ( current < next && !beforeExecution )
+        {
+            ++it;
+            continue;
+        }
+
+        Module* module = moduleInstance( it->second );
+        if ( module )
+        {
+            cDebug() << "Preparing" << it->second.toString() << "at step" << current;
+            auto jobs = module->jobs();
+            for ( auto& j : jobs )
+            {
+                j->setModuleInstance( module->instanceKey().toString() );
+            }
+            JobQueue::instance()->prepare( jobs );
+        }
+        it = m_pendingPrepare.erase( it );
+    }
+}
+
 bool
 ModuleManager::addModule( Module* module )
 {
@@ -326,6 +488,7 @@ ModuleManager::addModule( Module* module )
 void
 ModuleManager::checkRequirements()
 {
+    CalamaresUtils::Trace::instant( "checkRequirements" );
     cDebug() << "Checking module requirements ..";
 
     QVector< Module* > modules( m_loadedModulesByInstanceKey.count() );
@@ -344,50 +507,25 @@ ModuleManager::checkRequirements()
     QTimer::singleShot( 0, rq, &RequirementsChecker::run );
 }
 
-static QStringList
-missingRequiredModules( const QStringList& required, const QMap< QString, ModuleSystem::Descriptor >& available )
-{
-    QStringList l;
-    for ( const QString& depName : required )
-    {
-        if ( !available.contains( depName ) )
-        {
-            l.append( depName );
-        }
-    }
-
-    return l;
-}
-
 size_t
 ModuleManager::checkDependencies()
 {
-    size_t numberRemoved = 0;
-    bool somethingWasRemovedBecauseOfUnmetDependencies = false;
-
-    // This goes through the map of available modules, and deletes those whose
-    // dependencies are not met, if any.
-    do
+    // Removing a module may leave other modules with unmet dependencies;
+    // the graph finds all of those in one pass.
+    ModuleSystem::DependencyGraph graph;
+    for ( auto it = m_availableDescriptorsByModuleName.cbegin(); it != m_availableDescriptorsByModuleName.cend();
+          ++it )
     {
-        somethingWasRemovedBecauseOfUnmetDependencies = false;
-        for ( auto it = m_availableDescriptorsByModuleName.begin(); it != m_availableDescriptorsByModuleName.end();
-              ++it )
-        {
-            QStringList unmet = missingRequiredModules( it->requiredModules(), m_availableDescriptorsByModuleName );
-
-            if ( unmet.count() > 0 )
-            {
-                QString moduleName = it->name();
-                somethingWasRemovedBecauseOfUnmetDependencies = true;
-                m_availableDescriptorsByModuleName.erase( it );
-                numberRemoved++;
-                cWarning() << "Module" << moduleName << "requires missing modules" << Logger::DebugList( unmet );
-                break;
-            }
-        }
-    } while ( somethingWasRemovedBecauseOfUnmetDependencies );
+        graph.add( it.key(), it->requiredModules() );
+    }
 
-    return numberRemoved;
+    const auto removed = graph.removeUnmet();
+    for ( const auto& r : removed )
+    {
+        m_availableDescriptorsByModuleName.remove( r.name );
+        cWarning() << "Module" << r.name << "requires missing modules" << Logger::DebugList( r.missing );
+    }
+    return static_cast< size_t >( removed.count() );
 }
 
 bool
@@ -11,6 +11,7 @@
 #ifndef MODULELOADER_H
 #define MODULELOADER_H
 
+#include "Job.h"
 #include "modulesystem/Descriptor.h"
 #include "modulesystem/InstanceKey.h"
 #include "modulesystem/Requirement.h"
@@ -94,6 +95,29 @@ public:
      */
     bool addModule( Module* );
 
+    /** @brief Loads the module for @p instanceKey from its descriptor
+     *
+     * The configuration file is the one from the *instances* section
+     * (or the default one) of `settings.conf`. A module that is already
+     * loaded is returned as-is. Returns @c nullptr (after logging
+     * why) if the module can not be loaded.
+     *
+     * This does not create any view steps, so it can be used to load the
+     * job modules without a UI; loadModules() uses this for every
+     * instance in the sequence.
+     */
+    Module* loadModule( const ModuleSystem::InstanceKey& instanceKey );
+
+    /** @brief The jobs of the loaded module @p instanceKey, ready to enqueue
+     *
+     * The jobs get the module instance, the emergency flag and the
+     * resources from the *instances* section set. Returns an empty
+     * list if the module is not loaded.
+     */
+    JobList instanceJobs( const ModuleSystem::InstanceKey& instanceKey );
+    /// @brief The weight (1 to 100) of @p instanceKey in the exec phase
+    int instanceWeight( const ModuleSystem::InstanceKey& instanceKey );
+
     /**
      * @brief Starts asynchronous requirements checking for each module.
      * When this is done, the signal requirementsComplete is emitted.
@@ -139,6 +163,15 @@ signals:
 private slots:
     void doInit();
 
+    /** @brief Starts the prepare phases that the user has reached
+     *
+     * A *prepare* phase in the sequence starts when the user reaches
+     * the view step after it; or, if that step is the execution step,
+     * the one before (e.g. the summary page), so that the jobs can
+     * run while the user reads it. See JobQueue::prepare().
+     */
+    void startPreparing();
+
 private:
     /**
      * Check in a general sense whether the dependencies between
@@ -164,6 +197,8 @@ private:
 
     QMap< QString, ModuleSystem::Descriptor > m_availableDescriptorsByModuleName;
     QMap< ModuleSystem::InstanceKey, Module* > m_loadedModulesByInstanceKey;
+    /// Module instances from prepare phases that have not started, with the index of the view step after them
+    QList< QPair< int, ModuleSystem::InstanceKey > > m_pendingPrepare;
     const QStringList m_paths;
     RequirementsModel* m_requirementsModel;
 
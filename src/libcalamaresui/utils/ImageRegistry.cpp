@@ -8,11 +8,212 @@
 
 #include "ImageRegistry.h"
 
+#include <QCache>
+#include <QCoreApplication>
+#include <QFutureWatcher>
+#include <QHash>
 #include <QIcon>
+#include <QImageReader>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QPainter>
 #include <QSvgRenderer>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
 
-static QHash< QString, QHash< int, QHash< qint64, QPixmap > > > s_cache;
+namespace
+{
+struct CacheKey
+{
+    QString path;
+    int mode;
+    QSize size;
+
+    bool operator==( const CacheKey& other ) const
+    {
+        return mode == other.mode && size == other.size && path == other.path;
+    }
+};
+
+uint
+qHash( const CacheKey& key, uint seed = 0 )
+{
+    return ::qHash( key.path, seed ) ^ ::qHash( key.mode, seed ) ^ ::qHash( key.size.width(), seed )
+        ^ ( ::qHash( key.size.height(), seed ) << 16 );
+}
+
+/** @brief A cached image
+ *
+ * The image is always there; a pixmap of it is added the first
+ * time pixmap() asks for it, in the GUI thread.
+ */
+struct CacheEntry
+{
+    QImage image;
+    QPixmap pixmap;
+
+    /// @brief Cost for the cache, in KiB
+    int cost() const
+    {
+        const qint64 bytes = qint64( image.bytesPerLine() ) * image.height()
+            + qint64( pixmap.width() ) * pixmap.height() * pixmap.depth() / 8;
+        return int( qMax< qint64 >( 1, bytes / 1024 ) );
+    }
+};
+
+/// @brief Like CalamaresUtils::createRoundedImage(), but thread-safe
+QImage
+roundedImage( const QImage& image, const QSize& size, float frameWidthPct = 0.20f )
+{
+    const int height = size.isEmpty() ? image.height() : size.height();
+    const int width = size.isEmpty() ? image.width() : size.width();
+    if ( !height || !width )
+    {
+        return QImage();
+    }
+
+    QImage scaled = image.scaled( width, height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+    QImage frame( width, height, QImage::Format_ARGB32_Premultiplied );
+    frame.fill( Qt::transparent );
+
+    QPainter painter( &frame );
+    painter.setRenderHint( QPainter::Antialiasing );
+    QPen pen;
+    pen.setColor( Qt::transparent );
+    pen.setJoinStyle( Qt::RoundJoin );
+    painter.setBrush( QBrush( scaled ) );
+    painter.setPen( pen );
+    painter.drawRoundedRect( QRect( 0, 0, width, height ),
+                             qreal( frameWidthPct ) * 100.0,
+                             qreal( frameWidthPct ) * 100.0,
+                             Qt::RelativeSize );
+    painter.end();
+    return frame;
+}
+
+bool
+isSvg( const QString& path )
+{
+    const QString lowerPath = path.toLower();
+    return lowerPath.endsWith( ".svg" ) || lowerPath.endsWith( ".svgz" );
+}
+
+/** @brief The size to decode an image of @p imageSize at, for @p size
+ *
+ * This follows the rules for sizes in ImageRegistry::pixmap(); returns
+ * an invalid size if the image is wanted at its own size, or if the
+ * size of the image is not known.
+ */
+QSize
+decodeSize( const QSize& imageSize, const QSize& size )
+{
+    if ( size.isNull() || !imageSize.isValid() || imageSize.isEmpty() )
+    {
+        return QSize();
+    }
+    if ( size.width() == 0 )
+    {
+        return QSize( qMax( 1, imageSize.width() * size.height() / imageSize.height() ), size.height() );
+    }
+    if ( size.height() == 0 )
+    {
+        return QSize( size.width(), qMax( 1, imageSize.height() * size.width() / imageSize.width() ) );
+    }
+    return size;
+}
+
+/** @brief Loads the image at @p path and scales it to @p size
+ *
+ * If @p original is not null, it is the (already decoded) raster
+ * image at @p path at its own size, and it is scaled instead of
+ * decoding the file again. SVG files are always rendered at the
+ * size that is wanted.
+ */
+QImage
+loadImage( const QString& path, const QSize& size, CalamaresUtils::ImageMode mode, const QImage& original )
+{
+    QImage image;
+    if ( !original.isNull() && !isSvg( path ) )
+    {
+        image = original;
+    }
+    else if ( isSvg( path ) )
+    {
+        // Render at the size that is wanted, rather than scaling afterwards
+        QSvgRenderer svgRenderer( path );
+        QImage i( size.isNull() || size.height() == 0 || size.width() == 0 ? svgRenderer.defaultSize() : size,
+                  QImage::Format_ARGB32_Premultiplied );
+        i.fill( Qt::transparent );
+
+        QPainter pixPainter( &i );
+        svgRenderer.render( &pixPainter );
+        pixPainter.end();
+
+        image = i;
+    }
+    else
+    {
+        QImageReader reader( path );
+        const QSize scaledSize = decodeSize( reader.size(), size );
+        if ( scaledSize.isValid() && mode != CalamaresUtils::RoundedCorners )
+        {
+            // Decode at the size that is wanted, rather than decoding all
+            // of a large image and scaling it afterwards; this is much
+            // cheaper for formats (like JPEG) that can decode scaled.
+            reader.setScaledSize( scaledSize );
+        }
+        image = reader.read();
+    }
+
+    if ( image.isNull() )
+    {
+        return image;
+    }
+
+    if ( mode == CalamaresUtils::RoundedCorners )
+    {
+        image = roundedImage( image, size );
+    }
+
+    if ( !size.isNull() && image.size() != size )
+    {
+        // The reader may have decoded it at the right width or height already
+        if ( size.width() == 0 )
+        {
+            if ( image.height() != size.height() )
+            {
+                image = image.scaledToHeight( size.height(), Qt::SmoothTransformation );
+            }
+        }
+        else if ( size.height() == 0 )
+        {
+            if ( image.width() != size.width() )
+            {
+                image = image.scaledToWidth( size.width(), Qt::SmoothTransformation );
+            }
+        }
+        else
+        {
+            image = image.scaled( size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+        }
+    }
+    return image;
+}
+
+}  // namespace
+
+struct ImageRegistry::Private
+{
+    mutable QMutex mutex;
+    QCache< CacheKey, CacheEntry > cache { 65536 };
+
+    /// @brief Adds (or replaces) an entry; call with the mutex locked
+    void insert( const CacheKey& key, const CacheEntry& entry )
+    {
+        auto* e = new CacheEntry( entry );
+        cache.insert( key, e, e->cost() );  // Deletes e if it is too large
+    }
+};
 
 
 ImageRegistry*
@@ -23,7 +224,12 @@ ImageRegistry::instance()
 }
 
 
-ImageRegistry::ImageRegistry() {}
+ImageRegistry::ImageRegistry()
+    : d( std::make_unique< Private >() )
+{
+}
+
+ImageRegistry::~ImageRegistry() {}
 
 
 QIcon
@@ -33,109 +239,158 @@ ImageRegistry::icon( const QString& image, CalamaresUtils::ImageMode mode )
 }
 
 
-qint64
-ImageRegistry::cacheKey( const QSize& size )
+QImage
+ImageRegistry::image( const QString& image, const QSize& size, CalamaresUtils::ImageMode mode )
 {
-    return size.width() * 100 + size.height() * 10;
+    Q_ASSERT( !( size.width() < 0 || size.height() < 0 ) );
+    if ( size.width() < 0 || size.height() < 0 )
+    {
+        return QImage();
+    }
+
+    const CacheKey key { image, int( mode ), size };
+    QImage original;
+    {
+        QMutexLocker lock( &d->mutex );
+        if ( const auto* entry = d->cache.object( key ) )
+        {
+            return entry->image;
+        }
+        // Maybe prefetch() has decoded it already, at its own size
+        if ( const auto* entry = d->cache.object( CacheKey { image, int( CalamaresUtils::Original ), QSize( 0, 0 ) } ) )
+        {
+            original = entry->image;
+        }
+    }
+
+    // Not in the cache; load it without holding the lock, so that
+    // other threads can use the cache meanwhile.
+    const QImage loaded = loadImage( image, size, mode, original );
+    if ( !loaded.isNull() )
+    {
+        QMutexLocker lock( &d->mutex );
+        if ( !d->cache.contains( key ) )
+        {
+            d->insert( key, CacheEntry { loaded, QPixmap() } );
+        }
+    }
+    return loaded;
 }
 
 
 QPixmap
 ImageRegistry::pixmap( const QString& image, const QSize& size, CalamaresUtils::ImageMode mode )
 {
+    Q_ASSERT( !QCoreApplication::instance() || QThread::currentThread() == QCoreApplication::instance()->thread() );
     Q_ASSERT( !( size.width() < 0 || size.height() < 0 ) );
     if ( size.width() < 0 || size.height() < 0 )
     {
         return QPixmap();
     }
 
-    QHash< qint64, QPixmap > subsubcache;
-    QHash< int, QHash< qint64, QPixmap > > subcache;
-
-    if ( s_cache.contains( image ) )
+    const CacheKey key { image, int( mode ), size };
     {
-        subcache = s_cache.value( image );
-
-        if ( subcache.contains( mode ) )
+        QMutexLocker lock( &d->mutex );
+        if ( const auto* entry = d->cache.object( key ) )
         {
-            subsubcache = subcache.value( mode );
-
-            const qint64 ck = cacheKey( size );
-            if ( subsubcache.contains( ck ) )
+            if ( !entry->pixmap.isNull() )
             {
-                return subsubcache.value( ck );
+                return entry->pixmap;
             }
         }
     }
 
-    // Image not found in cache. Let's load it.
-    QPixmap pixmap;
-    if ( image.toLower().endsWith( ".svg" ) )
+    const QImage loaded = this->image( image, size, mode );
+    if ( loaded.isNull() )
     {
-        QSvgRenderer svgRenderer( image );
-        QPixmap p( size.isNull() || size.height() == 0 || size.width() == 0 ? svgRenderer.defaultSize() : size );
-        p.fill( Qt::transparent );
+        return QPixmap();
+    }
+    const QPixmap pixmap = QPixmap::fromImage( loaded );
+    QMutexLocker lock( &d->mutex );
+    d->insert( key, CacheEntry { loaded, pixmap } );
+    return pixmap;
+}
 
-        QPainter pixPainter( &p );
-        svgRenderer.render( &pixPainter );
-        pixPainter.end();
 
-        pixmap = p;
-    }
-    else
+QFuture< QImage >
+ImageRegistry::prefetch( const QString& image, const QSize& size, CalamaresUtils::ImageMode mode )
+{
+    return QtConcurrent::run( [this, image, size, mode]() { return this->image( image, size, mode ); } );
+}
+
+bool
+ImageRegistry::isCached( const QString& image, const QSize& size, CalamaresUtils::ImageMode mode ) const
+{
+    QMutexLocker lock( &d->mutex );
+    return d->cache.contains( CacheKey { image, int( mode ), size } );
+}
+
+QPixmap
+ImageRegistry::pixmapAsync( const QString& image,
+                            const QSize& size,
+                            QObject* context,
+                            std::function< void( const QPixmap& ) > ready,
+                            CalamaresUtils::ImageMode mode )
+{
+    Q_ASSERT( !QCoreApplication::instance() || QThread::currentThread() == QCoreApplication::instance()->thread() );
+    Q_ASSERT( context );
+    Q_ASSERT( !( size.width() < 0 || size.height() < 0 ) );
+    if ( size.width() < 0 || size.height() < 0 )
     {
-        pixmap = QPixmap( image );
+        return QPixmap();
     }
 
-    if ( !pixmap.isNull() )
+    if ( isCached( image, size, mode ) )
     {
-        if ( mode == CalamaresUtils::RoundedCorners )
-        {
-            pixmap = CalamaresUtils::createRoundedImage( pixmap, size );
-        }
+        // At worst, it still needs to be converted to a pixmap
+        return pixmap( image, size, mode );
+    }
 
-        if ( !size.isNull() && pixmap.size() != size )
-        {
-            if ( size.width() == 0 )
-            {
-                pixmap = pixmap.scaledToHeight( size.height(), Qt::SmoothTransformation );
-            }
-            else if ( size.height() == 0 )
-            {
-                pixmap = pixmap.scaledToWidth( size.width(), Qt::SmoothTransformation );
-            }
-            else
-            {
-                pixmap = pixmap.scaled( size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
-            }
-        }
+    auto* watcher = new QFutureWatcher< QImage >( context );
+    QObject::connect(
+        watcher, &QFutureWatcher< QImage >::finished, context, [this, watcher, image, size, mode, ready]() {
+            watcher->deleteLater();
+            ready( pixmap( image, size, mode ) );
+        } );
+    watcher->setFuture( prefetch( image, size, mode ) );
 
-        putInCache( image, size, mode, pixmap );
+    QPixmap placeholder;
+    if ( !size.isEmpty() )
+    {
+        placeholder = QPixmap( size );
+        placeholder.fill( Qt::transparent );
     }
-
-    return pixmap;
+    return placeholder;
 }
 
 
 void
-ImageRegistry::putInCache( const QString& image,
-                           const QSize& size,
-                           CalamaresUtils::ImageMode mode,
-                           const QPixmap& pixmap )
+ImageRegistry::setCacheLimit( int kib )
 {
-    QHash< qint64, QPixmap > subsubcache;
-    QHash< int, QHash< qint64, QPixmap > > subcache;
+    QMutexLocker lock( &d->mutex );
+    d->cache.setMaxCost( qMax( 0, kib ) );
+}
+
+
+int
+ImageRegistry::cacheLimit() const
+{
+    QMutexLocker lock( &d->mutex );
+    return d->cache.maxCost();
+}
 
-    if ( s_cache.contains( image ) )
-    {
-        subcache = s_cache.value( image );
-        if ( subcache.contains( mode ) )
-        {
-            subsubcache = subcache.value( mode );
-        }
-    }
 
-    subsubcache.insert( cacheKey( size ), pixmap );
-    subcache.insert( mode, subsubcache );
-    s_cache.insert( image, subcache );
+int
+ImageRegistry::cacheCost() const
+{
+    QMutexLocker lock( &d->mutex );
+    return d->cache.totalCost();
+}
+
+
+void
+ImageRegistry::clear()
+{
+    QMutexLocker lock( &d->mutex );
+    d->cache.clear();
 }
@@ -9,25 +9,106 @@
 #ifndef IMAGE_REGISTRY_H
 #define IMAGE_REGISTRY_H
 
+#include <QImage>
 #include <QPixmap>
 
 #include "DllMacro.h"
 #include "utils/CalamaresUtilsGui.h"
 
+#include <QFuture>
+
+#include <functional>
+#include <memory>
+
+class QObject;
+
+/** @brief Loads (and scales) images, and remembers them
+ *
+ * Images are cached by path, mode and size, in a cache that is
+ * limited in size: the least-recently used images are dropped
+ * when the limit is reached (see setCacheLimit()).
+ */
 class UIDLLEXPORT ImageRegistry
 {
 public:
     static ImageRegistry* instance();
 
     explicit ImageRegistry();
+    ~ImageRegistry();
 
     QIcon icon( const QString& image, CalamaresUtils::ImageMode mode = CalamaresUtils::Original );
+    /** @brief The @p image, scaled to @p size
+     *
+     * A @p size with a width (or height) of 0 scales the image
+     * to the given height (or width), keeping the aspect ratio.
+     * An empty size leaves the image at its own size.
+     *
+     * Pixmaps can only be used in the GUI thread; see image()
+     * for loading and scaling in other threads.
+     */
     QPixmap
     pixmap( const QString& image, const QSize& size, CalamaresUtils::ImageMode mode = CalamaresUtils::Original );
+    /** @brief The @p image, scaled to @p size
+     *
+     * This is the same as pixmap(), but returns a QImage and can be
+     * called from any thread. Rendering large SVG images can be done
+     * in a worker thread this way, after which pixmap() with the same
+     * arguments is cheap.
+     */
+    QImage
+    image( const QString& image, const QSize& size, CalamaresUtils::ImageMode mode = CalamaresUtils::Original );
+
+    /** @brief Starts loading the @p image in the background
+     *
+     * The image is loaded (as with image()) in the global thread pool
+     * and ends up in the cache. Prefetching images that will be needed
+     * soon at their own size (the default) makes later calls cheap:
+     * raster images are scaled from the cached original instead of
+     * being decoded again. SVG images are rendered for each size, so
+     * prefetch those at the size they will be shown.
+     */
+    QFuture< QImage > prefetch( const QString& image,
+                                const QSize& size = QSize( 0, 0 ),
+                                CalamaresUtils::ImageMode mode = CalamaresUtils::Original );
+
+    /** @brief The @p image, scaled to @p size, without waiting for it
+     *
+     * If the image is in the cache already, the pixmap is returned and
+     * @p ready is not called. Otherwise the image is loaded in the
+     * background, a transparent placeholder of @p size (a null pixmap if
+     * @p size is partly 0) is returned, and @p ready is called later, in
+     * the GUI thread, with the real pixmap (null if it can not be loaded).
+     * If @p context is destroyed before that, @p ready is not called.
+     */
+    QPixmap pixmapAsync( const QString& image,
+                         const QSize& size,
+                         QObject* context,
+                         std::function< void( const QPixmap& ) > ready,
+                         CalamaresUtils::ImageMode mode = CalamaresUtils::Original );
+
+    /** @brief Is the @p image, scaled to @p size, in the cache?
+     *
+     * If so, pixmap() and image() with the same arguments are cheap.
+     */
+    bool isCached( const QString& image,
+                   const QSize& size,
+                   CalamaresUtils::ImageMode mode = CalamaresUtils::Original ) const;
+
+    /** @brief Sets the size limit of the cache, in KiB
+     *
+     * The default is 65536 (64MiB). Images larger than the whole
+     * cache are loaded but not cached.
+     */
+    void setCacheLimit( int kib );
+    int cacheLimit() const;
+    /// @brief The size of the cached images, in KiB
+    int cacheCost() const;
+    /// @brief Drops all the cached images
+    void clear();
 
 private:
-    qint64 cacheKey( const QSize& size );
-    void putInCache( const QString& image, const QSize& size, CalamaresUtils::ImageMode mode, const QPixmap& pixmap );
+    struct Private;
+    std::unique_ptr< Private > d;
 };
 
 #endif  // IMAGE_REGISTRY_H
@@ -0,0 +1,170 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "MemoryAccounting.h"
+
+#include "GlobalStorage.h"
+#include "JobQueue.h"
+#include "ViewManager.h"
+#include "utils/Dirs.h"
+#include "utils/ImageRegistry.h"
+#include "utils/Logger.h"
+#include "viewpages/ViewStep.h"
+
+#include <QHash>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QStringList>
+
+namespace CalamaresUtils
+{
+namespace MemoryAccounting
+{
+
+namespace
+{
+struct Entry
+{
+    MemoryUsage load;
+    MemoryUsage widget;
+    MemoryUsage activation;
+    int activations = 0;
+};
+
+struct Accounts
+{
+    QStringList order;  ///< Keys, in the order they were first seen
+    QHash< QString, Entry > entries;
+
+    Entry& entry( const QString& key )
+    {
+        if ( !entries.contains( key ) )
+        {
+            order.append( key );
+        }
+        return entries[ key ];
+    }
+};
+
+Accounts&
+accounts()
+{
+    static Accounts s_accounts;
+    return s_accounts;
+}
+
+/// @brief Module instance key of @p step, or its class name if it has none (e.g. the exec step)
+QString
+stepKey( const Calamares::ViewStep* step )
+{
+    const auto key = step->moduleInstanceKey();
+    return key.isValid() ? key.toString() : QString::fromLatin1( step->metaObject()->className() );
+}
+
+MemoryUsage
+add( const MemoryUsage& a, const MemoryUsage& b )
+{
+    MemoryUsage u;
+    u.rss = a.rss + b.rss;
+    u.pss = a.pss + b.pss;
+    u.anonymous = a.anonymous + b.anonymous;
+    u.swap = a.swap + b.swap;
+    return u;
+}
+}  // namespace
+
+void
+recordLoad( const Calamares::ModuleSystem::InstanceKey& key, const MemoryUsage& before )
+{
+    accounts().entry( key.toString() ).load = MemoryUsage::sample().delta( before );
+}
+
+void
+recordWidget( const Calamares::ViewStep* step, const MemoryUsage& before )
+{
+    if ( step )
+    {
+        accounts().entry( stepKey( step ) ).widget = MemoryUsage::sample().delta( before );
+    }
+}
+
+void
+recordActivation( const Calamares::ViewStep* step, const MemoryUsage& before )
+{
+    if ( !step )
+    {
+        return;
+    }
+    Entry& e = accounts().entry( stepKey( step ) );
+    e.activation = add( e.activation, MemoryUsage::sample().delta( before ) );
+    e.activations++;
+}
+
+QVariantMap
+report( bool withGlobalStorage )
+{
+    QVariantMap process = MemoryUsage::sample().toMap();
+    process.insert( QStringLiteral( "imageCache" ), qint64( ImageRegistry::instance()->cacheCost() ) * 1024 );
+    if ( withGlobalStorage && Calamares::JobQueue::instance() && Calamares::JobQueue::instance()->globalStorage() )
+    {
+        const QVariantMap gs = Calamares::JobQueue::instance()->globalStorage()->data();
+        process.insert( QStringLiteral( "globalStorage" ),
+                        QJsonDocument::fromVariant( gs ).toJson( QJsonDocument::Compact ).size() );
+    }
+
+    // Steps by key, so that steps without a module can be listed too
+    QHash< QString, const Calamares::ViewStep* > steps;
+    QStringList order = accounts().order;
+    const auto* viewManager = Calamares::ViewManager::instance();
+    for ( const auto* step : viewManager ? viewManager->viewSteps() : Calamares::ViewStepList() )
+    {
+        const QString key = stepKey( step );
+        steps.insert( key, step );
+        if ( !order.contains( key ) )
+        {
+            order.append( key );
+        }
+    }
+
+    QVariantList modules;
+    for ( const auto& key : qAsConst( order ) )
+    {
+        const Entry e = accounts().entries.value( key );
+        QVariantMap m { { QStringLiteral( "module" ), key },
+                        { QStringLiteral( "load" ), e.load.toMap() },
+                        { QStringLiteral( "widget" ), e.widget.toMap() },
+                        { QStringLiteral( "activation" ), e.activation.toMap() },
+                        { QStringLiteral( "activations" ), e.activations } };
+        const auto* step = steps.value( key, nullptr );
+        if ( step )
+        {
+            m.insert( QStringLiteral( "name" ), step->prettyName() );
+            m.insert( QStringLiteral( "step" ), step->memoryUsage() );
+        }
+        modules.append( m );
+    }
+
+    return QVariantMap { { QStringLiteral( "process" ), process }, { QStringLiteral( "modules" ), modules } };
+}
+
+bool
+save()
+{
+    QSaveFile f( CalamaresUtils::appLogDir().filePath( QStringLiteral( "memory-statistics.json" ) ) );
+    if ( !f.open( QIODevice::WriteOnly ) || f.write( QJsonDocument::fromVariant( report( true ) ).toJson() ) < 0
+         || !f.commit() )
+    {
+        cWarning() << "Could not write memory statistics to" << f.fileName();
+        return false;
+    }
+    return true;
+}
+
+}  // namespace MemoryAccounting
+}  // namespace CalamaresUtils
@@ -0,0 +1,79 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+/** @file Which module costs how much memory
+ *
+ * The ModuleManager and ViewManager take a CalamaresUtils::MemoryUsage
+ * sample before loading a module, before creating the widget of a view
+ * step (which may be well before it is shown) and before activating a
+ * view step, and pass it here afterwards; the difference is what that
+ * module or step cost. Together with what the view steps report themselves (see
+ * Calamares::ViewStep::memoryUsage()) and the sizes of the shared
+ * caches, this makes up the memory report that the debug window shows
+ * and that is written to memory-statistics.json next to the session log.
+ *
+ * The differences are of the whole process, so work on other threads
+ * that happens at the same time (e.g. the requirements checks) is
+ * counted towards the module or step, too. Everything here is called
+ * from the UI thread.
+ */
+
+#ifndef UTILS_MEMORYACCOUNTING_H
+#define UTILS_MEMORYACCOUNTING_H
+
+#include "DllMacro.h"
+
+#include "modulesystem/InstanceKey.h"
+#include "utils/ResourceUsage.h"
+
+#include <QVariantMap>
+
+namespace Calamares
+{
+class ViewStep;
+}
+
+namespace CalamaresUtils
+{
+namespace MemoryAccounting
+{
+/// @brief Module @p key has been loaded; @p before was sampled before that started
+UIDLLEXPORT void recordLoad( const Calamares::ModuleSystem::InstanceKey& key, const MemoryUsage& before );
+/// @brief The widget of view @p step has been created; @p before was sampled before that started
+UIDLLEXPORT void recordWidget( const Calamares::ViewStep* step, const MemoryUsage& before );
+/// @brief View @p step has been shown; @p before was sampled before that started
+UIDLLEXPORT void recordActivation( const Calamares::ViewStep* step, const MemoryUsage& before );
+
+/** @brief The memory report, as it is now
+ *
+ * The map has key *process*, with the current MemoryUsage of the
+ * process and the size of the image cache (*imageCache*), all in
+ * bytes. With @p withGlobalStorage, it also has the size of global
+ * storage (*globalStorage*, as compact JSON); that converts all of
+ * global storage, so it is not for a report that is refreshed often.
+ * Key *modules* has a list with one map per module (and view step
+ * without a module), in the order they were loaded: *module*, *name*
+ * (the pretty name of the view step, if there is one), *load*, *widget*
+ * and *activation* (MemoryUsage differences), *activations* (how often
+ * the step was shown; the activation difference is the sum) and *step*
+ * (what the view step reports itself).
+ */
+UIDLLEXPORT QVariantMap report( bool withGlobalStorage = false );
+
+/** @brief Writes the report to memory-statistics.json in the log directory
+ *
+ * The report includes the size of global storage. This may be called
+ * more than once; each time, the file is overwritten with the report
+ * as it is then.
+ */
+UIDLLEXPORT bool save();
+}  // namespace MemoryAccounting
+}  // namespace CalamaresUtils
+
+#endif
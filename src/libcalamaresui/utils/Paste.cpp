@@ -16,22 +16,32 @@
 #include "widgets/TranslationFix.h"
 
 #include <QApplication>
+#include <QBuffer>
 #include <QClipboard>
+#include <QEventLoop>
 #include <QFile>
 #include <QFileInfo>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QTcpSocket>
+#include <QTimer>
 #include <QUrl>
 #include <QWidget>
 
+#include <functional>
+
 using namespace CalamaresUtils::Units;
 
-/** @brief Reads the logfile, returns its contents.
+/// @brief Called with the number of bytes sent so far; returns @c false to cancel
+using ProgressFunction = std::function< bool( qint64 ) >;
+
+/** @brief Opens the logfile, positioned at what should be uploaded
  *
- * Returns an empty QByteArray() on any kind of error.
+ * Sets @p size to the number of bytes to upload, from the
+ * current position in @p file. Returns @c false on any kind of error.
  */
-STATICTEST QByteArray
-logFileContents( const qint64 sizeLimitBytes )
+static bool
+openLogFile( const qint64 sizeLimitBytes, QFile& file, qint64& size )
 {
     if ( sizeLimitBytes > 0 )
     {
@@ -40,68 +50,162 @@ logFileContents( const qint64 sizeLimitBytes )
     if ( sizeLimitBytes == 0 )
     {
         cDebug() << "Log upload size is 0, upload disabled.";
-        return QByteArray();
+        return false;
     }
 
-    const QString name = Logger::logFile();
-    QFile pasteSourceFile( name );
-    if ( !pasteSourceFile.open( QIODevice::ReadOnly | QIODevice::Text ) )
-    {
-        cWarning() << "Could not open log file" << name;
-        return QByteArray();
-    }
-    if ( sizeLimitBytes < 0 )
+    file.setFileName( Logger::logFile() );
+    if ( !file.open( QIODevice::ReadOnly | QIODevice::Text ) )
     {
-        return pasteSourceFile.readAll();
+        cWarning() << "Could not open log file" << file.fileName();
+        return false;
     }
-    QFileInfo fi( pasteSourceFile );
-    if ( fi.size() > sizeLimitBytes )
+    QFileInfo fi( file );
+    if ( sizeLimitBytes > 0 && fi.size() > sizeLimitBytes )
     {
         cDebug() << "Only last" << sizeLimitBytes << "bytes of log file (sized" << fi.size() << "bytes) uploaded";
         fi.refresh();  // Because we just wrote to the file with that cDebug() ^^
-        pasteSourceFile.seek( fi.size() - sizeLimitBytes );
+        file.seek( fi.size() - sizeLimitBytes );
+        size = sizeLimitBytes;
     }
-    return pasteSourceFile.read( sizeLimitBytes );
+    else
+    {
+        size = fi.size();
+    }
+    return true;
 }
 
-
-STATICTEST QString
-ficheLogUpload( const QByteArray& pasteData, const QUrl& serverUrl, QObject* parent )
+/** @brief Reads the logfile, returns its contents.
+ *
+ * Returns an empty QByteArray() on any kind of error.
+ */
+STATICTEST QByteArray
+logFileContents( const qint64 sizeLimitBytes )
 {
-    QTcpSocket* socket = new QTcpSocket( parent );
-    socket->connectToHost( serverUrl.host(), serverUrl.port() );
-
-    if ( !socket->waitForConnected() )
+    QFile file;
+    qint64 size = 0;
+    if ( !openLogFile( sizeLimitBytes, file, size ) )
     {
-        cError() << "Could not connect to paste server";
-        socket->close();
-        return QString();
+        return QByteArray();
     }
+    return sizeLimitBytes < 0 ? file.readAll() : file.read( size );
+}
 
-    cDebug() << "Connected to paste server" << serverUrl.host();
+/** @brief Sends @p size bytes from @p source to the fiche server at @p serverUrl
+ *
+ * The data is written in chunks, as the socket takes them, so it never
+ * needs to be in memory all at once. This runs an event loop until the
+ * server answers (or something fails), so the UI stays responsive
+ * meanwhile; @p progress (if set) is told how far the upload is,
+ * and can cancel it, also while connecting and while waiting
+ * for the answer.
+ *
+ * Returns the URL of the paste, or an empty string on failure.
+ */
+static QString
+ficheUpload( QIODevice* source, qint64 size, const QUrl& serverUrl, const ProgressFunction& progress )
+{
+    constexpr qint64 chunkSize = 64_KiB;
+    // Like the wait*() calls that this replaces, give up after 30s without progress
+    constexpr int timeoutMs = 30000;
+
+    QTcpSocket socket;
+    QEventLoop loop;
+    QTimer timeout;
+    timeout.setSingleShot( true );
+    timeout.setInterval( timeoutMs );
+
+    // Also ask for cancellation when the socket has nothing to say
+    QTimer cancelPoll;
+    cancelPoll.setInterval( 250 );
 
-    socket->write( pasteData );
+    qint64 sent = 0;
+    bool connected = false;
+    bool canceled = false;
+    QByteArray responseText;
 
-    if ( !socket->waitForBytesWritten() )
+    auto checkCanceled = [&]() {
+        if ( !canceled && progress && !progress( sent ) )
+        {
+            cDebug() << "Paste upload canceled";
+            canceled = true;
+            loop.quit();
+        }
+        return canceled;
+    };
+
+    auto sendChunk = [&]() {
+        timeout.start();
+        if ( checkCanceled() )
+        {
+            return;
+        }
+        if ( sent < size && socket.bytesToWrite() < chunkSize )
+        {
+            const QByteArray chunk = source->read( qMin( chunkSize, size - sent ) );
+            if ( chunk.isEmpty() )
+            {
+                size = sent;  // The file ended early
+            }
+            else
+            {
+                sent += chunk.size();
+                socket.write( chunk );
+            }
+        }
+        if ( sent >= size && !socket.bytesToWrite() )
+        {
+            cDebug() << Logger::SubEntry << "Paste data written to paste server";
+        }
+    };
+
+    QObject::connect( &socket, &QTcpSocket::connected, [&]() {
+        cDebug() << "Connected to paste server" << serverUrl.host();
+        connected = true;
+        sendChunk();
+    } );
+    QObject::connect( &socket, &QTcpSocket::bytesWritten, sendChunk );
+    QObject::connect( &socket, &QTcpSocket::readyRead, [&]() {
+        if ( checkCanceled() )
+        {
+            return;
+        }
+        if ( socket.canReadLine() )
+        {
+            cDebug() << Logger::SubEntry << "Reading response from paste server";
+            responseText = socket.readLine( 1024 );
+            loop.quit();
+        }
+    } );
+    QObject::connect( &socket, &QTcpSocket::stateChanged, [&]( QAbstractSocket::SocketState state ) {
+        if ( state == QAbstractSocket::UnconnectedState )
+        {
+            // Refused, or the server hung up without an answer
+            responseText.append( socket.readAll() );
+            loop.quit();
+        }
+    } );
+    QObject::connect( &timeout, &QTimer::timeout, &loop, &QEventLoop::quit );
+    QObject::connect( &cancelPoll, &QTimer::timeout, checkCanceled );
+
+    timeout.start();
+    cancelPoll.start();
+    socket.connectToHost( serverUrl.host(), quint16( serverUrl.port() ) );
+    loop.exec();
+    timeout.stop();
+    cancelPoll.stop();
+    socket.disconnect();
+    socket.abort();
+
+    if ( canceled )
     {
-        cError() << "Could not write to paste server";
-        socket->close();
         return QString();
     }
-
-    cDebug() << Logger::SubEntry << "Paste data written to paste server";
-
-    if ( !socket->waitForReadyRead() )
+    if ( !connected )
     {
-        cError() << "No data from paste server";
-        socket->close();
+        cError() << "Could not connect to paste server";
         return QString();
     }
 
-    cDebug() << Logger::SubEntry << "Reading response from paste server";
-    QByteArray responseText = socket->readLine( 1024 );
-    socket->close();
-
     QUrl pasteUrl = QUrl( QString( responseText ).trimmed(), QUrl::StrictMode );
     if ( pasteUrl.isValid() && pasteUrl.host() == serverUrl.host() )
     {
@@ -115,8 +219,25 @@ ficheLogUpload( const QByteArray& pasteData, const QUrl& serverUrl, QObject* par
     }
 }
 
-QString
-CalamaresUtils::Paste::doLogUpload( QObject* parent )
+STATICTEST QString
+ficheLogUpload( const QByteArray& pasteData, const QUrl& serverUrl, QObject* parent )
+{
+    Q_UNUSED( parent )
+    QBuffer buffer;
+    buffer.setData( pasteData );
+    buffer.open( QIODevice::ReadOnly );
+    return ficheUpload( &buffer, pasteData.size(), serverUrl, ProgressFunction() );
+}
+
+/** @brief Uploads the log file according to the branding
+ *
+ * The log is read from the file while it is uploaded. If there
+ * is an @p progress function, it is called first with the total
+ * number of bytes (as a negative number), then with the
+ * number of bytes sent so far.
+ */
+static QString
+logUpload( const ProgressFunction& progress )
 {
     auto [ type, serverUrl, sizeLimitBytes ] = Calamares::Branding::instance()->uploadServer();
     if ( !serverUrl.isValid() )
@@ -136,12 +257,17 @@ CalamaresUtils::Paste::doLogUpload( QObject* parent )
         return QString();
     }
 
-    QByteArray pasteData = logFileContents( sizeLimitBytes );
-    if ( pasteData.isEmpty() )
+    QFile logFile;
+    qint64 size = 0;
+    if ( !openLogFile( sizeLimitBytes, logFile, size ) || size <= 0 )
     {
         // An error has already been logged
         return QString();
     }
+    if ( progress )
+    {
+        progress( -size );
+    }
 
     switch ( type )
     {
@@ -149,16 +275,45 @@ CalamaresUtils::Paste::doLogUpload( QObject* parent )
         cWarning() << "No upload configured.";
         return QString();
     case Calamares::Branding::UploadServerType::Fiche:
-        return ficheLogUpload( pasteData, serverUrl, parent );
+        return ficheUpload( &logFile, size, serverUrl, progress );
     }
     return QString();
 }
 
+QString
+CalamaresUtils::Paste::doLogUpload( QObject* parent )
+{
+    Q_UNUSED( parent )
+    return logUpload( ProgressFunction() );
+}
+
 QString
 CalamaresUtils::Paste::doLogUploadUI( QWidget* parent )
 {
+    QProgressDialog progressDialog(
+        QCoreApplication::translate( "Calamares::ViewManager", "Uploading the install log ..." ),
+        QCoreApplication::translate( "Calamares::ViewManager", "&Cancel" ),
+        0,
+        0,
+        parent );
+    progressDialog.setWindowModality( Qt::WindowModal );
+    progressDialog.setMinimumDuration( 500 );
+    // The total comes first, as a negative number
+    QString pasteUrl = logUpload( [&progressDialog]( qint64 bytes ) {
+        if ( bytes < 0 )
+        {
+            // Progress in KiB, so that the int range is no problem
+            progressDialog.setMaximum( int( -bytes / 1024 ) + 1 );
+        }
+        else
+        {
+            progressDialog.setValue( int( bytes / 1024 ) );
+        }
+        return !progressDialog.wasCanceled();
+    } );
+    progressDialog.reset();
+
     // These strings originated in the ViewManager class
-    QString pasteUrl = CalamaresUtils::Paste::doLogUpload( parent );
     QString pasteUrlMessage;
     if ( pasteUrl.isEmpty() )
     {
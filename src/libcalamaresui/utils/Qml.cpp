@@ -19,7 +19,9 @@
 #include "utils/Logger.h"
 
 #include <QByteArray>
+#include <QCoreApplication>
 #include <QObject>
+#include <QQmlEngine>
 #include <QQuickItem>
 #include <QString>
 #include <QVariant>
@@ -234,6 +236,10 @@ registerQmlModels()
             "io.calamares.core", 1, 0, "Global", []( QQmlEngine*, QJSEngine* ) -> QObject* {
                 return Calamares::JobQueue::instance()->globalStorage();
             } );
+        qmlRegisterSingletonType< Calamares::JobQueue >(
+            "io.calamares.core", 1, 0, "JobQueue", []( QQmlEngine*, QJSEngine* ) -> QObject* {
+                return Calamares::JobQueue::instance();
+            } );
         qmlRegisterSingletonType< CalamaresUtils::Network::Manager >(
             "io.calamares.core", 1, 0, "Network", []( QQmlEngine*, QJSEngine* ) -> QObject* {
                 return &CalamaresUtils::Network::Manager::instance();
@@ -241,4 +247,17 @@ registerQmlModels()
     }
 }
 
+QQmlEngine*
+qmlEngine()
+{
+    static QQmlEngine* engine = nullptr;
+    if ( !engine )
+    {
+        registerQmlModels();
+        engine = new QQmlEngine( QCoreApplication::instance() );
+        engine->addImportPath( qmlModulesDir().absolutePath() );
+    }
+    return engine;
+}
+
 }  // namespace CalamaresUtils
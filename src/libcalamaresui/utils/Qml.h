@@ -17,6 +17,7 @@
 
 #include <QDir>
 
+class QQmlEngine;
 class QQuickItem;
 
 namespace CalamaresUtils
@@ -48,6 +49,16 @@ UIDLLEXPORT bool initQmlModulesDir();
  */
 UIDLLEXPORT void registerQmlModels();
 
+/** @brief The QML engine shared by the Calamares QML views
+ *
+ * The engine is created on first use, with the global Calamares models
+ * registered (see registerQmlModels()) and the QML modules directory
+ * in its import path. Views that need their own context properties
+ * should create a child context of the engine's root context, since
+ * the root context is shared by all the views.
+ */
+UIDLLEXPORT QQmlEngine* qmlEngine();
+
 /** @brief Calls the QML method @p method on @p qmlObject
  *
  * Pass in only the name of the method (e.g. onActivate). This function
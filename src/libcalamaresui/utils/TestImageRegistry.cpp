@@ -0,0 +1,133 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "ImageRegistry.h"
+
+#include <QTemporaryDir>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtTest/QtTest>
+
+class TestImageRegistry : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestImageRegistry() {}
+    ~TestImageRegistry() override {}
+
+private Q_SLOTS:
+    void initTestCase();
+    void testSizes();
+    void testLimit();
+    void testThreads();
+    void testPrefetch();
+    void testScaledDecode();
+
+private:
+    QTemporaryDir m_dir;
+    QString m_path;
+};
+
+void
+TestImageRegistry::initTestCase()
+{
+    QVERIFY( m_dir.isValid() );
+    m_path = m_dir.filePath( "image.png" );
+    QImage i( 4, 8, QImage::Format_ARGB32 );
+    i.fill( Qt::red );
+    QVERIFY( i.save( m_path ) );
+}
+
+void
+TestImageRegistry::testSizes()
+{
+    ImageRegistry r;
+
+    // The original size
+    QCOMPARE( r.image( m_path, QSize( 0, 0 ) ).size(), QSize( 4, 8 ) );
+    // These two used to share a cache slot
+    QCOMPARE( r.image( m_path, QSize( 1, 10 ) ).size(), QSize( 1, 10 ) );
+    QCOMPARE( r.image( m_path, QSize( 2, 0 ) ).size(), QSize( 2, 4 ) );
+    // And again, from the cache
+    QCOMPARE( r.image( m_path, QSize( 1, 10 ) ).size(), QSize( 1, 10 ) );
+    QCOMPARE( r.image( m_path, QSize( 2, 0 ) ).size(), QSize( 2, 4 ) );
+    QCOMPARE( r.image( m_path, QSize( 0, 16 ) ).size(), QSize( 8, 16 ) );
+
+    QVERIFY( r.image( m_dir.filePath( "missing.png" ), QSize( 10, 10 ) ).isNull() );
+}
+
+void
+TestImageRegistry::testLimit()
+{
+    ImageRegistry r;
+    QCOMPARE( r.cacheLimit(), 65536 );
+
+    // Nothing fits in the cache, but images are still loaded
+    r.setCacheLimit( 0 );
+    QCOMPARE( r.cacheLimit(), 0 );
+    QCOMPARE( r.image( m_path, QSize( 100, 100 ) ).size(), QSize( 100, 100 ) );
+    QCOMPARE( r.image( m_path, QSize( 100, 100 ) ).size(), QSize( 100, 100 ) );
+
+    r.setCacheLimit( 1024 );
+    QCOMPARE( r.image( m_path, QSize( 100, 100 ) ).size(), QSize( 100, 100 ) );
+    r.clear();
+    QCOMPARE( r.image( m_path, QSize( 100, 100 ) ).size(), QSize( 100, 100 ) );
+}
+
+void
+TestImageRegistry::testThreads()
+{
+    ImageRegistry r;
+    QList< QFuture< QSize > > futures;
+    for ( int i = 1; i <= 32; ++i )
+    {
+        futures.append(
+            QtConcurrent::run( [&r, this, i]() { return r.image( m_path, QSize( i % 8 + 1, i ) ).size(); } ) );
+    }
+    for ( int i = 1; i <= 32; ++i )
+    {
+        QCOMPARE( futures[ i - 1 ].result(), QSize( i % 8 + 1, i ) );
+    }
+}
+
+void
+TestImageRegistry::testPrefetch()
+{
+    ImageRegistry r;
+    auto future = r.prefetch( m_path );
+    QCOMPARE( future.result().size(), QSize( 4, 8 ) );
+    // Scaled from the prefetched original
+    QCOMPARE( r.image( m_path, QSize( 2, 0 ) ).size(), QSize( 2, 4 ) );
+    QCOMPARE( r.image( m_path, QSize( 0, 0 ) ).pixelColor( 0, 0 ), QColor( Qt::red ) );
+
+    QVERIFY( r.prefetch( m_dir.filePath( "missing.png" ) ).result().isNull() );
+}
+
+void
+TestImageRegistry::testScaledDecode()
+{
+    const QString path = m_dir.filePath( "large.jpg" );
+    QImage i( 800, 400, QImage::Format_RGB32 );
+    i.fill( Qt::blue );
+    QVERIFY( i.save( path ) );
+
+    ImageRegistry r;
+    // Decoded at (about) the wanted size, then made exact
+    QCOMPARE( r.image( path, QSize( 100, 0 ) ).size(), QSize( 100, 50 ) );
+    QCOMPARE( r.image( path, QSize( 0, 30 ) ).size(), QSize( 60, 30 ) );
+    QCOMPARE( r.image( path, QSize( 33, 33 ) ).size(), QSize( 33, 33 ) );
+    const QColor c = r.image( path, QSize( 100, 0 ) ).pixelColor( 50, 25 );
+    QVERIFY( c.blue() > 200 && c.red() < 50 );
+}
+
+QTEST_GUILESS_MAIN( TestImageRegistry )
+
+#include "utils/moc-warnings.h"
+
+#include "TestImageRegistry.moc"
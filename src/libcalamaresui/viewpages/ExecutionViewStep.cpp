@@ -59,11 +59,15 @@ ExecutionViewStep::ExecutionViewStep( QObject* parent )
     , m_widget( new QWidget )
     , m_progressBar( new QProgressBar )
     , m_label( new QLabel )
+    , m_slowLabel( new QLabel )
     , m_slideshow( makeSlideshow( m_widget ) )
 {
     m_widget->setObjectName( "slideshow" );
     m_progressBar->setObjectName( "exec-progress" );
     m_label->setObjectName( "exec-message" );
+    m_slowLabel->setObjectName( "exec-slow-message" );
+    m_slowLabel->setWordWrap( true );
+    m_slowLabel->hide();
 
     QVBoxLayout* layout = new QVBoxLayout( m_widget );
     QVBoxLayout* innerLayout = new QVBoxLayout;
@@ -77,8 +81,12 @@ ExecutionViewStep::ExecutionViewStep( QObject* parent )
     innerLayout->addSpacing( CalamaresUtils::defaultFontHeight() / 2 );
     innerLayout->addWidget( m_progressBar );
     innerLayout->addWidget( m_label );
+    innerLayout->addWidget( m_slowLabel );
 
     connect( JobQueue::instance(), &JobQueue::progress, this, &ExecutionViewStep::updateFromJobQueue );
+    connect(
+        JobQueue::instance(), &JobQueue::remainingTimeChanged, this, &ExecutionViewStep::updateRemainingTime );
+    connect( JobQueue::instance(), &JobQueue::jobSlow, this, &ExecutionViewStep::updateSlowJob );
 }
 
 
@@ -140,35 +148,13 @@ ExecutionViewStep::onActivate()
 {
     m_slideshow->changeSlideShowState( Slideshow::Start );
 
-    const auto instanceDescriptors = Calamares::Settings::instance()->moduleInstances();
-
     JobQueue* queue = JobQueue::instance();
+    auto* moduleManager = Calamares::ModuleManager::instance();
     for ( const auto& instanceKey : m_jobInstanceKeys )
     {
-        const auto& moduleDescriptor = Calamares::ModuleManager::instance()->moduleDescriptor( instanceKey );
-        Calamares::Module* module = Calamares::ModuleManager::instance()->moduleInstance( instanceKey );
-
-        const auto instanceDescriptor
-            = std::find_if( instanceDescriptors.constBegin(),
-                            instanceDescriptors.constEnd(),
-                            [=]( const Calamares::InstanceDescription& d ) { return d.key() == instanceKey; } );
-        int weight = moduleDescriptor.weight();
-        if ( instanceDescriptor != instanceDescriptors.constEnd() && instanceDescriptor->explicitWeight() )
-        {
-            weight = instanceDescriptor->weight();
-        }
-        weight = qBound( 1, weight, 100 );
-        if ( module )
+        if ( moduleManager->moduleInstance( instanceKey ) )
         {
-            auto jl = module->jobs();
-            if ( module->isEmergency() )
-            {
-                for ( auto& j : jl )
-                {
-                    j->setEmergency( true );
-                }
-            }
-            queue->enqueue( weight, jl );
+            queue->enqueue( moduleManager->instanceWeight( instanceKey ), moduleManager->instanceJobs( instanceKey ) );
         }
     }
 
@@ -193,13 +179,53 @@ ExecutionViewStep::appendJobModuleInstanceKey( const ModuleSystem::InstanceKey&
 void
 ExecutionViewStep::updateFromJobQueue( qreal percent, const QString& message )
 {
-    m_progressBar->setValue( int( percent * m_progressBar->maximum() ) );
-    if ( !message.isEmpty() )
+    // Progress is coalesced by the queue, but avoid repaints
+    // when nothing visible changes anyway.
+    const int value = int( percent * m_progressBar->maximum() );
+    if ( value != m_progressBar->value() )
+    {
+        m_progressBar->setValue( value );
+    }
+    if ( !message.isEmpty() && message != m_label->text() )
     {
         m_label->setText( message );
     }
 }
 
+void
+ExecutionViewStep::updateRemainingTime( int seconds )
+{
+    if ( seconds < 0 )
+    {
+        m_progressBar->setFormat( QStringLiteral( "%p%" ) );
+    }
+    else if ( seconds < 60 )
+    {
+        m_progressBar->setFormat( tr( "%p% (less than a minute left)" ) );
+    }
+    else
+    {
+        // Round up, so that "1 minute" means "a bit less than a minute"
+        m_progressBar->setFormat( tr( "%p% (about %n minute(s) left)", nullptr, ( seconds + 59 ) / 60 ) );
+    }
+}
+
+void
+ExecutionViewStep::updateSlowJob( const QString& prettyName, int seconds )
+{
+    if ( prettyName.isEmpty() )
+    {
+        m_slowLabel->hide();
+        return;
+    }
+    m_slowLabel->setText( tr( "%1 is taking longer than expected (%n minute(s) so far). "
+                              "The installation log has details.",
+                              nullptr,
+                              seconds / 60 )
+                              .arg( prettyName ) );
+    m_slowLabel->show();
+}
+
 void
 ExecutionViewStep::onLeave()
 {
@@ -55,11 +55,14 @@ private:
     QWidget* m_widget;
     QProgressBar* m_progressBar;
     QLabel* m_label;
+    QLabel* m_slowLabel;  ///< "taking longer than expected", hidden unless so
     Slideshow* m_slideshow;
 
     QList< ModuleSystem::InstanceKey > m_jobInstanceKeys;
 
     void updateFromJobQueue( qreal percent, const QString& message );
+    void updateRemainingTime( int seconds );
+    void updateSlowJob( const QString& prettyName, int seconds );
 };
 
 }  // namespace Calamares
@@ -17,6 +17,8 @@
 
 #include <PythonQt.h>
 
+#include <QFutureWatcher>
+
 
 Utils::Utils( QObject* parent )
     : QObject( parent )
@@ -25,6 +27,11 @@ Utils::Utils( QObject* parent )
     PythonQt::self()->evalScript( m_exceptionCxt, "import subprocess" );
 }
 
+Utils::~Utils()
+{
+    m_cancellation.cancel();
+}
+
 
 void
 Utils::debug( const QString& s ) const
@@ -104,6 +111,76 @@ Utils::obscure( const QString& string ) const
 }
 
 
+void
+Utils::target_env_call_async( const QStringList& args, PyObject* callback, const QString& stdin, int timeout )
+{
+    runAsync( args, stdin, timeout, callback, false );
+}
+
+
+void
+Utils::target_env_output_async( const QStringList& args, PyObject* callback, const QString& stdin, int timeout )
+{
+    runAsync( args, stdin, timeout, callback, true );
+}
+
+
+void
+Utils::cancel_pending_calls()
+{
+    // The watchers still finish, and count down m_pending
+    m_cancellation.cancel();
+    m_cancellation = CalamaresUtils::Executor::Cancellation();
+}
+
+
+void
+Utils::runAsync( const QStringList& args, const QString& stdin, int timeout, PyObject* callback, bool withOutput )
+{
+    if ( !callback || !PyCallable_Check( callback ) )
+    {
+        cWarning() << "PythonQt asynchronous command" << args << "needs a callable.";
+        return;
+    }
+
+    // The callback is only touched on this (the UI) thread: the worker
+    // runs the command, and nothing else.
+    PythonQtObjectPtr ready( callback );
+    // A plain pair, since QtConcurrent needs a default-constructible result
+    using Watcher = QFutureWatcher< QPair< int, QString > >;
+    auto* watcher = new Watcher( this );
+    const auto cancellation = m_cancellation;
+    connect( watcher, &Watcher::finished, this, [ this, watcher, ready, withOutput, cancellation ]() {
+        watcher->deleteLater();
+        --m_pending;
+        if ( cancellation.isCancelled() )
+        {
+            return;
+        }
+        const auto r = watcher->result();
+        QVariantList results { r.first };
+        if ( withOutput )
+        {
+            results.append( r.second );
+        }
+        PythonQt::self()->call( ready, results );
+    } );
+
+    ++m_pending;
+    // Target commands can take long; they should not hold up the lookups the UI waits for
+    watcher->setFuture( CalamaresUtils::Executor::run(
+        CalamaresUtils::Executor::Lane::Background,
+        "pythonqt-command",
+        cancellation,
+        [ args, stdin, timeout ]( const CalamaresUtils::Executor::Cancellation& c ) {
+            // So that the command itself is stopped, too
+            CalamaresUtils::Executor::CancellationScope scope( c );
+            return QPair< int, QString >( CalamaresUtils::System::instance()->targetEnvCommand(
+                args, QString(), stdin, std::chrono::seconds( timeout > 0 ? timeout : 0 ) ) );
+        } ) );
+}
+
+
 int
 Utils::_handle_check_target_env_call_error( int ec, const QString& cmd ) const
 {
@@ -10,6 +10,8 @@
 #ifndef PYTHONQTUTILSWRAPPER_H
 #define PYTHONQTUTILSWRAPPER_H
 
+#include "utils/Executor.h"
+
 #include <PythonQtObjectPtr.h>
 
 #include <QObject>
@@ -24,7 +26,7 @@ class Utils : public QObject
     Q_OBJECT
 public:
     explicit Utils( QObject* parent = nullptr );
-    virtual ~Utils() {}
+    ~Utils() override;
 
 public slots:
     void debug( const QString& s ) const;
@@ -48,10 +50,46 @@ public slots:
 
     QString obscure( const QString& string ) const;
 
+    /** @brief Runs @p args in the target without blocking the UI
+     *
+     * The command runs in the Background lane of the Executor; when it is done, @p callback
+     * is called (on the UI thread, like all Python code in a PythonQt
+     * module) with the exit code. Nothing is raised for a non-zero
+     * exit code, since there is no caller any more to raise it in.
+     */
+    void target_env_call_async( const QStringList& args,
+                                PyObject* callback,
+                                const QString& stdin = QString(),
+                                int timeout = 0 );
+
+    /** @brief Runs @p args in the target without blocking the UI, for the output
+     *
+     * This is like target_env_call_async(), but @p callback is called
+     * with the exit code and the output of the command.
+     */
+    void target_env_output_async( const QStringList& args,
+                                  PyObject* callback,
+                                  const QString& stdin = QString(),
+                                  int timeout = 0 );
+
+    /// @brief The number of asynchronous commands that have not called back yet
+    int pending_calls() const { return m_pending; }
+
+    /** @brief Stops the asynchronous commands that have not called back yet
+     *
+     * Commands that have not started do not run, and running ones are
+     * stopped; none of their callbacks is called. Later calls run
+     * as usual. This also happens when the Utils object is destroyed.
+     */
+    void cancel_pending_calls();
+
 private:
     inline int _handle_check_target_env_call_error( int ec, const QString& cmd ) const;
+    void runAsync( const QStringList& args, const QString& stdin, int timeout, PyObject* callback, bool withOutput );
 
     PythonQtObjectPtr m_exceptionCxt;
+    int m_pending = 0;
+    CalamaresUtils::Executor::Cancellation m_cancellation;
 };
 
 #endif  // PYTHONQTUTILSWRAPPER_H
@@ -16,6 +16,7 @@
 #include "utils/Logger.h"
 #include "utils/NamedEnum.h"
 #include "utils/Qml.h"
+#include "utils/Trace.h"
 #include "utils/Variant.h"
 #include "widgets/WaitingWidget.h"
 
@@ -65,16 +66,20 @@ QmlViewStep::QmlViewStep( QObject* parent )
     : ViewStep( parent )
     , m_widget( new QWidget )
     , m_spinner( new WaitingWidget( tr( "Loading ..." ) ) )
-    , m_qmlWidget( new QQuickWidget )
+    , m_qmlWidget( nullptr )
 {
-    CalamaresUtils::registerQmlModels();
+    {
+        CalamaresUtils::Trace::Span span( "QQuickWidget", "qml" );
+        // All the QML steps share one engine, each with its own context
+        m_qmlWidget = new QQuickWidget( CalamaresUtils::qmlEngine(), nullptr );
+        m_qmlContext = new QQmlContext( CalamaresUtils::qmlEngine()->rootContext(), this );
+    }
 
     QVBoxLayout* layout = new QVBoxLayout( m_widget );
     layout->addWidget( m_spinner );
 
     m_qmlWidget->setSizePolicy( QSizePolicy::Expanding, QSizePolicy::Expanding );
     m_qmlWidget->setResizeMode( QQuickWidget::SizeRootObjectToView );
-    m_qmlWidget->engine()->addImportPath( CalamaresUtils::qmlModulesDir().absolutePath() );
 
     // QML Loading starts when the configuration for the module is set.
 }
@@ -125,6 +130,19 @@ QmlViewStep::onActivate()
     {
         changeQMLState( QMLAction::Start, m_qmlObject );
     }
+    else if ( m_qmlComponent && m_qmlComponent->isReady() )
+    {
+        // First visit, create the object now; showQml() activates it
+        createQmlObject();
+    }
+}
+
+QVariantMap
+QmlViewStep::memoryUsage() const
+{
+    // The engine is shared, and Qt does not say how large its heap is
+    const int objects = m_qmlObject ? m_qmlObject->findChildren< QObject* >().count() + 1 : 0;
+    return QVariantMap { { QStringLiteral( "qmlObjects" ), objects } };
 }
 
 void
@@ -168,29 +186,48 @@ QmlViewStep::loadComplete()
     }
     if ( m_qmlComponent->isReady() && !m_qmlObject )
     {
-        cDebug() << Logger::SubEntry << "QML component complete" << m_qmlFileName << "creating object";
         // Don't do this again
         disconnect( m_qmlComponent, &QQmlComponent::statusChanged, this, &QmlViewStep::loadComplete );
 
-        QObject* o = m_qmlComponent->create();
-        m_qmlObject = qobject_cast< QQuickItem* >( o );
-        if ( !m_qmlObject )
+        // Pages that are not visible yet are created on their first visit
+        if ( ViewManager::instance()->currentStep() == this )
         {
-            cError() << Logger::SubEntry << "Could not create QML from" << m_qmlFileName;
-            delete o;
+            createQmlObject();
         }
         else
         {
-            // setContent() is public API, but not documented publicly.
-            // It is marked \internal in the Qt sources, but does exactly
-            // what is needed: sets up visual parent by replacing the root
-            // item, and handling resizes.
-            m_qmlWidget->setContent( QUrl( m_qmlFileName ), m_qmlComponent, m_qmlObject );
-            showQml();
+            cDebug() << Logger::SubEntry << "QML component complete" << m_qmlFileName << "deferring object";
         }
     }
 }
 
+void
+QmlViewStep::createQmlObject()
+{
+    cDebug() << "QML component" << m_qmlFileName << "creating object";
+    CalamaresUtils::Trace::Span span( "QML create", "qml" );
+
+    QObject* o = m_qmlComponent->create( m_qmlContext );
+    m_qmlObject = qobject_cast< QQuickItem* >( o );
+    if ( !m_qmlObject )
+    {
+        cError() << Logger::SubEntry << "Could not create QML from" << m_qmlFileName;
+        delete o;
+        // Don't try again on the next visit
+        m_qmlComponent->deleteLater();
+        m_qmlComponent = nullptr;
+    }
+    else
+    {
+        // setContent() is public API, but not documented publicly.
+        // It is marked \internal in the Qt sources, but does exactly
+        // what is needed: sets up visual parent by replacing the root
+        // item, and handling resizes.
+        m_qmlWidget->setContent( QUrl( m_qmlFileName ), m_qmlComponent, m_qmlObject );
+        showQml();
+    }
+}
+
 void
 QmlViewStep::showQml()
 {
@@ -244,7 +281,7 @@ QmlViewStep::setConfigurationMap( const QVariantMap& configurationMap )
 
         cDebug() << "QmlViewStep" << moduleInstanceKey() << "loading" << m_qmlFileName;
         m_qmlComponent = new QQmlComponent(
-            m_qmlWidget->engine(), QUrl( m_qmlFileName ), QQmlComponent::CompilationMode::Asynchronous );
+            CalamaresUtils::qmlEngine(), QUrl( m_qmlFileName ), QQmlComponent::CompilationMode::Asynchronous );
         connect( m_qmlComponent, &QQmlComponent::statusChanged, this, &QmlViewStep::loadComplete );
         if ( m_qmlComponent->status() == QQmlComponent::Error )
         {
@@ -277,7 +314,7 @@ QmlViewStep::getConfig()
 void
 QmlViewStep::setContextProperty( const char* name, QObject* property )
 {
-    m_qmlWidget->engine()->rootContext()->setContextProperty( name, property );
+    m_qmlContext->setContextProperty( name, property );
 }
 
 }  // namespace Calamares
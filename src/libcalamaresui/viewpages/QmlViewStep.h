@@ -14,6 +14,7 @@
 #include "viewpages/ViewStep.h"
 
 class QQmlComponent;
+class QQmlContext;
 class QQuickItem;
 class QQuickWidget;
 class WaitingWidget;
@@ -32,6 +33,11 @@ namespace Calamares
  * - jobs() if there is real work to be done during installation
  * - getConfig() to return a meaningful configuration object
  *
+ * All QML view steps share one QML engine (see CalamaresUtils::qmlEngine());
+ * each step has its own context for the *config* property. The QML
+ * is loaded asynchronously when the configuration is set, but the
+ * object is not created until the step is first shown.
+ *
  * For details on the interaction between the config object and
  * the QML in the module, see the module documentation:
  *      src/modules/README.md
@@ -66,6 +72,9 @@ public:
     virtual void onActivate() override;
     virtual void onLeave() override;
 
+    /// @brief The number of objects created from the QML, under key *qmlObjects*
+    virtual QVariantMap memoryUsage() const override;
+
     /// @brief QML widgets don't produce jobs by default
     virtual JobList jobs() const override;
 
@@ -96,6 +105,8 @@ private Q_SLOTS:
     void loadComplete();
 
 private:
+    /// @brief Create the QML object from the (loaded) component and show it
+    void createQmlObject();
     /// @brief Swap out the spinner for the QQuickWidget
     void showQml();
     /// @brief Show error message in spinner.
@@ -110,6 +121,7 @@ private:
     QWidget* m_widget = nullptr;
     WaitingWidget* m_spinner = nullptr;
     QQuickWidget* m_qmlWidget = nullptr;
+    QQmlContext* m_qmlContext = nullptr;
     QQmlComponent* m_qmlComponent = nullptr;
     QQuickItem* m_qmlObject = nullptr;
 };
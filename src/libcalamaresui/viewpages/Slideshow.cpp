@@ -13,12 +13,15 @@
 
 #include "Branding.h"
 #include "utils/Dirs.h"
+#include "utils/ImageRegistry.h"
 #include "utils/Logger.h"
 #ifdef WITH_QML
 #include "utils/Qml.h"
 #endif
 #include "utils/Retranslator.h"
+#include "utils/Trace.h"
 
+#include <QImageReader>
 #include <QLabel>
 #include <QMutexLocker>
 #ifdef WITH_QML
@@ -39,10 +42,14 @@ Slideshow::~Slideshow() {}
 #ifdef WITH_QML
 SlideshowQML::SlideshowQML( QWidget* parent )
     : Slideshow( parent )
-    , m_qmlShow( new QQuickWidget )
+    , m_qmlShow( nullptr )
     , m_qmlComponent( nullptr )
     , m_qmlObject( nullptr )
 {
+    {
+        CalamaresUtils::Trace::Span span( "QQuickWidget (slideshow)", "qml" );
+        m_qmlShow = new QQuickWidget;
+    }
     m_qmlShow->setObjectName( "qml" );
 
     CalamaresUtils::registerQmlModels();
@@ -61,6 +68,14 @@ SlideshowQML::SlideshowQML( QWidget* parent )
         cDebug() << "QML load on startup, API 2.";
         loadQmlV2();
     }
+    else if ( !Calamares::Branding::instance()->slideshowPath().isEmpty() )
+    {
+        // The engine caches what it has compiled, so the setSource()
+        // on activation does not need to read and compile the QML.
+        m_qmlComponent = new QQmlComponent( m_qmlShow->engine(),
+                                            Calamares::Branding::instance()->slideshowUrl(),
+                                            QQmlComponent::CompilationMode::Asynchronous );
+    }
 }
 
 SlideshowQML::~SlideshowQML()
@@ -83,7 +98,7 @@ SlideshowQML::loadQmlV2()
     if ( !m_qmlComponent && !Calamares::Branding::instance()->slideshowPath().isEmpty() )
     {
         m_qmlComponent = new QQmlComponent( m_qmlShow->engine(),
-                                            QUrl::fromLocalFile( Calamares::Branding::instance()->slideshowPath() ),
+                                            Calamares::Branding::instance()->slideshowUrl(),
                                             QQmlComponent::CompilationMode::Asynchronous );
         connect( m_qmlComponent, &QQmlComponent::statusChanged, this, &SlideshowQML::loadQmlV2Complete );
     }
@@ -113,8 +128,7 @@ SlideshowQML::loadQmlV2Complete()
             // It is marked \internal in the Qt sources, but does exactly
             // what is needed: sets up visual parent by replacing the root
             // item, and handling resizes.
-            m_qmlShow->setContent(
-                QUrl::fromLocalFile( Calamares::Branding::instance()->slideshowPath() ), m_qmlComponent, m_qmlObject );
+            m_qmlShow->setContent( Calamares::Branding::instance()->slideshowUrl(), m_qmlComponent, m_qmlObject );
             if ( isActive() )
             {
                 // We're alreay visible! Must have been slow QML loading, and we
@@ -171,7 +185,7 @@ SlideshowQML::changeSlideShowState( Action state )
         // API version 1 assumes onCompleted is the trigger
         if ( activate )
         {
-            m_qmlShow->setSource( QUrl::fromLocalFile( Calamares::Branding::instance()->slideshowPath() ) );
+            m_qmlShow->setSource( Calamares::Branding::instance()->slideshowUrl() );
         }
         // needs the root object for property setting, below
         m_qmlObject = m_qmlShow->rootObject();
@@ -211,6 +225,15 @@ SlideshowPictures::SlideshowPictures( QWidget* parent )
     m_label->setAlignment( Qt::AlignCenter );
     m_timer->setInterval( std::chrono::milliseconds( 2000 ) );
     connect( m_timer, &QTimer::timeout, this, &SlideshowPictures::next );
+
+    // Load them all while the disk is not yet busy installing; showing
+    // them at a (smaller) size later is then only a matter of scaling.
+    m_imageSizes.reserve( m_images.count() );
+    for ( const auto& path : qAsConst( m_images ) )
+    {
+        m_imageSizes.append( QImageReader( path ).size() );
+        ImageRegistry::instance()->prefetch( path );
+    }
 }
 
 SlideshowPictures::~SlideshowPictures()
@@ -277,7 +300,47 @@ SlideshowPictures::next()
         return;
     }
 
-    m_label->setPixmap( QPixmap( m_images.at( m_imageIndex ) ) );
+    showImage( m_imageIndex );
+}
+
+QSize
+SlideshowPictures::imageSize( int index ) const
+{
+    const QSize own = m_imageSizes.value( index );
+    const QSize bounds = m_label->size();
+    if ( !own.isValid() || bounds.isEmpty() || ( own.width() <= bounds.width() && own.height() <= bounds.height() ) )
+    {
+        // At its own size, as it always was
+        return QSize( 0, 0 );
+    }
+    // Too big, so shrink to fit
+    return own.scaled( bounds, Qt::KeepAspectRatio );
+}
+
+void
+SlideshowPictures::showImage( int index )
+{
+    auto* registry = ImageRegistry::instance();
+    const QString path = m_images.at( index );
+    const QSize size = imageSize( index );
+    if ( registry->isCached( path, size ) )
+    {
+        m_label->setPixmap( registry->pixmap( path, size ) );
+    }
+    else
+    {
+        // Keep showing the previous image until this one is ready
+        registry->pixmapAsync( path, size, this, [this, index]( const QPixmap& pixmap ) {
+            if ( m_imageIndex == index )
+            {
+                m_label->setPixmap( pixmap );
+            }
+        } );
+    }
+
+    // Get the next one ready at the size it will be shown
+    const int nextIndex = ( index + 1 ) % m_images.count();
+    registry->prefetch( m_images.at( nextIndex ), imageSize( nextIndex ) );
 }
 
 
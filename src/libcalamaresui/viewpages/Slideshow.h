@@ -15,7 +15,9 @@
 #include "CalamaresConfig.h"
 
 #include <QMutex>
+#include <QSize>
 #include <QStringList>
+#include <QVector>
 #include <QWidget>
 
 class QLabel;
@@ -84,7 +86,9 @@ protected:
  * Branding settings *slideshow* and *slideshowAPI*, showing the QML
  * file from *slideshow*. The API version influences when and how the
  * QML is loaded; version 1 does so only when the slideshow is activated,
- * while version 2 does so asynchronously.
+ * while version 2 does so asynchronously. For version 1, the QML is
+ * still compiled asynchronously when the slideshow is created, so
+ * that activating it only needs to create the objects.
  */
 class SlideshowQML : public Slideshow
 {
@@ -105,7 +109,7 @@ public slots:
 
 private:
     QQuickWidget* m_qmlShow;
-    QQmlComponent* m_qmlComponent;
+    QQmlComponent* m_qmlComponent;  ///< For API 1, only for compiling it early
     QQuickItem* m_qmlObject;  ///< The actual show
 };
 #endif
@@ -117,6 +121,10 @@ private:
  * do not use QML at all. It is configured through the Branding
  * setting *slideshow*. When using this widget, the setting must
  * be a list of filenames; the API is set to -1.
+ *
+ * The images are loaded into memory in the background when the
+ * slideshow is created, long before it is shown, so that showing
+ * them does not compete for the disk with the installation.
  */
 class SlideshowPictures : public Slideshow
 {
@@ -132,10 +140,16 @@ public slots:
     void next();
 
 private:
+    /// @brief The size to show image @p index at, in the label
+    QSize imageSize( int index ) const;
+    /// @brief Shows image @p index, once it has been loaded
+    void showImage( int index );
+
     QLabel* m_label;
     QTimer* m_timer;
     int m_imageIndex;
     QStringList m_images;
+    QVector< QSize > m_imageSizes;  ///< Their own sizes
 };
 
 }  // namespace Calamares
@@ -0,0 +1,118 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "PythonQtUtilsWrapper.h"
+
+#include "GlobalStorage.h"
+#include "JobQueue.h"
+#include "utils/CalamaresUtilsSystem.h"
+#include "utils/Logger.h"
+
+#include <PythonQt.h>
+
+#include <QtTest/QtTest>
+
+class TestPythonQtUtilsWrapper : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestPythonQtUtilsWrapper() {}
+    ~TestPythonQtUtilsWrapper() override {}
+
+private Q_SLOTS:
+    void initTestCase();
+    void testCallAsync();
+    void testOutputAsync();
+    void testCancel();
+};
+
+void
+TestPythonQtUtilsWrapper::initTestCase()
+{
+    Logger::setupLogLevel( Logger::LOGDEBUG );
+    // Without chroot, and with a JobQueue, the "target" is /
+    if ( !Calamares::JobQueue::instance() )
+    {
+        (void)new Calamares::JobQueue();
+    }
+    if ( !CalamaresUtils::System::instance() )
+    {
+        (void)new CalamaresUtils::System( false );
+    }
+    PythonQt::init( PythonQt::IgnoreSiteModule );
+}
+
+void
+TestPythonQtUtilsWrapper::testCallAsync()
+{
+    Utils utils;
+    PythonQtObjectPtr cxt = PythonQt::self()->createUniqueModule();
+    cxt.addObject( "utils", &utils );
+    cxt.evalScript( "results = []\n"
+                    "utils.target_env_call_async(['true'], lambda ec: results.append(ec))\n"
+                    "utils.target_env_call_async(['false'], lambda ec: results.append(ec))\n" );
+    QCOMPARE( utils.pending_calls(), 2 );
+    QTRY_COMPARE( utils.pending_calls(), 0 );
+
+    // Either may call back first
+    QVariantList results = cxt.getVariable( "results" ).toList();
+    QCOMPARE( results.count(), 2 );
+    QVERIFY( results.contains( 0 ) );
+    QVERIFY( results.contains( 1 ) );
+}
+
+void
+TestPythonQtUtilsWrapper::testOutputAsync()
+{
+    Utils utils;
+    PythonQtObjectPtr cxt = PythonQt::self()->createUniqueModule();
+    cxt.addObject( "utils", &utils );
+    cxt.evalScript( "results = []\n"
+                    "utils.target_env_output_async(['echo', 'hi'], lambda ec, out: results.extend([ec, out]))\n" );
+    QTRY_COMPARE( utils.pending_calls(), 0 );
+
+    QVariantList results = cxt.getVariable( "results" ).toList();
+    QCOMPARE( results.count(), 2 );
+    QCOMPARE( results.at( 0 ).toInt(), 0 );
+    QCOMPARE( results.at( 1 ).toString().trimmed(), QStringLiteral( "hi" ) );
+
+    // Not a callable: nothing happens
+    cxt.evalScript( "utils.target_env_output_async(['echo', 'hi'], 1)\n" );
+    QCOMPARE( utils.pending_calls(), 0 );
+}
+
+void
+TestPythonQtUtilsWrapper::testCancel()
+{
+    Utils utils;
+    PythonQtObjectPtr cxt = PythonQt::self()->createUniqueModule();
+    cxt.addObject( "utils", &utils );
+    cxt.evalScript( "results = []\n"
+                    "utils.target_env_call_async(['sleep', '30'], lambda ec: results.append(ec))\n" );
+    QCOMPARE( utils.pending_calls(), 1 );
+
+    QElapsedTimer timer;
+    timer.start();
+    utils.cancel_pending_calls();
+    QTRY_COMPARE_WITH_TIMEOUT( utils.pending_calls(), 0, 10000 );
+    QVERIFY( timer.elapsed() < 10000 );
+    QCOMPARE( cxt.getVariable( "results" ).toList().count(), 0 );
+
+    // Later calls run as usual
+    cxt.evalScript( "utils.target_env_call_async(['true'], lambda ec: results.append(ec))\n" );
+    QTRY_COMPARE( utils.pending_calls(), 0 );
+    QCOMPARE( cxt.getVariable( "results" ).toList(), QVariantList { 0 } );
+}
+
+QTEST_GUILESS_MAIN( TestPythonQtUtilsWrapper )
+
+#include "utils/moc-warnings.h"
+
+#include "TestPythonQtUtilsWrapper.moc"
@@ -79,6 +79,24 @@ ViewStep::checkRequirements()
     return RequirementsList();
 }
 
+bool
+ViewStep::hasLazyWidget() const
+{
+    return false;
+}
+
+bool
+ViewStep::releaseWidget()
+{
+    return false;
+}
+
+QVariantMap
+ViewStep::memoryUsage() const
+{
+    return QVariantMap();
+}
+
 QSize
 ViewStep::widgetMargins( Qt::Orientations panelSides )
 {
@@ -83,6 +83,44 @@ public:
      */
     virtual QWidget* widget() = 0;
 
+    /** @brief Can widget creation wait until the step is shown?
+     *
+     * If this returns @c true, the ViewManager does not call widget()
+     * when the step is added, but only when the step is about to become
+     * the current step (or while idle, just before that). A view step
+     * that returns @c true must create its widget in widget(), and must
+     * cope with onActivate() and other calls before that happens.
+     *
+     * The default implementation returns @c false.
+     */
+    virtual bool hasLazyWidget() const;
+
+    /** @brief Lets go of the widget, which will not be shown again
+     *
+     * This is called (with *release-pages-during-exec* set in
+     * `settings.conf`) for the view steps before an exec phase, once
+     * the jobs of that phase have been created. The ViewManager has taken
+     * the widget out of its stack. A view step that deletes its widget
+     * (and other things it only needs for the UI, like models and images)
+     * returns @c true; after that, only prettyName() and the like are
+     * called. A view step that keeps the widget returns @c false, and
+     * the widget goes back into the stack; it may still delete what is
+     * inside it. The default implementation does nothing and returns
+     * @c false.
+     */
+    virtual bool releaseWidget();
+
+    /** @brief What the step knows it keeps in memory
+     *
+     * The keys say what it is (e.g. "model"), the values are sizes in
+     * bytes, or counts for keys that say so (e.g. "qmlObjects"). This
+     * shows up in the debug window and in the memory statistics, next
+     * to what the process as a whole used while the step was loaded and
+     * shown; it need not be exact. The default implementation returns
+     * an empty map.
+     */
+    virtual QVariantMap memoryUsage() const;
+
     /** @brief Get margins for this widget
      *
      * This is called by the layout manager to find the desired
@@ -20,7 +20,10 @@
 #   Calamares is Free Software: see the License-Identifier above.
 #
 
+import glob
 import os
+import re
+import shlex
 import shutil
 import subprocess
 
@@ -314,6 +317,93 @@ def get_grub_efi_parameters():
     return None
 
 
+def cached_os_prober():
+    """
+    Returns the lines of os-prober output that the partition module
+    stored (in *osproberLines*), for the operating systems that are
+    still there after partitioning: the lines for partitions that were
+    formatted for the installation are left out. Returns None if there
+    is nothing cached, or reuseOsprober is false.
+    """
+    lines = libcalamares.globalstorage.value("osproberLines")
+    if lines is None or not libcalamares.job.configuration.get("reuseOsprober", True):
+        return None
+
+    partitions = libcalamares.globalstorage.value("partitions") or []
+    claimed = set([p["device"] for p in partitions if p.get("claimed")])
+    found = []
+    for line in lines:
+        # /dev/sda1:Name:Label:type or /dev/sda1@/path/to/file:...
+        device = line.split(":")[0].split("@")[0]
+        if device in claimed or not os.path.exists(device):
+            libcalamares.utils.debug("Dropping os-prober entry {!s}".format(line))
+        else:
+            found.append(line)
+    return found
+
+
+def os_prober_enabled(root_mount_point):
+    """
+    Returns True if grub-mkconfig in the target would run os-prober:
+    os-prober is installed there, and GRUB_DISABLE_OS_PROBER is not
+    set to true in /etc/default/grub (or a file in /etc/default/grub.d).
+    """
+    bin_dirs = ["/usr/local/sbin", "/usr/local/bin", "/usr/sbin", "/usr/bin", "/sbin", "/bin"]
+    if not any([os.path.exists(root_mount_point + d + "/os-prober") for d in bin_dirs]):
+        return False
+
+    config_files = [root_mount_point + "/etc/default/grub"]
+    config_files += sorted(glob.glob(root_mount_point + "/etc/default/grub.d/*.cfg"))
+    setting = re.compile(r"^\s*(export\s+)?GRUB_DISABLE_OS_PROBER=(.*)$")
+    disabled = ""
+    for config_file in config_files:
+        try:
+            with open(config_file, "r") as f:
+                for line in f:
+                    m = setting.match(line.strip())
+                    if m:
+                        disabled = m.group(2).strip().strip("\"'")
+        except OSError:
+            pass
+    return disabled != "true"
+
+
+def run_grub_mkconfig(output_file):
+    """
+    Runs grub-mkconfig in the target system to write @p output_file.
+
+    When the os-prober output from before partitioning is available
+    (see cached_os_prober()), grub-mkconfig finds an os-prober that
+    prints that, instead of scanning all the disks again. That only
+    happens when grub-mkconfig would run the real os-prober (see
+    os_prober_enabled()), so the entries are not added otherwise.
+    """
+    command = [libcalamares.job.configuration["grubMkconfig"], "-o", output_file]
+    root_mount_point = libcalamares.globalstorage.value("rootMountPoint")
+    lines = cached_os_prober()
+    if lines is None or not os_prober_enabled(root_mount_point):
+        check_target_env_call(command)
+        return
+
+    wrapper_dir = "/tmp/calamares-os-prober"
+    host_wrapper_dir = root_mount_point + wrapper_dir
+    os.makedirs(host_wrapper_dir, exist_ok=True)
+    wrapper = os.path.join(host_wrapper_dir, "os-prober")
+    with open(wrapper, "w") as f:
+        f.write("#!/bin/sh\n# Generated by Calamares from the os-prober output before partitioning\n")
+        f.write("cat <<'CALAMARES_OS_PROBER'\n")
+        for line in lines:
+            f.write(line + "\n")
+        f.write("CALAMARES_OS_PROBER\n")
+    os.chmod(wrapper, 0o755)
+    libcalamares.utils.debug("Re-using {!s} os-prober entries for {!s}".format(len(lines), command[0]))
+    try:
+        check_target_env_call(["sh", "-c", "PATH={!s}:\"$PATH\" exec {!s}".format(
+            wrapper_dir, " ".join([shlex.quote(c) for c in command]))])
+    finally:
+        shutil.rmtree(host_wrapper_dir, ignore_errors=True)
+
+
 def install_grub(efi_directory, fw_type):
     """
     Installs grub as bootloader, either in pc or efi mode.
@@ -384,8 +474,7 @@ def install_grub(efi_directory, fw_type):
 
     # The input file /etc/default/grub should already be filled out by the
     # grubcfg job module.
-    check_target_env_call([libcalamares.job.configuration["grubMkconfig"],
-                           "-o", libcalamares.job.configuration["grubCfg"]])
+    run_grub_mkconfig(libcalamares.job.configuration["grubCfg"])
 
 
 def install_secureboot(efi_directory):
@@ -442,9 +531,7 @@ def install_secureboot(efi_directory):
 
     # The input file /etc/default/grub should already be filled out by the
     # grubcfg job module.
-    check_target_env_call([libcalamares.job.configuration["grubMkconfig"],
-                           "-o", os.path.join(efi_directory, "EFI",
-                                              efi_bootloader_id, "grub.cfg")])
+    run_grub_mkconfig(os.path.join(efi_directory, "EFI", efi_bootloader_id, "grub.cfg"))
 
 
 def vfat_correct_case(parent, name):
@@ -15,9 +15,12 @@
 
 #include "Job.h"
 
+#include <QHash>
 #include <QList>
 #include <QPair>
 #include <QString>
+#include <QStringList>
+#include <QVariantMap>
 
 namespace CalamaresUtils
 {
@@ -52,6 +55,7 @@ class ContextualProcessBinding
 public:
     ContextualProcessBinding( const QString& varname )
         : m_variable( varname )
+        , m_selector( varname.split( '.' ) )
     {
     }
 
@@ -77,10 +81,19 @@ public:
      * is for) and false otherwise.
      */
     bool fetch( Calamares::GlobalStorage* storage, QString& value ) const;
+    /** @brief Tries to obtain this binding's value from a snapshot of GS
+     *
+     * Like fetch(), above, but looks in @p data (e.g. from
+     * GlobalStorage::data()), so that several bindings can be
+     * looked up in the same (consistent) state of GS.
+     */
+    bool fetch( const QVariantMap& data, QString& value ) const;
 
 private:
     QString m_variable;
+    QStringList m_selector;  ///< The variable, split at dots
     QList< ValueCheck > m_checks;
+    QHash< QString, CalamaresUtils::CommandList* > m_lookup;  ///< The commands of m_checks, by value
     CalamaresUtils::CommandList* m_wildcard = nullptr;
 };
 
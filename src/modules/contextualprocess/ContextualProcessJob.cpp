@@ -33,6 +33,11 @@ void
 ContextualProcessBinding::append( const QString& value, CalamaresUtils::CommandList* commands )
 {
     m_checks.append( ValueCheck( value, commands ) );
+    // Like a search through m_checks, the first commands for a value win
+    if ( !m_lookup.contains( value ) )
+    {
+        m_lookup.insert( value, commands );
+    }
     if ( value == QString( "*" ) )
     {
         m_wildcard = commands;
@@ -42,12 +47,10 @@ ContextualProcessBinding::append( const QString& value, CalamaresUtils::CommandL
 Calamares::JobResult
 ContextualProcessBinding::run( const QString& value ) const
 {
-    for ( const auto& c : m_checks )
+    const auto it = m_lookup.constFind( value );
+    if ( it != m_lookup.constEnd() )
     {
-        if ( value == c.value() )
-        {
-            return c.commands()->run();
-        }
+        return it.value()->run();
     }
 
     if ( m_wildcard )
@@ -58,46 +61,43 @@ ContextualProcessBinding::run( const QString& value ) const
     return Calamares::JobResult::ok();
 }
 
-///@brief Implementation of fetch() for recursively looking up dotted selector parts.
-static bool
-fetch( QString& value, QStringList& selector, int index, const QVariant& v )
+bool
+ContextualProcessBinding::fetch( Calamares::GlobalStorage* storage, QString& value ) const
 {
-    if ( !v.canConvert( QMetaType::QVariantMap ) )
+    value.clear();
+    if ( !storage )
     {
         return false;
     }
-    const QVariantMap map = v.toMap();
-    const QString& key = selector.at( index );
-    if ( index == selector.length() - 1 )
-    {
-        value = map.value( key ).toString();
-        return map.contains( key );
-    }
-    else
+    if ( m_selector.count() == 1 )
     {
-        return fetch( value, selector, index + 1, map.value( key ) );
+        value = storage->value( m_variable ).toString();
+        return storage->contains( m_variable );
     }
+    return fetch( storage->data(), value );
 }
 
-
 bool
-ContextualProcessBinding::fetch( Calamares::GlobalStorage* storage, QString& value ) const
+ContextualProcessBinding::fetch( const QVariantMap& data, QString& value ) const
 {
     value.clear();
-    if ( !storage )
-    {
-        return false;
-    }
-    if ( m_variable.contains( '.' ) )
-    {
-        QStringList steps = m_variable.split( '.' );
-        return ::fetch( value, steps, 1, storage->value( steps.first() ) );
-    }
-    else
+    QVariant v = data;
+    for ( int index = 0; index < m_selector.count(); ++index )
     {
-        value = storage->value( m_variable ).toString();
-        return storage->contains( m_variable );
+        if ( !v.canConvert( QMetaType::QVariantMap ) )
+        {
+            return false;
+        }
+        const QVariantMap map = v.toMap();
+        const auto it = map.constFind( m_selector.at( index ) );
+        if ( it == map.constEnd() )
+        {
+            return false;
+        }
+        v = it.value();
     }
+    value = v.toString();
+    return true;
 }
 
 
@@ -123,12 +123,13 @@ ContextualProcessJob::prettyName() const
 Calamares::JobResult
 ContextualProcessJob::exec()
 {
-    Calamares::GlobalStorage* gs = Calamares::JobQueue::instance()->globalStorage();
+    // All the bindings look at the same values, even if GS changes while the commands run
+    const QVariantMap data = Calamares::JobQueue::instance()->globalStorage()->data();
 
     for ( const ContextualProcessBinding* binding : m_commands )
     {
         QString value;
-        if ( binding->fetch( gs, value ) )
+        if ( binding->fetch( data, value ) )
         {
             Calamares::JobResult r = binding->run( value );
             if ( !r )
@@ -179,4 +179,17 @@ ContextualProcessTests::testFetch()
         QCOMPARE( s, QString() );
         QVERIFY( s.isEmpty() );
     }
+    {
+        // The same lookups in a snapshot of GS
+        const QVariantMap data = gs->data();
+        QString s;
+        QVERIFY( ContextualProcessBinding( QStringLiteral( "tomato" ) ).fetch( data, s ) );
+        QCOMPARE( s, QStringLiteral( "fruit" ) );
+        QVERIFY( ContextualProcessBinding( QStringLiteral( "berries.knoebels" ) ).fetch( data, s ) );
+        QCOMPARE( s, QStringLiteral( "green" ) );
+        QVERIFY( !ContextualProcessBinding( QStringLiteral( "parsnip" ) ).fetch( data, s ) );
+        QVERIFY( !ContextualProcessBinding( QStringLiteral( "tomato.red" ) ).fetch( data, s ) );
+        QVERIFY( !ContextualProcessBinding( QStringLiteral( "filesystem_use.ufs" ) ).fetch( data, s ) );
+        QVERIFY( s.isEmpty() );
+    }
 }
@@ -18,6 +18,8 @@
 import abc
 import os
 import re
+import shlex
+import subprocess
 import libcalamares
 import configparser
 
@@ -31,6 +33,65 @@ _translation = gettext.translation("calamares-python",
 _ = _translation.gettext
 _n = _translation.ngettext
 
+
+# Names of groups and users in the target system, by NSS
+# database; see target_account_names().
+_account_names = {}
+
+
+def target_account_names(database):
+    """
+    Returns the set of names in the NSS @p database (e.g. "group" or
+    "passwd") of the target system. They are looked up with getent in
+    the target, so that groups and users from any source configured in
+    its nsswitch.conf (not just /etc/group and /etc/passwd) count.
+    The database is listed only once.
+    """
+    if database not in _account_names:
+        names = set()
+        try:
+            output = libcalamares.utils.check_target_env_output(["getent", database])
+            for line in output.splitlines():
+                name = line.split(":", 1)[0].strip()
+                if name:
+                    names.add(name)
+        except subprocess.CalledProcessError as e:
+            libcalamares.utils.warning("Cannot list {!s} in target: {!s}".format(database, e))
+        _account_names[database] = names
+    return _account_names[database]
+
+
+def target_env_call_all(commands):
+    """
+    Runs the @p commands (each a list of arguments) one after the other
+    in a single shell in the target system. Like separate calls to
+    target_env_call(), a command that fails does not stop the ones after it.
+    """
+    if commands:
+        script = "; ".join([" ".join([shlex.quote(arg) for arg in c]) for c in commands])
+        libcalamares.utils.target_env_call(["sh", "-c", script])
+
+
+# Session files in the target system, by (root mount point, directory);
+# see target_session_files().
+_session_files = {}
+
+
+def target_session_files(root_mount_point, directory):
+    """
+    Returns the set of file names in @p directory (e.g. "/usr/share/xsessions")
+    in the target system at @p root_mount_point. The directory is listed
+    only once.
+    """
+    key = (root_mount_point, directory)
+    if key not in _session_files:
+        try:
+            _session_files[key] = set(os.listdir(root_mount_point + directory))
+        except OSError:
+            _session_files[key] = set()
+    return _session_files[key]
+
+
 class DesktopEnvironment:
     """
     Desktop Environment -- some utility functions for a desktop
@@ -95,11 +156,10 @@ class DesktopEnvironment:
         Returns the full path of the .desktop file within @p root_mount_point,
         or None if it isn't found.  Searches both X11 and Wayland sessions.
         """
-        x11_sessions = "{!s}/usr/share/xsessions/{!s}.desktop".format(root_mount_point, self.desktop_file)
-        wayland_sessions = "{!s}/usr/share/wayland-sessions/{!s}.desktop".format(root_mount_point, self.desktop_file)
-        for candidate in (x11_sessions, wayland_sessions):
-            if os.path.exists(candidate):
-                return candidate
+        file_name = "{!s}.desktop".format(self.desktop_file)
+        for sessions in ("/usr/share/xsessions", "/usr/share/wayland-sessions"):
+            if file_name in target_session_files(root_mount_point, sessions):
+                return "{!s}{!s}/{!s}".format(root_mount_point, sessions, file_name)
         return None
 
     def is_installed(self, root_mount_point):
@@ -240,6 +300,29 @@ class DisplayManager(metaclass=abc.ABCMeta):
         sbin_path = "{!s}/usr/sbin/{!s}".format(self.root_mount_point, self.executable)
         return os.path.exists(bin_path) or os.path.exists(sbin_path)
 
+    def need_group(self, name):
+        """
+        Returns True if the group @p name does not exist in the target
+        system yet. The caller is expected to add it, so later calls
+        for the same @p name return False.
+        """
+        groups = target_account_names("group")
+        if name in groups:
+            return False
+        groups.add(name)
+        return True
+
+    def need_user(self, name):
+        """
+        Returns True if the user @p name does not exist in the target
+        system yet, like need_group().
+        """
+        users = target_account_names("passwd")
+        if name in users:
+            return False
+        users.add(name)
+        return True
+
     # The four abstract methods below are called in the order listed here.
     # They must all be implemented by subclasses, but not all of them
     # actually do something for all DMs.
@@ -322,17 +405,12 @@ class DMmdm(DisplayManager):
                     mdm_conf.write('AutomaticLoginEnable=False\n')
 
     def basic_setup(self):
-        if libcalamares.utils.target_env_call(
-                    ['getent', 'group', 'mdm']
-                    ) != 0:
-            libcalamares.utils.target_env_call(
-                ['groupadd', '-g', '128', 'mdm']
-                )
+        commands = []
+        if self.need_group('mdm'):
+            commands.append(['groupadd', '-g', '128', 'mdm'])
 
-        if libcalamares.utils.target_env_call(
-                ['getent', 'passwd', 'mdm']
-                ) != 0:
-            libcalamares.utils.target_env_call(
+        if self.need_user('mdm'):
+            commands.append(
                 ['useradd',
                     '-c', '"Linux Mint Display Manager"',
                     '-u', '128',
@@ -343,15 +421,10 @@ class DMmdm(DisplayManager):
                     ]
                 )
 
-        libcalamares.utils.target_env_call(
-            ['passwd', '-l', 'mdm']
-            )
-        libcalamares.utils.target_env_call(
-            ['chown', 'root:mdm', '/var/lib/mdm']
-            )
-        libcalamares.utils.target_env_call(
-            ['chmod', '1770', '/var/lib/mdm']
-            )
+        commands.append(['passwd', '-l', 'mdm'])
+        commands.append(['chown', 'root:mdm', '/var/lib/mdm'])
+        commands.append(['chmod', '1770', '/var/lib/mdm'])
+        target_env_call_all(commands)
 
     def desktop_environment_setup(self, default_desktop_environment):
         os.system(
@@ -448,17 +521,12 @@ class DMgdm(DisplayManager):
 
 
     def basic_setup(self):
-        if libcalamares.utils.target_env_call(
-                ['getent', 'group', 'gdm']
-                ) != 0:
-            libcalamares.utils.target_env_call(
-                ['groupadd', '-g', '120', 'gdm']
-                )
+        commands = []
+        if self.need_group('gdm'):
+            commands.append(['groupadd', '-g', '120', 'gdm'])
 
-        if libcalamares.utils.target_env_call(
-                ['getent', 'passwd', 'gdm']
-                ) != 0:
-            libcalamares.utils.target_env_call(
+        if self.need_user('gdm'):
+            commands.append(
                 ['useradd',
                     '-c', '"Gnome Display Manager"',
                     '-u', '120',
@@ -469,12 +537,9 @@ class DMgdm(DisplayManager):
                     ]
                 )
 
-        libcalamares.utils.target_env_call(
-            ['passwd', '-l', 'gdm']
-            )
-        libcalamares.utils.target_env_call(
-            ['chown', '-R', 'gdm:gdm', '/var/lib/gdm']
-            )
+        commands.append(['passwd', '-l', 'gdm'])
+        commands.append(['chown', '-R', 'gdm:gdm', '/var/lib/gdm'])
+        target_env_call_all(commands)
 
     def desktop_environment_setup(self, desktop_environment):
         pass
@@ -528,17 +593,12 @@ class DMkdm(DisplayManager):
                 )
 
     def basic_setup(self):
-        if libcalamares.utils.target_env_call(
-                ['getent', 'group', 'kdm']
-                ) != 0:
-            libcalamares.utils.target_env_call(
-                ['groupadd', '-g', '135', 'kdm']
-                )
+        commands = []
+        if self.need_group('kdm'):
+            commands.append(['groupadd', '-g', '135', 'kdm'])
 
-        if libcalamares.utils.target_env_call(
-                ['getent', 'passwd', 'kdm']
-                ) != 0:
-            libcalamares.utils.target_env_call(
+        if self.need_user('kdm'):
+            commands.append(
                 ['useradd',
                     '-u', '135',
                     '-g', 'kdm',
@@ -550,9 +610,8 @@ class DMkdm(DisplayManager):
                     ]
                 )
 
-        libcalamares.utils.target_env_call(
-            ['chown', '-R', '135:135', 'var/lib/kdm']
-            )
+        commands.append(['chown', '-R', '135:135', 'var/lib/kdm'])
+        target_env_call_all(commands)
 
     def desktop_environment_setup(self, desktop_environment):
         pass
@@ -590,22 +649,14 @@ class DMlxdm(DisplayManager):
                 )
 
     def basic_setup(self):
-        if libcalamares.utils.target_env_call(
-                ['getent', 'group', 'lxdm']
-                ) != 0:
-            libcalamares.utils.target_env_call(
-                ['groupadd', '--system', 'lxdm']
-                )
+        commands = []
+        if self.need_group('lxdm'):
+            commands.append(['groupadd', '--system', 'lxdm'])
 
-        libcalamares.utils.target_env_call(
-            ['chgrp', '-R', 'lxdm', '/var/lib/lxdm']
-            )
-        libcalamares.utils.target_env_call(
-            ['chgrp', 'lxdm', '/etc/lxdm/lxdm.conf']
-            )
-        libcalamares.utils.target_env_call(
-            ['chmod', '+r', '/etc/lxdm/lxdm.conf']
-            )
+        commands.append(['chgrp', '-R', 'lxdm', '/var/lib/lxdm'])
+        commands.append(['chgrp', 'lxdm', '/etc/lxdm/lxdm.conf'])
+        commands.append(['chmod', '+r', '/etc/lxdm/lxdm.conf'])
+        target_env_call_all(commands)
 
     def desktop_environment_setup(self, default_desktop_environment):
         os.system(
@@ -675,21 +726,13 @@ class DMlightdm(DisplayManager):
 
 
     def basic_setup(self):
-        libcalamares.utils.target_env_call(
-            ['mkdir', '-p', '/run/lightdm']
-            )
+        commands = [['mkdir', '-p', '/run/lightdm']]
 
-        if libcalamares.utils.target_env_call(
-                ['getent', 'group', 'lightdm']
-                ) != 0:
-            libcalamares.utils.target_env_call(
-                ['groupadd', '-g', '620', 'lightdm']
-                )
+        if self.need_group('lightdm'):
+            commands.append(['groupadd', '-g', '620', 'lightdm'])
 
-        if libcalamares.utils.target_env_call(
-                ['getent', 'passwd', 'lightdm']
-                ) != 0:
-            libcalamares.utils.target_env_call(
+        if self.need_user('lightdm'):
+            commands.append(
                 ['useradd', '-c',
                     '"LightDM Display Manager"',
                     '-u', '620',
@@ -700,9 +743,10 @@ class DMlightdm(DisplayManager):
                     ]
                 )
 
-        libcalamares.utils.target_env_call(['passwd', '-l', 'lightdm'])
-        libcalamares.utils.target_env_call(['chown', '-R', 'lightdm:lightdm', '/run/lightdm'])
-        libcalamares.utils.target_env_call(['chmod', '+r' '/etc/lightdm/lightdm.conf'])
+        commands.append(['passwd', '-l', 'lightdm'])
+        commands.append(['chown', '-R', 'lightdm:lightdm', '/run/lightdm'])
+        commands.append(['chmod', '+r', '/etc/lightdm/lightdm.conf'])
+        target_env_call_all(commands)
 
     def desktop_environment_setup(self, default_desktop_environment):
         os.system(
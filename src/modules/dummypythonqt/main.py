@@ -81,6 +81,13 @@ class DummyPythonQtViewStep:
         # (without a special "slot" designation).
         btn.connect("clicked(bool)", self.on_btn_clicked)
 
+        # Python code runs on the UI thread, so anything that takes a while
+        # freezes the window. Commands can run without blocking instead,
+        # with a callback (also on the UI thread) for the result:
+        #   calamares.utils.target_env_output_async(["ls", "/boot"],
+        #                                           self.on_listed)
+        # where on_listed(exit_code, output) updates the page.
+
     def on_btn_clicked(self):
         self.main_widget.layout().addWidget(QLabel(_("A new QLabel.")))
 
@@ -12,12 +12,16 @@
 #include "CalamaresVersion.h"
 #include "GlobalStorage.h"
 #include "JobQueue.h"
+#include "partition/Mount.h"
 #include "partition/PartitionIterator.h"
+#include "utils/CalamaresUtilsSystem.h"
 #include "utils/Logger.h"
 #include "utils/Units.h"
 #include "utils/Variant.h"
 
 #include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
 #include <QProcess>
 #include <QThread>
 
@@ -25,10 +29,13 @@
 #include <kpmcore/backend/corebackendmanager.h>
 #include <kpmcore/core/device.h>
 #include <kpmcore/core/partition.h>
+#include <kpmcore/core/partitiontable.h>
+#include <kpmcore/fs/filesystem.h>
 #include <kpmcore/ops/resizeoperation.h>
 #include <kpmcore/util/report.h>
 
 using CalamaresUtils::Partition::PartitionIterator;
+using CalamaresUtils::System;
 
 ResizeFSJob::ResizeFSJob( QObject* parent )
     : Calamares::CppJob( parent )
@@ -46,9 +53,66 @@ ResizeFSJob::prettyName() const
     return tr( "Resize Filesystem Job" );
 }
 
+/** @brief The whole-disk device node that holds partition @p partitionNode
+ *
+ * In sysfs, a partition is a subdirectory of its disk. Returns an
+ * empty string if @p partitionNode is not a partition (or does not exist).
+ */
+static QString
+containingDisk( const QString& partitionNode )
+{
+    const QString node = QFileInfo( partitionNode ).canonicalFilePath();
+    if ( !node.startsWith( QStringLiteral( "/dev/" ) ) )
+    {
+        return QString();
+    }
+    const QString sysfs = QStringLiteral( "/sys/class/block/" ) + QFileInfo( node ).fileName();
+    if ( !QFileInfo::exists( sysfs + QStringLiteral( "/partition" ) ) )
+    {
+        return QString();
+    }
+    // e.g. /sys/class/block/sda1 -> /sys/devices/.../block/sda/sda1
+    return QStringLiteral( "/dev/" ) + QFileInfo( QFileInfo( sysfs ).canonicalFilePath() ).dir().dirName();
+}
+
+Partition*
+ResizeFSJob::findPartition( Device* device, const QString& partitionNode )
+{
+    for ( auto part_it = PartitionIterator::begin( device ); part_it != PartitionIterator::end( device ); ++part_it )
+    {
+        cDebug() << Logger::SubEntry << ( *part_it )->mountPoint() << "on" << ( *part_it )->deviceNode();
+        if ( ( !m_fsname.isEmpty() && ( *part_it )->mountPoint() == m_fsname )
+             || ( !m_devicename.isEmpty() && ( *part_it )->deviceNode() == m_devicename )
+             || ( !partitionNode.isEmpty() && ( *part_it )->deviceNode() == partitionNode ) )
+        {
+            cDebug() << Logger::SubEntry << "matched configuration dev=" << m_devicename << "fs=" << m_fsname;
+            return *part_it;
+        }
+    }
+    return nullptr;
+}
+
 ResizeFSJob::PartitionMatch
 ResizeFSJob::findPartition()
 {
+    // Usually the system knows which disk it is, and scanning just that
+    // one is much faster than scanning them all.
+    const QString partitionNode = QFileInfo(
+        m_devicename.isEmpty() ? CalamaresUtils::Partition::mountedDevice( m_fsname ) : m_devicename )
+                                      .canonicalFilePath();
+    const QString diskNode = containingDisk( partitionNode );
+    if ( !diskNode.isEmpty() )
+    {
+        cDebug() << "ResizeFSJob looking for" << partitionNode << "on" << diskNode;
+        Device* dev = m_kpmcore.backend()->scanDevice( diskNode );
+        Partition* part = dev ? findPartition( dev, partitionNode ) : nullptr;
+        if ( part )
+        {
+            return PartitionMatch( dev, part );
+        }
+        cDebug() << Logger::SubEntry << "not found, scanning all devices.";
+    }
+
     using DeviceList = QList< Device* >;
 #if defined( WITH_KPMCORE4API )
     DeviceList devices
@@ -65,16 +129,10 @@ ResizeFSJob::findPartition()
             continue;
         }
         cDebug() << "ResizeFSJob found" << ( *dev_it )->deviceNode();
-        for ( auto part_it = PartitionIterator::begin( *dev_it ); part_it != PartitionIterator::end( *dev_it );
-              ++part_it )
+        Partition* part = findPartition( *dev_it, partitionNode );
+        if ( part )
         {
-            cDebug() << Logger::SubEntry << ( *part_it )->mountPoint() << "on" << ( *part_it )->deviceNode();
-            if ( ( !m_fsname.isEmpty() && ( *part_it )->mountPoint() == m_fsname )
-                 || ( !m_devicename.isEmpty() && ( *part_it )->deviceNode() == m_devicename ) )
-            {
-                cDebug() << Logger::SubEntry << "matched configuration dev=" << m_devicename << "fs=" << m_fsname;
-                return PartitionMatch( *dev_it, *part_it );
-            }
+            return PartitionMatch( *dev_it, part );
         }
     }
 
@@ -82,6 +140,38 @@ ResizeFSJob::findPartition()
     return PartitionMatch( nullptr, nullptr );
 }
 
+/** @brief Can the partition and FS of @p m be grown while the FS is mounted?
+ *
+ * This needs a filesystem that can grow online, and a partition
+ * table that sfdisk can edit. Logical partitions are left to KPMcore,
+ * since the extended partition would need to grow as well.
+ */
+static bool
+canGrowOnline( const ResizeFSJob::PartitionMatch& m )
+{
+    const Partition* p = m.second;
+    if ( !p->isMounted() || p->mountPoint().isEmpty() || p->roles().has( PartitionRole::Logical ) )
+    {
+        return false;
+    }
+    const PartitionTable* table = m.first->partitionTable();
+    if ( !table
+         || !( table->type() == PartitionTable::TableType::msdos || table->type() == PartitionTable::TableType::gpt ) )
+    {
+        return false;
+    }
+    switch ( p->fileSystem().type() )
+    {
+    case FileSystem::Type::Ext3:
+    case FileSystem::Type::Ext4:
+    case FileSystem::Type::Btrfs:
+    case FileSystem::Type::Xfs:
+        return true;
+    default:
+        return false;
+    }
+}
+
 /** @brief Returns the last sector the matched partition should occupy.
  *
  * Returns a sector number. Returns -1 if something is wrong (e.g.
@@ -219,7 +309,28 @@ ResizeFSJob::exec()
 
     if ( ( new_end > 0 ) && ( new_end > m.second->lastSector() ) )
     {
+        if ( canGrowOnline( m ) )
+        {
+            bool changed = false;
+            const QString message = growOnline( m, new_end, changed );
+            if ( message.isEmpty() )
+            {
+                cDebug() << "Online resize OK.";
+                return Calamares::JobResult::ok();
+            }
+            if ( changed )
+            {
+                // The partition table was written, so KPMcore would start from the wrong place
+                return Calamares::JobResult::error( tr( "Resize Failed" ), message );
+            }
+            cWarning() << "Online resize failed, trying KPMcore." << message;
+        }
+
         ResizeOperation op( *m.first, *m.second, m.second->firstSector(), new_end );
+        // This is the percentage of the KPMcore job that is running
+        connect( &op, &Operation::progress, [this]( int percent ) {
+            emit progress( qBound( 0, percent, 100 ) / 100.0 );
+        } );
         Report op_report( nullptr );
         if ( op.execute( op_report ) )
         {
@@ -236,6 +347,72 @@ ResizeFSJob::exec()
 }
 
 
+QString
+ResizeFSJob::growOnline( ResizeFSJob::PartitionMatch m, qint64 new_end, bool& changed )
+{
+    const QString disk = m.first->deviceNode();
+    const QString number = QString::number( m.second->number() );
+    const qint64 first = m.second->firstSector();
+
+    // Only the partition table is written: the kernel is told about the
+    // new size of the (mounted, so busy) partition separately.
+    emit progress( 0.0 );
+    auto r = System::runCommand( System::RunLocation::RunInHost,
+                                 { QStringLiteral( "sfdisk" ),
+                                   QStringLiteral( "--no-reread" ),
+                                   QStringLiteral( "--no-tell-kernel" ),
+                                   QStringLiteral( "-N" ),
+                                   number,
+                                   disk },
+                                 QString(),
+                                 QStringLiteral( "%1,%2\n" ).arg( first ).arg( new_end - first + 1 ),
+                                 std::chrono::seconds( 30 ) );
+    if ( r.getExitCode() != 0 )
+    {
+        return tr( "The partition table of %1 could not be changed." ).arg( disk );
+    }
+    changed = true;
+    emit progress( 0.2 );
+
+    r = System::runCommand(
+        { QStringLiteral( "partx" ), QStringLiteral( "-u" ), QStringLiteral( "--nr" ), number, disk },
+        std::chrono::seconds( 30 ) );
+    if ( r.getExitCode() != 0 )
+    {
+        return tr( "The new size of partition %1 could not be passed on to the system." )
+            .arg( m.second->deviceNode() );
+    }
+    // From here on, the partition is its new size
+    m.second->setLastSector( new_end );
+    emit progress( 0.3 );
+
+    const QString mountPoint = m.second->mountPoint();
+    QStringList args;
+    switch ( m.second->fileSystem().type() )
+    {
+    case FileSystem::Type::Btrfs:
+        args = QStringList { QStringLiteral( "btrfs" ),
+                             QStringLiteral( "filesystem" ),
+                             QStringLiteral( "resize" ),
+                             QStringLiteral( "max" ),
+                             mountPoint };
+        break;
+    case FileSystem::Type::Xfs:
+        args = QStringList { QStringLiteral( "xfs_growfs" ), mountPoint };
+        break;
+    default:
+        args = QStringList { QStringLiteral( "resize2fs" ), m.second->deviceNode() };
+    }
+    r = System::runCommand( System::RunLocation::RunInHost, args );
+    if ( r.getExitCode() != 0 )
+    {
+        return tr( "The filesystem %1 could not be grown to fill its partition." ).arg( mountPoint ) + '\n'
+            + r.getOutput();
+    }
+    emit progress( 1.0 );
+    return QString();
+}
+
 void
 ResizeFSJob::setConfigurationMap( const QVariantMap& configurationMap )
 {
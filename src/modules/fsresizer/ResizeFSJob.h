@@ -58,12 +58,28 @@ private:
     QString m_devicename;
     bool m_required;
 
+public:
     using PartitionMatch = QPair< Device*, Partition* >;
-    /** @brief Find the configured FS */
+
+private:
+    /** @brief Find the configured FS
+     *
+     * Looks on the disk that holds the configured FS first, and
+     * scans all the devices only if that fails.
+     */
     PartitionMatch findPartition();
+    /** @brief Find the configured FS on @p device, or @p partitionNode */
+    Partition* findPartition( Device* device, const QString& partitionNode );
 
     /** @brief Return a new end-sector for the given dev-part pair. */
     qint64 findGrownEnd( PartitionMatch );
+
+    /** @brief Grow the partition, then the mounted FS, to end at @p new_end
+     *
+     * Returns an empty string on success, or an error message.
+     * Sets @p changed once the partition table has been written.
+     */
+    QString growOnline( PartitionMatch m, qint64 new_end, bool& changed );
 };
 
 CALAMARES_PLUGIN_FACTORY_DECLARATION( ResizeFSJobFactory )
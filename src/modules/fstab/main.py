@@ -14,7 +14,6 @@
 
 import os
 import re
-import subprocess
 
 import libcalamares
 
@@ -129,10 +128,20 @@ class FstabGenerator(object):
         return None
 
     def find_ssd_disks(self):
-        """ Checks for ssd disks """
-        disks = {disk_name_for_partition(x) for x in self.partitions}
+        """
+        Checks for ssd disks. The partition module stores the
+        *rotational* attribute of the disk with each partition;
+        only partitions without it need to look in sysfs.
+        """
+        disks = {disk_name_for_partition(x) for x in self.partitions if "rotational" not in x}
         self.ssd_disks = {x for x in disks if is_ssd_disk(x)}
 
+    def is_ssd_partition(self, partition):
+        """ Is @p partition on an SSD (or other non-rotational disk)? """
+        if "rotational" in partition:
+            return not partition["rotational"]
+        return disk_name_for_partition(partition) in self.ssd_disks
+
     def generate_crypttab(self):
         """ Create crypttab. """
         mkdir_p(os.path.join(self.root_mount_point, "etc"))
@@ -222,7 +231,7 @@ class FstabGenerator(object):
         has_luks = "luksMapperName" in partition
         mount_point = partition["mountPoint"]
         disk_name = disk_name_for_partition(partition)
-        is_ssd = disk_name in self.ssd_disks
+        is_ssd = self.is_ssd_partition(partition)
 
         # Swap partitions are called "linuxswap" by parted.
         # That "fs" is visible in GS, but that gets mapped
@@ -241,9 +250,22 @@ class FstabGenerator(object):
         if is_ssd:
             extra = self.ssd_extra_mount_options.get(filesystem)
 
+            if extra and partition.get("discard", True) is False:
+                # The disk can't do it, so don't ask the kernel for it
+                extra = ",".join([o for o in extra.split(",") if not o.startswith("discard")])
+
             if extra:
                 options += "," + extra
 
+        # From the device-class profile in the partition module
+        if partition.get("extraMountOptions"):
+            options += "," + partition["extraMountOptions"]
+
+        # The mount module compressed btrfs while unpacking; keep doing so
+        btrfs_compression = libcalamares.globalstorage.value("btrfsCompression")
+        if filesystem == "btrfs" and btrfs_compression and "compress" not in options:
+            options += ",compress={}".format(btrfs_compression)
+
         if mount_point == "/" and filesystem != "btrfs":
             check = 1
         elif mount_point and mount_point != "swap" and filesystem != "btrfs":
@@ -305,40 +327,53 @@ def create_swapfile(root_mount_point, root_btrfs):
     as documented in
         https://wiki.archlinux.org/index.php/Swap#Swap_file
 
+    The size is the one suggested by the partition module, or 512MiB
+    if there is no suggestion. The file is allocated and given a swap
+    header in one go by libcalamares, so there is no progress in between.
+
     The swapfile-creation covers progress from 0.2 to 0.5
     """
     libcalamares.job.setprogress(0.2)
     if root_btrfs:
         # btrfs swapfiles must reside on a subvolume that is not snapshotted to prevent file system corruption
         swapfile_path = os.path.join(root_mount_point, "swap/swapfile")
-        with open(swapfile_path, "wb") as f:
-            pass
-        o = subprocess.check_output(["chattr", "+C", swapfile_path])
-        libcalamares.utils.debug("swapfile attributes: {!s}".format(o))
-        o = subprocess.check_output(["btrfs", "property", "set", swapfile_path, "compression", "none"])
-        libcalamares.utils.debug("swapfile compression: {!s}".format(o))
     else:
         swapfile_path = os.path.join(root_mount_point, "swapfile")
-        with open(swapfile_path, "wb") as f:
-            pass
-    # Create the swapfile; swapfiles are small-ish
-    zeroes = bytes(16384)
-    with open(swapfile_path, "wb") as f:
-        total = 0
-        desired_size = 512 * 1024 * 1024  # 512MiB
-        while total < desired_size:
-            chunk = f.write(zeroes)
-            if chunk < 1:
-                libcalamares.utils.debug("Short write on {!s}, cancelling.".format(swapfile_path))
-                break
-            libcalamares.job.setprogress(0.2 + 0.3 * ( total / desired_size ) )
-            total += chunk
-    os.chmod(swapfile_path, 0o600)
-    o = subprocess.check_output(["mkswap", swapfile_path])
-    libcalamares.utils.debug("swapfile mkswap: {!s}".format(o))
+
+    size_mib = libcalamares.globalstorage.value("swapFileSizeMiB")
+    if not size_mib or size_mib <= 0:
+        size_mib = 512
+    # On btrfs, No_COW also turns off compression, which swapfiles need
+    ec = libcalamares.utils.create_swapfile(swapfile_path, size_mib * 1024 * 1024, root_btrfs)
+    if ec != 0:
+        raise OSError(ec, os.strerror(ec), swapfile_path)
+    libcalamares.utils.debug("swapfile {!s} created, {!s}MiB".format(swapfile_path, size_mib))
     libcalamares.job.setprogress(0.5)
 
 
+def create_zram_config(root_mount_point, compression):
+    """
+    Writes the zram-generator configuration in @p root_mount_point, so
+    that the target system swaps to compressed RAM (zram0) instead of
+    to disk. There is no fstab entry for it: systemd sets it up at boot.
+
+    The size is the one suggested by the partition module; if there is
+    no suggestion, zram-generator uses its own default size.
+    """
+    size_mib = libcalamares.globalstorage.value("zramSizeMiB")
+    config_path = os.path.join(root_mount_point, "etc/systemd/zram-generator.conf")
+    mkdir_p(os.path.dirname(config_path))
+    with open(config_path, "w") as config_file:
+        config_file.write("# Compressed swap in RAM, configured by Calamares\n")
+        config_file.write("[zram0]\n")
+        if size_mib and size_mib > 0:
+            config_file.write("zram-size = {!s}\n".format(size_mib))
+        if compression:
+            config_file.write("compression-algorithm = {!s}\n".format(compression))
+        config_file.write("swap-priority = 100\n")
+    libcalamares.utils.debug("zram swap configured, {!s}MiB".format(size_mib))
+
+
 def run():
     """ Configures fstab.
 
@@ -364,8 +399,10 @@ def run():
 
     # This follows the GS settings from the partition module's Config object
     swap_choice = global_storage.value( "partitionChoices" )
+    zram_swap = False
     if swap_choice:
         swap_choice = swap_choice.get( "swap", None )
+        zram_swap = swap_choice == "zram"
         if swap_choice and swap_choice == "file":
             # There's no formatted partition for it, so we'll sneak in an entry
             root_partitions = [ p["fs"].lower() for p in partitions if p["mountPoint"] == "/" ]
@@ -400,6 +437,8 @@ def run():
         root_partitions = [ p["fs"].lower() for p in partitions if p["mountPoint"] == "/" ]
         root_btrfs = (root_partitions[0] == "btrfs") if root_partitions else False
         create_swapfile(root_mount_point, root_btrfs)
+    if zram_swap:
+        create_zram_config(root_mount_point, conf.get("zramCompression", None))
 
     try:
         libcalamares.job.setprogress(0.5)
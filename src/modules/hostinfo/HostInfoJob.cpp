@@ -12,6 +12,7 @@
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 #include "utils/CalamaresUtilsSystem.h"
+#include "utils/HardwareInfo.h"
 #include "utils/Logger.h"
 #include "utils/Units.h"
 
@@ -139,24 +140,16 @@ hostCPUmatchARM( const QString& s )
 QString
 hostCPU_Linux()
 {
-    QFile cpuinfo( "/proc/cpuinfo" );
-    if ( cpuinfo.open( QIODevice::ReadOnly ) )
+    const auto& info = CalamaresUtils::HardwareInfo::instance();
+    if ( !info.cpuVendor().isEmpty() )
     {
-        QTextStream in( &cpuinfo );
-        QString line;
-        while ( in.readLineInto( &line ) )
-        {
-            if ( line.startsWith( "vendor_id" ) )
-            {
-                return hostCPUmatch( line );
-            }
-            if ( line.startsWith( "CPU implementer" ) )
-            {
-                return hostCPUmatchARM( line );
-            }
-        }
+        return hostCPUmatch( info.cpuVendor() );
     }
-    return QString();  // Not open, or not found
+    if ( !info.cpuImplementer().isEmpty() )
+    {
+        return hostCPUmatchARM( info.cpuImplementer() );
+    }
+    return QString();  // Not found
 }
 #endif
 
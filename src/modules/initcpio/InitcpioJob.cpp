@@ -10,12 +10,24 @@
 #include "InitcpioJob.h"
 
 #include "utils/CalamaresUtilsSystem.h"
+#include "utils/Checksum.h"
 #include "utils/Logger.h"
+#include "utils/String.h"
 #include "utils/UMask.h"
 #include "utils/Variant.h"
 
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QRegularExpression>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <vector>
+
+using CalamaresUtils::System;
 
 InitcpioJob::InitcpioJob( QObject* parent )
     : Calamares::CppJob( parent )
@@ -45,6 +57,151 @@ fixPermissions( const QDir& d )
     }
 }
 
+QStringList
+installedPresets( const QDir& presetDir )
+{
+    QStringList presets;
+    for ( const auto& fi : presetDir.entryInfoList( { "*.preset" }, QDir::Files, QDir::Name ) )
+    {
+        presets.append( fi.completeBaseName() );
+    }
+    return presets;
+}
+
+/// @brief The values of the `<prefix>...<suffix>=value` lines in a preset
+static QStringList
+presetValues( const QString& presetContents, const QString& pattern )
+{
+    // Presets are shell scripts; this is good enough for the ones mkinitcpio ships.
+    QRegularExpression re( QStringLiteral( "^\\s*%1=[\"']?([^\"'\\s]+)" ).arg( pattern ),
+                           QRegularExpression::MultilineOption );
+    QStringList values;
+    auto it = re.globalMatch( presetContents );
+    while ( it.hasNext() )
+    {
+        values.append( it.next().captured( 1 ) );
+    }
+    return values;
+}
+
+QStringList
+presetImages( const QString& presetContents )
+{
+    return presetValues( presetContents, QStringLiteral( "\\w+_image" ) );
+}
+
+QString
+presetKernel( const QString& presetContents )
+{
+    const auto values = presetValues( presetContents, QStringLiteral( "ALL_kver" ) );
+    return values.isEmpty() ? QString() : values.last();
+}
+
+QStringList
+configHooks( const QString& configContents )
+{
+    QRegularExpression re( QStringLiteral( "^\\s*HOOKS=(?:\\(([^)]*)\\)|\"([^\"]*)\")" ),
+                           QRegularExpression::MultilineOption );
+    QStringList hooks;
+    auto it = re.globalMatch( configContents );
+    while ( it.hasNext() )
+    {
+        const auto match = it.next();
+        const QString list = match.captured( 1 ).isEmpty() ? match.captured( 2 ) : match.captured( 1 );
+        hooks = list.split( QRegularExpression( QStringLiteral( "\\s+" ) ), SplitSkipEmptyParts );
+    }
+    return hooks;
+}
+
+/// @brief Does the mkinitcpio configuration in the target use the *autodetect* hook?
+static bool
+targetUsesAutodetect()
+{
+    const auto* system = System::instance();
+    QStringList configFiles { system->targetPath( QStringLiteral( "/etc/mkinitcpio.conf" ) ) };
+    const QDir confDir( system->targetPath( QStringLiteral( "/etc/mkinitcpio.conf.d" ) ) );
+    for ( const auto& fi : confDir.entryInfoList( { "*.conf" }, QDir::Files, QDir::Name ) )
+    {
+        configFiles.append( fi.absoluteFilePath() );
+    }
+
+    QStringList hooks;
+    for ( const auto& path : configFiles )
+    {
+        QFile f( path );
+        if ( f.open( QIODevice::ReadOnly ) )
+        {
+            const auto fileHooks = configHooks( QString::fromUtf8( f.readAll() ) );
+            if ( !fileHooks.isEmpty() )
+            {
+                hooks = fileHooks;
+            }
+        }
+    }
+    return hooks.contains( QStringLiteral( "autodetect" ) );
+}
+
+bool
+InitcpioJob::isUnchanged( const QString& preset ) const
+{
+    const auto* system = System::instance();
+    const QString root = system->targetPath( QStringLiteral( "/" ) );
+    if ( root.isEmpty() || QFileInfo( root ).canonicalFilePath() == QStringLiteral( "/" ) )
+    {
+        // Not installing to a separate root, nothing to compare with
+        return false;
+    }
+    if ( targetUsesAutodetect() )
+    {
+        // The image from the live system only has the modules for the machine it was made on
+        cDebug() << "The target uses the autodetect hook, generating the initramfs for" << preset;
+        return false;
+    }
+
+    const QString presetFile = QStringLiteral( "/etc/mkinitcpio.d/%1.preset" ).arg( preset );
+    QFile f( system->targetPath( presetFile ) );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        return false;
+    }
+    const QString contents = QString::fromUtf8( f.readAll() );
+    const auto images = presetImages( contents );
+    if ( images.isEmpty() )
+    {
+        return false;
+    }
+    for ( const auto& image : images )
+    {
+        if ( !QFileInfo::exists( system->targetPath( image ) ) )
+        {
+            return false;
+        }
+    }
+
+    // Everything that goes into the image, apart from the files the hooks pick up
+    QStringList inputs { QStringLiteral( "/etc/mkinitcpio.conf" ),
+                         QStringLiteral( "/etc/mkinitcpio.conf.d" ),
+                         presetFile,
+                         QStringLiteral( "/etc/initcpio" ),
+                         QStringLiteral( "/usr/lib/initcpio" ),
+                         QStringLiteral( "/etc/crypttab" ),
+                         QStringLiteral( "/etc/vconsole.conf" ) };
+    const QString kernel = presetKernel( contents );
+    if ( !kernel.isEmpty() )
+    {
+        inputs.append( kernel );
+    }
+    for ( const auto& moduleDir : QDir( system->targetPath( QStringLiteral( "/usr/lib/modules" ) ) )
+                                      .entryList( QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name ) )
+    {
+        inputs.append( QStringLiteral( "/usr/lib/modules/%1/modules.dep" ).arg( moduleDir ) );
+        inputs.append( QStringLiteral( "/usr/lib/modules/%1/modules.builtin" ).arg( moduleDir ) );
+    }
+
+    return CalamaresUtils::filesChecksum( QStringLiteral( "/" ), inputs )
+        == CalamaresUtils::filesChecksum( root, inputs );
+}
+
 Calamares::JobResult
 InitcpioJob::exec()
 {
@@ -63,10 +220,60 @@ InitcpioJob::exec()
         }
     }
 
-    cDebug() << "Updating initramfs with kernel" << m_kernel;
-    auto r = CalamaresUtils::System::instance()->targetEnvCommand(
-        { "mkinitcpio", "-p", m_kernel }, QString(), QString() /* no timeout , 0 */ );
-    return r.explainProcess( "mkinitcpio", std::chrono::seconds( 10 ) /* fake timeout */ );
+    QStringList presets;
+    if ( m_kernel == QStringLiteral( "all" ) )
+    {
+        presets = installedPresets( QDir( System::instance()->targetPath( "/etc/mkinitcpio.d" ) ) );
+    }
+    if ( presets.isEmpty() )
+    {
+        presets.append( m_kernel );
+    }
+    if ( m_skipUnchanged )
+    {
+        for ( auto it = presets.begin(); it != presets.end(); )
+        {
+            if ( isUnchanged( *it ) )
+            {
+                cDebug() << "Keeping initramfs for" << *it << "from the live system.";
+                it = presets.erase( it );
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount( m_parallel > 0 ? m_parallel : QThread::idealThreadCount() );
+    cDebug() << "Updating initramfs for" << presets << "with" << pool.maxThreadCount() << "workers.";
+    std::vector< CalamaresUtils::ProcessResult > results( std::size_t( presets.count() ),
+                                                          CalamaresUtils::ProcessResult( 0, QString() ) );
+    QList< QFuture< void > > running;
+    for ( int i = 0; i < presets.count(); ++i )
+    {
+        running.append( QtConcurrent::run( &pool, [&result = results[ std::size_t( i ) ], preset = presets.at( i )]() {
+            result = System::runCommand( System::RunLocation::RunInTarget, { "mkinitcpio", "-p", preset } );
+        } ) );
+    }
+
+    // Wait for all of them, then report the first failure
+    for ( int i = 0; i < running.count(); ++i )
+    {
+        running[ i ].waitForFinished();
+        emit progress( qreal( i + 1 ) / running.count() );
+    }
+    for ( int i = 0; i < presets.count(); ++i )
+    {
+        const auto& r = results.at( std::size_t( i ) );
+        if ( r.getExitCode() != 0 )
+        {
+            cWarning() << "mkinitcpio failed for preset" << presets.at( i );
+            return r.explainProcess( "mkinitcpio", std::chrono::seconds( 10 ) /* fake timeout */ );
+        }
+    }
+    return Calamares::JobResult::ok();
 }
 
 void
@@ -97,6 +304,8 @@ InitcpioJob::setConfigurationMap( const QVariantMap& configurationMap )
     }
 
     m_unsafe = CalamaresUtils::getBool( configurationMap, "be_unsafe", false );
+    m_skipUnchanged = CalamaresUtils::getBool( configurationMap, "skip_unchanged", false );
+    m_parallel = int( CalamaresUtils::getInteger( configurationMap, "parallel", 0 ) );
 }
 
 CALAMARES_PLUGIN_FACTORY_DEFINITION( InitcpioJobFactory, registerPlugin< InitcpioJob >(); )
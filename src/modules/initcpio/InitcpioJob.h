@@ -14,7 +14,9 @@
 #include "DllMacro.h"
 #include "utils/PluginFactory.h"
 
+#include <QDir>
 #include <QObject>
+#include <QStringList>
 #include <QVariantMap>
 
 class PLUGINDLLEXPORT InitcpioJob : public Calamares::CppJob
@@ -32,10 +34,38 @@ public:
     void setConfigurationMap( const QVariantMap& configurationMap ) override;
 
 private:
+    /// @brief Is the initramfs for @p preset in the target the same as one generated from it?
+    bool isUnchanged( const QString& preset ) const;
+
     QString m_kernel;
     bool m_unsafe = false;
+    bool m_skipUnchanged = false;
+    int m_parallel = 0;
 };
 
+/** @brief The names of the presets in @p presetDir
+ *
+ * These are the names of the `*.preset` files in the directory
+ * (without the suffix), sorted, as passed to `mkinitcpio -p`.
+ */
+QStringList installedPresets( const QDir& presetDir );
+
+/** @brief The images that mkinitcpio generates for a preset
+ *
+ * Returns the paths of the images named in the contents of a
+ * `.preset` file, e.g. `default_image="/boot/initramfs-linux.img"`.
+ */
+QStringList presetImages( const QString& presetContents );
+
+/// @brief The kernel named by the `ALL_kver` line of a `.preset` file
+QString presetKernel( const QString& presetContents );
+
+/** @brief The hooks named by the (last) `HOOKS` line of a `mkinitcpio.conf`
+ *
+ * Both `HOOKS=(base udev)` and the older `HOOKS="base udev"` are understood.
+ */
+QStringList configHooks( const QString& configContents );
+
 CALAMARES_PLUGIN_FACTORY_DECLARATION( InitcpioJobFactory )
 
 #endif  // INITCPIOJOB_H
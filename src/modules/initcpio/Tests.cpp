@@ -9,6 +9,8 @@
 
 #include "Tests.h"
 
+#include "InitcpioJob.h"
+
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 #include "Settings.h"
@@ -18,8 +20,10 @@
 
 #include <QtTest/QtTest>
 
+#include <QFile>
 #include <QFileInfo>
 #include <QStringList>
+#include <QTemporaryDir>
 
 extern void fixPermissions( const QDir& d );
 
@@ -44,3 +48,47 @@ InitcpioTests::testFixPermissions()
     fixPermissions( QDir( "/nonexistent/nonexistent" ) );
     QVERIFY( true );
 }
+
+void
+InitcpioTests::testPresets()
+{
+    static const char preset[] = "# mkinitcpio preset file for the 'linux' package\n"
+                                 "\n"
+                                 "ALL_config=\"/etc/mkinitcpio.conf\"\n"
+                                 "ALL_kver=\"/boot/vmlinuz-linux\"\n"
+                                 "\n"
+                                 "PRESETS=('default' 'fallback')\n"
+                                 "\n"
+                                 "#default_config=\"/etc/mkinitcpio.conf\"\n"
+                                 "default_image=\"/boot/initramfs-linux.img\"\n"
+                                 "#default_options=\"\"\n"
+                                 "\n"
+                                 "#fallback_config=\"/etc/mkinitcpio.conf\"\n"
+                                 "fallback_image='/boot/initramfs-linux-fallback.img'\n"
+                                 "fallback_options=\"-S autodetect\"\n";
+    QCOMPARE( presetImages( preset ),
+              QStringList( { "/boot/initramfs-linux.img", "/boot/initramfs-linux-fallback.img" } ) );
+    QCOMPARE( presetKernel( preset ), QStringLiteral( "/boot/vmlinuz-linux" ) );
+    QVERIFY( presetImages( QString() ).isEmpty() );
+    QVERIFY( presetKernel( QString() ).isEmpty() );
+
+    const QString config = "MODULES=()\n"
+                           "#HOOKS=(base)\n"
+                           "HOOKS=(base udev autodetect modconf block filesystems)\n";
+    QCOMPARE( configHooks( config ),
+              QStringList( { "base", "udev", "autodetect", "modconf", "block", "filesystems" } ) );
+    QCOMPARE( configHooks( config + "HOOKS=\"base systemd\"\n" ), QStringList( { "base", "systemd" } ) );
+    QVERIFY( configHooks( QString() ).isEmpty() );
+
+    QTemporaryDir d;
+    QVERIFY( d.isValid() );
+    QVERIFY( installedPresets( QDir( d.path() ) ).isEmpty() );
+    for ( const auto& name : { "linux.preset", "linux-lts.preset", "linux.preset.pacsave", "README" } )
+    {
+        QFile f( d.filePath( name ) );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        f.write( preset );
+    }
+    QCOMPARE( installedPresets( QDir( d.path() ) ), QStringList( { "linux-lts", "linux" } ) );
+    QVERIFY( installedPresets( QDir( "/nonexistent/nonexistent" ) ).isEmpty() );
+}
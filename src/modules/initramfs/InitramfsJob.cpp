@@ -10,10 +10,22 @@
 #include "InitramfsJob.h"
 
 #include "utils/CalamaresUtilsSystem.h"
+#include "utils/Checksum.h"
 #include "utils/Logger.h"
 #include "utils/UMask.h"
 #include "utils/Variant.h"
 
+#include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <vector>
+
+using CalamaresUtils::System;
+
 InitramfsJob::InitramfsJob( QObject* parent )
     : Calamares::CppJob( parent )
 {
@@ -28,13 +40,87 @@ InitramfsJob::prettyName() const
     return tr( "Creating initramfs." );
 }
 
+QStringList
+installedKernels( const QDir& bootDir )
+{
+    static const QString prefix = QStringLiteral( "vmlinuz-" );
+
+    QStringList versions;
+    for ( const auto& name : bootDir.entryList( { prefix + '*' }, QDir::Files, QDir::Name ) )
+    {
+        versions.append( name.mid( prefix.length() ) );
+    }
+    return versions;
+}
+
+bool
+InitramfsJob::isUnchanged( const QString& version ) const
+{
+    const auto* system = System::instance();
+    const QString root = system->targetPath( QStringLiteral( "/" ) );
+    if ( root.isEmpty() || QFileInfo( root ).canonicalFilePath() == QStringLiteral( "/" ) )
+    {
+        // Not installing to a separate root, nothing to compare with
+        return false;
+    }
+    if ( !QFileInfo::exists( system->targetPath( QStringLiteral( "/boot/initrd.img-%1" ).arg( version ) ) ) )
+    {
+        return false;
+    }
+
+    // Everything that goes into the image, apart from the files the hooks pick up
+    const QStringList inputs { QStringLiteral( "/etc/initramfs-tools" ),
+                               QStringLiteral( "/usr/share/initramfs-tools" ),
+                               QStringLiteral( "/etc/crypttab" ),
+                               QStringLiteral( "/etc/default/keyboard" ),
+                               QStringLiteral( "/etc/console-setup" ),
+                               QStringLiteral( "/boot/config-%1" ).arg( version ),
+                               QStringLiteral( "/lib/modules/%1/modules.dep" ).arg( version ),
+                               QStringLiteral( "/lib/modules/%1/modules.builtin" ).arg( version ) };
+    return CalamaresUtils::filesChecksum( QStringLiteral( "/" ), inputs )
+        == CalamaresUtils::filesChecksum( root, inputs );
+}
 
 Calamares::JobResult
 InitramfsJob::exec()
 {
     CalamaresUtils::UMask m( CalamaresUtils::UMask::Safe );
 
-    cDebug() << "Updating initramfs with kernel" << m_kernel;
+    QStringList versions;
+    if ( m_kernel == QStringLiteral( "all" ) )
+    {
+        versions = installedKernels( QDir( System::instance()->targetPath( "/boot" ) ) );
+    }
+    if ( versions.isEmpty() )
+    {
+        versions.append( m_kernel );
+    }
+    // This must happen before the safe-UMASK configuration is written,
+    // which the live system does not have.
+    if ( m_skipUnchanged )
+    {
+        for ( auto it = versions.begin(); it != versions.end(); )
+        {
+            if ( isUnchanged( *it ) )
+            {
+                cDebug() << "Keeping initramfs for" << *it << "from the live system.";
+                if ( !m_unsafe )
+                {
+                    QFile::setPermissions( System::instance()->targetPath( "/boot/initrd.img-" + *it ),
+                                           QFileDevice::ReadOwner | QFileDevice::WriteOwner );
+                }
+                it = versions.erase( it );
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+    if ( versions.isEmpty() )
+    {
+        return Calamares::JobResult::ok();
+    }
 
     if ( m_unsafe )
     {
@@ -53,9 +139,37 @@ InitramfsJob::exec()
     }
 
     // And then do the ACTUAL work.
-    auto r = CalamaresUtils::System::instance()->targetEnvCommand(
-        { "update-initramfs", "-k", m_kernel, "-c", "-t" }, QString(), QString() /* no timeout, 0 */ );
-    return r.explainProcess( "update-initramfs", std::chrono::seconds( 10 ) /* fake timeout */ );
+    QThreadPool pool;
+    pool.setMaxThreadCount( m_parallel > 0 ? m_parallel : QThread::idealThreadCount() );
+    cDebug() << "Updating initramfs for" << versions << "with" << pool.maxThreadCount() << "workers.";
+    std::vector< CalamaresUtils::ProcessResult > results( std::size_t( versions.count() ),
+                                                          CalamaresUtils::ProcessResult( 0, QString() ) );
+    QList< QFuture< void > > running;
+    for ( int i = 0; i < versions.count(); ++i )
+    {
+        running.append(
+            QtConcurrent::run( &pool, [&result = results[ std::size_t( i ) ], version = versions.at( i )]() {
+                result = System::runCommand( System::RunLocation::RunInTarget,
+                                             { "update-initramfs", "-k", version, "-c", "-t" } );
+            } ) );
+    }
+
+    // Wait for all of them, then report the first failure
+    for ( int i = 0; i < running.count(); ++i )
+    {
+        running[ i ].waitForFinished();
+        emit progress( qreal( i + 1 ) / running.count() );
+    }
+    for ( int i = 0; i < versions.count(); ++i )
+    {
+        const auto& r = results.at( std::size_t( i ) );
+        if ( r.getExitCode() != 0 )
+        {
+            cWarning() << "update-initramfs failed for kernel" << versions.at( i );
+            return r.explainProcess( "update-initramfs", std::chrono::seconds( 10 ) /* fake timeout */ );
+        }
+    }
+    return Calamares::JobResult::ok();
 }
 
 
@@ -87,6 +201,8 @@ InitramfsJob::setConfigurationMap( const QVariantMap& configurationMap )
     }
 
     m_unsafe = CalamaresUtils::getBool( configurationMap, "be_unsafe", false );
+    m_skipUnchanged = CalamaresUtils::getBool( configurationMap, "skip_unchanged", false );
+    m_parallel = int( CalamaresUtils::getInteger( configurationMap, "parallel", 0 ) );
 }
 
 CALAMARES_PLUGIN_FACTORY_DEFINITION( InitramfsJobFactory, registerPlugin< InitramfsJob >(); )
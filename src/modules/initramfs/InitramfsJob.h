@@ -14,7 +14,9 @@
 #include "DllMacro.h"
 #include "utils/PluginFactory.h"
 
+#include <QDir>
 #include <QObject>
+#include <QStringList>
 #include <QVariantMap>
 
 class PLUGINDLLEXPORT InitramfsJob : public Calamares::CppJob
@@ -32,10 +34,22 @@ public:
     void setConfigurationMap( const QVariantMap& configurationMap ) override;
 
 private:
+    /// @brief Is the initramfs for @p version in the target the same as one generated from it?
+    bool isUnchanged( const QString& version ) const;
+
     QString m_kernel;
     bool m_unsafe = false;
+    bool m_skipUnchanged = false;
+    int m_parallel = 0;
 };
 
+/** @brief The versions of the kernels in @p bootDir
+ *
+ * These are the versions of the `vmlinuz-<version>` files in
+ * the directory, sorted, as passed to `update-initramfs -k`.
+ */
+QStringList installedKernels( const QDir& bootDir );
+
 CALAMARES_PLUGIN_FACTORY_DECLARATION( InitramfsJobFactory )
 
 #endif  // INITRAMFSJOB_H
@@ -9,6 +9,8 @@
 
 #include "Tests.h"
 
+#include "InitramfsJob.h"
+
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 #include "Settings.h"
@@ -21,6 +23,7 @@
 
 #include <QFileInfo>
 #include <QStringList>
+#include <QTemporaryDir>
 
 QTEST_GUILESS_MAIN( InitramfsTests )
 
@@ -72,3 +75,20 @@ InitramfsTests::testCreateTargetFile()
 
     QFile::remove( path );
 }
+
+void
+InitramfsTests::testInstalledKernels()
+{
+    QTemporaryDir d;
+    QVERIFY( d.isValid() );
+    QVERIFY( installedKernels( QDir( d.path() ) ).isEmpty() );
+    QVERIFY( QDir( d.path() ).mkpath( "vmlinuz-directory" ) );
+    for ( const auto& name :
+          { "vmlinuz-5.10.0-9-amd64", "vmlinuz-5.14.0-2-amd64", "config-5.10.0-9-amd64", "vmlinuz.old" } )
+    {
+        QFile f( d.filePath( name ) );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+    }
+    QCOMPARE( installedKernels( QDir( d.path() ) ), QStringList( { "5.10.0-9-amd64", "5.14.0-2-amd64" } ) );
+    QVERIFY( installedKernels( QDir( "/nonexistent/nonexistent" ) ).isEmpty() );
+}
@@ -25,6 +25,8 @@ private Q_SLOTS:
 
     // TODO: this doesn't actually test any of the functionality of this job
     void testCreateTargetFile();
+
+    void testInstalledKernels();
 };
 
 #endif
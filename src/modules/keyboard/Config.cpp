@@ -15,6 +15,7 @@
 
 #include "GlobalStorage.h"
 #include "JobQueue.h"
+#include "geoip/Prefetch.h"
 #include "utils/Logger.h"
 #include "utils/RAII.h"
 #include "utils/Retranslator.h"
@@ -22,9 +23,13 @@
 #include "utils/Variant.h"
 
 #include <QApplication>
+#include <QFile>
+#include <QHash>
 #include <QProcess>
 #include <QTimer>
 
+#include <algorithm>
+
 /* Returns stringlist with suitable setxkbmap command-line arguments
  * to set the given @p model.
  */
@@ -112,39 +117,64 @@ xkbmap_query_grp_option()
     return outputLine.mid( index, lastIndex - index );
 }
 
-AdditionalLayoutInfo
-Config::getAdditionalLayoutInfo( const QString& layout )
+/* Returns the group-switch option, asking setxkbmap only once
+ *
+ * The live session's option does not change while Calamares runs
+ * (except through Calamares itself), so one query is enough.
+ */
+static QString
+cached_grp_option()
 {
-    QFile layoutTable( ":/non-ascii-layouts" );
-
-    if ( !layoutTable.open( QIODevice::ReadOnly | QIODevice::Text ) )
-    {
-        cError() << "Non-ASCII layout table could not be opened";
-        return AdditionalLayoutInfo();
-    }
-
-    QString tableLine;
-
-    do
-    {
-        tableLine = layoutTable.readLine();
-    } while ( layoutTable.canReadLine() && !tableLine.startsWith( layout ) );
+    static const QString option = xkbmap_query_grp_option();
+    return option;
+}
 
-    if ( !tableLine.startsWith( layout ) )
-    {
-        return AdditionalLayoutInfo();
-    }
+/* Reads the table of non-ASCII layouts once; the key is the layout,
+ * the value says which layout to add for ASCII support.
+ */
+static const QHash< QString, AdditionalLayoutInfo >&
+additionalLayoutTable()
+{
+    static const QHash< QString, AdditionalLayoutInfo > table = []() {
+        QHash< QString, AdditionalLayoutInfo > t;
+        QFile layoutTable( ":/non-ascii-layouts" );
 
-    QStringList tableEntries = tableLine.split( " ", SplitSkipEmptyParts );
+        if ( !layoutTable.open( QIODevice::ReadOnly | QIODevice::Text ) )
+        {
+            cError() << "Non-ASCII layout table could not be opened";
+            return t;
+        }
 
-    AdditionalLayoutInfo r;
+        while ( !layoutTable.atEnd() )
+        {
+            const QString tableLine = QString::fromUtf8( layoutTable.readLine() ).trimmed();
+            if ( tableLine.isEmpty() || tableLine.startsWith( '#' ) )
+            {
+                continue;
+            }
 
-    r.additionalLayout = tableEntries[ 1 ];
-    r.additionalVariant = tableEntries[ 2 ] == "-" ? "" : tableEntries[ 2 ];
+            const QStringList tableEntries = tableLine.split( " ", SplitSkipEmptyParts );
+            if ( tableEntries.count() < 4 )
+            {
+                cWarning() << "Non-ASCII layout table has bad line" << tableLine;
+                continue;
+            }
 
-    r.vconsoleKeymap = tableEntries[ 3 ];
+            AdditionalLayoutInfo r;
+            r.additionalLayout = tableEntries[ 1 ];
+            r.additionalVariant = tableEntries[ 2 ] == "-" ? "" : tableEntries[ 2 ];
+            r.vconsoleKeymap = tableEntries[ 3 ];
+            t.insert( tableEntries[ 0 ], r );
+        }
+        return t;
+    }();
+    return table;
+}
 
-    return r;
+AdditionalLayoutInfo
+Config::getAdditionalLayoutInfo( const QString& layout )
+{
+    return additionalLayoutTable().value( layout );
 }
 
 Config::Config( QObject* parent )
@@ -157,13 +187,21 @@ Config::Config( QObject* parent )
 
     // Connect signals and slots
     connect( m_keyboardModelsModel, &KeyboardModelsModel::currentIndexChanged, [&]( int index ) {
+        if ( m_retranslating )
+        {
+            return;
+        }
         // Set Xorg keyboard model
         m_selectedModel = m_keyboardModelsModel->key( index );
-        QProcess::execute( "setxkbmap", xkbmap_model_args( m_selectedModel ) );
+        runSetxkbmap( xkbmap_model_args( m_selectedModel ) );
         emit prettyStatusChanged();
     } );
 
     connect( m_keyboardLayoutsModel, &KeyboardLayoutModel::currentIndexChanged, [&]( int index ) {
+        if ( m_retranslating )
+        {
+            return;
+        }
         m_selectedLayout = m_keyboardLayoutsModel->item( index ).first;
         updateVariants( QPersistentModelIndex( m_keyboardLayoutsModel->index( index ) ) );
         emit prettyStatusChanged();
@@ -180,11 +218,30 @@ Config::Config( QObject* parent )
     m_selectedModel = m_keyboardModelsModel->key( m_keyboardModelsModel->currentIndex() );
     m_selectedLayout = m_keyboardLayoutsModel->item( m_keyboardLayoutsModel->currentIndex() ).first;
     m_selectedVariant = m_keyboardVariantsModel->key( m_keyboardVariantsModel->currentIndex() );
+
+    // Follow the locale as it changes (e.g. on the locale page); guessing
+    // stops once the user has picked something.
+    auto* jobQueue = Calamares::JobQueue::instance();
+    if ( jobQueue && jobQueue->globalStorage() )
+    {
+        auto* gs = jobQueue->globalStorage();
+        connect( gs, &Calamares::GlobalStorage::changed, this, [this, gs]() {
+            const QString lang = gs->value( "localeConf" ).toMap().value( "LANG" ).toString();
+            if ( !lang.isEmpty() && lang != m_guessedLanguage )
+            {
+                guessLocaleKeyboardLayout();
+            }
+        } );
+    }
 }
 
 void
 Config::xkbChanged( int index )
 {
+    if ( m_retranslating )
+    {
+        return;
+    }
     // Set Xorg keyboard layout + variant
     m_selectedVariant = m_keyboardVariantsModel->key( index );
 
@@ -207,17 +264,16 @@ Config::xkbApply()
 
     if ( !m_additionalLayoutInfo.additionalLayout.isEmpty() )
     {
-        m_additionalLayoutInfo.groupSwitcher = xkbmap_query_grp_option();
+        m_additionalLayoutInfo.groupSwitcher = cached_grp_option();
 
         if ( m_additionalLayoutInfo.groupSwitcher.isEmpty() )
         {
             m_additionalLayoutInfo.groupSwitcher = "grp:alt_shift_toggle";
         }
 
-        QProcess::execute( "setxkbmap",
-                           xkbmap_layout_args( { m_additionalLayoutInfo.additionalLayout, m_selectedLayout },
-                                               { m_additionalLayoutInfo.additionalVariant, m_selectedVariant },
-                                               m_additionalLayoutInfo.groupSwitcher ) );
+        runSetxkbmap( xkbmap_layout_args( { m_additionalLayoutInfo.additionalLayout, m_selectedLayout },
+                                          { m_additionalLayoutInfo.additionalVariant, m_selectedVariant },
+                                          m_additionalLayoutInfo.groupSwitcher ) );
 
 
         cDebug() << "xkbmap selection changed to: " << m_selectedLayout << '-' << m_selectedVariant << "(added "
@@ -226,12 +282,70 @@ Config::xkbApply()
     }
     else
     {
-        QProcess::execute( "setxkbmap", xkbmap_layout_args( m_selectedLayout, m_selectedVariant ) );
+        runSetxkbmap( xkbmap_layout_args( m_selectedLayout, m_selectedVariant ) );
         cDebug() << "xkbmap selection changed to: " << m_selectedLayout << '-' << m_selectedVariant;
     }
     m_setxkbmapTimer.disconnect( this );
 }
 
+void
+Config::runSetxkbmap( const QStringList& args )
+{
+    // A newer request of the same kind (-model or -layout) replaces
+    // one that has not started yet; the old one is out of date anyway.
+    const QString kind = args.value( 0 );
+    auto pending = std::find_if( m_pendingXkbmap.begin(), m_pendingXkbmap.end(), [&kind]( const QStringList& a ) {
+        return a.value( 0 ) == kind;
+    } );
+    if ( pending != m_pendingXkbmap.end() )
+    {
+        *pending = args;
+    }
+    else
+    {
+        m_pendingXkbmap.append( args );
+    }
+
+    if ( !m_setxkbmap )
+    {
+        startSetxkbmap();
+    }
+}
+
+void
+Config::startSetxkbmap()
+{
+    if ( m_pendingXkbmap.isEmpty() )
+    {
+        return;
+    }
+
+    const QStringList args = m_pendingXkbmap.takeFirst();
+    m_setxkbmap = new QProcess( this );
+    connect( m_setxkbmap,
+             QOverload< int, QProcess::ExitStatus >::of( &QProcess::finished ),
+             this,
+             [this, args]( int exitCode, QProcess::ExitStatus exitStatus ) {
+                 if ( exitStatus != QProcess::NormalExit || exitCode != 0 )
+                 {
+                     cWarning() << "setxkbmap" << args << "failed with exit code" << exitCode;
+                 }
+                 m_setxkbmap->deleteLater();
+                 m_setxkbmap = nullptr;
+                 startSetxkbmap();
+             } );
+    connect( m_setxkbmap, &QProcess::errorOccurred, this, [this, args]( QProcess::ProcessError e ) {
+        if ( e == QProcess::FailedToStart )
+        {
+            cWarning() << "setxkbmap" << args << "could not be started.";
+            m_setxkbmap->deleteLater();
+            m_setxkbmap = nullptr;
+            startSetxkbmap();
+        }
+    } );
+    m_setxkbmap->start( QStringLiteral( "setxkbmap" ), args );
+}
+
 
 KeyboardModelsModel*
 Config::keyboardModels() const
@@ -254,18 +368,8 @@ Config::keyboardVariants() const
 static QPersistentModelIndex
 findLayout( const KeyboardLayoutModel* klm, const QString& currentLayout )
 {
-    QPersistentModelIndex currentLayoutItem;
-
-    for ( int i = 0; i < klm->rowCount(); ++i )
-    {
-        QModelIndex idx = klm->index( i );
-        if ( idx.isValid() && idx.data( KeyboardLayoutModel::KeyboardLayoutKeyRole ).toString() == currentLayout )
-        {
-            currentLayoutItem = idx;
-        }
-    }
-
-    return currentLayoutItem;
+    // An invalid index if there is no such layout (the row is -1)
+    return QPersistentModelIndex( klm->index( klm->findKey( currentLayout ) ) );
 }
 
 void
@@ -380,43 +484,146 @@ Config::createJobs()
     return list;
 }
 
-static void
-guessLayout( const QStringList& langParts, KeyboardLayoutModel* layouts, KeyboardVariantsModel* variants )
+/* Guessing a keyboard layout based on the locale means
+ * mapping between language identifiers in <lang>_<country>
+ * format to keyboard mappings, which are <country>_<layout>
+ * format; in addition, some countries have multiple languages,
+ * so fr_BE and nl_BE want different layouts (both Belgian)
+ * and sometimes the language-country name doesn't match the
+ * keyboard-country name at all (e.g. Ellas vs. Greek).
+ *
+ * This is a table of language-to-keyboard mappings. The
+ * language identifier is the key, while the value is
+ * a string that is used instead of the real language
+ * identifier in guessing -- so it should be something
+ * like <layout>_<country>.
+ *
+ * The table is fixed at build-time; it is turned into a hash
+ * (once) so that each guess is a lookup.
+ */
+struct SpecialCaseLayout
+{
+    const char* locale;
+    const char* layout;
+};
+
+static constexpr char arabic[] = "ara";
+static constexpr const SpecialCaseLayout specialCaseTable[] = {
+    /* Most Arab countries map to Arabic keyboard (Default) */
+    { "ar_AE", arabic },
+    { "ar_BH", arabic },
+    { "ar_DZ", arabic },
+    { "ar_EG", arabic },
+    { "ar_IN", arabic },
+    { "ar_IQ", arabic },
+    { "ar_JO", arabic },
+    { "ar_KW", arabic },
+    { "ar_LB", arabic },
+    { "ar_LY", arabic },
+    /* Not Morocco: use layout ma */
+    { "ar_OM", arabic },
+    { "ar_QA", arabic },
+    { "ar_SA", arabic },
+    { "ar_SD", arabic },
+    { "ar_SS", arabic },
+    /* Not Syria: use layout sy */
+    { "ar_TN", arabic },
+    { "ar_YE", arabic },
+    { "ca_ES", "cat_ES" }, /* Catalan */
+    { "en_CA", "us" }, /* Canadian English */
+    { "el_CY", "gr" }, /* Greek in Cyprus */
+    { "el_GR", "gr" }, /* Greek in Greece */
+    { "ig_NG", "igbo_NG" }, /* Igbo in Nigeria */
+    { "ha_NG", "hausa_NG" }, /* Hausa */
+    { "en_IN", "eng_in" }, /* India, English with Rupee */
+};
+
+static const QHash< QString, QString >&
+specialCaseLayouts()
+{
+    static const QHash< QString, QString > table = []() {
+        QHash< QString, QString > t;
+        for ( const auto& entry : specialCaseTable )
+        {
+            t.insert( QString::fromLatin1( entry.locale ), QString::fromLatin1( entry.layout ) );
+        }
+        return t;
+    }();
+    return table;
+}
+
+QString
+Config::layoutKey( const QString& layout ) const
 {
-    bool foundCountryPart = false;
-    for ( auto countryPart = langParts.rbegin(); !foundCountryPart && countryPart != langParts.rend(); ++countryPart )
+    if ( m_layoutKeys.isEmpty() )
     {
-        cDebug() << Logger::SubEntry << "looking for locale part" << *countryPart;
-        for ( int i = 0; i < layouts->rowCount(); ++i )
+        for ( int i = 0; i < m_keyboardLayoutsModel->rowCount(); ++i )
         {
-            QModelIndex idx = layouts->index( i );
-            QString name
-                = idx.isValid() ? idx.data( KeyboardLayoutModel::KeyboardLayoutKeyRole ).toString() : QString();
-            if ( idx.isValid() && ( name.compare( *countryPart, Qt::CaseInsensitive ) == 0 ) )
+            const QString key = m_keyboardLayoutsModel->key( i );
+            if ( !key.isEmpty() && !m_layoutKeys.contains( key.toLower() ) )
             {
-                cDebug() << Logger::SubEntry << "matched" << name;
-                layouts->setCurrentIndex( i );
-                foundCountryPart = true;
-                break;
+                m_layoutKeys.insert( key.toLower(), key );
             }
         }
-        if ( foundCountryPart )
+    }
+    return m_layoutKeys.value( layout.toLower() );
+}
+
+Config::LayoutGuess
+Config::guessLayout( const QStringList& langParts ) const
+{
+    const QString cacheKey = langParts.join( '_' );
+    const auto cached = m_guessCache.constFind( cacheKey );
+    if ( cached != m_guessCache.constEnd() )
+    {
+        return cached.value();
+    }
+
+    LayoutGuess guess;
+    for ( auto countryPart = langParts.rbegin(); countryPart != langParts.rend(); ++countryPart )
+    {
+        cDebug() << Logger::SubEntry << "looking for locale part" << *countryPart;
+        guess.layout = layoutKey( *countryPart );
+        if ( guess.layout.isEmpty() )
         {
-            ++countryPart;
-            if ( countryPart != langParts.rend() )
+            continue;
+        }
+
+        cDebug() << Logger::SubEntry << "matched" << guess.layout;
+        ++countryPart;
+        if ( countryPart != langParts.rend() )
+        {
+            cDebug() << "Next level:" << *countryPart;
+            const auto variants
+                = m_keyboardLayoutsModel->item( m_keyboardLayoutsModel->findKey( guess.layout ) ).second.variants;
+            for ( const auto& variant : variants )
             {
-                cDebug() << "Next level:" << *countryPart;
-                for ( int variantnumber = 0; variantnumber < variants->rowCount(); ++variantnumber )
+                if ( variant.compare( *countryPart, Qt::CaseInsensitive ) == 0 )
                 {
-                    if ( variants->key( variantnumber ).compare( *countryPart, Qt::CaseInsensitive ) == 0 )
-                    {
-                        variants->setCurrentIndex( variantnumber );
-                        cDebug() << Logger::SubEntry << "matched variant" << *countryPart << ' '
-                                 << variants->key( variantnumber );
-                    }
+                    cDebug() << Logger::SubEntry << "matched variant" << *countryPart << ' ' << variant;
+                    guess.variant = variant;
                 }
             }
         }
+        break;
+    }
+
+    m_guessCache.insert( cacheKey, guess );
+    return guess;
+}
+
+void
+Config::applyGuess( const LayoutGuess& guess )
+{
+    if ( guess.layout.isEmpty() )
+    {
+        return;
+    }
+    // Changing the layout updates the variants model (see updateVariants())
+    m_keyboardLayoutsModel->setCurrentIndex( m_keyboardLayoutsModel->findKey( guess.layout ) );
+    if ( !guess.variant.isEmpty() )
+    {
+        m_keyboardVariantsModel->setCurrentIndex( m_keyboardVariantsModel->findKey( guess.variant ) );
     }
 }
 
@@ -430,56 +637,29 @@ Config::guessLocaleKeyboardLayout()
     cPointerSetter returnToIntial( &m_state, State::Initial );
     m_state = State::Guessing;
 
-    /* Guessing a keyboard layout based on the locale means
-     * mapping between language identifiers in <lang>_<country>
-     * format to keyboard mappings, which are <country>_<layout>
-     * format; in addition, some countries have multiple languages,
-     * so fr_BE and nl_BE want different layouts (both Belgian)
-     * and sometimes the language-country name doesn't match the
-     * keyboard-country name at all (e.g. Ellas vs. Greek).
-     *
-     * This is a table of language-to-keyboard mappings. The
-     * language identifier is the key, while the value is
-     * a string that is used instead of the real language
-     * identifier in guessing -- so it should be something
-     * like <layout>_<country>.
-     */
-    static constexpr char arabic[] = "ara";
-    static const auto specialCaseMap = QMap< std::string, std::string >( {
-        /* Most Arab countries map to Arabic keyboard (Default) */
-        { "ar_AE", arabic },
-        { "ar_BH", arabic },
-        { "ar_DZ", arabic },
-        { "ar_EG", arabic },
-        { "ar_IN", arabic },
-        { "ar_IQ", arabic },
-        { "ar_JO", arabic },
-        { "ar_KW", arabic },
-        { "ar_LB", arabic },
-        { "ar_LY", arabic },
-        /* Not Morocco: use layout ma */
-        { "ar_OM", arabic },
-        { "ar_QA", arabic },
-        { "ar_SA", arabic },
-        { "ar_SD", arabic },
-        { "ar_SS", arabic },
-        /* Not Syria: use layout sy */
-        { "ar_TN", arabic },
-        { "ar_YE", arabic },
-        { "ca_ES", "cat_ES" }, /* Catalan */
-        { "en_CA", "us" }, /* Canadian English */
-        { "el_CY", "gr" }, /* Greek in Cyprus */
-        { "el_GR", "gr" }, /* Greek in Greece */
-        { "ig_NG", "igbo_NG" }, /* Igbo in Nigeria */
-        { "ha_NG", "hausa_NG" }, /* Hausa */
-        { "en_IN", "eng_in" }, /* India, English with Rupee */
-    } );
-
     // Try to preselect a layout, depending on language and locale
     Calamares::GlobalStorage* gs = Calamares::JobQueue::instance()->globalStorage();
     QString lang = gs->value( "localeConf" ).toMap().value( "LANG" ).toString();
+    m_guessedLanguage = lang;
 
     cDebug() << "Got locale language" << lang;
+    if ( lang.isEmpty() )
+    {
+        // No locale (yet), so go by the country from the early GeoIP lookup;
+        // a country alone does not say which of its layouts, so it takes the
+        // language of the user interface.
+        const QString country = gs->value( CalamaresUtils::GeoIP::Prefetch::globalStorageKey() )
+                                    .toMap()
+                                    .value( QStringLiteral( "country" ) )
+                                    .toString();
+        const QString language
+            = CalamaresUtils::translatorLocaleName().name.section( '@', 0, 0 ).section( '_', 0, 0 );
+        if ( !country.isEmpty() && !language.isEmpty() )
+        {
+            lang = language + '_' + country;
+            cDebug() << "Got GeoIP country" << country << "for language" << lang;
+        }
+    }
     if ( !lang.isEmpty() )
     {
         // Chop off .codeset and @modifier
@@ -498,17 +678,18 @@ Config::guessLocaleKeyboardLayout()
     }
     if ( !lang.isEmpty() )
     {
-        std::string lang_s = lang.toStdString();
-        if ( specialCaseMap.contains( lang_s ) )
+        const auto& specialCases = specialCaseLayouts();
+        const auto it = specialCases.constFind( lang );
+        if ( it != specialCases.constEnd() )
         {
-            QString newLang = QString::fromStdString( specialCaseMap.value( lang_s ) );
+            const QString newLang = it.value();
             cDebug() << Logger::SubEntry << "special case language" << lang << "becomes" << newLang;
             lang = newLang;
         }
     }
     if ( !lang.isEmpty() )
     {
-        guessLayout( lang.split( '_', SplitSkipEmptyParts ), m_keyboardLayoutsModel, m_keyboardVariantsModel );
+        applyGuess( guessLayout( lang.split( '_', SplitSkipEmptyParts ) ) );
     }
 }
 
@@ -535,18 +716,13 @@ Config::finalize()
 void
 Config::updateVariants( const QPersistentModelIndex& currentItem, QString currentVariant )
 {
-    const auto variants = m_keyboardLayoutsModel->item( currentItem.row() ).second.variants;
-    m_keyboardVariantsModel->setVariants( variants );
+    const auto layout = m_keyboardLayoutsModel->item( currentItem.row() );
+    m_keyboardVariantsModel->setVariants( layout.first, layout.second.variants );
 
-    auto index = -1;
-    for ( const auto& key : variants.keys() )
+    const int row = m_keyboardVariantsModel->findKey( currentVariant );
+    if ( row >= 0 )
     {
-        index++;
-        if ( variants[ key ] == currentVariant )
-        {
-            m_keyboardVariantsModel->setCurrentIndex( index );
-            return;
-        }
+        m_keyboardVariantsModel->setCurrentIndex( row );
     }
 }
 
@@ -569,11 +745,22 @@ void
 Config::retranslate()
 {
     retranslateKeyboardModels();
+
+    // Only the order of the rows changes: the selection stays the same,
+    // so there is nothing to apply and it is not a choice by the user.
+    cBoolSetter< true > retranslating( m_retranslating );
+    m_keyboardModelsModel->retranslate();
+    m_keyboardLayoutsModel->retranslate();
+    m_keyboardVariantsModel->retranslate();
 }
 
 void
 Config::selectionChange()
 {
+    if ( m_retranslating )
+    {
+        return;
+    }
     if ( m_state == State::Initial )
     {
         m_state = State::UserSelected;
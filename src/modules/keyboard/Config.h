@@ -16,11 +16,14 @@
 #include "KeyboardLayoutModel.h"
 
 #include <QAbstractListModel>
+#include <QHash>
 #include <QMap>
 #include <QObject>
 #include <QTimer>
 #include <QUrl>
 
+class QProcess;
+
 class Config : public QObject
 {
     Q_OBJECT
@@ -65,8 +68,9 @@ public:
      * translations of strings in the xkb table, so need to be
      * notified of language changes as well.
      *
-     * Only widgets get LanguageChange events, so one of them will
-     * need to call this.
+     * Only widgets get LanguageChange events, so one of them (or the
+     * Retranslator) will need to call this. The models then show their
+     * rows in the order for the new language.
      */
     void retranslate();
 
@@ -90,6 +94,17 @@ private:
     void xkbChanged( int index );
     void xkbApply();
 
+    /** @brief Runs setxkbmap with @p args without blocking
+     *
+     * Only one setxkbmap process runs at a time. Requests that come in
+     * meanwhile are queued, and a queued request of the same kind
+     * (model or layout) is replaced by the newer one.
+     */
+    void runSetxkbmap( const QStringList& args );
+    void startSetxkbmap();
+    QProcess* m_setxkbmap = nullptr;
+    QList< QStringList > m_pendingXkbmap;
+
     KeyboardModelsModel* m_keyboardModelsModel;
     KeyboardLayoutModel* m_keyboardLayoutsModel;
     KeyboardVariantsModel* m_keyboardVariantsModel;
@@ -119,12 +134,42 @@ private:
         UserSelected  // explicit choice is made, preserve that
     };
     State m_state = State::Initial;
+    /// @brief Set while the models change order for a new language
+    bool m_retranslating = false;
 
     /** @brief Handles state change when selections in model, variant, layout
      *
      * This handles the Initial -> UserSelected transition in particular.
      */
     void selectionChange();
+
+    /** @brief A guessed layout and variant (xkb keys)
+     *
+     * These are keys rather than rows, since the rows depend on the
+     * language; an empty variant means there is no guess for it.
+     */
+    struct LayoutGuess
+    {
+        QString layout;
+        QString variant;
+    };
+
+    /** @brief Guess layout and variant from the parts of a language
+     *
+     * The parts are tried from last to first; the first one that
+     * names a layout picks the layout, and the one before that may
+     * pick a variant. Results are cached, since the models do not
+     * change once loaded.
+     */
+    LayoutGuess guessLayout( const QStringList& langParts ) const;
+    void applyGuess( const LayoutGuess& guess );
+    /// @brief The layout key that is (case-insensitively) @p layout, or empty
+    QString layoutKey( const QString& layout ) const;
+
+    mutable QHash< QString, QString > m_layoutKeys;
+    mutable QHash< QString, LayoutGuess > m_guessCache;
+    /// @brief The LANG that was last used for guessing
+    QString m_guessedLanguage;
 };
 
 
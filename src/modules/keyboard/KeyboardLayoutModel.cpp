@@ -14,9 +14,12 @@
 #include "utils/RAII.h"
 #include "utils/Retranslator.h"
 
+#include <QCollator>
+#include <QLocale>
 #include <QTranslator>
 
 #include <algorithm>
+#include <numeric>
 
 static QTranslator* s_kbtranslator = nullptr;
 
@@ -31,15 +34,231 @@ retranslateKeyboardModels()
 }
 
 
-XKBListModel::XKBListModel( QObject* parent )
+/** @brief The language that the labels are translated to, or empty
+ *
+ * Empty means untranslated: there are no (keyboard) translations
+ * loaded yet, or none for the current language.
+ */
+static QString
+currentLanguage()
+{
+    if ( s_kbtranslator && !s_kbtranslator->isEmpty() )
+    {
+        return CalamaresUtils::translatorLocaleName().name;
+    }
+    return QString();
+}
+
+static QString
+translated( const char* context, const QString& label )
+{
+    if ( s_kbtranslator && !s_kbtranslator->isEmpty() && context )
+    {
+        auto s = s_kbtranslator->translate( context, label.toUtf8().data() );
+        if ( !s.isEmpty() )
+        {
+            return s;
+        }
+    }
+    return label;
+}
+
+
+TranslatedListModel::TranslatedListModel( const char* context, QObject* parent )
     : QAbstractListModel( parent )
+    , m_context( context )
+{
+}
+
+int
+TranslatedListModel::rowCount( const QModelIndex& ) const
+{
+    return m_labels.count();
+}
+
+void
+TranslatedListModel::setCurrentIndex( int index )
+{
+    if ( index >= rowCount() || index < 0 )
+    {
+        return;
+    }
+    if ( m_currentIndex != index )
+    {
+        m_currentIndex = index;
+        emit currentIndexChanged( m_currentIndex );
+    }
+}
+
+const TranslatedListModel::Order&
+TranslatedListModel::order( const QString& language ) const
+{
+    const QString key = m_listKey + QChar( '\n' ) + language;
+    const auto it = m_orders.constFind( key );
+    if ( it != m_orders.constEnd() )
+    {
+        return it.value();
+    }
+
+    const int count = m_labels.count();
+    Order o;
+    o.labels.reserve( count );
+    for ( const auto& label : m_labels )
+    {
+        o.labels.append( translated( m_context, label ) );
+    }
+
+    QCollator collator( language.isEmpty() ? QLocale() : QLocale( language ) );
+    collator.setCaseSensitivity( Qt::CaseInsensitive );
+    o.items.resize( count );
+    std::iota( o.items.begin(), o.items.end(), 0 );
+    std::stable_sort( o.items.begin(), o.items.end(), [ & ]( int a, int b ) {
+        return collator.compare( o.labels.at( a ), o.labels.at( b ) ) < 0;
+    } );
+
+    o.rows.resize( count );
+    o.prefixes.reserve( count );
+    for ( int row = 0; row < count; ++row )
+    {
+        o.rows[ o.items.at( row ) ] = row;
+        o.prefixes.append( qMakePair( o.labels.at( o.items.at( row ) ).toCaseFolded(), row ) );
+    }
+    std::sort( o.prefixes.begin(), o.prefixes.end() );
+
+    return m_orders.insert( key, o ).value();
+}
+
+void
+TranslatedListModel::setLabels( const QString& listKey, const QStringList& labels )
 {
+    beginResetModel();
+    m_listKey = listKey;
+    m_labels = labels;
+    m_language = currentLanguage();
+    m_order = order( m_language );
+    m_currentIndex = -1;
+    endResetModel();
+}
+
+void
+TranslatedListModel::retranslate()
+{
+    const QString language = currentLanguage();
+    if ( language == m_language )
+    {
+        return;
+    }
+
+    emit layoutAboutToBeChanged( {}, QAbstractItemModel::VerticalSortHint );
+    const Order previous = m_order;
+    const int previousIndex = m_currentIndex;
+    m_language = language;
+    m_order = order( m_language );
+
+    const QModelIndexList from = persistentIndexList();
+    QModelIndexList to;
+    to.reserve( from.count() );
+    for ( const auto& i : from )
+    {
+        to.append( index( m_order.rows.at( previous.items.at( i.row() ) ) ) );
+    }
+    changePersistentIndexList( from, to );
+    // Views (e.g. a combo box) that follow the layout change find it current already
+    if ( previousIndex >= 0 )
+    {
+        m_currentIndex = m_order.rows.at( previous.items.at( previousIndex ) );
+    }
+    emit layoutChanged( {}, QAbstractItemModel::VerticalSortHint );
+    if ( rowCount() > 0 )
+    {
+        emit dataChanged( index( 0 ), index( rowCount() - 1 ), { Qt::DisplayRole } );
+    }
+    if ( m_currentIndex != previousIndex )
+    {
+        emit currentIndexChanged( m_currentIndex );
+    }
+}
+
+int
+TranslatedListModel::itemAt( int row ) const
+{
+    if ( row < 0 || row >= m_order.items.count() )
+    {
+        return -1;
+    }
+    return m_order.items.at( row );
 }
 
 int
-XKBListModel::rowCount( const QModelIndex& ) const
+TranslatedListModel::rowOf( int item ) const
+{
+    if ( item < 0 || item >= m_order.rows.count() )
+    {
+        return -1;
+    }
+    return m_order.rows.at( item );
+}
+
+QString
+TranslatedListModel::translatedLabel( int item ) const
+{
+    return m_order.labels.at( item );
+}
+
+/** @brief The first row at or after @p from that starts with @p prefix
+ *
+ * The matching labels are next to each other in @p prefixes, so this
+ * only looks at those. With @p wrap, a match before @p from is used
+ * if there is none after it.
+ */
+static int
+findPrefixFrom( const QVector< QPair< QString, int > >& prefixes, const QString& prefix, int from, bool wrap )
+{
+    const QString folded = prefix.toCaseFolded();
+    int after = -1;
+    int before = -1;
+    for ( auto it = std::lower_bound( prefixes.cbegin(), prefixes.cend(), qMakePair( folded, -1 ) );
+          it != prefixes.cend() && it->first.startsWith( folded );
+          ++it )
+    {
+        int& best = it->second >= from ? after : before;
+        if ( best < 0 || it->second < best )
+        {
+            best = it->second;
+        }
+    }
+    return ( after >= 0 || !wrap ) ? after : before;
+}
+
+int
+TranslatedListModel::findPrefix( const QString& prefix ) const
+{
+    return findPrefixFrom( m_order.prefixes, prefix, 0, false );
+}
+
+QModelIndexList
+TranslatedListModel::match( const QModelIndex& start,
+                            int role,
+                            const QVariant& value,
+                            int hits,
+                            Qt::MatchFlags flags ) const
+{
+    const int matchType = int( flags ) & 0x0F;
+    if ( role != Qt::DisplayRole || matchType != Qt::MatchStartsWith || hits != 1
+         || flags.testFlag( Qt::MatchCaseSensitive ) )
+    {
+        return QAbstractListModel::match( start, role, value, hits, flags );
+    }
+
+    const int row = findPrefixFrom(
+        m_order.prefixes, value.toString(), qMax( start.row(), 0 ), flags.testFlag( Qt::MatchWrap ) );
+    return row >= 0 ? QModelIndexList { index( row ) } : QModelIndexList();
+}
+
+
+XKBListModel::XKBListModel( const char* context, QObject* parent )
+    : TranslatedListModel( context, parent )
 {
-    return m_list.count();
 }
 
 QVariant
@@ -49,26 +268,18 @@ XKBListModel::data( const QModelIndex& index, int role ) const
     {
         return QVariant();
     }
-    if ( index.row() < 0 || index.row() >= m_list.count() )
+    const int item = itemAt( index.row() );
+    if ( item < 0 )
     {
         return QVariant();
     }
 
-    const auto item = m_list.at( index.row() );
     switch ( role )
     {
     case LabelRole:
-        if ( s_kbtranslator && !s_kbtranslator->isEmpty() && m_contextname )
-        {
-            auto s = s_kbtranslator->translate( m_contextname, item.label.toUtf8().data() );
-            if ( !s.isEmpty() )
-            {
-                return s;
-            }
-        }
-        return item.label;
+        return translatedLabel( item );
     case KeyRole:
-        return item.key;
+        return m_list.at( item ).key;
     default:
         return QVariant();
     }
@@ -78,21 +289,15 @@ XKBListModel::data( const QModelIndex& index, int role ) const
 QString
 XKBListModel::key( int index ) const
 {
-    if ( index < 0 || index >= m_list.count() )
-    {
-        return QString();
-    }
-    return m_list[ index ].key;
+    const int item = itemAt( index );
+    return item < 0 ? QString() : m_list.at( item ).key;
 }
 
 QString
 XKBListModel::label( int index ) const
 {
-    if ( index < 0 || index >= m_list.count() )
-    {
-        return QString();
-    }
-    return m_list[ index ].label;
+    const int item = itemAt( index );
+    return item < 0 ? QString() : m_list.at( item ).label;
 }
 
 QHash< int, QByteArray >
@@ -102,39 +307,38 @@ XKBListModel::roleNames() const
 }
 
 void
-XKBListModel::setCurrentIndex( int index )
+XKBListModel::setList( const QString& listKey, const QVector< ModelInfo >& list )
 {
-    if ( index >= m_list.count() || index < 0 )
-    {
-        return;
-    }
-    if ( m_currentIndex != index )
+    m_list = list;
+    QStringList labels;
+    labels.reserve( list.count() );
+    for ( const auto& info : list )
     {
-        m_currentIndex = index;
-        emit currentIndexChanged( m_currentIndex );
+        labels.append( info.label );
     }
+    setLabels( listKey, labels );
 }
 
 KeyboardModelsModel::KeyboardModelsModel( QObject* parent )
-    : XKBListModel( parent )
+    : XKBListModel( "kb_models", parent )
 {
-    m_contextname = "kb_models";
-
     // The models map is from human-readable names (!) to xkb identifier
     const auto models = KeyboardGlobal::getKeyboardModels();
-    m_list.reserve( models.count() );
+    QVector< ModelInfo > list;
+    list.reserve( models.count() );
     int index = 0;
     for ( const auto& key : models.keys() )
     {
         // So here *key* is the key in the map, which is the human-readable thing,
         //   while the struct fields are xkb-id, and human-readable
-        m_list << ModelInfo { models[ key ], key };
+        list << ModelInfo { models[ key ], key };
         if ( models[ key ] == "pc105" )
         {
             m_defaultPC105 = index;
         }
         index++;
     }
+    setList( QString(), list );
 
     cDebug() << "Loaded" << m_list.count() << "keyboard models";
     setCurrentIndex();  // If pc105 was seen, select it now
@@ -142,19 +346,11 @@ KeyboardModelsModel::KeyboardModelsModel( QObject* parent )
 
 
 KeyboardLayoutModel::KeyboardLayoutModel( QObject* parent )
-    : QAbstractListModel( parent )
+    : TranslatedListModel( "kb_layouts", parent )
 {
     init();
 }
 
-int
-KeyboardLayoutModel::rowCount( const QModelIndex& parent ) const
-{
-    Q_UNUSED( parent )
-    return m_layouts.count();
-}
-
-
 QVariant
 KeyboardLayoutModel::data( const QModelIndex& index, int role ) const
 {
@@ -162,26 +358,20 @@ KeyboardLayoutModel::data( const QModelIndex& index, int role ) const
     {
         return QVariant();
     }
+    const int item = itemAt( index.row() );
+    if ( item < 0 )
+    {
+        return QVariant();
+    }
 
     switch ( role )
     {
     case Qt::DisplayRole:
-    {
-        auto description = m_layouts.at( index.row() ).second.description;
-        if ( s_kbtranslator && !s_kbtranslator->isEmpty() )
-        {
-            auto s = s_kbtranslator->translate( "kb_layouts", description.toUtf8().data() );
-            if ( !s.isEmpty() )
-            {
-                return s;
-            }
-        }
-        return description;
-    }
+        return translatedLabel( item );
     case KeyboardVariantsRole:
-        return QVariant::fromValue( m_layouts.at( index.row() ).second.variants );
+        return QVariant::fromValue( m_layouts.at( item ).second.variants );
     case KeyboardLayoutKeyRole:
-        return m_layouts.at( index.row() ).first;
+        return m_layouts.at( item ).first;
     }
 
     return QVariant();
@@ -190,39 +380,49 @@ KeyboardLayoutModel::data( const QModelIndex& index, int role ) const
 const QPair< QString, KeyboardGlobal::KeyboardInfo >
 KeyboardLayoutModel::item( const int& index ) const
 {
-    if ( index >= m_layouts.count() || index < 0 )
+    const int item = itemAt( index );
+    if ( item < 0 )
     {
         return QPair< QString, KeyboardGlobal::KeyboardInfo >();
     }
-
-    return m_layouts.at( index );
+    return m_layouts.at( item );
 }
 
 QString
 KeyboardLayoutModel::key( int index ) const
 {
-    if ( index >= m_layouts.count() || index < 0 )
+    const int item = itemAt( index );
+    return item < 0 ? QString() : m_layouts.at( item ).first;
+}
+
+int
+KeyboardLayoutModel::findKey( const QString& key ) const
+{
+    using Layout = QPair< QString, KeyboardGlobal::KeyboardInfo >;
+    auto byKey = []( const Layout& layout, const QString& k ) { return layout.first < k; };
+    const auto it = std::lower_bound( m_layouts.cbegin(), m_layouts.cend(), key, byKey );
+    if ( it == m_layouts.cend() || it->first != key )
     {
-        return QString();
+        return -1;
     }
-    return m_layouts.at( index ).first;
+    return rowOf( int( it - m_layouts.cbegin() ) );
 }
 
 void
 KeyboardLayoutModel::init()
 {
-    KeyboardGlobal::LayoutsMap layouts = KeyboardGlobal::getKeyboardLayouts();
+    // The map is sorted by key, which findKey() relies on; the
+    // order that is shown comes from the (translated) descriptions.
+    const KeyboardGlobal::LayoutsMap layouts = KeyboardGlobal::getKeyboardLayouts();
+    m_layouts.reserve( layouts.count() );
+    QStringList descriptions;
+    descriptions.reserve( layouts.count() );
     for ( KeyboardGlobal::LayoutsMap::const_iterator it = layouts.constBegin(); it != layouts.constEnd(); ++it )
     {
         m_layouts.append( qMakePair( it.key(), it.value() ) );
+        descriptions.append( it.value().description );
     }
-
-    std::stable_sort( m_layouts.begin(),
-                      m_layouts.end(),
-                      []( const QPair< QString, KeyboardGlobal::KeyboardInfo >& a,
-                          const QPair< QString, KeyboardGlobal::KeyboardInfo >& b ) {
-                          return a.second.description < b.second.description;
-                      } );
+    setLabels( QString(), descriptions );
 }
 
 QHash< int, QByteArray >
@@ -231,44 +431,38 @@ KeyboardLayoutModel::roleNames() const
     return { { Qt::DisplayRole, "label" }, { KeyboardLayoutKeyRole, "key" }, { KeyboardVariantsRole, "variants" } };
 }
 
-void
-KeyboardLayoutModel::setCurrentIndex( int index )
-{
-    if ( index >= m_layouts.count() || index < 0 )
-    {
-        return;
-    }
-
-    if ( m_currentIndex != index )
-    {
-        m_currentIndex = index;
-        emit currentIndexChanged( m_currentIndex );
-    }
-}
 
-int
-KeyboardLayoutModel::currentIndex() const
+KeyboardVariantsModel::KeyboardVariantsModel( QObject* parent )
+    : XKBListModel( "kb_variants", parent )
 {
-    return m_currentIndex;
 }
 
-
-KeyboardVariantsModel::KeyboardVariantsModel( QObject* parent )
-    : XKBListModel( parent )
+void
+KeyboardVariantsModel::setVariants( const QString& layout, const QMap< QString, QString >& variants )
 {
-    m_contextname = "kb_variants";
+    auto it = m_variants.constFind( layout );
+    if ( it == m_variants.constEnd() )
+    {
+        QVector< ModelInfo > list;
+        list.reserve( variants.count() );
+        for ( auto v = variants.cbegin(); v != variants.cend(); ++v )
+        {
+            list << ModelInfo { v.value(), v.key() };
+        }
+        it = m_variants.insert( layout, list );
+    }
+    setList( layout, it.value() );
 }
 
-void
-KeyboardVariantsModel::setVariants( QMap< QString, QString > variants )
+int
+KeyboardVariantsModel::findKey( const QString& key ) const
 {
-    beginResetModel();
-    m_list.clear();
-    m_list.reserve( variants.count() );
-    for ( const auto& key : variants.keys() )
+    for ( int item = 0; item < m_list.count(); ++item )
     {
-        m_list << ModelInfo { variants[ key ], key };
+        if ( m_list.at( item ).key == key )
+        {
+            return rowOf( item );
+        }
     }
-    m_currentIndex = -1;
-    endResetModel();
+    return -1;
 }
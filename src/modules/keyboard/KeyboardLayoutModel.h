@@ -13,18 +13,115 @@
 #include "keyboardwidget/keyboardglobal.h"
 
 #include <QAbstractListModel>
+#include <QHash>
 #include <QMap>
 #include <QMetaType>
 #include <QObject>
+#include <QStringList>
+#include <QVector>
+
+/** @brief A list model whose rows are shown sorted by translated label
+ *
+ * The items are stored once, in a fixed order; what changes with the
+ * language is only the order in which they are shown. That order (a
+ * permutation of the items) is computed once per language and kept,
+ * so switching back and forth between languages does not sort again.
+ * Rows are positions in the current order, items are positions in the
+ * stored data.
+ *
+ * Each order also has an index of case-folded labels, for type-ahead
+ * searches through findPrefix() (and match(), which the views use).
+ *
+ * This model acts like it has a single selection, as well;
+ * the selected item stays selected when the order changes.
+ */
+class TranslatedListModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY( int currentIndex WRITE setCurrentIndex READ currentIndex NOTIFY currentIndexChanged )
+
+public:
+    /// @brief Create a model whose labels are translated in @p context
+    explicit TranslatedListModel( const char* context, QObject* parent = nullptr );
+
+    int rowCount( const QModelIndex& = QModelIndex() ) const override;
+
+    void setCurrentIndex( int index );
+    int currentIndex() const { return m_currentIndex; }
+
+    /** @brief The first row whose translated label starts with @p prefix
+     *
+     * The comparison is case-insensitive. Returns -1 if there is none.
+     * This is a binary search, not a scan over the labels.
+     */
+    Q_INVOKABLE int findPrefix( const QString& prefix ) const;
+
+    /** @brief Type-ahead searches use findPrefix()
+     *
+     * Searches for the start of the label (which is what the views
+     * do for keyboard search) use the index; others fall back to
+     * the default implementation.
+     */
+    QModelIndexList match( const QModelIndex& start,
+                           int role,
+                           const QVariant& value,
+                           int hits = 1,
+                           Qt::MatchFlags flags
+                           = Qt::MatchFlags( Qt::MatchStartsWith | Qt::MatchWrap ) ) const override;
+
+    /** @brief Show the rows in the order for the current language
+     *
+     * Call this after the translations have changed. Persistent
+     * indexes and the current index follow their items.
+     */
+    void retranslate();
+
+signals:
+    void currentIndexChanged( int index );
+
+protected:
+    /** @brief Sets the (untranslated) labels of the items
+     *
+     * This resets the model and clears the current index. The orders
+     * are kept per @p listKey and language, so a list that was shown
+     * before (e.g. the variants of a layout) is not sorted again.
+     */
+    void setLabels( const QString& listKey, const QStringList& labels );
+
+    /// @brief The item shown at @p row, or -1 if @p row is invalid
+    int itemAt( int row ) const;
+    /// @brief The row where @p item is shown, or -1 if @p item is invalid
+    int rowOf( int item ) const;
+    /// @brief The translated label of @p item (which must be valid)
+    QString translatedLabel( int item ) const;
+
+private:
+    struct Order
+    {
+        QStringList labels;  ///< Translated labels, by item
+        QVector< int > items;  ///< Item for each row
+        QVector< int > rows;  ///< Row for each item
+        QVector< QPair< QString, int > > prefixes;  ///< Case-folded label and row, sorted
+    };
+    const Order& order( const QString& language ) const;
+
+    const char* m_context;
+    QString m_listKey;
+    QStringList m_labels;  ///< Untranslated labels, by item
+    QString m_language;  ///< Language of the current order
+    Order m_order;  ///< For the current language
+    mutable QHash< QString, Order > m_orders;  ///< By list key and language
+
+    int m_currentIndex = -1;
+};
 
 /** @brief A list model with an xkb key and a human-readable string
  *
  * This model acts like it has a single selection, as well.
  */
-class XKBListModel : public QAbstractListModel
+class XKBListModel : public TranslatedListModel
 {
     Q_OBJECT
-    Q_PROPERTY( int currentIndex WRITE setCurrentIndex READ currentIndex NOTIFY currentIndexChanged )
 
 public:
     enum
@@ -33,9 +130,8 @@ public:
         KeyRole = Qt::UserRole  ///< xkb identifier
     };
 
-    explicit XKBListModel( QObject* parent = nullptr );
+    explicit XKBListModel( const char* context, QObject* parent = nullptr );
 
-    int rowCount( const QModelIndex& = QModelIndex() ) const override;
     QVariant data( const QModelIndex& index, int role ) const override;
     /** @brief xkb key for a given index (row)
      *
@@ -46,19 +142,13 @@ public:
 
     /** @brief human-readable label for a given index (row)
      *
-     * This is like calling data( QModelIndex( index ), LabelRole ).toString(),
-     * but shorter and faster. Can return an empty string if index is invalid.
+     * This is the untranslated label; data( QModelIndex( index ), LabelRole )
+     * is the translated one. Can return an empty string if index is invalid.
      */
     QString label( int index ) const;
 
     QHash< int, QByteArray > roleNames() const override;
 
-    void setCurrentIndex( int index );
-    int currentIndex() const { return m_currentIndex; }
-
-signals:
-    void currentIndexChanged( int index );
-
 protected:
     struct ModelInfo
     {
@@ -67,9 +157,10 @@ protected:
         /// Human-readable
         QString label;
     };
+    /// @brief Sets the items (keeping their order as items), see TranslatedListModel::setLabels()
+    void setList( const QString& listKey, const QVector< ModelInfo >& list );
+
     QVector< ModelInfo > m_list;
-    int m_currentIndex = -1;
-    const char* m_contextname = nullptr;
 };
 
 
@@ -85,10 +176,10 @@ public:
     explicit KeyboardModelsModel( QObject* parent = nullptr );
 
     /// @brief Set the index back to PC105 (the default physical model)
-    void setCurrentIndex() { XKBListModel::setCurrentIndex( m_defaultPC105 ); }
+    void setCurrentIndex() { XKBListModel::setCurrentIndex( rowOf( m_defaultPC105 ) ); }
 
 private:
-    int m_defaultPC105 = -1;  ///< The index of pc105, if there is one
+    int m_defaultPC105 = -1;  ///< The item of pc105, if there is one
 };
 
 /** @brief A list of keyboard layouts (arrangements of keycaps)
@@ -96,10 +187,9 @@ private:
  * Layouts can have a list of associated Variants, so this
  * is slightly more complicated than the "regular" XKBListModel.
  */
-class KeyboardLayoutModel : public QAbstractListModel
+class KeyboardLayoutModel : public TranslatedListModel
 {
     Q_OBJECT
-    Q_PROPERTY( int currentIndex WRITE setCurrentIndex READ currentIndex NOTIFY currentIndexChanged )
 
 public:
     enum Roles : int
@@ -110,12 +200,8 @@ public:
 
     KeyboardLayoutModel( QObject* parent = nullptr );
 
-    int rowCount( const QModelIndex& parent = QModelIndex() ) const override;
-
     QVariant data( const QModelIndex& index, int role ) const override;
 
-    void setCurrentIndex( int index );
-    int currentIndex() const;
     const QPair< QString, KeyboardGlobal::KeyboardInfo > item( const int& index ) const;
 
     /** @brief xkb key for a given index (row)
@@ -125,23 +211,24 @@ public:
      */
     QString key( int index ) const;
 
+    /// @brief The row of the layout with xkb key @p key, or -1
+    int findKey( const QString& key ) const;
+
 protected:
     QHash< int, QByteArray > roleNames() const override;
 
 private:
     void init();
-    int m_currentIndex = -1;
-    QList< QPair< QString, KeyboardGlobal::KeyboardInfo > > m_layouts;
-
-signals:
-    void currentIndexChanged( int index );
+    /// @brief Sorted by xkb key; this does not change once loaded
+    QVector< QPair< QString, KeyboardGlobal::KeyboardInfo > > m_layouts;
 };
 
 /** @brief A list of variants (xkb id and human-readable)
  *
  * The variants that are available depend on the Layout that is used,
  * so the `setVariants()` function can be used to update the variants
- * when the two models are related.
+ * when the two models are related. The variants of each layout are
+ * kept, so going back to a layout swaps its list in again.
  */
 class KeyboardVariantsModel : public XKBListModel
 {
@@ -150,7 +237,19 @@ class KeyboardVariantsModel : public XKBListModel
 public:
     explicit KeyboardVariantsModel( QObject* parent = nullptr );
 
-    void setVariants( QMap< QString, QString > variants );
+    /** @brief Show the variants of layout @p layout
+     *
+     * The map @p variants is from human-readable name to xkb identifier,
+     * as in KeyboardGlobal::KeyboardInfo. It is only read the first time
+     * a layout is shown. The current index is cleared.
+     */
+    void setVariants( const QString& layout, const QMap< QString, QString >& variants );
+
+    /// @brief The row of the variant with xkb key @p key, or -1
+    int findKey( const QString& key ) const;
+
+private:
+    QHash< QString, QVector< ModelInfo > > m_variants;  ///< By layout
 };
 
 /** @brief Adjust to changes in application language.
@@ -26,8 +26,10 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
 #include <QSettings>
 #include <QTextStream>
+#include <QVector>
 
 
 SetKeyboardLayoutJob::SetKeyboardLayoutJob( const QString& model,
@@ -81,88 +83,111 @@ SetKeyboardLayoutJob::findConvertedKeymap( const QString& convertedKeymapPath )
 }
 
 
-STATICTEST QString
-findLegacyKeymap( const QString& layout, const QString& model, const QString& variant )
+namespace
 {
-    cDebug() << "Looking for legacy keymap" << layout << model << variant << "in QRC";
-
-    int bestMatching = 0;
-    QString name;
+/// @brief One line of kbd-model-map
+struct LegacyKeymap
+{
+    QString keymap;
+    QString layouts;  // X11 layouts, comma-separated
+    QString model;
+    QString variant;  // empty for "-"
+};
 
-    QFile file( ":/kbd-model-map" );
-    if ( !file.open( QIODevice::ReadOnly | QIODevice::Text ) )
-    {
-        cDebug() << Logger::SubEntry << "Could not read QRC";
-        return QString();
-    }
+/** @brief The kbd-model-map table, read (once) from QRC
+ *
+ * Entries are grouped by their first X11 layout, which is the only
+ * thing findLegacyKeymap() can match on; within a group they are in
+ * the order of the file, which matters for ties.
+ */
+const QHash< QString, QVector< LegacyKeymap > >&
+legacyKeymaps()
+{
+    static const QHash< QString, QVector< LegacyKeymap > > table = []() {
+        QHash< QString, QVector< LegacyKeymap > > t;
 
-    QTextStream stream( &file );
-    while ( !stream.atEnd() )
-    {
-        QString line = stream.readLine().trimmed();
-        if ( line.isEmpty() || line.startsWith( '#' ) )
+        QFile file( ":/kbd-model-map" );
+        if ( !file.open( QIODevice::ReadOnly | QIODevice::Text ) )
         {
-            continue;
+            cDebug() << Logger::SubEntry << "Could not read QRC";
+            return t;
         }
 
-        QStringList mapping = line.split( '\t', SplitSkipEmptyParts );
-        if ( mapping.size() < 5 )
+        QTextStream stream( &file );
+        while ( !stream.atEnd() )
         {
-            continue;
+            QString line = stream.readLine().trimmed();
+            if ( line.isEmpty() || line.startsWith( '#' ) )
+            {
+                continue;
+            }
+
+            QStringList mapping = line.split( '\t', SplitSkipEmptyParts );
+            if ( mapping.size() < 5 )
+            {
+                continue;
+            }
+
+            QString mappingVariant = mapping[ 3 ];
+            if ( mappingVariant == "-" )
+            {
+                mappingVariant = QString();
+            }
+
+            // We ignore mapping[4], the xkb options, for now. If we ever
+            // allow setting options in the UI, we should match them here.
+            const QString firstLayout = mapping[ 1 ].section( ',', 0, 0 );
+            t[ firstLayout ].append( LegacyKeymap { mapping[ 0 ], mapping[ 1 ], mapping[ 2 ], mappingVariant } );
         }
+        return t;
+    }();
+    return table;
+}
+}  // namespace
+
+STATICTEST QString
+findLegacyKeymap( const QString& layout, const QString& model, const QString& variant )
+{
+    cDebug() << "Looking for legacy keymap" << layout << model << variant << "in QRC";
+
+    int bestMatching = 0;
+    QString name;
 
+    for ( const auto& mapping : legacyKeymaps().value( layout ) )
+    {
         int matching = 0;
 
         // Determine how well matching this entry is
         // We assume here that we have one X11 layout. If the UI changes to
         // allow more than one layout, this should change too.
-        if ( layout == mapping[ 1 ] )
+        if ( layout == mapping.layouts )
         // If we got an exact match, this is best
         {
             matching = 10;
         }
-        // Look for an entry whose first layout matches ours
-        else if ( mapping[ 1 ].startsWith( layout + ',' ) )
+        // Otherwise the entry's first layout matches ours (that is how
+        // they are grouped)
+        else
         {
             matching = 5;
         }
 
-        if ( matching > 0 )
+        if ( model.isEmpty() || model == mapping.model )
         {
-            if ( model.isEmpty() || model == mapping[ 2 ] )
-            {
-                matching++;
-            }
-
-            QString mappingVariant = mapping[ 3 ];
-            if ( mappingVariant == "-" )
-            {
-                mappingVariant = QString();
-            }
-            else if ( mappingVariant.startsWith( ',' ) )
-            {
-                mappingVariant.remove( 1, 0 );
-            }
-
-            if ( variant == mappingVariant )
-            {
-                matching++;
-            }
+            matching++;
+        }
 
-            // We ignore mapping[4], the xkb options, for now. If we ever
-            // allow setting options in the UI, we should match them here.
+        if ( variant == mapping.variant )
+        {
+            matching++;
         }
 
         // The best matching entry so far, then let's save that
-        if ( matching >= qMax( bestMatching, 1 ) )
+        if ( matching > bestMatching )
         {
-            cDebug() << Logger::SubEntry << "Found legacy keymap" << mapping[ 0 ] << "with score" << matching;
-
-            if ( matching > bestMatching )
-            {
-                bestMatching = matching;
-                name = mapping[ 0 ];
-            }
+            cDebug() << Logger::SubEntry << "Found legacy keymap" << mapping.keymap << "with score" << matching;
+            bestMatching = matching;
+            name = mapping.keymap;
         }
     }
 
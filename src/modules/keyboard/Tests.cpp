@@ -6,6 +6,8 @@
  *   Calamares is Free Software: see the License-Identifier above.
  *
  */
+#include "KeyboardLayoutModel.h"
+
 #include "utils/Logger.h"
 
 #include <QtTest/QtTest>
@@ -25,6 +27,8 @@ private Q_SLOTS:
 
     void testSimpleLayoutLookup_data();
     void testSimpleLayoutLookup();
+
+    void testVariantsOrder();
 };
 
 void
@@ -45,6 +49,10 @@ KeyboardLayoutTests::testSimpleLayoutLookup_data()
     QTest::newRow( "turkish default" ) << QString( "tr" ) << QString() << QString() << QString( "trq" );
     QTest::newRow( "turkish alt-q" ) << QString( "tr" ) << QString() << QString( "alt" ) << QString( "trq" );
     QTest::newRow( "turkish f" ) << QString( "tr" ) << QString() << QString( "f" ) << QString( "trf" );
+    QTest::newRow( "ukrainian" ) << QString( "ua" ) << QString() << QString() << QString( "ua-utf" );
+    QTest::newRow( "swiss french" ) << QString( "ch" ) << QString() << QString( "fr" ) << QString( "fr_CH" );
+    QTest::newRow( "croatian pc105" ) << QString( "hr" ) << QString( "pc105" ) << QString() << QString( "croat" );
+    QTest::newRow( "unknown" ) << QString( "zz" ) << QString() << QString() << QString();
 }
 
 
@@ -59,6 +67,46 @@ KeyboardLayoutTests::testSimpleLayoutLookup()
     QCOMPARE( findLegacyKeymap( layout, model, variant ), vconsole );
 }
 
+void
+KeyboardLayoutTests::testVariantsOrder()
+{
+    KeyboardVariantsModel m;
+    QCOMPARE( m.rowCount(), 0 );
+    QCOMPARE( m.findPrefix( QString() ), -1 );
+
+    // Human-readable name to xkb key; shown sorted by name, regardless of case
+    m.setVariants( QStringLiteral( "us" ),
+                   { { QStringLiteral( "Default" ), QString() },
+                     { QStringLiteral( "Dvorak" ), QStringLiteral( "dvorak" ) },
+                     { QStringLiteral( "alt-intl" ), QStringLiteral( "alt-intl" ) } } );
+    QCOMPARE( m.rowCount(), 3 );
+    QCOMPARE( m.currentIndex(), -1 );
+    QCOMPARE( m.key( 0 ), QStringLiteral( "alt-intl" ) );
+    QCOMPARE( m.key( 1 ), QString() );
+    QCOMPARE( m.key( 2 ), QStringLiteral( "dvorak" ) );
+    QCOMPARE( m.findKey( QStringLiteral( "dvorak" ) ), 2 );
+    QCOMPARE( m.findKey( QStringLiteral( "colemak" ) ), -1 );
+
+    // Type-ahead
+    QCOMPARE( m.findPrefix( QStringLiteral( "d" ) ), 1 );
+    QCOMPARE( m.findPrefix( QStringLiteral( "DV" ) ), 2 );
+    QCOMPARE( m.findPrefix( QStringLiteral( "Alt" ) ), 0 );
+    QCOMPARE( m.findPrefix( QStringLiteral( "x" ) ), -1 );
+    QCOMPARE( m.match( m.index( 2 ), Qt::DisplayRole, QStringLiteral( "d" ) ), QModelIndexList { m.index( 2 ) } );
+    QCOMPARE( m.match( m.index( 2 ), Qt::DisplayRole, QStringLiteral( "a" ) ), QModelIndexList { m.index( 0 ) } );
+    QCOMPARE( m.match( m.index( 2 ), Qt::DisplayRole, QStringLiteral( "a" ), 1, Qt::MatchStartsWith ),
+              QModelIndexList() );
+
+    // Another layout, and back: the same list again, with no selection
+    m.setCurrentIndex( 2 );
+    m.setVariants( QStringLiteral( "fr" ), { { QStringLiteral( "Default" ), QString() } } );
+    QCOMPARE( m.rowCount(), 1 );
+    m.setVariants( QStringLiteral( "us" ), {} );  // Not read a second time
+    QCOMPARE( m.rowCount(), 3 );
+    QCOMPARE( m.currentIndex(), -1 );
+    QCOMPARE( m.key( 2 ), QStringLiteral( "dvorak" ) );
+}
+
 
 QTEST_GUILESS_MAIN( KeyboardLayoutTests )
 
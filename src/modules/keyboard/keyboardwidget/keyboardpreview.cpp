@@ -18,6 +18,11 @@
 #include "utils/Logger.h"
 #include "utils/String.h"
 
+#include <QHash>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <atomic>
+
 KeyBoardPreview::KeyBoardPreview( QWidget* parent )
     : QWidget( parent )
     , layout( "us" )
@@ -65,6 +70,14 @@ KeyBoardPreview::KeyBoardPreview( QWidget* parent )
                                                  << 0x35 << 0x36 );
 
     kb = &kbList[ KB_104 ];
+
+    connect( &m_codesWatcher, &QFutureWatcher< Codes >::finished, this, &KeyBoardPreview::codesLoaded );
+}
+
+KeyBoardPreview::~KeyBoardPreview()
+{
+    // Don't leave ckbcomp running for a widget that is gone
+    m_codesWatcher.waitForFinished();
 }
 
 
@@ -79,14 +92,7 @@ void
 KeyBoardPreview::setVariant( QString _variant )
 {
     variant = _variant;
-
-    if ( !loadCodes() )
-    {
-        return;
-    }
-
-    loadInfo();
-    repaint();
+    loadCodes();
 }
 
 
@@ -116,18 +122,98 @@ KeyBoardPreview::loadInfo()
 }
 
 
-bool
+static QString
+codesKey( const QString& layout, const QString& variant )
+{
+    return layout + '\t' + variant;
+}
+
+QHash< QString, KeyBoardPreview::Codes >&
+KeyBoardPreview::codesCache()
+{
+    // Successful ckbcomp runs for the session; a failure may be temporary
+    static QHash< QString, Codes > cache;
+    return cache;
+}
+
+void
 KeyBoardPreview::loadCodes()
 {
     if ( layout.isEmpty() )
     {
-        return false;
+        return;
     }
 
-    QStringList param { "-model", "pc106", "-layout", layout, "-compact" };
-    if ( !variant.isEmpty() )
+    const auto it = codesCache().constFind( codesKey( layout, variant ) );
+    if ( it != codesCache().constEnd() )
     {
-        param << "-variant" << variant;
+        applyCodes( it.value() );
+        return;
+    }
+
+    if ( m_codesWatcher.isRunning() )
+    {
+        // Picked up when the running one is done; anything requested
+        // in between is simply skipped.
+        m_hasPending = true;
+        return;
+    }
+    startCodes( layout, variant );
+}
+
+void
+KeyBoardPreview::startCodes( const QString& forLayout, const QString& forVariant )
+{
+    m_codesWatcher.setFuture( QtConcurrent::run( &KeyBoardPreview::runCkbcomp, forLayout, forVariant ) );
+}
+
+void
+KeyBoardPreview::codesLoaded()
+{
+    const Codes c = m_codesWatcher.result();
+    if ( c.ok )
+    {
+        codesCache().insert( codesKey( c.layout, c.variant ), c );
+    }
+
+    if ( c.layout == layout && c.variant == variant )
+    {
+        m_hasPending = false;
+        applyCodes( c );
+    }
+    else if ( m_hasPending )
+    {
+        m_hasPending = false;
+        loadCodes();
+    }
+}
+
+void
+KeyBoardPreview::applyCodes( const Codes& c )
+{
+    if ( !c.ok )
+    {
+        // Keep showing whatever was there before
+        return;
+    }
+
+    codes = c.codes;
+    loadInfo();
+    m_renderedValid = false;
+    update();
+}
+
+KeyBoardPreview::Codes
+KeyBoardPreview::runCkbcomp( const QString& forLayout, const QString& forVariant )
+{
+    Codes result;
+    result.layout = forLayout;
+    result.variant = forVariant;
+
+    QStringList param { "-model", "pc106", "-layout", forLayout, "-compact" };
+    if ( !forVariant.isEmpty() )
+    {
+        param << "-variant" << forVariant;
     }
 
 
@@ -137,24 +223,20 @@ KeyBoardPreview::loadCodes()
     process.start( "ckbcomp", param );
     if ( !process.waitForStarted() )
     {
-        static bool need_warning = true;
-        if ( need_warning )
+        static std::atomic< bool > need_warning { true };
+        if ( need_warning.exchange( false ) )
         {
             cWarning() << "ckbcomp not found , keyboard preview disabled";
-            need_warning = false;
         }
-        return false;
+        return result;
     }
 
-    if ( !process.waitForFinished() )
+    if ( !process.waitForFinished() || process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0 )
     {
-        cWarning() << "ckbcomp failed, keyboard preview skipped for" << layout << variant;
-        return false;
+        cWarning() << "ckbcomp failed, keyboard preview skipped for" << forLayout << forVariant;
+        return result;
     }
 
-    // Clear codes
-    codes.clear();
-
     const QStringList list = QString( process.readAll() ).split( "\n", SplitSkipEmptyParts );
 
     for ( const QString& line : list )
@@ -186,10 +268,11 @@ KeyBoardPreview::loadCodes()
             code.alt = "";
         }
 
-        codes.append( code );
+        result.codes.append( code );
     }
 
-    return true;
+    result.ok = true;
+    return result;
 }
 
 
@@ -265,13 +348,34 @@ KeyBoardPreview::resizeEvent( QResizeEvent* )
     key_w = ( usable_width - 14 * space ) / 15;
 
     setMaximumHeight( key_w * 4 + space * 5 + 1 );
+    m_renderedValid = false;
 }
 
 
 void
 KeyBoardPreview::paintEvent( QPaintEvent* event )
 {
+    const qreal ratio = devicePixelRatioF();
+    if ( !m_renderedValid || m_rendered.size() != size() * ratio )
+    {
+        m_rendered = QPixmap( size() * ratio );
+        m_rendered.setDevicePixelRatio( ratio );
+        m_rendered.fill( Qt::transparent );
+        QPainter rp( &m_rendered );
+        drawKeyboard( rp );
+        m_renderedValid = true;
+    }
+
     QPainter p( this );
+    p.drawPixmap( 0, 0, m_rendered );
+
+    QWidget::paintEvent( event );
+}
+
+
+void
+KeyBoardPreview::drawKeyboard( QPainter& p )
+{
     p.setRenderHint( QPainter::Antialiasing );
 
     p.setBrush( QColor( 0xd6, 0xd6, 0xd6 ) );
@@ -395,7 +499,4 @@ KeyBoardPreview::paintEvent( QPaintEvent* event )
         y = 6 + key_w * 2 + space * 2;
         p.drawRoundedRect( QRectF( x, y, remaining_widths[ 2 ], key_w ), rx, rx );
     }
-
-
-    QWidget::paintEvent( event );
 }
@@ -17,6 +17,8 @@
 
 #include <QColor>
 #include <QFont>
+#include <QFutureWatcher>
+#include <QHash>
 #include <QPainter>
 #include <QPainterPath>
 #include <QPen>
@@ -28,11 +30,21 @@
 #include <QWidget>
 
 
+/** @brief Shows the key labels of a keyboard layout
+ *
+ * The key labels come from ckbcomp, which runs in a worker thread.
+ * Successful results are cached per layout and variant for the session,
+ * and while one ckbcomp runs only the most recent request is kept
+ * waiting; intermediate ones (e.g. scrolling through the layout list)
+ * are dropped. The drawn keyboard is cached as a pixmap until the size
+ * or the key labels change.
+ */
 class KeyBoardPreview : public QWidget
 {
     Q_OBJECT
 public:
     explicit KeyBoardPreview( QWidget* parent = nullptr );
+    ~KeyBoardPreview() override;
 
     void setLayout( QString layout );
     void setVariant( QString variant );
@@ -56,19 +68,41 @@ private:
         QString plain, shift, ctrl, alt;
     };
 
+    /// @brief Result of running ckbcomp for one layout and variant
+    struct Codes
+    {
+        QString layout, variant;
+        bool ok = false;
+        QList< Code > codes;
+    };
+
     QString layout, variant;
     QFont lowerFont, upperFont;
     KB *kb, kbList[ 3 ];
     QList< Code > codes;
     int space, usable_width, key_w;
 
+    QFutureWatcher< Codes > m_codesWatcher;
+    bool m_hasPending = false;  ///< Something else was requested while ckbcomp runs
+
+    QPixmap m_rendered;  ///< The keyboard as last drawn
+    bool m_renderedValid = false;
+
     void loadInfo();
-    bool loadCodes();
+    /// @brief Looks up codes for layout and variant, or starts ckbcomp
+    void loadCodes();
+    void startCodes( const QString& forLayout, const QString& forVariant );
+    void codesLoaded();
+    void applyCodes( const Codes& c );
+    static Codes runCkbcomp( const QString& forLayout, const QString& forVariant );
+    static QHash< QString, Codes >& codesCache();
+    /// @brief Draws the whole keyboard with @p p (into m_rendered)
+    void drawKeyboard( QPainter& p );
     QString regular_text( int index );
     QString shift_text( int index );
     QString ctrl_text( int index );
     QString alt_text( int index );
-    QString fromUnicodeString( QString raw );
+    static QString fromUnicodeString( QString raw );
 
 protected:
     void paintEvent( QPaintEvent* event ) override;
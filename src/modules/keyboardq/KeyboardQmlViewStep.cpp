@@ -15,6 +15,7 @@
 
 #include "GlobalStorage.h"
 #include "JobQueue.h"
+#include "utils/Retranslator.h"
 
 CALAMARES_PLUGIN_FACTORY_DEFINITION( KeyboardQmlViewStepFactory, registerPlugin< KeyboardQmlViewStep >(); )
 
@@ -23,6 +24,8 @@ KeyboardQmlViewStep::KeyboardQmlViewStep( QObject* parent )
     , m_config( new Config( this ) )
 {
     m_config->detectCurrentKeyboardLayout();
+    // There are no widgets to get the LanguageChange event, see Config::retranslate()
+    CALAMARES_RETRANSLATE( m_config->retranslate(); );
     emit nextStatusChanged( true );
 }
 
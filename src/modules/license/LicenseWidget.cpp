@@ -17,10 +17,13 @@
 
 #include <QDesktopServices>
 #include <QFile>
+#include <QFutureWatcher>
 #include <QHBoxLayout>
+#include <QHash>
 #include <QLabel>
 #include <QPushButton>
 #include <QVBoxLayout>
+#include <QtConcurrent/QtConcurrentRun>
 
 static QString
 loadLocalFile( const QUrl& u )
@@ -40,6 +43,14 @@ loadLocalFile( const QUrl& u )
     return QString( "\n" ) + file.readAll();
 }
 
+/// @brief License texts that have been loaded already, by URL
+static QHash< QUrl, QString >&
+licenseTexts()
+{
+    static QHash< QUrl, QString > texts;
+    return texts;
+}
+
 LicenseWidget::LicenseWidget( LicenseEntry entry, QWidget* parent )
     : QWidget( parent )
     , m_entry( std::move( entry ) )
@@ -79,7 +90,24 @@ LicenseWidget::LicenseWidget( LicenseEntry entry, QWidget* parent )
 
     if ( m_entry.isLocal() )
     {
-        m_fullTextContents = loadLocalFile( m_entry.m_url );
+        auto it = licenseTexts().constFind( m_entry.m_url );
+        if ( it != licenseTexts().constEnd() )
+        {
+            m_fullTextContents = it.value();
+        }
+        else
+        {
+            // Large license texts are read in the background; the page
+            // shows the file name until the text is there.
+            auto* watcher = new QFutureWatcher< QString >( this );
+            connect( watcher, &QFutureWatcher< QString >::finished, this, [this, watcher]() {
+                watcher->deleteLater();
+                m_fullTextContents = watcher->result();
+                licenseTexts().insert( m_entry.m_url, m_fullTextContents );
+                showLocalLicenseText();
+            } );
+            watcher->setFuture( QtConcurrent::run( loadLocalFile, m_entry.m_url ) );
+        }
         showLocalLicenseText();
         connect( m_viewLicenseButton, &QAbstractButton::clicked, this, &LicenseWidget::expandClicked );
     }
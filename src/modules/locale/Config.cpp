@@ -14,6 +14,7 @@
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 #include "Settings.h"
+#include "geoip/Prefetch.h"
 #include "locale/Global.h"
 #include "locale/Translation.h"
 #include "modulesystem/ModuleManager.h"
@@ -22,6 +23,7 @@
 #include "utils/Variant.h"
 
 #include <QFile>
+#include <QFileInfo>
 #include <QProcess>
 #include <QTimeZone>
 
@@ -289,7 +291,7 @@ Config::automaticLocaleConfiguration() const
         return LocaleConfiguration();
     }
     return LocaleConfiguration::fromLanguageAndLocation(
-        QLocale().name(), supportedLocales(), currentLocation()->country() );
+        QLocale().name(), m_availableLocales, currentLocation()->country() );
 }
 
 LocaleConfiguration
@@ -460,28 +462,49 @@ getGeoIP( const QVariantMap& configurationMap, std::unique_ptr< CalamaresUtils::
     QVariantMap map = CalamaresUtils::getSubMap( configurationMap, "geoip", ok );
     if ( ok )
     {
-        QString url = CalamaresUtils::getString( map, "url" );
-        QString style = CalamaresUtils::getString( map, "style" );
-        QString selector = CalamaresUtils::getString( map, "selector" );
-
-        geoip = std::make_unique< CalamaresUtils::GeoIP::Handler >( style, url, selector );
+        geoip = std::make_unique< CalamaresUtils::GeoIP::Handler >( map );
         if ( !geoip->isValid() )
         {
-            cWarning() << "GeoIP Style" << style << "is not recognized.";
+            cWarning() << "GeoIP has no usable providers.";
         }
     }
 }
 
+static inline void
+getMapTiles( const QVariantMap& configurationMap, QString& directory, int& maximumZoom )
+{
+    bool ok = false;
+    QVariantMap map = CalamaresUtils::getSubMap( configurationMap, "map", ok );
+    if ( !ok )
+    {
+        return;
+    }
+    directory = CalamaresUtils::getString( map, "tiles" );
+    if ( !directory.isEmpty() && !QFileInfo( directory ).isDir() )
+    {
+        cWarning() << "Map tiles directory" << directory << "does not exist, using the online map.";
+        directory.clear();
+    }
+    if ( !directory.isEmpty() )
+    {
+        // Low zoom levels only: level 6 is already 4096 tiles
+        maximumZoom = int( qBound( 0LL, CalamaresUtils::getInteger( map, "maximumZoom", 5 ), 20LL ) );
+    }
+}
+
 void
 Config::setConfigurationMap( const QVariantMap& configurationMap )
 {
     getLocaleGenLines( configurationMap, m_localeGenLines );
+    m_availableLocales = AvailableLocales( m_localeGenLines );
     getAdjustLiveTimezone( configurationMap, m_adjustLiveTimezone );
     getStartingTimezone( configurationMap, m_startingTimezone );
     getGeoIP( configurationMap, m_geoip );
+    getMapTiles( configurationMap, m_mapTilesDirectory, m_mapMaximumZoom );
 
 #ifndef BUILD_AS_TEST
-    if ( m_geoip && m_geoip->isValid() )
+    using Prefetch = CalamaresUtils::GeoIP::Prefetch;
+    if ( ( m_geoip && m_geoip->isValid() ) || Prefetch::instance().state() != Prefetch::State::Idle )
     {
         connect(
             Calamares::ModuleManager::instance(), &Calamares::ModuleManager::modulesLoaded, this, &Config::startGeoIP );
@@ -516,6 +539,21 @@ Config::finalizeGlobalStorage() const
 void
 Config::startGeoIP()
 {
+    // The application-wide lookup, if there is one, replaces ours
+    using Prefetch = CalamaresUtils::GeoIP::Prefetch;
+    auto& prefetch = Prefetch::instance();
+    if ( prefetch.state() == Prefetch::State::Finished )
+    {
+        completeGeoIP( prefetch.timezone() );
+        return;
+    }
+    if ( prefetch.state() == Prefetch::State::Running )
+    {
+        connect(
+            &prefetch, &Prefetch::finished, this, [this, &prefetch]() { completeGeoIP( prefetch.timezone() ); } );
+        return;
+    }
+
     if ( m_geoip && m_geoip->isValid() )
     {
         auto& network = CalamaresUtils::Network::Manager::instance();
@@ -524,17 +562,18 @@ Config::startGeoIP()
             using Watcher = QFutureWatcher< CalamaresUtils::GeoIP::RegionZonePair >;
             m_geoipWatcher = std::make_unique< Watcher >();
             m_geoipWatcher->setFuture( m_geoip->query() );
-            connect( m_geoipWatcher.get(), &Watcher::finished, this, &Config::completeGeoIP );
+            connect( m_geoipWatcher.get(), &Watcher::finished, this, [this]() {
+                completeGeoIP( m_geoipWatcher->result() );
+            } );
         }
     }
 }
 
 void
-Config::completeGeoIP()
+Config::completeGeoIP( const CalamaresUtils::GeoIP::RegionZonePair& r )
 {
     if ( !currentLocation() )
     {
-        auto r = m_geoipWatcher->result();
         if ( r.isValid() )
         {
             m_startingTimezone = r;
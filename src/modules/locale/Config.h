@@ -50,6 +50,10 @@ class Config : public QObject
     // This is a long human-readable string with all three statuses
     Q_PROPERTY( QString prettyStatus READ prettyStatus NOTIFY prettyStatusChanged FINAL )
 
+    // Pre-rendered map tiles, for the QML map (empty if there are none)
+    Q_PROPERTY( QString mapTilesDirectory READ mapTilesDirectory CONSTANT FINAL )
+    Q_PROPERTY( int mapMaximumZoom READ mapMaximumZoom CONSTANT FINAL )
+
 public:
     Config( QObject* parent = nullptr );
     ~Config() override;
@@ -84,6 +88,11 @@ public:
 
     const CalamaresUtils::Locale::TimeZoneData* currentLocation() const { return m_currentLocation; }
 
+    /// Directory with pre-rendered map tiles; empty to use the online map
+    QString mapTilesDirectory() const { return m_mapTilesDirectory; }
+    /// Highest zoom level that the map allows (the tiles go up to that level)
+    int mapMaximumZoom() const { return m_mapMaximumZoom; }
+
 
     /// Special case, set location from starting timezone if not already set
     void setCurrentLocation();
@@ -140,6 +149,8 @@ signals:
 private:
     /// A list of supported locale identifiers (e.g. "en_US.UTF-8")
     QStringList m_localeGenLines;
+    /// The same, indexed for fromLanguageAndLocation()
+    AvailableLocales m_availableLocales;
 
     /// The regions (America, Asia, Europe ..)
     std::unique_ptr< CalamaresUtils::Locale::RegionsModel > m_regionModel;
@@ -173,6 +184,15 @@ private:
      */
     CalamaresUtils::GeoIP::RegionZonePair m_startingTimezone;
 
+    /** @brief Offline map tiles (for the QML map)
+     *
+     * When there is a tile directory, the map uses those tiles and
+     * does not need the network; it can not zoom in further than
+     * the tiles go.
+     */
+    QString m_mapTilesDirectory;
+    int m_mapMaximumZoom = 20;
+
     /** @brief Handler for GeoIP lookup (if configured)
      *
      * The GeoIP lookup needs to be started at some suitable time,
@@ -182,7 +202,7 @@ private:
 
     // Implementation details for doing GeoIP lookup
     void startGeoIP();
-    void completeGeoIP();
+    void completeGeoIP( const CalamaresUtils::GeoIP::RegionZonePair& r );
     std::unique_ptr< QFutureWatcher< CalamaresUtils::GeoIP::RegionZonePair > > m_geoipWatcher;
 };
 
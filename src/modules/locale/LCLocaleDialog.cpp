@@ -13,9 +13,12 @@
 #include <QBoxLayout>
 #include <QDialogButtonBox>
 #include <QLabel>
+#include <QLineEdit>
 #include <QListWidget>
 #include <QPushButton>
 
+#include <algorithm>
+
 LCLocaleDialog::LCLocaleDialog( const QString& guessedLCLocale, const QStringList& localeGenLines, QWidget* parent )
     : QDialog( parent )
 {
@@ -34,18 +37,53 @@ LCLocaleDialog::LCLocaleDialog( const QString& guessedLCLocale, const QStringLis
     mainLayout->addWidget( upperText );
     setMinimumWidth( upperText->fontMetrics().height() * 24 );
 
+    m_filterEdit = new QLineEdit( this );
+    m_filterEdit->setPlaceholderText( tr( "Search locales" ) );
+    m_filterEdit->setClearButtonEnabled( true );
+    mainLayout->addWidget( m_filterEdit );
+
     m_localesWidget = new QListWidget( this );
     m_localesWidget->addItems( localeGenLines );
     m_localesWidget->setSelectionMode( QAbstractItemView::SingleSelection );
     mainLayout->addWidget( m_localesWidget );
 
-    int selected = -1;
+    // The keys and their sorted index are built once; filtering and the
+    // initial selection are then binary searches instead of string scans
+    // over the whole SUPPORTED list.
+    m_keys.reserve( localeGenLines.count() );
+    m_index.reserve( localeGenLines.count() );
     for ( int i = 0; i < localeGenLines.count(); ++i )
     {
-        if ( localeGenLines[ i ].contains( guessedLCLocale ) )
+        m_keys.append( localeGenLines[ i ].toLower() );
+        m_index.push_back( i );
+    }
+    std::stable_sort(
+        m_index.begin(), m_index.end(), [this]( int a, int b ) { return m_keys[ a ] < m_keys[ b ]; } );
+    m_visibleBegin = 0;
+    m_visibleEnd = m_index.size();
+
+    int selected = -1;
+    {
+        const QString guess = guessedLCLocale.toLower();
+        auto it = std::lower_bound( m_index.cbegin(),
+                                    m_index.cend(),
+                                    guess,
+                                    [this]( int row, const QString& key ) { return m_keys[ row ] < key; } );
+        if ( it != m_index.cend() && m_keys[ *it ].startsWith( guess ) )
         {
-            selected = i;
-            break;
+            selected = *it;
+        }
+        else
+        {
+            // Not a prefix of any line, fall back to the old substring match
+            for ( int i = 0; i < localeGenLines.count(); ++i )
+            {
+                if ( localeGenLines[ i ].contains( guessedLCLocale ) )
+                {
+                    selected = i;
+                    break;
+                }
+            }
         }
     }
 
@@ -59,6 +97,7 @@ LCLocaleDialog::LCLocaleDialog( const QString& guessedLCLocale, const QStringLis
     connect( dbb->button( QDialogButtonBox::Ok ), &QPushButton::clicked, this, &QDialog::accept );
     connect( dbb->button( QDialogButtonBox::Cancel ), &QPushButton::clicked, this, &QDialog::reject );
 
+    connect( m_filterEdit, &QLineEdit::textChanged, this, &LCLocaleDialog::filterLocales );
     connect( m_localesWidget, &QListWidget::itemDoubleClicked, this, &QDialog::accept );
     connect( m_localesWidget, &QListWidget::itemSelectionChanged, [this, dbb]() {
         if ( m_localesWidget->selectedItems().isEmpty() )
@@ -75,6 +114,50 @@ LCLocaleDialog::LCLocaleDialog( const QString& guessedLCLocale, const QStringLis
     {
         m_localesWidget->setCurrentRow( selected );
     }
+    m_filterEdit->setFocus();
+}
+
+void
+LCLocaleDialog::filterLocales( const QString& text )
+{
+    const QString prefix = text.trimmed().toLower();
+
+    // Keys sharing a prefix are contiguous in the sorted index
+    const auto first = std::lower_bound( m_index.cbegin(),
+                                         m_index.cend(),
+                                         prefix,
+                                         [this]( int row, const QString& key ) { return m_keys[ row ] < key; } );
+    const auto last = std::partition_point(
+        first, m_index.cend(), [this, &prefix]( int row ) { return m_keys[ row ].startsWith( prefix ); } );
+    const std::size_t newBegin = std::size_t( first - m_index.cbegin() );
+    const std::size_t newEnd = std::size_t( last - m_index.cbegin() );
+
+    auto inNew = [=]( std::size_t i ) { return newBegin <= i && i < newEnd; };
+    auto inOld = [this]( std::size_t i ) { return m_visibleBegin <= i && i < m_visibleEnd; };
+
+    for ( std::size_t i = m_visibleBegin; i < m_visibleEnd; ++i )
+    {
+        if ( !inNew( i ) )
+        {
+            m_localesWidget->setRowHidden( m_index[ i ], true );
+        }
+    }
+    for ( std::size_t i = newBegin; i < newEnd; ++i )
+    {
+        if ( !inOld( i ) )
+        {
+            m_localesWidget->setRowHidden( m_index[ i ], false );
+        }
+    }
+    m_visibleBegin = newBegin;
+    m_visibleEnd = newEnd;
+
+    // Keep a visible selection, so that OK picks something the user can see
+    const int current = m_localesWidget->currentRow();
+    if ( newBegin < newEnd && ( current < 0 || m_localesWidget->isRowHidden( current ) ) )
+    {
+        m_localesWidget->setCurrentRow( m_index[ newBegin ] );
+    }
 }
 
 
@@ -11,7 +11,11 @@
 #define LCLOCALEDIALOG_H
 
 #include <QDialog>
+#include <QStringList>
 
+#include <vector>
+
+class QLineEdit;
 class QListWidget;
 
 class LCLocaleDialog : public QDialog
@@ -25,7 +29,21 @@ public:
     QString selectedLCLocale();
 
 private:
+    /** @brief Shows only the locales whose name starts with @p text
+     *
+     * Matching is case-insensitive. The range of matching rows is found
+     * by binary search in the sorted index, and only the rows that enter
+     * or leave that range since the previous filter are shown or hidden.
+     */
+    void filterLocales( const QString& text );
+
     QListWidget* m_localesWidget;
+    QLineEdit* m_filterEdit;
+
+    QStringList m_keys;  ///< lower-cased locale lines, by row
+    std::vector< int > m_index;  ///< rows, sorted by key
+    std::size_t m_visibleBegin = 0;  ///< range in m_index that is shown
+    std::size_t m_visibleEnd = 0;
 };
 
 #endif  // LCLOCALEDIALOG_H
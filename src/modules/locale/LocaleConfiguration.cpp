@@ -13,7 +13,65 @@
 #include "utils/Logger.h"
 
 #include <QLocale>
-#include <QRegularExpression>
+
+AvailableLocales::AvailableLocales( const QStringList& lines )
+{
+    for ( const QString& line : lines )
+    {
+        const auto parts = split( line );
+        if ( parts.first.isEmpty() )
+        {
+            continue;
+        }
+        m_byLanguage[ parts.first ].append( line );
+        if ( !parts.second.isEmpty() )
+        {
+            m_byTerritory[ parts.second ].append( line );
+            const QString key = parts.first + '_' + parts.second;
+            if ( !m_first.contains( key ) )
+            {
+                m_first.insert( key, line );
+            }
+        }
+    }
+}
+
+QPair< QString, QString >
+AvailableLocales::split( const QString& line )
+{
+    static const QString languageEnd = QStringLiteral( "_.@ " );
+    static const QString territoryEnd = QStringLiteral( ".@ " );
+
+    int i = 0;
+    while ( i < line.length() && !languageEnd.contains( line.at( i ) ) )
+    {
+        ++i;
+    }
+    const QString language = line.left( i );
+    if ( i >= line.length() || line.at( i ) != '_' )
+    {
+        return { language, QString() };
+    }
+    const int start = ++i;
+    while ( i < line.length() && !territoryEnd.contains( line.at( i ) ) )
+    {
+        ++i;
+    }
+    return { language, line.mid( start, i - start ) };
+}
+
+QString
+AvailableLocales::startingWith( const QString& prefix ) const
+{
+    for ( const QString& line : m_byLanguage.value( split( prefix ).first ) )
+    {
+        if ( line.startsWith( prefix ) )
+        {
+            return line;
+        }
+    }
+    return QString();
+}
 
 LocaleConfiguration::LocaleConfiguration()
     : explicit_lang( false )
@@ -45,12 +103,20 @@ LocaleConfiguration
 LocaleConfiguration::fromLanguageAndLocation( const QString& languageLocale,
                                               const QStringList& availableLocales,
                                               const QString& countryCode )
+{
+    return fromLanguageAndLocation( languageLocale, AvailableLocales( availableLocales ), countryCode );
+}
+
+LocaleConfiguration
+LocaleConfiguration::fromLanguageAndLocation( const QString& languageLocale,
+                                              const AvailableLocales& availableLocales,
+                                              const QString& countryCode )
 {
     QString language = languageLocale.split( '_' ).first();
 
-    // Either an exact match, or the whole language part matches
-    // (followed by .<encoding> or _<country>
-    QStringList linesForLanguage = availableLocales.filter( QRegularExpression( language + "[._]" ) );
+    // The lines where the whole language part matches
+    // (followed by .<encoding> or _<country>)
+    const QStringList linesForLanguage = availableLocales.forLanguage( language );
 
     QString lang;
     if ( linesForLanguage.length() == 0 || languageLocale.isEmpty() )
@@ -73,14 +139,10 @@ LocaleConfiguration::fromLanguageAndLocation( const QString& languageLocale,
         # locale categories reflect the selected location. */
     if ( language == "pt" || language == "zh" )
     {
-        QString proposedLocale = QString( "%1_%2" ).arg( language ).arg( countryCode );
-        for ( const QString& line : linesForLanguage )
+        const QString proposedLocale = availableLocales.first( language, countryCode );
+        if ( !proposedLocale.isEmpty() )
         {
-            if ( line.contains( proposedLocale ) )
-            {
-                lang = line;
-                break;
-            }
+            lang = proposedLocale;
         }
     }
 
@@ -88,14 +150,7 @@ LocaleConfiguration::fromLanguageAndLocation( const QString& languageLocale,
     // language locale and pick the first result, if any.
     if ( lang.isEmpty() )
     {
-        for ( const QString& line : availableLocales )
-        {
-            if ( line.startsWith( languageLocale ) )
-            {
-                lang = line;
-                break;
-            }
-        }
+        lang = availableLocales.startingWith( languageLocale );
     }
 
     // Else we have an unrecognized or unsupported locale, all we can do is go with
@@ -152,28 +207,17 @@ LocaleConfiguration::fromLanguageAndLocation( const QString& languageLocale,
     // We make a proposed locale based on the UI language and the timezone's country. There is no
     // guarantee that this will be a valid, supported locale (often it won't).
     QString lc_formats;
-    QString combined = QString( "%1_%2" ).arg( language ).arg( countryCode );
     // We look up if it's a supported locale.
-    for ( const QString& line : availableLocales )
+    const QString combined = availableLocales.first( language, countryCode );
+    if ( !combined.isEmpty() )
     {
-        if ( line.startsWith( combined ) )
-        {
-            lang = line;
-            lc_formats = line;
-            break;
-        }
+        lang = combined;
+        lc_formats = combined;
     }
 
     if ( lc_formats.isEmpty() )
     {
-        QStringList available;
-        for ( const QString& line : availableLocales )
-        {
-            if ( line.contains( QString( "_%1" ).arg( countryCode ) ) )
-            {
-                available.append( line );
-            }
-        }
+        QStringList available = availableLocales.forTerritory( countryCode );
         available.sort();
         if ( available.count() == 1 )
         {
@@ -181,7 +225,7 @@ LocaleConfiguration::fromLanguageAndLocation( const QString& languageLocale,
         }
         else
         {
-            QMap< QString, QString > countryToDefaultLanguage {
+            static const QMap< QString, QString > countryToDefaultLanguage {
                 { "AU", "en" },
                 { "CN", "zh" },
                 { "DE", "de" },
@@ -228,17 +272,7 @@ LocaleConfiguration::fromLanguageAndLocation( const QString& languageLocale,
             };
             if ( countryToDefaultLanguage.contains( countryCode ) )
             {
-                QString combinedLocale
-                    = QString( "%1_%2" ).arg( countryToDefaultLanguage.value( countryCode ) ).arg( countryCode );
-
-                for ( const QString& line : availableLocales )
-                {
-                    if ( line.startsWith( combinedLocale ) )
-                    {
-                        lc_formats = line;
-                        break;
-                    }
-                }
+                lc_formats = availableLocales.first( countryToDefaultLanguage.value( countryCode ), countryCode );
             }
         }
     }
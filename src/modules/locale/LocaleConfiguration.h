@@ -12,8 +12,50 @@
 #define LOCALECONFIGURATION_H
 
 #include <QDebug>
+#include <QHash>
 #include <QMap>
+#include <QPair>
 #include <QString>
+#include <QStringList>
+
+/** @brief The available locales, indexed by language and territory
+ *
+ * The lines are as in /usr/share/i18n/SUPPORTED, e.g. "en_US.UTF-8 UTF-8".
+ * The language of a line is the part before any of "_.@ ", the territory
+ * is the part after "_" up to any of ".@ ". Each index keeps the lines in
+ * their original order, so "the first line for" something is the same
+ * as with a search through the whole list.
+ */
+class AvailableLocales
+{
+public:
+    AvailableLocales() = default;
+    explicit AvailableLocales( const QStringList& lines );
+
+    /// @brief The lines for @p language (e.g. "nl"), in any territory
+    QStringList forLanguage( const QString& language ) const { return m_byLanguage.value( language ); }
+    /// @brief The lines for @p territory (e.g. "BE"), in any language
+    QStringList forTerritory( const QString& territory ) const { return m_byTerritory.value( territory ); }
+    /// @brief The first line for @p language in @p territory; empty if there is none
+    QString first( const QString& language, const QString& territory ) const
+    {
+        return m_first.value( language + '_' + territory );
+    }
+    /** @brief The first line that starts with @p prefix; empty if there is none
+     *
+     * The @p prefix is a locale name, e.g. "nl" or "nl_BE"; only the lines
+     * for its language are searched.
+     */
+    QString startingWith( const QString& prefix ) const;
+
+    /// @brief Splits @p line into its language and territory (which may be empty)
+    static QPair< QString, QString > split( const QString& line );
+
+private:
+    QHash< QString, QStringList > m_byLanguage;
+    QHash< QString, QStringList > m_byTerritory;
+    QHash< QString, QString > m_first;  ///< First line for each "<language>_<territory>"
+};
 
 class LocaleConfiguration
 {
@@ -43,6 +85,10 @@ public:  // TODO: private (but need to be public for tests)
      */
     static LocaleConfiguration
     fromLanguageAndLocation( const QString& language, const QStringList& availableLocales, const QString& countryCode );
+    /// @brief As above, with the available locales already indexed
+    static LocaleConfiguration fromLanguageAndLocation( const QString& language,
+                                                        const AvailableLocales& availableLocales,
+                                                        const QString& countryCode );
 
     /// Is this an empty (default-constructed and not modified) configuration?
     bool isEmpty() const;
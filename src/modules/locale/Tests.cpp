@@ -17,6 +17,7 @@
 #include <QtTest/QtTest>
 
 #include <set>
+#include <vector>
 
 class LocaleTests : public QObject
 {
@@ -31,10 +32,12 @@ private Q_SLOTS:
     void testEmptyLocaleConfiguration();
     void testDefaultLocaleConfiguration();
     void testSplitLocaleConfiguration();
+    void testAvailableLocales();
 
     // Check the TZ images for consistency
     void testTZSanity();
     void testTZImages();  // No overlaps in images
+    void testTZImageIndex();  // Raster matches images
     void testTZLocations();  // No overlaps in locations
     void testSpecificLocations();
 
@@ -98,6 +101,53 @@ LocaleTests::testSplitLocaleConfiguration()
     QCOMPARE( lc3.lc_numeric, QStringLiteral( "de_DE.UTF-8" ) );
 }
 
+void
+LocaleTests::testAvailableLocales()
+{
+    QCOMPARE( AvailableLocales::split( "en_US.UTF-8 UTF-8" ), qMakePair( QString( "en" ), QString( "US" ) ) );
+    QCOMPARE( AvailableLocales::split( "sr_RS@latin UTF-8" ), qMakePair( QString( "sr" ), QString( "RS" ) ) );
+    QCOMPARE( AvailableLocales::split( "eo.UTF-8 UTF-8" ), qMakePair( QString( "eo" ), QString() ) );
+    QCOMPARE( AvailableLocales::split( "nl" ), qMakePair( QString( "nl" ), QString() ) );
+
+    const QStringList lines { "be_BY.UTF-8 UTF-8", "bem_ZM.UTF-8 UTF-8", "de_BE.UTF-8 UTF-8", "en_US.UTF-8 UTF-8",
+                              "eo.UTF-8 UTF-8",    "fr_BE.UTF-8 UTF-8",  "fy_NL UTF-8",       "nl_BE.UTF-8 UTF-8",
+                              "nl_NL.UTF-8 UTF-8", "pt_BR.UTF-8 UTF-8",  "pt_PT.UTF-8 UTF-8", "ta_LK.UTF-8 UTF-8" };
+    const AvailableLocales available( lines );
+    QCOMPARE( available.forLanguage( "be" ), QStringList { "be_BY.UTF-8 UTF-8" } );  // Not bem
+    QCOMPARE( available.forLanguage( "nl" ).count(), 2 );
+    QCOMPARE( available.forTerritory( "BE" ).count(), 3 );
+    QCOMPARE( available.first( "nl", "NL" ), QStringLiteral( "nl_NL.UTF-8 UTF-8" ) );
+    QCOMPARE( available.first( "nl", "US" ), QString() );
+    QCOMPARE( available.startingWith( "nl" ), QStringLiteral( "nl_BE.UTF-8 UTF-8" ) );
+    QCOMPARE( available.startingWith( "eo" ), QStringLiteral( "eo.UTF-8 UTF-8" ) );
+    QCOMPARE( available.startingWith( "be" ), QStringLiteral( "be_BY.UTF-8 UTF-8" ) );
+
+    // Language and location match
+    auto lc = LocaleConfiguration::fromLanguageAndLocation( "nl_NL", available, "BE" );
+    QCOMPARE( lc.language(), QStringLiteral( "nl_BE.UTF-8 UTF-8" ) );
+    QCOMPARE( lc.lc_numeric, QStringLiteral( "nl_BE.UTF-8 UTF-8" ) );
+    // Formats from the only locale for the country
+    lc = LocaleConfiguration::fromLanguageAndLocation( "en_US", available, "LK" );
+    QCOMPARE( lc.language(), QStringLiteral( "en_US.UTF-8 UTF-8" ) );
+    QCOMPARE( lc.lc_numeric, QStringLiteral( "ta_LK.UTF-8 UTF-8" ) );
+    // Several locales for the country, none preferred: formats follow the language
+    lc = LocaleConfiguration::fromLanguageAndLocation( "en_US", available, "BE" );
+    QCOMPARE( lc.lc_numeric, QStringLiteral( "en_US.UTF-8 UTF-8" ) );
+    // Preferred language for the country
+    lc = LocaleConfiguration::fromLanguageAndLocation( "en_US", available, "NL" );
+    QCOMPARE( lc.lc_numeric, QStringLiteral( "nl_NL.UTF-8 UTF-8" ) );
+    // Portuguese follows the location
+    lc = LocaleConfiguration::fromLanguageAndLocation( "pt_BR", available, "PT" );
+    QCOMPARE( lc.language(), QStringLiteral( "pt_PT.UTF-8 UTF-8" ) );
+    // Unknown language
+    lc = LocaleConfiguration::fromLanguageAndLocation( "xx_YY", available, "US" );
+    QCOMPARE( lc.language(), QStringLiteral( "en_US.UTF-8" ) );
+
+    // The same, from the plain list
+    QCOMPARE( LocaleConfiguration::fromLanguageAndLocation( "en_US", lines, "NL" ).lc_numeric,
+              QStringLiteral( "nl_NL.UTF-8 UTF-8" ) );
+}
+
 void
 LocaleTests::testTZSanity()
 {
@@ -133,9 +183,9 @@ LocaleTests::testTZImages()
         QVERIFY( !background.isNull() );
         QCOMPARE( background.size(), windowSize );
     }
-    for ( const auto& image : images )
+    for ( int i = 0; i < images.count(); ++i )
     {
-        QCOMPARE( image.size(), windowSize );
+        QCOMPARE( images.image( i ).size(), windowSize );
     }
 
     // Check zones are uniquely-claimed
@@ -178,6 +228,52 @@ LocaleTests::testTZImages()
     QCOMPARE( overlapcount, 0 );
 }
 
+void
+LocaleTests::testTZImageIndex()
+{
+    auto images = TimeZoneImageList::fromDirectory( SOURCE_DIR );
+    QCOMPARE( images.count(), images.zoneCount );
+
+    // The shipped raster must agree with the first image claiming each pixel;
+    // if this fails, re-run images/zone-index.py.
+    const QSize size = images.imageSize;
+    std::vector< int > expected( size.width() * size.height(), -1 );
+    for ( int i = 0; i < images.count(); ++i )
+    {
+        const QImage zone = images.image( i );
+        QCOMPARE( zone.size(), size );
+        for ( int y = 0; y < size.height(); ++y )
+        {
+            for ( int x = 0; x < size.width(); ++x )
+            {
+                int& e = expected[ y * size.width() + x ];
+                if ( e < 0 && zone.pixel( x, y ) != 0 )
+                {
+                    e = i;
+                }
+            }
+        }
+    }
+
+    int mismatches = 0;
+    for ( int y = 0; y < size.height(); ++y )
+    {
+        for ( int x = 0; x < size.width(); ++x )
+        {
+            if ( images.index( QPoint( x, y ) ) != expected[ y * size.width() + x ] )
+            {
+                mismatches++;
+            }
+        }
+    }
+    QCOMPARE( mismatches, 0 );
+
+    QCOMPARE( images.index( QPoint( -1, 0 ) ), -1 );
+    QCOMPARE( images.index( QPoint( size.width(), 0 ) ), -1 );
+    QVERIFY( images.find( QPoint( 0, size.height() ) ).isNull() );
+    QCOMPARE( images.image( 0 ).text( QStringLiteral( "zone" ) ), images.zoneName( 0 ) );
+}
+
 bool
 operator<( const QPoint& l, const QPoint& r )
 {
@@ -0,0 +1,129 @@
+#! /usr/bin/env python3
+#
+#  === This file is part of Calamares - <https://calamares.io> ===
+#
+#   SPDX-FileCopyrightText: 2026 agent <agent@local>
+#   SPDX-License-Identifier: BSD-2-Clause
+#
+"""
+Python3 script to build the zone-index raster from the timezone images.
+
+The raster is one byte per pixel, row-major, the same size as the
+timezone images (780x340). A byte value of 0 means no zone image
+claims that pixel; otherwise the value is one more than the index
+of the first zone image (in the order of zoneNames in TimeZoneImage.cpp)
+whose pixel there is not fully transparent-black.
+
+Run the script from **inside** the images/ directory, after changing
+any of the timezone_*.png files:
+
+    python3 zone-index.py > timezone_index.bin
+
+Only the standard library is used; the PNG decoder here understands
+exactly the kinds of PNG used by the timezone images (8-bit RGBA and
+8-bit palette, not interlaced).
+"""
+#
+### END USAGE
+
+import struct
+import sys
+import zlib
+
+# Must match zoneNames in timezonewidget/TimeZoneImage.cpp
+zone_names = [
+    "0.0", "1.0", "2.0", "3.0", "3.5", "4.0", "4.5", "5.0", "5.5", "5.75", "6.0", "6.5", "7.0",
+    "8.0", "9.0", "9.5", "10.0", "10.5", "11.0", "12.0", "12.75", "13.0", "-1.0", "-2.0", "-3.0", "-3.5",
+    "-4.0", "-4.5", "-5.0", "-5.5", "-6.0", "-7.0", "-8.0", "-9.0", "-9.5", "-10.0", "-11.0",
+]
+
+WIDTH = 780
+HEIGHT = 340
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    if pb <= pc:
+        return b
+    return c
+
+
+def read_png(filename):
+    """
+    Returns a list of rows; each row is a list of (r, g, b, a) tuples.
+    """
+    with open(filename, "rb") as f:
+        data = f.read()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError("{!s} is not a PNG".format(filename))
+
+    pos = 8
+    idat = b""
+    palette = []
+    alphas = b""
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += length + 12
+        if kind == b"IHDR":
+            width, height, depth, colortype, _, _, interlace = struct.unpack(">IIBBBBB", chunk)
+        elif kind == b"PLTE":
+            palette = [tuple(chunk[i:i + 3]) for i in range(0, len(chunk), 3)]
+        elif kind == b"tRNS":
+            alphas = chunk
+        elif kind == b"IDAT":
+            idat += chunk
+        elif kind == b"IEND":
+            break
+
+    if depth != 8 or interlace != 0 or colortype not in (3, 6):
+        raise ValueError("{!s} has an unsupported PNG format".format(filename))
+    if (width, height) != (WIDTH, HEIGHT):
+        raise ValueError("{!s} has the wrong size".format(filename))
+
+    bpp = 4 if colortype == 6 else 1
+    stride = width * bpp
+    raw = zlib.decompress(idat)
+    rows = []
+    previous = bytearray(stride)
+    for y in range(height):
+        filtertype = raw[y * (stride + 1)]
+        line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for x in range(stride):
+            a = line[x - bpp] if x >= bpp else 0
+            b = previous[x]
+            c = previous[x - bpp] if x >= bpp else 0
+            if filtertype == 1:
+                line[x] = (line[x] + a) & 0xff
+            elif filtertype == 2:
+                line[x] = (line[x] + b) & 0xff
+            elif filtertype == 3:
+                line[x] = (line[x] + ((a + b) >> 1)) & 0xff
+            elif filtertype == 4:
+                line[x] = (line[x] + paeth(a, b, c)) & 0xff
+        previous = line
+
+        if colortype == 6:
+            rows.append([tuple(line[x:x + 4]) for x in range(0, stride, 4)])
+        else:
+            rows.append([palette[i] + ((alphas[i] if i < len(alphas) else 255),) for i in line])
+    return rows
+
+
+def main():
+    raster = bytearray(WIDTH * HEIGHT)
+    for index, name in enumerate(zone_names):
+        rows = read_png("timezone_{!s}.png".format(name))
+        for y, row in enumerate(rows):
+            for x, pixel in enumerate(row):
+                offset = y * WIDTH + x
+                if not raster[offset] and pixel != (0, 0, 0, 0):
+                    raster[offset] = index + 1
+    sys.stdout.buffer.write(raster)
+
+
+if __name__ == "__main__":
+    main()
@@ -11,7 +11,9 @@
 
 #include "utils/Logger.h"
 
+#include <QCache>
 #include <QDir>
+#include <QFile>
 
 #include <cmath>
 
@@ -25,40 +27,179 @@ static_assert( TimeZoneImageList::zoneCount == ( sizeof( zoneNames ) / sizeof( z
 #define ZONE_NAME QStringLiteral( "zone" )
 
 static_assert( TimeZoneImageList::zoneCount == 37, "Incorrect number of zones" );
+static_assert( TimeZoneImageList::zoneCount < 255, "Zone index must fit in a byte" );
 
-TimeZoneImageList::TimeZoneImageList() {}
+// Pixel value indicating that a spot is outside of a zone
+static constexpr const int RGB_TRANSPARENT = 0;
 
-TimeZoneImageList
-TimeZoneImageList::fromQRC()
+/// @brief How many decoded overlays to keep around
+static constexpr const int overlayCacheSize = 4;
+
+struct TimeZoneImageList::Private
+{
+    QString prefix;  ///< Directory (with trailing /) holding the images
+    bool valid = false;
+
+    /** @brief The zone-index raster
+     *
+     * Points into the mapped @c indexFile, or into @c indexData when
+     * mapping is not possible. 0 is unclaimed, otherwise zone index + 1.
+     */
+    const uchar* raster = nullptr;
+    QFile indexFile;
+    QByteArray indexData;
+
+    QCache< int, QImage > overlays;
+
+    QString fileName( int index ) const
+    {
+        return prefix + QStringLiteral( "timezone_" ) + zoneNames[ index ] + QStringLiteral( ".png" );
+    }
+
+    bool loadIndex();
+    void buildIndex();
+};
+
+bool
+TimeZoneImageList::Private::loadIndex()
 {
-    TimeZoneImageList l;
-    for ( const auto* zoneName : zoneNames )
+    const qint64 expectedSize = qint64( imageSize.width() ) * imageSize.height();
+
+    indexFile.setFileName( prefix + QStringLiteral( "timezone_index.bin" ) );
+    if ( !indexFile.open( QIODevice::ReadOnly ) )
+    {
+        return false;
+    }
+    if ( indexFile.size() != expectedSize )
     {
-        l.append( QImage( QStringLiteral( ":/images/timezone_" ) + zoneName + ".png" ) );
-        l.last().setText( ZONE_NAME, zoneName );
+        cWarning() << "TimeZone index" << indexFile.fileName() << "has size" << indexFile.size() << "expected"
+                   << expectedSize;
+        indexFile.close();
+        return false;
     }
 
-    return l;
+    raster = indexFile.map( 0, expectedSize );
+    if ( !raster )
+    {
+        // Compressed resources can't be mapped; the copy is still only
+        // one byte per pixel.
+        indexData = indexFile.readAll();
+        indexFile.close();
+        if ( indexData.size() != expectedSize )
+        {
+            indexData.clear();
+            return false;
+        }
+        raster = reinterpret_cast< const uchar* >( indexData.constData() );
+    }
+    return true;
+}
+
+void
+TimeZoneImageList::Private::buildIndex()
+{
+    // Same rule as images/zone-index.py, for when the raster is missing.
+    const int width = imageSize.width();
+    const int height = imageSize.height();
+    indexData = QByteArray( width * height, '\0' );
+
+    for ( int i = 0; i < zoneCount; ++i )
+    {
+        const QImage zone = QImage( fileName( i ) ).convertToFormat( QImage::Format_ARGB32 );
+        if ( zone.size() != imageSize )
+        {
+            continue;
+        }
+        for ( int y = 0; y < height; ++y )
+        {
+            const auto* line = reinterpret_cast< const QRgb* >( zone.constScanLine( y ) );
+            char* out = indexData.data() + y * width;
+            for ( int x = 0; x < width; ++x )
+            {
+                if ( !out[ x ] && line[ x ] != RGB_TRANSPARENT )
+                {
+                    out[ x ] = char( i + 1 );
+                }
+            }
+        }
+    }
+    raster = reinterpret_cast< const uchar* >( indexData.constData() );
+}
+
+TimeZoneImageList::TimeZoneImageList( const QString& prefix )
+    : d( std::make_unique< Private >() )
+{
+    d->overlays.setMaxCost( overlayCacheSize );
+    if ( prefix.isEmpty() )
+    {
+        return;
+    }
+
+    d->prefix = prefix;
+    d->valid = true;
+    if ( !d->loadIndex() )
+    {
+        cDebug() << "TimeZone index not found in" << prefix << ", building from images.";
+        d->buildIndex();
+    }
+}
+
+TimeZoneImageList::TimeZoneImageList( TimeZoneImageList&& ) = default;
+
+TimeZoneImageList::~TimeZoneImageList() = default;
+
+TimeZoneImageList
+TimeZoneImageList::fromQRC()
+{
+    return TimeZoneImageList( QStringLiteral( ":/images/" ) );
 }
 
 TimeZoneImageList
 TimeZoneImageList::fromDirectory( const QString& dirName )
 {
-    TimeZoneImageList l;
     QDir dir( dirName );
     if ( !dir.exists() )
     {
         cWarning() << "TimeZone images directory" << dirName << "does not exist.";
-        return l;
+        return TimeZoneImageList( QString() );
+    }
+
+    return TimeZoneImageList( dir.absolutePath() + '/' );
+}
+
+int
+TimeZoneImageList::count() const
+{
+    return d->valid ? zoneCount : 0;
+}
+
+QImage
+TimeZoneImageList::image( int index ) const
+{
+    if ( index < 0 || index >= count() )
+    {
+        return QImage();
     }
 
-    for ( const auto* zoneName : zoneNames )
+    if ( const QImage* cached = d->overlays.object( index ) )
     {
-        l.append( QImage( dir.filePath( QStringLiteral( "timezone_" ) + zoneName + ".png" ) ) );
-        l.last().setText( ZONE_NAME, zoneName );
+        return *cached;
     }
 
-    return l;
+    QImage zone( d->fileName( index ) );
+    zone.setText( ZONE_NAME, zoneNames[ index ] );
+    d->overlays.insert( index, new QImage( zone ) );
+    return zone;
+}
+
+QString
+TimeZoneImageList::zoneName( int index ) const
+{
+    if ( index < 0 || index >= zoneCount )
+    {
+        return QString();
+    }
+    return QString::fromLatin1( zoneNames[ index ] );
 }
 
 QPoint
@@ -135,21 +276,18 @@ TimeZoneImageList::getLocationPosition( double longitude, double latitude )
     return QPoint( int( x ), int( y ) );
 }
 
-// Pixel value indicating that a spot is outside of a zone
-static constexpr const int RGB_TRANSPARENT = 0;
-
 int
 TimeZoneImageList::index( QPoint pos, int& count ) const
 {
     count = 0;
 
 #ifdef DEBUG_TIMEZONES
-    for ( int i = 0; i < size(); ++i )
+    for ( int i = 0; i < this->count(); ++i )
     {
-        const QImage& zone = at( i );
+        const QImage zone = image( i );
 
         // If not transparent set as current
-        if ( zone.pixel( pos ) != RGB_TRANSPARENT )
+        if ( zone.valid( pos ) && zone.pixel( pos ) != RGB_TRANSPARENT )
         {
             // Log *all* the zones that contain this point,
             // but only pick the first.
@@ -175,26 +313,15 @@ TimeZoneImageList::index( QPoint pos, int& count ) const
 int
 TimeZoneImageList::index( QPoint pos ) const
 {
-    for ( int i = 0; i < size(); ++i )
+    if ( !d->raster || pos.x() < 0 || pos.y() < 0 || pos.x() >= imageSize.width() || pos.y() >= imageSize.height() )
     {
-        const QImage& zone = at( i );
-
-        // If not transparent set as current
-        if ( zone.pixel( pos ) != RGB_TRANSPARENT )
-        {
-            return i;
-        }
+        return -1;
     }
-    return -1;
+    return int( d->raster[ pos.y() * imageSize.width() + pos.x() ] ) - 1;
 }
 
 QImage
 TimeZoneImageList::find( QPoint p ) const
 {
-    int i = index( p );
-    if ( i < 0 || size() <= i )
-    {
-        return QImage();
-    }
-    return at( i );
+    return image( index( p ) );
 }
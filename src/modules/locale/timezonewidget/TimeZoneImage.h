@@ -11,7 +11,9 @@
 #define TIMEZONEIMAGE_H
 
 #include <QImage>
-#include <QList>
+#include <QString>
+
+#include <memory>
 
 using TimeZoneImage = QImage;
 
@@ -19,25 +21,45 @@ using TimeZoneImage = QImage;
  *
  * There's one fixed list of timezone images that can be loaded
  * from the QRC, or from the source directory.
+ *
+ * Looking up which zone claims a pixel does not need the images
+ * themselves: a zone-index raster (one byte per pixel, see
+ * `images/zone-index.py`) answers that directly. It is mapped from
+ * the resource or file when possible. The overlay images are only
+ * decoded when they are asked for, and only a few of them are kept.
  */
-class TimeZoneImageList : public QList< TimeZoneImage >
+class TimeZoneImageList
 {
 private:
-    TimeZoneImageList();
+    explicit TimeZoneImageList( const QString& prefix );
 
 public:
-    /** @brief loads all the images from QRC.
+    TimeZoneImageList( TimeZoneImageList&& );
+    ~TimeZoneImageList();
+
+    /** @brief uses the images from QRC.
      *
      * The images are assumed to be compiled into the Qt resource
      * system and are loaded from there.
      */
     static TimeZoneImageList fromQRC();
-    /** @brief loads all the images from a specified directory.
+    /** @brief uses the images from a specified directory.
      *
      * No error is returned if files are missing.
      */
     static TimeZoneImageList fromDirectory( const QString& dirName );
 
+    /// @brief The number of zones in the list (zero if loading failed)
+    int count() const;
+    /** @brief Get the overlay image for zone @p index
+     *
+     * The image is decoded on first use and cached. Returns a null
+     * image if @p index is out of range or the file is missing.
+     */
+    QImage image( int index ) const;
+    /// @brief The UTC offset (e.g. "5.75") that zone @p index represents
+    QString zoneName( int index ) const;
+
     /** @brief Map longitude and latitude to pixel positions
      *
      * The image is flat, and stretched at the poles and generally
@@ -58,7 +80,8 @@ public:
     /** @brief Find the index of the image claiming point @p p
      *
      * As `index(p)`, but also fills in @p count with the number of
-     * zones that claim the point.
+     * zones that claim the point. Only when DEBUG_TIMEZONES is set
+     * is @p count computed, and it needs every image decoded.
      */
     int index( QPoint p, int& count ) const;
     /** @brief Get image of the zone claiming @p p
@@ -71,6 +94,10 @@ public:
     static constexpr const int zoneCount = 37;
     /// @brief The expected size of each zone image.
     static constexpr const QSize imageSize = QSize( 780, 340 );
+
+private:
+    struct Private;
+    std::unique_ptr< Private > d;
 };
 
 #endif
@@ -66,6 +66,9 @@ def rewrite_locale_gen(srcfilename, destfilename, locale_conf):
     Copies a locale.gen file from @p srcfilename to @p destfilename
     (this may be the same name), enabling those locales that can
     be found in the map @p locale_conf. Also always enables en_US.UTF-8.
+
+    Returns a list of (locale, charmap) pairs, one for each line
+    (enabled or not) in the file that is for one of those locales.
     """
     en_us_locale = 'en_US.UTF-8'
 
@@ -80,6 +83,7 @@ def rewrite_locale_gen(srcfilename, destfilename, locale_conf):
 
     enabled_locales = {}
     seen_locales = set()
+    selected_locales = []
 
     # Write source out again, enabling some
     with open(destfilename, "w") as gen:
@@ -95,6 +99,13 @@ def rewrite_locale_gen(srcfilename, destfilename, locale_conf):
                 for locale_value in locale_values:
                     if locale.startswith(locale_value):
                         enabled_locales[locale] = uncommented
+            if locale and any(locale.startswith(v) for v in locale_values):
+                # The charmap is the second word; a line without one is
+                # copied, but there is nothing to compile for it.
+                words = RE_TRAILING_COMMENT.sub("", uncommented).split()
+                pair = (locale, words[1]) if len(words) > 1 else None
+                if pair and pair not in selected_locales:
+                    selected_locales.append(pair)
             gen.write(line)
 
         gen.write("\n###\n#\n# Locales enabled by Calamares\n")
@@ -107,6 +118,75 @@ def rewrite_locale_gen(srcfilename, destfilename, locale_conf):
             if locale not in seen_locales:
                 gen.write("# Missing: %s\n" % locale)
 
+    return selected_locales
+
+
+def normalized_locale(locale):
+    """
+    Returns the name that glibc uses for @p locale in the locale
+    archive: the codeset is lower-cased without punctuation, so
+    "de_DE.UTF-8" becomes "de_DE.utf8".
+    """
+    m = re.match("^([^.@]*)(?:\\.([^@]*))?(@.*)?$", locale)
+    if not m or not m.group(2):
+        return locale
+    codeset = re.sub("[^a-z0-9]", "", m.group(2).lower())
+    if codeset.isdigit():
+        codeset = "iso" + codeset
+    return m.group(1) + "." + codeset + (m.group(3) or "")
+
+
+def compiled_locales(install_path):
+    """
+    Returns the set of (normalized) locale names that are already
+    compiled in the target system, in the locale archive or as
+    a directory of their own.
+    """
+    compiled = set()
+    try:
+        archive = libcalamares.utils.check_target_env_output(["localedef", "--list-archive"])
+        compiled.update(l.strip() for l in archive.splitlines() if l.strip())
+    except Exception as e:
+        libcalamares.utils.debug("Cannot list the locale archive: {!s}".format(e))
+    locale_dir = os.path.join(install_path, "usr/lib/locale")
+    if os.path.isdir(locale_dir):
+        for name in os.listdir(locale_dir):
+            if os.path.exists(os.path.join(locale_dir, name, "LC_CTYPE")):
+                compiled.add(name)
+    return compiled
+
+
+def compile_selected_locales(install_path, selected_locales):
+    """
+    Compiles the @p selected_locales, (locale, charmap) pairs as
+    returned by rewrite_locale_gen(), with localedef in the target
+    system; the locales are compiled at the same time.
+    Those that are already compiled (e.g. because the live image
+    has them) are skipped.
+
+    Returns False if any of them failed, in which case locale-gen
+    should be run instead.
+    """
+    compiled = compiled_locales(install_path)
+    missing = [(l, c) for l, c in selected_locales if normalized_locale(l) not in compiled]
+    if not missing:
+        libcalamares.utils.debug("All {!s} selected locales are already compiled".format(len(selected_locales)))
+        return True
+
+    commands = []
+    for locale, charmap in missing:
+        # The input file is the locale without its codeset
+        # (but with its modifier), like locale-gen does.
+        input_name = re.sub("\\.[^@]*", "", locale)
+        commands.append(["localedef", "-i", input_name, "-f", charmap, locale])
+    exit_codes = libcalamares.utils.target_env_call_batch(commands)
+    failed = [l for (l, _c), ec in zip(missing, exit_codes) if ec != 0]
+    if failed:
+        libcalamares.utils.warning("Cannot compile locales {!s}".format(", ".join(failed)))
+        return False
+    libcalamares.utils.debug("Compiled locales {!s}".format(", ".join(l for l, _c in missing)))
+    return True
+
 
 def run():
     """ Create locale """
@@ -150,8 +230,12 @@ def run():
     # if the live system has locale.gen, but the target does not:
     # in that case, fix your installation filesystem.
     if os.path.exists('/etc/locale.gen'):
-        rewrite_locale_gen(target_locale_gen, target_locale_gen, locale_conf)
-        libcalamares.utils.target_env_call(['locale-gen'])
+        selected_locales = rewrite_locale_gen(target_locale_gen, target_locale_gen, locale_conf)
+        if libcalamares.job.configuration.get("localeGen", "locale-gen") == "selected" and selected_locales:
+            if not compile_selected_locales(install_path, selected_locales):
+                libcalamares.utils.target_env_call(['locale-gen'])
+        else:
+            libcalamares.utils.target_env_call(['locale-gen'])
         libcalamares.utils.debug('{!s} done'.format(target_locale_gen))
 
     # write /etc/locale.conf
@@ -27,6 +27,10 @@ Column {
     property var cityName: ""
     property var countryName: ""
 
+    // Pre-rendered tiles (see *map* in localeq.conf) mean the map
+    //   does not need the network at all.
+    readonly property bool offlineTiles: config.mapTilesDirectory !== ""
+
     /* This is an extra GeoIP lookup, which will find better-accuracy
      * location data for the user's IP, and then sets the current timezone
      * and map location. Call it from Component.onCompleted so that
@@ -61,8 +65,18 @@ Column {
      * so it happens as the page is shown.
      */
     function getIpOffline() {
-        cityName = config.currentLocation.zone
-        countryName = config.currentLocation.countryCode
+        var location = config.currentLocation
+        if (!location) {
+            // Nothing figured out (yet), so keep the default view
+            return
+        }
+        if (offlineTiles) {
+            // No geocoding without the network; zone.tab has the location
+            map.center = QtPositioning.coordinate(location.latitude, location.longitude)
+            return
+        }
+        cityName = location.zone
+        countryName = location.countryCode
     }
 
     /* This is an **accurate** TZ lookup method: it queries an
@@ -94,7 +108,8 @@ Column {
     }
 
     /* This is a quick TZ lookup method: it uses the existing
-     * Calamares "closest TZ" code, which has lots of caveats.
+     * Calamares "closest TZ" code, which finds the nearest zone.tab
+     * location through a spatial index, without the network.
      *
      * See below, in MouseArea, for calling the right method.
      */
@@ -115,13 +130,26 @@ Column {
             name: "esri" // "esri", "here", "itemsoverlay", "mapbox", "mapboxgl",  "osm"
         }
 
+        /* The osm plugin reads tiles from the offline directory before
+         * it asks the network for them; with the providers repository
+         * disabled it does not go online to find out the tile servers.
+         */
+        Plugin {
+            id: offlinePlugin
+            name: "osm"
+            PluginParameter { name: "osm.mapping.offline.directory"; value: config.mapTilesDirectory }
+            PluginParameter { name: "osm.mapping.providersrepository.disabled"; value: true }
+            PluginParameter { name: "osm.mapping.cache.disk.size"; value: 0 }
+        }
+
         Map {
             id: map
             anchors.fill: parent
-            plugin: mapPlugin
+            plugin: offlineTiles ? offlinePlugin : mapPlugin
             activeMapType: supportedMapTypes[0]
-            //might be desirable to set zoom level configurable?
-            zoomLevel: 5
+            // Beyond the offline tiles there is nothing to show
+            maximumZoomLevel: config.mapMaximumZoom
+            zoomLevel: Math.min(5, config.mapMaximumZoom)
             bearing: 0
             tilt: 0
             copyrightsVisible : true
@@ -130,7 +158,7 @@ Column {
             GeocodeModel {
                 id: geocodeModel
                 plugin: mapPlugin
-                autoUpdate: true
+                autoUpdate: !offlineTiles
                 query: Address {
                     id: address
                     city: cityName
@@ -25,7 +25,7 @@ Page {
          * lookup or configuration, call the update function
          * here, and disable the one at onCompleted in Map.qml.
          */
-        if (Network.hasInternet) { image.item.getIpOffline() }
+        if (Network.hasInternet || config.mapTilesDirectory !== "") { image.item.getIpOffline() }
     }
 
     Loader {
@@ -34,7 +34,8 @@ Page {
         width: parent.width
         height: parent.height / 1.28
         // Network is in io.calamares.core
-        source: Network.hasInternet ? "Map.qml" : "Offline.qml"
+        // With pre-rendered tiles, the map works without it
+        source: (Network.hasInternet || config.mapTilesDirectory !== "") ? "Map.qml" : "Offline.qml"
     }
 
     RowLayout {
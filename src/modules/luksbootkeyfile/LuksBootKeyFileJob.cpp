@@ -8,6 +8,8 @@
 #include "LuksBootKeyFileJob.h"
 
 #include "utils/CalamaresUtilsSystem.h"
+#include "utils/Entropy.h"
+#include "utils/Executor.h"
 #include "utils/Logger.h"
 #include "utils/UMask.h"
 #include "utils/Variant.h"
@@ -15,12 +17,17 @@
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 
-LuksBootKeyFileJob::LuksBootKeyFileJob( QObject* parent )
-    : Calamares::CppJob( parent )
-{
-}
+#include <QFuture>
+#include <QMutex>
+#include <QMutexLocker>
 
-LuksBootKeyFileJob::~LuksBootKeyFileJob() {}
+#include <algorithm>
+
+#ifdef HAVE_LIBCRYPTSETUP
+#include <libcryptsetup.h>
+
+#include <memory>
+#endif
 
 QString
 LuksBootKeyFileJob::prettyName() const
@@ -97,26 +104,206 @@ struct LuksDeviceList
 };
 
 static const char keyfile[] = "/crypto_keyfile.bin";
+static constexpr const int keyfileSize = 2048;
 
+/** @brief Writes a new random key to the keyfile in the target system
+ *
+ * The key is also returned in @p key.
+ */
 static bool
-generateTargetKeyfile()
+generateTargetKeyfile( QByteArray& key )
 {
+    if ( CalamaresUtils::getEntropy( keyfileSize, key ) != CalamaresUtils::EntropySource::URandom )
+    {
+        cWarning() << "Could not get random data for the LUKS keyfile.";
+        return false;
+    }
+
     CalamaresUtils::UMask m( CalamaresUtils::UMask::Safe );
-    auto r = CalamaresUtils::System::instance()->targetEnvCommand(
-        { "dd", "bs=512", "count=4", "if=/dev/urandom", QString( "of=%1" ).arg( keyfile ) } );
-    if ( r.getExitCode() != 0 )
+    auto r = CalamaresUtils::System::instance()->createTargetFile(
+        keyfile, key, CalamaresUtils::System::WriteMode::Overwrite );
+    if ( !r )
     {
-        cWarning() << "Could not create LUKS keyfile:" << r.getOutput() << "(exit code" << r.getExitCode() << ')';
+        cWarning() << "Could not create LUKS keyfile" << keyfile << "in the target system.";
         return false;
     }
-    // Give ample time to check that the file was created correctly
-    r = CalamaresUtils::System::instance()->targetEnvCommand( { "ls", "-la", "/" } );
-    cDebug() << "In target system after creating LUKS file" << r.getOutput();
+    cDebug() << "Created LUKS keyfile" << r.path();
     return true;
 }
 
+/** @brief Key-derivation settings, to re-use for the other devices
+ *
+ * Benchmarking the key derivation (e.g. argon2) is a large part of
+ * adding a key, and the outcome is the same for each device on this
+ * machine. The benchmark is done once, in the background, as soon as
+ * the partitions with LUKS are known; the settings from the key slot added to the first
+ * device are used for the others (of the same LUKS version).
+ */
+struct KeyDerivation
+{
+#ifdef HAVE_LIBCRYPTSETUP
+    bool isValid = false;
+    QByteArray deviceType;  ///< LUKS1 or LUKS2
+    QByteArray type;
+    QByteArray hash;
+    struct crypt_pbkdf_type pbkdf = {};
+#endif
+};
+
+using KeyDerivationList = QList< KeyDerivation >;
+
+static QMutex s_benchmarkMutex;
+/// @brief The benchmark, once it is started (guarded by s_benchmarkMutex)
+static QFuture< KeyDerivationList > s_benchmark;
+static bool s_benchmarkStarted = false;
+
+/// @brief Waits for the benchmark, if it was started, and returns its results
+static KeyDerivationList
+benchmarkedKeyDerivations()
+{
+    QFuture< KeyDerivationList > benchmark;
+    {
+        QMutexLocker lock( &s_benchmarkMutex );
+        benchmark = s_benchmark;
+    }
+    benchmark.waitForFinished();
+    return benchmark.isCanceled() || benchmark.resultCount() < 1 ? KeyDerivationList() : benchmark.result();
+}
+
+#ifdef HAVE_LIBCRYPTSETUP
+/** @brief Benchmarks the default key derivation for @p deviceType
+ *
+ * This does the benchmark that adding a key slot to a device of that
+ * type (LUKS1 or LUKS2) would do, but without a device.
+ */
+static KeyDerivation
+benchmarkKeyDerivation( const char* deviceType )
+{
+    KeyDerivation k;
+    const struct crypt_pbkdf_type* defaults = crypt_get_pbkdf_default( deviceType );
+    struct crypt_device* cdp = nullptr;
+    if ( !defaults || crypt_init( &cdp, nullptr ) < 0 )
+    {
+        return k;
+    }
+    std::unique_ptr< struct crypt_device, decltype( &crypt_free ) > cd( cdp, &crypt_free );
+
+    // Only the time it takes matters, not the password or salt
+    static const char password[] = "calamares";
+    static const char salt[ 32 ] = {};
+    // The volume key of the default cipher, aes-xts-plain64, is 512 bits
+    static constexpr const size_t volumeKeySize = 64;
+    struct crypt_pbkdf_type pbkdf = *defaults;
+    const int r = crypt_benchmark_pbkdf(
+        cd.get(), &pbkdf, password, sizeof( password ) - 1, salt, sizeof( salt ), volumeKeySize, nullptr, nullptr );
+    if ( r < 0 )
+    {
+        cDebug() << "Could not benchmark key derivation for" << deviceType << "(error" << r << ')';
+        return k;
+    }
+
+    k.isValid = true;
+    k.deviceType = QByteArray( deviceType );
+    k.type = QByteArray( pbkdf.type );
+    k.hash = pbkdf.hash ? QByteArray( pbkdf.hash ) : QByteArray();
+    k.pbkdf = pbkdf;
+    return k;
+}
+
+/** @brief Starts the benchmark, once, if @p partitions has LUKS devices
+ *
+ * The benchmark takes a lot of CPU and memory (argon2), so it is only
+ * done for an installation with encryption.
+ */
+static void
+startBenchmark( const QVariant& partitions )
+{
+    QMutexLocker lock( &s_benchmarkMutex );
+    if ( s_benchmarkStarted )
+    {
+        return;
+    }
+    const LuksDeviceList s( partitions );
+    if ( !s.valid || s.devices.isEmpty() )
+    {
+        return;
+    }
+    s_benchmarkStarted = true;
+    s_benchmark = CalamaresUtils::Executor::run(
+        CalamaresUtils::Executor::Lane::Background, "luksbootkeyfile-benchmark", []() {
+            return KeyDerivationList { benchmarkKeyDerivation( CRYPT_LUKS2 ), benchmarkKeyDerivation( CRYPT_LUKS1 ) };
+        } );
+}
+
+/** @brief Adds @p key to a key slot of device @p d, unlocking it with the passphrase
+ *
+ * The first valid settings in @p reuse for the same LUKS version are
+ * used without benchmarking. If @p used is not nullptr, it
+ * receives the settings of the new key slot.
+ */
+static bool
+setupLuks( const LuksDevice& d, const QByteArray& key, const KeyDerivationList& reuse, KeyDerivation* used )
+{
+    struct crypt_device* cdp = nullptr;
+    int r = crypt_init( &cdp, d.device.toLocal8Bit().constData() );
+    if ( r < 0 )
+    {
+        cWarning() << "Could not open LUKS device" << d.device << "(error" << r << ')';
+        return false;
+    }
+    std::unique_ptr< struct crypt_device, decltype( &crypt_free ) > cd( cdp, &crypt_free );
+
+    r = crypt_load( cd.get(), CRYPT_LUKS, nullptr );
+    if ( r < 0 )
+    {
+        cWarning() << "Could not read LUKS header of" << d.device << "(error" << r << ')';
+        return false;
+    }
+
+    const QByteArray deviceType( crypt_get_type( cd.get() ) );
+    auto reusable = std::find_if( reuse.cbegin(), reuse.cend(), [&deviceType]( const KeyDerivation& k ) {
+        return k.isValid && k.deviceType == deviceType;
+    } );
+    if ( reusable != reuse.cend() )
+    {
+        struct crypt_pbkdf_type pbkdf = reusable->pbkdf;
+        pbkdf.type = reusable->type.constData();
+        pbkdf.hash = reusable->hash.isEmpty() ? nullptr : reusable->hash.constData();
+        pbkdf.flags |= CRYPT_PBKDF_NO_BENCHMARK;
+        if ( crypt_set_pbkdf_type( cd.get(), &pbkdf ) < 0 )
+        {
+            cDebug() << Logger::SubEntry << "Could not re-use key derivation settings for" << d.device;
+        }
+    }
+
+    QByteArray passphrase = d.passphrase.toUtf8();
+    const int slot = crypt_keyslot_add_by_passphrase( cd.get(),
+                                                      CRYPT_ANY_SLOT,
+                                                      passphrase.constData(),
+                                                      size_t( passphrase.size() ),
+                                                      key.constData(),
+                                                      size_t( key.size() ) );
+    passphrase.fill( '\0' );
+    if ( slot < 0 )
+    {
+        cWarning() << "Could not configure LUKS keyfile on" << d.device << "(error" << slot << ')';
+        return false;
+    }
+
+    struct crypt_pbkdf_type pbkdf = {};
+    if ( used && crypt_keyslot_get_pbkdf( cd.get(), slot, &pbkdf ) == 0 )
+    {
+        used->isValid = true;
+        used->deviceType = deviceType;
+        used->type = QByteArray( pbkdf.type );
+        used->hash = pbkdf.hash ? QByteArray( pbkdf.hash ) : QByteArray();
+        used->pbkdf = pbkdf;
+    }
+    return true;
+}
+#else
 static bool
-setupLuks( const LuksDevice& d )
+setupLuks( const LuksDevice& d, const QByteArray&, const KeyDerivationList&, KeyDerivation* )
 {
     auto r = CalamaresUtils::System::instance()->targetEnvCommand(
         { "cryptsetup", "luksAddKey", d.device, keyfile }, QString(), d.passphrase, std::chrono::seconds( 15 ) );
@@ -128,6 +315,34 @@ setupLuks( const LuksDevice& d )
     }
     return true;
 }
+#endif
+
+LuksBootKeyFileJob::LuksBootKeyFileJob( QObject* parent )
+    : Calamares::CppJob( parent )
+{
+#ifdef HAVE_LIBCRYPTSETUP
+    // The partitions are stored by the partition module's jobs, early in
+    // the installation; the benchmark then runs while other jobs (e.g.
+    // unpacking the image) do, and is done when this job needs it.
+    auto* gs = Calamares::JobQueue::instance() ? Calamares::JobQueue::instance()->globalStorage() : nullptr;
+    if ( gs )
+    {
+        connect(
+            gs,
+            &Calamares::GlobalStorage::keyChanged,
+            this,
+            [ gs ]( const QString& key ) {
+                if ( key == QStringLiteral( "partitions" ) )
+                {
+                    startBenchmark( gs->value( key ) );
+                }
+            },
+            Qt::DirectConnection );
+    }
+#endif
+}
+
+LuksBootKeyFileJob::~LuksBootKeyFileJob() {}
 
 static QVariantList
 partitions()
@@ -212,21 +427,47 @@ LuksBootKeyFileJob::exec()
             tr( "Root partition %1 is LUKS but no passphrase has been set." ).arg( s.devices.first().device ) );
     }
 
-    if ( !generateTargetKeyfile() )
+    QByteArray key;
+    if ( !generateTargetKeyfile( key ) )
     {
         return Calamares::JobResult::error(
             tr( "Encrypted rootfs setup error" ),
             tr( "Could not create LUKS key file for root partition %1." ).arg( s.devices.first().device ) );
     }
 
-    for ( const auto& d : s.devices )
+    // The root device goes first, then the others, with the key-derivation
+    // settings from the root device. They are done one after the other:
+    // each key derivation may take a lot of memory (argon2), and
+    // libcryptsetup is not safe to use from several threads at once.
+    const KeyDerivationList benchmarked = benchmarkedKeyDerivations();
+    KeyDerivation rootKeyDerivation;
+    const auto& root = s.devices.first();
+    if ( !setupLuks( root, key, benchmarked, &rootKeyDerivation ) )
     {
-        if ( !setupLuks( d ) )
-            return Calamares::JobResult::error(
-                tr( "Encrypted rootfs setup error" ),
-                tr( "Could not configure LUKS key file on partition %1." ).arg( d.device ) );
+        return Calamares::JobResult::error(
+            tr( "Encrypted rootfs setup error" ),
+            tr( "Could not configure LUKS key file on partition %1." ).arg( root.device ) );
     }
 
+    const KeyDerivationList reuse = KeyDerivationList { rootKeyDerivation } + benchmarked;
+    QString failedDevice;
+    for ( int i = 1; i < s.devices.count(); ++i )
+    {
+        const LuksDevice& d = s.devices.at( i );
+        if ( !setupLuks( d, key, reuse, nullptr ) )
+        {
+            failedDevice = d.device;
+            break;
+        }
+    }
+    key.fill( '\0' );
+
+    if ( !failedDevice.isEmpty() )
+    {
+        return Calamares::JobResult::error(
+            tr( "Encrypted rootfs setup error" ),
+            tr( "Could not configure LUKS key file on partition %1." ).arg( failedDevice ) );
+    }
     return Calamares::JobResult::ok();
 }
 
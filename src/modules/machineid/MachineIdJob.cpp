@@ -11,11 +11,11 @@
  */
 
 #include "MachineIdJob.h"
+#include "MachineIdSchema.h"
 #include "Workers.h"
 
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/Logger.h"
-#include "utils/Variant.h"
 
 #include "GlobalStorage.h"
 #include "JobQueue.h"
@@ -135,16 +135,22 @@ MachineIdJob::exec()
 void
 MachineIdJob::setConfigurationMap( const QVariantMap& map )
 {
-    m_systemd = CalamaresUtils::getBool( map, "systemd", false );
+    MachineIdSchema config;
+    if ( !config.load( map ) )
+    {
+        cWarning() << "MachineId: configuration does not match the schema.";
+    }
+
+    m_systemd = config.systemd;
 
-    m_dbus = CalamaresUtils::getBool( map, "dbus", false );
-    if ( map.contains( "dbus-symlink" ) )
+    m_dbus = config.dbus;
+    if ( config.hasDbusSymlink )
     {
-        m_dbus_symlink = CalamaresUtils::getBool( map, "dbus-symlink", false );
+        m_dbus_symlink = config.dbusSymlink;
     }
-    else if ( map.contains( "symlink" ) )
+    else if ( config.hasSymlink )
     {
-        m_dbus_symlink = CalamaresUtils::getBool( map, "symlink", false );
+        m_dbus_symlink = config.symlink;
         cWarning() << "MachineId: configuration setting *symlink* is deprecated, use *dbus-symlink*.";
     }
     // else it's still false from the constructor
@@ -152,9 +158,9 @@ MachineIdJob::setConfigurationMap( const QVariantMap& map )
     // ignore it, though, if dbus is false
     m_dbus_symlink = m_dbus && m_dbus_symlink;
 
-    m_entropy_copy = CalamaresUtils::getBool( map, "entropy-copy", false );
-    m_entropy_files = CalamaresUtils::getStringList( map, "entropy-files" );
-    if ( CalamaresUtils::getBool( map, "entropy", false ) )
+    m_entropy_copy = config.entropyCopy;
+    m_entropy_files = config.entropyFiles;
+    if ( config.entropy )
     {
         cWarning() << "MachineId:: configuration setting *entropy* is deprecated, use *entropy-files* instead.";
         m_entropy_files.append( QStringLiteral( "/var/lib/urandom/random-seed" ) );
@@ -0,0 +1,161 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2020 Adriaan de Groot <groot@kde.org>
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+/* Generated by ci/schemaconfig.py from machineid.schema.yaml as MachineIdSchema
+ *
+ * Do not edit this file: edit the schema and run the script again.
+ */
+
+#ifndef MACHINEID_MACHINEIDSCHEMA_H
+#define MACHINEID_MACHINEIDSCHEMA_H
+
+#include "utils/Logger.h"
+
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <QVariantMap>
+
+struct MachineIdSchema
+{
+    bool systemd = false;
+    bool dbus = false;
+    bool dbusSymlink = false;
+    bool entropyCopy = false;
+    QStringList entropyFiles;
+    bool symlink = false;
+    bool entropy = false;
+
+    bool hasSystemd = false;
+    bool hasDbus = false;
+    bool hasDbusSymlink = false;
+    bool hasEntropyCopy = false;
+    bool hasEntropyFiles = false;
+    bool hasSymlink = false;
+    bool hasEntropy = false;
+
+    /** @brief Reads the configuration from @p map in a single pass
+     *
+     * Values of the wrong type are ignored, so the member keeps its default.
+     * Returns @c false (after logging a warning) if there are values of
+     * the wrong type, unknown keys, or missing required keys.
+     */
+    bool load( const QVariantMap& map );
+};
+
+inline bool
+MachineIdSchema::load( const QVariantMap& map )
+{
+    bool ok = true;
+    for ( auto it = map.cbegin(); it != map.cend(); ++it )
+    {
+        const QString& key = it.key();
+        const QVariant& v = it.value();
+        if ( key == QLatin1String( "systemd" ) )
+        {
+            if ( v.type() == QVariant::Bool )
+            {
+                systemd = v.toBool();
+                hasSystemd = true;
+            }
+            else
+            {
+                cWarning() << "Configuration key" << key << "should be of type boolean.";
+                ok = false;
+            }
+        }
+        else if ( key == QLatin1String( "dbus" ) )
+        {
+            if ( v.type() == QVariant::Bool )
+            {
+                dbus = v.toBool();
+                hasDbus = true;
+            }
+            else
+            {
+                cWarning() << "Configuration key" << key << "should be of type boolean.";
+                ok = false;
+            }
+        }
+        else if ( key == QLatin1String( "dbus-symlink" ) )
+        {
+            if ( v.type() == QVariant::Bool )
+            {
+                dbusSymlink = v.toBool();
+                hasDbusSymlink = true;
+            }
+            else
+            {
+                cWarning() << "Configuration key" << key << "should be of type boolean.";
+                ok = false;
+            }
+        }
+        else if ( key == QLatin1String( "entropy-copy" ) )
+        {
+            if ( v.type() == QVariant::Bool )
+            {
+                entropyCopy = v.toBool();
+                hasEntropyCopy = true;
+            }
+            else
+            {
+                cWarning() << "Configuration key" << key << "should be of type boolean.";
+                ok = false;
+            }
+        }
+        else if ( key == QLatin1String( "entropy-files" ) )
+        {
+            if ( v.canConvert( QMetaType::QStringList ) )
+            {
+                entropyFiles = v.toStringList();
+                hasEntropyFiles = true;
+            }
+            else
+            {
+                cWarning() << "Configuration key" << key << "should be of type array.";
+                ok = false;
+            }
+        }
+        else if ( key == QLatin1String( "symlink" ) )
+        {
+            if ( v.type() == QVariant::Bool )
+            {
+                symlink = v.toBool();
+                hasSymlink = true;
+            }
+            else
+            {
+                cWarning() << "Configuration key" << key << "should be of type boolean.";
+                ok = false;
+            }
+        }
+        else if ( key == QLatin1String( "entropy" ) )
+        {
+            if ( v.type() == QVariant::Bool )
+            {
+                entropy = v.toBool();
+                hasEntropy = true;
+            }
+            else
+            {
+                cWarning() << "Configuration key" << key << "should be of type boolean.";
+                ok = false;
+            }
+        }
+        else
+        {
+            cWarning() << "Unknown configuration key" << key;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+#endif
@@ -12,8 +12,8 @@
 
 #include "Workers.h"
 
-#include "utils/CalamaresUtilsSystem.h"
 #include "utils/Entropy.h"
+#include "utils/FileCopy.h"
 #include "utils/Logger.h"
 
 #include <QFile>
@@ -71,7 +71,7 @@ copyFile( const QString& rootMountPoint, const QString& fileName )
     {
         return Calamares::JobResult::error( QObject::tr( "File not found" ), fileName );
     }
-    if ( !f.copy( rootMountPoint + fileName ) )
+    if ( !CalamaresUtils::copyFile( fileName, rootMountPoint + fileName ) )
     {
         return Calamares::JobResult::error( QObject::tr( "File not found" ), rootMountPoint + fileName );
     }
@@ -141,39 +141,62 @@ createEntropy( const EntropyGeneration kind, const QString& rootMountPoint, cons
     return createNewEntropy( poolSize, rootMountPoint, fileName );
 }
 
+/** @brief Writes a new random machine-id to @p fileName in the target system
+ *
+ * The format is the one from systemd-machine-id-setup and dbus-uuidgen:
+ * 32 lowercase hex digits and a newline. Like systemd, the random bits
+ * are marked as a version-4 UUID. This avoids starting a process in
+ * the target system for each id.
+ */
 static Calamares::JobResult
-runCmd( const QStringList& cmd )
+writeMachineId( const QString& rootMountPoint, const QString& fileName )
 {
-    auto r = CalamaresUtils::System::instance()->targetEnvCommand( cmd );
-    if ( r.getExitCode() )
+    QByteArray id;
+    CalamaresUtils::EntropySource source = CalamaresUtils::getEntropy( 16, id );
+    if ( source != CalamaresUtils::EntropySource::URandom )
     {
-        return r.explainProcess( cmd, std::chrono::seconds( 0 ) );
+        cWarning() << "Entropy data for machine-id is low-quality.";
     }
+    id[ 6 ] = char( ( id.at( 6 ) & 0x0f ) | 0x40 );
+    id[ 8 ] = char( ( id.at( 8 ) & 0x3f ) | 0x80 );
 
+    QFile f( rootMountPoint + fileName );
+    if ( !f.open( QIODevice::WriteOnly | QIODevice::Truncate ) || f.write( id.toHex() + '\n' ) != 33 )
+    {
+        return Calamares::JobResult::error(
+            QObject::tr( "File not found" ),
+            QObject::tr( "Could not create machine-id file <pre>%1</pre>." ).arg( fileName ) );
+    }
+    f.close();
+    f.setPermissions( QFile::ReadOwner | QFile::ReadGroup | QFile::ReadOther );
     return Calamares::JobResult::ok();
 }
 
 Calamares::JobResult
 createSystemdMachineId( const QString& rootMountPoint, const QString& fileName )
 {
-    Q_UNUSED( rootMountPoint )
-    Q_UNUSED( fileName )
-    return runCmd( QStringList { QStringLiteral( "systemd-machine-id-setup" ) } );
+    return writeMachineId( rootMountPoint, fileName );
 }
 
 Calamares::JobResult
 createDBusMachineId( const QString& rootMountPoint, const QString& fileName )
 {
-    Q_UNUSED( rootMountPoint )
-    Q_UNUSED( fileName )
-    return runCmd( QStringList { QStringLiteral( "dbus-uuidgen" ), QStringLiteral( "--ensure" ) } );
+    return writeMachineId( rootMountPoint, fileName );
 }
 
 Calamares::JobResult
 createDBusLink( const QString& rootMountPoint, const QString& fileName, const QString& systemdFileName )
 {
-    Q_UNUSED( rootMountPoint )
-    return runCmd( QStringList { QStringLiteral( "ln" ), QStringLiteral( "-sf" ), systemdFileName, fileName } );
+    // Like ln -sf, replace whatever is there; the link is relative to the target's root
+    const QString linkName = rootMountPoint + fileName;
+    QFile::remove( linkName );
+    if ( !QFile::link( systemdFileName, linkName ) )
+    {
+        return Calamares::JobResult::error(
+            QObject::tr( "File not found" ),
+            QObject::tr( "Could not link <pre>%1</pre> to <pre>%2</pre>." ).arg( fileName, systemdFileName ) );
+    }
+    return Calamares::JobResult::ok();
 }
 
 }  // namespace MachineId
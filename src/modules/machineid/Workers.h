@@ -49,7 +49,8 @@ createEntropy( const EntropyGeneration kind, const QString& rootMountPoint, cons
 
 /** @brief MachineID functions
  *
- * Creating UUIDs for DBUS and SystemD.
+ * Creating UUIDs for DBUS and SystemD. These are written directly,
+ * rather than by running the tools for it in the target system.
  */
 
 /// @brief Create a new DBus UUID file
@@ -59,6 +60,7 @@ Calamares::JobResult createDBusMachineId( const QString& rootMountPoint, const Q
 Calamares::JobResult
 createDBusLink( const QString& rootMountPoint, const QString& fileName, const QString& systemdFileName );
 
+/// @brief Create a new systemd machine-id file
 Calamares::JobResult createSystemdMachineId( const QString& rootMountPoint, const QString& fileName );
 
 
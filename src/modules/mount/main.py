@@ -13,9 +13,12 @@
 #   Calamares is Free Software: see the License-Identifier above.
 #
 
-import tempfile
-import subprocess
+import concurrent.futures
+import fcntl
 import os
+import struct
+import subprocess
+import tempfile
 
 import libcalamares
 
@@ -61,9 +64,87 @@ def get_btrfs_subvolumes(partitions):
     return btrfs_subvolumes
 
 
-def mount_partition(root_mount_point, partition, partitions):
+# From linux/btrfs.h: _IOW(BTRFS_IOCTL_MAGIC, 14, struct btrfs_ioctl_vol_args),
+# where the struct is a 64-bit fd followed by a 4088-byte name.
+BTRFS_IOC_SUBVOL_CREATE = 0x5000940E
+BTRFS_PATH_NAME_MAX = 4087
+
+
+def create_btrfs_subvolumes(root_mount_point, subvolumes):
+    """
+    Create the @p subvolumes (paths relative to @p root_mount_point,
+    where the top level of the btrfs filesystem is mounted). They are
+    created with the ioctl that `btrfs subvolume create` uses, without
+    starting a process for each. Any that cannot be created that way
+    (e.g. very old kernels) are created with one call to the btrfs tool.
+    """
+    remaining = []
+    for s in subvolumes:
+        path = root_mount_point + s['subvolume']
+        parent, name = os.path.split(path.rstrip("/"))
+        name = name.encode("utf-8")
+        if not name or len(name) > BTRFS_PATH_NAME_MAX:
+            remaining.append(path)
+            continue
+        try:
+            fd = os.open(parent, os.O_RDONLY | os.O_DIRECTORY)
+            try:
+                fcntl.ioctl(fd, BTRFS_IOC_SUBVOL_CREATE, struct.pack("q4088s", 0, name))
+            finally:
+                os.close(fd)
+        except OSError as e:
+            libcalamares.utils.debug("Cannot create subvolume {!s} directly: {!s}".format(path, e))
+            remaining.append(path)
+    if remaining:
+        subprocess.check_call(['btrfs', 'subvolume', 'create'] + remaining)
+
+
+def btrfs_subvolume_mounts(root_mount_point, partition, partitions):
+    """
+    Creates the btrfs subvolumes on the root @p partition, and returns
+    partition-like entries to mount each of them. The top level of the
+    filesystem is mounted once to create all of the subvolumes.
+    """
+    btrfs_subvolumes = get_btrfs_subvolumes(partitions)
+
+    # Store created list in global storage so it can be used in the fstab module
+    libcalamares.globalstorage.insert("btrfsSubvolumes", btrfs_subvolumes)
+
+    mount_partition(root_mount_point, partition)
+    try:
+        create_btrfs_subvolumes(root_mount_point, btrfs_subvolumes)
+    finally:
+        subprocess.check_call(["umount", "-v", root_mount_point])
+
+    mounts = []
+    for s in btrfs_subvolumes:
+        subvolume = dict(partition)
+        subvolume["mountPoint"] = s["mountPoint"]
+        subvolume["options"] = with_btrfs_compression(
+            ",".join(["subvol={}".format(s['subvolume']), partition.get("options", "")]))
+        mounts.append(subvolume)
+    return mounts
+
+
+def with_btrfs_compression(options):
+    """
+    Adds the *btrfsCompression* of the job configuration to the mount
+    @p options of a btrfs filesystem, unless they set compression already.
+    Compressing while the image is unpacked writes (much) less to the
+    target disk, which matters for slow eMMC and USB disks.
+    """
+    compression = libcalamares.job.configuration.get("btrfsCompression", None)
+    if not compression or "compress" in options:
+        return options
+    return ",".join([o for o in options.split(",") if o] + ["compress={}".format(compression)])
+
+
+def mount_partition(root_mount_point, partition):
     """
     Do a single mount of @p partition inside @p root_mount_point.
+
+    This is called from worker threads (see mount_tree()), so it
+    does not touch global storage.
     """
     # Create mount point with `+` rather than `os.path.join()` because
     # `partition["mountPoint"]` starts with a '/'.
@@ -102,40 +183,68 @@ def mount_partition(root_mount_point, partition, partitions):
                                 partition.get("options", "")) != 0:
         libcalamares.utils.warning("Cannot mount {}".format(device))
 
-    # Special handling for btrfs subvolumes. Create the subvolumes listed in mount.conf
-    if fstype == "btrfs" and partition["mountPoint"] == '/':
-        # Root has been mounted to btrfs volume -> create subvolumes from configuration
-        btrfs_subvolumes = get_btrfs_subvolumes(partitions)
 
-        # Store created list in global storage so it can be used in the fstab module
-        libcalamares.globalstorage.insert("btrfsSubvolumes", btrfs_subvolumes)
-        # Create the subvolumes that are in the completed list
-        for s in btrfs_subvolumes:
-            subprocess.check_call(['btrfs', 'subvolume', 'create',
-                               root_mount_point + s['subvolume']])
+def is_below(mount_point, parent):
+    """
+    Is @p mount_point inside (or the same as) @p parent?
+    """
+    return parent == "/" or mount_point == parent or mount_point.startswith(parent + "/")
 
-        subprocess.check_call(["umount", "-v", root_mount_point])
 
-        device = partition["device"]
+class MountNode:
+    def __init__(self, partition):
+        self.partition = partition
+        self.children = []
 
-        if "luksMapperName" in partition:
-            device = os.path.join("/dev/mapper", partition["luksMapperName"])
 
-        # Mount the subvolumes
-        for s in btrfs_subvolumes:
-            mount_option = "subvol={}".format(s['subvolume'])
-            subvolume_mountpoint = mount_point[:-1] + s['mountPoint']
-            if libcalamares.utils.mount(device,
-                                    subvolume_mountpoint,
-                                    fstype,
-                                    ",".join([mount_option, partition.get("options", "")])) != 0:
-                libcalamares.utils.warning("Cannot mount {}".format(device))
+def mount_tree(partitions):
+    """
+    Returns the roots of a tree of @p partitions, where the children
+    of a node are mounted inside it. Each partition is the child of the
+    nearest one it is inside of; for a mount point that is used more
+    than once, the later entry is the child of the earlier one.
+    """
+    # Sorting by path components lists each mount point after
+    # everything it is inside of (unlike sorting the strings,
+    # which puts /home-extra between /home and /home/user).
+    ordered = sorted(partitions, key=lambda p: p["mountPoint"].rstrip("/").split("/"))
+    roots = []
+    nodes = []
+    for p in ordered:
+        node = MountNode(p)
+        parent = next((n for n in reversed(nodes) if is_below(p["mountPoint"], n.partition["mountPoint"])), None)
+        if parent:
+            parent.children.append(node)
+        else:
+            roots.append(node)
+        nodes.append(node)
+    return roots
+
+
+def mount_all(root_mount_point, partitions):
+    """
+    Mount all of @p partitions. A partition is mounted once the one it is
+    inside of is mounted; partitions that do not depend on each other
+    (e.g. /home and /var, or /proc and /sys) are mounted concurrently.
+    """
+    with concurrent.futures.ThreadPoolExecutor(max_workers=min(8, len(partitions) or 1)) as pool:
+        pending = dict()
+        for node in mount_tree(partitions):
+            pending[pool.submit(mount_partition, root_mount_point, node.partition)] = node
+        while pending:
+            done, _ = concurrent.futures.wait(pending, return_when=concurrent.futures.FIRST_COMPLETED)
+            for f in done:
+                node = pending.pop(f)
+                # Raises if the mount failed badly, like the sequential mounting did
+                f.result()
+                for child in node.children:
+                    pending[pool.submit(mount_partition, root_mount_point, child.partition)] = child
 
 
 def run():
     """
     Mount all the partitions from GlobalStorage and from the job configuration.
-    Partitions are mounted in-lexical-order of their mountPoint.
+    Partitions are mounted after the partition their mountPoint is inside of.
     """
     partitions = libcalamares.globalstorage.value("partitions")
 
@@ -155,16 +264,31 @@ def run():
     if libcalamares.globalstorage.value("firmwareType") == "efi":
         extra_mounts.extend(extra_mounts_efi)
 
-    # Add extra mounts to the partitions list and sort by mount points.
-    # This way, we ensure / is mounted before the rest, and every mount point
-    # is created on the right partition (e.g. if a partition is to be mounted
-    # under /tmp, we make sure /tmp is mounted before the partition)
-    mountable_partitions = [ p for p in partitions + extra_mounts if "mountPoint" in p and p["mountPoint"] ]
-    mountable_partitions.sort(key=lambda x: x["mountPoint"])
-    for partition in mountable_partitions:
-        mount_partition(root_mount_point, partition, partitions)
+    # Add extra mounts to the partitions list. The btrfs subvolumes replace
+    # the root partition, since they are mounted instead of it. Then
+    # mount_all() makes sure / is mounted before the rest, and every mount
+    # point is created on the right partition (e.g. if a partition is to be
+    # mounted under /tmp, we make sure /tmp is mounted before the partition)
+    mountable_partitions = []
+    for p in partitions + extra_mounts:
+        if not p.get("mountPoint", None):
+            continue
+        if p["mountPoint"] == "/" and p.get("fs", "").lower() == "btrfs":
+            mountable_partitions.extend(btrfs_subvolume_mounts(root_mount_point, p, partitions))
+        elif p.get("fs", "").lower() == "btrfs":
+            btrfs_partition = dict(p)
+            btrfs_partition["options"] = with_btrfs_compression(p.get("options", ""))
+            mountable_partitions.append(btrfs_partition)
+        else:
+            mountable_partitions.append(p)
+    mount_all(root_mount_point, mountable_partitions)
 
     libcalamares.globalstorage.insert("rootMountPoint", root_mount_point)
 
+    # The fstab module uses the same compression in the installed system
+    btrfs_compression = libcalamares.job.configuration.get("btrfsCompression", None)
+    if btrfs_compression:
+        libcalamares.globalstorage.insert("btrfsCompression", btrfs_compression)
+
     # Remember the extra mounts for the unpackfs module
     libcalamares.globalstorage.insert("extraMounts", extra_mounts)
@@ -87,7 +87,13 @@ Config::titleLabel() const
 void
 Config::loadGroupList( const QVariantList& groupData )
 {
-    m_model->setupModelData( groupData );
+    loadGroupTree( PackageTree( groupData ) );
+}
+
+void
+Config::loadGroupTree( PackageTree&& tree )
+{
+    m_model->setTree( std::move( tree ) );
     if ( m_model->rowCount() < 1 )
     {
         cWarning() << "NetInstall groups data was empty.";
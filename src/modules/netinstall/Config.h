@@ -71,6 +71,12 @@ public:
      * subgroups and packages -- from @p groupData.
      */
     void loadGroupList( const QVariantList& groupData );
+    /** @brief Fill model from an already-built tree.
+     *
+     * Like loadGroupList(), but the tree may have been built in
+     * another thread; the model takes the items from @p tree.
+     */
+    void loadGroupTree( PackageTree&& tree );
 
     /** @brief Write the selected package lists to global storage
      *
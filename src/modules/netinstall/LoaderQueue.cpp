@@ -17,8 +17,12 @@
 #include "utils/RAII.h"
 #include "utils/Yaml.h"
 
+#include <QFutureWatcher>
 #include <QNetworkReply>
 #include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <memory>
 
 /** @brief Call fetchNext() on the queue if it can
  *
@@ -78,6 +82,29 @@ LoaderQueue::LoaderQueue( Config* parent )
     : QObject( parent )
     , m_config( parent )
 {
+    m_hedgeTimer.setSingleShot( true );
+    m_hedgeTimer.setInterval( int( hedgeDelay().count() ) );
+    connect( &m_hedgeTimer, &QTimer::timeout, this, &LoaderQueue::fetchNext );
+}
+
+LoaderQueue::~LoaderQueue()
+{
+    finish();
+}
+
+void
+LoaderQueue::finish()
+{
+    m_finished = true;
+    m_hedgeTimer.stop();
+    m_queue.clear();
+    for ( auto* reply : qAsConst( m_replies ) )
+    {
+        disconnect( reply, nullptr, this, nullptr );
+        reply->abort();
+        reply->deleteLater();
+    }
+    m_replies.clear();
 }
 
 void
@@ -96,21 +123,41 @@ LoaderQueue::load()
 void
 LoaderQueue::fetchNext()
 {
+    if ( m_finished )
+    {
+        return;
+    }
     if ( m_queue.isEmpty() )
     {
-        emit done();
+        if ( !isBusy() )
+        {
+            // Everything has been tried, and failed
+            if ( m_failure != Config::Status::Ok )
+            {
+                m_config->setStatus( m_failure );
+            }
+            finish();
+            emit done();
+        }
         return;
     }
-
-    auto source = m_queue.takeFirst();
-    if ( source.isLocal() )
+    if ( m_queue.head().isLocal() )
     {
-        m_config->loadGroupList( source.data );
-        emit done();
+        // Only when everything before it has failed
+        if ( !isBusy() )
+        {
+            m_config->loadGroupList( m_queue.head().data );
+            finish();
+            emit done();
+        }
+        return;
     }
-    else
+
+    m_hedgeTimer.stop();
+    fetch( m_queue.takeFirst().url );
+    if ( !m_queue.isEmpty() && isBusy() )
     {
-        fetch( source.url );
+        m_hedgeTimer.start();
     }
 }
 
@@ -121,7 +168,7 @@ LoaderQueue::fetch( const QUrl& url )
 
     if ( !url.isValid() )
     {
-        m_config->setStatus( Config::Status::FailedBadConfiguration );
+        fail( Config::Status::FailedBadConfiguration );
         cDebug() << "Invalid URL" << url;
         return;
     }
@@ -131,67 +178,50 @@ LoaderQueue::fetch( const QUrl& url )
     cDebug() << "NetInstall loading groups from" << url;
     QNetworkReply* reply = Manager::instance().asynchronousGet(
         url,
-        RequestOptions( RequestOptions::FakeUserAgent | RequestOptions::FollowRedirect, std::chrono::seconds( 30 ) ) );
+        RequestOptions( RequestOptions::FakeUserAgent | RequestOptions::FollowRedirect | RequestOptions::AllowHttp2,
+                        std::chrono::seconds( 30 ) ) );
 
     if ( !reply )
     {
         cDebug() << Logger::SubEntry << "Request failed immediately.";
-        // If nobody sets a different status, this will remain
-        m_config->setStatus( Config::Status::FailedBadConfiguration );
+        fail( Config::Status::FailedBadConfiguration );
     }
     else
     {
-        // When the network request is done, **then** we might
-        // do the next item from the queue, so don't call fetchNext() now.
+        // When the network request is done (or takes too long), **then**
+        // we might do the next item from the queue, so don't call fetchNext() now.
         next.release();
-        m_reply = reply;
-        connect( reply, &QNetworkReply::finished, this, &LoaderQueue::dataArrived );
+        m_replies.append( reply );
+        connect( reply, &QNetworkReply::finished, this, [this, reply]() { dataArrived( reply ); } );
     }
 }
 
-void
-LoaderQueue::dataArrived()
+/** @brief Groups data parsed from a reply
+ *
+ * This is built in a worker thread by parseGroups().
+ */
+struct ParsedGroups
 {
-    FetchNextUnless next( this );
-
-    if ( !m_reply || !m_reply->isFinished() )
-    {
-        cWarning() << "NetInstall data called too early.";
-        m_config->setStatus( Config::Status::FailedInternalError );
-        return;
-    }
-
-    cDebug() << "NetInstall group data received" << m_reply->size() << "bytes from" << m_reply->url();
-
-    cqDeleter< QNetworkReply > d { m_reply };
-
-    // If m_required is *false* then we still say we're ready
-    // even if the reply is corrupt or missing.
-    if ( m_reply->error() != QNetworkReply::NoError )
-    {
-        cWarning() << "unable to fetch netinstall package lists.";
-        cDebug() << Logger::SubEntry << "Netinstall reply error: " << m_reply->error();
-        cDebug() << Logger::SubEntry << "Request for url: " << m_reply->url().toString()
-                 << " failed with: " << m_reply->errorString();
-        m_config->setStatus( Config::Status::FailedNetworkError );
-        return;
-    }
+    std::shared_ptr< PackageTree > tree;  ///< Null if the data is unusable
+    bool badData = false;  ///< Set if the data is not YAML at all
+};
 
-    QByteArray yamlData = m_reply->readAll();
+static ParsedGroups
+parseGroups( const QByteArray& yamlData )
+{
+    ParsedGroups parsed;
     try
     {
         YAML::Node groups = YAML::Load( yamlData.constData() );
 
         if ( groups.IsSequence() )
         {
-            m_config->loadGroupList( CalamaresUtils::yamlSequenceToVariant( groups ) );
-            next.done( m_config->statusCode() == Config::Status::Ok );
+            parsed.tree = std::make_shared< PackageTree >( CalamaresUtils::yamlSequenceToVariant( groups ) );
         }
         else if ( groups.IsMap() )
         {
             auto map = CalamaresUtils::yamlMapToVariant( groups );
-            m_config->loadGroupList( map.value( "groups" ).toList() );
-            next.done( m_config->statusCode() == Config::Status::Ok );
+            parsed.tree = std::make_shared< PackageTree >( map.value( "groups" ).toList() );
         }
         else
         {
@@ -201,6 +231,88 @@ LoaderQueue::dataArrived()
     catch ( YAML::Exception& e )
     {
         CalamaresUtils::explainYamlException( e, yamlData, "netinstall groups data" );
-        m_config->setStatus( Config::Status::FailedBadData );
+        parsed.badData = true;
+    }
+    return parsed;
+}
+
+bool
+LoaderQueue::accept( PackageTree&& groups )
+{
+    if ( groups.count() < 1 )
+    {
+        // Not loaded, so that the model keeps what it has
+        cWarning() << "NetInstall groups data was empty.";
+        fail( Config::Status::FailedNoData );
+        return false;
+    }
+    m_config->loadGroupTree( std::move( groups ) );
+    if ( m_config->statusCode() == Config::Status::Ok )
+    {
+        // The first valid answer wins
+        finish();
+        return true;
+    }
+    return false;
+}
+
+void
+LoaderQueue::dataArrived( QNetworkReply* reply )
+{
+    FetchNextUnless next( this );
+
+    if ( !m_replies.removeOne( reply ) || !reply->isFinished() )
+    {
+        cWarning() << "NetInstall data called too early.";
+        fail( Config::Status::FailedInternalError );
+        return;
+    }
+
+    cDebug() << "NetInstall group data received" << reply->size() << "bytes from" << reply->url();
+
+    cqDeleter< QNetworkReply > d { reply };
+
+    // If m_required is *false* then we still say we're ready
+    // even if the reply is corrupt or missing.
+    if ( reply->error() != QNetworkReply::NoError )
+    {
+        cWarning() << "unable to fetch netinstall package lists.";
+        cDebug() << Logger::SubEntry << "Netinstall reply error: " << reply->error();
+        cDebug() << Logger::SubEntry << "Request for url: " << reply->url().toString()
+                 << " failed with: " << reply->errorString();
+        fail( Config::Status::FailedNetworkError );
+        return;
+    }
+
+    // Parsing a large groups file takes a while, so that happens in a
+    // worker thread; the finished tree is loaded into the model afterwards.
+    auto* watcher = new QFutureWatcher< ParsedGroups >( this );
+    connect( watcher, &QFutureWatcher< ParsedGroups >::finished, this, [this, watcher]() {
+        watcher->deleteLater();
+        --m_parsing;
+        groupsParsed( watcher->result() );
+    } );
+    ++m_parsing;
+    watcher->setFuture( QtConcurrent::run( parseGroups, reply->readAll() ) );
+    next.release();
+}
+
+void
+LoaderQueue::groupsParsed( const ParsedGroups& groups )
+{
+    FetchNextUnless next( this );
+    if ( m_finished )
+    {
+        // Some other source was faster
+        next.release();
+        return;
+    }
+    if ( groups.badData )
+    {
+        fail( Config::Status::FailedBadData );
+    }
+    if ( groups.tree )
+    {
+        next.done( accept( std::move( *groups.tree ) ) );
     }
 }
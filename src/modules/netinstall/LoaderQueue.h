@@ -12,12 +12,20 @@
 #ifndef NETINSTALL_LOADERQUEUE_H
 #define NETINSTALL_LOADERQUEUE_H
 
+#include "Config.h"
+
+#include <QList>
+#include <QObject>
 #include <QQueue>
+#include <QTimer>
 #include <QUrl>
 #include <QVariantList>
 
-class Config;
+#include <chrono>
+
+class PackageTree;
 class QNetworkReply;
+struct ParsedGroups;
 
 /** @brief Data about an entry in *groupsUrl*
  *
@@ -47,6 +55,13 @@ struct SourceItem
  * by calling load(). This will try to load the items, in order;
  * the first one that succeeds will end the loading process.
  *
+ * URLs are not tried strictly one after the other: if a URL has
+ * not answered within hedgeDelay(), the next one is fetched as well,
+ * and the first valid answer wins (the other requests are aborted).
+ * When a request fails, the next item is started right away. Local
+ * data is only used once all the URLs before it have failed. A failure
+ * is only reported (as the status of the Config) once all have failed.
+ *
  * Signal done() is emitted when done (also when all of the items fail).
  */
 class LoaderQueue : public QObject
@@ -55,23 +70,43 @@ class LoaderQueue : public QObject
 public:
     LoaderQueue( Config* parent );
 
+    ~LoaderQueue() override;
+
     void append( SourceItem&& i );
     int count() const { return m_queue.count(); }
 
+    /// @brief How long a URL may take before the next one is also fetched
+    static constexpr std::chrono::milliseconds hedgeDelay() { return std::chrono::milliseconds( 2000 ); }
+
 public Q_SLOTS:
     void load();
 
     void fetchNext();
     void fetch( const QUrl& url );
-    void dataArrived();
+    void dataArrived( QNetworkReply* reply );
 
 Q_SIGNALS:
     void done();
 
 private:
+    /// @brief Aborts the requests still running, and empties the queue
+    void finish();
+    /// @brief Loads @p groups; if they are valid, stops loading and returns @c true
+    bool accept( PackageTree&& groups );
+    /// @brief Remembers why a source failed, for when all of them have
+    void fail( Config::Status s ) { m_failure = s; }
+    /// @brief Called (in the GUI thread) with the data from a reply, once parsed
+    void groupsParsed( const ParsedGroups& groups );
+    /// @brief Are there requests running, or replies being parsed?
+    bool isBusy() const { return !m_replies.isEmpty() || m_parsing > 0; }
+
     QQueue< SourceItem > m_queue;
     Config* m_config = nullptr;
-    QNetworkReply* m_reply = nullptr;
+    QList< QNetworkReply* > m_replies;  ///< Running requests
+    int m_parsing = 0;  ///< Replies being parsed
+    QTimer m_hedgeTimer;
+    bool m_finished = false;
+    Config::Status m_failure = Config::Status::Ok;  ///< Of the most recent source that failed
 };
 
 #endif
@@ -12,6 +12,7 @@
 
 #include "NetInstallPage.h"
 
+#include "PackageFilterModel.h"
 #include "PackageModel.h"
 #include "ui_page_netinst.h"
 
@@ -29,24 +30,35 @@ NetInstallPage::NetInstallPage( Config* c, QWidget* parent )
     : QWidget( parent )
     , m_config( c )
     , ui( new Ui::Page_NetInst )
+    , m_filter( new PackageFilterModel( c->model(), this ) )
 {
     ui->setupUi( this );
     ui->groupswidget->header()->setSectionResizeMode( QHeaderView::ResizeToContents );
-    ui->groupswidget->setModel( c->model() );
+    ui->groupswidget->setModel( m_filter );
+    connect( ui->searchEdit, &QLineEdit::textChanged, this, &NetInstallPage::search );
     connect( c, &Config::statusChanged, ui->netinst_status, &QLabel::setText );
-    connect( c, &Config::titleLabelChanged, [ui = this->ui]( const QString title ) {
-        ui->label->setVisible( !title.isEmpty() );
-        ui->label->setText( title );
-    } );
+    connect( c, &Config::titleLabelChanged, this, &NetInstallPage::setTitle );
     connect( c, &Config::statusReady, this, &NetInstallPage::expandGroups );
+
+    // The page may be created after the groups have loaded
+    ui->netinst_status->setText( c->status() );
+    setTitle( c->titleLabel() );
+    expandGroups();
 }
 
 NetInstallPage::~NetInstallPage() {}
 
+void
+NetInstallPage::setTitle( const QString& title )
+{
+    ui->label->setVisible( !title.isEmpty() );
+    ui->label->setText( title );
+}
+
 void
 NetInstallPage::expandGroups()
 {
-    auto* model = m_config->model();
+    auto* model = m_filter;
     // Go backwards because expanding a group may cause rows to appear below it
     for ( int i = model->rowCount() - 1; i >= 0; --i )
     {
@@ -58,6 +70,22 @@ NetInstallPage::expandGroups()
     }
 }
 
+void
+NetInstallPage::search( const QString& text )
+{
+    m_filter->setFilterString( text );
+    if ( m_filter->filterString().isEmpty() )
+    {
+        ui->groupswidget->collapseAll();
+        expandGroups();
+    }
+    else
+    {
+        // Matches are hard to spot in collapsed groups
+        ui->groupswidget->expandAll();
+    }
+}
+
 void
 NetInstallPage::onActivate()
 {
@@ -23,6 +23,7 @@
 
 #include <memory>
 
+class PackageFilterModel;
 class QNetworkReply;
 
 namespace Ui
@@ -47,8 +48,14 @@ public:
     void expandGroups();
 
 private:
+    /// @brief Show @p title above the groups (hidden if empty)
+    void setTitle( const QString& title );
+    /// @brief Show only the packages matching @p text, expanded
+    void search( const QString& text );
+
     Config* m_config;
     Ui::Page_NetInst* ui;
+    PackageFilterModel* m_filter;
 };
 
 #endif  // NETINSTALLPAGE_H
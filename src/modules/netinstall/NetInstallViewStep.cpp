@@ -17,7 +17,7 @@ CALAMARES_PLUGIN_FACTORY_DEFINITION( NetInstallViewStepFactory, registerPlugin<
 
 NetInstallViewStep::NetInstallViewStep( QObject* parent )
     : Calamares::ViewStep( parent )
-    , m_widget( new NetInstallPage( &m_config ) )
+    , m_widget( nullptr )
     , m_nextEnabled( false )
 {
     connect( &m_config, &Config::statusReady, this, &NetInstallViewStep::nextIsReady );
@@ -72,6 +72,10 @@ NetInstallViewStep::prettyName() const
 QWidget*
 NetInstallViewStep::widget()
 {
+    if ( !m_widget )
+    {
+        m_widget = new NetInstallPage( &m_config );
+    }
     return m_widget;
 }
 
@@ -111,10 +115,26 @@ NetInstallViewStep::jobs() const
 }
 
 
+bool
+NetInstallViewStep::releaseWidget()
+{
+    // The selected packages are in GlobalStorage already, see onLeave()
+    delete m_widget;
+    m_widget = nullptr;
+    if ( m_config.model() )
+    {
+        m_config.model()->setupModelData( QVariantList() );
+    }
+    return true;
+}
+
 void
 NetInstallViewStep::onActivate()
 {
-    m_widget->onActivate();
+    if ( m_widget )
+    {
+        m_widget->onActivate();
+    }
 }
 
 void
@@ -32,6 +32,7 @@ public:
     QString prettyName() const override;
 
     QWidget* widget() override;
+    bool hasLazyWidget() const override { return true; }
 
     bool isNextEnabled() const override;
     bool isBackEnabled() const override;
@@ -41,6 +42,8 @@ public:
 
     Calamares::JobList jobs() const override;
 
+    bool releaseWidget() override;
+
     void onActivate() override;
 
     // Leaving the page; store all selected packages for later installation.
@@ -0,0 +1,211 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "PackageFilterModel.h"
+
+#include "PackageModel.h"
+#include "PackageTreeItem.h"
+
+#include "utils/Logger.h"
+
+#include <QElapsedTimer>
+
+#include <numeric>
+
+/// @brief The trigram of three characters, starting at @p s[ @p i ]
+static inline quint64
+trigram( const QString& s, int i )
+{
+    return ( quint64( s.at( i ).unicode() ) << 32 ) | ( quint64( s.at( i + 1 ).unicode() ) << 16 )
+        | quint64( s.at( i + 2 ).unicode() );
+}
+
+PackageFilterModel::PackageFilterModel( PackageModel* source, QObject* parent )
+    : QSortFilterProxyModel( parent )
+{
+    setSourceModel( source );
+    // The items belong to the model, so forget about them before they go away
+    connect( source, &QAbstractItemModel::modelAboutToBeReset, this, &PackageFilterModel::clearIndex );
+    connect( source, &QAbstractItemModel::modelReset, this, [this]() {
+        buildIndex();
+        const QString filter = m_filter;
+        m_filter.clear();
+        setFilterString( filter );
+    } );
+    buildIndex();
+}
+
+PackageFilterModel::~PackageFilterModel() {}
+
+void
+PackageFilterModel::clearIndex()
+{
+    m_entries.clear();
+    m_trigrams.clear();
+    m_matches.clear();
+    m_matched.clear();
+    m_visible.clear();
+}
+
+void
+PackageFilterModel::buildIndex()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    clearIndex();
+    addItems( QModelIndex() );
+
+    for ( int i = 0; i < m_entries.count(); ++i )
+    {
+        const QString& text = m_entries.at( i ).text;
+        for ( int j = 0; j + 2 < text.length(); ++j )
+        {
+            auto& postings = m_trigrams[ trigram( text, j ) ];
+            // Entries are visited in order, so postings stay sorted and unique
+            if ( postings.isEmpty() || postings.last() != i )
+            {
+                postings.append( i );
+            }
+        }
+    }
+    cDebug() << "NetInstall search index has" << m_entries.count() << "items," << m_trigrams.count() << "trigrams in"
+             << timer.elapsed() << "ms";
+}
+
+void
+PackageFilterModel::addItems( const QModelIndex& parent )
+{
+    auto* model = sourceModel();
+    for ( int row = 0; row < model->rowCount( parent ); ++row )
+    {
+        const QModelIndex index = model->index( row, 0, parent );
+        const auto* item = static_cast< const PackageTreeItem* >( index.internalPointer() );
+        if ( !item )
+        {
+            continue;
+        }
+
+        const QString name = item->isPackage() ? item->packageName() : item->name();
+        m_entries.append( Entry { item, QString( name + '\n' + item->description() ).toCaseFolded() } );
+        addItems( index );
+    }
+}
+
+QVector< int >
+PackageFilterModel::indexCandidates( const QString& folded ) const
+{
+    if ( folded.length() < 3 )
+    {
+        QVector< int > all( m_entries.count() );
+        std::iota( all.begin(), all.end(), 0 );
+        return all;
+    }
+
+    // Every item containing @p folded contains all of its trigrams,
+    // so the shortest list of items for any one trigram is enough.
+    const QVector< int >* shortest = nullptr;
+    for ( int j = 0; j + 2 < folded.length(); ++j )
+    {
+        auto it = m_trigrams.constFind( trigram( folded, j ) );
+        if ( it == m_trigrams.constEnd() )
+        {
+            return QVector< int >();
+        }
+        if ( !shortest || it->count() < shortest->count() )
+        {
+            shortest = &it.value();
+        }
+    }
+    return *shortest;
+}
+
+void
+PackageFilterModel::setFilterString( const QString& filter )
+{
+    const QString folded = filter.trimmed().toCaseFolded();
+    if ( folded == m_filter )
+    {
+        return;
+    }
+
+    if ( folded.isEmpty() )
+    {
+        m_matches.clear();
+    }
+    else if ( !m_filter.isEmpty() && folded.contains( m_filter ) )
+    {
+        // Narrowing the search: only what matched before can still match
+        QVector< int > candidates = indexCandidates( folded );
+        match( folded, candidates.count() < m_matches.count() ? candidates : m_matches );
+    }
+    else
+    {
+        match( folded, indexCandidates( folded ) );
+    }
+
+    m_filter = folded;
+    m_matched.clear();
+    m_visible.clear();
+    for ( int i : qAsConst( m_matches ) )
+    {
+        const PackageTreeItem* item = m_entries.at( i ).item;
+        m_matched.insert( item );
+        // Groups are shown if anything in them matches; stop at the
+        // first group that is already shown, since its groups are too.
+        for ( ; item && !m_visible.contains( item ); item = item->parentItem() )
+        {
+            m_visible.insert( item );
+        }
+    }
+    invalidateFilter();
+}
+
+void
+PackageFilterModel::match( const QString& folded, const QVector< int >& candidates )
+{
+    QVector< int > matches;
+    for ( int i : candidates )
+    {
+        if ( m_entries.at( i ).text.contains( folded ) )
+        {
+            matches.append( i );
+        }
+    }
+    m_matches = matches;
+}
+
+bool
+PackageFilterModel::filterAcceptsRow( int sourceRow, const QModelIndex& sourceParent ) const
+{
+    if ( m_filter.isEmpty() )
+    {
+        return true;
+    }
+
+    const QModelIndex index = sourceModel()->index( sourceRow, 0, sourceParent );
+    const auto* item = static_cast< const PackageTreeItem* >( index.internalPointer() );
+    if ( !item )
+    {
+        return false;
+    }
+    if ( m_visible.contains( item ) )
+    {
+        return true;
+    }
+    // Everything in a matching group is shown
+    for ( const auto* parent = item->parentItem(); parent; parent = parent->parentItem() )
+    {
+        if ( m_matched.contains( parent ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,79 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef NETINSTALL_PACKAGEFILTERMODEL_H
+#define NETINSTALL_PACKAGEFILTERMODEL_H
+
+#include <QHash>
+#include <QSet>
+#include <QSortFilterProxyModel>
+#include <QString>
+#include <QVector>
+
+class PackageModel;
+class PackageTreeItem;
+
+/** @brief Search in the groups and packages of a PackageModel
+ *
+ * The names and descriptions of all the items in the model are
+ * indexed (by trigram) when the model is (re)loaded, so that
+ * a search does not need to look at every item: only the items
+ * that contain the least-common trigram of the search text are
+ * checked. When the search text is extended (e.g. while typing)
+ * only the items that matched before are checked again.
+ *
+ * An item is shown if it matches, if one of the groups it is in
+ * matches, or if something in it matches.
+ */
+class PackageFilterModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+public:
+    PackageFilterModel( PackageModel* source, QObject* parent = nullptr );
+    ~PackageFilterModel() override;
+
+    bool filterAcceptsRow( int sourceRow, const QModelIndex& sourceParent ) const override;
+
+    /// @brief The (case-folded) search text
+    QString filterString() const { return m_filter; }
+    /// @brief The number of items that match the search text
+    int matchCount() const { return m_matches.count(); }
+
+public Q_SLOTS:
+    /** @brief Show only the items matching @p filter
+     *
+     * The search is case-insensitive and looks for @p filter anywhere
+     * in the name or description. An empty @p filter shows everything.
+     */
+    void setFilterString( const QString& filter );
+
+private:
+    struct Entry
+    {
+        const PackageTreeItem* item;
+        QString text;  ///< Case-folded name and description
+    };
+
+    void clearIndex();
+    void buildIndex();
+    void addItems( const QModelIndex& parent );
+    /// @brief Indexes into m_entries that might contain @p folded
+    QVector< int > indexCandidates( const QString& folded ) const;
+    void match( const QString& folded, const QVector< int >& candidates );
+
+    QVector< Entry > m_entries;
+    QHash< quint64, QVector< int > > m_trigrams;
+
+    QString m_filter;
+    QVector< int > m_matches;  ///< Indexes into m_entries that match m_filter
+    QSet< const PackageTreeItem* > m_matched;  ///< Items that match
+    QSet< const PackageTreeItem* > m_visible;  ///< Items that match, and their groups
+};
+
+#endif
@@ -14,6 +14,8 @@
 #include "utils/Variant.h"
 #include "utils/Yaml.h"
 
+#include <utility>
+
 PackageModel::PackageModel( QObject* parent )
     : QAbstractItemModel( parent )
 {
@@ -22,6 +24,7 @@ PackageModel::PackageModel( QObject* parent )
 PackageModel::~PackageModel()
 {
     delete m_rootItem;
+    qDeleteAll( m_hiddenItems );
 }
 
 QModelIndex
@@ -170,6 +173,33 @@ PackageModel::headerData( int section, Qt::Orientation orientation, int role ) c
     return QVariant();
 }
 
+/** @brief Appends the selected packages under @p item to @p selectedPackages
+ *
+ * Unchecked groups are skipped whole, so this only visits the
+ * selected part of the tree.
+ */
+static void
+appendItemPackages( PackageTreeItem* item, PackageTreeItem::List& selectedPackages )
+{
+    for ( int i = 0; i < item->childCount(); i++ )
+    {
+        auto* child = item->child( i );
+        if ( child->isSelected() == Qt::Unchecked )
+        {
+            continue;
+        }
+
+        if ( child->isPackage() )  // package
+        {
+            selectedPackages.append( child );
+        }
+        else
+        {
+            appendItemPackages( child, selectedPackages );
+        }
+    }
+}
+
 PackageTreeItem::List
 PackageModel::getPackages() const
 {
@@ -178,12 +208,13 @@ PackageModel::getPackages() const
         return PackageTreeItem::List();
     }
 
-    auto items = getItemPackages( m_rootItem );
+    PackageTreeItem::List items;
+    appendItemPackages( m_rootItem, items );
     for ( auto package : m_hiddenItems )
     {
         if ( package->hiddenSelected() )
         {
-            items.append( getItemPackages( package ) );
+            appendItemPackages( package, items );
         }
     }
     return items;
@@ -193,28 +224,49 @@ PackageTreeItem::List
 PackageModel::getItemPackages( PackageTreeItem* item ) const
 {
     PackageTreeItem::List selectedPackages;
-    for ( int i = 0; i < item->childCount(); i++ )
-    {
-        auto* child = item->child( i );
-        if ( child->isSelected() == Qt::Unchecked )
-        {
-            continue;
-        }
+    appendItemPackages( item, selectedPackages );
+    return selectedPackages;
+}
 
-        if ( child->isPackage() )  // package
-        {
-            selectedPackages.append( child );
-        }
-        else
-        {
-            selectedPackages.append( getItemPackages( child ) );
-        }
+PackageTree::PackageTree( const QVariantList& groupData )
+    : m_rootItem( new PackageTreeItem() )
+{
+    build( groupData, m_rootItem );
+}
+
+PackageTree::PackageTree( PackageTree&& other )
+    : m_rootItem( other.m_rootItem )
+    , m_hiddenItems( std::move( other.m_hiddenItems ) )
+{
+    other.m_rootItem = nullptr;
+    other.m_hiddenItems.clear();
+}
+
+PackageTree&
+PackageTree::operator=( PackageTree&& other )
+{
+    if ( this != &other )
+    {
+        std::swap( m_rootItem, other.m_rootItem );
+        std::swap( m_hiddenItems, other.m_hiddenItems );
     }
-    return selectedPackages;
+    return *this;
+}
+
+PackageTree::~PackageTree()
+{
+    delete m_rootItem;
+    qDeleteAll( m_hiddenItems );
+}
+
+int
+PackageTree::count() const
+{
+    return m_rootItem ? m_rootItem->childCount() : 0;
 }
 
 void
-PackageModel::setupModelData( const QVariantList& groupList, PackageTreeItem* parent )
+PackageTree::build( const QVariantList& groupList, PackageTreeItem* parent )
 {
     for ( const auto& group : groupList )
     {
@@ -264,7 +316,7 @@ PackageModel::setupModelData( const QVariantList& groupList, PackageTreeItem* pa
             QVariantList subgroups = groupMap.value( "subgroups" ).toList();
             if ( !subgroups.isEmpty() )
             {
-                setupModelData( subgroups, item );
+                build( subgroups, item );
                 // The children might be checked while the parent isn't (yet).
                 // Children are added to their parent (below) without affecting
                 // the checked-state -- do it manually. Items with subgroups
@@ -294,7 +346,6 @@ PackageModel::setupModelData( const QVariantList& groupList, PackageTreeItem* pa
         }
         else
         {
-            item->setCheckable( true );
             parent->appendChild( item );
         }
     }
@@ -303,9 +354,16 @@ PackageModel::setupModelData( const QVariantList& groupList, PackageTreeItem* pa
 void
 PackageModel::setupModelData( const QVariantList& l )
 {
+    setTree( PackageTree( l ) );
+}
+
+void
+PackageModel::setTree( PackageTree&& tree )
+{
+    PackageTree incoming( std::move( tree ) );
     emit beginResetModel();
-    delete m_rootItem;
-    m_rootItem = new PackageTreeItem();
-    setupModelData( l, m_rootItem );
+    std::swap( m_rootItem, incoming.m_rootItem );
+    std::swap( m_hiddenItems, incoming.m_hiddenItems );
     emit endResetModel();
+    // Now incoming has the old items, and deletes them
 }
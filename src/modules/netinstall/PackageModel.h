@@ -23,6 +23,37 @@ namespace YAML
 class Node;
 }
 
+/** @brief The groups and packages for a PackageModel
+ *
+ * Building the tree from (YAML) data can take a while for large
+ * groups files, so it can be done in any thread, and the finished
+ * tree is then handed to the model with PackageModel::setTree().
+ * Until then, the tree owns its items.
+ */
+class PackageTree
+{
+public:
+    PackageTree() = default;
+    /// @brief Builds the tree from a list of groups, see PackageModel::setupModelData()
+    explicit PackageTree( const QVariantList& groupData );
+    PackageTree( const PackageTree& ) = delete;
+    PackageTree( PackageTree&& other );
+    PackageTree& operator=( const PackageTree& ) = delete;
+    PackageTree& operator=( PackageTree&& other );
+    ~PackageTree();
+
+    /// @brief The number of (visible) top-level groups
+    int count() const;
+
+private:
+    friend class PackageModel;
+
+    void build( const QVariantList& groupData, PackageTreeItem* parent );
+
+    PackageTreeItem* m_rootItem = nullptr;
+    PackageTreeItem::List m_hiddenItems;
+};
+
 class PackageModel : public QAbstractItemModel
 {
     Q_OBJECT
@@ -41,7 +72,10 @@ public:
     explicit PackageModel( QObject* parent = nullptr );
     ~PackageModel() override;
 
+    /// @brief Replaces the contents of the model with groups from @p l
     void setupModelData( const QVariantList& l );
+    /// @brief Replaces the contents of the model with @p tree, which becomes empty
+    void setTree( PackageTree&& tree );
 
     QVariant data( const QModelIndex& index, int role ) const override;
     bool setData( const QModelIndex& index, const QVariant& value, int role = Qt::EditRole ) override;
@@ -60,8 +94,6 @@ public:
 private:
     friend class ItemTests;
 
-    void setupModelData( const QVariantList& l, PackageTreeItem* parent );
-
     PackageTreeItem* m_rootItem = nullptr;
     PackageTreeItem::List m_hiddenItems;
 };
@@ -94,7 +94,10 @@ PackageTreeItem::~PackageTreeItem()
 void
 PackageTreeItem::appendChild( PackageTreeItem* child )
 {
+    child->m_row = m_childItems.count();
     m_childItems.append( child );
+    // This does not change our own state; call updateSelected() for that.
+    countChild( child->isSelected(), 1 );
 }
 
 PackageTreeItem*
@@ -114,7 +117,7 @@ PackageTreeItem::row() const
 {
     if ( m_parentItem )
     {
-        return m_parentItem->m_childItems.indexOf( const_cast< PackageTreeItem* >( this ) );
+        return m_row;
     }
     return 0;
 }
@@ -185,73 +188,81 @@ PackageTreeItem::setSelected( Qt::CheckState isSelected )
         return;
     }
 
+    const Qt::CheckState previous = m_selected;
     m_selected = isSelected;
     setChildrenSelected( isSelected );
 
-    // Look for suitable parent item which may change checked-state
-    // when one of its children changes.
-    PackageTreeItem* currentItem = parentItem();
-    while ( ( currentItem != nullptr ) && ( currentItem->childCount() == 0 ) )
+    // Items that are not (yet) in their parent's list of children,
+    // e.g. hidden ones or ones still being built, don't count for the parent.
+    if ( previous != isSelected && m_row >= 0 )
     {
-        currentItem = currentItem->parentItem();
-    }
-    if ( currentItem == nullptr )
-    {
-        // Reached the root .. don't bother
-        return;
+        m_parentItem->childSelectionChanged( previous, isSelected );
     }
-
-    currentItem->updateSelected();
 }
 
 void
 PackageTreeItem::updateSelected()
 {
     // Figure out checked-state based on the children
-    int childrenSelected = 0;
-    int childrenPartiallySelected = 0;
-    for ( int i = 0; i < childCount(); i++ )
+    Qt::CheckState state = Qt::PartiallyChecked;
+    if ( !m_childrenChecked && !m_childrenPartial )
     {
-        if ( child( i )->isSelected() == Qt::Checked )
-        {
-            childrenSelected++;
-        }
-        if ( child( i )->isSelected() == Qt::PartiallyChecked )
-        {
-            childrenPartiallySelected++;
-        }
+        state = Qt::Unchecked;
     }
-    if ( !childrenSelected && !childrenPartiallySelected )
+    else if ( m_childrenChecked == childCount() )
     {
-        setSelected( Qt::Unchecked );
+        state = Qt::Checked;
     }
-    else if ( childrenSelected == childCount() )
+
+    if ( parentItem() == nullptr || state == m_selected )
     {
-        setSelected( Qt::Checked );
+        // Root is always checked; otherwise, nothing changes upwards either
+        return;
     }
-    else
+
+    const Qt::CheckState previous = m_selected;
+    m_selected = state;
+    if ( m_row >= 0 )
     {
-        setSelected( Qt::PartiallyChecked );
+        m_parentItem->childSelectionChanged( previous, state );
     }
 }
 
+void
+PackageTreeItem::childSelectionChanged( Qt::CheckState from, Qt::CheckState to )
+{
+    countChild( from, -1 );
+    countChild( to, 1 );
+    updateSelected();
+}
+
+void
+PackageTreeItem::countChild( Qt::CheckState state, int delta )
+{
+    if ( state == Qt::Checked )
+    {
+        m_childrenChecked += delta;
+    }
+    else if ( state == Qt::PartiallyChecked )
+    {
+        m_childrenPartial += delta;
+    }
+}
 
 void
 PackageTreeItem::setChildrenSelected( Qt::CheckState isSelected )
 {
     if ( isSelected != Qt::PartiallyChecked )
+    {
+        m_childrenChecked = isSelected == Qt::Checked ? childCount() : 0;
+        m_childrenPartial = 0;
         // Children are never root; don't need to use setSelected on them.
         for ( auto child : m_childItems )
         {
             child->m_selected = isSelected;
             child->setChildrenSelected( isSelected );
         }
-}
-
-int
-PackageTreeItem::type() const
-{
-    return QStandardItem::UserType;
+    }
 }
 
 QVariant
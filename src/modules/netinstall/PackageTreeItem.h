@@ -12,10 +12,15 @@
 #define PACKAGETREEITEM_H
 
 #include <QList>
-#include <QStandardItem>
 #include <QVariant>
 
-class PackageTreeItem : public QStandardItem
+/** @brief One group or package in the netinstall tree
+ *
+ * Items own their children. Groups keep a count of checked and
+ * partially-checked children, so that toggling an item only touches
+ * its own subtree and its ancestors, not the whole tree.
+ */
+class PackageTreeItem
 {
 public:
     using List = QList< PackageTreeItem* >;
@@ -39,12 +44,12 @@ public:
     explicit PackageTreeItem( const QVariantMap& groupData, GroupTag&& parent );
     ///@brief A root item, always selected, named "<root>"
     explicit PackageTreeItem();
-    ~PackageTreeItem() override;
+    ~PackageTreeItem();
 
     void appendChild( PackageTreeItem* child );
     PackageTreeItem* child( int row );
     int childCount() const;
-    QVariant data( int column ) const override;
+    QVariant data( int column ) const;
     int row() const;
 
     PackageTreeItem* parentItem();
@@ -127,13 +132,11 @@ public:
     /** @brief Update selectedness based on the children's states
      *
      * This only makes sense for groups, which might have packages
-     * or subgroups; it checks only direct children.
+     * or subgroups; it uses only the counts of the direct children,
+     * which appendChild() and setSelected() keep up-to-date.
      */
     void updateSelected();
 
-    // QStandardItem methods
-    int type() const override;
-
     /** @brief Are two items equal
      *
      * This **disregards** parent-item and the child-items, and compares
@@ -145,8 +148,17 @@ public:
     bool operator!=( const PackageTreeItem& rhs ) const { return !( *this == rhs ); }
 
 private:
+    Q_DISABLE_COPY( PackageTreeItem )
+
+    /// @brief Adjust the child-counts for one child going from @p from to @p to
+    void childSelectionChanged( Qt::CheckState from, Qt::CheckState to );
+    void countChild( Qt::CheckState state, int delta );
+
     PackageTreeItem* m_parentItem;
     List m_childItems;
+    int m_row = -1;  ///< Index in the parent's children, -1 if not (yet) appended
+    int m_childrenChecked = 0;
+    int m_childrenPartial = 0;
 
     // An entry can be a package, or a group.
     QString m_name;
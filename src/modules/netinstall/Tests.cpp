@@ -8,6 +8,8 @@
  */
 
 #include "Config.h"
+#include "LoaderQueue.h"
+#include "PackageFilterModel.h"
 #include "PackageModel.h"
 #include "PackageTreeItem.h"
 
@@ -18,8 +20,13 @@
 
 #include <KMacroExpander>
 
+#include <QElapsedTimer>
+#include <QTcpServer>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtTest/QtTest>
 
+#include <memory>
+
 class ItemTests : public QObject
 {
     Q_OBJECT
@@ -43,10 +50,15 @@ private Q_SLOTS:
     void testGroup();
     void testCompare();
     void testModel();
+    void testTree();
+    void testSelection();
+    void testSearch();
     void testExampleFiles();
 
     void testUrlFallback_data();
     void testUrlFallback();
+    void testUrlHedged();
+    void testUrlHedgedFailure();
 };
 
 ItemTests::ItemTests() {}
@@ -125,6 +137,18 @@ static const char doc_with_expanded[] =
 "    - ccr\n"
 "    - base-devel\n"
 "    - bash\n";
+
+static const char nested[] =
+"- name: \"Desktop\"\n"
+"  description: \"Desktops\"\n"
+"  selected: false\n"
+"  subgroups:\n"
+"    - name: \"KDE\"\n"
+"      description: \"KDE\"\n"
+"      packages: [ plasma, dolphin ]\n"
+"    - name: \"Xfce\"\n"
+"      description: \"Xfce\"\n"
+"      packages: [ xfce4 ]\n";
 // *INDENT-ON*
 // clang-format on
 
@@ -308,6 +332,128 @@ ItemTests::testModel()
     QVERIFY( *( m2.m_rootItem->child( 0 ) ) != *group );
 }
 
+void
+ItemTests::testTree()
+{
+    const QVariantList yamlContents = CalamaresUtils::yamlSequenceToVariant( YAML::Load( doc ) );
+
+    // Built in another thread, handed to the model here
+    auto future = QtConcurrent::run( [yamlContents]() { return std::make_shared< PackageTree >( yamlContents ); } );
+    auto tree = future.result();
+    QVERIFY( tree );
+    QCOMPARE( tree->count(), 1 );
+
+    PackageModel m( nullptr );
+    QSignalSpy resets( &m, &PackageModel::modelReset );
+    m.setTree( std::move( *tree ) );
+    QCOMPARE( tree->count(), 0 );
+    QCOMPARE( resets.count(), 1 );
+    QCOMPARE( m.rowCount(), 1 );
+    QCOMPARE( m.rowCount( m.index( 0, 0 ) ), 3 );
+    checkAllSelected( m.m_rootItem );
+
+    // Replacing the tree replaces all of it
+    m.setTree( PackageTree() );
+    QCOMPARE( resets.count(), 2 );
+    QCOMPARE( m.rowCount(), 0 );
+    QVERIFY( m.getPackages().isEmpty() );
+}
+
+void
+ItemTests::testSelection()
+{
+    PackageModel m( nullptr );
+    m.setupModelData( CalamaresUtils::yamlSequenceToVariant( YAML::Load( nested ) ) );
+    QCOMPARE( m.rowCount(), 1 );
+
+    PackageTreeItem* desktop = m.m_rootItem->child( 0 );
+    QCOMPARE( desktop->childCount(), 2 );
+    PackageTreeItem* kde = desktop->child( 0 );
+    PackageTreeItem* xfce = desktop->child( 1 );
+    QCOMPARE( kde->row(), 0 );
+    QCOMPARE( xfce->row(), 1 );
+    QCOMPARE( desktop->isSelected(), Qt::Unchecked );
+    QVERIFY( m.getPackages().isEmpty() );
+
+    // One package makes everything above it partial
+    kde->child( 1 )->setSelected( Qt::Checked );
+    QCOMPARE( kde->isSelected(), Qt::PartiallyChecked );
+    QCOMPARE( desktop->isSelected(), Qt::PartiallyChecked );
+    QCOMPARE( m.m_rootItem->isSelected(), Qt::Checked );  // Root doesn't change
+    QCOMPARE( m.getPackages().count(), 1 );
+
+    kde->child( 0 )->setSelected( Qt::Checked );
+    QCOMPARE( kde->isSelected(), Qt::Checked );
+    QCOMPARE( desktop->isSelected(), Qt::PartiallyChecked );
+    QCOMPARE( m.getPackages().count(), 2 );
+
+    // Checking a whole group checks everything under it
+    desktop->setSelected( Qt::Checked );
+    QCOMPARE( xfce->isSelected(), Qt::Checked );
+    QCOMPARE( xfce->child( 0 )->isSelected(), Qt::Checked );
+    QCOMPARE( m.getPackages().count(), 3 );
+
+    // .. and the counts stay right afterwards
+    xfce->child( 0 )->setSelected( Qt::Unchecked );
+    QCOMPARE( xfce->isSelected(), Qt::Unchecked );
+    QCOMPARE( desktop->isSelected(), Qt::PartiallyChecked );
+    kde->setSelected( Qt::Unchecked );
+    QCOMPARE( desktop->isSelected(), Qt::Unchecked );
+    QCOMPARE( kde->child( 0 )->isSelected(), Qt::Unchecked );
+    QVERIFY( m.getPackages().isEmpty() );
+}
+
+void
+ItemTests::testSearch()
+{
+    PackageModel m( nullptr );
+    m.setupModelData( CalamaresUtils::yamlSequenceToVariant( YAML::Load( nested ) ) );
+    PackageFilterModel f( &m );
+    QCOMPARE( f.rowCount(), 1 );
+
+    const QModelIndex desktop = f.index( 0, 0 );
+    QCOMPARE( f.rowCount( desktop ), 2 );
+
+    // Case doesn't matter; the groups leading to the match are shown
+    f.setFilterString( QStringLiteral( "DOL" ) );
+    QCOMPARE( f.matchCount(), 1 );
+    QCOMPARE( f.rowCount(), 1 );
+    QCOMPARE( f.rowCount( desktop ), 1 );
+    const QModelIndex kde = f.index( 0, 0, desktop );
+    QCOMPARE( f.data( kde, Qt::DisplayRole ).toString(), QStringLiteral( "KDE" ) );
+    QCOMPARE( f.rowCount( kde ), 1 );
+    QCOMPARE( f.data( f.index( 0, 0, kde ), Qt::DisplayRole ).toString(), QStringLiteral( "dolphin" ) );
+
+    // Narrowing, and then nothing
+    f.setFilterString( QStringLiteral( "dolphin" ) );
+    QCOMPARE( f.matchCount(), 1 );
+    f.setFilterString( QStringLiteral( "dolphins" ) );
+    QCOMPARE( f.matchCount(), 0 );
+    QCOMPARE( f.rowCount(), 0 );
+
+    // Short searches don't use the trigrams; a matching group shows all of its packages
+    f.setFilterString( QStringLiteral( "kd" ) );
+    QCOMPARE( f.matchCount(), 1 );
+    QCOMPARE( f.rowCount( f.index( 0, 0, f.index( 0, 0 ) ) ), 2 );
+
+    // Descriptions are searched too
+    f.setFilterString( QStringLiteral( "desktops" ) );
+    QCOMPARE( f.matchCount(), 1 );
+    QCOMPARE( f.rowCount( f.index( 0, 0 ) ), 2 );
+
+    // Reloading the model keeps the search
+    f.setFilterString( QStringLiteral( "xfce4" ) );
+    QCOMPARE( f.matchCount(), 1 );
+    m.setupModelData( CalamaresUtils::yamlSequenceToVariant( YAML::Load( nested ) ) );
+    QCOMPARE( f.filterString(), QStringLiteral( "xfce4" ) );
+    QCOMPARE( f.matchCount(), 1 );
+    QCOMPARE( f.rowCount( f.index( 0, 0 ) ), 1 );
+
+    f.setFilterString( QString() );
+    QCOMPARE( f.matchCount(), 0 );
+    QCOMPARE( f.rowCount( f.index( 0, 0 ) ), 2 );
+}
+
 void
 ItemTests::testExampleFiles()
 {
@@ -420,6 +566,68 @@ ItemTests::testUrlFallback()
     QCOMPARE( c.model()->rowCount(), count );
 }
 
+void
+ItemTests::testUrlHedged()
+{
+    // A server that accepts connections, but never answers
+    QTcpServer deadServer;
+    QVERIFY( deadServer.listen( QHostAddress::LocalHost ) );
+
+    const QString testdir = QString( "%1/tests" ).arg( BUILD_AS_TEST );
+    Config c;
+    c.setConfigurationMap(
+        { { "required", true },
+          { "groupsUrl",
+            QStringList { QString( "http://127.0.0.1:%1/netinstall.yaml" ).arg( deadServer.serverPort() ),
+                          QString( "file://%1/data-small.yaml" ).arg( testdir ) } } } );
+
+    QEventLoop loop;
+    connect( &c, &Config::statusReady, &loop, &QEventLoop::quit );
+    QSignalSpy spy( &c, &Config::statusReady );
+    QElapsedTimer timer;
+    timer.start();
+    QTimer::singleShot( std::chrono::seconds( 10 ), &loop, &QEventLoop::quit );
+    loop.exec();
+
+    // The second URL is used without waiting for the first to time out
+    QCOMPARE( spy.count(), 1 );
+    QCOMPARE( smash( c.statusCode() ), smash( Config::Status::Ok ) );
+    QCOMPARE( c.model()->rowCount(), 2 );
+    QVERIFY( timer.elapsed() >= LoaderQueue::hedgeDelay().count() );
+    QVERIFY( timer.elapsed() < 10000 );
+}
+
+void
+ItemTests::testUrlHedgedFailure()
+{
+    QTcpServer deadServer;
+    QVERIFY( deadServer.listen( QHostAddress::LocalHost ) );
+
+    // The second URL fails while the first is still waiting; that is not
+    // reported, since the first (or the third) may still answer.
+    const QString testdir = QString( "%1/tests" ).arg( BUILD_AS_TEST );
+    Config c;
+    QList< int > statuses;
+    connect( &c, &Config::statusChanged, [ &c, &statuses ]() { statuses.append( smash( c.statusCode() ) ); } );
+    c.setConfigurationMap(
+        { { "required", true },
+          { "groupsUrl",
+            QStringList { QString( "http://127.0.0.1:%1/netinstall.yaml" ).arg( deadServer.serverPort() ),
+                          QString( "file://%1/does-not-exist.yaml" ).arg( testdir ),
+                          QString( "file://%1/data-small.yaml" ).arg( testdir ) } } } );
+
+    QEventLoop loop;
+    connect( &c, &Config::statusReady, &loop, &QEventLoop::quit );
+    QSignalSpy spy( &c, &Config::statusReady );
+    QTimer::singleShot( std::chrono::seconds( 10 ), &loop, &QEventLoop::quit );
+    loop.exec();
+
+    QCOMPARE( spy.count(), 1 );
+    QCOMPARE( smash( c.statusCode() ), smash( Config::Status::Ok ) );
+    QCOMPARE( c.model()->rowCount(), 2 );
+    QVERIFY( !statuses.contains( smash( Config::Status::FailedNetworkError ) ) );
+}
+
 
 QTEST_GUILESS_MAIN( ItemTests )
 
@@ -17,6 +17,8 @@
 #ifdef HAVE_APPSTREAM
 #include "ItemAppStream.h"
 #include <AppStreamQt/pool.h>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
 #include <memory>
 #endif
 
@@ -177,8 +179,20 @@ Config::prettyStatus() const
     return tr( "Install option: <strong>%1</strong>" ).arg( m_packageChoice.value_or( tr( "None" ) ) );
 }
 
+/// @brief An *appstream* entry from the config, added once the AppStream data is loaded
+struct AppStreamItem
+{
+    int row;  ///< Where it would have been in the model
+    QVariantMap map;
+};
+
+/** @brief Fills the @p model with @p items
+ *
+ * Entries that need AppStream data are not added, but appended
+ * to @p appStreamItems instead.
+ */
 static void
-fillModel( PackageListModel* model, const QVariantList& items )
+fillModel( PackageListModel* model, const QVariantList& items, QVector< AppStreamItem >& appStreamItems )
 {
     if ( items.isEmpty() )
     {
@@ -186,11 +200,6 @@ fillModel( PackageListModel* model, const QVariantList& items )
         return;
     }
 
-#ifdef HAVE_APPSTREAM
-    std::unique_ptr< AppStream::Pool > pool;
-    bool poolOk = false;
-#endif
-
     cDebug() << "Loading PackageChooser model items from config";
     int item_index = 0;
     for ( const auto& item_it : items )
@@ -205,7 +214,7 @@ fillModel( PackageListModel* model, const QVariantList& items )
 
         if ( item_map.contains( "appdata" ) )
         {
-#ifdef HAVE_XML
+#ifdef HAVE_APPDATA
             model->addPackage( fromAppData( item_map ) );
 #else
             cWarning() << "Loading AppData XML is not supported.";
@@ -214,16 +223,7 @@ fillModel( PackageListModel* model, const QVariantList& items )
         else if ( item_map.contains( "appstream" ) )
         {
 #ifdef HAVE_APPSTREAM
-            if ( !pool )
-            {
-                pool = std::make_unique< AppStream::Pool >();
-                pool->setLocale( QStringLiteral( "ALL" ) );
-                poolOk = pool->load();
-            }
-            if ( pool && poolOk )
-            {
-                model->addPackage( fromAppStream( *pool, item_map ) );
-            }
+            appStreamItems.append( AppStreamItem { model->packageCount(), item_map } );
 #else
             cWarning() << "Loading AppStream data is not supported.";
 #endif
@@ -234,6 +234,74 @@ fillModel( PackageListModel* model, const QVariantList& items )
         }
     }
     cDebug() << Logger::SubEntry << "Loaded PackageChooser with" << model->packageCount() << "entries.";
+#ifdef HAVE_APPDATA
+    saveAppDataCache();
+#endif
+}
+
+#ifdef HAVE_APPSTREAM
+void
+Config::loadAppStream( QVector< AppStreamItem >&& items )
+{
+    cDebug() << "Loading AppStream data for" << items.count() << "PackageChooser entries in the background.";
+
+    auto pool = std::make_shared< AppStream::Pool >();
+    pool->setLocale( QStringLiteral( "ALL" ) );
+    // Use the binary caches, rather than parsing all the metadata again
+    pool->setCacheFlags( AppStream::Pool::CacheFlagUseSystem | AppStream::Pool::CacheFlagUseUser );
+
+    auto* watcher = new QFutureWatcher< bool >( this );
+    connect( watcher, &QFutureWatcher< bool >::finished, this, [this, watcher, pool, items = std::move( items )]() {
+        watcher->deleteLater();
+        if ( !watcher->result() )
+        {
+            cWarning() << "Could not load AppStream data:" << pool->lastError();
+            return;
+        }
+
+        int inserted = 0;
+        for ( const auto& item : items )
+        {
+            auto package = fromAppStream( *pool, item.map );
+            if ( package.isValid() )
+            {
+                m_model->insertPackage( item.row + inserted, std::move( package ) );
+                ++inserted;
+            }
+        }
+        cDebug() << "Loaded" << inserted << "PackageChooser entries from AppStream.";
+        if ( !m_defaultModelIndex.isValid() )
+        {
+            findDefaultIndex();
+        }
+    } );
+    watcher->setFuture( QtConcurrent::run( [pool]() { return pool->load(); } ) );
+}
+#else
+void
+Config::loadAppStream( QVector< AppStreamItem >&& )
+{
+}
+#endif
+
+void
+Config::findDefaultIndex()
+{
+    if ( m_defaultItemId.isEmpty() )
+    {
+        return;
+    }
+    for ( int item_n = 0; item_n < m_model->packageCount(); ++item_n )
+    {
+        QModelIndex item_idx = m_model->index( item_n, 0 );
+        QVariant item_id = m_model->data( item_idx, PackageListModel::IdRole );
+
+        if ( item_id.toString() == m_defaultItemId )
+        {
+            m_defaultModelIndex = item_idx;
+            break;
+        }
+    }
 }
 
 void
@@ -251,22 +319,15 @@ Config::setConfigurationMap( const QVariantMap& configurationMap )
 
     if ( configurationMap.contains( "items" ) )
     {
-        fillModel( m_model, configurationMap.value( "items" ).toList() );
+        QVector< AppStreamItem > appStreamItems;
+        fillModel( m_model, configurationMap.value( "items" ).toList(), appStreamItems );
 
-        QString default_item_id = CalamaresUtils::getString( configurationMap, "default" );
-        if ( !default_item_id.isEmpty() )
+        m_defaultItemId = CalamaresUtils::getString( configurationMap, "default" );
+        findDefaultIndex();
+
+        if ( !appStreamItems.isEmpty() )
         {
-            for ( int item_n = 0; item_n < m_model->packageCount(); ++item_n )
-            {
-                QModelIndex item_idx = m_model->index( item_n, 0 );
-                QVariant item_id = m_model->data( item_idx, PackageListModel::IdRole );
-
-                if ( item_id.toString() == default_item_id )
-                {
-                    m_defaultModelIndex = item_idx;
-                    break;
-                }
-            }
+            loadAppStream( std::move( appStreamItems ) );
         }
     }
     else
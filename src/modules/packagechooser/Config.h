@@ -37,6 +37,8 @@ enum class PackageChooserMethod
 
 const NamedEnumTable< PackageChooserMethod >& PackageChooserMethodNames();
 
+struct AppStreamItem;
+
 class Config : public Calamares::ModuleSystem::Config
 {
     Q_OBJECT
@@ -103,8 +105,18 @@ signals:
     void prettyStatusChanged();
 
 private:
+    /// @brief Sets m_defaultModelIndex to the item with id m_defaultItemId
+    void findDefaultIndex();
+    /** @brief Loads the AppStream data in the background
+     *
+     * The pool is loaded in a worker thread; once it is done, only the
+     * components named by @p items are looked up and inserted in the model.
+     */
+    void loadAppStream( QVector< AppStreamItem >&& items );
+
     PackageListModel* m_model = nullptr;
-    QModelIndex m_defaultModelIndex;
+    QString m_defaultItemId;
+    QPersistentModelIndex m_defaultModelIndex;
 
     /// Selection mode for this module
     PackageChooserMode m_mode = PackageChooserMode::Optional;
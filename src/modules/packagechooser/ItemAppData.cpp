@@ -9,171 +9,318 @@
 
 /** @brief Loading items from AppData XML files.
  *
- * Only used if QtXML is found, implements PackageItem::fromAppData().
+ * Only used if AppData support is enabled, implements PackageItem::fromAppData().
  */
-#include "PackageModel.h"
+#include "ItemAppData.h"
 
+#include "CalamaresVersionX.h"
+#include "utils/Dirs.h"
 #include "utils/Logger.h"
 #include "utils/Variant.h"
 
-#include <QDomDocument>
-#include <QDomNodeList>
+#include <QDataStream>
+#include <QDateTime>
 #include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QUrl>
+#include <QXmlStreamReader>
 
-/** @brief try to load the given @p fileName XML document
+/** @brief Returns language of the current element of @p xml
  *
- * Returns a QDomDocument, which will be valid iff the file can
- * be read and contains valid XML data.
+ * Transforms the attribute value for xml:lang to something
+ * suitable for TranslatedString (e.g. [lang]).
  */
-static inline QDomDocument
-loadAppData( const QString& fileName )
+static inline QString
+getLanguage( const QXmlStreamReader& xml )
 {
-    QFile file( fileName );
-    if ( !file.open( QIODevice::ReadOnly ) )
-    {
-        return QDomDocument();
-    }
-    QDomDocument doc( "AppData" );
-    if ( !doc.setContent( &file ) )
+    QString language = xml.attributes().value( QStringLiteral( "xml:lang" ) ).toString();
+    if ( !language.isEmpty() )
     {
-        file.close();
-        return QDomDocument();
+        language.replace( '-', '_' );
+        language.prepend( '[' );
+        language.append( ']' );
     }
-    file.close();
-    return doc;
+    return language;
 }
 
-/** @brief gets the text of child element @p tagName
+/** @brief Gets a suitable screenshot path from the current <screenshots> element
+ *
+ * The <screenshots> element contains zero or more <screenshot>
+ * elements, which can have a *type* associated with them.
+ * Returns the <image> path for the one labeled with type=default
+ * or, if there is no default, the first element.
  */
-static inline QString
-getChildText( const QDomNode& n, const QString& tagName )
+static QString
+getScreenshotPath( QXmlStreamReader& xml )
 {
-    QDomElement e = n.firstChildElement( tagName );
-    return e.isNull() ? QString() : e.text();
+    QString path;
+    bool found = false;
+    bool foundDefault = false;
+    while ( xml.readNextStartElement() )
+    {
+        if ( foundDefault || xml.name() != QLatin1String( "screenshot" ) )
+        {
+            xml.skipCurrentElement();
+            continue;
+        }
+        const bool isDefault = xml.attributes().value( QStringLiteral( "type" ) ) == QLatin1String( "default" );
+        QString image;
+        bool foundImage = false;
+        while ( xml.readNextStartElement() )
+        {
+            if ( !foundImage && xml.name() == QLatin1String( "image" ) )
+            {
+                image = xml.readElementText( QXmlStreamReader::IncludeChildElements );
+                foundImage = true;
+            }
+            else
+            {
+                xml.skipCurrentElement();
+            }
+        }
+        // If none has the "type=default" attribute, use the first one
+        if ( !found || isDefault )
+        {
+            path = image;
+            found = true;
+            foundDefault = isDefault;
+        }
+    }
+    return path;
 }
 
-/** @brief Gets a suitable screenshot path
+/** @brief Reads the AppData from @p device
  *
- * The <screenshots> element contains zero or more <screenshot>
- * elements, which can have a *type* associated with them.
- * Scan the screenshot elements, return the <image> path
- * for the one labeled with type=default or, if there is no
- * default, the first element.
+ * Builds up a map of the <name> elements (which may have a *lang*
+ * attribute to indicate translations) and paragraphs of the
+ * <description> element (also with lang). Uses the <summary>
+ * elements to supplement the description if no description
+ * is available for a given language. The map also has the <id>
+ * and screenshot path from the AppData, under keys *id* and
+ * *screenshot*.
+ *
+ * Only the elements that are needed are read; the rest of the
+ * document is skipped over. Returns an empty map if the document
+ * is not valid, or not a <component>.
  */
-static inline QString
-getScreenshotPath( const QDomNode& n )
+static QVariantMap
+parseAppData( QIODevice* device )
 {
-    QDomElement shotsNode = n.firstChildElement( "screenshots" );
-    if ( shotsNode.isNull() )
+    QXmlStreamReader xml( device );
+    if ( !xml.readNextStartElement() || xml.name() != QLatin1String( "component" ) )
     {
-        return QString();
+        return QVariantMap();
     }
 
-    const QDomNodeList shotList = shotsNode.childNodes();
-    int firstScreenshot = -1;  // Use which screenshot node?
-    for ( int i = 0; i < shotList.count(); ++i )
+    QVariantMap m;
+    QVariantMap descriptions;  // Paragraphs of the description, which take precedence over <summary>
+    QString id;
+    QString screenshotPath;
+    bool foundId = false;
+    bool foundDescription = false;
+    bool foundScreenshots = false;
+    while ( xml.readNextStartElement() )
     {
-        if ( !shotList.at( i ).isElement() )
+        const auto name = xml.name();
+        if ( name == QLatin1String( "name" ) )
         {
-            continue;
+            const QString key = QStringLiteral( "name" ) + getLanguage( xml );
+            m[ key ] = xml.readElementText( QXmlStreamReader::IncludeChildElements );
         }
-        QDomElement e = shotList.at( i ).toElement();
-        if ( e.tagName() != "screenshot" )
+        else if ( name == QLatin1String( "summary" ) )
         {
-            continue;
+            const QString key = QStringLiteral( "description" ) + getLanguage( xml );
+            m[ key ] = xml.readElementText( QXmlStreamReader::IncludeChildElements );
         }
-        // If none has the "type=default" attribute, use the first one
-        if ( firstScreenshot < 0 )
+        else if ( name == QLatin1String( "id" ) && !foundId )
         {
-            firstScreenshot = i;
+            id = xml.readElementText( QXmlStreamReader::IncludeChildElements );
+            foundId = true;
         }
-        // But type=default takes precedence.
-        if ( e.hasAttribute( "type" ) && e.attribute( "type" ) == "default" )
+        else if ( name == QLatin1String( "description" ) && !foundDescription )
         {
-            firstScreenshot = i;
-            break;
+            foundDescription = true;
+            while ( xml.readNextStartElement() )
+            {
+                if ( xml.name() == QLatin1String( "p" ) )
+                {
+                    const QString key = QStringLiteral( "description" ) + getLanguage( xml );
+                    descriptions[ key ] = xml.readElementText( QXmlStreamReader::IncludeChildElements );
+                }
+                else
+                {
+                    xml.skipCurrentElement();
+                }
+            }
+        }
+        else if ( name == QLatin1String( "screenshots" ) && !foundScreenshots )
+        {
+            foundScreenshots = true;
+            screenshotPath = getScreenshotPath( xml );
+            // Items from AppData are not fetched from the network, unlike AppStream ones
+            const QString scheme = QUrl( screenshotPath ).scheme();
+            if ( scheme == QLatin1String( "http" ) || scheme == QLatin1String( "https" ) )
+            {
+                cDebug() << "Ignoring remote AppData screenshot" << screenshotPath;
+                screenshotPath.clear();
+            }
+        }
+        else
+        {
+            xml.skipCurrentElement();
         }
     }
-
-    if ( firstScreenshot >= 0 )
+    // Read to the end, so that broken XML is noticed
+    while ( !xml.atEnd() )
+    {
+        xml.readNext();
+    }
+    if ( xml.hasError() )
     {
-        return shotList.at( firstScreenshot ).firstChildElement( "image" ).text();
+        cWarning() << "AppData is not valid XML:" << xml.errorString() << "at line" << xml.lineNumber();
+        return QVariantMap();
     }
 
-    return QString();
+    for ( auto it = descriptions.cbegin(); it != descriptions.cend(); ++it )
+    {
+        m.insert( it.key(), it.value() );
+    }
+    m.insert( "id", id );
+    m.insert( "screenshot", screenshotPath );
+    return m;
 }
 
-/** @brief Returns language of the given element @p e
+/** @brief One parsed AppData file in the AppData cache
  *
- * Transforms the attribute value for xml:lang to something
- * suitable for TranslatedString (e.g. [lang]).
+ * The entry is valid for the file as long as the size and
+ * modification time of the file are unchanged.
  */
-static inline QString
-getLanguage( const QDomElement& e )
+struct AppDataCacheEntry
 {
-    QString language = e.attribute( "xml:lang" );
-    if ( !language.isEmpty() )
+    qint64 modified = 0;
+    qint64 size = -1;
+    QVariantMap contents;
+};
+
+static QDataStream&
+operator<<( QDataStream& s, const AppDataCacheEntry& e )
+{
+    return s << e.modified << e.size << e.contents;
+}
+
+static QDataStream&
+operator>>( QDataStream& s, AppDataCacheEntry& e )
+{
+    return s >> e.modified >> e.size >> e.contents;
+}
+
+static const char s_appDataCacheMagic[] = "CALAMARES-APPDATA-CACHE";
+static QMutex s_appDataCacheMutex;
+static QHash< QString, AppDataCacheEntry >* s_appDataCache = nullptr;  ///< Read on first use
+static bool s_appDataCacheChanged = false;
+
+static QString
+appDataCacheFile()
+{
+    return CalamaresUtils::appLogDir().filePath( QStringLiteral( "appdata.cache" ) );
+}
+
+/// @brief Reads the cache from disk, the first time; call with the mutex locked
+static void
+loadAppDataCache()
+{
+    if ( s_appDataCache )
     {
-        language.replace( '-', '_' );
-        language.prepend( '[' );
-        language.append( ']' );
+        return;
     }
-    return language;
+    s_appDataCache = new QHash< QString, AppDataCacheEntry >;
+
+    QFile f( appDataCacheFile() );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        return;
+    }
+    QDataStream s( &f );
+    s.setVersion( QDataStream::Qt_5_9 );
+    QByteArray magic;
+    QString version;
+    s >> magic >> version;
+    if ( magic != s_appDataCacheMagic || version != CALAMARES_VERSION )
+    {
+        cDebug() << "AppData cache" << f.fileName() << "is not for this version of Calamares.";
+        return;
+    }
+    QHash< QString, AppDataCacheEntry > entries;
+    s >> entries;
+    if ( s.status() != QDataStream::Ok )
+    {
+        cWarning() << "AppData cache" << f.fileName() << "could not be read.";
+        return;
+    }
+    s_appDataCache->swap( entries );
 }
 
-/** @brief Scan the list of @p children for @p tagname elements and add them to the map
- *
- * Uses @p mapname instead of @p tagname for the entries in map @p m
- * to allow renaming from XML to map keys (in particular for
- * TranslatedString). Also transforms xml:lang attributes to suitable
- * key-decorations on @p mapname.
- */
-static inline void
-fillMap( QVariantMap& m, const QDomNodeList& children, const QString& tagname, const QString& mapname )
+/// @brief The parsed AppData file @p fileName, from the cache if it has not changed
+static QVariantMap
+loadAppData( const QString& fileName )
 {
-    for ( int i = 0; i < children.count(); ++i )
+    const QFileInfo fi( fileName );
+    const qint64 modified = fi.lastModified().toMSecsSinceEpoch();
+    const qint64 size = fi.size();
+    const QString key = fi.absoluteFilePath();
     {
-        if ( !children.at( i ).isElement() )
-        {
-            continue;
-        }
-
-        QDomElement e = children.at( i ).toElement();
-        if ( e.tagName() != tagname )
+        QMutexLocker lock( &s_appDataCacheMutex );
+        loadAppDataCache();
+        auto it = s_appDataCache->constFind( key );
+        if ( it != s_appDataCache->constEnd() && it->modified == modified && it->size == size )
         {
-            continue;
+            return it->contents;
         }
+    }
 
-        m[ mapname + getLanguage( e ) ] = e.text();
+    QFile file( fileName );
+    if ( !file.open( QIODevice::ReadOnly ) )
+    {
+        cWarning() << "Could not read AppData" << fileName;
+        return QVariantMap();
     }
+    cDebug() << "Loading AppData XML from" << fileName;
+    const QVariantMap contents = parseAppData( &file );
+
+    QMutexLocker lock( &s_appDataCacheMutex );
+    s_appDataCache->insert( key, AppDataCacheEntry { modified, size, contents } );
+    s_appDataCacheChanged = true;
+    return contents;
 }
 
-/** @brief gets the <name> and <description> elements
-*
-* Builds up a map of the <name> elements (which may have a *lang*
-* attribute to indicate translations and paragraphs of the
-* <description> element (also with lang). Uses the <summary>
-* elements to supplement the description if no description
-* is available for a given language.
-*
-* Returns a map with keys suitable for use by TranslatedString.
-*/
-static inline QVariantMap
-getNameAndSummary( const QDomNode& n )
+void
+saveAppDataCache()
 {
-    QVariantMap m;
-
-    const QDomNodeList children = n.childNodes();
-    fillMap( m, children, "name", "name" );
-    fillMap( m, children, "summary", "description" );
-
-    const QDomElement description = n.firstChildElement( "description" );
-    if ( !description.isNull() )
+    QMutexLocker lock( &s_appDataCacheMutex );
+    if ( !s_appDataCache || !s_appDataCacheChanged )
     {
-        fillMap( m, description.childNodes(), "p", "description" );
+        return;
     }
 
-    return m;
+    QSaveFile f( appDataCacheFile() );
+    if ( !f.open( QIODevice::WriteOnly ) )
+    {
+        cWarning() << "Could not write AppData cache" << f.fileName();
+        return;
+    }
+    QDataStream s( &f );
+    s.setVersion( QDataStream::Qt_5_9 );
+    s << QByteArray( s_appDataCacheMagic ) << QString( CALAMARES_VERSION ) << *s_appDataCache;
+    if ( s.status() != QDataStream::Ok || !f.commit() )
+    {
+        cWarning() << "Could not write AppData cache" << f.fileName();
+        return;
+    }
+    s_appDataCacheChanged = false;
 }
 
 PackageItem
@@ -185,41 +332,30 @@ fromAppData( const QVariantMap& item_map )
         cWarning() << "Can't load AppData without a suitable key.";
         return PackageItem();
     }
-    cDebug() << "Loading AppData XML from" << fileName;
 
-    QDomDocument doc = loadAppData( fileName );
-    if ( doc.isNull() )
+    QVariantMap map = loadAppData( fileName );
+    if ( map.isEmpty() )
     {
         return PackageItem();
     }
 
-    QDomElement componentNode = doc.documentElement();
-    if ( !componentNode.isNull() && componentNode.tagName() == "component" )
+    // An "id" entry in the Calamares config overrides ID in the AppData
+    QString id = CalamaresUtils::getString( item_map, "id" );
+    if ( !id.isEmpty() )
     {
-        // An "id" entry in the Calamares config overrides ID in the AppData
-        QString id = CalamaresUtils::getString( item_map, "id" );
-        if ( id.isEmpty() )
-        {
-            id = getChildText( componentNode, "id" );
-        }
-        if ( id.isEmpty() )
-        {
-            return PackageItem();
-        }
-
-        // A "screenshot" entry in the Calamares config overrides AppData
-        QString screenshotPath = CalamaresUtils::getString( item_map, "screenshot" );
-        if ( screenshotPath.isEmpty() )
-        {
-            screenshotPath = getScreenshotPath( componentNode );
-        }
-
-        QVariantMap map = getNameAndSummary( componentNode );
         map.insert( "id", id );
-        map.insert( "screenshot", screenshotPath );
+    }
+    else if ( map.value( "id" ).toString().isEmpty() )
+    {
+        return PackageItem();
+    }
 
-        return PackageItem( map );
+    // A "screenshot" entry in the Calamares config overrides AppData
+    QString screenshotPath = CalamaresUtils::getString( item_map, "screenshot" );
+    if ( !screenshotPath.isEmpty() )
+    {
+        map.insert( "screenshot", screenshotPath );
     }
 
-    return PackageItem();
+    return PackageItem( map );
 }
@@ -20,9 +20,16 @@
  * ID is under the control of Calamares, and the screenshot can be
  * forced to a local path available on the installation medium.
  *
- * Requires XML support in libcalamares, if not present will
- * return invalid PackageItems.
+ * Parsed AppData files are cached, in memory and (see saveAppDataCache())
+ * on disk; a file is parsed again only when its size or modification
+ * time changes.
  */
 PackageItem fromAppData( const QVariantMap& map );
 
+/** @brief Writes the AppData cache to disk, if anything was added to it
+ *
+ * The cache is in the Calamares cache directory (where the log is).
+ */
+void saveAppDataCache();
+
 #endif
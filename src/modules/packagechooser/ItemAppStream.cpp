@@ -28,13 +28,13 @@ sizeOrder( const QSize& size )
     return size.width() * size.height();
 }
 
-/// @brief Sets a screenshot in @p map from @p screenshot, if a usable one is found
-static void
-setScreenshot( QVariantMap& map, const AppStream::Screenshot& screenshot )
+/// @brief The URL of a usable image in @p screenshot, or an invalid URL
+static QUrl
+screenshotUrl( const AppStream::Screenshot& screenshot )
 {
     if ( screenshot.images().count() < 1 )
     {
-        return;
+        return QUrl();
     }
 
     // Pick the smallest
@@ -47,11 +47,7 @@ setScreenshot( QVariantMap& map, const AppStream::Screenshot& screenshot )
             url = img.url();
         }
     }
-
-    if ( url.isValid() )
-    {
-        map.insert( "screenshot", url.toString() );
-    }
+    return url;
 }
 
 /// @brief Interpret an AppStream Component
@@ -87,6 +83,9 @@ fromComponent( AppStream::Component& component )
         }
     }
 
+    PackageItem item( map );
+
+    // The screenshot is only fetched when the item is shown
     auto screenshots = component.screenshots();
     if ( screenshots.count() > 0 )
     {
@@ -95,18 +94,18 @@ fromComponent( AppStream::Component& component )
         {
             if ( s.isDefault() )
             {
-                setScreenshot( map, s );
+                item.screenshotUrl = screenshotUrl( s );
                 done = true;
                 break;
             }
         }
         if ( !done )
         {
-            setScreenshot( map, screenshots.first() );
+            item.screenshotUrl = screenshotUrl( screenshots.first() );
         }
     }
 
-    return PackageItem( map );
+    return item;
 }
 
 PackageItem
@@ -142,7 +141,8 @@ fromAppStream( AppStream::Pool& pool, const QVariantMap& item_map )
         }
         if ( !screenshotPath.isEmpty() )
         {
-            r.screenshot = screenshotPath;
+            r.screenshotPath = screenshotPath;
+            r.screenshotUrl = QUrl();
         }
     }
     return r;
@@ -12,9 +12,11 @@
 #include "ui_page_package.h"
 
 #include "utils/CalamaresUtilsGui.h"
+#include "utils/ImageRegistry.h"
 #include "utils/Logger.h"
 #include "utils/Retranslator.h"
 
+#include <QImageReader>
 #include <QLabel>
 
 PackageChooserPage::PackageChooserPage( PackageChooserMode mode, QWidget* parent )
@@ -77,13 +79,71 @@ smartClip( const QPixmap& pixmap, QSize size )
     return pixmap.scaled( size, Qt::KeepAspectRatio );
 }
 
+/** @brief The size to load the image at @p path at, to fit in @p bounds
+ *
+ * Only the image header is read. Images that already fit are
+ * loaded at their own size, which is QSize( 0, 0 ) for ImageRegistry.
+ */
+static QSize
+fittedSize( const QString& path, const QSize& bounds )
+{
+    const QSize imageSize = QImageReader( path ).size();
+    if ( !imageSize.isValid() || bounds.isEmpty()
+         || ( ( imageSize.width() <= bounds.width() ) && ( imageSize.height() <= bounds.height() ) ) )
+    {
+        return QSize( 0, 0 );
+    }
+    return imageSize.scaled( bounds, Qt::KeepAspectRatio );
+}
+
+void
+PackageChooserPage::showScreenshot( const QPixmap& pixmap, const QString& path )
+{
+    m_screenshotPath = path;
+    if ( path.isEmpty() )
+    {
+        ui->productScreenshot->setPixmap( pixmap.isNull() ? m_introduction.screenshot
+                                                          : smartClip( pixmap, ui->productScreenshot->size() ) );
+        return;
+    }
+
+    QPixmap shown = ImageRegistry::instance()->pixmapAsync(
+        path, fittedSize( path, ui->productScreenshot->size() ), this, [this, path]( const QPixmap& loaded ) {
+            // Only if the user hasn't moved on to something else
+            if ( m_screenshotPath == path )
+            {
+                ui->productScreenshot->setPixmap( loaded.isNull() ? m_introduction.screenshot : loaded );
+            }
+        } );
+    // This is a placeholder if the image is still being loaded
+    ui->productScreenshot->setPixmap( shown.isNull() ? m_introduction.screenshot : shown );
+}
+
+void
+PackageChooserPage::prefetchScreenshots( const QModelIndex& index )
+{
+    const auto* model = ui->products->model();
+    for ( int row : { index.row() - 1, index.row() + 1 } )
+    {
+        const QModelIndex neighbour = model->index( row, 0 );
+        if ( neighbour.isValid() )
+        {
+            const QString path = model->data( neighbour, PackageListModel::ScreenshotPathRole ).toString();
+            if ( !path.isEmpty() )
+            {
+                ImageRegistry::instance()->prefetch( path, fittedSize( path, ui->productScreenshot->size() ) );
+            }
+        }
+    }
+}
+
 void
 PackageChooserPage::currentChanged( const QModelIndex& index )
 {
     if ( !index.isValid() || !ui->products->selectionModel()->hasSelection() )
     {
         ui->productName->setText( m_introduction.name.get() );
-        ui->productScreenshot->setPixmap( m_introduction.screenshot );
+        showScreenshot( m_introduction.screenshot, m_introduction.screenshotPath );
         ui->productDescription->setText( m_introduction.description.get() );
     }
     else
@@ -93,15 +153,9 @@ PackageChooserPage::currentChanged( const QModelIndex& index )
         ui->productName->setText( model->data( index, PackageListModel::NameRole ).toString() );
         ui->productDescription->setText( model->data( index, PackageListModel::DescriptionRole ).toString() );
 
-        QPixmap currentScreenshot = model->data( index, PackageListModel::ScreenshotRole ).value< QPixmap >();
-        if ( currentScreenshot.isNull() )
-        {
-            ui->productScreenshot->setPixmap( m_introduction.screenshot );
-        }
-        else
-        {
-            ui->productScreenshot->setPixmap( smartClip( currentScreenshot, ui->productScreenshot->size() ) );
-        }
+        showScreenshot( model->data( index, PackageListModel::ScreenshotRole ).value< QPixmap >(),
+                        model->data( index, PackageListModel::ScreenshotPathRole ).toString() );
+        prefetchScreenshots( index );
     }
 }
 
@@ -128,6 +182,17 @@ PackageChooserPage::setModel( QAbstractItemModel* model )
              &QItemSelectionModel::selectionChanged,
              this,
              &PackageChooserPage::updateLabels );
+    // Screenshots may arrive after the item is shown
+    connect( model,
+             &QAbstractItemModel::dataChanged,
+             this,
+             [this]( const QModelIndex& topLeft, const QModelIndex& bottomRight ) {
+                 const QModelIndex current = ui->products->selectionModel()->currentIndex();
+                 if ( current.isValid() && topLeft.row() <= current.row() && current.row() <= bottomRight.row() )
+                 {
+                     currentChanged( current );
+                 }
+             } );
 }
 
 void
@@ -173,4 +238,5 @@ PackageChooserPage::setIntroduction( const PackageItem& item )
     m_introduction.name = item.name;
     m_introduction.description = item.description;
     m_introduction.screenshot = item.screenshot;
+    m_introduction.screenshotPath = item.screenshotPath;
 }
@@ -50,8 +50,18 @@ signals:
     void selectionChanged();
 
 private:
+    /** @brief Shows the screenshot at @p path, or else @p pixmap
+     *
+     * Images from a path are loaded at the size they are shown,
+     * in the background if they are not in the ImageRegistry yet.
+     */
+    void showScreenshot( const QPixmap& pixmap, const QString& path );
+    /// @brief Starts loading the screenshots next to @p index
+    void prefetchScreenshots( const QModelIndex& index );
+
     Ui::PackageChooserPage* ui;
     PackageItem m_introduction;
+    QString m_screenshotPath;  ///< What showScreenshot() is showing
 };
 
 #endif  // PACKAGECHOOSERPAGE_H
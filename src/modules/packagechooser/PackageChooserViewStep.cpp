@@ -133,6 +133,22 @@ PackageChooserViewStep::jobs() const
     return l;
 }
 
+bool
+PackageChooserViewStep::releaseWidget()
+{
+    // The selection is in GlobalStorage already, see onLeave()
+    delete m_widget;
+    m_widget = nullptr;
+    return true;
+}
+
+QVariantMap
+PackageChooserViewStep::memoryUsage() const
+{
+    const auto* model = m_config->model();
+    return QVariantMap { { QStringLiteral( "model" ), model ? model->memoryUsage() : qint64( 0 ) } };
+}
+
 void
 PackageChooserViewStep::setConfigurationMap( const QVariantMap& configurationMap )
 {
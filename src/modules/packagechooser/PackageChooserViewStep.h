@@ -42,6 +42,8 @@ public:
     void onLeave() override;
 
     Calamares::JobList jobs() const override;
+    bool releaseWidget() override;
+    QVariantMap memoryUsage() const override;
 
     void setConfigurationMap( const QVariantMap& configurationMap ) override;
 
@@ -9,9 +9,12 @@
 
 #include "PackageModel.h"
 
+#include "network/Manager.h"
 #include "utils/Logger.h"
 #include "utils/Variant.h"
 
+#include <QNetworkReply>
+
 PackageItem::PackageItem() {}
 
 PackageItem::PackageItem( const QString& a_id, const QString& a_name, const QString& a_description )
@@ -24,11 +27,11 @@ PackageItem::PackageItem( const QString& a_id, const QString& a_name, const QStr
 PackageItem::PackageItem( const QString& a_id,
                           const QString& a_name,
                           const QString& a_description,
-                          const QString& screenshotPath )
+                          const QString& a_screenshotPath )
     : id( a_id )
     , name( a_name )
     , description( a_description )
-    , screenshot( screenshotPath )
+    , screenshotPath( a_screenshotPath )
 {
 }
 
@@ -36,7 +39,7 @@ PackageItem::PackageItem::PackageItem( const QVariantMap& item_map )
     : id( CalamaresUtils::getString( item_map, "id" ) )
     , name( CalamaresUtils::Locale::TranslatedString( item_map, "name" ) )
     , description( CalamaresUtils::Locale::TranslatedString( item_map, "description" ) )
-    , screenshot( CalamaresUtils::getString( item_map, "screenshot" ) )
+    , screenshotPath( CalamaresUtils::getString( item_map, "screenshot" ) )
     , packageNames( CalamaresUtils::getStringList( item_map, "packages" ) )
 {
     if ( name.isEmpty() && id.isEmpty() )
@@ -68,17 +71,67 @@ PackageListModel::~PackageListModel() {}
 
 void
 PackageListModel::addPackage( PackageItem&& p )
+{
+    insertPackage( m_packages.count(), std::move( p ) );
+}
+
+void
+PackageListModel::insertPackage( int row, PackageItem&& p )
 {
     // Only add valid packages
     if ( p.isValid() )
     {
-        int c = m_packages.count();
-        beginInsertRows( QModelIndex(), c, c );
-        m_packages.append( p );
+        row = qBound( 0, row, m_packages.count() );
+        beginInsertRows( QModelIndex(), row, row );
+        m_packages.insert( row, p );
         endInsertRows();
     }
 }
 
+void
+PackageListModel::fetchScreenshot( int row )
+{
+    auto& package = m_packages[ row ];
+    const QUrl url = package.screenshotUrl;
+    package.screenshotUrl = QUrl();  // Only try once
+
+    if ( url.isLocalFile() || url.scheme().isEmpty() )
+    {
+        // Local files are loaded by whoever shows them, at the size they need
+        package.screenshotPath = url.isLocalFile() ? url.toLocalFile() : url.toString();
+        return;
+    }
+
+    using namespace CalamaresUtils::Network;
+    QNetworkReply* reply = Manager::instance().asynchronousGet(
+        url, RequestOptions( RequestOptions::FollowRedirect, std::chrono::seconds( 10 ) ) );
+    if ( !reply )
+    {
+        cWarning() << "Could not fetch screenshot" << url;
+        return;
+    }
+    const QString id = package.id;
+    connect( reply, &QNetworkReply::finished, this, [this, reply, id, url]() {
+        reply->deleteLater();
+        QPixmap pixmap;
+        if ( reply->error() != QNetworkReply::NoError || !pixmap.loadFromData( reply->readAll() ) )
+        {
+            cWarning() << "Could not load screenshot" << url;
+            return;
+        }
+        // Rows may have been inserted in the meantime, so look for the id
+        for ( int r = 0; r < m_packages.count(); ++r )
+        {
+            if ( m_packages[ r ].id == id )
+            {
+                m_packages[ r ].screenshot = pixmap;
+                emit dataChanged( index( r ), index( r ), QVector< int > { ScreenshotRole } );
+                break;
+            }
+        }
+    } );
+}
+
 QStringList
 PackageListModel::getInstallPackagesForName( const QString& id ) const
 {
@@ -106,6 +159,25 @@ PackageListModel::getInstallPackagesForNames( const QStringList& ids ) const
     return l;
 }
 
+qint64
+PackageListModel::memoryUsage() const
+{
+    qint64 bytes = qint64( m_packages.count() ) * qint64( sizeof( PackageItem ) );
+    for ( const auto& p : qAsConst( m_packages ) )
+    {
+        qint64 chars = p.id.size() + p.screenshotPath.size() + p.screenshotUrl.toString().size();
+        chars += qint64( p.name.count() ) * p.name.get().size();
+        chars += qint64( p.description.count() ) * p.description.get().size();
+        for ( const auto& name : p.packageNames )
+        {
+            chars += name.size();
+        }
+        bytes += chars * qint64( sizeof( QChar ) );
+        bytes += qint64( p.screenshot.width() ) * p.screenshot.height() * p.screenshot.depth() / 8;
+    }
+    return bytes;
+}
+
 int
 PackageListModel::rowCount( const QModelIndex& index ) const
 {
@@ -134,8 +206,19 @@ PackageListModel::data( const QModelIndex& index, int role ) const
     {
         return m_packages[ row ].description.get();
     }
-    else if ( role == ScreenshotRole )
+    else if ( role == ScreenshotRole || role == ScreenshotPathRole )
     {
+        if ( m_packages[ row ].screenshot.isNull() && m_packages[ row ].screenshotPath.isEmpty()
+             && m_packages[ row ].screenshotUrl.isValid() )
+        {
+            // Screenshots are loaded the first time they are needed; when
+            // one comes from the network, dataChanged() is emitted later.
+            const_cast< PackageListModel* >( this )->fetchScreenshot( row );
+        }
+        if ( role == ScreenshotPathRole )
+        {
+            return m_packages[ row ].screenshotPath;
+        }
         return m_packages[ row ].screenshot;
     }
     else if ( role == IdRole )
@@ -16,6 +16,7 @@
 #include <QAbstractListModel>
 #include <QObject>
 #include <QPixmap>
+#include <QUrl>
 #include <QVector>
 
 
@@ -25,6 +26,20 @@ struct PackageItem
     CalamaresUtils::Locale::TranslatedString name;
     CalamaresUtils::Locale::TranslatedString description;
     QPixmap screenshot;
+    /** @brief The (local or QRC) path of the screenshot
+     *
+     * This is not loaded when the item is created; the page loads
+     * it at the size it is shown at. If it is set, it is used
+     * instead of the screenshot pixmap.
+     */
+    QString screenshotPath;
+    /** @brief Where to get the screenshot from, if it isn't loaded yet
+     *
+     * This is used for AppStream items, where the screenshot is
+     * (usually) remote: PackageListModel fetches it the first time
+     * the screenshot is asked for.
+     */
+    QUrl screenshotUrl;
     QStringList packageNames;
 
     /// @brief Create blank PackageItem
@@ -38,9 +53,9 @@ struct PackageItem
 
     /** @brief Creates a PackageItem from given strings.
      *
-     * Set all the text members and load the screenshot from the given
-     * @p screenshotPath, which may be a QRC path (:/path/in/qrc) or
-     * a filesystem path, whatever QPixmap understands.
+     * Set all the text members and the @p screenshotPath, which may be
+     * a QRC path (:/path/in/qrc) or a filesystem path, whatever QImageReader
+     * understands. The screenshot itself is loaded later.
      */
     PackageItem( const QString& id, const QString& name, const QString& description, const QString& screenshotPath );
 
@@ -89,6 +104,11 @@ public:
      * Only valid packages are added -- that is, they must have a name.
      */
     void addPackage( PackageItem&& p );
+    /** @brief Add a package @p at position @p row in the model
+     *
+     * Only valid packages are added, like addPackage().
+     */
+    void insertPackage( int row, PackageItem&& p );
 
     int rowCount( const QModelIndex& index ) const override;
     QVariant data( const QModelIndex& index, int role ) const override;
@@ -111,15 +131,27 @@ public:
      */
     QStringList getInstallPackagesForNames( const QStringList& ids ) const;
 
+    /** @brief About how many bytes the items take
+     *
+     * This counts the strings and the screenshots that are loaded into
+     * the items. Translations are assumed to be as long as the string
+     * in the current language.
+     */
+    qint64 memoryUsage() const;
+
     enum Roles : int
     {
         NameRole = Qt::DisplayRole,
         DescriptionRole = Qt::UserRole,
         ScreenshotRole,
-        IdRole
+        IdRole,
+        ScreenshotPathRole
     };
 
 private:
+    /// @brief Starts loading the screenshotUrl of the package at @p row
+    void fetchScreenshot( int row );
+
     PackageList m_packages;
 };
 
@@ -59,7 +59,7 @@ PackageChooserTests::testAppData()
     QVariantMap m;
     m.insert( "appdata", appdataName );
 
-#ifdef HAVE_XML
+#ifdef HAVE_APPDATA
     PackageItem p1 = fromAppData( m );
     QVERIFY( p1.isValid() );
     QCOMPARE( p1.id, QStringLiteral( "io.calamares.calamares.desktop" ) );
@@ -71,6 +71,7 @@ PackageChooserTests::testAppData()
     QCOMPARE( p1.description.get( QLocale( "nl" ) ),
               QStringLiteral( "Calamares is een installatieprogramma voor Linux distributies." ) );
     QVERIFY( p1.screenshot.isNull() );
+    QVERIFY( p1.screenshotPath.isEmpty() );
 
     m.insert( "id", "calamares" );
     m.insert( "screenshot", ":/images/calamares.png" );
@@ -79,6 +80,64 @@ PackageChooserTests::testAppData()
     QCOMPARE( p2.id, QStringLiteral( "calamares" ) );
     QCOMPARE( p2.description.get( QLocale( "nl" ) ),
               QStringLiteral( "Calamares is een installatieprogramma voor Linux distributies." ) );
-    QVERIFY( !p2.screenshot.isNull() );
+    // The screenshot is loaded only when it is shown
+    QCOMPARE( p2.screenshotPath, QStringLiteral( ":/images/calamares.png" ) );
+    QVERIFY( !QImage( p2.screenshotPath ).isNull() );
+#endif
+}
+
+#ifdef HAVE_APPDATA
+static void
+writeAppData( const QString& path, const QByteArray& name )
+{
+    QFile f( path );
+    QVERIFY( f.open( QIODevice::WriteOnly | QIODevice::Truncate ) );
+    f.write( "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<component>\n  <id>cached.desktop</id>\n  <name>" );
+    f.write( name );
+    f.write( "</name>\n  <summary>Cached item</summary>\n</component>\n" );
+}
+#endif
+
+void
+PackageChooserTests::testAppDataCache()
+{
+#ifdef HAVE_APPDATA
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString path = dir.filePath( "cached.appdata.xml" );
+    const QVariantMap m { { "appdata", path } };
+
+    writeAppData( path, "First" );
+    const QDateTime modified = QFileInfo( path ).lastModified();
+    PackageItem p1 = fromAppData( m );
+    QVERIFY( p1.isValid() );
+    QCOMPARE( p1.id, QStringLiteral( "cached.desktop" ) );
+    QCOMPARE( p1.name.get(), QStringLiteral( "First" ) );
+
+    // Same size and modification time: the file is not read again
+    writeAppData( path, "Other" );
+    {
+        QFile f( path );
+        QVERIFY( f.open( QIODevice::ReadWrite ) );
+        QVERIFY( f.setFileTime( modified, QFileDevice::FileModificationTime ) );
+    }
+    QCOMPARE( fromAppData( m ).name.get(), QStringLiteral( "First" ) );
+
+    // A new modification time invalidates the entry
+    {
+        QFile f( path );
+        QVERIFY( f.open( QIODevice::ReadWrite ) );
+        QVERIFY( f.setFileTime( modified.addSecs( 10 ), QFileDevice::FileModificationTime ) );
+    }
+    QCOMPARE( fromAppData( m ).name.get(), QStringLiteral( "Other" ) );
+
+    // Broken XML gives no item, from a fresh parse as well as from the cache
+    {
+        QFile f( path );
+        QVERIFY( f.open( QIODevice::WriteOnly | QIODevice::Truncate ) );
+        f.write( "<component><id>broken</id><name>Broken</component>" );
+    }
+    QVERIFY( !fromAppData( m ).isValid() );
+    QVERIFY( !fromAppData( m ).isValid() );
 #endif
 }
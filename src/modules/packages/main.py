@@ -15,11 +15,15 @@
 #
 
 import abc
+import os
+import re
+import shlex
 from string import Template
 import subprocess
 
 import libcalamares
-from libcalamares.utils import check_target_env_call, target_env_call
+from libcalamares.utils import check_target_env_call
+from libcalamares.utils import check_target_env_process_output
 from libcalamares.utils import gettext_path, gettext_languages
 
 import gettext
@@ -34,6 +38,7 @@ _n = _translation.ngettext
 total_packages = 0  # For the entire job
 completed_packages = 0  # Done so far for this job
 group_packages = 0  # One group of packages from an -install or -remove entry
+group_done = 0  # Packages of the group for which commands have finished
 
 INSTALL = object()
 REMOVE = object()
@@ -46,6 +51,16 @@ def _change_mode(mode):
     libcalamares.job.setprogress(completed_packages * 1.0 / total_packages)
 
 
+def _group_progress(count, fraction):
+    """
+    Sets the progress of the job while a command that handles
+    @p count packages of the current group is @p fraction done.
+    """
+    if total_packages > 0:
+        done = min(group_done + fraction * count, group_packages)
+        libcalamares.job.setprogress((completed_packages + done) * 1.0 / total_packages)
+
+
 def pretty_name():
     return _("Install packages.")
 
@@ -83,13 +98,15 @@ class PackageManager(metaclass=abc.ABCMeta):
     backends.
     """
     backend = None
+    # Where the package manager keeps downloaded packages, in the
+    # target system; None if it is not one directory of package files.
+    cache_dir = None
 
     @abc.abstractmethod
     def install(self, pkgs, from_local=False):
         """
-        Install a list of packages (named) into the system.
-        Although this handles lists, in practice it is called
-        with one package at a time.
+        Install a list of packages (named) into the system,
+        as one transaction if the package manager can do that.
 
         @param pkgs: list[str]
             list of package names
@@ -113,10 +130,44 @@ class PackageManager(metaclass=abc.ABCMeta):
     def update_db(self):
         pass
 
+    def download_command(self, pkgs):
+        """
+        Returns the command (a list of strings, to be run in the target
+        system) that downloads the packages @p pkgs, and what they
+        depend on, into the package cache without installing anything;
+        or None if the package manager cannot do that.
+
+        @param pkgs: list[str]
+            list of package names
+        """
+        return None
+
     def run(self, script):
         if script != "":
             check_target_env_call(script.split(" "))
 
+    def run_with_progress(self, command, pkgs, parse_line):
+        """
+        Runs @p command (like check_target_env_call) for the packages
+        @p pkgs. Each line of output is passed to @p parse_line, which
+        returns the fraction (0..1) of the work that is done, or None
+        if the line says nothing about progress; the job progress is
+        updated from that while the command runs.
+        """
+        global group_done
+        best = [0.0]
+
+        def update(line):
+            fraction = parse_line(line)
+            if fraction is not None and fraction > best[0]:
+                best[0] = min(fraction, 1.0)
+                _group_progress(len(pkgs), best[0])
+
+        try:
+            check_target_env_process_output(command, update)
+        finally:
+            group_done += len(pkgs)
+
     def install_package(self, packagedata, from_local=False):
         """
         Install a package from a single entry in the install list.
@@ -159,18 +210,37 @@ class PackageManager(metaclass=abc.ABCMeta):
 
         This operation is called for "critical" packages,
         which are expected to succeed, or fail, all together.
-        However, if there are packages with pre- or post-scripts,
-        then packages are installed one-by-one instead.
+        Consecutive plain package names are installed together;
+        packages with pre- or post-scripts are installed one-by-one,
+        in between, so that the scripts run in the right order.
 
         NOTE: package managers may reimplement this method
         NOTE: exceptions are expected to leave this method, to indicate
               failure of the installation.
         """
-        if all([isinstance(x, str) for x in package_list]):
-            self.install(package_list, from_local=from_local)
-        else:
-            for package in package_list:
-                self.install_package(package, from_local=from_local)
+        for batch in _batches(package_list):
+            if isinstance(batch, list):
+                self.install(batch, from_local=from_local)
+            else:
+                self.install_package(batch, from_local=from_local)
+
+    def _try_batch(self, action, description, package_list):
+        """
+        Calls @p action with the list of package names @p package_list
+        at once. If that fails, the list is split in two and each half
+        is tried again (and so on), so that only the packages that
+        fail by themselves are left out; those are reported with
+        @p description ("install" or "remove").
+        """
+        try:
+            action(package_list)
+        except subprocess.CalledProcessError:
+            if len(package_list) <= 1:
+                libcalamares.utils.warning("Could not {!s} package {!s}".format(description, " ".join(package_list)))
+            else:
+                half = len(package_list) // 2
+                self._try_batch(action, description, package_list[:half])
+                self._try_batch(action, description, package_list[half:])
 
     def operation_try_install(self, package_list):
         """
@@ -180,19 +250,21 @@ class PackageManager(metaclass=abc.ABCMeta):
 
         This operation is called for "non-critical" packages,
         which can succeed or fail without affecting the overall installation.
-        Packages are installed one-by-one to support package managers
-        that do not have a "install as much as you can" mode.
+        Plain package names are installed all together first; only if
+        that fails are they installed in smaller groups, to support package
+        managers that do not have a "install as much as you can" mode.
 
         NOTE: package managers may reimplement this method
         NOTE: no package-installation exceptions should be raised
         """
-        # we make a separate package manager call for each package so a
-        # single failing package won't stop all of them
-        for package in package_list:
-            try:
-                self.install_package(package)
-            except subprocess.CalledProcessError:
-                libcalamares.utils.warning("Could not install package %s" % package)
+        for batch in _batches(package_list):
+            if isinstance(batch, list):
+                self._try_batch(self.install, "install", batch)
+            else:
+                try:
+                    self.install_package(batch)
+                except subprocess.CalledProcessError:
+                    libcalamares.utils.warning("Could not install package %s" % batch)
 
     def operation_remove(self, package_list):
         """
@@ -201,32 +273,132 @@ class PackageManager(metaclass=abc.ABCMeta):
         structures (with a pre- and post-install step).
 
         This operation is called for "critical" packages, which are
-        expected to succeed or fail all together.
-        However, if there are packages with pre- or post-scripts,
-        then packages are removed one-by-one instead.
+        expected to succeed or fail all together. As with installing,
+        packages with pre- or post-scripts are removed one-by-one.
 
         NOTE: package managers may reimplement this method
         NOTE: exceptions should be raised to indicate failure
         """
-        if all([isinstance(x, str) for x in package_list]):
-            self.remove(package_list)
-        else:
-            for package in package_list:
-                self.remove_package(package)
+        for batch in _batches(package_list):
+            if isinstance(batch, list):
+                self.remove(batch)
+            else:
+                self.remove_package(batch)
 
     def operation_try_remove(self, package_list):
         """
         Same relation as try_install has to install, except it removes
-        packages instead. Packages are removed one-by-one.
+        packages instead.
 
         NOTE: package managers may reimplement this method
         NOTE: no package-installation exceptions should be raised
         """
-        for package in package_list:
-            try:
-                self.remove_package(package)
-            except subprocess.CalledProcessError:
-                libcalamares.utils.warning("Could not remove package %s" % package)
+        for batch in _batches(package_list):
+            if isinstance(batch, list):
+                self._try_batch(self.remove, "remove", batch)
+            else:
+                try:
+                    self.remove_package(batch)
+                except subprocess.CalledProcessError:
+                    libcalamares.utils.warning("Could not remove package %s" % batch)
+
+
+def _count_progress(pattern, line):
+    """
+    Returns the fraction done from a line of output matching the
+    regular expression @p pattern, which has groups for the number
+    of the current step and the total number of steps; or None.
+    """
+    m = pattern.search(line)
+    if m is None or int(m.group(2)) < 1:
+        return None
+    return (int(m.group(1)) - 1) / int(m.group(2))
+
+
+# With -o APT::Status-Fd=1 apt reports "dlstatus:" while downloading
+# and "pmstatus:" while installing, with a percentage, e.g.
+#   pmstatus:vim:47.0588:Installing vim (amd64)
+_apt_status = re.compile(r"^(dlstatus|pmstatus):[^:]*:([0-9.]+):")
+_apt_download_weight = 0.3
+
+
+def _apt_progress(line):
+    m = _apt_status.match(line)
+    if m is None:
+        return None
+    fraction = float(m.group(2)) / 100.0
+    if m.group(1) == "dlstatus":
+        return _apt_download_weight * fraction
+    return _apt_download_weight + (1.0 - _apt_download_weight) * fraction
+
+
+# e.g. "  Installing       : vim-enhanced-9.0-1.fc38.x86_64     3/5"
+_dnf_step = re.compile(r"^\s*(?:Installing|Upgrading|Reinstalling|Downgrading|Removing|Erasing|Cleanup|Verifying)"
+                       r"\s*:.*\s(\d+)/(\d+)\s*$")
+
+
+def _dnf_progress(line):
+    return _count_progress(_dnf_step, line)
+
+
+# e.g. "(3/5) installing vim" with a progress bar, which pacman only
+# shows on a terminal. Otherwise (as here) the output has the number of
+# packages, e.g. "Packages (5) vim-9.0-1 ...", and then "installing vim..."
+# for each of them.
+_pacman_step = re.compile(r"^\(\s*(\d+)/\s*(\d+)\)\s+(?:installing|upgrading|reinstalling|downgrading|removing)\s")
+_pacman_total = re.compile(r"^Packages \((\d+)\)")
+_pacman_operation = re.compile(r"^(?:installing|upgrading|reinstalling|downgrading|removing)\s+\S+\.\.\.\s*$")
+
+
+class _PacmanProgress:
+    """
+    Progress of a pacman command for @p count packages, from its lines of
+    output. Dependencies may make pacman do more than @p count packages,
+    so the count it reports itself is used when it is there.
+    """
+    def __init__(self, count):
+        self.total = count
+        self.done = 0
+
+    def __call__(self, line):
+        fraction = _count_progress(_pacman_step, line)
+        if fraction is not None:
+            return fraction
+        m = _pacman_total.match(line)
+        if m is not None:
+            self.total = int(m.group(1))
+            return None
+        if self.total < 1 or _pacman_operation.match(line) is None:
+            return None
+        self.done += 1
+        return (self.done - 1) / self.total
+
+
+# e.g. "(3/5) Installing: vim-9.0-1.1.x86_64 ...[done]"
+_zypper_step = re.compile(r"^\(\s*(\d+)/\s*(\d+)\)\s+(?:Installing|Removing)")
+
+
+def _zypper_progress(line):
+    return _count_progress(_zypper_step, line)
+
+
+def _batches(package_list):
+    """
+    Splits @p package_list into batches: each run of consecutive
+    plain package names becomes one list, while each package with
+    pre- or post-scripts (a dict) is a batch by itself.
+    """
+    batch = []
+    for package in package_list:
+        if isinstance(package, str):
+            batch.append(package)
+        else:
+            if batch:
+                yield batch
+                batch = []
+            yield package
+    if batch:
+        yield batch
 
 ### PACKAGE MANAGER IMPLEMENTATIONS
 #
@@ -254,13 +426,18 @@ class PMApk(PackageManager):
 
 class PMApt(PackageManager):
     backend = "apt"
+    cache_dir = "/var/cache/apt/archives"
 
     def install(self, pkgs, from_local=False):
-        check_target_env_call(["apt-get", "-q", "-y", "install"] + pkgs)
+        self.run_with_progress(["apt-get", "-q", "-y", "-o", "APT::Status-Fd=1",
+                                "install"] + pkgs, pkgs, _apt_progress)
+
+    def download_command(self, pkgs):
+        return ["apt-get", "-q", "-y", "--download-only", "install"] + pkgs
 
     def remove(self, pkgs):
-        check_target_env_call(["apt-get", "--purge", "-q", "-y",
-                               "remove"] + pkgs)
+        self.run_with_progress(["apt-get", "--purge", "-q", "-y", "-o", "APT::Status-Fd=1",
+                                "remove"] + pkgs, pkgs, _apt_progress)
         check_target_env_call(["apt-get", "--purge", "-q", "-y",
                                "autoremove"])
 
@@ -276,13 +453,19 @@ class PMDnf(PackageManager):
     backend = "dnf"
 
     def install(self, pkgs, from_local=False):
-        check_target_env_call(["dnf", "-y", "install"] + pkgs)
+        self.run_with_progress(["dnf", "-y", "install"] + pkgs, pkgs, _dnf_progress)
+
+    def download_command(self, pkgs):
+        return ["dnf", "-y", "install", "--downloadonly"] + pkgs
 
     def remove(self, pkgs):
         # ignore the error code for now because dnf thinks removing a
         # nonexistent package is an error
-        target_env_call(["dnf", "--disablerepo=*", "-C", "-y",
-                         "remove"] + pkgs)
+        try:
+            self.run_with_progress(["dnf", "--disablerepo=*", "-C", "-y",
+                                    "remove"] + pkgs, pkgs, _dnf_progress)
+        except subprocess.CalledProcessError:
+            pass
 
     def update_db(self):
         # Doesn't need updates
@@ -369,6 +552,7 @@ class PMPackageKit(PackageManager):
 
 class PMPacman(PackageManager):
     backend = "pacman"
+    cache_dir = "/var/cache/pacman/pkg"
 
     def install(self, pkgs, from_local=False):
         if from_local:
@@ -376,11 +560,14 @@ class PMPacman(PackageManager):
         else:
             pacman_flags = "-S"
 
-        check_target_env_call(["pacman", pacman_flags,
-                               "--noconfirm"] + pkgs)
+        self.run_with_progress(["pacman", pacman_flags,
+                                "--noconfirm"] + pkgs, pkgs, _PacmanProgress(len(pkgs)))
+
+    def download_command(self, pkgs):
+        return ["pacman", "-Sw", "--noconfirm"] + pkgs
 
     def remove(self, pkgs):
-        check_target_env_call(["pacman", "-Rs", "--noconfirm"] + pkgs)
+        self.run_with_progress(["pacman", "-Rs", "--noconfirm"] + pkgs, pkgs, _PacmanProgress(len(pkgs)))
 
     def update_db(self):
         check_target_env_call(["pacman", "-Sy"])
@@ -391,6 +578,7 @@ class PMPacman(PackageManager):
 
 class PMPamac(PackageManager):
     backend = "pamac"
+    cache_dir = "/var/cache/pacman/pkg"
 
     def del_db_lock(self, lock="/var/lib/pacman/db.lck"):
         # In case some error or crash, the database will be locked,
@@ -471,6 +659,9 @@ class PMYum(PackageManager):
     def install(self, pkgs, from_local=False):
         check_target_env_call(["yum", "-y", "install"] + pkgs)
 
+    def download_command(self, pkgs):
+        return ["yum", "-y", "install", "--downloadonly"] + pkgs
+
     def remove(self, pkgs):
         check_target_env_call(["yum", "--disablerepo=*", "-C", "-y",
                                "remove"] + pkgs)
@@ -487,14 +678,18 @@ class PMZypp(PackageManager):
     backend = "zypp"
 
     def install(self, pkgs, from_local=False):
-        check_target_env_call(["zypper", "--non-interactive",
-                               "--quiet-install", "install",
-                               "--auto-agree-with-licenses",
-                               "install"] + pkgs)
+        self.run_with_progress(["zypper", "--non-interactive",
+                                "--quiet-install", "install",
+                                "--auto-agree-with-licenses",
+                                "install"] + pkgs, pkgs, _zypper_progress)
+
+    def download_command(self, pkgs):
+        return ["zypper", "--non-interactive", "install",
+                "--auto-agree-with-licenses", "--download-only"] + pkgs
 
     def remove(self, pkgs):
-        check_target_env_call(["zypper", "--non-interactive",
-                               "remove"] + pkgs)
+        self.run_with_progress(["zypper", "--non-interactive",
+                                "remove"] + pkgs, pkgs, _zypper_progress)
 
     def update_db(self):
         check_target_env_call(["zypper", "--non-interactive", "update"])
@@ -557,6 +752,69 @@ def subst_locale(plist):
     return ret
 
 
+# The direction of each package operation. Operations with the same
+# key may be merged when there are only operations in the same
+# direction in between.
+_operation_direction = {
+    "install": INSTALL,
+    "try_install": INSTALL,
+    "localInstall": INSTALL,
+    "remove": REMOVE,
+    "try_remove": REMOVE,
+    }
+
+
+def plan_operations(operations):
+    """
+    Merges the package operations @p operations into as few
+    package-manager transactions as possible.
+
+    @param operations: list[dict]
+        Package operations, as in the *operations* configuration
+        (followed by those from GlobalStorage, e.g. from netinstall).
+    @return: list[dict]
+        Operations with a single key each, and the packages localized
+        (see subst_locale()), in the order they should be done.
+
+    An operation is merged into an earlier operation with the
+    same key, as long as the operations in between go in the same
+    direction (e.g. only installs between two *install*s). Operations
+    with packages that have pre- or post-scripts, and *localInstall*
+    operations, are left where they are, since their order may matter.
+    Packages that are already listed in a step are not repeated.
+    """
+    steps = []  # Each is [key, package_list, movable]
+    for entry in operations:
+        for key, packages in entry.items():
+            if key == "source":
+                libcalamares.utils.debug("Package-list from {!s}".format(packages))
+                continue
+            if key not in _operation_direction:
+                libcalamares.utils.warning("Unknown package-operation key {!s}".format(key))
+                continue
+
+            package_list = subst_locale(packages)
+            movable = key != "localInstall" and all([isinstance(x, str) for x in package_list])
+            target = None
+            if movable:
+                for step in reversed(steps):
+                    if _operation_direction[step[0]] is not _operation_direction[key] or not step[2]:
+                        break
+                    if step[0] == key:
+                        target = step
+                        break
+            if target is None:
+                target = [key, [], movable]
+                steps.append(target)
+            for package in package_list:
+                if not isinstance(package, str) or package not in target[1]:
+                    target[1].append(package)
+
+    plan = [{key: package_list} for key, package_list, _ in steps if package_list]
+    libcalamares.utils.debug("Package operations: {!s} planned as {!s} steps".format(len(operations), len(plan)))
+    return plan
+
+
 def run_operations(pkgman, entry):
     """
     Call package manager with suitable parameters for the given
@@ -570,13 +828,15 @@ def run_operations(pkgman, entry):
         not iterated in a specific order, so it is recommended to use only
         one action per dictionary. The list of packages may be package
         names (strings) or package information dictionaries with pre-
-        and post-scripts.
+        and post-scripts, and has been localized already (see
+        plan_operations()).
     """
-    global group_packages, completed_packages, mode_packages
+    global group_packages, group_done, completed_packages, mode_packages
 
     for key in entry.keys():
-        package_list = subst_locale(entry[key])
+        package_list = entry[key]
         group_packages = len(package_list)
+        group_done = 0
         if key == "install":
             _change_mode(INSTALL)
             pkgman.operation_install(package_list)
@@ -604,6 +864,162 @@ def run_operations(pkgman, entry):
     _change_mode(None)
 
 
+# GlobalStorage key for the files in the package cache before a
+# background download, see PackageCache.remember()
+_cache_key = "packagesCacheBefore"
+
+
+class PackageCache:
+    """
+    Seeds the package cache of the target system from a cache
+    (or local repository) on the live medium, as configured with
+    *package_cache*, and counts what had to be downloaded anyway.
+    """
+    def __init__(self, pkgman, config):
+        self.source = config.get("source", None) if config else None
+        self.mode = config.get("mode", "copy") if config else "copy"
+        self.destination = None
+        self.seeded = 0
+        self.before = set()
+
+        destination = (config.get("destination", None) if config else None) or pkgman.cache_dir
+        root_mount_point = libcalamares.globalstorage.value("rootMountPoint")
+        if self.source and destination and root_mount_point:
+            self.destination = os.path.join(root_mount_point, destination.lstrip("/"))
+        elif self.source:
+            libcalamares.utils.warning("No destination for the package cache {!s}".format(self.source))
+
+    def _files(self):
+        try:
+            return set([f.name for f in os.scandir(self.destination) if f.is_file()])
+        except OSError:
+            return set()
+
+    def seed(self):
+        """
+        Bind-mounts or copies the files of the cache into the
+        package cache of the target system. A bind-mount stays
+        until the umount module; the source must be writable then,
+        since the package manager puts its downloads there as well.
+        """
+        if not self.destination:
+            return
+        if not os.path.isdir(self.source):
+            libcalamares.utils.warning("Package cache {!s} does not exist".format(self.source))
+            self.destination = None
+            return
+
+        os.makedirs(self.destination, exist_ok=True)
+        if self.mode == "bind":
+            if not os.path.ismount(self.destination):
+                r = libcalamares.utils.mount(self.source, self.destination, "", "--bind")
+                if r != 0:
+                    libcalamares.utils.warning("Could not bind-mount package cache {!s}".format(self.source))
+            self.seeded = len(self._files())
+        else:
+            files = [f.path for f in os.scandir(self.source) if f.is_file()]
+            if files:
+                # Share data blocks where possible, keep packages already there
+                r = subprocess.call(["cp", "--preserve=timestamps", "--reflink=auto", "--no-clobber"]
+                                    + files + [self.destination])
+                if r != 0:
+                    libcalamares.utils.warning("Could not copy all of package cache {!s}".format(self.source))
+            self.seeded = len(files)
+        if libcalamares.globalstorage.contains(_cache_key):
+            # An earlier instance downloaded in the background since
+            self.before = set(libcalamares.globalstorage.value(_cache_key) or [])
+        else:
+            self.before = self._files()
+        libcalamares.utils.debug("Package cache {!s} ({!s}): {!s} packages".format(
+            self.source, self.mode, self.seeded))
+
+    def remember(self):
+        """
+        Stores the files in the cache, before a background download
+        starts, for the instance of this module that installs them:
+        what the download adds counts as downloaded there.
+        """
+        if self.destination:
+            libcalamares.globalstorage.insert(_cache_key, sorted(self.before))
+
+    def report(self, downloaded=True):
+        """
+        Logs, and adds to the statistics of the job (*packagesSeeded*
+        and *packagesDownloaded*, see *jobStatistics* in GlobalStorage),
+        how many packages were seeded and how many were downloaded
+        (that is, not found in the cache) since. With @p downloaded
+        False, while a download is still running, only the first.
+        """
+        if not self.destination:
+            return
+        libcalamares.job.add_statistic("packagesSeeded", self.seeded)
+        if not downloaded:
+            libcalamares.utils.debug("Package cache: {!s} seeded".format(self.seeded))
+            return
+        count = len(self._files() - self.before)
+        libcalamares.globalstorage.remove(_cache_key)
+        libcalamares.utils.debug("Package cache: {!s} seeded, {!s} downloaded".format(self.seeded, count))
+        libcalamares.job.add_statistic("packagesDownloaded", count)
+
+
+# GlobalStorage key for the background download, see start_download()
+_download_key = "packagesDownload"
+
+
+def start_download(pkgman, operations):
+    """
+    Starts downloading, in the background, the packages that
+    @p operations (a plan, see plan_operations()) will install.
+    The download runs in the target system, like the installation
+    will; its process ID is stored in GlobalStorage so that a later
+    instance of this module can wait for it (see wait_for_download()).
+
+    The packages of *install* operations are downloaded first, then
+    those of *try_install* (where a failure does not matter).
+    Returns True if a download was started.
+    """
+    commands = []
+    for key in ("install", "try_install"):
+        pkgs = [p for op in operations for p in op.get(key, []) if isinstance(p, str)]
+        command = pkgman.download_command(pkgs) if pkgs else None
+        if command:
+            commands.append(" ".join([shlex.quote(c) for c in command]))
+    if not commands:
+        return False
+
+    root_mount_point = libcalamares.globalstorage.value("rootMountPoint")
+    if not root_mount_point:
+        libcalamares.utils.warning("No rootMountPoint to download packages into")
+        return False
+    # Each command may fail, the installation later will try again
+    script = " ; ".join(commands) + " ; true"
+    process = subprocess.Popen(["chroot", root_mount_point, "/bin/sh", "-c", script],
+                               stdin=subprocess.DEVNULL, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL,
+                               start_new_session=True)
+    libcalamares.utils.debug("Downloading packages in the background, pid {!s}: {!s}".format(process.pid, script))
+    libcalamares.globalstorage.insert(_download_key, process.pid)
+    return True
+
+
+def wait_for_download():
+    """
+    If a background download was started (by an earlier instance of
+    this module), waits for it to finish, so that the package manager
+    is free again and the packages are in the cache.
+    """
+    if not libcalamares.globalstorage.contains(_download_key):
+        return
+
+    pid = libcalamares.globalstorage.value(_download_key)
+    libcalamares.globalstorage.remove(_download_key)
+    libcalamares.utils.debug("Waiting for package download, pid {!s}".format(pid))
+    try:
+        os.waitpid(int(pid), 0)
+    except (ChildProcessError, ValueError, TypeError):
+        # Already finished (and reaped) or not ours
+        pass
+
+
 def run():
     """
     Calls routine with detected package manager to install locale packages
@@ -627,8 +1043,25 @@ def run():
         libcalamares.utils.warning( "Package installation has been skipped: no internet" )
         return None
 
+    download_only = libcalamares.job.configuration.get("download_only", False)
+    if download_only and not libcalamares.globalstorage.value("hasInternet"):
+        libcalamares.utils.debug("Not downloading packages: no internet")
+        return None
+    # Before using the package manager at all, let a download finish
+    wait_for_download()
+
+    cache = PackageCache(pkgman, libcalamares.job.configuration.get("package_cache", None))
+    cache.seed()
+
+    # Updating the database and the system take a while, and don't
+    # report any progress themselves; they get a phase of the job
+    # each, and the package operations get the rest.
     update_db = libcalamares.job.configuration.get("update_db", False)
-    if update_db and libcalamares.globalstorage.value("hasInternet"):
+    update_db = update_db and libcalamares.globalstorage.value("hasInternet")
+    update_system = libcalamares.job.configuration.get("update_system", False)
+    update_system = update_system and not download_only and libcalamares.globalstorage.value("hasInternet")
+    if update_db:
+        libcalamares.job.begin_phase(_("Updating the package database."), 0.1)
         try:
             pkgman.update_db()
         except subprocess.CalledProcessError as e:
@@ -639,8 +1072,8 @@ def run():
                     _("The package manager could not prepare updates. The command <pre>{!s}</pre> returned error code {!s}.")
                     .format(e.cmd, e.returncode))
 
-    update_system = libcalamares.job.configuration.get("update_system", False)
-    if update_system and libcalamares.globalstorage.value("hasInternet"):
+    if update_system:
+        libcalamares.job.begin_phase(_("Updating the installed packages."), 0.3)
         try:
             pkgman.update_system()
         except subprocess.CalledProcessError as e:
@@ -654,18 +1087,28 @@ def run():
     operations = libcalamares.job.configuration.get("operations", [])
     if libcalamares.globalstorage.contains("packageOperations"):
         operations += libcalamares.globalstorage.value("packageOperations")
+    operations = plan_operations(operations)
+
+    if download_only:
+        cache.remember()
+        start_download(pkgman, operations)
+        cache.report(downloaded=False)
+        return None
 
     mode_packages = None
     total_packages = 0
     completed_packages = 0
     for op in operations:
         for packagelist in op.values():
-            total_packages += len(subst_locale(packagelist))
+            total_packages += len(packagelist)
 
     if not total_packages:
         # Avoids potential divide-by-zero in progress reporting
+        cache.report()
         return None
 
+    # Unnamed, so that pretty_status_message() is shown
+    libcalamares.job.begin_phase("", 1.0)
     for entry in operations:
         group_packages = 0
         libcalamares.utils.debug(pretty_name())
@@ -680,6 +1123,7 @@ def run():
                     .format(e.cmd, e.returncode))
 
     mode_packages = None
+    cache.report()
 
     libcalamares.job.setprogress(1.0)
 
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# === This file is part of Calamares - <https://calamares.io> ===
+#
+#   SPDX-FileCopyrightText: 2026 agent <agent@local>
+#   SPDX-License-Identifier: GPL-3.0-or-later
+#
+#   Calamares is Free Software: see the License-Identifier above.
+#
+# Checks the progress that the packages module reports from the output
+# of a package manager. The output is read from a file captured from
+# the package manager with its output not on a terminal, as when
+# Calamares runs it.
+#
+# Usage: progress.py <main.py> <captured output> <number of packages>
+
+import importlib.util
+import sys
+import types
+
+
+def stub_libcalamares(output_lines, progress):
+    """
+    Makes a libcalamares module that is just enough to load main.py:
+    running a command "outputs" @p output_lines, and the progress that
+    is set is appended to @p progress.
+    """
+    libcalamares = types.ModuleType("libcalamares")
+    utils = types.ModuleType("libcalamares.utils")
+    job = types.ModuleType("libcalamares.job")
+
+    def process_output(command, callback):
+        for line in output_lines:
+            callback(line)
+        return 0
+
+    utils.check_target_env_call = lambda *args, **kwargs: 0
+    utils.check_target_env_process_output = process_output
+    utils.gettext_path = lambda: None
+    utils.gettext_languages = lambda: []
+    utils.debug = lambda *args: None
+    utils.warning = lambda *args: None
+    job.setprogress = progress.append
+    job.configuration = {}
+    libcalamares.utils = utils
+    libcalamares.job = job
+    sys.modules["libcalamares"] = libcalamares
+    sys.modules["libcalamares.utils"] = utils
+
+
+def main(module_file, output_file, count):
+    with open(output_file, "r") as f:
+        output_lines = f.readlines()
+    progress = []
+    stub_libcalamares(output_lines, progress)
+
+    spec = importlib.util.spec_from_file_location("packages", module_file)
+    packages = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(packages)
+
+    pkgs = ["package{!s}".format(i) for i in range(count)]
+    packages.total_packages = count
+    packages.group_packages = count
+    packages.PMPacman().install(pkgs)
+
+    print("Progress", progress)
+    # One step for each package that pacman installs, and none for hooks
+    steps = len([line for line in output_lines if line.startswith("installing ")])
+    assert len(progress) == steps - 1, "Expected {!s} progress updates".format(steps - 1)
+    assert progress == sorted(progress), "Progress goes backwards"
+    assert 0.0 < progress[0] and progress[-1] < 1.0, "Progress out of range"
+    assert packages.group_done == count
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1], sys.argv[2], int(sys.argv[3])))
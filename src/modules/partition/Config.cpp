@@ -40,7 +40,18 @@ Config::swapChoiceNames()
                                                       { QStringLiteral( "small" ), SwapChoice::SmallSwap },
                                                       { QStringLiteral( "suspend" ), SwapChoice::FullSwap },
                                                       { QStringLiteral( "reuse" ), SwapChoice::ReuseSwap },
-                                                      { QStringLiteral( "file" ), SwapChoice::SwapFile } };
+                                                      { QStringLiteral( "file" ), SwapChoice::SwapFile },
+                                                      { QStringLiteral( "zram" ), SwapChoice::ZRamSwap } };
+
+    return names;
+}
+
+const NamedEnumTable< Config::EraseDiscard >&
+Config::eraseDiscardNames()
+{
+    static const NamedEnumTable< EraseDiscard > names { { QStringLiteral( "none" ), EraseDiscard::NoDiscard },
+                                                        { QStringLiteral( "discard" ), EraseDiscard::PlainDiscard },
+                                                        { QStringLiteral( "secure" ), EraseDiscard::SecureDiscard } };
 
     return names;
 }
@@ -190,7 +201,7 @@ Config::setInstallChoice( InstallChoice c )
 void
 Config::setSwapChoice( int c )
 {
-    if ( ( c < SwapChoice::NoSwap ) || ( c > SwapChoice::SwapFile ) )
+    if ( ( c < SwapChoice::NoSwap ) || ( c > SwapChoice::ZRamSwap ) )
     {
         cWarning() << "Invalid swap choice (int)" << c;
         c = SwapChoice::NoSwap;
@@ -213,6 +224,8 @@ void
 Config::setEraseFsTypeChoice( const QString& choice )
 {
     QString canonicalChoice = PartUtils::canonicalFilesystemName( choice, nullptr );
+    // Even picking the default is a choice, which the profiles do not override
+    m_eraseFsTypeChosen = true;
     if ( canonicalChoice != m_eraseFsTypeChoice )
     {
         m_eraseFsTypeChoice = canonicalChoice;
@@ -297,9 +310,53 @@ Config::fillConfigurationFSTypes( const QVariantMap& configurationMap )
     Q_ASSERT( !m_eraseFsTypes.isEmpty() );
     Q_ASSERT( m_eraseFsTypes.contains( fsRealName ) );
     m_eraseFsTypeChoice = fsRealName;
+    m_eraseFsTypeChosen = false;
     Q_EMIT eraseModeFilesystemChanged( m_eraseFsTypeChoice );
 }
 
+/** @brief Reads *deviceClassProfiles*, a map of device class to profile
+ *
+ * Unknown classes are kept (with a warning), since they do no harm.
+ * A *fileSystemType* that KPMcore does not know is dropped.
+ */
+static QHash< QString, Config::DeviceClassProfile >
+getDeviceClassProfiles( const QVariantMap& configurationMap )
+{
+    static const QStringList knownClasses { "nvme", "ssd", "hdd", "mmc", "virtual" };
+
+    QHash< QString, Config::DeviceClassProfile > profiles;
+    bool found = false;
+    const QVariantMap map = CalamaresUtils::getSubMap( configurationMap, "deviceClassProfiles", found );
+    for ( auto it = map.cbegin(); it != map.cend(); ++it )
+    {
+        if ( !knownClasses.contains( it.key() ) )
+        {
+            cWarning() << "Partition-module *deviceClassProfiles* has unknown device class" << it.key();
+        }
+        const QVariantMap m = it.value().toMap();
+        Config::DeviceClassProfile profile;
+        const QString fsName = CalamaresUtils::getString( m, "fileSystemType" );
+        if ( !fsName.isEmpty() )
+        {
+            FileSystem::Type fsType = FileSystem::Type::Unknown;
+            const QString fsRealName = PartUtils::canonicalFilesystemName( fsName, &fsType );
+            if ( fsType == FileSystem::Type::Unknown )
+            {
+                cWarning() << "Partition-module *deviceClassProfiles* for" << it.key() << "has bad *fileSystemType*"
+                           << fsName;
+            }
+            else
+            {
+                profile.fileSystemType = fsRealName;
+            }
+        }
+        profile.features = m.value( "features" ).toMap();
+        profile.mountOptions = m.value( "mountOptions" ).toMap();
+        profiles.insert( it.key(), profile );
+    }
+    return profiles;
+}
+
 
 void
 Config::setConfigurationMap( const QVariantMap& configurationMap )
@@ -323,6 +380,13 @@ Config::setConfigurationMap( const QVariantMap& configurationMap )
     setSwapChoice( m_initialSwapChoice );
 
     m_allowManualPartitioning = CalamaresUtils::getBool( configurationMap, "allowManualPartitioning", true );
+    m_liveZRam = CalamaresUtils::getBool( configurationMap, "liveZRam", false );
+    const QString eraseDiscard = CalamaresUtils::getString( configurationMap, "eraseDiscard" );
+    m_eraseDiscard = eraseDiscardNames().find( eraseDiscard, nameFound );
+    if ( !eraseDiscard.isEmpty() && !nameFound )
+    {
+        cWarning() << "Configuration for *eraseDiscard* is not a known setting:" << eraseDiscard;
+    }
 
     Calamares::GlobalStorage* gs = Calamares::JobQueue::instance()->globalStorage();
     m_requiredPartitionTableType = CalamaresUtils::getStringList( configurationMap, "requiredPartitionTableType" );
@@ -330,6 +394,18 @@ Config::setConfigurationMap( const QVariantMap& configurationMap )
 
     fillGSConfigurationEFI( gs, configurationMap );
     fillConfigurationFSTypes( configurationMap );
+    m_deviceClassProfiles = getDeviceClassProfiles( configurationMap );
+}
+
+QString
+Config::eraseFsType( const QString& deviceClass ) const
+{
+    const QString profileType = m_deviceClassProfiles.value( deviceClass ).fileSystemType;
+    if ( !m_eraseFsTypeChosen && !profileType.isEmpty() )
+    {
+        return profileType;
+    }
+    return m_eraseFsTypeChoice;
 }
 
 void
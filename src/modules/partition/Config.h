@@ -14,8 +14,10 @@
 
 #include <kpmcore/fs/filesystem.h>
 
+#include <QHash>
 #include <QObject>
 #include <QSet>
+#include <QVariantMap>
 
 class Config : public QObject
 {
@@ -54,7 +56,8 @@ public:
         ReuseSwap,  // don't create, but do use existing
         SmallSwap,  // up to 8GiB of swap
         FullSwap,  // ensureSuspendToDisk -- at least RAM size
-        SwapFile  // use a file (if supported)
+        SwapFile,  // use a file (if supported)
+        ZRamSwap  // compressed swap in RAM (zram), none on disk
     };
     Q_ENUM( SwapChoice )
     static const NamedEnumTable< SwapChoice >& swapChoiceNames();
@@ -62,6 +65,28 @@ public:
 
     using EraseFsTypesSet = QStringList;
 
+    /** @brief Discard the whole disk before *erase* mode partitions it */
+    enum EraseDiscard
+    {
+        NoDiscard,
+        PlainDiscard,  // BLKDISCARD, for solid-state disks that support it
+        SecureDiscard  // BLKSECDISCARD where supported, plain discard otherwise
+    };
+    Q_ENUM( EraseDiscard )
+    static const NamedEnumTable< EraseDiscard >& eraseDiscardNames();
+
+    /** @brief Settings for new filesystems on one class of disk
+     *
+     * The classes are those of PartUtils::deviceClass(). The maps
+     * are keyed by filesystem name (e.g. "ext4").
+     */
+    struct DeviceClassProfile
+    {
+        QString fileSystemType;  ///< For *erase* mode, unless the user picks another; empty for the default
+        QVariantMap features;  ///< Features of new filesystems, as in *partitionLayout*
+        QVariantMap mountOptions;  ///< Extra mount options, for fstab
+    };
+
     void setConfigurationMap( const QVariantMap& );
     /** @brief Set GS values where other modules configuration has priority
      *
@@ -121,6 +146,19 @@ public:
      */
     QString eraseFsType() const { return m_eraseFsTypeChoice; }
 
+    /** @brief The FS type for *erase* mode on a disk of class @p deviceClass
+     *
+     * This is the eraseFsType(), unless the user has not picked one (not
+     * even the default) and the profile for @p deviceClass names another.
+     */
+    QString eraseFsType( const QString& deviceClass ) const;
+
+    /// @brief The profile for @p deviceClass; empty if there is none
+    DeviceClassProfile deviceClassProfile( const QString& deviceClass ) const
+    {
+        return m_deviceClassProfiles.value( deviceClass );
+    }
+
     /** @brief Configured default FS type (for other modes than erase)
      *
      * This is not "Unknown" or "Unformatted"
@@ -130,6 +168,12 @@ public:
     ///@brief Is manual partitioning allowed (not explicitly disabled in the config file)?
     bool allowManualPartitioning() const { return m_allowManualPartitioning; }
 
+    ///@brief Should the live system swap to compressed RAM while installing (explicitly enabled)?
+    bool liveZRam() const { return m_liveZRam; }
+
+    ///@brief Should *erase* mode discard the whole disk first (NoDiscard unless configured)?
+    EraseDiscard eraseDiscard() const { return m_eraseDiscard; }
+
 public Q_SLOTS:
     void setInstallChoice( int );  ///< Translates a button ID or so to InstallChoice
     void setInstallChoice( InstallChoice );
@@ -147,7 +191,9 @@ private:
     void fillConfigurationFSTypes( const QVariantMap& configurationMap );
     EraseFsTypesSet m_eraseFsTypes;
     QString m_eraseFsTypeChoice;
+    bool m_eraseFsTypeChosen = false;  ///< Has the user picked a FS type (with setEraseFsTypeChoice())?
     FileSystem::Type m_defaultFsType;
+    QHash< QString, DeviceClassProfile > m_deviceClassProfiles;
 
     SwapChoiceSet m_swapChoices;
     SwapChoice m_initialSwapChoice = NoSwap;
@@ -158,6 +204,8 @@ private:
     QStringList m_requiredPartitionTableType;
 
     bool m_allowManualPartitioning = true;
+    EraseDiscard m_eraseDiscard = NoDiscard;
+    bool m_liveZRam = false;
 };
 
 /** @brief Given a set of swap choices, return a sensible value from it.
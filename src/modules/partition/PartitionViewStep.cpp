@@ -26,6 +26,7 @@
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 #include "utils/CalamaresUtilsGui.h"
+#include "utils/Executor.h"
 #include "utils/Logger.h"
 #include "utils/QtCompat.h"
 #include "utils/Retranslator.h"
@@ -38,7 +39,6 @@
 #include <QFormLayout>
 #include <QMessageBox>
 #include <QStackedWidget>
-#include <QtConcurrent/QtConcurrent>
 
 PartitionViewStep::PartitionViewStep( QObject* parent )
     : Calamares::ViewStep( parent )
@@ -111,26 +111,6 @@ PartitionViewStep::prettyName() const
     return tr( "Partitions" );
 }
 
-/** @brief Gather the pretty descriptions of all the partitioning jobs
- *
- * Returns a QStringList of each job's pretty description, including
- * empty strings and duplicates. The list is in-order of how the
- * jobs will be run.
- */
-static QStringList
-jobDescriptions( const Calamares::JobList& jobs )
-{
-    QStringList jobsLines;
-    for ( const Calamares::job_ptr& job : qAsConst( jobs ) )
-    {
-        if ( !job->prettyDescription().isEmpty() )
-        {
-            jobsLines.append( job->prettyDescription() );
-        }
-    }
-    return jobsLines;
-}
-
 /** @brief A top-level description of what @p choice does
  *
  * Returns a (branded) string describing what @p choice will do.
@@ -219,6 +199,27 @@ diskDescription( int listLength, const PartitionCoreModule::SummaryInfo& info, C
     }
 }
 
+/** @brief A line about the alignment of the new partitions in @p info
+ *
+ * Empty when no partitions were created from the layout (e.g. when
+ * partitioning manually), otherwise starts with a line break.
+ */
+static QString
+alignmentDescription( const PartitionCoreModule::SummaryInfo& info )
+{
+    using CalamaresUtils::Units::operator""_MiB;
+    static const char context[] = "PartitionViewStep";
+
+    if ( info.alignment <= 0 )
+    {
+        return QString();
+    }
+    const QString text = info.alignment % 1_MiB
+        ? QCoreApplication::translate( context, "New partitions are aligned to %1 KiB." ).arg( info.alignment / 1024 )
+        : QCoreApplication::translate( context, "New partitions are aligned to %1 MiB." ).arg( info.alignment / 1_MiB );
+    return QStringLiteral( "<br/>" ) + text;
+}
+
 QString
 PartitionViewStep::prettyStatus() const
 {
@@ -236,10 +237,10 @@ PartitionViewStep::prettyStatus() const
     for ( const auto& info : list )
     {
         // TODO: this overwrites each iteration
-        diskInfoLabel = diskDescription( list.length(), info, choice );
+        diskInfoLabel = diskDescription( list.length(), info, choice ) + alignmentDescription( info );
     }
 
-    const QStringList jobsLines = jobDescriptions( jobs() );
+    const QStringList jobsLines = m_core->jobDescriptions( m_config );
     if ( !jobsLines.isEmpty() )
     {
         jobsLabel = jobsLines.join( "<br/>" );
@@ -275,7 +276,7 @@ PartitionViewStep::createSummaryWidget() const
     for ( const auto& info : list )
     {
         QLabel* diskInfoLabel = new QLabel;
-        diskInfoLabel->setText( diskDescription( list.length(), info, choice ) );
+        diskInfoLabel->setText( diskDescription( list.length(), info, choice ) + alignmentDescription( info ) );
         formLayout->addRow( diskInfoLabel );
 
         PartitionBarsView* preview;
@@ -320,7 +321,7 @@ PartitionViewStep::createSummaryWidget() const
         field->addWidget( previewLabels );
         formLayout->addRow( tr( "After:" ), field );
     }
-    const QStringList jobsLines = jobDescriptions( jobs() );
+    const QStringList jobsLines = m_core->jobDescriptions( m_config );
     if ( !jobsLines.isEmpty() )
     {
         QLabel* jobsLabel = new QLabel( widget );
@@ -344,7 +345,8 @@ PartitionViewStep::widget()
 void
 PartitionViewStep::next()
 {
-    if ( m_choicePage == m_widget->currentWidget() )
+    // After releaseWidget(), there are no pages; the stack is empty
+    if ( m_choicePage && m_choicePage == m_widget->currentWidget() )
     {
         if ( m_config->installChoice() == Config::InstallChoice::Manual )
         {
@@ -369,13 +371,13 @@ PartitionViewStep::next()
 void
 PartitionViewStep::back()
 {
-    if ( m_widget->currentWidget() != m_choicePage )
+    if ( m_choicePage && m_widget->currentWidget() != m_choicePage )
     {
         m_widget->setCurrentWidget( m_choicePage );
-        m_choicePage->setLastSelectedDeviceIndex( m_manualPartitionPage->selectedDeviceIndex() );
 
         if ( m_manualPartitionPage )
         {
+            m_choicePage->setLastSelectedDeviceIndex( m_manualPartitionPage->selectedDeviceIndex() );
             m_manualPartitionPage->deleteLater();
             m_manualPartitionPage = nullptr;
         }
@@ -444,9 +446,11 @@ void
 PartitionViewStep::onActivate()
 {
     m_config->fillGSSecondaryConfiguration();
+    m_core->setWatchDevices( true );
 
     // if we're coming back to PVS from the next VS
-    if ( m_widget->currentWidget() == m_choicePage && m_config->installChoice() == Config::InstallChoice::Alongside )
+    if ( m_choicePage && m_widget->currentWidget() == m_choicePage
+         && m_config->installChoice() == Config::InstallChoice::Alongside )
     {
         m_choicePage->applyActionChoice( Config::InstallChoice::Alongside );
         //        m_choicePage->reset();
@@ -496,14 +500,19 @@ shouldWarnForGPTOnBIOS( const PartitionCoreModule* core )
 void
 PartitionViewStep::onLeave()
 {
-    if ( m_widget->currentWidget() == m_choicePage )
+    // The jobs refer to the devices as they are now; stop updating them.
+    m_core->setWatchDevices( false );
+
+    if ( m_choicePage && m_widget->currentWidget() == m_choicePage )
     {
         m_choicePage->onLeave();
+        // That sets mount points (e.g. of the EFI system partition) directly
+        m_core->invalidateJobs();
         return;
     }
 
     const auto* branding = Calamares::Branding::instance();
-    if ( m_widget->currentWidget() == m_manualPartitionPage )
+    if ( m_manualPartitionPage && m_widget->currentWidget() == m_manualPartitionPage )
     {
         if ( PartUtils::isEfiSystem() )
         {
@@ -686,10 +695,14 @@ PartitionViewStep::setConfigurationMap( const QVariantMap& configurationMap )
         this->m_future = nullptr;
     } );
 
-    QFuture< void > future = QtConcurrent::run( this, &PartitionViewStep::initPartitionCoreModule );
+    // Not an interactive task: the user is still on an earlier page,
+    // and the scan waits for the bulk I/O lane (e.g. os-prober) anyway.
+    QFuture< void > future = CalamaresUtils::Executor::run(
+        CalamaresUtils::Executor::Lane::Background, "partition-load", [ this ]() { initPartitionCoreModule(); } );
     m_future->setFuture( future );
 
     m_core->initLayout( m_config->defaultFsType(), configurationMap.value( "partitionLayout" ).toList() );
+    m_core->setProfileConfig( m_config );
 }
 
 
@@ -699,6 +712,18 @@ PartitionViewStep::jobs() const
     return m_core->jobs( m_config );
 }
 
+bool
+PartitionViewStep::releaseWidget()
+{
+    // The jobs only need the core (and its devices), not the pages with
+    // their device previews. The stack stays, since the other methods use it.
+    delete m_choicePage;
+    m_choicePage = nullptr;
+    delete m_manualPartitionPage;
+    m_manualPartitionPage = nullptr;
+    return false;
+}
+
 Calamares::RequirementsList
 PartitionViewStep::checkRequirements()
 {
@@ -63,6 +63,7 @@ public:
     void setConfigurationMap( const QVariantMap& configurationMap ) override;
 
     Calamares::JobList jobs() const override;
+    bool releaseWidget() override;
 
     Calamares::RequirementsList checkRequirements() override;
 
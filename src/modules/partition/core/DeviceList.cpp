@@ -10,6 +10,8 @@
 
 #include "DeviceList.h"
 
+#include "core/FilesystemProbe.h"
+
 #include "partition/PartitionIterator.h"
 #include "utils/Logger.h"
 
@@ -18,7 +20,6 @@
 #include <kpmcore/core/device.h>
 #include <kpmcore/core/partition.h>
 
-#include <QProcess>
 
 using CalamaresUtils::Partition::PartitionIterator;
 
@@ -43,11 +44,7 @@ hasRootPartition( Device* device )
 static bool
 blkIdCheckIso9660( const QString& path )
 {
-    QProcess blkid;
-    blkid.start( "blkid", { path } );
-    blkid.waitForFinished();
-    QString output = QString::fromLocal8Bit( blkid.readAllStandardOutput() );
-    return output.contains( "iso9660" );
+    return probeFilesystem( path ).type == QStringLiteral( "iso9660" );
 }
 
 static bool
@@ -108,21 +105,13 @@ erase( DeviceList& l, DeviceList::iterator& it )
     return r;
 }
 
-QList< Device* >
-getDevices( DeviceType which )
+/** @brief Removes (and deletes) the devices that can not be used from @p devices
+ *
+ * See getDevices() for what is removed, depending on @p which.
+ */
+static void
+removeUnsuitableDevices( DeviceList& devices, DeviceType which )
 {
-    CoreBackend* backend = CoreBackendManager::self()->backend();
-    if ( !backend )
-    {
-        cWarning() << "No KPM backend found.";
-        return {};
-    }
-#if defined( WITH_KPMCORE4API )
-    DeviceList devices = backend->scanDevices( /* not includeReadOnly, not includeLoopback */ ScanFlag( 0 ) );
-#else
-    DeviceList devices = backend->scanDevices( /* excludeReadOnly */ true );
-#endif
-
     /* The list of devices is cleaned up for use:
      *  - some devices can **never** be used (e.g. floppies, nullptr)
      *  - some devices can be used if unsafe mode is on, but not in normal operation
@@ -183,7 +172,40 @@ getDevices( DeviceType which )
         }
     }
     cDebug() << Logger::SubEntry << "there are" << devices.count() << "devices left.";
+}
+
+QList< Device* >
+getDevices( DeviceType which )
+{
+    CoreBackend* backend = CoreBackendManager::self()->backend();
+    if ( !backend )
+    {
+        cWarning() << "No KPM backend found.";
+        return {};
+    }
+#if defined( WITH_KPMCORE4API )
+    DeviceList devices = backend->scanDevices( /* not includeReadOnly, not includeLoopback */ ScanFlag( 0 ) );
+#else
+    DeviceList devices = backend->scanDevices( /* excludeReadOnly */ true );
+#endif
+
+    removeUnsuitableDevices( devices, which );
     return devices;
 }
 
+Device*
+scanDevice( const QString& deviceNode, DeviceType which )
+{
+    CoreBackend* backend = CoreBackendManager::self()->backend();
+    if ( !backend )
+    {
+        cWarning() << "No KPM backend found.";
+        return nullptr;
+    }
+
+    DeviceList devices { backend->scanDevice( deviceNode ) };
+    removeUnsuitableDevices( devices, which );
+    return devices.isEmpty() ? nullptr : devices.first();
+}
+
 }  // namespace PartUtils
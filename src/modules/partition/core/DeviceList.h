@@ -35,6 +35,15 @@ enum class DeviceType
  */
 QList< Device* > getDevices( DeviceType which = DeviceType::All );
 
+/**
+ * @brief Scans a single storage device.
+ * @param deviceNode The device to scan (e.g. "/dev/sdb").
+ * @param which As for getDevices(), selects whether the device is returned.
+ * @return the device, or nullptr if it can not be scanned or does
+ *      not meet the criterium.
+ */
+Device* scanDevice( const QString& deviceNode, DeviceType which = DeviceType::All );
+
 }  // namespace PartUtils
 
 #endif  // DEVICELIST_H
@@ -0,0 +1,240 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "DeviceWatcher.h"
+
+#include "utils/Logger.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QSocketNotifier>
+
+#if defined( Q_OS_LINUX )
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+/// @brief How long to wait after the last event before reporting (milliseconds)
+static constexpr int settleTime = 1500;
+/// @brief How long the changes of a disk are ignored after Calamares scanned it
+static constexpr std::chrono::seconds ignoreTime { 5 };
+
+DeviceWatcher::DeviceWatcher( QObject* parent )
+    : QObject( parent )
+{
+    m_settleTimer.setSingleShot( true );
+    m_settleTimer.setInterval( settleTime );
+    connect( &m_settleTimer, &QTimer::timeout, this, &DeviceWatcher::settled );
+}
+
+DeviceWatcher::~DeviceWatcher()
+{
+    setActive( false );
+}
+
+bool
+DeviceWatcher::setActive( bool active )
+{
+    if ( active == isActive() )
+    {
+        return active;
+    }
+
+    if ( !active )
+    {
+        delete m_notifier;
+        m_notifier = nullptr;
+#if defined( Q_OS_LINUX )
+        ::close( m_socket );
+#endif
+        m_socket = -1;
+        m_settleTimer.stop();
+        m_added.clear();
+        m_removed.clear();
+        m_changed.clear();
+        return false;
+    }
+
+#if defined( Q_OS_LINUX )
+    m_socket = ::socket( AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT );
+    if ( m_socket < 0 )
+    {
+        cWarning() << "Can not watch for device changes (no uevent socket).";
+        return false;
+    }
+
+    struct sockaddr_nl address = {};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = 1;  // The kernel's own events
+    if ( ::bind( m_socket, reinterpret_cast< struct sockaddr* >( &address ), sizeof( address ) ) < 0 )
+    {
+        cWarning() << "Can not watch for device changes (uevent socket does not bind).";
+        ::close( m_socket );
+        m_socket = -1;
+        return false;
+    }
+
+    m_notifier = new QSocketNotifier( m_socket, QSocketNotifier::Read, this );
+    connect( m_notifier, &QSocketNotifier::activated, this, &DeviceWatcher::readEvents );
+    cDebug() << "Watching for device changes.";
+    return true;
+#else
+    cWarning() << "Can not watch for device changes on this platform.";
+    return false;
+#endif
+}
+
+void
+DeviceWatcher::ignoreScanned( const QString& disk )
+{
+    const QString name = disk.startsWith( QStringLiteral( "/dev/" ) ) ? disk.mid( 5 ) : disk;
+    QMutexLocker lock( &m_ignoredMutex );
+    m_ignoredUntil.insert( name, std::chrono::steady_clock::now() + ignoreTime );
+}
+
+bool
+DeviceWatcher::isIgnored( const QString& name )
+{
+    QMutexLocker lock( &m_ignoredMutex );
+    const auto it = m_ignoredUntil.find( name );
+    if ( it == m_ignoredUntil.end() )
+    {
+        return false;
+    }
+    if ( std::chrono::steady_clock::now() < it.value() )
+    {
+        return true;
+    }
+    m_ignoredUntil.erase( it );
+    return false;
+}
+
+/** @brief Splits a kernel uevent into its properties
+ *
+ * The event is a header "action@devpath" followed by KEY=value
+ * strings, each zero-terminated.
+ */
+static QHash< QByteArray, QByteArray >
+parseEvent( const QByteArray& event )
+{
+    QHash< QByteArray, QByteArray > properties;
+    const auto parts = event.split( '\0' );
+    for ( const QByteArray& part : parts )
+    {
+        const int equals = part.indexOf( '=' );
+        if ( equals > 0 )
+        {
+            properties.insert( part.left( equals ), part.mid( equals + 1 ) );
+        }
+    }
+    return properties;
+}
+
+void
+DeviceWatcher::readEvents()
+{
+#if defined( Q_OS_LINUX )
+    char buffer[ 8192 ];
+    bool interesting = false;
+
+    ssize_t length;
+    while ( ( length = ::recv( m_socket, buffer, sizeof( buffer ), 0 ) ) > 0 )
+    {
+        const auto properties = parseEvent( QByteArray( buffer, int( length ) ) );
+        const QByteArray devicePath = properties.value( "DEVPATH" );
+        if ( properties.value( "SUBSYSTEM" ) != "block" || devicePath.startsWith( "/devices/virtual/" ) )
+        {
+            continue;
+        }
+
+        const QByteArray action = properties.value( "ACTION" );
+        const QByteArray type = properties.value( "DEVTYPE" );
+        if ( type == "partition" )
+        {
+            // The disk is the parent in sysfs, e.g. .../block/sdb/sdb1
+            const QByteArray parentPath = devicePath.left( devicePath.lastIndexOf( '/' ) );
+            const QString disk = QString::fromLatin1( parentPath.mid( parentPath.lastIndexOf( '/' ) + 1 ) );
+            if ( ( action == "add" || action == "remove" ) && !m_added.contains( disk ) && !isIgnored( disk ) )
+            {
+                m_changed.insert( disk );
+                interesting = true;
+            }
+        }
+        else if ( type == "disk" )
+        {
+            const QString disk = QString::fromLatin1( properties.value( "DEVNAME" ) );
+            if ( action == "add" )
+            {
+                if ( m_removed.remove( disk ) )
+                {
+                    m_changed.insert( disk );
+                }
+                else
+                {
+                    m_added.insert( disk );
+                }
+                interesting = true;
+            }
+            else if ( action == "remove" )
+            {
+                m_changed.remove( disk );
+                if ( !m_added.remove( disk ) )
+                {
+                    m_removed.insert( disk );
+                }
+                interesting = true;
+            }
+            else if ( action == "change" && properties.value( "DISK_MEDIA_CHANGE" ) == "1" )
+            {
+                // Other change events on a disk are caused (by udev) when
+                // a writable file descriptor on the disk is closed.
+                if ( !m_added.contains( disk ) && !isIgnored( disk ) )
+                {
+                    m_changed.insert( disk );
+                    interesting = true;
+                }
+            }
+        }
+    }
+
+    if ( interesting )
+    {
+        m_settleTimer.start();
+    }
+#endif
+}
+
+void
+DeviceWatcher::settled()
+{
+    auto toNodes = []( const QSet< QString >& names ) {
+        QStringList nodes;
+        for ( const QString& name : names )
+        {
+            nodes.append( QStringLiteral( "/dev/" ) + name );
+        }
+        nodes.sort();
+        return nodes;
+    };
+
+    const QStringList added = toNodes( m_added );
+    const QStringList removed = toNodes( m_removed );
+    const QStringList changed = toNodes( m_changed - m_added - m_removed );
+    m_added.clear();
+    m_removed.clear();
+    m_changed.clear();
+
+    if ( added.isEmpty() && removed.isEmpty() && changed.isEmpty() )
+    {
+        return;
+    }
+    cDebug() << "Devices changed, added" << added << "removed" << removed << "changed" << changed;
+    emit devicesChanged( added, removed, changed );
+}
@@ -0,0 +1,96 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef PARTITION_DEVICEWATCHER_H
+#define PARTITION_DEVICEWATCHER_H
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include <chrono>
+
+class QSocketNotifier;
+
+/** @brief Watches the kernel for disks coming and going
+ *
+ * Listens to the kernel's block-device uevents (the same events
+ * udev gets) and reports, in bunches, which disks were added,
+ * which were removed and which changed (partitions added or removed,
+ * or new media inserted). Only whole disks that have a device behind
+ * them are reported: loop, dm, md, zram and similar virtual devices
+ * are ignored, as are the "change" events that udev itself causes
+ * when a disk is closed after being opened for writing (which
+ * scanning a disk with KPMcore does). Changes to the partitions of a
+ * disk that Calamares scanned itself just before are ignored too (see
+ * ignoreScanned()).
+ *
+ * Events are collected until udev has had some time to settle
+ * (the device nodes need to exist before the disk can be scanned)
+ * and then devicesChanged() is emitted once.
+ */
+class DeviceWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DeviceWatcher( QObject* parent = nullptr );
+    ~DeviceWatcher() override;
+
+    /** @brief Start or stop listening
+     *
+     * Events that come in while the watcher is not active are lost.
+     * Returns @c false if the kernel events cannot be had (e.g.
+     * not on Linux, or in a container); the watcher is not active then.
+     */
+    bool setActive( bool active );
+    bool isActive() const { return m_notifier != nullptr; }
+
+    /** @brief Ignores the changes of @p disk for a little while
+     *
+     * Call this after scanning @p disk (a device node, e.g. "/dev/sdb"):
+     * closing it after the scan makes udev re-read the partition table,
+     * and the events for that would otherwise lead to another scan, and
+     * so on. Partitions that really change in that time are missed, as
+     * are media changes; the disk being added or removed is not. This
+     * may be called from any thread.
+     */
+    void ignoreScanned( const QString& disk );
+
+signals:
+    /** @brief Disks have changed
+     *
+     * Each list holds device nodes (e.g. "/dev/sdb") of whole disks,
+     * and a disk appears in at most one of the lists. A disk that
+     * was removed and added again in between is reported as changed.
+     */
+    void devicesChanged( const QStringList& added, const QStringList& removed, const QStringList& changed );
+
+private:
+    void readEvents();
+    void settled();
+    /// @brief Is @p name (e.g. "sdb") still ignored after a scan?
+    bool isIgnored( const QString& name );
+
+    int m_socket = -1;
+    QSocketNotifier* m_notifier = nullptr;
+    QTimer m_settleTimer;
+
+    QSet< QString > m_added;
+    QSet< QString > m_removed;
+    QSet< QString > m_changed;
+
+    QMutex m_ignoredMutex;  ///< Guards m_ignoredUntil
+    QHash< QString, std::chrono::steady_clock::time_point > m_ignoredUntil;
+};
+
+#endif
@@ -0,0 +1,127 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "FilesystemProbe.h"
+
+#include "utils/CalamaresUtilsSystem.h"
+#include "utils/Logger.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#ifdef HAVE_LIBBLKID
+#include <blkid/blkid.h>
+#endif
+
+namespace PartUtils
+{
+
+static QMutex s_probesMutex;
+static QHash< QString, FilesystemProbe > s_probes;
+
+#ifdef HAVE_LIBBLKID
+static QString
+lookupValue( blkid_probe probe, const char* name )
+{
+    const char* value = nullptr;
+    if ( blkid_probe_lookup_value( probe, name, &value, nullptr ) == 0 && value )
+    {
+        return QString::fromLocal8Bit( value );
+    }
+    return QString();
+}
+
+static FilesystemProbe
+runProbe( const QString& devicePath )
+{
+    FilesystemProbe result;
+    blkid_probe probe = blkid_new_probe_from_filename( devicePath.toLocal8Bit().constData() );
+    if ( !probe )
+    {
+        return result;
+    }
+
+    blkid_probe_enable_superblocks( probe, 1 );
+    blkid_probe_set_superblocks_flags( probe, BLKID_SUBLKS_TYPE | BLKID_SUBLKS_UUID );
+    // 0 is "found something", 1 is "found nothing", negative is an error
+    const int r = blkid_do_safeprobe( probe );
+    if ( r >= 0 )
+    {
+        result.ok = true;
+        if ( r == 0 )
+        {
+            result.type = lookupValue( probe, "TYPE" );
+            result.uuid = lookupValue( probe, "UUID" );
+        }
+    }
+    blkid_free_probe( probe );
+    return result;
+}
+#else
+static FilesystemProbe
+runProbe( const QString& devicePath )
+{
+    FilesystemProbe result;
+    auto r = CalamaresUtils::System::runCommand( CalamaresUtils::System::RunLocation::RunInHost,
+                                                 { "blkid", "-s", "TYPE", "-s", "UUID", "-o", "export", devicePath } );
+    // blkid exits with 2 when there is nothing to report
+    if ( r.getExitCode() == 0 || r.getExitCode() == 2 )
+    {
+        result.ok = true;
+        const auto lines = r.getOutput().split( '\n' );
+        for ( const QString& line : lines )
+        {
+            if ( line.startsWith( "TYPE=" ) )
+            {
+                result.type = line.mid( 5 ).trimmed();
+            }
+            else if ( line.startsWith( "UUID=" ) )
+            {
+                result.uuid = line.mid( 5 ).trimmed();
+            }
+        }
+    }
+    return result;
+}
+#endif
+
+FilesystemProbe
+probeFilesystem( const QString& devicePath )
+{
+    {
+        QMutexLocker lock( &s_probesMutex );
+        auto it = s_probes.constFind( devicePath );
+        if ( it != s_probes.constEnd() )
+        {
+            return it.value();
+        }
+    }
+
+    // Probe without holding the lock, so that different devices
+    // can be probed at the same time.
+    const FilesystemProbe result = runProbe( devicePath );
+    if ( !result.isValid() )
+    {
+        cWarning() << "Could not probe" << devicePath << "for a filesystem.";
+    }
+
+    QMutexLocker lock( &s_probesMutex );
+    s_probes.insert( devicePath, result );
+    return result;
+}
+
+void
+clearFilesystemProbes()
+{
+    QMutexLocker lock( &s_probesMutex );
+    s_probes.clear();
+}
+
+}  // namespace PartUtils
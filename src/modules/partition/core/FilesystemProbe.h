@@ -0,0 +1,50 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef PARTITION_FILESYSTEMPROBE_H
+#define PARTITION_FILESYSTEMPROBE_H
+
+#include <QString>
+
+namespace PartUtils
+{
+
+/** @brief What blkid has to say about a block device
+ *
+ * If the device could not be probed at all, isValid() is false.
+ * A device that has no (recognized) filesystem on it is valid,
+ * with an empty type.
+ */
+struct FilesystemProbe
+{
+    bool ok = false;
+    QString type;  ///< e.g. "ext4" or "iso9660"
+    QString uuid;  ///< UUID of the filesystem, if it has one
+
+    bool isValid() const { return ok; }
+};
+
+/** @brief Probes the block device @p devicePath for a filesystem
+ *
+ * With libblkid available, this probes in-process; otherwise the
+ * `blkid` command is run. Results are cached per device path: the
+ * device scan, the fstab probes of os-prober results and the
+ * ClearMounts job all look at the same partitions. Use
+ * clearFilesystemProbes() when the disks may have changed.
+ *
+ * This can be called from any thread.
+ */
+FilesystemProbe probeFilesystem( const QString& devicePath );
+
+/// @brief Forgets all the cached results of probeFilesystem()
+void clearFilesystemProbes();
+
+}  // namespace PartUtils
+
+#endif
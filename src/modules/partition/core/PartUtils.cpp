@@ -12,6 +12,7 @@
 #include "PartUtils.h"
 
 #include "core/DeviceModel.h"
+#include "core/FilesystemProbe.h"
 #include "core/KPMHelpers.h"
 #include "core/PartitionInfo.h"
 
@@ -20,7 +21,9 @@
 #include "partition/Mount.h"
 #include "partition/PartitionIterator.h"
 #include "partition/PartitionQuery.h"
+#include "partition/PartitionSnapshot.h"
 #include "utils/CalamaresUtilsSystem.h"
+#include "utils/HardwareInfo.h"
 #include "utils/Logger.h"
 #include "utils/RAII.h"
 
@@ -29,10 +32,26 @@
 #include <kpmcore/core/device.h>
 #include <kpmcore/core/partition.h>
 
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
 #include <QProcess>
 #include <QTemporaryDir>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+#include <numeric>
 
 using CalamaresUtils::Partition::isPartitionFreeSpace;
+using CalamaresUtils::Partition::PartitionIterator;
 using CalamaresUtils::Partition::isPartitionNew;
 
 namespace PartUtils
@@ -69,7 +88,13 @@ convenienceName( const Partition* const candidate )
 static double
 getRequiredStorageGiB( bool& ok )
 {
-    return Calamares::JobQueue::instance()->globalStorage()->value( "requiredStorageGiB" ).toDouble( &ok );
+    auto* jobQueue = Calamares::JobQueue::instance();
+    if ( !jobQueue || !jobQueue->globalStorage() )
+    {
+        ok = false;
+        return 0.0;
+    }
+    return jobQueue->globalStorage()->value( "requiredStorageGiB" ).toDouble( &ok );
 }
 
 bool
@@ -117,6 +142,26 @@ canBeReplaced( Partition* candidate, const Logger::Once& o )
 }
 
 
+/** @brief Remembered results of canBeResized()
+ *
+ * The key is the partition path and filesystem UUID, so that the same
+ * partition in the immutable copy of a device and in the device itself
+ * (or in a re-scan of an unchanged disk) shares the result. Partitions
+ * without a path (e.g. free space) are not remembered.
+ */
+struct ResizeCheck
+{
+    bool resizable = false;
+    double requiredStorageGiB = -1.0;
+};
+using ResizeCheckKey = QPair< QString, QString >;
+
+static QMutex s_resizeChecksMutex;
+static QHash< ResizeCheckKey, ResizeCheck > s_resizeChecks;
+static int s_resizeChecksGeneration = 0;
+
+static bool checkResizable( Partition* candidate, const Logger::Once& o );
+
 bool
 canBeResized( Partition* candidate, const Logger::Once& o )
 {
@@ -125,7 +170,50 @@ canBeResized( Partition* candidate, const Logger::Once& o )
         cDebug() << o << "Partition* is NULL";
         return false;
     }
+    if ( candidate->partitionPath().isEmpty() )
+    {
+        return checkResizable( candidate, o );
+    }
+
+    bool ok = false;
+    const double requiredStorageGiB = getRequiredStorageGiB( ok );
+    const ResizeCheckKey key( candidate->partitionPath(), candidate->fileSystem().uuid() );
+    int generation = 0;
+    {
+        QMutexLocker lock( &s_resizeChecksMutex );
+        const auto it = s_resizeChecks.constFind( key );
+        if ( ok && it != s_resizeChecks.constEnd()
+             && qFuzzyCompare( 1.0 + it->requiredStorageGiB, 1.0 + requiredStorageGiB ) )
+        {
+            return it->resizable;
+        }
+        generation = s_resizeChecksGeneration;
+    }
+
+    const bool resizable = checkResizable( candidate, o );
+    if ( ok )
+    {
+        QMutexLocker lock( &s_resizeChecksMutex );
+        // If the checks were cleared in the meantime, the disk may have changed
+        if ( generation == s_resizeChecksGeneration )
+        {
+            s_resizeChecks.insert( key, { resizable, requiredStorageGiB } );
+        }
+    }
+    return resizable;
+}
+
+void
+clearResizeChecks()
+{
+    QMutexLocker lock( &s_resizeChecksMutex );
+    s_resizeChecks.clear();
+    ++s_resizeChecksGeneration;
+}
 
+static bool
+checkResizable( Partition* candidate, const Logger::Once& o )
+{
     cDebug() << o << "Checking if" << convenienceName( candidate ) << "can be resized.";
     if ( !candidate->fileSystem().supportGrow() || !candidate->fileSystem().supportShrink() )
     {
@@ -197,55 +285,113 @@ canBeResized( Partition* candidate, const Logger::Once& o )
 }
 
 
+static double
+currentRequiredStorageGiB()
+{
+    bool ok = false;
+    const double requiredStorageGiB = getRequiredStorageGiB( ok );
+    return ok ? requiredStorageGiB : -1.0;
+}
+
 bool
-canBeResized( DeviceModel* dm, const QString& partitionPath, const Logger::Once& o )
+DeviceAnalysis::isCurrent() const
+{
+    return qFuzzyCompare( 1.0 + requiredStorageGiB, 1.0 + currentRequiredStorageGiB() );
+}
+
+DeviceAnalysis
+analyzeDevice( Device* device )
+{
+    Logger::Once o;
+    DeviceAnalysis analysis;
+    analysis.requiredStorageGiB = currentRequiredStorageGiB();
+    if ( !device )
+    {
+        return analysis;
+    }
+
+    for ( auto it = PartitionIterator::begin( device ); it != PartitionIterator::end( device ); ++it )
+    {
+        if ( canBeResized( *it, o ) )
+        {
+            analysis.resizable.insert( *it );
+        }
+        if ( canBeReplaced( *it, o ) )
+        {
+            analysis.replaceable.insert( *it );
+        }
+        if ( ( *it )->isMounted() )
+        {
+            analysis.anyMounted = true;
+        }
+    }
+    cDebug() << o << "Device" << device->deviceNode() << "has" << analysis.resizable.count() << "resizable and"
+             << analysis.replaceable.count() << "replaceable partitions.";
+    return analysis;
+}
+
+
+/// @brief All the devices in @p dm, in model order
+static QList< Device* >
+modelDevices( DeviceModel* dm )
+{
+    QList< Device* > devices;
+    for ( int i = 0; i < dm->rowCount(); ++i )
+    {
+        devices.append( dm->deviceForIndex( dm->index( i ) ) );
+    }
+    return devices;
+}
+
+static bool
+canBeResized( const CalamaresUtils::Partition::PartitionSnapshot& partitions,
+              const QString& partitionPath,
+              const Logger::Once& o )
 {
     cDebug() << o << "Checking if" << partitionPath << "can be resized.";
-    QString partitionWithOs = partitionPath;
-    if ( partitionWithOs.startsWith( "/dev/" ) )
+    if ( partitionPath.startsWith( "/dev/" ) )
     {
-        for ( int i = 0; i < dm->rowCount(); ++i )
+        const auto* entry = partitions.findByPath( partitionPath );
+        if ( entry )
         {
-            Device* dev = dm->deviceForIndex( dm->index( i ) );
-            Partition* candidate = CalamaresUtils::Partition::findPartitionByPath( { dev }, partitionWithOs );
-            if ( candidate )
-            {
-                return canBeResized( candidate, o );
-            }
+            return canBeResized( entry->partition, o );
         }
-        cDebug() << Logger::SubEntry << "no Partition* found for" << partitionWithOs;
+        cDebug() << Logger::SubEntry << "no Partition* found for" << partitionPath;
     }
 
-    cDebug() << Logger::SubEntry << "Partition" << partitionWithOs << "CANNOT BE RESIZED FOR AUTOINSTALL.";
+    cDebug() << Logger::SubEntry << "Partition" << partitionPath << "CANNOT BE RESIZED FOR AUTOINSTALL.";
     return false;
 }
 
+bool
+canBeResized( DeviceModel* dm, const QString& partitionPath, const Logger::Once& o )
+{
+    return canBeResized( CalamaresUtils::Partition::PartitionSnapshot( modelDevices( dm ) ), partitionPath, o );
+}
+
 
 static FstabEntryList
 lookForFstabEntries( const QString& partitionPath )
 {
     QStringList mountOptions { "ro" };
 
-    auto r = CalamaresUtils::System::runCommand( CalamaresUtils::System::RunLocation::RunInHost,
-                                                 { "blkid", "-s", "TYPE", "-o", "value", partitionPath } );
-    if ( r.getExitCode() )
+    const auto probe = probeFilesystem( partitionPath );
+    if ( !probe.isValid() )
     {
         cWarning() << "blkid on" << partitionPath << "failed.";
     }
-    else
+    else if ( ( probe.type == "ext3" ) || ( probe.type == "ext4" ) )
     {
-        QString fstype = r.getOutput().trimmed();
-        if ( ( fstype == "ext3" ) || ( fstype == "ext4" ) )
-        {
-            mountOptions.append( "noload" );
-        }
+        mountOptions.append( "noload" );
     }
 
-    cDebug() << "Checking device" << partitionPath << "for fstab (fs=" << r.getOutput() << ')';
+    cDebug() << "Checking device" << partitionPath << "for fstab (fs=" << probe.type << ')';
 
     FstabEntryList fstabEntries;
 
-    CalamaresUtils::Partition::TemporaryMount mount( partitionPath, QString(), mountOptions.join( ',' ) );
+    // With the type from blkid, there is no guessing when mounting
+    CalamaresUtils::Partition::TemporaryMount mount(
+        partitionPath, probe.isValid() ? probe.type : QString(), mountOptions.join( ',' ) );
     if ( mount.isValid() )
     {
         QFile fstabFile( mount.path() + "/etc/fstab" );
@@ -356,12 +502,84 @@ findPartitionPathForMountPoint( const FstabEntryList& fstab, const QString& moun
 }
 
 
+/** @brief Parses one line of os-prober output into @p entry
+ *
+ * Returns @c false if the line does not describe an OS on a partition.
+ * Only the name, path, file and line fields of @p entry are set.
+ */
+static bool
+parseOsproberLine( const QString& line, OsproberEntry& entry )
+{
+    if ( line.simplified().isEmpty() )
+    {
+        return false;
+    }
+
+    QStringList lineColumns = line.split( ':' );
+    QString prettyName;
+    if ( !lineColumns.value( 1 ).simplified().isEmpty() )
+    {
+        prettyName = lineColumns.value( 1 ).simplified();
+    }
+    else if ( !lineColumns.value( 2 ).simplified().isEmpty() )
+    {
+        prettyName = lineColumns.value( 2 ).simplified();
+    }
+
+    QString file, path = lineColumns.value( 0 ).simplified();
+    if ( !path.startsWith( "/dev/" ) )  //basic sanity check
+    {
+        return false;
+    }
+
+    // strip extra file after device: /dev/name@/path/to/file
+    int index = path.indexOf( '@' );
+    if ( index != -1 )
+    {
+        file = path.right( path.length() - index - 1 );
+        path = path.left( index );
+    }
+
+    entry = OsproberEntry { prettyName, path, file, QString(), false, lineColumns, FstabEntryList(), QString() };
+    return true;
+}
+
+/// @brief The fstab of a partition, and the partition it mounts as /home
+using FstabProbe = QPair< FstabEntryList, QString >;
+
+static FstabProbe
+probeFstab( const QString& partitionPath )
+{
+    FstabEntryList fstabEntries = lookForFstabEntries( partitionPath );
+    QString homePath = findPartitionPathForMountPoint( fstabEntries, "/home" );
+    return FstabProbe( fstabEntries, homePath );
+}
+
 OsproberEntryList
-runOsprober( DeviceModel* dm )
+scanOsprober()
 {
-    Logger::Once o;
+    // Each probe mounts a partition and reads from it; don't hammer
+    // the disks with more than a handful of those at once.
+    QThreadPool probePool;
+    probePool.setMaxThreadCount( qBound( 1, QThread::idealThreadCount(), 4 ) );
+
+    // Several os-prober lines may name the same partition (e.g. the EFI
+    // system partition); that partition is probed only once.
+    QHash< QString, QFuture< FstabProbe > > probes;
+    OsproberEntryList osproberEntries;
+
+    auto takeLine = [&]( const QString& line ) {
+        OsproberEntry entry;
+        if ( parseOsproberLine( line.trimmed(), entry ) )
+        {
+            if ( !probes.contains( entry.path ) )
+            {
+                probes.insert( entry.path, QtConcurrent::run( &probePool, probeFstab, entry.path ) );
+            }
+            osproberEntries.append( entry );
+        }
+    };
 
-    QString osproberOutput;
     QProcess osprober;
     osprober.setProgram( "os-prober" );
     osprober.setProcessChannelMode( QProcess::SeparateChannels );
@@ -370,60 +588,63 @@ runOsprober( DeviceModel* dm )
     {
         cError() << "os-prober cannot start.";
     }
-    else if ( !osprober.waitForFinished( 60000 ) )
-    {
-        cError() << "os-prober timed out.";
-    }
     else
     {
-        osproberOutput.append( QString::fromLocal8Bit( osprober.readAllStandardOutput() ).trimmed() );
-    }
-
-    QStringList osproberCleanLines;
-    OsproberEntryList osproberEntries;
-    const auto lines = osproberOutput.split( '\n' );
-    for ( const QString& line : lines )
-    {
-        if ( !line.simplified().isEmpty() )
+        constexpr int timeout = 60000;
+        QElapsedTimer timer;
+        timer.start();
+        while ( osprober.state() != QProcess::NotRunning && !timer.hasExpired( timeout ) )
         {
-            QStringList lineColumns = line.split( ':' );
-            QString prettyName;
-            if ( !lineColumns.value( 1 ).simplified().isEmpty() )
-            {
-                prettyName = lineColumns.value( 1 ).simplified();
-            }
-            else if ( !lineColumns.value( 2 ).simplified().isEmpty() )
+            // Returns early when output arrives, or when os-prober exits
+            osprober.waitForReadyRead( int( qMax( qint64( 1 ), timeout - timer.elapsed() ) ) );
+            while ( osprober.canReadLine() )
             {
-                prettyName = lineColumns.value( 2 ).simplified();
+                takeLine( QString::fromLocal8Bit( osprober.readLine() ) );
             }
+        }
+        const bool timedOut = osprober.state() != QProcess::NotRunning;
+        if ( timedOut )
+        {
+            // Keep what was found so far; the rest is lost.
+            cError() << "os-prober timed out.";
+            osprober.kill();
+            osprober.waitForFinished( 1000 );
+        }
+        // Output that arrived together with the exit is still buffered
+        while ( osprober.canReadLine() )
+        {
+            takeLine( QString::fromLocal8Bit( osprober.readLine() ) );
+        }
+        // The last line may not have a newline at the end; after a kill,
+        // it is cut off instead.
+        const QByteArray tail = osprober.readAllStandardOutput();
+        if ( !timedOut && !tail.trimmed().isEmpty() )
+        {
+            takeLine( QString::fromLocal8Bit( tail ) );
+        }
+    }
 
-            QString file, path = lineColumns.value( 0 ).simplified();
-            if ( !path.startsWith( "/dev/" ) )  //basic sanity check
-            {
-                continue;
-            }
+    for ( auto& entry : osproberEntries )
+    {
+        const FstabProbe probe = probes.value( entry.path ).result();
+        entry.fstab = probe.first;
+        entry.homePath = probe.second;
+    }
+    return osproberEntries;
+}
 
-            // strip extra file after device: /dev/name@/path/to/file
-            int index = path.indexOf( '@' );
-            if ( index != -1 )
-            {
-                file = path.right( path.length() - index - 1 );
-                path = path.left( index );
-            }
+void
+finishOsprober( DeviceModel* dm, OsproberEntryList& entries )
+{
+    Logger::Once o;
 
-            FstabEntryList fstabEntries = lookForFstabEntries( path );
-            QString homePath = findPartitionPathForMountPoint( fstabEntries, "/home" );
-
-            osproberEntries.append( { prettyName,
-                                      path,
-                                      file,
-                                      QString(),
-                                      canBeResized( dm, path, o ),
-                                      lineColumns,
-                                      fstabEntries,
-                                      homePath } );
-            osproberCleanLines.append( line );
-        }
+    // All the entries are looked up on the same devices
+    const CalamaresUtils::Partition::PartitionSnapshot partitions( modelDevices( dm ) );
+    QStringList osproberCleanLines;
+    for ( auto& entry : entries )
+    {
+        entry.canBeResized = canBeResized( partitions, entry.path, o );
+        osproberCleanLines.append( entry.line.join( ':' ) );
     }
 
     if ( osproberCleanLines.count() > 0 )
@@ -436,14 +657,158 @@ runOsprober( DeviceModel* dm )
     }
 
     Calamares::JobQueue::instance()->globalStorage()->insert( "osproberLines", osproberCleanLines );
+}
 
+OsproberEntryList
+runOsprober( DeviceModel* dm )
+{
+    OsproberEntryList osproberEntries = scanOsprober();
+    finishOsprober( dm, osproberEntries );
     return osproberEntries;
 }
 
+QString
+blockDevicesFingerprint()
+{
+    static const char sysBlock[] = "/sys/class/block";
+    static const char* const attributes[]
+        = { "dev", "size", "start", "ro", "diskseq", "device/serial", "device/wwid" };
+
+    QDir blockDir( sysBlock );
+    if ( !blockDir.exists() )
+    {
+        return QString();
+    }
+
+    QStringList fingerprint;
+    const auto names = blockDir.entryList( QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name );
+    for ( const QString& name : names )
+    {
+        QStringList line { name };
+        for ( const char* attribute : attributes )
+        {
+            QFile f( blockDir.filePath( name + '/' + attribute ) );
+            line.append( f.open( QIODevice::ReadOnly ) ? QString::fromLatin1( f.readAll() ).trimmed() : QString() );
+        }
+        fingerprint.append( line.join( ' ' ) );
+    }
+    return fingerprint.join( '\n' );
+}
+
+bool
+isRotational( const QString& deviceNode )
+{
+    QFile f( QStringLiteral( "/sys/class/block/%1/queue/rotational" ).arg( QFileInfo( deviceNode ).fileName() ) );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        return true;
+    }
+    return f.readAll().trimmed() != "0";
+}
+
+bool
+supportsDiscard( const QString& deviceNode )
+{
+    const QString disk = QFileInfo( deviceNode ).fileName();
+    QFile f( QStringLiteral( "/sys/class/block/%1/queue/discard_max_bytes" ).arg( disk ) );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        return false;
+    }
+    return f.readAll().trimmed().toULongLong() > 0;
+}
+
+QString
+deviceClass( const QString& deviceNode )
+{
+    const QString disk = QFileInfo( deviceNode ).fileName();
+    if ( disk.startsWith( QStringLiteral( "vd" ) ) || disk.startsWith( QStringLiteral( "xvd" ) ) )
+    {
+        return QStringLiteral( "virtual" );
+    }
+
+    QFile model( QStringLiteral( "/sys/class/block/%1/device/model" ).arg( disk ) );
+    if ( model.open( QIODevice::ReadOnly ) )
+    {
+        static const QStringList hypervisors { "QEMU", "VBOX", "VMware", "Virtual" };
+        const QString name = QString::fromLatin1( model.readAll() );
+        if ( std::any_of( hypervisors.cbegin(), hypervisors.cend(), [ &name ]( const QString& h ) {
+                 return name.contains( h, Qt::CaseInsensitive );
+             } ) )
+        {
+            return QStringLiteral( "virtual" );
+        }
+    }
+
+    if ( disk.startsWith( QStringLiteral( "nvme" ) ) )
+    {
+        return QStringLiteral( "nvme" );
+    }
+    if ( disk.startsWith( QStringLiteral( "mmcblk" ) ) )
+    {
+        return QStringLiteral( "mmc" );
+    }
+    return isRotational( deviceNode ) ? QStringLiteral( "hdd" ) : QStringLiteral( "ssd" );
+}
+
+qint64
+alignmentFromHints( qint64 logicalSize, const QList< qint64 >& hints )
+{
+    using CalamaresUtils::Units::operator""_MiB;
+    constexpr qint64 maxAlignment = 64_MiB;
+
+    qint64 alignment = std::max( 1_MiB, logicalSize );
+    for ( qint64 hint : hints )
+    {
+        if ( hint <= 0 || ( logicalSize > 0 && hint % logicalSize ) )
+        {
+            continue;
+        }
+        const qint64 aligned = std::lcm( alignment, hint );
+        if ( aligned > maxAlignment )
+        {
+            cDebug() << "Ignoring I/O size hint" << hint << "for alignment.";
+            continue;
+        }
+        alignment = aligned;
+    }
+    return alignment;
+}
+
+qint64
+partitionAlignment( const QString& deviceNode, qint64 logicalSize )
+{
+    const QDir sysfs( QStringLiteral( "/sys/class/block/%1" ).arg( QFileInfo( deviceNode ).fileName() ) );
+    auto read = [ &sysfs ]( const char* name ) -> qint64 {
+        QFile f( sysfs.filePath( QString::fromLatin1( name ) ) );
+        if ( !f.open( QIODevice::ReadOnly ) )
+        {
+            return 0;
+        }
+        return f.readAll().trimmed().toLongLong();
+    };
+
+    if ( read( "alignment_offset" ) )
+    {
+        // The disk's own sectors do not start on a boundary; the hints
+        // below would be off by that much, so stick to the default.
+        cWarning() << "Device" << deviceNode << "has an alignment offset, using 1MiB alignment.";
+        return alignmentFromHints( logicalSize, {} );
+    }
+
+    const qint64 alignment = alignmentFromHints( logicalSize,
+                                                 { read( "queue/physical_block_size" ),
+                                                   read( "queue/minimum_io_size" ),
+                                                   read( "queue/optimal_io_size" ),
+                                                   read( "device/preferred_erase_size" ) } );
+    cDebug() << "Partitions on" << deviceNode << "are aligned to" << alignment / 1024 << "KiB.";
+    return alignment;
+}
+
 bool
 isEfiSystem()
 {
-    return QDir( "/sys/firmware/efi/efivars" ).exists();
+    return CalamaresUtils::HardwareInfo::instance().isEfi();
 }
 
 bool
@@ -20,8 +20,10 @@
 #include <kpmcore/fs/filesystem.h>
 
 // Qt
+#include <QSet>
 #include <QString>
 
+class Device;
 class DeviceModel;
 class Partition;
 namespace Logger
@@ -53,6 +55,12 @@ bool canBeReplaced( Partition* candidate, const Logger::Once& o );
 /**
  * @brief canBeReplaced checks whether the given Partition satisfies the criteria
  * for resizing (shrinking) it to make room for a new OS.
+ *
+ * The result is remembered per partition path and filesystem UUID
+ * (and storage requirement), since the device analysis, the os-prober
+ * entries and the choice page all ask about the same partitions.
+ * Use clearResizeChecks() when the disks may have changed.
+ *
  * @param candidate the candidate partition to resize.
  * @param o applied to debug-logging.
  * @return true if the criteria are met, otherwise false.
@@ -69,14 +77,131 @@ bool canBeResized( Partition* candidate, const Logger::Once& o );
  */
 bool canBeResized( DeviceModel* dm, const QString& partitionPath, const Logger::Once& o );
 
+/** @brief Forgets the remembered results of canBeResized()
+ *
+ * Checks that are running while this is called do not remember
+ * their results either. This can be called from any thread.
+ */
+void clearResizeChecks();
+
+/** @brief What can be done with the partitions of one device
+ *
+ * The partitions are those of the Device passed to analyzeDevice(),
+ * and the results apply only as long as that device does not change.
+ */
+struct DeviceAnalysis
+{
+    QSet< const Partition* > resizable;  ///< Those for which canBeResized() is true
+    QSet< const Partition* > replaceable;  ///< Those for which canBeReplaced() is true
+    bool anyMounted = false;
+    double requiredStorageGiB = -1.0;  ///< The requirement the checks used
+
+    bool canBeResized( const Partition* candidate ) const { return resizable.contains( candidate ); }
+    bool canBeReplaced( const Partition* candidate ) const { return replaceable.contains( candidate ); }
+    /// @brief Is this still correct for the current storage requirement?
+    bool isCurrent() const;
+};
+
+/**
+ * @brief Checks canBeResized() and canBeReplaced() for each partition of @p device
+ *
+ * This also checks if any partition is mounted. It does not change
+ * the device, so it can be done on a device in another thread.
+ */
+DeviceAnalysis analyzeDevice( Device* device );
+
+/**
+ * @brief scanOsprober executes os-prober and probes the fstab of each OS found
+ *
+ * Lines are parsed as os-prober prints them, and the fstab of each
+ * partition is read (in a small thread pool) while os-prober goes on
+ * looking at the other partitions. This does not need a DeviceModel,
+ * so it can run in the background while devices are scanned. The
+ * entries are returned in os-prober order; canBeResized is not set.
+ *
+ * @return a list of os-prober entries, parsed.
+ */
+OsproberEntryList scanOsprober();
+
+/**
+ * @brief finishOsprober completes the @p entries from scanOsprober()
+ *
+ * Fills in canBeResized for each entry and writes relevant
+ * data to GlobalStorage.
+ * @param dm the DeviceModel instance.
+ * @param entries the entries to update.
+ */
+void finishOsprober( DeviceModel* dm, OsproberEntryList& entries );
+
 /**
  * @brief runOsprober executes os-prober, parses the output and writes relevant
  * data to GlobalStorage.
+ *
+ * This is scanOsprober() followed by finishOsprober().
  * @param dm the DeviceModel instance.
  * @return a list of os-prober entries, parsed.
  */
 OsproberEntryList runOsprober( DeviceModel* dm );
 
+/**
+ * @brief A fingerprint of the block devices in the system
+ *
+ * Built from sysfs: for each block device and partition its device
+ * number, size, start sector, read-only flag, media generation (diskseq)
+ * and serial number (if the kernel provides them). Equal fingerprints
+ * mean that no disk was added, removed or swapped, and no partition
+ * was created, deleted or moved, in between. Returns an empty string
+ * if sysfs is not available; an empty fingerprint matches nothing.
+ */
+QString blockDevicesFingerprint();
+
+/**
+ * @brief Does the disk @p deviceNode (e.g. "/dev/sda") have spinning platters?
+ *
+ * Decides based on the rotational flag in sysfs; when that is not
+ * available (e.g. not a whole disk), the disk is assumed to be rotational.
+ */
+bool isRotational( const QString& deviceNode );
+
+/**
+ * @brief Can the disk @p deviceNode (e.g. "/dev/nvme0n1") discard blocks?
+ *
+ * Decides based on the discard limit in sysfs; when that is not
+ * available, the disk is assumed not to support discard.
+ */
+bool supportsDiscard( const QString& deviceNode );
+
+/**
+ * @brief The class of the disk @p deviceNode, for device-class profiles
+ *
+ * One of "virtual" (virtio and Xen disks, and disks that the hypervisor
+ * names as such), "nvme", "mmc" (eMMC and SD cards), "hdd" (rotational)
+ * or "ssd" (anything else). Decides based on the name and sysfs; when
+ * sysfs does not know the disk, it is a "hdd", as in isRotational().
+ */
+QString deviceClass( const QString& deviceNode );
+
+/**
+ * @brief Combines I/O topology hints into an alignment, in bytes
+ *
+ * The alignment is at least 1MiB (and the @p logicalSize), and a multiple
+ * of each of the @p hints (in bytes) that makes sense: hints that are not
+ * a multiple of the logical sector size, or that would push the alignment
+ * past 64MiB, are ignored, since some disks report nonsense there.
+ */
+qint64 alignmentFromHints( qint64 logicalSize, const QList< qint64 >& hints );
+
+/**
+ * @brief The alignment, in bytes, for new partitions on @p deviceNode
+ *
+ * Reads the I/O topology of the disk from sysfs: the physical block size,
+ * the minimum and optimal I/O sizes (for RAID, the chunk size and the
+ * stripe width) and the erase-block size of eMMC and SD cards, and
+ * combines them with alignmentFromHints(). Without sysfs (or for devices
+ * that are not disks, such as LVM volume groups) this is 1MiB.
+ */
+qint64 partitionAlignment( const QString& deviceNode, qint64 logicalSize );
+
 /**
  * @brief Is this system EFI-enabled? Decides based on /sys/firmware/efi
  */
@@ -36,7 +36,8 @@ namespace PartitionActions
 qint64
 swapSuggestion( const qint64 availableSpaceB, Config::SwapChoice swap )
 {
-    if ( ( swap != Config::SwapChoice::SmallSwap ) && ( swap != Config::SwapChoice::FullSwap ) )
+    if ( ( swap != Config::SwapChoice::SmallSwap ) && ( swap != Config::SwapChoice::FullSwap )
+         && ( swap != Config::SwapChoice::SwapFile ) && ( swap != Config::SwapChoice::ZRamSwap ) )
     {
         return 0;
     }
@@ -47,6 +48,13 @@ swapSuggestion( const qint64 availableSpaceB, Config::SwapChoice swap )
     qint64 availableRamB = memory.first;
     qreal overestimationFactor = memory.second;
 
+    // Compressed swap in RAM takes no disk space: it is as large as
+    // the RAM, up to 8GiB as for small swap.
+    if ( swap == Config::SwapChoice::ZRamSwap )
+    {
+        return qMin( 8_GiB, qint64( availableRamB * overestimationFactor ) );
+    }
+
     bool ensureSuspendToDisk = swap == Config::SwapChoice::FullSwap;
 
     // Ramp up quickly to 8GiB, then follow memory size
@@ -102,6 +110,16 @@ doAutopartition( PartitionCoreModule* core, Device* dev, Choices::AutoPartitionO
     // before that one, numbered 0..2047).
     qint64 firstFreeSector = CalamaresUtils::bytesToSectors( empty_space_sizeB, dev->logicalSize() );
 
+    // Partitions start (and so, end) on boundaries that suit the disk:
+    // 1MiB, or more for RAID stripes and large erase blocks.
+    const qint64 alignSectors
+        = PartUtils::partitionAlignment( dev->deviceNode(), dev->logicalSize() ) / dev->logicalSize();
+    auto alignUp = [ alignSectors ]( qint64 sector ) {
+        return ( ( sector + alignSectors - 1 ) / alignSectors ) * alignSectors;
+    };
+    auto alignDown = [ alignSectors ]( qint64 sector ) { return ( sector / alignSectors ) * alignSectors; };
+    firstFreeSector = alignUp( firstFreeSector );
+
     PartitionTable::TableType partType = PartitionTable::nameToTableType( o.defaultPartitionTableType );
     if ( partType == PartitionTable::unknownTableType )
     {
@@ -126,7 +144,7 @@ doAutopartition( PartitionCoreModule* core, Device* dev, Choices::AutoPartitionO
             uefisys_part_sizeB = part_size.toBytes( dev->capacity() );
         }
 
-        qint64 efiSectorCount = CalamaresUtils::bytesToSectors( uefisys_part_sizeB, dev->logicalSize() );
+        qint64 efiSectorCount = alignUp( CalamaresUtils::bytesToSectors( uefisys_part_sizeB, dev->logicalSize() ) );
         Q_ASSERT( efiSectorCount > 0 );
 
         // Since sectors count from 0, and this partition is created starting
@@ -168,11 +186,33 @@ doAutopartition( PartitionCoreModule* core, Device* dev, Choices::AutoPartitionO
         // If there is enough room for ESP + root + swap, create swap, otherwise don't.
         shouldCreateSwap = availableSpaceB > requiredSpaceB;
     }
+    else if ( o.swap == Config::SwapChoice::SwapFile )
+    {
+        // The fstab module creates the swapfile; tell it how large
+        qint64 availableSpaceB = ( dev->totalLogical() - firstFreeSector ) * dev->logicalSize();
+        gs->insert( "swapFileSizeMiB", CalamaresUtils::BytesToMiB( swapSuggestion( availableSpaceB, o.swap ) ) );
+    }
+    else if ( o.swap == Config::SwapChoice::ZRamSwap )
+    {
+        // The fstab module configures zram in the target; tell it how large
+        gs->insert( "zramSizeMiB", CalamaresUtils::BytesToMiB( swapSuggestion( 0, o.swap ) ) );
+    }
+    // From an earlier choice (e.g. going back to the partitioning page)
+    if ( o.swap != Config::SwapChoice::SwapFile )
+    {
+        gs->remove( "swapFileSizeMiB" );
+    }
+    if ( o.swap != Config::SwapChoice::ZRamSwap )
+    {
+        gs->remove( "zramSizeMiB" );
+    }
 
     qint64 lastSectorForRoot = dev->totalLogical() - 1;  //last sector of the device
     if ( shouldCreateSwap )
     {
         lastSectorForRoot -= suggestedSwapSizeB / dev->logicalSize() + 1;
+        // Start swap on a boundary, too
+        lastSectorForRoot = alignDown( lastSectorForRoot + 1 ) - 1;
     }
 
     core->layoutApply( dev, firstFreeSector, lastSectorForRoot, o.luksPassphrase );
@@ -63,6 +63,15 @@ struct AutoPartitionOptions : ReplacePartitionOptions
 
 }  // namespace Choices
 
+/**
+ * @brief The suggested size of swap for @p swap, in bytes
+ *
+ * This follows the RAM size, see partition.conf. The @p availableSpaceB
+ * on the disk limits swap on disk (but not in RAM, for zram). Returns 0
+ * for choices that create no swap.
+ */
+qint64 swapSuggestion( const qint64 availableSpaceB, Config::SwapChoice swap );
+
 /**
  * @brief doAutopartition sets up an autopartitioning operation on the given Device.
  * @param core a pointer to the PartitionCoreModule instance.
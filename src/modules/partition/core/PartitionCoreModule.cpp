@@ -13,12 +13,17 @@
 
 #include "core/PartitionCoreModule.h"
 
+#include "Config.h"
+
 #include "core/BootLoaderModel.h"
 #include "core/ColorUtils.h"
 #include "core/DeviceList.h"
 #include "core/DeviceModel.h"
+#include "core/DeviceWatcher.h"
+#include "core/FilesystemProbe.h"
 #include "core/KPMHelpers.h"
 #include "core/PartUtils.h"
+#include "core/PartitionActions.h"
 #include "core/PartitionInfo.h"
 #include "core/PartitionModel.h"
 #include "jobs/AutoMountManagementJob.h"
@@ -32,17 +37,23 @@
 #include "jobs/DeletePartitionJob.h"
 #include "jobs/FillGlobalStorageJob.h"
 #include "jobs/FormatPartitionJob.h"
+#include "jobs/PartitionBatchJob.h"
 #include "jobs/RemoveVolumeGroupJob.h"
 #include "jobs/ResizePartitionJob.h"
 #include "jobs/ResizeVolumeGroupJob.h"
 #include "jobs/SetPartitionFlagsJob.h"
+#include "jobs/ZRamSwapJob.h"
 
 #ifdef DEBUG_PARTITION_LAME
 #include "JobExample.h"
 #endif
+#include "partition/FileSystem.h"
 #include "partition/PartitionIterator.h"
 #include "partition/PartitionQuery.h"
+#include "partition/PartitionSnapshot.h"
+#include "utils/Executor.h"
 #include "utils/Logger.h"
+#include "utils/Retranslator.h"
 #include "utils/Traits.h"
 #include "utils/Variant.h"
 
@@ -62,27 +73,33 @@
 #include <QFutureWatcher>
 #include <QProcess>
 #include <QStandardItemModel>
-#include <QtConcurrent/QtConcurrent>
+#include <QTimer>
+
+#include <algorithm>
+#include <iterator>
 
 using CalamaresUtils::Partition::isPartitionFreeSpace;
 using CalamaresUtils::Partition::isPartitionNew;
 using CalamaresUtils::Partition::PartitionIterator;
 
-PartitionCoreModule::RefreshHelper::RefreshHelper( PartitionCoreModule* module )
+namespace Executor = CalamaresUtils::Executor;
+
+PartitionCoreModule::RefreshHelper::RefreshHelper( PartitionCoreModule* module, const Device* device )
     : m_module( module )
+    , m_device( device )
 {
 }
 
 PartitionCoreModule::RefreshHelper::~RefreshHelper()
 {
-    m_module->refreshAfterModelChange();
+    m_module->refreshAfterModelChange( m_device );
 }
 
 class OperationHelper
 {
 public:
-    OperationHelper( PartitionModel* model, PartitionCoreModule* core )
-        : m_coreHelper( core )
+    OperationHelper( const Device* device, PartitionModel* model, PartitionCoreModule* core )
+        : m_coreHelper( core, device )
         , m_modelHelper( model )
     {
     }
@@ -95,7 +112,7 @@ private:
     // then refresh is called. Remember that destructors are
     // called in *reverse* order of declaration in this class.
     PartitionCoreModule::RefreshHelper m_coreHelper;
-    PartitionModel::ResetHelper m_modelHelper;
+    PartitionModel::UpdateHelper m_modelHelper;
 };
 
 
@@ -133,6 +150,8 @@ struct PartitionCoreModule::DeviceInfo
     QScopedPointer< Device > device;
     QScopedPointer< PartitionModel > partitionModel;
     const QScopedPointer< Device > immutableDevice;
+    /// @brief Analysis of the immutableDevice
+    PartUtils::DeviceAnalysis analysis;
 
     // To check if LVM VGs are deactivated
     bool isAvailable;
@@ -140,6 +159,21 @@ struct PartitionCoreModule::DeviceInfo
     void forgetChanges();
     bool isDirty() const;
 
+    /** @brief State derived from the device, as of the last updateState()
+     *
+     * The module combines these for all of the devices, so that
+     * a change to one device needs a look at that device only.
+     */
+    bool dirty = false;
+    bool hasRootMountPoint = false;
+    QList< Partition* > efiSystemPartitions;
+
+    /// @brief Alignment of the partitions from layoutApply(), in bytes; 0 if none
+    qint64 alignment = 0;
+
+    /// @brief Looks at the device (and its jobs) again for the state above
+    void updateState();
+
     const Calamares::JobList& jobs() const { return m_jobs; }
 
     /** @brief Take the jobs of the given type that apply to @p partition
@@ -187,8 +221,10 @@ PartitionCoreModule::DeviceInfo::DeviceInfo( Device* _device )
     : device( _device )
     , partitionModel( new PartitionModel )
     , immutableDevice( new Device( *_device ) )
+    , analysis( PartUtils::analyzeDevice( immutableDevice.data() ) )
     , isAvailable( true )
 {
+    updateState();
 }
 
 PartitionCoreModule::DeviceInfo::~DeviceInfo() {}
@@ -203,6 +239,8 @@ PartitionCoreModule::DeviceInfo::forgetChanges()
         PartitionInfo::reset( *it );
     }
     partitionModel->revert();
+    alignment = 0;
+    updateState();
 }
 
 
@@ -225,16 +263,43 @@ PartitionCoreModule::DeviceInfo::isDirty() const
     return false;
 }
 
+void
+PartitionCoreModule::DeviceInfo::updateState()
+{
+    static const QString root = QStringLiteral( "/" );
+    const bool isEfi = PartUtils::isEfiSystem();
+
+    dirty = !m_jobs.isEmpty();
+    hasRootMountPoint = false;
+    efiSystemPartitions.clear();
+    for ( auto it = PartitionIterator::begin( device.data() ); it != PartitionIterator::end( device.data() ); ++it )
+    {
+        dirty = dirty || PartitionInfo::isDirty( *it );
+        hasRootMountPoint = hasRootMountPoint || PartitionInfo::mountPoint( *it ) == root;
+        if ( isEfi && PartUtils::isEfiBootable( *it ) )
+        {
+            efiSystemPartitions.append( *it );
+        }
+    }
+}
+
 //- PartitionCoreModule ------------------------------------
 PartitionCoreModule::PartitionCoreModule( QObject* parent )
     : QObject( parent )
     , m_deviceModel( new DeviceModel( this ) )
     , m_bootLoaderModel( new BootLoaderModel( this ) )
+    , m_deviceWatcher( new DeviceWatcher( this ) )
 {
     if ( !m_kpmcore )
     {
         qFatal( "Failed to initialize KPMcore backend" );
     }
+    connect( m_deviceWatcher, &DeviceWatcher::devicesChanged, this, &PartitionCoreModule::updateDevices );
+    // The cached job descriptions are translated
+    connect( CalamaresUtils::Retranslator::instance(),
+             &CalamaresUtils::Retranslator::languageChanged,
+             this,
+             &PartitionCoreModule::invalidateJobs );
 }
 
 
@@ -250,10 +315,31 @@ void
 PartitionCoreModule::doInit()
 {
     FileSystemFactory::init();
+    // Disks may have changed since the last probes (when reverting)
+    PartUtils::clearFilesystemProbes();
+    PartUtils::clearResizeChecks();
+
+    const QString fingerprint = PartUtils::blockDevicesFingerprint();
+    const bool reuseOsprober = !fingerprint.isEmpty() && fingerprint == m_osproberFingerprint;
 
     using DeviceList = QList< Device* >;
     DeviceList devices = PartUtils::getDevices( PartUtils::DeviceType::WritableOnly );
 
+    // os-prober (and reading fstab from what it finds) is slow; it mounts
+    // the partitions it probes, so it waits for KPMcore to finish scanning
+    // the devices, and then runs while the device models are filled. When
+    // reverting, and the disks have not changed since the last scan,
+    // the previous results are used instead.
+    QFuture< OsproberEntryList > osprober;
+    if ( reuseOsprober )
+    {
+        cDebug() << "Block devices unchanged, re-using" << m_osproberScan.count() << "os-prober entries.";
+    }
+    else
+    {
+        osprober = Executor::run( Executor::Lane::BulkIO, "os-prober", []() { return PartUtils::scanOsprober(); } );
+    }
+
     cDebug() << "LIST OF DETECTED DEVICES:";
     cDebug() << Logger::SubEntry << "node\tcapacity\tname\tprettyName";
     for ( auto device : devices )
@@ -264,6 +350,7 @@ PartitionCoreModule::doInit()
             // Gives ownership of the Device* to the DeviceInfo object
             auto deviceInfo = new DeviceInfo( device );
             m_deviceInfos << deviceInfo;
+            m_deviceWatcher->ignoreScanned( device->deviceNode() );
             cDebug() << Logger::SubEntry << device->deviceNode() << device->capacity() << device->name()
                      << device->prettyName();
         }
@@ -275,9 +362,29 @@ PartitionCoreModule::doInit()
     cDebug() << Logger::SubEntry << devices.count() << "devices detected.";
     m_deviceModel->init( devices );
 
-    // The following PartUtils::runOsprober call in turn calls PartUtils::canBeResized,
+    //FIXME: this should be removed in favor of
+    //       proper KPM support for EFI
+    QFuture< void > efiScan;
+    if ( PartUtils::isEfiSystem() )
+    {
+        efiScan = Executor::run( Executor::Lane::BulkIO, "efi-scan", [ this ]() { scanForEfiSystemPartitions(); } );
+    }
+
+    // The following PartUtils::finishOsprober call in turn calls PartUtils::canBeResized,
     // which relies on a working DeviceModel.
-    m_osproberLines = PartUtils::runOsprober( this->deviceModel() );
+    if ( !reuseOsprober )
+    {
+        m_osproberScan = osprober.result();
+        m_osproberFingerprint = fingerprint;
+    }
+    m_osproberLines = m_osproberScan;
+    PartUtils::finishOsprober( this->deviceModel(), m_osproberLines );
+
+    // Looking for LVM physical volumes runs the LVM tools, which takes a
+    // while. The tools scan the same disks that os-prober mounts partitions
+    // of, so this starts once os-prober is done, and runs while the
+    // partition models are filled.
+    QFuture< void > lvmScan = Executor::run( Executor::Lane::BulkIO, "lvm-scan", [ this ]() { scanForLVMPVs(); } );
 
     // We perform a best effort of filling out filesystem UUIDs in m_osproberLines
     // because we will need them later on in PartitionModel if partition paths
@@ -289,20 +396,22 @@ PartitionCoreModule::doInit()
     // designed that it requires a partition path rearrangement at runtime?
     // Logical partitions on an MSDOS disklabel of course.
     // See DeletePartitionJob::updatePreview.
-    for ( auto deviceInfo : m_deviceInfos )
     {
-        for ( auto it = PartitionIterator::begin( deviceInfo->device.data() );
-              it != PartitionIterator::end( deviceInfo->device.data() );
-              ++it )
+        QList< Device* > scanned;
+        for ( auto deviceInfo : qAsConst( m_deviceInfos ) )
+        {
+            scanned.append( deviceInfo->device.data() );
+        }
+        const CalamaresUtils::Partition::PartitionSnapshot partitions( scanned );
+        for ( auto& line : m_osproberLines )
         {
-            Partition* partition = *it;
-            for ( auto jt = m_osproberLines.begin(); jt != m_osproberLines.end(); ++jt )
+            const auto* entry = partitions.findByPath( line.path );
+            if ( entry )
             {
-                if ( jt->path == partition->partitionPath()
-                     && partition->fileSystem().supportGetUUID() != FileSystem::cmdSupportNone
-                     && !partition->fileSystem().uuid().isEmpty() )
+                const FileSystem& fs = entry->partition->fileSystem();
+                if ( fs.supportGetUUID() != FileSystem::cmdSupportNone && !fs.uuid().isEmpty() )
                 {
-                    jt->uuid = partition->fileSystem().uuid();
+                    line.uuid = fs.uuid();
                 }
             }
         }
@@ -328,14 +437,9 @@ PartitionCoreModule::doInit()
 
     m_bootLoaderModel->init( bootLoaderDevices );
 
-    scanForLVMPVs();
-
-    //FIXME: this should be removed in favor of
-    //       proper KPM support for EFI
-    if ( PartUtils::isEfiSystem() )
-    {
-        scanForEfiSystemPartitions();
-    }
+    lvmScan.waitForFinished();
+    efiScan.waitForFinished();
+    invalidateJobs();
 }
 
 PartitionCoreModule::~PartitionCoreModule()
@@ -378,6 +482,24 @@ PartitionCoreModule::immutableDeviceCopy( const Device* device )
 }
 
 
+PartUtils::DeviceAnalysis
+PartitionCoreModule::deviceAnalysis( const Device* device )
+{
+    Q_ASSERT( device );
+    DeviceInfo* info = infoForDevice( device );
+    if ( !info )
+    {
+        return PartUtils::DeviceAnalysis();
+    }
+
+    if ( !info->analysis.isCurrent() )
+    {
+        info->analysis = PartUtils::analyzeDevice( info->immutableDevice.data() );
+    }
+    return info->analysis;
+}
+
+
 void
 PartitionCoreModule::createPartitionTable( Device* device, PartitionTable::TableType type )
 {
@@ -388,18 +510,53 @@ PartitionCoreModule::createPartitionTable( Device* device, PartitionTable::Table
         // keep previous changes
         deviceInfo->forgetChanges();
 
-        OperationHelper helper( partitionModelForDevice( device ), this );
+        OperationHelper helper( device, partitionModelForDevice( device ), this );
         deviceInfo->makeJob< CreatePartitionTableJob >( type );
     }
 }
 
+/** @brief Adds the filesystem features from the device-class profile of @p device
+ *
+ * The new filesystem of @p partition gets the features that the profile
+ * lists for its type, unless it has that feature already (e.g. from the
+ * partition layout). Features reach mkfs only with KPMcore 4.2.
+ */
+static void
+addProfileFeatures( const Config* config, Device* device, Partition* partition )
+{
+    if ( !config )
+    {
+        return;
+    }
+    const auto profile = config->deviceClassProfile( PartUtils::deviceClass( device->deviceNode() ) );
+    if ( profile.features.isEmpty() )
+    {
+        return;
+    }
+#if defined( WITH_KPMCORE42API )
+    FileSystem& fs = partition->fileSystem();
+    const QVariantMap features = profile.features.value( CalamaresUtils::Partition::untranslatedFS( fs ) ).toMap();
+    for ( auto it = features.cbegin(); it != features.cend(); ++it )
+    {
+        if ( !fs.features().contains( it.key() ) )
+        {
+            fs.addFeature( it.key(), it.value() );
+        }
+    }
+#else
+    Q_UNUSED( partition )
+    cWarning() << "Ignoring device-class features for" << device->deviceNode() << "; requires KPMcore >= 4.2.0.";
+#endif
+}
+
 void
 PartitionCoreModule::createPartition( Device* device, Partition* partition, PartitionTable::Flags flags )
 {
     auto* deviceInfo = infoForDevice( device );
     Q_ASSERT( deviceInfo );
 
-    OperationHelper helper( partitionModelForDevice( device ), this );
+    addProfileFeatures( m_profileConfig, device, partition );
+    OperationHelper helper( device, partitionModelForDevice( device ), this );
     deviceInfo->makeJob< CreatePartitionJob >( partition );
 
     if ( flags != KPM_PARTITION_FLAG( None ) )
@@ -474,7 +631,7 @@ PartitionCoreModule::deletePartition( Device* device, Partition* partition )
     auto* deviceInfo = infoForDevice( device );
     Q_ASSERT( deviceInfo );
 
-    OperationHelper helper( partitionModelForDevice( device ), this );
+    OperationHelper helper( device, partitionModelForDevice( device ), this );
 
     if ( partition->roles().has( PartitionRole::Extended ) )
     {
@@ -547,7 +704,8 @@ PartitionCoreModule::formatPartition( Device* device, Partition* partition )
 {
     auto* deviceInfo = infoForDevice( device );
     Q_ASSERT( deviceInfo );
-    OperationHelper helper( partitionModelForDevice( device ), this );
+    addProfileFeatures( m_profileConfig, device, partition );
+    OperationHelper helper( device, partitionModelForDevice( device ), this );
     deviceInfo->makeJob< FormatPartitionJob >( partition );
 }
 
@@ -557,7 +715,7 @@ PartitionCoreModule::setFilesystemLabel( Device* device, Partition* partition, c
     auto deviceInfo = infoForDevice( device );
     Q_ASSERT( deviceInfo );
 
-    OperationHelper helper( partitionModelForDevice( device ), this );
+    OperationHelper helper( device, partitionModelForDevice( device ), this );
     deviceInfo->makeJob< ChangeFilesystemLabelJob >( partition, newLabel );
 }
 
@@ -566,7 +724,7 @@ PartitionCoreModule::resizePartition( Device* device, Partition* partition, qint
 {
     auto* deviceInfo = infoForDevice( device );
     Q_ASSERT( deviceInfo );
-    OperationHelper helper( partitionModelForDevice( device ), this );
+    OperationHelper helper( device, partitionModelForDevice( device ), this );
     deviceInfo->makeJob< ResizePartitionJob >( partition, first, last );
 }
 
@@ -575,13 +733,118 @@ PartitionCoreModule::setPartitionFlags( Device* device, Partition* partition, Pa
 {
     auto* deviceInfo = infoForDevice( device );
     Q_ASSERT( deviceInfo );
-    OperationHelper( partitionModelForDevice( device ), this );
+    OperationHelper helper( device, partitionModelForDevice( device ), this );
     deviceInfo->makeJob< SetPartFlagsJob >( partition, flags );
     PartitionInfo::setFlags( partition, flags );
 }
 
+/** @brief Makes the partition table job in @p jobs discard the whole @p device first
+ *
+ * Only in *erase* mode, where the whole disk is going to be overwritten
+ * anyway, and only on solid-state disks that can discard blocks.
+ */
+static void
+setEraseDiscard( const Config* config, Device* device, const Calamares::JobList& jobs )
+{
+    // The jobs stay around when the user picks another choice, so always set it
+    auto discard = CreatePartitionTableJob::Discard::None;
+    if ( config && config->installChoice() == Config::InstallChoice::Erase
+         && config->eraseDiscard() != Config::EraseDiscard::NoDiscard )
+    {
+        if ( PartUtils::isRotational( device->deviceNode() ) || !PartUtils::supportsDiscard( device->deviceNode() ) )
+        {
+            cDebug() << "Not discarding" << device->deviceNode() << "since it is rotational or cannot discard.";
+        }
+        else
+        {
+            discard = config->eraseDiscard() == Config::EraseDiscard::SecureDiscard
+                ? CreatePartitionTableJob::Discard::Secure
+                : CreatePartitionTableJob::Discard::Plain;
+        }
+    }
+    for ( const auto& job : jobs )
+    {
+        if ( auto* tableJob = qobject_cast< CreatePartitionTableJob* >( job.data() ) )
+        {
+            tableJob->setDiscard( discard );
+        }
+    }
+}
+
+/** @brief Puts runs of jobs in @p jobs for @p device together in a PartitionBatchJob
+ *
+ * Consecutive jobs that declare the same resources (so that the JobQueue
+ * would run them one after the other anyway) become one job.
+ */
+static void
+batchDeviceJobs( Device* device, Calamares::JobList& jobs )
+{
+    auto sameResources = []( const Calamares::job_ptr& a, const Calamares::job_ptr& b ) {
+        return a->readResources() == b->readResources() && a->writeResources() == b->writeResources();
+    };
+
+    Calamares::JobList batched;
+    for ( auto it = jobs.cbegin(); it != jobs.cend(); )
+    {
+        auto end = std::find_if_not(
+            it, jobs.cend(), [ & ]( const Calamares::job_ptr& job ) { return sameResources( *it, job ); } );
+        if ( std::distance( it, end ) < 2 )
+        {
+            batched << *it;
+        }
+        else
+        {
+            Calamares::JobList run;
+            std::copy( it, end, std::back_inserter( run ) );
+            Calamares::job_ptr batch( new PartitionBatchJob( device->deviceNode(), run ) );
+            batch->setResources( ( *it )->readResources(), ( *it )->writeResources() );
+            batched << batch;
+        }
+        it = end;
+    }
+    jobs = batched;
+}
+
 Calamares::JobList
 PartitionCoreModule::jobs( const Config* config ) const
+{
+    // Read before the jobs are made: a change meanwhile leaves the cache out of date
+    const quint64 revision = m_jobsRevision.load();
+    if ( m_jobsCache.revision != revision || m_jobsCache.config != config )
+    {
+        m_jobsCache = JobsCache();
+        m_jobsCache.jobs = createJobs( config );
+        m_jobsCache.revision = revision;
+        m_jobsCache.config = config;
+    }
+    return m_jobsCache.jobs;
+}
+
+QStringList
+PartitionCoreModule::jobDescriptions( const Config* config ) const
+{
+    const auto& jobList = jobs( config );
+    if ( !m_jobsCache.hasDescriptions )
+    {
+        for ( const auto& job : jobList )
+        {
+            auto* batch = qobject_cast< PartitionBatchJob* >( job.data() );
+            for ( const auto& j : batch ? batch->jobs() : Calamares::JobList { job } )
+            {
+                const QString description = j->prettyDescription();
+                if ( !description.isEmpty() )
+                {
+                    m_jobsCache.descriptions.append( description );
+                }
+            }
+        }
+        m_jobsCache.hasDescriptions = true;
+    }
+    return m_jobsCache.descriptions;
+}
+
+Calamares::JobList
+PartitionCoreModule::createJobs( const Config* config ) const
 {
     Calamares::JobList lst;
     QList< Device* > devices;
@@ -603,6 +866,11 @@ PartitionCoreModule::jobs( const Config* config ) const
     Calamares::job_ptr automountControl( new AutoMountManagementJob( true /* disable automount */ ) );
     lst << automountControl;
     lst << Calamares::job_ptr( new ClearTempMountsJob() );
+    if ( config && config->liveZRam() )
+    {
+        lst << Calamares::job_ptr(
+            new ZRamSwapJob( PartitionActions::swapSuggestion( 0, Config::SwapChoice::ZRamSwap ) ) );
+    }
 
     for ( auto info : m_deviceInfos )
     {
@@ -614,7 +882,14 @@ PartitionCoreModule::jobs( const Config* config ) const
 
     for ( auto info : m_deviceInfos )
     {
-        lst << info->jobs();
+        const bool isDisk = info->device->type() == Device::Type::Disk_Device;
+        Calamares::JobList deviceJobs = info->jobs();
+        if ( isDisk )
+        {
+            setEraseDiscard( config, info->device.data(), deviceJobs );
+        }
+        batchDeviceJobs( info->device.data(), deviceJobs );
+        lst << deviceJobs;
         devices << info->device.data();
     }
     lst << Calamares::job_ptr( new FillGlobalStorageJob( config, devices, m_bootLoaderInstallPath ) );
@@ -686,17 +961,29 @@ PartitionCoreModule::osproberEntries() const
 void
 PartitionCoreModule::refreshPartition( Device* device, Partition* )
 {
-    // Keep it simple for now: reset the model. This can be improved to cause
-    // the model to Q_EMIT dataChanged() for the affected row instead, avoiding
-    // the loss of the current selection.
+    // The model works out which rows changed, so the helper does it all.
     auto model = partitionModelForDevice( device );
     Q_ASSERT( model );
-    OperationHelper helper( model, this );
+    OperationHelper helper( device, model, this );
 }
 
 void
-PartitionCoreModule::refreshAfterModelChange()
+PartitionCoreModule::refreshAfterModelChange( const Device* changed )
 {
+    invalidateJobs();
+    DeviceInfo* changedInfo = changed ? infoForDevice( changed ) : nullptr;
+    if ( changedInfo )
+    {
+        changedInfo->updateState();
+    }
+    else
+    {
+        for ( auto info : qAsConst( m_deviceInfos ) )
+        {
+            info->updateState();
+        }
+    }
+
     updateHasRootMountPoint();
     updateIsDirty();
     m_bootLoaderModel->update();
@@ -715,7 +1002,9 @@ void
 PartitionCoreModule::updateHasRootMountPoint()
 {
     bool oldValue = m_hasRootMountPoint;
-    m_hasRootMountPoint = findPartitionByMountPoint( "/" );
+    m_hasRootMountPoint = std::any_of( m_deviceInfos.cbegin(),
+                                       m_deviceInfos.cend(),
+                                       []( const DeviceInfo* info ) { return info->hasRootMountPoint; } );
 
     if ( oldValue != m_hasRootMountPoint )
     {
@@ -727,13 +1016,8 @@ void
 PartitionCoreModule::updateIsDirty()
 {
     bool oldValue = m_isDirty;
-    m_isDirty = false;
-    for ( auto info : m_deviceInfos )
-        if ( info->isDirty() )
-        {
-            m_isDirty = true;
-            break;
-        }
+    m_isDirty = std::any_of(
+        m_deviceInfos.cbegin(), m_deviceInfos.cend(), []( const DeviceInfo* info ) { return info->dirty; } );
     if ( oldValue != m_isDirty )
     {
         isDirtyChanged( m_isDirty );
@@ -745,18 +1029,17 @@ PartitionCoreModule::scanForEfiSystemPartitions()
 {
     const bool wasEmpty = m_efiSystemPartitions.isEmpty();
 
-    m_efiSystemPartitions.clear();
-
-    QList< Device* > devices;
+    // Each device found its own when its state was last updated
+    QList< Partition* > efiSystemPartitions;
     for ( int row = 0; row < deviceModel()->rowCount(); ++row )
     {
-        Device* device = deviceModel()->deviceForIndex( deviceModel()->index( row ) );
-        devices.append( device );
+        const DeviceInfo* info = infoForDevice( deviceModel()->deviceForIndex( deviceModel()->index( row ) ) );
+        if ( info )
+        {
+            efiSystemPartitions << info->efiSystemPartitions;
+        }
     }
 
-    QList< Partition* > efiSystemPartitions
-        = CalamaresUtils::Partition::findPartitions( devices, PartUtils::isEfiBootable );
-
     if ( efiSystemPartitions.isEmpty() )
     {
         cWarning() << "system is EFI but no EFI system partitions found.";
@@ -872,6 +1155,19 @@ PartitionCoreModule::infoForDevice( const Device* device ) const
     return nullptr;
 }
 
+PartitionCoreModule::DeviceInfo*
+PartitionCoreModule::infoForDeviceNode( const QString& deviceNode ) const
+{
+    for ( auto* deviceInfo : m_deviceInfos )
+    {
+        if ( deviceInfo->device && deviceInfo->device->deviceNode() == deviceNode )
+        {
+            return deviceInfo;
+        }
+    }
+    return nullptr;
+}
+
 Partition*
 PartitionCoreModule::findPartitionByMountPoint( const QString& mountPoint ) const
 {
@@ -892,6 +1188,7 @@ PartitionCoreModule::setBootLoaderInstallPath( const QString& path )
 {
     cDebug() << "PCM::setBootLoaderInstallPath" << path;
     m_bootLoaderInstallPath = path;
+    invalidateJobs();
 }
 
 void
@@ -909,8 +1206,13 @@ PartitionCoreModule::layoutApply( Device* dev,
                                   const PartitionRole& role )
 {
     bool isEfi = PartUtils::isEfiSystem();
-    QList< Partition* > partList
-        = m_partLayout.createPartitions( dev, firstSector, lastSector, luksPassphrase, parent, role );
+    const qint64 alignment = PartUtils::partitionAlignment( dev->deviceNode(), dev->logicalSize() );
+    QList< Partition* > partList = m_partLayout.createPartitions(
+        dev, firstSector, lastSector, luksPassphrase, parent, role, alignment / dev->logicalSize() );
+    if ( auto* deviceInfo = infoForDevice( dev ) )
+    {
+        deviceInfo->alignment = alignment;
+    }
 
     // Partition::mountPoint() tells us where it is mounted **now**, while
     // PartitionInfo::mountPoint() says where it will be mounted in the target system.
@@ -1018,9 +1320,12 @@ PartitionCoreModule::revertDevice( Device* dev, bool individualRevert )
         return;
     }
     devInfo->forgetChanges();
+    invalidateJobs();
     CoreBackend* backend = CoreBackendManager::self()->backend();
     Device* newDev = backend->scanDevice( devInfo->device->deviceNode() );
+    m_deviceWatcher->ignoreScanned( devInfo->device->deviceNode() );
     devInfo->device.reset( newDev );
+    devInfo->updateState();
     devInfo->partitionModel->init( newDev, m_osproberLines );
 
     m_deviceModel->swapDevice( dev, newDev );
@@ -1044,6 +1349,114 @@ PartitionCoreModule::revertDevice( Device* dev, bool individualRevert )
 }
 
 
+void
+PartitionCoreModule::setWatchDevices( bool watch )
+{
+    m_deviceWatcher->setActive( watch );
+}
+
+
+void
+PartitionCoreModule::updateDevices( const QStringList& added, const QStringList& removed, const QStringList& changed )
+{
+    if ( !m_revertMutex.tryLock() )
+    {
+        // Init or a revert is running; try again when that is done.
+        QTimer::singleShot(
+            500, this, [this, added, removed, changed]() { updateDevices( added, removed, changed ); } );
+        return;
+    }
+    PartUtils::clearFilesystemProbes();
+    PartUtils::clearResizeChecks();
+
+    // The jobs of a new or changed volume group point into the disks of its PVs
+    const bool volumeGroupChanges
+        = std::any_of( m_deviceInfos.cbegin(),
+                       m_deviceInfos.cend(),
+                       []( const DeviceInfo* info )
+                       { return dynamic_cast< LvmDevice* >( info->device.data() ) && !info->jobs().isEmpty(); } );
+    for ( const QString& node : removed )
+    {
+        DeviceInfo* deviceInfo = infoForDeviceNode( node );
+        if ( !deviceInfo )
+        {
+            continue;
+        }
+        if ( deviceInfo->isDirty() || volumeGroupChanges )
+        {
+            // The jobs (and the pages) still use the Device*, so it stays;
+            // the jobs fail if the disk is still missing at install time.
+            cWarning() << "Device" << node << "was removed, but there are pending changes; it is kept.";
+            continue;
+        }
+        cDebug() << "Device" << node << "was removed.";
+        m_deviceModel->removeDevice( deviceInfo->device.data() );
+        m_deviceInfos.removeAll( deviceInfo );
+        delete deviceInfo;
+    }
+
+    QStringList toAdd = added;
+    QList< Device* > toRescan;
+    for ( const QString& node : changed )
+    {
+        DeviceInfo* deviceInfo = infoForDeviceNode( node );
+        if ( !deviceInfo )
+        {
+            // e.g. a card reader that now has a card in it
+            toAdd.append( node );
+        }
+        else if ( deviceInfo->isDirty() )
+        {
+            cWarning() << "Device" << node << "has changed, but also has pending changes; not rescanned.";
+        }
+        else
+        {
+            toRescan.append( deviceInfo->device.data() );
+        }
+    }
+
+    for ( const QString& node : qAsConst( toAdd ) )
+    {
+        if ( infoForDeviceNode( node ) )
+        {
+            continue;
+        }
+        Device* device = PartUtils::scanDevice( node, PartUtils::DeviceType::WritableOnly );
+        m_deviceWatcher->ignoreScanned( node );
+        if ( !device )
+        {
+            cDebug() << "Device" << node << "was added, but is not usable.";
+            continue;
+        }
+        cDebug() << "Device" << node << "was added.";
+        // Gives ownership of the Device* to the DeviceInfo object
+        auto* deviceInfo = new DeviceInfo( device );
+        m_deviceInfos << deviceInfo;
+        deviceInfo->partitionModel->init( device, m_osproberLines );
+        m_deviceModel->addDevice( device );
+    }
+
+    m_revertMutex.unlock();
+
+    for ( Device* device : qAsConst( toRescan ) )
+    {
+        cDebug() << "Device" << device->deviceNode() << "has changed.";
+        revertDevice( device, false );
+    }
+
+    QList< Device* > bootLoaderDevices;
+    for ( DeviceInfo* const info : qAsConst( m_deviceInfos ) )
+    {
+        if ( info && !info->device.isNull() && info->device->type() == Device::Type::Disk_Device )
+        {
+            bootLoaderDevices.append( info->device.data() );
+        }
+    }
+    m_bootLoaderModel->init( bootLoaderDevices );
+    refreshAfterModelChange();
+}
+
+
 void
 PartitionCoreModule::asyncRevertDevice( Device* dev, std::function< void() > callback )
 {
@@ -1053,7 +1466,8 @@ PartitionCoreModule::asyncRevertDevice( Device* dev, std::function< void() > cal
         watcher->deleteLater();
     } );
 
-    QFuture< void > future = QtConcurrent::run( this, &PartitionCoreModule::revertDevice, dev, true );
+    QFuture< void > future = Executor::run(
+        Executor::Lane::Interactive, "revert-device", [ this, dev ]() { revertDevice( dev, true ); } );
     watcher->setFuture( future );
 }
 
@@ -1065,6 +1479,7 @@ PartitionCoreModule::clearJobs()
     {
         deviceInfo->forgetChanges();
     }
+    invalidateJobs();
     updateIsDirty();
 }
 
@@ -1100,6 +1515,7 @@ PartitionCoreModule::createSummaryInfo() const
         SummaryInfo summaryInfo;
         summaryInfo.deviceName = deviceInfo->device->name();
         summaryInfo.deviceNode = deviceInfo->device->deviceNode();
+        summaryInfo.alignment = deviceInfo->alignment;
 
         Device* deviceBefore = deviceInfo->immutableDevice.data();
         summaryInfo.partitionModelBefore = new PartitionModel;
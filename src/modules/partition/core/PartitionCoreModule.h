@@ -13,6 +13,7 @@
 #define PARTITIONCOREMODULE_H
 
 #include "core/KPMHelpers.h"
+#include "core/PartUtils.h"
 #include "core/PartitionLayout.h"
 #include "core/PartitionModel.h"
 #include "jobs/PartitionJob.h"
@@ -29,6 +30,7 @@
 #include <QMutex>
 #include <QObject>
 
+#include <atomic>
 #include <functional>
 
 class BootLoaderModel;
@@ -36,6 +38,7 @@ class Config;
 class CreatePartitionJob;
 class Device;
 class DeviceModel;
+class DeviceWatcher;
 class FileSystem;
 class Partition;
 
@@ -56,12 +59,14 @@ public:
      * This helper class calls refresh() on the module
      * on destruction (nothing else). It is used as
      * part of the model-consistency objects, along with
-     * PartitionModel::ResetHelper.
+     * PartitionModel::UpdateHelper. If the change is to
+     * one @p device only, pass it so that only that
+     * device is looked at again.
      */
     class RefreshHelper
     {
     public:
-        RefreshHelper( PartitionCoreModule* module );
+        RefreshHelper( PartitionCoreModule* module, const Device* device = nullptr );
         ~RefreshHelper();
 
         RefreshHelper( const RefreshHelper& ) = delete;
@@ -69,6 +74,7 @@ public:
 
     private:
         PartitionCoreModule* m_module;
+        const Device* m_device;
     };
 
     /**
@@ -82,6 +88,7 @@ public:
         QString deviceNode;
         PartitionModel* partitionModelBefore;
         PartitionModel* partitionModelAfter;
+        qint64 alignment = 0;  ///< Of the partitions from the layout, in bytes; 0 if none
     };
 
     PartitionCoreModule( QObject* parent = nullptr );
@@ -116,6 +123,15 @@ public:
     //FIXME: make this horrible method private. -- Teo 12/2015
     Device* immutableDeviceCopy( const Device* device );
 
+    /** @brief What can be done with the partitions of @p device
+     *
+     * This is the PartUtils::analyzeDevice() of the immutableDeviceCopy(),
+     * done once when the device is scanned (in the background, at startup).
+     * Since that copy does not change, neither does the analysis; it
+     * is done again only if the storage requirement has changed since.
+     */
+    PartUtils::DeviceAnalysis deviceAnalysis( const Device* device );
+
     /**
      * @brief bootLoaderModel returns a model which represents the available boot
      * loader locations.
@@ -130,7 +146,9 @@ public:
      * @brief Add a job to do the actual partition-creation.
      *
      * If @p flags is not FlagNone, then the given flags are
-     * applied to the newly-created partition.
+     * applied to the newly-created partition. The new filesystem
+     * gets the features from the device-class profile of @p device
+     * (see setProfileConfig()).
      */
     void
     createPartition( Device* device, Partition* partition, PartitionTable::Flags flags = KPM_PARTITION_FLAG( None ) );
@@ -158,6 +176,13 @@ public:
     /// @brief Set the path where the bootloader will be installed
     void setBootLoaderInstallPath( const QString& path );
 
+    /** @brief Use the device-class profiles from @p config for new filesystems
+     *
+     * The filesystems of partitions that are created or formatted after
+     * this get the features that the profile for their disk lists.
+     */
+    void setProfileConfig( const Config* config ) { m_profileConfig = config; }
+
     /** @brief Initialize the default layout that will be applied
      *
      * See PartitionLayout::init()
@@ -176,9 +201,22 @@ public:
      * @brief jobs creates and returns a list of jobs which can then apply the changes
      * requested by the user.
      * @return a list of jobs.
+     *
+     * The list is created once, and then kept until the partitioning changes
+     * (or the language does), so the summary and exec get the same jobs.
      */
     Calamares::JobList jobs( const Config* ) const;
 
+    /// @brief The non-empty prettyDescription()s of jobs(), cached along with them
+    QStringList jobDescriptions( const Config* ) const;
+
+    /** @brief Drops the cached jobs() and their descriptions
+     *
+     * The changes made through this class do so already; call this
+     * after changing a PartitionInfo (e.g. a mount point) directly.
+     */
+    void invalidateJobs() { ++m_jobsRevision; }
+
     bool hasRootMountPoint() const;
 
     QList< Partition* > efiSystemPartitions() const;
@@ -211,6 +249,16 @@ public:
 
     void clearJobs();  // only clear jobs, the Device* states are preserved
 
+    /** @brief Follow disks being plugged in or removed
+     *
+     * While @p watch is true, disks that are added to the system are
+     * scanned and added to the device model, disks that are removed
+     * are dropped, and disks whose partitions change (outside of
+     * Calamares) are rescanned -- unless they have pending changes.
+     * Only the affected disk is scanned, not all of them.
+     */
+    void setWatchDevices( bool watch );
+
     bool isDirty();  // true if there are pending changes, otherwise false
 
     bool isVGdeactivated( LvmDevice* device );
@@ -240,7 +288,13 @@ Q_SIGNALS:
 
 private:
     struct DeviceInfo;
-    void refreshAfterModelChange();
+    /** @brief Updates the state that is derived from the devices
+     *
+     * With a @p changed device, only that device is looked at again;
+     * the state of the others is kept from their last refresh. Without
+     * one, all the devices are.
+     */
+    void refreshAfterModelChange( const Device* changed = nullptr );
 
     void doInit();
     void updateHasRootMountPoint();
@@ -248,7 +302,13 @@ private:
     void scanForEfiSystemPartitions();
     void scanForLVMPVs();
 
+    Calamares::JobList createJobs( const Config* ) const;
+
     DeviceInfo* infoForDevice( const Device* ) const;
+    DeviceInfo* infoForDeviceNode( const QString& deviceNode ) const;
+
+    /// @brief Handles DeviceWatcher::devicesChanged()
+    void updateDevices( const QStringList& added, const QStringList& removed, const QStringList& changed );
 
     CalamaresUtils::Partition::KPMManager m_kpmcore;
 
@@ -258,14 +318,36 @@ private:
 
     DeviceModel* m_deviceModel;
     BootLoaderModel* m_bootLoaderModel;
+    DeviceWatcher* m_deviceWatcher;
     bool m_hasRootMountPoint = false;
     bool m_isDirty = false;
     QString m_bootLoaderInstallPath;
     PartitionLayout m_partLayout;
+    const Config* m_profileConfig = nullptr;
 
     OsproberEntryList m_osproberLines;
+    /** @brief Results of the last os-prober scan, for re-use by revert()
+     *
+     * These are valid as long as the block devices still match
+     * m_osproberFingerprint (see PartUtils::blockDevicesFingerprint()).
+     */
+    OsproberEntryList m_osproberScan;
+    QString m_osproberFingerprint;
 
     QMutex m_revertMutex;
+
+    /// @brief The jobs() for a Config, as of revision m_jobsRevision
+    struct JobsCache
+    {
+        quint64 revision = 0;
+        const Config* config = nullptr;
+        Calamares::JobList jobs;
+        QStringList descriptions;
+        bool hasDescriptions = false;
+    };
+    /// Bumped for each change, also from the threads that revert devices; the empty cache is never current
+    std::atomic< quint64 > m_jobsRevision { 1 };
+    mutable JobsCache m_jobsCache;
 };
 
 #endif /* PARTITIONCOREMODULE_H */
@@ -27,6 +27,20 @@
 #include <kpmcore/core/partition.h>
 #include <kpmcore/fs/filesystem.h>
 
+/// @brief The first multiple of @p alignment that is at least @p sector
+static qint64
+alignUp( qint64 sector, qint64 alignment )
+{
+    return ( ( sector + alignment - 1 ) / alignment ) * alignment;
+}
+
+/// @brief The last multiple of @p alignment that is at most @p sector
+static qint64
+alignDown( qint64 sector, qint64 alignment )
+{
+    return ( sector / alignment ) * alignment;
+}
+
 PartitionLayout::PartitionLayout() {}
 
 PartitionLayout::PartitionLayout( const PartitionLayout& layout )
@@ -207,41 +221,62 @@ PartitionLayout::createPartitions( Device* dev,
                                    qint64 lastSector,
                                    QString luksPassphrase,
                                    PartitionNode* parent,
-                                   const PartitionRole& role )
+                                   const PartitionRole& role,
+                                   qint64 alignSectors )
 {
     // Make sure the default FS is sensible; warn and use ext4 if not
     setDefaultFsType( m_defaultFsType );
 
+    alignSectors = std::max( alignSectors, qint64( 1 ) );
+    firstSector = alignUp( firstSector, alignSectors );
+
     QList< Partition* > partList;
-    // Map each partition entry to its requested size (0 when calculated later)
-    QMap< const PartitionLayout::PartitionEntry*, qint64 > partSectorsMap;
     const qint64 totalSectors = lastSector - firstSector + 1;
     qint64 currentSector, availableSectors = totalSectors;
 
+    // The min- and max-sizes do not depend on what is available, so convert
+    // them once; percentages of the minimum and maximum are of the whole space.
+    const qint64 sectorSize = dev->logicalSize();
+    const int entryCount = m_partLayout.count();
+    QVector< qint64 > minSectors( entryCount, 0 );
+    QVector< qint64 > maxSectors( entryCount, 0 );
+    for ( int i = 0; i < entryCount; ++i )
+    {
+        const auto& entry = m_partLayout.at( i );
+        if ( entry.partMinSize.isValid() )
+        {
+            minSectors[ i ] = entry.partMinSize.toSectors( totalSectors, sectorSize );
+        }
+        if ( entry.partMaxSize.isValid() )
+        {
+            maxSectors[ i ] = entry.partMaxSize.toSectors( totalSectors, sectorSize );
+        }
+    }
+
+    // Each partition entry's requested size (0 when calculated later)
+    QVector< qint64 > partSectors( entryCount, 0 );
+
     // Let's check if we have enough space for each partitions, using the size
     // propery or the min-size property if unit is in percentage.
-    for ( const auto& entry : qAsConst( m_partLayout ) )
+    for ( int i = 0; i < entryCount; ++i )
     {
+        const auto& entry = m_partLayout.at( i );
         if ( !entry.partSize.isValid() )
         {
             cWarning() << "Partition" << entry.partMountPoint << "size is invalid, skipping...";
             continue;
         }
 
-        // Calculate partition size: Rely on "possibly uninitialized use"
-        // warnings to ensure that all the cases are covered below.
         // We need to ignore the percent-defined until later
-        qint64 sectors = 0;
         if ( entry.partSize.unit() != CalamaresUtils::Partition::SizeUnit::Percent )
         {
-            sectors = entry.partSize.toSectors( totalSectors, dev->logicalSize() );
+            partSectors[ i ] = entry.partSize.toSectors( totalSectors, sectorSize );
         }
         else if ( entry.partMinSize.isValid() )
         {
-            sectors = entry.partMinSize.toSectors( totalSectors, dev->logicalSize() );
+            partSectors[ i ] = minSectors.at( i );
         }
-        partSectorsMap.insert( &entry, sectors );
-        availableSectors -= sectors;
+        availableSectors -= partSectors.at( i );
     }
 
     // There is not enough space for all partitions, use the min-size property
@@ -249,34 +284,32 @@ PartitionLayout::createPartitions( Device* dev,
     if ( availableSectors < 0 )
     {
         availableSectors = totalSectors;
-        for ( const auto& entry : qAsConst( m_partLayout ) )
+        for ( int i = 0; i < entryCount; ++i )
         {
-            qint64 sectors = partSectorsMap.value( &entry );
-            if ( entry.partMinSize.isValid() )
+            if ( m_partLayout.at( i ).partMinSize.isValid() )
             {
-                sectors = entry.partMinSize.toSectors( totalSectors, dev->logicalSize() );
-                partSectorsMap.insert( &entry, sectors );
+                partSectors[ i ] = minSectors.at( i );
             }
-            availableSectors -= sectors;
+            availableSectors -= partSectors.at( i );
         }
     }
 
     // Assign sectors for percentage-defined partitions.
-    for ( const auto& entry : qAsConst( m_partLayout ) )
+    for ( int i = 0; i < entryCount; ++i )
     {
+        const auto& entry = m_partLayout.at( i );
         if ( entry.partSize.unit() == CalamaresUtils::Partition::SizeUnit::Percent )
         {
-            qint64 sectors
-                = entry.partSize.toSectors( availableSectors + partSectorsMap.value( &entry ), dev->logicalSize() );
+            qint64 sectors = entry.partSize.toSectors( availableSectors + partSectors.at( i ), sectorSize );
             if ( entry.partMinSize.isValid() )
             {
-                sectors = std::max( sectors, entry.partMinSize.toSectors( totalSectors, dev->logicalSize() ) );
+                sectors = std::max( sectors, minSectors.at( i ) );
             }
             if ( entry.partMaxSize.isValid() )
             {
-                sectors = std::min( sectors, entry.partMaxSize.toSectors( totalSectors, dev->logicalSize() ) );
+                sectors = std::min( sectors, maxSectors.at( i ) );
             }
-            partSectorsMap.insert( &entry, sectors );
+            partSectors[ i ] = sectors;
         }
     }
 
@@ -285,15 +318,38 @@ PartitionLayout::createPartitions( Device* dev,
     // Create the partitions.
     currentSector = firstSector;
     availableSectors = totalSectors;
-    for ( const auto& entry : qAsConst( m_partLayout ) )
+    for ( int i = 0; i < entryCount; ++i )
     {
+        const auto& entry = m_partLayout.at( i );
         // Adjust partition size based on available space.
-        qint64 sectors = partSectorsMap.value( &entry );
-        sectors = std::min( sectors, availableSectors );
+        qint64 sectors = std::min( partSectors.at( i ), availableSectors );
         if ( sectors == 0 )
         {
             continue;
         }
+        // End where the next partition can start; what is left after
+        // the rounding of earlier partitions goes to a partition that
+        // (nearly) takes the rest.
+        if ( availableSectors - sectors < alignSectors )
+        {
+            sectors = availableSectors;
+        }
+        else
+        {
+            // Round up, so that a partition is never smaller than asked;
+            // only the max-size can make it round down, but not below
+            // the min-size.
+            const qint64 alignedUp = alignUp( currentSector + sectors, alignSectors ) - currentSector;
+            const qint64 alignedDown = alignDown( currentSector + sectors, alignSectors ) - currentSector;
+            if ( !entry.partMaxSize.isValid() || alignedUp <= maxSectors.at( i ) )
+            {
+                sectors = alignedUp;
+            }
+            else if ( alignedDown > 0 && alignedDown >= minSectors.at( i ) )
+            {
+                sectors = alignedDown;
+            }
+        }
 
         Partition* part = nullptr;
         if ( luksPassphrase.isEmpty() )
@@ -111,6 +111,13 @@ public:
 
     /**
      * @brief Apply the current partition layout to the selected drive space.
+     *
+     * With an @p alignSectors larger than 1, the first partition starts on
+     * a multiple of that many sectors, and the sizes are rounded up
+     * so that each following partition does as well (down instead, if
+     * rounding up would exceed the max-size). A partition that would
+     * leave less than @p alignSectors unused takes the rest.
+     *
      * @return  A list of Partition objects.
      */
     QList< Partition* > createPartitions( Device* dev,
@@ -118,7 +125,8 @@ public:
                                           qint64 lastSector,
                                           QString luksPassphrase,
                                           PartitionNode* parent,
-                                          const PartitionRole& role );
+                                          const PartitionRole& role,
+                                          qint64 alignSectors = 1 );
 
 private:
     QList< PartitionEntry > m_partLayout;
@@ -29,25 +29,31 @@
 
 // Qt
 #include <QColor>
+#include <QSet>
 
 using CalamaresUtils::Partition::isPartitionFreeSpace;
 using CalamaresUtils::Partition::isPartitionNew;
 
-//- ResetHelper --------------------------------------------
-PartitionModel::ResetHelper::ResetHelper( PartitionModel* model )
+//- UpdateHelper -------------------------------------------
+PartitionModel::UpdateHelper::UpdateHelper( PartitionModel* model )
     : m_model( model )
 {
-    m_model->m_lock.lock();
-    m_model->beginResetModel();
+    if ( m_model->m_updateDepth++ == 0 )
+    {
+        m_model->m_lock.lock();
+    }
 }
 
-PartitionModel::ResetHelper::~ResetHelper()
+PartitionModel::UpdateHelper::~UpdateHelper()
 {
-    // We need to unlock the mutex before emitting the reset signal,
-    // because the reset will cause clients to start looking at the
-    // (new) data.
-    m_model->m_lock.unlock();
-    m_model->endResetModel();
+    if ( --m_model->m_updateDepth == 0 )
+    {
+        // We need to unlock the mutex before emitting the signals,
+        // because they will cause clients to start looking at the
+        // (new) data.
+        m_model->m_lock.unlock();
+        m_model->updateRows();
+    }
 }
 
 //- PartitionModel -----------------------------------------
@@ -64,9 +70,184 @@ PartitionModel::init( Device* device, const OsproberEntryList& osproberEntries )
     beginResetModel();
     m_device = device;
     m_osproberEntries = osproberEntries;
+    m_rows = makeRows( device ? device->partitionTable() : nullptr );
     endResetModel();
 }
 
+/** @brief What data() depends on, for @p partition
+ *
+ * When this changes, the row for the partition changes.
+ */
+static QVariantList
+signature( Partition* partition )
+{
+    const FileSystem& fs = partition->fileSystem();
+    return { partition->firstSector(),
+             partition->lastSector(),
+             int( partition->state() ),
+             partition->partitionPath(),
+             int( fs.type() ),
+             fs.label(),
+             fs.uuid(),
+             PartitionInfo::mountPoint( partition ),
+             PartitionInfo::format( partition ),
+             int( PartitionInfo::flags( partition ) ) };
+}
+
+QVector< PartitionModel::Row >
+PartitionModel::makeRows( PartitionNode* node )
+{
+    QVector< Row > rows;
+    if ( node )
+    {
+        for ( Partition* partition : node->children() )
+        {
+            rows.append( { partition, signature( partition ), makeRows( partition ) } );
+        }
+    }
+    return rows;
+}
+
+const PartitionModel::Row*
+PartitionModel::findRow( const QVector< Row >& rows, int row, const void* partition )
+{
+    if ( row < rows.count() && rows[ row ].partition == partition )
+    {
+        return &rows[ row ];
+    }
+    for ( const auto& r : rows )
+    {
+        if ( const auto* child = findRow( r.children, row, partition ) )
+        {
+            return child;
+        }
+    }
+    return nullptr;
+}
+
+const PartitionModel::Row*
+PartitionModel::rowFor( const QModelIndex& index ) const
+{
+    return index.isValid() ? findRow( m_rows, index.row(), index.internalPointer() ) : nullptr;
+}
+
+void
+PartitionModel::updateRows()
+{
+    const QVector< Row > newRows = makeRows( m_device ? m_device->partitionTable() : nullptr );
+    if ( updateRows( QModelIndex(), m_rows, newRows ) )
+    {
+        // The colors of new partitions depend on how many come before them
+        emitColorsChanged( QModelIndex(), m_rows );
+    }
+}
+
+bool
+PartitionModel::updateRows( const QModelIndex& parent, QVector< Row >& rows, const QVector< Row >& newRows )
+{
+    bool changed = false;
+
+    QSet< const Partition* > newPartitions;
+    for ( const auto& r : newRows )
+    {
+        newPartitions.insert( r.partition );
+    }
+
+    // Removed partitions, in runs, from the back so that rows stay put
+    for ( int last = rows.count() - 1; last >= 0; --last )
+    {
+        if ( newPartitions.contains( rows[ last ].partition ) )
+        {
+            continue;
+        }
+        int first = last;
+        while ( first > 0 && !newPartitions.contains( rows[ first - 1 ].partition ) )
+        {
+            --first;
+        }
+        beginRemoveRows( parent, first, last );
+        rows.erase( rows.begin() + first, rows.begin() + last + 1 );
+        endRemoveRows();
+        changed = true;
+        last = first;
+    }
+
+    // What is left must be in the same order; partitions do not
+    // swap places, but if they do, start over.
+    {
+        int j = 0;
+        for ( const auto& r : rows )
+        {
+            while ( j < newRows.count() && newRows[ j ].partition != r.partition )
+            {
+                ++j;
+            }
+            if ( j >= newRows.count() )
+            {
+                cWarning() << "Partitions have been re-ordered, resetting the partition model.";
+                beginResetModel();
+                m_rows = makeRows( m_device ? m_device->partitionTable() : nullptr );
+                endResetModel();
+                return false;
+            }
+        }
+    }
+
+    // New partitions, in runs, with their children (if any)
+    for ( int i = 0, j = 0; j < newRows.count(); )
+    {
+        if ( i < rows.count() && rows[ i ].partition == newRows[ j ].partition )
+        {
+            ++i;
+            ++j;
+            continue;
+        }
+        const int first = j;
+        while ( j < newRows.count() && !( i < rows.count() && rows[ i ].partition == newRows[ j ].partition ) )
+        {
+            ++j;
+        }
+        beginInsertRows( parent, i, i + j - first - 1 );
+        for ( int k = first; k < j; ++k )
+        {
+            rows.insert( i++, newRows[ k ] );
+        }
+        endInsertRows();
+        changed = true;
+    }
+
+    // Now the same partitions are in the same rows
+    Q_ASSERT( rows.count() == newRows.count() );
+    for ( int row = 0; row < rows.count(); ++row )
+    {
+        if ( rows[ row ].signature != newRows[ row ].signature )
+        {
+            rows[ row ].signature = newRows[ row ].signature;
+            Q_EMIT dataChanged( index( row, 0, parent ), index( row, ColumnCount - 1, parent ) );
+        }
+        if ( !rows[ row ].children.isEmpty() || !newRows[ row ].children.isEmpty() )
+        {
+            changed |= updateRows( index( row, 0, parent ), rows[ row ].children, newRows[ row ].children );
+        }
+    }
+    return changed;
+}
+
+void
+PartitionModel::emitColorsChanged( const QModelIndex& parent, const QVector< Row >& rows )
+{
+    if ( rows.isEmpty() )
+    {
+        return;
+    }
+    Q_EMIT dataChanged(
+        index( 0, NameColumn, parent ), index( rows.count() - 1, NameColumn, parent ), { Qt::DecorationRole } );
+    for ( int row = 0; row < rows.count(); ++row )
+    {
+        emitColorsChanged( index( row, 0, parent ), rows[ row ].children );
+    }
+}
+
 int
 PartitionModel::columnCount( const QModelIndex& ) const
 {
@@ -76,26 +257,28 @@ PartitionModel::columnCount( const QModelIndex& ) const
 int
 PartitionModel::rowCount( const QModelIndex& parent ) const
 {
-    Partition* parentPartition = partitionForIndex( parent );
-    if ( parentPartition )
+    if ( !parent.isValid() )
+    {
+        return m_rows.count();
+    }
+    if ( parent.column() != 0 )
     {
-        return parentPartition->children().count();
+        return 0;
     }
-    PartitionTable* table = m_device->partitionTable();
-    return table ? table->children().count() : 0;
+    const Row* parentRow = rowFor( parent );
+    return parentRow ? parentRow->children.count() : 0;
 }
 
 QModelIndex
 PartitionModel::index( int row, int column, const QModelIndex& parent ) const
 {
-    PartitionNode* parentPartition = parent.isValid() ? static_cast< PartitionNode* >( partitionForIndex( parent ) )
-                                                      : static_cast< PartitionNode* >( m_device->partitionTable() );
-    if ( !parentPartition )
+    const Row* parentRow = parent.isValid() ? rowFor( parent ) : nullptr;
+    if ( parent.isValid() && !parentRow )
     {
         return QModelIndex();
     }
-    auto lst = parentPartition->children();
-    if ( row < 0 || row >= lst.count() )
+    const QVector< Row >& rows = parentRow ? parentRow->children : m_rows;
+    if ( row < 0 || row >= rows.count() )
     {
         return QModelIndex();
     }
@@ -103,8 +286,7 @@ PartitionModel::index( int row, int column, const QModelIndex& parent ) const
     {
         return QModelIndex();
     }
-    Partition* partition = parentPartition->children().at( row );
-    return createIndex( row, column, partition );
+    return createIndex( row, column, rows[ row ].partition );
 }
 
 QModelIndex
@@ -114,25 +296,20 @@ PartitionModel::parent( const QModelIndex& child ) const
     {
         return QModelIndex();
     }
-    Partition* partition = partitionForIndex( child );
-    if ( !partition )
-    {
-        return QModelIndex();
-    }
-    PartitionNode* parentNode = partition->parent();
-    if ( parentNode == m_device->partitionTable() )
+    const void* partition = child.internalPointer();
+    if ( child.row() < m_rows.count() && m_rows[ child.row() ].partition == partition )
     {
         return QModelIndex();
     }
 
-    int row = 0;
-    for ( auto p : m_device->partitionTable()->children() )
+    // Only extended partitions have children, and they are top-level
+    for ( int row = 0; row < m_rows.count(); ++row )
     {
-        if ( parentNode == p )
+        const auto& children = m_rows[ row ].children;
+        if ( child.row() < children.count() && children[ child.row() ].partition == partition )
         {
-            return createIndex( row, 0, parentNode );
+            return createIndex( row, 0, m_rows[ row ].partition );
         }
-        ++row;
     }
     cWarning() << "No parent found!";
     return QModelIndex();
@@ -327,5 +504,6 @@ PartitionModel::partitionForIndex( const QModelIndex& index ) const
 void
 PartitionModel::update()
 {
+    updateRows();
     Q_EMIT dataChanged( index( 0, 0 ), index( rowCount() - 1, columnCount() - 1 ) );
 }
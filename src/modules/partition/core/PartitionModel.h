@@ -15,6 +15,8 @@
 // Qt
 #include <QAbstractItemModel>
 #include <QMutex>
+#include <QVariantList>
+#include <QVector>
 
 class Device;
 class Partition;
@@ -28,9 +30,9 @@ class PartitionNode;
  * Note on updating:
  *
  * The Device class does not notify the outside world of changes on the
- * Partition objects it owns. Since a Qt model must notify its views *before*
- * and *after* making changes, it is important to make use of
- * the PartitionModel::ResetHelper class to wrap changes.
+ * Partition objects it owns. The model keeps its own copy of the partition
+ * tree, which is what the views see, and compares it with the device
+ * after a change. Use the PartitionModel::UpdateHelper class to wrap changes.
  *
  * This is what PartitionCoreModule does when it create jobs.
  */
@@ -40,18 +42,21 @@ class PartitionModel : public QAbstractItemModel
 public:
     /**
      * This helper class must be instantiated on the stack *before* making
-     * changes to the device represented by this model. It will cause the model
-     * to Q_EMIT modelAboutToBeReset() when instantiated and modelReset() when
-     * destructed.
+     * changes to the device represented by this model. When it is destroyed,
+     * the model compares the device with what it was before, and tells
+     * the views which rows were removed, inserted or changed, so that
+     * they keep their selection and expansion state and only redo the rows
+     * that changed. Helpers may be nested (then the outermost one does
+     * the comparison).
      */
-    class ResetHelper
+    class UpdateHelper
     {
     public:
-        ResetHelper( PartitionModel* model );
-        ~ResetHelper();
+        UpdateHelper( PartitionModel* model );
+        ~UpdateHelper();
 
-        ResetHelper( const ResetHelper& ) = delete;
-        ResetHelper& operator=( const ResetHelper& ) = delete;
+        UpdateHelper( const UpdateHelper& ) = delete;
+        UpdateHelper& operator=( const UpdateHelper& ) = delete;
 
     private:
         PartitionModel* m_model;
@@ -103,13 +108,37 @@ public:
 
     Device* device() const { return m_device; }
 
+    /** @brief Tells the views that (something in) all rows changed
+     *
+     * Changed, inserted and removed partitions are found as for
+     * UpdateHelper; then the whole model is reported as changed,
+     * for changes that are not in the partitions themselves.
+     */
     void update();
 
 private:
-    friend class ResetHelper;
+    friend class UpdateHelper;
+
+    /// @brief A partition as the views last saw it
+    struct Row
+    {
+        Partition* partition;
+        QVariantList signature;  ///< Everything that data() depends on
+        QVector< Row > children;
+    };
+
+    static QVector< Row > makeRows( PartitionNode* node );
+    static const Row* findRow( const QVector< Row >& rows, int row, const void* partition );
+    const Row* rowFor( const QModelIndex& index ) const;
+    /// @brief Update m_rows from the device, emitting signals for each difference
+    void updateRows();
+    bool updateRows( const QModelIndex& parent, QVector< Row >& rows, const QVector< Row >& newRows );
+    void emitColorsChanged( const QModelIndex& parent, const QVector< Row >& rows );
 
     Device* m_device;
     OsproberEntryList m_osproberEntries;
+    QVector< Row > m_rows;
+    int m_updateDepth = 0;
     mutable QMutex m_lock;
 };
 
@@ -36,6 +36,7 @@
 #include "partition/PartitionIterator.h"
 #include "partition/PartitionQuery.h"
 #include "utils/CalamaresUtilsGui.h"
+#include "utils/Executor.h"
 #include "utils/Logger.h"
 #include "utils/Retranslator.h"
 #include "utils/Units.h"
@@ -54,9 +55,9 @@
 #include <QFutureWatcher>
 #include <QLabel>
 #include <QListView>
-#include <QtConcurrent/QtConcurrent>
 
 using Calamares::PrettyRadioButton;
+using CalamaresUtils::Executor::Lane;
 using CalamaresUtils::Partition::findPartitionByPath;
 using CalamaresUtils::Partition::isPartitionFreeSpace;
 using CalamaresUtils::Partition::PartitionIterator;
@@ -206,7 +207,8 @@ createCombo( const QSet< SwapChoice >& s, SwapChoice dflt )
                            SwapChoice::SmallSwap,
                            SwapChoice::FullSwap,
                            SwapChoice::ReuseSwap,
-                           SwapChoice::SwapFile } )
+                           SwapChoice::SwapFile,
+                           SwapChoice::ZRamSwap } )
         if ( s.contains( c ) )
         {
             box->addItem( QString(), c );
@@ -403,7 +405,7 @@ ChoicePage::applyDeviceChoice()
     if ( m_core->isDirty() )
     {
         ScanningDialog::run(
-            QtConcurrent::run( [=] {
+            CalamaresUtils::Executor::run( Lane::Interactive, "revert-all-devices", [=] {
                 QMutexLocker locker( &m_coreMutex );
                 m_core->revertAllDevices();
             } ),
@@ -484,8 +486,10 @@ ChoicePage::applyActionChoice( InstallChoice choice )
     case InstallChoice::Erase:
     {
         auto gs = Calamares::JobQueue::instance()->globalStorage();
+        const QString deviceClass
+            = selectedDevice() ? PartUtils::deviceClass( selectedDevice()->deviceNode() ) : QString();
         PartitionActions::Choices::AutoPartitionOptions options { gs->value( "defaultPartitionTableType" ).toString(),
-                                                                  m_config->eraseFsType(),
+                                                                  m_config->eraseFsType( deviceClass ),
                                                                   m_encryptWidget->passphrase(),
                                                                   gs->value( "efiSystemPartition" ).toString(),
                                                                   CalamaresUtils::GiBtoBytes(
@@ -495,7 +499,7 @@ ChoicePage::applyActionChoice( InstallChoice choice )
         if ( m_core->isDirty() )
         {
             ScanningDialog::run(
-                QtConcurrent::run( [=] {
+                CalamaresUtils::Executor::run( Lane::Interactive, "revert-device", [=] {
                     QMutexLocker locker( &m_coreMutex );
                     m_core->revertDevice( selectedDevice() );
                 } ),
@@ -516,7 +520,7 @@ ChoicePage::applyActionChoice( InstallChoice choice )
         if ( m_core->isDirty() )
         {
             ScanningDialog::run(
-                QtConcurrent::run( [=] {
+                CalamaresUtils::Executor::run( Lane::Interactive, "revert-device", [=] {
                     QMutexLocker locker( &m_coreMutex );
                     m_core->revertDevice( selectedDevice() );
                 } ),
@@ -534,7 +538,7 @@ ChoicePage::applyActionChoice( InstallChoice choice )
         if ( m_core->isDirty() )
         {
             ScanningDialog::run(
-                QtConcurrent::run( [=] {
+                CalamaresUtils::Executor::run( Lane::Interactive, "revert-device", [=] {
                     QMutexLocker locker( &m_coreMutex );
                     m_core->revertDevice( selectedDevice() );
                 } ),
@@ -772,9 +776,12 @@ ChoicePage::doReplaceSelectedPartition( const QModelIndex& current )
     // This will be deleted by the second lambda, below.
     QString* homePartitionPath = new QString();
 
+    const bool doReuseHomePartition = m_reuseHomeCheckBox->isChecked();
     ScanningDialog::run(
-        QtConcurrent::run(
-            [this, current, homePartitionPath]( bool doReuseHomePartition ) {
+        CalamaresUtils::Executor::run(
+            Lane::Interactive,
+            "replace-partition",
+            [this, current, homePartitionPath, doReuseHomePartition]() {
                 QMutexLocker locker( &m_coreMutex );
 
                 if ( m_core->isDirty() )
@@ -853,8 +860,7 @@ ChoicePage::doReplaceSelectedPartition( const QModelIndex& current )
                         }
                     }
                 }
-            },
-            m_reuseHomeCheckBox->isChecked() ),
+            } ),
         [this, homePartitionPath] {
             m_reuseHomeCheckBox->setVisible( !homePartitionPath->isEmpty() );
             if ( !homePartitionPath->isEmpty() )
@@ -1022,10 +1028,10 @@ ChoicePage::updateActionChoicePreview( InstallChoice choice )
         m_previewAfterFrame->show();
         m_previewAfterLabel->show();
 
-        SelectionFilter filter = []( const QModelIndex& index ) {
-            return PartUtils::canBeResized(
-                static_cast< Partition* >( index.data( PartitionModel::PartitionPtrRole ).value< void* >() ),
-                Logger::Once() );
+        // The "before" views show the immutable copy, which is what was analyzed
+        SelectionFilter filter = [analysis = m_core->deviceAnalysis( currentDevice )]( const QModelIndex& index ) {
+            return analysis.canBeResized(
+                static_cast< Partition* >( index.data( PartitionModel::PartitionPtrRole ).value< void* >() ) );
         };
         m_beforePartitionBarsView->setSelectionFilter( filter );
         m_beforePartitionLabelsView->setSelectionFilter( filter );
@@ -1112,10 +1118,9 @@ ChoicePage::updateActionChoicePreview( InstallChoice choice )
         }
         else
         {
-            SelectionFilter filter = []( const QModelIndex& index ) {
-                return PartUtils::canBeReplaced(
-                    static_cast< Partition* >( index.data( PartitionModel::PartitionPtrRole ).value< void* >() ),
-                    Logger::Once() );
+            SelectionFilter filter = [analysis = m_core->deviceAnalysis( currentDevice )]( const QModelIndex& index ) {
+                return analysis.canBeReplaced(
+                    static_cast< Partition* >( index.data( PartitionModel::PartitionPtrRole ).value< void* >() ) );
             };
             m_beforePartitionBarsView->setSelectionFilter( filter );
             m_beforePartitionLabelsView->setSelectionFilter( filter );
@@ -1309,22 +1314,13 @@ ChoicePage::setupActions()
             || m_requiredPartitionTableType.contains( PartitionTable::tableTypeToName( tableType ) );
     }
 
-    for ( auto it = PartitionIterator::begin( currentDevice ); it != PartitionIterator::end( currentDevice ); ++it )
     {
-        if ( PartUtils::canBeResized( *it, o ) )
-        {
-            cDebug() << Logger::SubEntry << "contains resizable" << it;
-            atLeastOneCanBeResized = true;
-        }
-        if ( PartUtils::canBeReplaced( *it, o ) )
-        {
-            cDebug() << Logger::SubEntry << "contains replaceable" << it;
-            atLeastOneCanBeReplaced = true;
-        }
-        if ( ( *it )->isMounted() )
-        {
-            atLeastOneIsMounted = true;
-        }
+        // Worked out when the device was scanned; the device is not changed
+        // here (it is reverted when another one is picked).
+        const auto analysis = m_core->deviceAnalysis( currentDevice );
+        atLeastOneCanBeResized = !analysis.resizable.isEmpty();
+        atLeastOneCanBeReplaced = !analysis.replaceable.isEmpty();
+        atLeastOneIsMounted = analysis.anyMounted;
     }
 
     if ( osproberEntriesForCurrentDevice.count() == 0 )
@@ -1657,6 +1653,9 @@ ChoicePage::updateSwapChoicesTr()
         case SwapChoice::SwapFile:
             m_eraseSwapChoiceComboBox->setItemText( index, tr( "Swap to file" ) );
             break;
+        case SwapChoice::ZRamSwap:
+            m_eraseSwapChoiceComboBox->setItemText( index, tr( "Swap to compressed RAM (zram)" ) );
+            break;
         default:
             cWarning() << "Box item" << index << m_eraseSwapChoiceComboBox->itemText( index ) << "has role" << value;
         }
@@ -68,7 +68,7 @@ void
 PartitionBarsView::setNestedPartitionsMode( PartitionBarsView::NestedPartitionsMode mode )
 {
     m_nestedPartitionsMode = mode;
-    viewport()->repaint();
+    invalidateSections();
 }
 
 
@@ -89,27 +89,71 @@ PartitionBarsView::sizeHint() const
 void
 PartitionBarsView::paintEvent( QPaintEvent* event )
 {
-    QPainter painter( viewport() );
-    painter.fillRect( rect(), palette().window() );
-    painter.setRenderHint( QPainter::Antialiasing );
+    Q_UNUSED( event )
 
     QRect partitionsRect = rect();
     partitionsRect.setHeight( VIEW_HEIGHT );
+    const auto& allSections = sections( partitionsRect );
+
+    const qreal dpr = devicePixelRatioF();
+    const QSize backgroundSize = viewport()->size() * dpr;
+    if ( m_background.isNull() || m_background.size() != backgroundSize )
+    {
+        m_background = QPixmap( backgroundSize );
+        m_background.setDevicePixelRatio( dpr );
+
+        QPainter painter( &m_background );
+        painter.fillRect( rect(), palette().window() );
+        painter.setRenderHint( QPainter::Antialiasing );
+        for ( const auto& section : allSections )
+        {
+            painter.save();
+            drawSection( &painter, section, false );
+            painter.restore();
+        }
+    }
+
+    QPainter painter( viewport() );
+    painter.drawPixmap( 0, 0, m_background );
 
-    painter.save();
-    drawPartitions( &painter, partitionsRect, QModelIndex() );
-    painter.restore();
+    // The hovered section is drawn again, highlighted, over the background;
+    // that hides its nested sections, so those are drawn again too.
+    if ( selectionMode() == QAbstractItemView::NoSelection  // no hover without selection
+         || !m_hoveredIndex.isValid() || !canBeSelected( m_hoveredIndex ) )
+    {
+        return;
+    }
+    painter.setRenderHint( QPainter::Antialiasing );
+    for ( int i = 0; i < allSections.count(); ++i )
+    {
+        if ( allSections[ i ].index != m_hoveredIndex )
+        {
+            continue;
+        }
+        const int depth = allSections[ i ].depth;
+        painter.save();
+        drawSection( &painter, allSections[ i ], true );
+        painter.restore();
+        for ( ++i; i < allSections.count() && allSections[ i ].depth > depth; ++i )
+        {
+            painter.save();
+            drawSection( &painter, allSections[ i ], false );
+            painter.restore();
+        }
+        break;
+    }
 }
 
 
 void
-PartitionBarsView::drawSection( QPainter* painter, const QRect& rect_, int x, int width, const QModelIndex& index )
+PartitionBarsView::drawSection( QPainter* painter, const Section& section, bool hovered )
 {
-    QColor color
-        = index.isValid() ? index.data( Qt::DecorationRole ).value< QColor >() : ColorUtils::unknownDisklabelColor();
-    bool isFreeSpace = index.isValid() ? index.data( PartitionModel::IsFreeSpaceRole ).toBool() : true;
+    const QColor color = section.color;
+    const bool isFreeSpace = section.isFreeSpace;
+    const int x = section.x;
+    const int width = section.width;
 
-    QRect rect = rect_;
+    QRect rect = section.rect;
     const int y = rect.y();
     const int height = rect.height();
     const int radius = qMax( 1, CORNER_RADIUS - ( VIEW_HEIGHT - height ) / 2 );
@@ -118,23 +162,7 @@ PartitionBarsView::drawSection( QPainter* painter, const QRect& rect_, int x, in
 
     rect.adjust( 0, 0, -1, -1 );
 
-
-    if ( selectionMode() != QAbstractItemView::NoSelection &&  // no hover without selection
-         m_hoveredIndex.isValid() && index == m_hoveredIndex )
-    {
-        if ( canBeSelected( index ) )
-        {
-            painter->setBrush( color.lighter( 115 ) );
-        }
-        else
-        {
-            painter->setBrush( color );
-        }
-    }
-    else
-    {
-        painter->setBrush( color );
-    }
+    painter->setBrush( hovered ? color.lighter( 115 ) : color );
 
     QColor borderColor = color.darker();
 
@@ -159,8 +187,8 @@ PartitionBarsView::drawSection( QPainter* painter, const QRect& rect_, int x, in
     painter->setBrush( gradient );
     painter->drawRoundedRect( rect, radius, radius );
 
-    if ( selectionMode() != QAbstractItemView::NoSelection && index.isValid() && selectionModel()
-         && !selectionModel()->selectedIndexes().isEmpty() && selectionModel()->selectedIndexes().first() == index )
+    if ( selectionMode() != QAbstractItemView::NoSelection && section.index.isValid()
+         && section.index == selectedIndex() )
     {
         painter->setPen( QPen( borderColor, 1 ) );
         QColor highlightColor = QPalette().highlight().color();
@@ -191,8 +219,35 @@ PartitionBarsView::drawSection( QPainter* painter, const QRect& rect_, int x, in
 }
 
 
+QModelIndex
+PartitionBarsView::selectedIndex() const
+{
+    if ( !selectionModel() )
+    {
+        return QModelIndex();
+    }
+    const auto selected = selectionModel()->selectedIndexes();
+    return selected.isEmpty() ? QModelIndex() : selected.first();
+}
+
+
+const QVector< PartitionBarsView::Section >&
+PartitionBarsView::sections( const QRect& rect )
+{
+    if ( !m_sectionsValid || rect != m_sectionsRect )
+    {
+        m_sections.clear();
+        m_sectionsRect = rect;
+        m_sectionsValid = true;
+        m_background = QPixmap();
+        layoutSections( rect, QModelIndex(), 0 );
+    }
+    return m_sections;
+}
+
+
 void
-PartitionBarsView::drawPartitions( QPainter* painter, const QRect& rect, const QModelIndex& parent )
+PartitionBarsView::layoutSections( const QRect& rect, const QModelIndex& parent, int depth )
 {
     PartitionModel* modl = qobject_cast< PartitionModel* >( model() );
     if ( !modl )
@@ -219,7 +274,13 @@ PartitionBarsView::drawPartitions( QPainter* painter, const QRect& rect, const Q
             width = rect.right() - x + 1;
         }
 
-        drawSection( painter, rect, x, width, item.index );
+        m_sections.append( { item.index,
+                             rect,
+                             x,
+                             width,
+                             depth,
+                             item.index.data( Qt::DecorationRole ).value< QColor >(),
+                             item.index.data( PartitionModel::IsFreeSpaceRole ).toBool() } );
 
         if ( m_nestedPartitionsMode == DrawNestedPartitions && modl->hasChildren( item.index ) )
         {
@@ -227,7 +288,7 @@ PartitionBarsView::drawPartitions( QPainter* painter, const QRect& rect, const Q
                            rect.y() + EXTENDED_PARTITION_MARGIN,
                            width - 2 * EXTENDED_PARTITION_MARGIN,
                            rect.height() - 2 * EXTENDED_PARTITION_MARGIN );
-            drawPartitions( painter, subRect, item.index );
+            layoutSections( subRect, item.index, depth + 1 );
         }
         x += width;
     }
@@ -235,7 +296,34 @@ PartitionBarsView::drawPartitions( QPainter* painter, const QRect& rect, const Q
     if ( !items.count() && !modl->device()->partitionTable() )  // No disklabel or unknown
     {
         int width = rect.right() - rect.x() + 1;
-        drawSection( painter, rect, rect.x(), width, QModelIndex() );
+        m_sections.append(
+            { QModelIndex(), rect, rect.x(), width, depth, ColorUtils::unknownDisklabelColor(), true } );
+    }
+}
+
+
+void
+PartitionBarsView::invalidateSections()
+{
+    m_sectionsValid = false;
+    invalidateBackground();
+}
+
+
+void
+PartitionBarsView::invalidateBackground()
+{
+    m_background = QPixmap();
+    viewport()->update();
+}
+
+
+void
+PartitionBarsView::updateHovered( const QModelIndex& index )
+{
+    if ( index.isValid() )
+    {
+        viewport()->update( visualRect( index ) );
     }
 }
 
@@ -399,7 +487,7 @@ void
 PartitionBarsView::setSelectionModel( QItemSelectionModel* selectionModel )
 {
     QAbstractItemView::setSelectionModel( selectionModel );
-    connect( selectionModel, &QItemSelectionModel::selectionChanged, this, [=] { viewport()->repaint(); } );
+    connect( selectionModel, &QItemSelectionModel::selectionChanged, this, [=] { invalidateBackground(); } );
 }
 
 
@@ -449,7 +537,7 @@ PartitionBarsView::setSelection( const QRect& rect, QItemSelectionModel::Selecti
         selectionModel()->select( eventIndex, flags );
     }
 
-    viewport()->repaint();
+    viewport()->update();
 }
 
 
@@ -479,7 +567,8 @@ PartitionBarsView::mouseMoveEvent( QMouseEvent* event )
             QGuiApplication::restoreOverrideCursor();
         }
 
-        viewport()->repaint();
+        updateHovered( oldHoveredIndex );
+        updateHovered( m_hoveredIndex );
     }
 }
 
@@ -490,8 +579,8 @@ PartitionBarsView::leaveEvent( QEvent* )
     QGuiApplication::restoreOverrideCursor();
     if ( m_hoveredIndex.isValid() )
     {
+        updateHovered( m_hoveredIndex );
         m_hoveredIndex = QModelIndex();
-        viewport()->repaint();
     }
 }
 
@@ -511,6 +600,17 @@ PartitionBarsView::mousePressEvent( QMouseEvent* event )
 }
 
 
+void
+PartitionBarsView::changeEvent( QEvent* event )
+{
+    QAbstractItemView::changeEvent( event );
+    if ( event->type() == QEvent::PaletteChange || event->type() == QEvent::StyleChange )
+    {
+        invalidateBackground();
+    }
+}
+
+
 void
 PartitionBarsView::updateGeometries()
 {
@@ -518,6 +618,40 @@ PartitionBarsView::updateGeometries()
 }
 
 
+void
+PartitionBarsView::reset()
+{
+    QAbstractItemView::reset();
+    invalidateSections();
+}
+
+
+void
+PartitionBarsView::dataChanged( const QModelIndex& topLeft,
+                                const QModelIndex& bottomRight,
+                                const QVector< int >& roles )
+{
+    QAbstractItemView::dataChanged( topLeft, bottomRight, roles );
+    invalidateSections();
+}
+
+
+void
+PartitionBarsView::rowsInserted( const QModelIndex& parent, int start, int end )
+{
+    QAbstractItemView::rowsInserted( parent, start, end );
+    invalidateSections();
+}
+
+
+void
+PartitionBarsView::rowsAboutToBeRemoved( const QModelIndex& parent, int start, int end )
+{
+    QAbstractItemView::rowsAboutToBeRemoved( parent, start, end );
+    invalidateSections();
+}
+
+
 QPair< QVector< PartitionBarsView::Item >, qreal >
 PartitionBarsView::computeItemsVector( const QModelIndex& parent ) const
 {
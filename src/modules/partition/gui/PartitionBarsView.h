@@ -14,6 +14,8 @@
 #include "PartitionViewSelectionFilter.h"
 
 #include <QAbstractItemView>
+#include <QPixmap>
+#include <QVector>
 
 
 /**
@@ -53,6 +55,9 @@ public:
 
     void setSelectionFilter( SelectionFilter canBeSelected );
 
+public slots:
+    void reset() override;
+
 protected:
     // QAbstractItemView API
     QRegion visualRegionForSelection( const QItemSelection& selection ) const override;
@@ -65,13 +70,43 @@ protected:
     void mouseMoveEvent( QMouseEvent* event ) override;
     void leaveEvent( QEvent* event ) override;
     void mousePressEvent( QMouseEvent* event ) override;
+    void changeEvent( QEvent* event ) override;
 
 protected slots:
     void updateGeometries() override;
+    void dataChanged( const QModelIndex& topLeft,
+                      const QModelIndex& bottomRight,
+                      const QVector< int >& roles = QVector< int >() ) override;
+    void rowsInserted( const QModelIndex& parent, int start, int end ) override;
+    void rowsAboutToBeRemoved( const QModelIndex& parent, int start, int end ) override;
 
 private:
-    void drawPartitions( QPainter* painter, const QRect& rect, const QModelIndex& parent );
-    void drawSection( QPainter* painter, const QRect& rect_, int x, int width, const QModelIndex& index );
+    /** @brief One colored section of the bar, as it is drawn
+     *
+     * Sections are kept in drawing order: the nested sections of an
+     * extended partition follow it, with a larger depth.
+     */
+    struct Section
+    {
+        QPersistentModelIndex index;  ///< Invalid for an unknown partition table
+        QRect rect;  ///< The bar (or nested bar) the section is in
+        int x;
+        int width;
+        int depth;
+        QColor color;
+        bool isFreeSpace;
+    };
+
+    const QVector< Section >& sections( const QRect& rect );
+    void layoutSections( const QRect& rect, const QModelIndex& parent, int depth );
+    /// @brief Forget the sections (e.g. the model changed) and the background
+    void invalidateSections();
+    /// @brief Forget the background (e.g. the selection changed)
+    void invalidateBackground();
+    void updateHovered( const QModelIndex& index );
+
+    void drawSection( QPainter* painter, const Section& section, bool hovered );
+    QModelIndex selectedIndex() const;
     QModelIndex indexAt( const QPoint& point, const QRect& rect, const QModelIndex& parent ) const;
     QRect visualRect( const QModelIndex& index, const QRect& rect, const QModelIndex& parent ) const;
 
@@ -86,6 +121,12 @@ private:
     };
     inline QPair< QVector< Item >, qreal > computeItemsVector( const QModelIndex& parent ) const;
     QPersistentModelIndex m_hoveredIndex;
+
+    QVector< Section > m_sections;
+    QRect m_sectionsRect;
+    bool m_sectionsValid = false;
+    /// @brief All the sections, drawn without hover highlight
+    QPixmap m_background;
 };
 
 #endif /* PARTITIONPREVIEW_H */
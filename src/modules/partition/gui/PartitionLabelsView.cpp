@@ -85,13 +85,111 @@ PartitionLabelsView::paintEvent( QPaintEvent* event )
 {
     Q_UNUSED( event )
 
+    const QRect lRect = labelsRect();
+
+    const qreal dpr = devicePixelRatioF();
+    const QSize backgroundSize = viewport()->size() * dpr;
+    if ( m_background.isNull() || m_background.size() != backgroundSize )
+    {
+        m_background = QPixmap( backgroundSize );
+        m_background.setDevicePixelRatio( dpr );
+
+        QPainter painter( &m_background );
+        painter.setFont( font() );
+        painter.fillRect( rect(), palette().window() );
+        painter.setRenderHint( QPainter::Antialiasing );
+        drawLabels( &painter, lRect );
+    }
+
     QPainter painter( viewport() );
-    painter.fillRect( rect(), palette().window() );
-    painter.setRenderHint( QPainter::Antialiasing );
+    painter.drawPixmap( 0, 0, m_background );
+
+    // The hovered label is drawn again, over its hover highlight
+    if ( selectionMode() != QAbstractItemView::NoSelection  // no hover without selection
+         && m_hoveredIndex.isValid() )
+    {
+        painter.setRenderHint( QPainter::Antialiasing );
+        const auto& allLabels = labels();
+        const auto rects = labelRects( lRect );
+        for ( int i = 0; i < allLabels.count(); ++i )
+        {
+            if ( allLabels[ i ].index == m_hoveredIndex )
+            {
+                const auto& label = allLabels[ i ];
+                drawHover( &painter, rects[ i ] );
+                drawLabel( &painter, label.texts, label.color, rects[ i ].topLeft(), label.index == selectedIndex() );
+                break;
+            }
+        }
+    }
+}
+
+
+const QVector< PartitionLabelsView::Label >&
+PartitionLabelsView::labels() const
+{
+    if ( !m_labelsValid )
+    {
+        m_labels.clear();
+        m_labelsValid = true;
+        for ( const QModelIndex& index : getIndexesToDraw( QModelIndex() ) )
+        {
+            const QStringList texts = buildTexts( index );
+            m_labels.append(
+                { index, texts, sizeForLabel( texts ), index.data( Qt::DecorationRole ).value< QColor >() } );
+        }
+    }
+    return m_labels;
+}
+
+
+QVector< QRect >
+PartitionLabelsView::labelRects( const QRect& rect ) const
+{
+    QVector< QRect > rects;
+    int label_x = rect.x();
+    int label_y = rect.y();
+    for ( const auto& label : labels() )
+    {
+        const QSize labelSize = label.size;
+        if ( label_x + labelSize.width() > rect.width() )  //wrap to new line if overflow
+        {
+            label_x = rect.x();
+            label_y += labelSize.height() + labelSize.height() / 4;
+        }
+
+        rects.append( QRect( QPoint( label_x, label_y ), labelSize ) );
+        label_x += labelSize.width() + LABELS_MARGIN;
+    }
+    return rects;
+}
 
-    QRect lRect = labelsRect();
 
-    drawLabels( &painter, lRect, QModelIndex() );
+void
+PartitionLabelsView::invalidateLabels()
+{
+    m_labelsValid = false;
+    invalidateBackground();
+}
+
+
+void
+PartitionLabelsView::invalidateBackground()
+{
+    m_background = QPixmap();
+    viewport()->update();
+}
+
+
+QModelIndex
+PartitionLabelsView::selectedIndex() const
+{
+    if ( selectionMode() == QAbstractItemView::NoSelection || !selectionModel() )
+    {
+        return QModelIndex();
+    }
+    const auto selected = selectionModel()->selectedIndexes();
+    return selected.isEmpty() ? QModelIndex() : selected.first();
 }
 
 
@@ -245,7 +343,7 @@ PartitionLabelsView::buildTexts( const QModelIndex& index ) const
 
 
 void
-PartitionLabelsView::drawLabels( QPainter* painter, const QRect& rect, const QModelIndex& parent )
+PartitionLabelsView::drawLabels( QPainter* painter, const QRect& rect )
 {
     PartitionModel* modl = qobject_cast< PartitionModel* >( model() );
     if ( !modl )
@@ -253,48 +351,15 @@ PartitionLabelsView::drawLabels( QPainter* painter, const QRect& rect, const QMo
         return;
     }
 
-    const QModelIndexList indexesToDraw = getIndexesToDraw( parent );
-
-    int label_x = rect.x();
-    int label_y = rect.y();
-    for ( const QModelIndex& index : indexesToDraw )
+    const auto& allLabels = labels();
+    const auto rects = labelRects( rect );
+    const QModelIndex selected = selectedIndex();
+    for ( int i = 0; i < allLabels.count(); ++i )
     {
-        QStringList texts = buildTexts( index );
-
-        QSize labelSize = sizeForLabel( texts );
-
-        QColor labelColor = index.data( Qt::DecorationRole ).value< QColor >();
-
-        if ( label_x + labelSize.width() > rect.width() )  //wrap to new line if overflow
-        {
-            label_x = rect.x();
-            label_y += labelSize.height() + labelSize.height() / 4;
-        }
-
-        // Draw hover
-        if ( selectionMode() != QAbstractItemView::NoSelection &&  // no hover without selection
-             m_hoveredIndex.isValid() && index == m_hoveredIndex )
-        {
-            painter->save();
-            QRect labelRect( QPoint( label_x, label_y ), labelSize );
-            labelRect.adjust( 0, -LAYOUT_MARGIN, 0, -2 * LAYOUT_MARGIN );
-            painter->translate( 0.5, 0.5 );
-            QRect hoverRect = labelRect.adjusted( 0, 0, -1, -1 );
-            painter->setBrush( QPalette().window().color().lighter( 102 ) );
-            painter->setPen( Qt::NoPen );
-            painter->drawRoundedRect( hoverRect, CORNER_RADIUS, CORNER_RADIUS );
-
-            painter->translate( -0.5, -0.5 );
-            painter->restore();
-        }
-
+        const auto& label = allLabels[ i ];
         // Is this element the selected one?
-        bool sel = selectionMode() != QAbstractItemView::NoSelection && index.isValid() && selectionModel()
-            && !selectionModel()->selectedIndexes().isEmpty() && selectionModel()->selectedIndexes().first() == index;
-
-        drawLabel( painter, texts, labelColor, QPoint( label_x, label_y ), sel );
-
-        label_x += labelSize.width() + LABELS_MARGIN;
+        const bool sel = label.index.isValid() && label.index == selected;
+        drawLabel( painter, label.texts, label.color, rects[ i ].topLeft(), sel );
     }
 
     if ( !modl->rowCount() && !modl->device()->partitionTable() )  // No disklabel or unknown
@@ -306,6 +371,23 @@ PartitionLabelsView::drawLabels( QPainter* painter, const QRect& rect, const QMo
 }
 
 
+void
+PartitionLabelsView::drawHover( QPainter* painter, const QRect& labelRect_ )
+{
+    painter->save();
+    QRect labelRect = labelRect_;
+    labelRect.adjust( 0, -LAYOUT_MARGIN, 0, -2 * LAYOUT_MARGIN );
+    painter->translate( 0.5, 0.5 );
+    QRect hoverRect = labelRect.adjusted( 0, 0, -1, -1 );
+    painter->setBrush( QPalette().window().color().lighter( 102 ) );
+    painter->setPen( Qt::NoPen );
+    painter->drawRoundedRect( hoverRect, CORNER_RADIUS, CORNER_RADIUS );
+
+    painter->translate( -0.5, -0.5 );
+    painter->restore();
+}
+
+
 QSize
 PartitionLabelsView::sizeForAllLabels( int maxLineWidth ) const
 {
@@ -315,16 +397,12 @@ PartitionLabelsView::sizeForAllLabels( int maxLineWidth ) const
         return QSize();
     }
 
-    const QModelIndexList indexesToDraw = getIndexesToDraw( QModelIndex() );
-
     int lineLength = 0;
     int numLines = 1;
     int singleLabelHeight = 0;
-    for ( const QModelIndex& index : indexesToDraw )
+    for ( const auto& label : labels() )
     {
-        QStringList texts = buildTexts( index );
-
-        QSize labelSize = sizeForLabel( texts );
+        const QSize labelSize = label.size;
 
         if ( lineLength + labelSize.width() > maxLineWidth )
         {
@@ -409,30 +487,14 @@ PartitionLabelsView::indexAt( const QPoint& point ) const
         return QModelIndex();
     }
 
-    const QModelIndexList indexesToDraw = getIndexesToDraw( QModelIndex() );
-
-    QRect rect = this->rect();
-    int label_x = rect.x();
-    int label_y = rect.y();
-    for ( const QModelIndex& index : indexesToDraw )
+    const auto& allLabels = labels();
+    const auto rects = labelRects( rect() );
+    for ( int i = 0; i < allLabels.count(); ++i )
     {
-        QStringList texts = buildTexts( index );
-
-        QSize labelSize = sizeForLabel( texts );
-
-        if ( label_x + labelSize.width() > rect.width() )  //wrap to new line if overflow
+        if ( rects[ i ].contains( point ) )
         {
-            label_x = rect.x();
-            label_y += labelSize.height() + labelSize.height() / 4;
-        }
-
-        QRect labelRect( QPoint( label_x, label_y ), labelSize );
-        if ( labelRect.contains( point ) )
-        {
-            return index;
+            return allLabels[ i ].index;
         }
-
-        label_x += labelSize.width() + LABELS_MARGIN;
     }
 
     return QModelIndex();
@@ -443,34 +505,19 @@ QRect
 PartitionLabelsView::visualRect( const QModelIndex& idx ) const
 {
     PartitionModel* modl = qobject_cast< PartitionModel* >( model() );
-    if ( !modl )
+    if ( !modl || !idx.isValid() )
     {
         return QRect();
     }
 
-    const QModelIndexList indexesToDraw = getIndexesToDraw( QModelIndex() );
-
-    QRect rect = this->rect();
-    int label_x = rect.x();
-    int label_y = rect.y();
-    for ( const QModelIndex& index : indexesToDraw )
+    const auto& allLabels = labels();
+    const auto rects = labelRects( rect() );
+    for ( int i = 0; i < allLabels.count(); ++i )
     {
-        QStringList texts = buildTexts( index );
-
-        QSize labelSize = sizeForLabel( texts );
-
-        if ( label_x + labelSize.width() > rect.width() )  //wrap to new line if overflow
+        if ( allLabels[ i ].index == idx )
         {
-            label_x = rect.x();
-            label_y += labelSize.height() + labelSize.height() / 4;
+            return rects[ i ];
         }
-
-        if ( idx.isValid() && idx == index )
-        {
-            return QRect( QPoint( label_x, label_y ), labelSize );
-        }
-
-        label_x += labelSize.width() + LABELS_MARGIN;
     }
 
     return QRect();
@@ -512,7 +559,7 @@ void
 PartitionLabelsView::setCustomNewRootLabel( const QString& text )
 {
     m_customNewRootLabel = text;
-    viewport()->repaint();
+    invalidateLabels();
 }
 
 
@@ -520,7 +567,7 @@ void
 PartitionLabelsView::setSelectionModel( QItemSelectionModel* selectionModel )
 {
     QAbstractItemView::setSelectionModel( selectionModel );
-    connect( selectionModel, &QItemSelectionModel::selectionChanged, this, [=] { viewport()->repaint(); } );
+    connect( selectionModel, &QItemSelectionModel::selectionChanged, this, [=] { invalidateBackground(); } );
 }
 
 
@@ -535,6 +582,7 @@ void
 PartitionLabelsView::setExtendedPartitionHidden( bool hidden )
 {
     m_extendedPartitionHidden = hidden;
+    invalidateLabels();
 }
 
 
@@ -594,7 +642,7 @@ PartitionLabelsView::mouseMoveEvent( QMouseEvent* event )
             QGuiApplication::restoreOverrideCursor();
         }
 
-        viewport()->repaint();
+        viewport()->update();
     }
 }
 
@@ -608,7 +656,7 @@ PartitionLabelsView::leaveEvent( QEvent* event )
     if ( m_hoveredIndex.isValid() )
     {
         m_hoveredIndex = QModelIndex();
-        viewport()->repaint();
+        viewport()->update();
     }
 }
 
@@ -628,8 +676,62 @@ PartitionLabelsView::mousePressEvent( QMouseEvent* event )
 }
 
 
+void
+PartitionLabelsView::changeEvent( QEvent* event )
+{
+    QAbstractItemView::changeEvent( event );
+    switch ( event->type() )
+    {
+    case QEvent::FontChange:
+    case QEvent::LanguageChange:
+        invalidateLabels();
+        break;
+    case QEvent::PaletteChange:
+    case QEvent::StyleChange:
+        invalidateBackground();
+        break;
+    default:
+        break;
+    }
+}
+
+
 void
 PartitionLabelsView::updateGeometries()
 {
     updateGeometry();  //get a new rect() for redrawing all the labels
 }
+
+
+void
+PartitionLabelsView::reset()
+{
+    QAbstractItemView::reset();
+    invalidateLabels();
+}
+
+
+void
+PartitionLabelsView::dataChanged( const QModelIndex& topLeft,
+                                  const QModelIndex& bottomRight,
+                                  const QVector< int >& roles )
+{
+    QAbstractItemView::dataChanged( topLeft, bottomRight, roles );
+    invalidateLabels();
+}
+
+
+void
+PartitionLabelsView::rowsInserted( const QModelIndex& parent, int start, int end )
+{
+    QAbstractItemView::rowsInserted( parent, start, end );
+    invalidateLabels();
+}
+
+
+void
+PartitionLabelsView::rowsAboutToBeRemoved( const QModelIndex& parent, int start, int end )
+{
+    QAbstractItemView::rowsAboutToBeRemoved( parent, start, end );
+    invalidateLabels();
+}
@@ -15,6 +15,8 @@
 #include "PartitionViewSelectionFilter.h"
 
 #include <QAbstractItemView>
+#include <QPixmap>
+#include <QVector>
 
 /**
  * A Qt model view which displays colored labels for partitions.
@@ -49,6 +51,9 @@ public:
 
     void setExtendedPartitionHidden( bool hidden );
 
+public slots:
+    void reset() override;
+
 protected:
     // QAbstractItemView API
     QRegion visualRegionForSelection( const QItemSelection& selection ) const override;
@@ -61,13 +66,38 @@ protected:
     void mouseMoveEvent( QMouseEvent* event ) override;
     void leaveEvent( QEvent* event ) override;
     void mousePressEvent( QMouseEvent* event ) override;
+    void changeEvent( QEvent* event ) override;
 
 protected slots:
     void updateGeometries() override;
+    void dataChanged( const QModelIndex& topLeft,
+                      const QModelIndex& bottomRight,
+                      const QVector< int >& roles = QVector< int >() ) override;
+    void rowsInserted( const QModelIndex& parent, int start, int end ) override;
+    void rowsAboutToBeRemoved( const QModelIndex& parent, int start, int end ) override;
 
 private:
+    /// @brief The texts of one label and their size, independent of where it goes
+    struct Label
+    {
+        QPersistentModelIndex index;
+        QStringList texts;
+        QSize size;
+        QColor color;
+    };
+
+    const QVector< Label >& labels() const;
+    /// @brief Where each of the labels() goes, wrapping at the width of @p rect
+    QVector< QRect > labelRects( const QRect& rect ) const;
+    /// @brief Forget the labels (e.g. the model changed) and the background
+    void invalidateLabels();
+    /// @brief Forget the background (e.g. the selection changed)
+    void invalidateBackground();
+
     QRect labelsRect() const;
-    void drawLabels( QPainter* painter, const QRect& rect, const QModelIndex& parent );
+    void drawLabels( QPainter* painter, const QRect& rect );
+    void drawHover( QPainter* painter, const QRect& labelRect );
+    QModelIndex selectedIndex() const;
     QSize sizeForAllLabels( int maxLineWidth ) const;
     QSize sizeForLabel( const QStringList& text ) const;
     void drawLabel( QPainter* painter, const QStringList& text, const QColor& color, const QPoint& pos, bool selected );
@@ -79,6 +109,11 @@ private:
 
     QString m_customNewRootLabel;
     QPersistentModelIndex m_hoveredIndex;
+
+    mutable QVector< Label > m_labels;
+    mutable bool m_labelsValid = false;
+    /// @brief All the labels, drawn without hover highlight
+    QPixmap m_background;
 };
 
 #endif  // PARTITIONLABELSVIEW_H
@@ -35,6 +35,7 @@
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 #include "partition/PartitionQuery.h"
+#include "utils/Executor.h"
 #include "utils/Logger.h"
 #include "utils/Retranslator.h"
 #include "widgets/TranslationFix.h"
@@ -55,7 +56,6 @@
 #include <QItemSelectionModel>
 #include <QMessageBox>
 #include <QPointer>
-#include <QtConcurrent/QtConcurrent>
 
 PartitionPage::PartitionPage( PartitionCoreModule* core, QWidget* parent )
     : QWidget( parent )
@@ -451,7 +451,7 @@ void
 PartitionPage::onRevertClicked()
 {
     ScanningDialog::run(
-        QtConcurrent::run( [this] {
+        CalamaresUtils::Executor::run( CalamaresUtils::Executor::Lane::Interactive, "revert-all-devices", [this] {
             QMutexLocker locker( &m_revertMutex );
 
             int oldIndex = m_ui->deviceComboBox->currentIndex();
@@ -44,10 +44,19 @@ PartitionSplitterWidget::PartitionSplitterWidget( QWidget* parent )
     , m_itemPrefSize( 0 )
     , m_resizing( false )
     , m_resizeHandleX( 0 )
+    , m_dragX( 0 )
+    , m_dragStart( 0 )
+    , m_dragTotal( 0 )
+    , m_dragWidth( 1 )
+    , m_sectorSize( 1 )
     , HANDLE_SNAP( QApplication::startDragDistance() )
     , m_drawNestedPartitions( false )
 {
     setMouseTracking( true );
+
+    m_dragTimer.setSingleShot( true );
+    m_dragTimer.setInterval( 16 );  // About one frame
+    connect( &m_dragTimer, &QTimer::timeout, this, &PartitionSplitterWidget::applyDrag );
 }
 
 
@@ -55,6 +64,7 @@ void
 PartitionSplitterWidget::init( Device* dev, bool drawNestedPartitions )
 {
     m_drawNestedPartitions = drawNestedPartitions;
+    m_sectorSize = qMax< qint64 >( 1, dev->logicalSize() );
     QVector< PartitionSplitterItem > allPartitionItems;
     PartitionSplitterItem* extendedPartitionItem = nullptr;
     for ( auto it = PartitionIterator::begin( dev ); it != PartitionIterator::end( dev ); ++it )
@@ -104,7 +114,7 @@ PartitionSplitterWidget::setupItems( const QVector< PartitionSplitterItem >& ite
 
     m_items.clear();
     m_items = items;
-    repaint();
+    update();
     for ( const PartitionSplitterItem& item : items )
     {
         cDebug() << "PSI added item" << item.itemPath << "size" << item.size;
@@ -236,7 +246,7 @@ PartitionSplitterWidget::setSplitPartition( const QString& path, qint64 minSize,
     cDebug() << "m_itemToResize:    " << !m_itemToResize.isNull() << m_itemToResize.itemPath;
     cDebug() << "m_itemToResizeNext:" << !m_itemToResizeNext.isNull() << m_itemToResizeNext.itemPath;
 
-    repaint();
+    update();
 }
 
 
@@ -297,84 +307,65 @@ PartitionSplitterWidget::mousePressEvent( QMouseEvent* event )
         if ( qAbs( event->x() - m_resizeHandleX ) < HANDLE_SNAP )
         {
             m_resizing = true;
-        }
-    }
-}
-
 
-void
-PartitionSplitterWidget::mouseMoveEvent( QMouseEvent* event )
-{
-    if ( m_resizing )
-    {
-        qint64 start = 0;
-        QString itemPath = m_itemToResize.itemPath;
-        for ( auto it = m_items.constBegin(); it != m_items.constEnd(); ++it )
-        {
-            if ( it->itemPath == itemPath )
-            {
-                break;
-            }
-            else if ( !it->children.isEmpty() )
+            // Nothing but the item to resize and the new item change
+            // size while dragging, so this can be worked out once.
+            qint64 start = 0;
+            const QString itemPath = m_itemToResize.itemPath;
+            for ( auto it = m_items.constBegin(); it != m_items.constEnd(); ++it )
             {
-                bool done = false;
-                for ( auto jt = it->children.constBegin(); jt != it->children.constEnd(); ++jt )
+                if ( it->itemPath == itemPath )
                 {
-                    if ( jt->itemPath == itemPath )
+                    break;
+                }
+                else if ( !it->children.isEmpty() )
+                {
+                    bool done = false;
+                    for ( auto jt = it->children.constBegin(); jt != it->children.constEnd(); ++jt )
+                    {
+                        if ( jt->itemPath == itemPath )
+                        {
+                            done = true;
+                            break;
+                        }
+                        start += jt->size;
+                    }
+                    if ( done )
                     {
-                        done = true;
                         break;
                     }
-                    start += jt->size;
                 }
-                if ( done )
+                else
                 {
-                    break;
+                    start += it->size;
                 }
             }
-            else
+
+            qint64 total = 0;
+            for ( auto it = m_items.constBegin(); it != m_items.constEnd(); ++it )
             {
-                start += it->size;
+                total += it->size;
             }
-        }
 
-        qint64 total = 0;
-        for ( auto it = m_items.constBegin(); it != m_items.constEnd(); ++it )
-        {
-            total += it->size;
+            m_dragStart = start;
+            m_dragTotal = total;
+            m_dragWidth = qMax( 1, rect().width() );  //effective width
+            m_dragX = event->x();
         }
+    }
+}
 
-        int ew = rect().width();  //effective width
-        qreal bpp = total / static_cast< qreal >( ew );  //bytes per pixel
-
-        qreal mx = event->x() * bpp - start;
-
-        // make sure we are within resize range
-        mx = qBound( static_cast< qreal >( m_itemMinSize ), mx, static_cast< qreal >( m_itemMaxSize ) );
-
-        qint64 span = m_itemPrefSize;
-        qreal percent = mx / span;
-        qint64 oldsize = m_itemToResize.size;
-
-        m_itemToResize.size = qRound64( span * percent );
-        m_itemToResizeNext.size -= m_itemToResize.size - oldsize;
-        _eachItem( m_items, [this]( PartitionSplitterItem& item ) -> bool {
-            if ( item.status == PartitionSplitterItem::Resizing )
-            {
-                item.size = m_itemToResize.size;
-                return true;
-            }
-            else if ( item.status == PartitionSplitterItem::ResizingNext )
-            {
-                item.size = m_itemToResizeNext.size;
-                return true;
-            }
-            return false;
-        } );
-
-        repaint();
 
-        Q_EMIT partitionResized( itemPath, m_itemToResize.size, m_itemToResizeNext.size );
+void
+PartitionSplitterWidget::mouseMoveEvent( QMouseEvent* event )
+{
+    if ( m_resizing )
+    {
+        m_dragX = event->x();
+        if ( !m_dragTimer.isActive() )
+        {
+            m_dragTimer.start();
+        }
     }
     else
     {
@@ -398,10 +389,60 @@ PartitionSplitterWidget::mouseReleaseEvent( QMouseEvent* event )
 {
     Q_UNUSED( event )
 
+    if ( m_resizing && m_dragTimer.isActive() )
+    {
+        // Don't lose the last bit of the drag
+        m_dragTimer.stop();
+        applyDrag();
+    }
     m_resizing = false;
 }
 
 
+void
+PartitionSplitterWidget::applyDrag()
+{
+    if ( !m_itemToResize || !m_itemToResizeNext )
+    {
+        return;
+    }
+
+    // Bytes (from the start of the item to resize) under the mouse,
+    // in whole sectors, and within the resize range. The division
+    // is split up so that huge disks do not overflow.
+    const qint64 x = m_dragX;
+    const qint64 offset
+        = ( m_dragTotal / m_dragWidth ) * x + ( m_dragTotal % m_dragWidth ) * x / m_dragWidth - m_dragStart;
+    const qint64 minSectors = ( m_itemMinSize + m_sectorSize - 1 ) / m_sectorSize;
+    const qint64 maxSectors = m_itemMaxSize / m_sectorSize;
+    const qint64 newSize = qBound( minSectors, offset / m_sectorSize, maxSectors ) * m_sectorSize;
+    if ( newSize == m_itemToResize.size )
+    {
+        return;
+    }
+
+    m_itemToResizeNext.size -= newSize - m_itemToResize.size;
+    m_itemToResize.size = newSize;
+    _eachItem( m_items, [this]( PartitionSplitterItem& item ) -> bool {
+        if ( item.status == PartitionSplitterItem::Resizing )
+        {
+            item.size = m_itemToResize.size;
+            return true;
+        }
+        else if ( item.status == PartitionSplitterItem::ResizingNext )
+        {
+            item.size = m_itemToResizeNext.size;
+            return true;
+        }
+        return false;
+    } );
+
+    update();
+
+    Q_EMIT partitionResized( m_itemToResize.itemPath, m_itemToResize.size, m_itemToResizeNext.size );
+}
+
+
 void
 PartitionSplitterWidget::drawSection( QPainter* painter,
                                       const QRect& rect_,
@@ -10,6 +10,7 @@
 #ifndef PARTITIONSPLITTERWIDGET_H
 #define PARTITIONSPLITTERWIDGET_H
 
+#include <QTimer>
 #include <QWidget>
 
 #include <functional>
@@ -67,6 +68,8 @@ protected:
 
 private:
     void setupItems( const QVector< PartitionSplitterItem >& items );
+    /// @brief Resize for the handle at @p x, the last position dragged to
+    void applyDrag();
 
     void drawPartitions( QPainter* painter, const QRect& rect, const QVector< PartitionSplitterItem >& itemList );
     void drawSection( QPainter* painter, const QRect& rect_, int x, int width, const PartitionSplitterItem& item );
@@ -92,6 +95,17 @@ private:
     bool m_resizing;
     int m_resizeHandleX;
 
+    /* While dragging, mouse moves only remember where the mouse is,
+     * and the sizes are updated (at most) once per frame. The sizes
+     * of everything that does not move are fixed for the whole drag.
+     */
+    QTimer m_dragTimer;
+    int m_dragX;
+    qint64 m_dragStart;  ///< Bytes before the item to resize
+    qint64 m_dragTotal;  ///< Bytes in the whole bar
+    int m_dragWidth;  ///< Pixels in the whole bar
+    qint64 m_sectorSize;  ///< Sizes are whole sectors of this many bytes
+
     const int HANDLE_SNAP;
 
     bool m_drawNestedPartitions;
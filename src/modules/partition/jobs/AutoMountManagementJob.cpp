@@ -14,6 +14,8 @@
 AutoMountManagementJob::AutoMountManagementJob( bool disable )
     : m_disable( disable )
 {
+    // So that exec() does not have to wait for the answer
+    CalamaresUtils::Partition::automountPrefetch();
 }
 
 QString
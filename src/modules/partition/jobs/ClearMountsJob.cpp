@@ -11,6 +11,7 @@
 
 #include "ClearMountsJob.h"
 
+#include "core/FilesystemProbe.h"
 #include "core/PartitionInfo.h"
 
 #include "partition/PartitionIterator.h"
@@ -24,9 +25,21 @@
 #include <kpmcore/util/report.h>
 
 #include <QDir>
+#include <QFileInfo>
+#include <QHash>
 #include <QProcess>
+#include <QSet>
 #include <QStringList>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/mount.h>
+#include <sys/stat.h>
+#include <sys/swap.h>
+#include <sys/sysmacros.h>
+
 using CalamaresUtils::Partition::PartitionIterator;
 
 ClearMountsJob::ClearMountsJob( Device* device )
@@ -81,233 +94,537 @@ getPartitionsForDevice( const QString& deviceName )
     return partitions;
 }
 
-Calamares::JobResult
-ClearMountsJob::exec()
-{
-    CalamaresUtils::Partition::Syncer s;
-
-    QString deviceName = m_device->deviceNode().split( '/' ).last();
-
-    QStringList goodNews;
-    QProcess process;
-
-    QStringList partitionsList = getPartitionsForDevice( deviceName );
-
-    // Build a list of partitions of type 82 (Linux swap / Solaris).
-    // We then need to clear them just in case they contain something resumable from a
-    // previous suspend-to-disk.
-    QStringList swapPartitions;
-    process.start( "sfdisk", { "-d", m_device->deviceNode() } );
-    process.waitForFinished();
-    // Sample output:
-    //    % sudo sfdisk -d /dev/sda
-    //    label: dos
-    //    label-id: 0x000ced89
-    //    device: /dev/sda
-    //    unit: sectors
-
-    //    /dev/sda1 : start=          63, size=    29329345, type=83, bootable
-    //    /dev/sda2 : start=    29331456, size=     2125824, type=82
 
-    swapPartitions = QString::fromLocal8Bit( process.readAllStandardOutput() ).split( '\n' );
-    swapPartitions = swapPartitions.filter( "type=82" );
-    for ( QStringList::iterator it = swapPartitions.begin(); it != swapPartitions.end(); ++it )
+/** @brief Undoes the octal escapes (e.g. "\040" for a space) of /proc/self/mountinfo and /proc/swaps */
+static QString
+unescapeProcPath( const QByteArray& path )
+{
+    QByteArray result;
+    result.reserve( path.length() );
+    for ( int i = 0; i < path.length(); ++i )
     {
-        *it = ( *it ).simplified().split( ' ' ).first();
+        if ( path[ i ] == '\\' && i + 3 < path.length() )
+        {
+            bool ok = false;
+            const int c = path.mid( i + 1, 3 ).toInt( &ok, 8 );
+            if ( ok )
+            {
+                result.append( char( c ) );
+                i += 3;
+                continue;
+            }
+        }
+        result.append( path[ i ] );
     }
+    return QString::fromLocal8Bit( result );
+}
 
-    const QStringList cryptoDevices = getCryptoDevices();
-    for ( const QString& mapperPath : cryptoDevices )
+/* Not exactly public API */
+QList< MountEntry >
+parseMountInfo( const QByteArray& mountInfo )
+{
+    QList< MountEntry > mounts;
+    const auto lines = mountInfo.split( '\n' );
+    for ( const QByteArray& line : lines )
     {
-        tryUmount( mapperPath );
-        QString news = tryCryptoClose( mapperPath );
-        if ( !news.isEmpty() )
+        // 36 35 98:0 /mnt1 /mnt2 rw,noatime master:1 - ext3 /dev/root rw,errors=continue
+        // There may be any number of optional fields before the "-".
+        const auto fields = line.split( ' ' );
+        const int separator = fields.indexOf( QByteArray( "-" ) );
+        if ( fields.count() < 5 || separator < 5 || separator + 2 >= fields.count() )
         {
-            goodNews.append( news );
+            continue;
         }
+        mounts.append( { QString::fromLatin1( fields[ 2 ] ),
+                         unescapeProcPath( fields[ separator + 2 ] ),
+                         unescapeProcPath( fields[ 4 ] ) } );
     }
+    return mounts;
+}
 
-    // First we umount all LVM logical volumes we can find
-    process.start( "lvscan", { "-a" } );
-    process.waitForFinished();
-    if ( process.exitCode() == 0 )  //means LVM2 tools are installed
+/* Not exactly public API */
+QList< SwapEntry >
+parseSwaps( const QByteArray& swaps )
+{
+    QList< SwapEntry > entries;
+    const auto lines = swaps.split( '\n' );
+    // The first line is the header
+    for ( int i = 1; i < lines.count(); ++i )
     {
-        const QStringList lvscanLines = QString::fromLocal8Bit( process.readAllStandardOutput() ).split( '\n' );
-        for ( const QString& lvscanLine : lvscanLines )
+        const auto fields = lines[ i ].simplified().split( ' ' );
+        if ( fields.count() >= 2 )
         {
-            QString lvPath = lvscanLine.simplified().split( ' ' ).value( 1 );  //second column
-            lvPath = lvPath.replace( '\'', "" );
+            entries.append( { unescapeProcPath( fields[ 0 ] ), fields[ 1 ] == "file" } );
+        }
+    }
+    return entries;
+}
 
-            QString news = tryUmount( lvPath );
-            if ( !news.isEmpty() )
+/* Not exactly public API */
+QString
+volumeGroupName( const QString& dmName )
+{
+    // LVM names its device-mapper devices "vg-lv", doubling any '-' in the names
+    QString vg;
+    for ( int i = 0; i < dmName.length(); ++i )
+    {
+        if ( dmName[ i ] == '-' )
+        {
+            if ( i + 1 < dmName.length() && dmName[ i + 1 ] == '-' )
             {
-                goodNews.append( news );
+                vg.append( '-' );
+                ++i;
+                continue;
             }
+            return vg;
         }
+        vg.append( dmName[ i ] );
     }
-    else
-    {
-        cWarning() << "this system does not seem to have LVM2 tools.";
-    }
+    return QString();
+}
 
-    // Then we go looking for volume groups that use this device for physical volumes
-    process.start( "pvdisplay", { "-C", "--noheadings" } );
-    process.waitForFinished();
-    if ( process.exitCode() == 0 )  //means LVM2 tools are installed
-    {
-        QString pvdisplayOutput = process.readAllStandardOutput();
-        if ( !pvdisplayOutput.simplified().isEmpty() )  //means there is at least one LVM PV
-        {
-            QSet< QString > vgSet;
+/* Not exactly public API */
+QStringList
+unmountOrder( QStringList mountPoints )
+{
+    // A mount point is below another only if it has more components
+    auto depth = []( const QString& path ) { return path.count( '/' ) - ( path.endsWith( '/' ) ? 1 : 0 ); };
+    mountPoints.removeDuplicates();
+    std::stable_sort( mountPoints.begin(), mountPoints.end(), [ & ]( const QString& a, const QString& b ) {
+        return depth( a ) > depth( b );
+    } );
+    return mountPoints;
+}
 
-            const QStringList pvdisplayLines = pvdisplayOutput.split( '\n' );
-            for ( const QString& pvdisplayLine : pvdisplayLines )
-            {
-                QString pvPath = pvdisplayLine.simplified().split( ' ' ).value( 0 );
-                QString vgName = pvdisplayLine.simplified().split( ' ' ).value( 1 );
-                if ( !pvPath.contains( deviceName ) )
-                {
-                    continue;
-                }
+static QByteArray
+readProcFile( const QString& path )
+{
+    // Files in /proc and /sys have no size, so read them until the end
+    QFile f( path );
+    return f.open( QIODevice::ReadOnly ) ? f.readAll() : QByteArray();
+}
 
-                vgSet.insert( vgName );
-            }
+static QString
+deviceNumber( dev_t d )
+{
+    return QStringLiteral( "%1:%2" ).arg( major( d ) ).arg( minor( d ) );
+}
+
+static QString
+canonicalDevicePath( const QString& path )
+{
+    const QString canonical = QFileInfo( path ).canonicalFilePath();
+    return canonical.isEmpty() ? path : canonical;
+}
+
+namespace
+{
 
-            foreach ( const QString& vgName, vgSet )
+/** @brief A block device that may need to be freed
+ *
+ * The holders are the block devices built on top of this one
+ * (e.g. the LUKS or LVM device-mapper devices on a partition).
+ */
+struct BlockNode
+{
+    QString name;  ///< Kernel name, e.g. "sda1" or "dm-3"
+    QString dmName;  ///< Device-mapper name, e.g. "luks-1234" or "vg-root"
+    QString dmUuid;  ///< e.g. "CRYPT-LUKS2-..." or "LVM-..."
+    QStringList swaps;  ///< Swap devices or files to switch off
+    QStringList mountPoints;
+    QVector< int > holders;
+
+    QString path() const { return QStringLiteral( "/dev/" ) + name; }
+    bool isCrypt() const { return dmUuid.startsWith( QStringLiteral( "CRYPT-" ) ); }
+    bool isLvm() const { return dmUuid.startsWith( QStringLiteral( "LVM-" ) ); }
+};
+
+/** @brief The block devices on a disk, and everything built on them
+ *
+ * The disk and its partitions are the roots, found in sysfs along with
+ * their holders. A volume group on the disk may also have logical volumes
+ * that are only on other disks; those are roots as well, since the whole
+ * volume group is deactivated. The mounts and swaps are read once from /proc.
+ */
+class BlockTree
+{
+public:
+    explicit BlockTree( const QString& diskName );
+
+    /** @brief Frees all the devices; returns what was done
+     *
+     * All the swaps are switched off, and then all the mount points are
+     * unmounted, deepest first, in one sequence. After that the volume
+     * groups are deactivated and the LUKS devices closed, from the top down.
+     */
+    QStringList teardown() const;
+
+    /// @brief Paths of all the devices, e.g. "/dev/sda1" and "/dev/dm-3"
+    QStringList devices() const;
+
+private:
+    int add( const QString& name );
+    void addVolumeGroups();
+    /// @brief The logical volumes (node indexes) of each volume group
+    QHash< QString, QVector< int > > volumeGroups() const;
+    /** @brief Appends @p index to @p order after its holders (leaving out the live image)
+     *
+     * A volume group counts as one holder: a device with a logical volume
+     * of the group on it comes after all the logical volumes of the group.
+     */
+    void bottomUp( int index,
+                   const QHash< QString, QVector< int > >& groups,
+                   QSet< int >& done,
+                   QVector< int >& order ) const;
+
+    QVector< BlockNode > m_nodes;
+    QHash< QString, int > m_index;
+    QVector< int > m_roots;
+    QList< MountEntry > m_mounts;
+    QList< SwapEntry > m_swaps;
+};
+
+BlockTree::BlockTree( const QString& diskName )
+    : m_mounts( parseMountInfo( readProcFile( QStringLiteral( "/proc/self/mountinfo" ) ) ) )
+    , m_swaps( parseSwaps( readProcFile( QStringLiteral( "/proc/swaps" ) ) ) )
+{
+    m_roots.append( add( diskName ) );
+
+    QDir sysDisk( QStringLiteral( "/sys/class/block/" ) + diskName );
+    QStringList partitions;
+    if ( sysDisk.exists() )
+    {
+        const auto entries = sysDisk.entryList( QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name );
+        for ( const QString& entry : entries )
+        {
+            if ( QFile::exists( sysDisk.filePath( entry + QStringLiteral( "/partition" ) ) ) )
             {
-                process.start( "vgchange", { "-an", vgName } );
-                process.waitForFinished();
-                if ( process.exitCode() == 0 )
-                {
-                    goodNews.append( QString( "Successfully disabled volume group %1." ).arg( vgName ) );
-                }
+                partitions.append( entry );
             }
         }
     }
     else
     {
-        cWarning() << "this system does not seem to have LVM2 tools.";
+        partitions = getPartitionsForDevice( diskName );
+    }
+    for ( const QString& p : qAsConst( partitions ) )
+    {
+        m_roots.append( add( p ) );
+    }
+    addVolumeGroups();
+}
+
+void
+BlockTree::addVolumeGroups()
+{
+    QSet< QString > volumeGroups;
+    for ( const auto& node : qAsConst( m_nodes ) )
+    {
+        if ( node.isLvm() )
+        {
+            volumeGroups.insert( volumeGroupName( node.dmName ) );
+        }
+    }
+    if ( volumeGroups.isEmpty() )
+    {
+        return;
     }
 
-    const QStringList cryptoDevices2 = getCryptoDevices();
-    for ( const QString& mapperPath : cryptoDevices2 )
+    const QDir sysBlock( QStringLiteral( "/sys/class/block" ) );
+    for ( const QString& name : sysBlock.entryList( { QStringLiteral( "dm-*" ) }, QDir::Dirs | QDir::System ) )
     {
-        tryUmount( mapperPath );
-        QString news = tryCryptoClose( mapperPath );
-        if ( !news.isEmpty() )
+        const QString sys = sysBlock.filePath( name );
+        const QString dmName = QString::fromLatin1( readProcFile( sys + QStringLiteral( "/dm/name" ) ) ).trimmed();
+        const QString dmUuid = QString::fromLatin1( readProcFile( sys + QStringLiteral( "/dm/uuid" ) ) ).trimmed();
+        if ( !m_index.contains( name ) && dmUuid.startsWith( QStringLiteral( "LVM-" ) )
+             && volumeGroups.contains( volumeGroupName( dmName ) ) )
         {
-            goodNews.append( news );
+            cDebug() << "Volume group" << volumeGroupName( dmName ) << "also has" << dmName << "on another disk.";
+            m_roots.prepend( add( name ) );
         }
     }
+}
 
-    for ( const QString& p : partitionsList )
+int
+BlockTree::add( const QString& name )
+{
+    const auto it = m_index.constFind( name );
+    if ( it != m_index.constEnd() )
     {
-        QString partPath = QString( "/dev/%1" ).arg( p );
+        return it.value();
+    }
 
-        QString news = tryUmount( partPath );
-        if ( !news.isEmpty() )
+    const QString sys = QStringLiteral( "/sys/class/block/" ) + name;
+    BlockNode node;
+    node.name = name;
+    node.dmName = QString::fromLatin1( readProcFile( sys + QStringLiteral( "/dm/name" ) ) ).trimmed();
+    node.dmUuid = QString::fromLatin1( readProcFile( sys + QStringLiteral( "/dm/uuid" ) ) ).trimmed();
+    const QString number = QString::fromLatin1( readProcFile( sys + QStringLiteral( "/dev" ) ) ).trimmed();
+
+    // Btrfs (among others) reports an anonymous device number in mountinfo,
+    // so mounts are matched on their source as well. Swap files live on
+    // the filesystem, so they are matched on the device numbers of the mounts.
+    QSet< QString > filesystemNumbers { number };
+    for ( const auto& mount : qAsConst( m_mounts ) )
+    {
+        if ( ( !number.isEmpty() && mount.deviceNumber == number )
+             || canonicalDevicePath( mount.source ) == node.path() )
         {
-            goodNews.append( news );
+            node.mountPoints.append( mount.mountPoint );
+            filesystemNumbers.insert( mount.deviceNumber );
         }
     }
+    node.mountPoints.removeDuplicates();
 
-    foreach ( QString p, swapPartitions )
+    for ( const auto& swap : qAsConst( m_swaps ) )
     {
-        QString news = tryClearSwap( p );
-        if ( !news.isEmpty() )
+        struct stat st;
+        const bool known = ::stat( swap.path.toLocal8Bit().constData(), &st ) == 0;
+        if ( swap.isFile ? ( known && filesystemNumbers.contains( deviceNumber( st.st_dev ) ) )
+                         : ( ( known && deviceNumber( st.st_rdev ) == number )
+                             || canonicalDevicePath( swap.path ) == node.path() ) )
         {
-            goodNews.append( news );
+            node.swaps.append( swap.path );
         }
     }
 
-    Calamares::JobResult ok = Calamares::JobResult::ok();
-    ok.setMessage( tr( "Cleared all mounts for %1" ).arg( m_device->deviceNode() ) );
-    ok.setDetails( goodNews.join( "\n" ) );
-
-    cDebug() << "ClearMountsJob finished. Here's what was done:\n" << goodNews.join( "\n" );
+    const int index = m_nodes.count();
+    m_nodes.append( node );
+    m_index.insert( name, index );
 
-    return ok;
+    const auto holders = QDir( sys + QStringLiteral( "/holders" ) ).entryList( QDir::Dirs | QDir::NoDotAndDotDot );
+    for ( const QString& holder : holders )
+    {
+        const int h = add( holder );
+        m_nodes[ index ].holders.append( h );
+    }
+    return index;
 }
 
+QStringList
+BlockTree::devices() const
+{
+    QStringList paths;
+    for ( const auto& node : m_nodes )
+    {
+        paths.append( node.path() );
+    }
+    return paths;
+}
 
-QString
-ClearMountsJob::tryUmount( const QString& partPath )
+QHash< QString, QVector< int > >
+BlockTree::volumeGroups() const
 {
-    QProcess process;
-    process.start( "umount", { partPath } );
-    process.waitForFinished();
-    if ( process.exitCode() == 0 )
+    QHash< QString, QVector< int > > groups;
+    for ( int i = 0; i < m_nodes.count(); ++i )
     {
-        return QString( "Successfully unmounted %1." ).arg( partPath );
+        if ( m_nodes[ i ].isLvm() )
+        {
+            groups[ volumeGroupName( m_nodes[ i ].dmName ) ].append( i );
+        }
     }
+    return groups;
+}
 
-    process.start( "swapoff", { partPath } );
-    process.waitForFinished();
-    if ( process.exitCode() == 0 )
+void
+BlockTree::bottomUp( int index,
+                     const QHash< QString, QVector< int > >& groups,
+                     QSet< int >& done,
+                     QVector< int >& order ) const
+{
+    if ( done.contains( index ) )
     {
-        return QString( "Successfully disabled swap %1." ).arg( partPath );
+        return;
     }
+    done.insert( index );
 
-    return QString();
+    const BlockNode& node = m_nodes[ index ];
+    // Fedora live images use /dev/mapper/live-* internally. We must not
+    // unmount those devices, because they are used by the live image and
+    // because we need /dev/mapper/live-base in the unpackfs module.
+    if ( node.dmName.startsWith( QStringLiteral( "live-" ) ) )
+    {
+        cDebug() << "Leaving live image device" << node.dmName << "alone.";
+        return;
+    }
+    for ( int h : node.holders )
+    {
+        if ( m_nodes[ h ].isLvm() && !node.isLvm() )
+        {
+            for ( int lv : groups.value( volumeGroupName( m_nodes[ h ].dmName ) ) )
+            {
+                bottomUp( lv, groups, done, order );
+            }
+        }
+        bottomUp( h, groups, done, order );
+    }
+    order.append( index );
 }
 
-
-QString
-ClearMountsJob::tryClearSwap( const QString& partPath )
+QStringList
+BlockTree::teardown() const
 {
-    QProcess process;
-    process.start( "blkid", { "-s", "UUID", "-o", "value", partPath } );
-    process.waitForFinished();
-    QString swapPartUuid = QString::fromLocal8Bit( process.readAllStandardOutput() ).simplified();
-    if ( process.exitCode() != 0 || swapPartUuid.isEmpty() )
+    // Holders come before the devices they are built on
+    const auto groups = volumeGroups();
+    QSet< int > done;
+    QVector< int > order;
+    for ( int root : m_roots )
     {
-        return QString();
+        bottomUp( root, groups, done, order );
     }
 
-    process.start( "mkswap", { "-U", swapPartUuid, partPath } );
-    process.waitForFinished();
-    if ( process.exitCode() != 0 )
+    QStringList news;
+    // Swap files keep their filesystem busy, so they go first
+    for ( int index : qAsConst( order ) )
     {
-        return QString();
+        for ( const QString& swap : m_nodes[ index ].swaps )
+        {
+            if ( ::swapoff( swap.toLocal8Bit().constData() ) == 0 )
+            {
+                news.append( QString( "Successfully disabled swap %1." ).arg( swap ) );
+            }
+            else
+            {
+                cWarning() << "Could not disable swap" << swap << std::strerror( errno );
+            }
+        }
     }
 
-    return QString( "Successfully cleared swap %1." ).arg( partPath );
+    // A filesystem on one device may be mounted below one on another
+    // device, so the mounts of all the devices are unmounted together.
+    QStringList mountPoints;
+    QHash< QString, QString > mountDevices;
+    for ( int index : qAsConst( order ) )
+    {
+        for ( const QString& mountPoint : m_nodes[ index ].mountPoints )
+        {
+            mountPoints.append( mountPoint );
+            mountDevices.insert( mountPoint, m_nodes[ index ].path() );
+        }
+    }
+    for ( const QString& mountPoint : unmountOrder( mountPoints ) )
+    {
+        if ( ::umount2( mountPoint.toLocal8Bit().constData(), 0 ) == 0 )
+        {
+            news.append(
+                QString( "Successfully unmounted %1 from %2." ).arg( mountDevices.value( mountPoint ), mountPoint ) );
+        }
+        else
+        {
+            cWarning() << "Could not unmount" << mountPoint << std::strerror( errno );
+        }
+    }
+
+    // All the logical volumes of a group come before its physical volumes,
+    // so the group is deactivated after the last of its logical volumes.
+    QHash< QString, int > remaining;
+    for ( auto it = groups.cbegin(); it != groups.cend(); ++it )
+    {
+        remaining.insert( it.key(), it.value().count() );
+    }
+    QProcess process;
+    for ( int index : qAsConst( order ) )
+    {
+        const BlockNode& node = m_nodes[ index ];
+        if ( node.isLvm() )
+        {
+            const QString vgName = volumeGroupName( node.dmName );
+            if ( --remaining[ vgName ] == 0 )
+            {
+                process.start( "vgchange", { "-an", vgName } );
+                process.waitForFinished();
+                if ( process.exitCode() == 0 )
+                {
+                    news.append( QString( "Successfully disabled volume group %1." ).arg( vgName ) );
+                }
+            }
+        }
+        else if ( node.isCrypt() )
+        {
+            process.start( "cryptsetup", { "close", node.dmName } );
+            process.waitForFinished();
+            if ( process.exitCode() == 0 )
+            {
+                news.append( QString( "Successfully closed mapper device %1." ).arg( node.dmName ) );
+            }
+        }
+    }
+    return news;
 }
 
+}  // namespace
 
-QString
-ClearMountsJob::tryCryptoClose( const QString& mapperPath )
+Calamares::JobResult
+ClearMountsJob::exec()
 {
+    QString deviceName = m_device->deviceNode().split( '/' ).last();
+    const BlockTree tree( deviceName );
+    // Only wait for udev on the devices that are torn down here
+    CalamaresUtils::Partition::Syncer s( tree.devices() );
+
+    QStringList goodNews;
     QProcess process;
-    process.start( "cryptsetup", { "close", mapperPath } );
+
+    // Build a list of partitions of type 82 (Linux swap / Solaris).
+    // We then need to clear them just in case they contain something resumable from a
+    // previous suspend-to-disk.
+    QStringList swapPartitions;
+    process.start( "sfdisk", { "-d", m_device->deviceNode() } );
     process.waitForFinished();
-    if ( process.exitCode() == 0 )
+    // Sample output:
+    //    % sudo sfdisk -d /dev/sda
+    //    label: dos
+    //    label-id: 0x000ced89
+    //    device: /dev/sda
+    //    unit: sectors
+
+    //    /dev/sda1 : start=          63, size=    29329345, type=83, bootable
+    //    /dev/sda2 : start=    29331456, size=     2125824, type=82
+
+    swapPartitions = QString::fromLocal8Bit( process.readAllStandardOutput() ).split( '\n' );
+    swapPartitions = swapPartitions.filter( "type=82" );
+    for ( QStringList::iterator it = swapPartitions.begin(); it != swapPartitions.end(); ++it )
     {
-        return QString( "Successfully closed mapper device %1." ).arg( mapperPath );
+        *it = ( *it ).simplified().split( ' ' ).first();
     }
 
-    return QString();
+    goodNews.append( tree.teardown() );
+
+    for ( const QString& p : qAsConst( swapPartitions ) )
+    {
+        QString news = tryClearSwap( p );
+        if ( !news.isEmpty() )
+        {
+            goodNews.append( news );
+        }
+    }
+
+    Calamares::JobResult ok = Calamares::JobResult::ok();
+    ok.setMessage( tr( "Cleared all mounts for %1" ).arg( m_device->deviceNode() ) );
+    ok.setDetails( goodNews.join( "\n" ) );
+
+    cDebug() << "ClearMountsJob finished. Here's what was done:\n" << goodNews.join( "\n" );
+
+    return ok;
 }
 
 
-QStringList
-ClearMountsJob::getCryptoDevices() const
+QString
+ClearMountsJob::tryClearSwap( const QString& partPath )
 {
-    QDir mapperDir( "/dev/mapper" );
-    const QFileInfoList fiList = mapperDir.entryInfoList( QDir::Files );
-    QStringList list;
+    const QString swapPartUuid = PartUtils::probeFilesystem( partPath ).uuid;
+    if ( swapPartUuid.isEmpty() )
+    {
+        return QString();
+    }
+
     QProcess process;
-    for ( const QFileInfo& fi : fiList )
+    process.start( "mkswap", { "-U", swapPartUuid, partPath } );
+    process.waitForFinished();
+    if ( process.exitCode() != 0 )
     {
-        QString baseName = fi.baseName();
-        // Fedora live images use /dev/mapper/live-* internally. We must not
-        // unmount those devices, because they are used by the live image and
-        // because we need /dev/mapper/live-base in the unpackfs module.
-        if ( baseName == "control" || baseName.startsWith( "live-" ) )
-        {
-            continue;
-        }
-        list.append( fi.absoluteFilePath() );
+        return QString();
     }
-    return list;
+
+    return QString( "Successfully cleared swap %1." ).arg( partPath );
 }
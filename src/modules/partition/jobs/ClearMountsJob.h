@@ -12,11 +12,36 @@
 
 #include "Job.h"
 
+#include <QList>
+#include <QString>
+
 class Device;
 
+/// @brief A line of /proc/self/mountinfo (used by ClearMountsJob, here for tests)
+struct MountEntry
+{
+    QString deviceNumber;  ///< e.g. "8:1"
+    QString source;  ///< e.g. "/dev/sda1"
+    QString mountPoint;
+};
+
+/// @brief A line of /proc/swaps (used by ClearMountsJob, here for tests)
+struct SwapEntry
+{
+    QString path;
+    bool isFile = false;
+};
+
 /**
  * This job tries to free all mounts for the given device, so partitioning
  * operations can proceed.
+ *
+ * The block devices that sit on top of the device and its partitions
+ * (LUKS containers, LVM logical volumes, ..) are found in sysfs, and
+ * torn down top-first: swap is switched off and filesystems unmounted
+ * (directly, not through umount(8) and swapoff(8)), LVM volume groups
+ * deactivated and LUKS containers closed. Stacks that do not share
+ * any block device are torn down at the same time.
  */
 class ClearMountsJob : public Calamares::Job
 {
@@ -28,10 +53,7 @@ public:
     Calamares::JobResult exec() override;
 
 private:
-    QString tryUmount( const QString& partPath );
     QString tryClearSwap( const QString& partPath );
-    QString tryCryptoClose( const QString& mapperPath );
-    QStringList getCryptoDevices() const;
     Device* m_device;
 };
 
@@ -13,6 +13,7 @@
 
 #include "partition/PartitionIterator.h"
 #include "utils/Logger.h"
+#include "utils/Units.h"
 
 // KPMcore
 #include <kpmcore/core/device.h>
@@ -23,8 +24,22 @@
 #include <kpmcore/util/report.h>
 
 // Qt
+#include <QFile>
 #include <QProcess>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#if defined( Q_OS_LINUX )
+#include <linux/fs.h>
+#endif
+
 using CalamaresUtils::Partition::PartitionIterator;
 
 CreatePartitionTableJob::CreatePartitionTableJob( Device* device, PartitionTable::TableType type )
@@ -44,6 +59,13 @@ CreatePartitionTableJob::prettyName() const
 QString
 CreatePartitionTableJob::prettyDescription() const
 {
+    if ( m_discard != Discard::None )
+    {
+        return tr( "Discard all data on <strong>%2</strong> (%3) and create new <strong>%1</strong> partition table." )
+            .arg( PartitionTable::tableTypeToName( m_type ).toUpper() )
+            .arg( m_device->deviceNode() )
+            .arg( m_device->name() );
+    }
     return tr( "Create new <strong>%1</strong> partition table on <strong>%2</strong> (%3)." )
         .arg( PartitionTable::tableTypeToName( m_type ).toUpper() )
         .arg( m_device->deviceNode() )
@@ -91,6 +113,16 @@ CreatePartitionTableJob::exec()
         cDebug() << Logger::SubEntry << "mount output:\n" << Logger::NoQuote << mount.readAllStandardOutput();
     }
 
+    if ( m_discard != Discard::None )
+    {
+        discardDevice();
+        if ( isCancelled() )
+        {
+            return Calamares::JobResult::error( message, tr( "The installation was cancelled." ) );
+        }
+        beginPhase( QString(), 0.1 );
+    }
+
     CreatePartitionTableOperation op( *m_device, table );
     op.setStatus( Operation::StatusRunning );
 
@@ -102,6 +134,61 @@ CreatePartitionTableJob::exec()
     return Calamares::JobResult::error( message, report.toText() );
 }
 
+void
+CreatePartitionTableJob::discardDevice()
+{
+    using namespace CalamaresUtils::Units;
+
+    // Most of the time goes to the discard, the table itself is quick
+    beginPhase( tr( "Discarding the data on %1." ).arg( m_device->deviceNode() ), 0.9 );
+#if defined( Q_OS_LINUX )
+    // Exclusive, so that nothing that still uses the device gets its blocks discarded
+    const QByteArray node = QFile::encodeName( m_device->deviceNode() );
+    const int fd = ::open( node.constData(), O_WRONLY | O_EXCL | O_CLOEXEC );
+    if ( fd < 0 )
+    {
+        cWarning() << "Could not open" << m_device->deviceNode() << "to discard it:" << std::strerror( errno );
+        return;
+    }
+
+    uint64_t size = 0;
+    if ( ::ioctl( fd, BLKGETSIZE64, &size ) != 0 )
+    {
+        cWarning() << "Could not get the size of" << m_device->deviceNode() << ':' << std::strerror( errno );
+        size = 0;
+    }
+
+    // In pieces, for progress and so that a cancellation does not wait
+    // for the whole disk; a piece takes well under a second on most disks.
+    constexpr uint64_t piece = uint64_t( 1_GiB );
+    unsigned long request = m_discard == Discard::Secure ? BLKSECDISCARD : BLKDISCARD;
+    uint64_t offset = 0;
+    while ( offset < size && !isCancelled() )
+    {
+        uint64_t range[ 2 ] = { offset, std::min( piece, size - offset ) };
+        if ( ::ioctl( fd, request, range ) != 0 )
+        {
+            const int error = errno;
+            if ( request == BLKSECDISCARD && offset == 0 && ( error == EOPNOTSUPP || error == EINVAL ) )
+            {
+                cWarning() << "Device" << m_device->deviceNode() << "has no secure discard, using plain discard.";
+                request = BLKDISCARD;
+                continue;
+            }
+            cWarning() << "Discard of" << m_device->deviceNode() << "stopped at" << offset << ':'
+                       << std::strerror( error );
+            break;
+        }
+        offset += range[ 1 ];
+        setPhaseProgress( qreal( offset ) / qreal( size ) );
+    }
+    ::close( fd );
+    cDebug() << "Discarded" << offset << "of" << size << "bytes on" << m_device->deviceNode();
+#else
+    cWarning() << "Discarding" << m_device->deviceNode() << "is only supported on Linux.";
+#endif
+}
+
 void
 CreatePartitionTableJob::updatePreview()
 {
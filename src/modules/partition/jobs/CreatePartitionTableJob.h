@@ -29,6 +29,14 @@ class CreatePartitionTableJob : public Calamares::Job
 {
     Q_OBJECT
 public:
+    /// @brief Whether to discard the whole device before creating the table
+    enum class Discard
+    {
+        None,
+        Plain,  ///< BLKDISCARD, the device may keep the old data around
+        Secure  ///< BLKSECDISCARD, falls back to BLKDISCARD if unsupported
+    };
+
     CreatePartitionTableJob( Device* device, PartitionTable::TableType type );
     QString prettyName() const override;
     QString prettyDescription() const override;
@@ -38,11 +46,22 @@ public:
     void updatePreview();
     Device* device() const { return m_device; }
 
+    /** @brief Discard all the blocks of the device first
+     *
+     * This tells a solid-state disk that the old data is no longer
+     * needed, which is quicker than letting the filesystems trim it
+     * later, piece by piece. Failure to discard is not an error.
+     */
+    void setDiscard( Discard discard ) { m_discard = discard; }
+    Discard discard() const { return m_discard; }
+
 private:
     CalamaresUtils::Partition::KPMManager m_kpmcore;
     Device* m_device;
     PartitionTable::TableType m_type;
+    Discard m_discard = Discard::None;
     PartitionTable* createTable();
+    void discardDevice();
 };
 
 #endif /* CREATEPARTITIONTABLEJOB_H */
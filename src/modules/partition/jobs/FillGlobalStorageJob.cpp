@@ -11,7 +11,9 @@
 
 #include "FillGlobalStorageJob.h"
 
+#include "Config.h"
 #include "core/KPMHelpers.h"
+#include "core/PartUtils.h"
 #include "core/PartitionInfo.h"
 
 #include "Branding.h"
@@ -20,6 +22,7 @@
 #include "partition/FileSystem.h"
 #include "partition/Global.h"
 #include "partition/PartitionIterator.h"
+#include "partition/Sync.h"
 #include "utils/Logger.h"
 
 #include <kpmcore/core/device.h>
@@ -29,6 +32,7 @@
 
 #include <QDebug>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
 #include <QProcess>
 
@@ -38,17 +42,69 @@ using CalamaresUtils::Partition::userVisibleFS;
 
 typedef QHash< QString, QString > UuidForPartitionHash;
 
+/** @brief The UUIDs that udev knows, by (canonical) device node
+ *
+ * udev keeps a symlink in /dev/disk/by-uuid/ for each filesystem
+ * and LUKS container that it has seen, so this reads them all in
+ * one pass, without running a command for each partition.
+ */
+static UuidForPartitionHash
+findSystemUuids()
+{
+    UuidForPartitionHash hash;
+    QDir dir( QStringLiteral( "/dev/disk/by-uuid" ) );
+    for ( const auto& fi : dir.entryInfoList( QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot ) )
+    {
+        const QString target = fi.symLinkTarget();
+        if ( !target.isEmpty() )
+        {
+            hash.insert( target, fi.fileName() );
+        }
+    }
+    return hash;
+}
+
+/// @brief The UUID of the device at @p path, if udev knows it
+static QString
+systemUuid( const UuidForPartitionHash& systemUuids, const QString& path )
+{
+    if ( path.isEmpty() )
+    {
+        return QString();
+    }
+    const QString node = QFileInfo( path ).canonicalFilePath();
+    return node.isEmpty() ? QString() : systemUuids.value( node );
+}
+
 static UuidForPartitionHash
-findPartitionUuids( QList< Device* > devices )
+findPartitionUuids( QList< Device* > devices, const UuidForPartitionHash& systemUuids )
 {
     UuidForPartitionHash hash;
+    int asked = 0;
     foreach ( Device* device, devices )
     {
         for ( auto it = PartitionIterator::begin( device ); it != PartitionIterator::end( device ); ++it )
         {
             Partition* p = *it;
             QString path = p->partitionPath();
-            QString uuid = p->fileSystem().readUUID( p->partitionPath() );
+            // An open LUKS container has the UUID of the filesystem inside it
+            QString fsPath = path;
+            if ( p->fileSystem().type() == FileSystem::Luks )
+            {
+                const auto& luksFs = dynamic_cast< const FS::luks& >( p->fileSystem() );
+                if ( luksFs.innerFS() && !luksFs.mapperName().isEmpty() )
+                {
+                    fsPath = luksFs.mapperName();
+                }
+            }
+
+            QString uuid = systemUuid( systemUuids, fsPath );
+            if ( uuid.isEmpty() && QFileInfo::exists( path ) )
+            {
+                // Not (yet) seen by udev, so ask the filesystem tools
+                uuid = p->fileSystem().readUUID( path );
+                ++asked;
+            }
             hash.insert( path, uuid );
         }
     }
@@ -57,6 +113,10 @@ findPartitionUuids( QList< Device* > devices )
     {
         cDebug() << "No UUIDs found for existing partitions.";
     }
+    else
+    {
+        cDebug() << "Found UUIDs for" << hash.count() << "partitions," << asked << "not from udev.";
+    }
     return hash;
 }
 
@@ -78,10 +138,60 @@ getLuksUuid( const QString& path )
 }
 
 
-static QVariant
-mapForPartition( Partition* partition, const QString& uuid )
+/// @brief The first line of a sysfs attribute of block device @p disk, or empty
+static QString
+readQueueAttribute( const QString& disk, const char* attribute )
+{
+    QFile f( QStringLiteral( "/sys/block/%1/queue/%2" ).arg( disk, attribute ) );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        return QString();
+    }
+    return QString::fromLatin1( f.readLine() ).trimmed();
+}
+
+/** @brief The queue attributes of the disk @p device, from sysfs
+ *
+ * These are the same for all the partitions on a disk, so they are
+ * read once for each device and then copied into each partition map:
+ *  - *rotational* (bool) false for SSDs and other flash storage,
+ *  - *discard* (bool) true if the disk supports discard (TRIM),
+ *  - *zoned* (string) "none", "host-aware" or "host-managed",
+ *  - *deviceClass* (string) see PartUtils::deviceClass().
+ * If sysfs does not know the device, the map is empty.
+ */
+static QVariantMap
+diskAttributes( const Device* device )
 {
     QVariantMap map;
+    const QString disk = QFileInfo( device->deviceNode() ).fileName();
+    const QString rotational = readQueueAttribute( disk, "rotational" );
+    if ( disk.isEmpty() || rotational.isEmpty() )
+    {
+        return map;
+    }
+    map[ "rotational" ] = rotational != QStringLiteral( "0" );
+    map[ "discard" ] = readQueueAttribute( disk, "discard_max_bytes" ).toULongLong() > 0;
+    const QString zoned = readQueueAttribute( disk, "zoned" );
+    map[ "zoned" ] = zoned.isEmpty() ? QStringLiteral( "none" ) : zoned;
+    map[ "deviceClass" ] = PartUtils::deviceClass( device->deviceNode() );
+    return map;
+}
+
+/** @brief The GS map for @p partition
+ *
+ * The @p disk attributes (see diskAttributes()) are copied in; the
+ * @p mountOptions (by filesystem name) are from the device-class profile
+ * of the disk, and become *extraMountOptions* for fstab.
+ */
+static QVariant
+mapForPartition( Partition* partition,
+                 const QString& uuid,
+                 const UuidForPartitionHash* systemUuids,
+                 const QVariantMap& disk,
+                 const QVariantMap& mountOptions )
+{
+    QVariantMap map = disk;
     map[ "device" ] = partition->partitionPath();
     map[ "partlabel" ] = partition->label();
     map[ "partuuid" ] = partition->uuid();
@@ -98,6 +208,11 @@ mapForPartition( Partition* partition, const QString& uuid )
     {
         map[ "fs" ] = untranslatedFS( dynamic_cast< FS::luks& >( partition->fileSystem() ).innerFS() );
     }
+    const QString extraMountOptions = mountOptions.value( map[ "fs" ].toString() ).toString();
+    if ( !extraMountOptions.isEmpty() )
+    {
+        map[ "extraMountOptions" ] = extraMountOptions;
+    }
     map[ "uuid" ] = uuid;
     map[ "claimed" ] = PartitionInfo::format( partition );  // If we formatted it, it's ours
 
@@ -110,7 +225,7 @@ mapForPartition( Partition* partition, const QString& uuid )
         << TR( "parttype", map[ "parttype" ].toString() ) << TR( "partattrs", map[ "partattrs" ].toString() )
         << TR( "mountPoint:", PartitionInfo::mountPoint( partition ) ) << TR( "fs:", map[ "fs" ].toString() )
         << TR( "fsName", map[ "fsName" ].toString() ) << TR( "uuid", uuid )
-        << TR( "claimed", map[ "claimed" ].toString() );
+        << TR( "claimed", map[ "claimed" ].toString() ) << TR( "rotational", map[ "rotational" ].toString() );
 
     if ( partition->roles().has( PartitionRole::Luks ) )
     {
@@ -119,7 +234,11 @@ mapForPartition( Partition* partition, const QString& uuid )
         if ( luksFs )
         {
             map[ "luksMapperName" ] = luksFs->mapperName().split( "/" ).last();
-            map[ "luksUuid" ] = getLuksUuid( partition->partitionPath() );
+            if ( systemUuids )
+            {
+                const QString luksUuid = systemUuid( *systemUuids, partition->partitionPath() );
+                map[ "luksUuid" ] = luksUuid.isEmpty() ? getLuksUuid( partition->partitionPath() ) : luksUuid;
+            }
             map[ "luksPassphrase" ] = luksFs->passphrase();
             deb << TR( "luksMapperName:", map[ "luksMapperName" ].toString() );
         }
@@ -155,8 +274,11 @@ prettyFileSystemFeatures( const QVariantMap& features )
     return list.join( QStringLiteral( ", " ) );
 }
 
-FillGlobalStorageJob::FillGlobalStorageJob( const Config*, QList< Device* > devices, const QString& bootLoaderPath )
-    : m_devices( devices )
+FillGlobalStorageJob::FillGlobalStorageJob( const Config* config,
+                                            QList< Device* > devices,
+                                            const QString& bootLoaderPath )
+    : m_config( config )
+    , m_devices( devices )
     , m_bootLoaderPath( bootLoaderPath )
 {
 }
@@ -173,7 +295,7 @@ FillGlobalStorageJob::prettyDescription() const
 {
     QStringList lines;
 
-    const auto partitionList = createPartitionList();
+    const auto partitionList = createPartitionList( false );
     for ( const QVariant& partitionItem : partitionList )
     {
         if ( partitionItem.type() == QVariant::Map )
@@ -322,7 +444,9 @@ Calamares::JobResult
 FillGlobalStorageJob::exec()
 {
     Calamares::GlobalStorage* storage = Calamares::JobQueue::instance()->globalStorage();
-    const auto partitions = createPartitionList();
+    // Once udev has caught up with the formatting, it knows (nearly) all the UUIDs
+    CalamaresUtils::Partition::sync();
+    const auto partitions = createPartitionList( true );
     cDebug() << "Saving partition information map to GlobalStorage[\"partitions\"]";
     storage->insert( "partitions", partitions );
     storeFSUse( storage, partitions );
@@ -346,18 +470,28 @@ FillGlobalStorageJob::exec()
 }
 
 QVariantList
-FillGlobalStorageJob::createPartitionList() const
+FillGlobalStorageJob::createPartitionList( bool withUuids ) const
 {
-    UuidForPartitionHash hash = findPartitionUuids( m_devices );
+    const UuidForPartitionHash systemUuids = withUuids ? findSystemUuids() : UuidForPartitionHash();
+    const UuidForPartitionHash hash
+        = withUuids ? findPartitionUuids( m_devices, systemUuids ) : UuidForPartitionHash();
     QVariantList lst;
     cDebug() << "Building partition information map";
     for ( auto device : m_devices )
     {
         cDebug() << Logger::SubEntry << "partitions on" << device->deviceNode();
+        const QVariantMap disk = diskAttributes( device );
+        const QVariantMap mountOptions = m_config
+            ? m_config->deviceClassProfile( PartUtils::deviceClass( device->deviceNode() ) ).mountOptions
+            : QVariantMap();
         for ( auto it = PartitionIterator::begin( device ); it != PartitionIterator::end( device ); ++it )
         {
             // Debug-logging is done when creating the map
-            lst << mapForPartition( *it, hash.value( ( *it )->partitionPath() ) );
+            lst << mapForPartition( *it,
+                                    hash.value( ( *it )->partitionPath() ),
+                                    withUuids ? &systemUuids : nullptr,
+                                    disk,
+                                    mountOptions );
         }
     }
     return lst;
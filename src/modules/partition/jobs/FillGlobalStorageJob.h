@@ -39,10 +39,16 @@ public:
     Calamares::JobResult exec() override;
 
 private:
+    const Config* m_config;  ///< For the device-class profiles; may be nullptr
     QList< Device* > m_devices;
     QString m_bootLoaderPath;
 
-    QVariantList createPartitionList() const;
+    /** @brief The "partitions" list for GlobalStorage
+     *
+     * Finding the UUIDs (@p withUuids) is only worthwhile once
+     * the partitions exist, so not for the description.
+     */
+    QVariantList createPartitionList( bool withUuids ) const;
     QVariant createBootLoaderMap() const;
 };
 
@@ -55,10 +55,12 @@ FormatPartitionJob::prettyDescription() const
 QString
 FormatPartitionJob::prettyStatusMessage() const
 {
-    return tr( "Formatting partition %1 with "
-               "file system %2." )
-        .arg( m_partition->partitionPath() )
-        .arg( userVisibleFS( m_partition->fileSystem() ) );
+    const QString message = tr( "Formatting partition %1 with "
+                                "file system %2." )
+                                .arg( m_partition->partitionPath() )
+                                .arg( userVisibleFS( m_partition->fileSystem() ) );
+    const QString details = progressDetails();
+    return details.isEmpty() ? message : message + QStringLiteral( " (" ) + details + ')';
 }
 
 
@@ -68,6 +70,8 @@ FormatPartitionJob::exec()
     Report report( nullptr );  // Root of the report tree, no parent
     CreateFileSystemOperation op( *m_device, *m_partition, m_partition->fileSystem().type() );
     op.setStatus( Operation::StatusRunning );
+    // mkfs tools report no byte counts; the bar moves per step
+    trackProgress( op, 0 );
 
     QString message = tr( "The installer failed to format partition %1 on disk '%2'." )
                           .arg( m_partition->partitionPath(), m_device->name() );
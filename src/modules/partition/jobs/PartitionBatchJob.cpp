@@ -0,0 +1,84 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "PartitionBatchJob.h"
+
+#include "utils/Logger.h"
+
+PartitionBatchJob::PartitionBatchJob( const QString& deviceNode, const Calamares::JobList& jobs )
+    : m_deviceNode( deviceNode )
+    , m_jobs( jobs )
+{
+}
+
+int
+PartitionBatchJob::getJobWeight() const
+{
+    int weight = 0;
+    for ( const auto& job : m_jobs )
+    {
+        weight += qMax( 1, job->getJobWeight() );
+    }
+    return weight;
+}
+
+QString
+PartitionBatchJob::prettyName() const
+{
+    return tr( "Partitioning %1 (%n operation(s))", nullptr, m_jobs.count() ).arg( m_deviceNode );
+}
+
+QString
+PartitionBatchJob::prettyStatusMessage() const
+{
+    const int current = m_current;
+    if ( current < 0 || current >= m_jobs.count() )
+    {
+        return prettyName();
+    }
+    const auto& job = m_jobs.at( current );
+    const QString phase = job->currentPhase();
+    return phase.isEmpty() ? job->prettyStatusMessage() : phase;
+}
+
+Calamares::JobResult
+PartitionBatchJob::exec()
+{
+    cDebug() << "Running" << m_jobs.count() << "partitioning jobs for" << m_deviceNode << "as one job.";
+    const qreal totalWeight = getJobWeight();
+    for ( int i = 0; i < m_jobs.count(); ++i )
+    {
+        const auto& job = m_jobs.at( i );
+        if ( i > 0 && isCancelled() )
+        {
+            m_current = -1;
+            return Calamares::JobResult::error( prettyName(), tr( "The installation was cancelled." ) );
+        }
+
+        m_current = i;
+        beginPhase( QString(), qMax( 1, job->getJobWeight() ) / totalWeight );
+        job->clearPhases();
+        job->setModuleInstance( moduleInstance() );
+        // The job runs in this thread, but both objects live in the GUI
+        // thread; connect directly, as the JobQueue does.
+        auto connection = connect(
+            job.data(), &Calamares::Job::progress, this, &Job::setPhaseProgress, Qt::DirectConnection );
+        cDebug() << Logger::SubEntry << "Starting job" << job->prettyName();
+        Calamares::JobResult result = job->exec();
+        disconnect( connection );
+        if ( !result )
+        {
+            m_current = -1;
+            return result;
+        }
+        setPhaseProgress( 1.0 );
+    }
+    m_current = -1;
+    return Calamares::JobResult::ok();
+}
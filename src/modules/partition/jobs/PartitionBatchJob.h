@@ -0,0 +1,50 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef PARTITIONBATCHJOB_H
+#define PARTITIONBATCHJOB_H
+
+#include "Job.h"
+
+#include <QString>
+
+#include <atomic>
+
+/** @brief Runs the partitioning jobs for one device as a single job
+ *
+ * The jobs run one after the other, in the thread of this job, and
+ * each one is a phase of it (weighted by the job weights), so the
+ * progress of each operation still shows. The first job that fails
+ * stops the batch, and its error is the error of the batch.
+ *
+ * The JobQueue schedules, times and checkpoints the batch as one job,
+ * instead of doing that for each of the jobs: a partition table that
+ * is half done can not be resumed from anyway.
+ */
+class PartitionBatchJob : public Calamares::Job
+{
+    Q_OBJECT
+public:
+    explicit PartitionBatchJob( const QString& deviceNode, const Calamares::JobList& jobs );
+
+    int getJobWeight() const override;
+    QString prettyName() const override;
+    QString prettyStatusMessage() const override;
+    Calamares::JobResult exec() override;
+
+    /// @brief The jobs in the batch, e.g. for their descriptions
+    const Calamares::JobList& jobs() const { return m_jobs; }
+
+private:
+    QString m_deviceNode;
+    Calamares::JobList m_jobs;
+    std::atomic< int > m_current { -1 };  ///< Index of the running job, -1 when none is
+};
+
+#endif  // PARTITIONBATCHJOB_H
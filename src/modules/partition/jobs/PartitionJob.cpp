@@ -9,6 +9,13 @@
 
 #include "PartitionJob.h"
 
+#include "utils/Units.h"
+
+#include <kpmcore/jobs/job.h>
+#include <kpmcore/ops/operation.h>
+
+#include <QMutexLocker>
+
 PartitionJob::PartitionJob( Partition* partition )
     : m_partition( partition )
 {
@@ -27,3 +34,103 @@ PartitionJob::iprogress( int percent )
     }
     Q_EMIT progress( qreal( percent / 100.0 ) );
 }
+
+void
+PartitionJob::trackProgress( Operation& op, qint64 bytes )
+{
+    {
+        QMutexLocker lock( &m_progressMutex );
+        m_progressTimer.start();
+        m_progressBytes = bytes;
+        m_progressFraction = 0.0;
+        m_stepsDone = 0;
+        m_stepsCurrent = 1;
+        m_stepDescription.clear();
+    }
+
+    // The job object lives in the GUI thread, while the operation runs (and
+    // emits) in the job thread: connect directly, so the progress is handled
+    // while the operation still exists. Using @p op as context drops the
+    // connections when the operation goes away.
+    const int stepsTotal = qMax( 1, op.totalProgress() );
+    connect(
+        &op,
+        &Operation::jobStarted,
+        &op,
+        [ this ]( ::Job* job, Operation* ) {
+            QMutexLocker lock( &m_progressMutex );
+            m_stepsCurrent = job->numSteps();
+            m_stepDescription = job->description();
+        },
+        Qt::DirectConnection );
+    connect(
+        &op,
+        &Operation::jobFinished,
+        &op,
+        [ this, stepsTotal ]( ::Job* job, Operation* ) {
+            int done;
+            {
+                QMutexLocker lock( &m_progressMutex );
+                m_stepsDone += job->numSteps();
+                done = m_stepsDone;
+            }
+            setOperationProgress( qreal( done ) / stepsTotal );
+        },
+        Qt::DirectConnection );
+    connect(
+        &op,
+        &Operation::progress,
+        &op,
+        [ this, stepsTotal ]( int percent ) {
+            qreal steps;
+            {
+                QMutexLocker lock( &m_progressMutex );
+                steps = m_stepsDone + qBound( 0, percent, 100 ) / 100.0 * m_stepsCurrent;
+            }
+            setOperationProgress( steps / stepsTotal );
+        },
+        Qt::DirectConnection );
+}
+
+void
+PartitionJob::setOperationProgress( qreal fraction )
+{
+    fraction = qBound( 0.0, fraction, 1.0 );
+    {
+        QMutexLocker lock( &m_progressMutex );
+        m_progressFraction = fraction;
+    }
+    Q_EMIT progress( fraction );
+}
+
+QString
+PartitionJob::progressDetails() const
+{
+    QMutexLocker lock( &m_progressMutex );
+    if ( !m_progressTimer.isValid() || m_progressFraction >= 1.0 )
+    {
+        return QString();
+    }
+    if ( m_progressBytes <= 0 )
+    {
+        // Steps are no measure of time, so the step is all there is to say
+        return m_stepDescription;
+    }
+    if ( m_progressFraction <= 0.01 )
+    {
+        return QString();
+    }
+    const qint64 elapsed = m_progressTimer.elapsed();
+    if ( elapsed < 5000 )
+    {
+        // Too early for a sensible estimate
+        return QString();
+    }
+
+    const int secondsLeft = int( elapsed * ( 1.0 - m_progressFraction ) / m_progressFraction / 1000 );
+    const QString timeLeft = secondsLeft < 90 ? tr( "about %n second(s) left", nullptr, secondsLeft )
+                                              : tr( "about %n minute(s) left", nullptr, ( secondsLeft + 30 ) / 60 );
+    const qreal mibPerSecond
+        = CalamaresUtils::BytesToMiB( qint64( m_progressBytes * m_progressFraction ) ) * 1000.0 / elapsed;
+    return tr( "%1 MiB/s, %2" ).arg( mibPerSecond, 0, 'f', 1 ).arg( timeLeft );
+}
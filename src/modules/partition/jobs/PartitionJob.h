@@ -14,6 +14,10 @@
 #include "Job.h"
 #include "partition/KPMManager.h"
 
+#include <QElapsedTimer>
+#include <QMutex>
+
+class Operation;
 class Partition;
 
 /**
@@ -36,8 +40,42 @@ public slots:
     void iprogress( int percent );
 
 protected:
+    /** @brief Report the progress of KPMcore operation @p op through progress()
+     *
+     * A KPMcore operation is a series of (KPMcore) jobs, each of which
+     * reports its own percentage; this combines them into the progress
+     * of the whole operation. @p bytes is the amount of data the operation
+     * moves (e.g. the size of the partition for a resize), which is used to
+     * estimate throughput and time left (see progressDetails()). Pass 0
+     * when the tools report no byte counts (e.g. mkfs): then only the
+     * step that is running is reported.
+     *
+     * Call this before executing the operation.
+     */
+    void trackProgress( Operation& op, qint64 bytes );
+
+    /** @brief Throughput and time left of the operation being tracked
+     *
+     * Returns e.g. "42 MiB/s, about 3 minutes left", the description of
+     * the running KPMcore step if there are no bytes to go by, or an empty
+     * string when there is nothing (yet) to say. This is meant for
+     * the job's prettyStatusMessage(), and can be called from any thread.
+     */
+    QString progressDetails() const;
+
     CalamaresUtils::Partition::KPMManager m_kpmcore;
     Partition* m_partition;
+
+private:
+    void setOperationProgress( qreal fraction );
+
+    mutable QMutex m_progressMutex;
+    QElapsedTimer m_progressTimer;
+    qint64 m_progressBytes = 0;
+    qreal m_progressFraction = 0.0;
+    int m_stepsDone = 0;  ///< KPMcore steps of the finished KPMcore jobs
+    int m_stepsCurrent = 1;  ///< KPMcore steps in the running KPMcore job
+    QString m_stepDescription;  ///< Of the running KPMcore job
 };
 
 #endif /* PARTITIONJOB_H */
@@ -55,11 +55,14 @@ ResizePartitionJob::prettyDescription() const
 QString
 ResizePartitionJob::prettyStatusMessage() const
 {
-    return tr( "Resizing %2MiB partition %1 to "
-               "%3MiB." )
-        .arg( partition()->partitionPath() )
-        .arg( ( BytesToMiB( m_oldLastSector - m_oldFirstSector + 1 ) * partition()->sectorSize() ) )
-        .arg( ( BytesToMiB( m_newLastSector - m_newFirstSector + 1 ) * partition()->sectorSize() ) );
+    const QString message
+        = tr( "Resizing %2MiB partition %1 to "
+              "%3MiB." )
+              .arg( partition()->partitionPath() )
+              .arg( ( BytesToMiB( m_oldLastSector - m_oldFirstSector + 1 ) * partition()->sectorSize() ) )
+              .arg( ( BytesToMiB( m_newLastSector - m_newFirstSector + 1 ) * partition()->sectorSize() ) );
+    const QString details = progressDetails();
+    return details.isEmpty() ? message : message + QStringLiteral( " (" ) + details + ')';
 }
 
 
@@ -72,7 +75,8 @@ ResizePartitionJob::exec()
     m_partition->setLastSector( m_oldLastSector );
     ResizeOperation op( *m_device, *m_partition, m_newFirstSector, m_newLastSector );
     op.setStatus( Operation::StatusRunning );
-    connect( &op, &Operation::progress, this, &ResizePartitionJob::iprogress );
+    const qint64 sectors = qMax( m_oldLastSector - m_oldFirstSector, m_newLastSector - m_newFirstSector ) + 1;
+    trackProgress( op, sectors * m_partition->sectorSize() );
 
     QString errorMessage = tr( "The installer failed to resize partition %1 on disk '%2'." )
                                .arg( m_partition->partitionPath() )
@@ -0,0 +1,91 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "ZRamSwapJob.h"
+
+#include "utils/CalamaresUtilsSystem.h"
+#include "utils/Logger.h"
+#include "utils/Units.h"
+
+#include <QFile>
+
+using CalamaresUtils::System;
+
+/// @brief Is there zram swap on the live system already?
+static bool
+hasZRamSwap()
+{
+    QFile swaps( QStringLiteral( "/proc/swaps" ) );
+    if ( !swaps.open( QIODevice::ReadOnly ) )
+    {
+        return false;
+    }
+    return swaps.readAll().contains( "/dev/zram" );
+}
+
+ZRamSwapJob::ZRamSwapJob( qint64 sizeB )
+    : m_sizeB( sizeB )
+{
+}
+
+QString
+ZRamSwapJob::prettyName() const
+{
+    return tr( "Enable compressed swap in RAM for the installation." );
+}
+
+QString
+ZRamSwapJob::prettyStatusMessage() const
+{
+    return tr( "Enabling compressed swap in RAM." );
+}
+
+Calamares::JobResult
+ZRamSwapJob::exec()
+{
+    if ( m_sizeB <= 0 || hasZRamSwap() )
+    {
+        cDebug() << "No zram swap needed on the live system, size" << m_sizeB;
+        return Calamares::JobResult::ok();
+    }
+
+    // The module may be built into the kernel, so a failure here is no reason to stop
+    System::runCommand( { QStringLiteral( "modprobe" ), QStringLiteral( "zram" ) }, std::chrono::seconds( 10 ) );
+
+    const auto sizeMiB = CalamaresUtils::BytesToMiB( m_sizeB );
+    auto r = System::runCommand( { QStringLiteral( "zramctl" ),
+                                   QStringLiteral( "--find" ),
+                                   QStringLiteral( "--size" ),
+                                   QStringLiteral( "%1M" ).arg( sizeMiB ) },
+                                 std::chrono::seconds( 10 ) );
+    const QString device = r.getOutput().trimmed();
+    if ( r.getExitCode() != 0 || !device.startsWith( QStringLiteral( "/dev/zram" ) ) )
+    {
+        cWarning() << "Could not set up a zram device:" << r.getExitCode() << r.getOutput();
+        return Calamares::JobResult::ok();
+    }
+
+    r = System::runCommand( { QStringLiteral( "mkswap" ), device }, std::chrono::seconds( 10 ) );
+    if ( r.getExitCode() == 0 )
+    {
+        // Before any swap on disk, as zram-generator does
+        r = System::runCommand(
+            { QStringLiteral( "swapon" ), QStringLiteral( "--priority" ), QStringLiteral( "100" ), device },
+            std::chrono::seconds( 10 ) );
+    }
+    if ( r.getExitCode() != 0 )
+    {
+        cWarning() << "Could not swap to" << device << ':' << r.getExitCode() << r.getOutput();
+        System::runCommand( { QStringLiteral( "zramctl" ), QStringLiteral( "--reset" ), device },
+                            std::chrono::seconds( 10 ) );
+        return Calamares::JobResult::ok();
+    }
+    cDebug() << "Swapping to" << device << "on the live system," << sizeMiB << "MiB";
+    return Calamares::JobResult::ok();
+}
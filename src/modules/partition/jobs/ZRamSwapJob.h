@@ -0,0 +1,39 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef PARTITION_ZRAMSWAPJOB_H
+#define PARTITION_ZRAMSWAPJOB_H
+
+#include "Job.h"
+
+/**
+ * This job enables compressed swap in RAM (zram) on the **live**
+ * system, so that unpacking the image and installing packages have
+ * some room on machines with little memory. It does nothing if the
+ * live system has zram swap already. The swap stays on after the
+ * installation, until the live system is shut down.
+ *
+ * Failing to set up zram is not an error: the installation goes
+ * on without it.
+ */
+class ZRamSwapJob : public Calamares::Job
+{
+    Q_OBJECT
+public:
+    ZRamSwapJob( qint64 sizeB );
+
+    QString prettyName() const override;
+    QString prettyStatusMessage() const override;
+    Calamares::JobResult exec() override;
+
+private:
+    qint64 m_sizeB;
+};
+
+#endif /* PARTITION_ZRAMSWAPJOB_H */
@@ -80,7 +80,6 @@ AutoMountJobTests::testRunQueue()
     QCOMPARE( progress.count(), 5 );
 }
 
-
 QTEST_GUILESS_MAIN( AutoMountJobTests )
 
 #include "utils/moc-warnings.h"
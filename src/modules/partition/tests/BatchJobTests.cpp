@@ -0,0 +1,127 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "jobs/PartitionBatchJob.h"
+
+#include "utils/Logger.h"
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+#include <thread>
+
+class BatchJobTests : public QObject
+{
+    Q_OBJECT
+public:
+    BatchJobTests();
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testBatch();
+    void testBatchFails();
+    void testBatchThread();
+};
+
+/// @brief A job that reports half-way progress, and appends its name to a list
+class NamedJob : public Calamares::Job
+{
+public:
+    NamedJob( const QString& name, QStringList& ran, bool fail = false )
+        : m_name( name )
+        , m_ran( ran )
+        , m_fail( fail )
+    {
+    }
+
+    QString prettyName() const override { return m_name; }
+    Calamares::JobResult exec() override
+    {
+        emit progress( 0.5 );
+        m_ran.append( m_name );
+        return m_fail ? Calamares::JobResult::error( m_name ) : Calamares::JobResult::ok();
+    }
+
+private:
+    QString m_name;
+    QStringList& m_ran;
+    bool m_fail;
+};
+
+BatchJobTests::BatchJobTests() {}
+
+void
+BatchJobTests::initTestCase()
+{
+    Logger::setupLogLevel( Logger::LOGDEBUG );
+}
+
+void
+BatchJobTests::testBatch()
+{
+    QStringList ran;
+    PartitionBatchJob batch( QStringLiteral( "/dev/sdz" ),
+                             { Calamares::job_ptr( new NamedJob( "a", ran ) ),
+                               Calamares::job_ptr( new NamedJob( "b", ran ) ) } );
+    QCOMPARE( batch.getJobWeight(), 2 );
+    QSignalSpy progress( &batch, &Calamares::Job::progress );
+    QVERIFY( batch.exec() );
+    QCOMPARE( ran, QStringList( { "a", "b" } ) );
+    // Start, half-way and end of each job
+    QCOMPARE( progress.count(), 6 );
+    QCOMPARE( progress.at( 1 ).first().toDouble(), 0.25 );
+    QCOMPARE( progress.at( 4 ).first().toDouble(), 0.75 );
+    QCOMPARE( progress.last().first().toDouble(), 1.0 );
+}
+
+void
+BatchJobTests::testBatchFails()
+{
+    QStringList ran;
+    PartitionBatchJob batch( QStringLiteral( "/dev/sdz" ),
+                             { Calamares::job_ptr( new NamedJob( "a", ran ) ),
+                               Calamares::job_ptr( new NamedJob( "b", ran, true ) ),
+                               Calamares::job_ptr( new NamedJob( "c", ran ) ) } );
+    const auto result = batch.exec();
+    QVERIFY( !result );
+    QCOMPARE( result.message(), QStringLiteral( "b" ) );
+    QCOMPARE( ran, QStringList( { "a", "b" } ) );  // c does not run after b fails
+}
+
+/* The JobQueue runs jobs in its own thread, while the job objects live
+ * in the GUI thread. The half-way progress of each job must still be
+ * reported while the batch runs, not queued for the GUI thread.
+ */
+void
+BatchJobTests::testBatchThread()
+{
+    QStringList ran;
+    PartitionBatchJob batch( QStringLiteral( "/dev/sdz" ),
+                             { Calamares::job_ptr( new NamedJob( "a", ran ) ),
+                               Calamares::job_ptr( new NamedJob( "b", ran ) ) } );
+    QSignalSpy progress( &batch, &Calamares::Job::progress );
+
+    bool ok = false;
+    std::thread worker( [ &batch, &ok ]() { ok = batch.exec(); } );
+    worker.join();
+
+    QVERIFY( ok );
+    QCOMPARE( ran, QStringList( { "a", "b" } ) );
+    // No event loop has run, so all of these were delivered directly
+    QCOMPARE( progress.count(), 6 );
+    QCOMPARE( progress.at( 1 ).first().toDouble(), 0.25 );
+    QCOMPARE( progress.at( 4 ).first().toDouble(), 0.75 );
+}
+
+QTEST_GUILESS_MAIN( BatchJobTests )
+
+#include "utils/moc-warnings.h"
+
+#include "BatchJobTests.moc"
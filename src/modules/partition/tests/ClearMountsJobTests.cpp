@@ -9,15 +9,23 @@
 
 #include "ClearMountsJobTests.h"
 
+#include "jobs/ClearMountsJob.h"
+
 #include "utils/Logger.h"
 
 #include <QtTest/QtTest>
 
+#include <algorithm>
+
 QTEST_GUILESS_MAIN( ClearMountsJobTests )
 
 
 /* Not exactly public API */
 QStringList getPartitionsForDevice( const QString& deviceName );
+QList< MountEntry > parseMountInfo( const QByteArray& mountInfo );
+QList< SwapEntry > parseSwaps( const QByteArray& swaps );
+QString volumeGroupName( const QString& dmName );
+QStringList unmountOrder( QStringList mountPoints );
 
 QStringList
 getPartitionsForDevice_other( const QString& deviceName )
@@ -58,3 +66,73 @@ ClearMountsJobTests::testFindPartitions()
 
     QCOMPARE( partitions, other_part );
 }
+
+void
+ClearMountsJobTests::testParseMountInfo()
+{
+    const QByteArray mountInfo( "22 1 8:2 / / rw,relatime shared:1 - ext4 /dev/sda2 rw\n"
+                                "25 22 0:21 / /proc rw,nosuid - proc proc rw\n"
+                                "40 22 0:35 /@home /home rw shared:5 master:2 - btrfs /dev/sda3 rw,space_cache\n"
+                                "41 22 253:0 / /mnt/my\\040disk rw - xfs /dev/mapper/vg-data rw\n"
+                                "garbage\n" );
+    const auto mounts = parseMountInfo( mountInfo );
+    QCOMPARE( mounts.count(), 4 );
+    QCOMPARE( mounts[ 0 ].deviceNumber, QStringLiteral( "8:2" ) );
+    QCOMPARE( mounts[ 0 ].source, QStringLiteral( "/dev/sda2" ) );
+    QCOMPARE( mounts[ 0 ].mountPoint, QStringLiteral( "/" ) );
+    QCOMPARE( mounts[ 1 ].mountPoint, QStringLiteral( "/proc" ) );
+    // Optional fields before the separator
+    QCOMPARE( mounts[ 2 ].deviceNumber, QStringLiteral( "0:35" ) );
+    QCOMPARE( mounts[ 2 ].source, QStringLiteral( "/dev/sda3" ) );
+    QCOMPARE( mounts[ 2 ].mountPoint, QStringLiteral( "/home" ) );
+    // Escaped space
+    QCOMPARE( mounts[ 3 ].mountPoint, QStringLiteral( "/mnt/my disk" ) );
+    QCOMPARE( mounts[ 3 ].source, QStringLiteral( "/dev/mapper/vg-data" ) );
+
+    // This system's own mounts can be parsed, if there is /proc
+    QFile f( "/proc/self/mountinfo" );
+    if ( f.open( QIODevice::ReadOnly ) )
+    {
+        const auto own = parseMountInfo( f.readAll() );
+        QVERIFY( !own.isEmpty() );
+        QVERIFY( std::any_of( own.cbegin(), own.cend(), []( const MountEntry& m ) { return m.mountPoint == "/"; } ) );
+    }
+}
+
+void
+ClearMountsJobTests::testParseSwaps()
+{
+    const QByteArray swaps( "Filename\t\t\t\tType\t\tSize\t\tUsed\t\tPriority\n"
+                            "/dev/sda5                               partition\t8388604\t\t0\t\t-2\n"
+                            "/swap\\040file                          file\t\t1048572\t\t0\t\t-3\n" );
+    const auto entries = parseSwaps( swaps );
+    QCOMPARE( entries.count(), 2 );
+    QCOMPARE( entries[ 0 ].path, QStringLiteral( "/dev/sda5" ) );
+    QVERIFY( !entries[ 0 ].isFile );
+    QCOMPARE( entries[ 1 ].path, QStringLiteral( "/swap file" ) );
+    QVERIFY( entries[ 1 ].isFile );
+
+    QVERIFY( parseSwaps( QByteArray() ).isEmpty() );
+}
+
+void
+ClearMountsJobTests::testVolumeGroupName()
+{
+    QCOMPARE( volumeGroupName( "vg-root" ), QStringLiteral( "vg" ) );
+    QCOMPARE( volumeGroupName( "fedora--vg-swap" ), QStringLiteral( "fedora-vg" ) );
+    QCOMPARE( volumeGroupName( "vg-lv--with--dashes" ), QStringLiteral( "vg" ) );
+    QCOMPARE( volumeGroupName( "a--b--c-d" ), QStringLiteral( "a-b-c" ) );
+    // Not an LVM name
+    QCOMPARE( volumeGroupName( "luks1234" ), QString() );
+}
+
+void
+ClearMountsJobTests::testUnmountOrder()
+{
+    // Mount points of different devices, in the order the devices were found
+    const QStringList mountPoints { "/mnt", "/mnt/home", "/media/usb", "/mnt/boot/efi", "/mnt/boot", "/mnt/home" };
+    const QStringList order = unmountOrder( mountPoints );
+    QCOMPARE( order, QStringList( { "/mnt/boot/efi", "/mnt/home", "/media/usb", "/mnt/boot", "/mnt" } ) );
+    QCOMPARE( unmountOrder( { "/", "/mnt/" } ), QStringList( { "/mnt/", "/" } ) );
+    QVERIFY( unmountOrder( {} ).isEmpty() );
+}
@@ -20,6 +20,10 @@ public:
 
 private Q_SLOTS:
     void testFindPartitions();
+    void testParseMountInfo();
+    void testParseSwaps();
+    void testVolumeGroupName();
+    void testUnmountOrder();
 };
 
 #endif
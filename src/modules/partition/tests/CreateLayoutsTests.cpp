@@ -9,6 +9,7 @@
 
 #include "CreateLayoutsTests.h"
 
+#include "core/PartUtils.h"
 #include "core/PartitionLayout.h"
 
 #include "JobQueue.h"
@@ -21,9 +22,6 @@
 
 using namespace CalamaresUtils::Units;
 
-class PartitionTable;
-class SmartStatus;
-
 QTEST_GUILESS_MAIN( CreateLayoutsTests )
 
 static CalamaresUtils::Partition::KPMManager* kpmcore = nullptr;
@@ -125,36 +123,65 @@ CreateLayoutsTests::testMixedSizePartition()
     QCOMPARE( partitions[ 2 ]->length(), ( ( 5_GiB - 5_MiB ) / 2 ) / LOGICAL_SIZE );
 }
 
-#ifdef WITH_KPMCORE4API
-// TODO: Get a clean way to instantiate a test Device from KPMCore
-class DevicePrivate
-{
-public:
-    QString m_Name;
-    QString m_DeviceNode;
-    qint64 m_LogicalSectorSize;
-    qint64 m_TotalLogical;
-    PartitionTable* m_PartitionTable;
-    QString m_IconName;
-    std::shared_ptr< SmartStatus > m_SmartStatus;
-    Device::Type m_Type;
-};
-
-TestDevice::TestDevice( const QString& name, const qint64 logicalSectorSize, const qint64 totalLogicalSectors )
-    : Device( std::make_shared< DevicePrivate >(),
-              name,
-              QString( "node" ),
-              logicalSectorSize,
-              totalLogicalSectors,
-              QString(),
-              Device::Type::Unknown_Device )
+void
+CreateLayoutsTests::testAlignedPartitions()
 {
+    PartitionLayout layout = PartitionLayout();
+    TestDevice dev( QString( "test" ), LOGICAL_SIZE, 5_GiB / LOGICAL_SIZE );
+    PartitionRole role( PartitionRole::Role::Any );
+    QList< Partition* > partitions;
+
+    // Neither the start nor the size of /boot is a multiple of 4MiB
+    if ( !layout.addEntry( { FileSystem::Type::Ext4, QString( "/boot" ), QString( "5MiB" ) } ) )
+    {
+        QFAIL( qPrintable( "Unable to create /boot partition" ) );
+    }
+    if ( !layout.addEntry( { FileSystem::Type::Ext4, QString( "/" ), QString( "100%" ) } ) )
+    {
+        QFAIL( qPrintable( "Unable to create / partition" ) );
+    }
+
+    const qint64 align = 4_MiB / LOGICAL_SIZE;
+    const qint64 lastSector = dev.totalLogical() - 1;
+    partitions = layout.createPartitions(
+        static_cast< Device* >( &dev ), 2048, lastSector, nullptr, nullptr, role, align );
+
+    QCOMPARE( partitions.count(), 2 );
+    QCOMPARE( partitions[ 0 ]->firstSector(), align );
+    QCOMPARE( partitions[ 0 ]->length(), 2 * align );  // Rounded up to 8MiB
+    QCOMPARE( partitions[ 1 ]->firstSector(), 3 * align );
+    QCOMPARE( partitions[ 1 ]->lastSector(), lastSector );
+
+    // With a max-size, it is rounded down instead, but not below the min-size
+    PartitionLayout capped = PartitionLayout();
+    if ( !capped.addEntry(
+             { FileSystem::Type::Ext4, QString( "/boot" ), QString( "5MiB" ), QString( "4MiB" ), QString( "6MiB" ) } ) )
+    {
+        QFAIL( qPrintable( "Unable to create /boot partition" ) );
+    }
+    if ( !capped.addEntry( { FileSystem::Type::Ext4, QString( "/" ), QString( "100%" ) } ) )
+    {
+        QFAIL( qPrintable( "Unable to create / partition" ) );
+    }
+    partitions = capped.createPartitions(
+        static_cast< Device* >( &dev ), 2048, lastSector, nullptr, nullptr, role, align );
+    QCOMPARE( partitions.count(), 2 );
+    QCOMPARE( partitions[ 0 ]->length(), align );
+    QCOMPARE( partitions[ 1 ]->firstSector(), 2 * align );
 }
-#else
-TestDevice::TestDevice( const QString& name, const qint64 logicalSectorSize, const qint64 totalLogicalSectors )
-    : Device( name, QString( "node" ), logicalSectorSize, totalLogicalSectors, QString(), Device::Type::Unknown_Device )
+
+void
+CreateLayoutsTests::testAlignmentHints()
 {
+    // No hints, or small ones, give 1MiB
+    QCOMPARE( PartUtils::alignmentFromHints( 512, {} ), 1_MiB );
+    QCOMPARE( PartUtils::alignmentFromHints( 512, { 512, 4096, 0 } ), 1_MiB );
+    QCOMPARE( PartUtils::alignmentFromHints( 4096, { 4096, 0, 0 } ), 1_MiB );
+    // RAID with 3 data disks and 512KiB chunks has a 1.5MiB stripe
+    QCOMPARE( PartUtils::alignmentFromHints( 512, { 4096, 512_KiB, 1536_KiB } ), 3_MiB );
+    // An eMMC with 4MiB erase blocks
+    QCOMPARE( PartUtils::alignmentFromHints( 512, { 512, 512, 0, 4_MiB } ), 4_MiB );
+    // Nonsense: not a multiple of the sector size, or huge
+    QCOMPARE( PartUtils::alignmentFromHints( 512, { 33553920 + 100 } ), 1_MiB );
+    QCOMPARE( PartUtils::alignmentFromHints( 512, { 33553920 } ), 1_MiB );
 }
-#endif
-
-TestDevice::~TestDevice() {}
@@ -10,7 +10,7 @@
 #ifndef CLEARMOUNTSJOBTESTS_H
 #define CLEARMOUNTSJOBTESTS_H
 
-#include "partition/KPMHelper.h"
+#include "TestDevice.h"
 
 #include <QObject>
 
@@ -25,15 +25,10 @@ private Q_SLOTS:
     void testFixedSizePartition();
     void testPercentSizePartition();
     void testMixedSizePartition();
+    void testAlignedPartitions();
+    void testAlignmentHints();
     void init();
     void cleanup();
 };
 
-class TestDevice : public Device
-{
-public:
-    TestDevice( const QString& name, const qint64 logicalSectorSize, const qint64 totalLogicalSectors );
-    ~TestDevice() override;
-};
-
 #endif
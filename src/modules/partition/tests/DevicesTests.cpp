@@ -8,12 +8,14 @@
  */
 
 #include "core/DeviceList.h"
+#include "core/FilesystemProbe.h"
 
 #include "partition/KPMManager.h"
 #include "utils/Logger.h"
 
 #include <kpmcore/backend/corebackend.h>
 #include <kpmcore/backend/corebackendmanager.h>
+#include <kpmcore/core/device.h>
 
 #include <QObject>
 #include <QtTest/QtTest>
@@ -32,6 +34,7 @@ public:
 private Q_SLOTS:
     void testKPMScanDevices();
     void testPartUtilScanDevices();
+    void testFilesystemProbe();
 
 private:
     std::unique_ptr< CalamaresUtils::Partition::KPMManager > m_d;
@@ -83,6 +86,31 @@ DevicesTests::testPartUtilScanDevices()
     QVERIFY( devices.count() > 0 );
 }
 
+void
+DevicesTests::testFilesystemProbe()
+{
+    Logger::setupLogLevel( Logger::LOGVERBOSE );
+
+    PartUtils::clearFilesystemProbes();
+    const auto missing = PartUtils::probeFilesystem( QStringLiteral( "/dev/calamares-does-not-exist" ) );
+    QVERIFY( !missing.isValid() );
+    QVERIFY( missing.type.isEmpty() );
+
+    auto devices = PartUtils::getDevices();
+    if ( devices.isEmpty() )
+    {
+        QSKIP( "No devices to probe" );
+    }
+    // The device scan probes each device, so this comes from the cache
+    const QString node = devices.first()->deviceNode();
+    const auto first = PartUtils::probeFilesystem( node );
+    const auto second = PartUtils::probeFilesystem( node );
+    QCOMPARE( first.isValid(), second.isValid() );
+    QCOMPARE( first.type, second.type );
+    QCOMPARE( first.uuid, second.uuid );
+    qDeleteAll( devices );
+}
+
 QTEST_GUILESS_MAIN( DevicesTests )
 
 #include "utils/moc-warnings.h"
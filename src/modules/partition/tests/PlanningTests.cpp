@@ -0,0 +1,289 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "TestDevice.h"
+
+#include "core/PartitionInfo.h"
+#include "core/PartitionLayout.h"
+
+#include "JobQueue.h"
+#include "partition/KPMManager.h"
+#include "partition/PartitionSize.h"
+#include "utils/Logger.h"
+#include "utils/Units.h"
+#include "utils/Variant.h"
+#include "utils/Yaml.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QObject>
+#include <QTextStream>
+#include <QtTest/QtTest>
+
+#include <cmath>
+#include <memory>
+
+using namespace CalamaresUtils::Units;
+using CalamaresUtils::Partition::PartitionSize;
+using CalamaresUtils::Partition::SizeUnit;
+
+/** @brief Plans partition layouts on many synthetic disks
+ *
+ * The disks and layouts are read from planning.yaml. Each layout is
+ * applied to each disk, and the resulting partitions are checked: they
+ * must be inside the space given, in order, and not overlap; when
+ * the disk is big enough, every entry of the layout must be there.
+ *
+ * Timing for each layout is logged. If the environment variable
+ * PLANNING_REPORT names a file, the planned partitions (the partitions
+ * that a CreatePartitionJob would be made for, in order) are written
+ * there, one disk and layout per paragraph, for comparing runs.
+ */
+class PlanningTests : public QObject
+{
+    Q_OBJECT
+public:
+    PlanningTests();
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testPlans_data();
+    void testPlans();
+    void benchmarkPlanning();
+
+private:
+    struct Disk
+    {
+        QString name;
+        qint64 sectorSize;
+        qint64 sectors;
+        bool generated;
+    };
+
+    void loadDisks( const QVariantMap& map );
+
+    QList< Disk > m_disks;
+    QVariantMap m_layouts;
+    std::unique_ptr< Calamares::JobQueue > m_jobQueue;
+    std::unique_ptr< CalamaresUtils::Partition::KPMManager > m_kpmcore;
+    std::unique_ptr< QFile > m_report;
+};
+
+PlanningTests::PlanningTests()
+{
+    Logger::setupLogLevel( Logger::LOGDEBUG );
+}
+
+void
+PlanningTests::loadDisks( const QVariantMap& map )
+{
+    const auto disks = map.value( "disks" ).toList();
+    for ( const auto& d : disks )
+    {
+        const auto disk = d.toMap();
+        const qint64 sectorSize = CalamaresUtils::getInteger( disk, "sectorSize", 512 );
+        m_disks.append( { CalamaresUtils::getString( disk, "name" ),
+                          sectorSize,
+                          CalamaresUtils::GiBtoBytes( CalamaresUtils::getDouble( disk, "sizeGiB" ) ) / sectorSize,
+                          false } );
+    }
+
+    bool ok = false;
+    const auto generated = CalamaresUtils::getSubMap( map, "generated", ok );
+    const int count = int( CalamaresUtils::getInteger( generated, "count", 0 ) );
+    const double minGiB = CalamaresUtils::getDouble( generated, "minGiB", 1.0 );
+    const double maxGiB = CalamaresUtils::getDouble( generated, "maxGiB", minGiB );
+    const auto sectorSizes = generated.value( "sectorSizes", QVariantList { 512 } ).toList();
+    for ( int i = 0; i < count; ++i )
+    {
+        const double f = count > 1 ? double( i ) / ( count - 1 ) : 0.0;
+        const qint64 sectorSize = sectorSizes.at( i % sectorSizes.count() ).toLongLong();
+        const qint64 bytes = CalamaresUtils::GiBtoBytes( minGiB * std::pow( maxGiB / minGiB, f ) );
+        m_disks.append( { QStringLiteral( "generated-%1" ).arg( i ), sectorSize, bytes / sectorSize, true } );
+    }
+}
+
+void
+PlanningTests::initTestCase()
+{
+    m_jobQueue = std::make_unique< Calamares::JobQueue >( nullptr );
+    m_kpmcore = std::make_unique< CalamaresUtils::Partition::KPMManager >();
+
+    // BUILD_AS_TEST is the source-directory path
+    const QFileInfo fi( QString( "%1/planning.yaml" ).arg( BUILD_AS_TEST ) );
+    QVERIFY( fi.exists() );
+    bool ok = false;
+    const auto map = CalamaresUtils::loadYaml( fi, &ok );
+    QVERIFY( ok );
+
+    loadDisks( map );
+    m_layouts = map.value( "layouts" ).toMap();
+    QVERIFY( !m_disks.isEmpty() );
+    QVERIFY( !m_layouts.isEmpty() );
+
+    const QString reportName = QString::fromLocal8Bit( qgetenv( "PLANNING_REPORT" ) );
+    if ( !reportName.isEmpty() )
+    {
+        m_report = std::make_unique< QFile >( reportName );
+        QVERIFY( m_report->open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text ) );
+    }
+}
+
+void
+PlanningTests::cleanupTestCase()
+{
+    m_report.reset();
+    m_kpmcore.reset();
+    m_jobQueue.reset();
+}
+
+/** @brief The smallest space in which all the entries of @p entries fit
+ *
+ * This is the sum of the fixed sizes (and minimum sizes, for the
+ * percentage-sized entries), plus some room for the percentages.
+ */
+static qint64
+requiredBytes( const QVariantList& entries )
+{
+    qint64 bytes = 0;
+    for ( const auto& e : entries )
+    {
+        const auto entry = e.toMap();
+        const PartitionSize size( CalamaresUtils::getString( entry, "size" ) );
+        const PartitionSize minSize( CalamaresUtils::getString( entry, "minSize" ) );
+        if ( size.unit() != SizeUnit::Percent )
+        {
+            bytes += size.toBytes();
+        }
+        else
+        {
+            bytes += ( minSize.isValid() ? minSize.toBytes() : 0 ) + 1_GiB;
+        }
+    }
+    return bytes;
+}
+
+void
+PlanningTests::testPlans_data()
+{
+    QTest::addColumn< QString >( "layoutName" );
+
+    for ( auto it = m_layouts.cbegin(); it != m_layouts.cend(); ++it )
+    {
+        QTest::newRow( qPrintable( it.key() ) ) << it.key();
+    }
+}
+
+void
+PlanningTests::testPlans()
+{
+    QFETCH( QString, layoutName );
+
+    const QVariantList entries = m_layouts.value( layoutName ).toList();
+    PartitionLayout layout;
+    layout.init( FileSystem::Type::Ext4, entries );
+    const qint64 required = requiredBytes( entries );
+
+    QTextStream report( m_report.get() );
+    QElapsedTimer timer;
+    qint64 planningTime = 0;
+    int complete = 0;
+    for ( const auto& disk : qAsConst( m_disks ) )
+    {
+        TestDevice dev( disk.name, disk.sectorSize, disk.sectors );
+        // Leave the first MiB, and the last sectors for a GPT backup
+        const qint64 firstSector = 1_MiB / disk.sectorSize;
+        const qint64 lastSector = disk.sectors - 1 - 34;
+
+        timer.start();
+        const auto partitions = layout.createPartitions(
+            &dev, firstSector, lastSector, QString(), nullptr, PartitionRole( PartitionRole::Primary ) );
+        planningTime += timer.nsecsElapsed();
+
+        qint64 next = firstSector;
+        for ( Partition* p : partitions )
+        {
+            QVERIFY2( p->firstSector() >= next,
+                      qPrintable( QStringLiteral( "%1 on %2 overlaps or is out of order" )
+                                      .arg( PartitionInfo::mountPoint( p ), disk.name ) ) );
+            QVERIFY2( p->lastSector() >= p->firstSector() && p->lastSector() <= lastSector,
+                      qPrintable( QStringLiteral( "%1 on %2 is outside of the disk" )
+                                      .arg( PartitionInfo::mountPoint( p ), disk.name ) ) );
+            next = p->lastSector() + 1;
+        }
+        if ( required <= ( lastSector - firstSector + 1 ) * disk.sectorSize )
+        {
+            QVERIFY2(
+                partitions.count() == entries.count(),
+                qPrintable( QStringLiteral( "%1 partitions on %2" ).arg( partitions.count() ).arg( disk.name ) ) );
+            ++complete;
+        }
+
+        if ( m_report )
+        {
+            report << layoutName << " on " << disk.name << " (" << disk.sectors << " sectors of " << disk.sectorSize
+                   << ")\n";
+            for ( Partition* p : partitions )
+            {
+                report << "  create " << p->fileSystem().name() << ' ' << PartitionInfo::mountPoint( p ) << ' '
+                       << p->firstSector() << '-' << p->lastSector() << '\n';
+            }
+            report << '\n';
+        }
+        qDeleteAll( partitions );
+    }
+
+    cDebug() << "Layout" << layoutName << "planned on" << m_disks.count() << "disks (" << complete << "complete) in"
+             << ( planningTime / 1000000 ) << "ms";
+}
+
+void
+PlanningTests::benchmarkPlanning()
+{
+    QList< PartitionLayout > layouts;
+    for ( const auto& entries : qAsConst( m_layouts ) )
+    {
+        layouts.append( PartitionLayout() );
+        layouts.last().init( FileSystem::Type::Ext4, entries.toList() );
+    }
+
+    QList< std::shared_ptr< TestDevice > > devices;
+    for ( const auto& disk : qAsConst( m_disks ) )
+    {
+        if ( !disk.generated )
+        {
+            devices.append( std::make_shared< TestDevice >( disk.name, disk.sectorSize, disk.sectors ) );
+        }
+    }
+
+    QBENCHMARK
+    {
+        for ( auto& layout : layouts )
+        {
+            for ( const auto& dev : qAsConst( devices ) )
+            {
+                qDeleteAll( layout.createPartitions( dev.get(),
+                                                     1_MiB / dev->logicalSize(),
+                                                     dev->totalLogical() - 1 - 34,
+                                                     QString(),
+                                                     nullptr,
+                                                     PartitionRole( PartitionRole::Primary ) ) );
+            }
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN( PlanningTests )
+
+#include "utils/moc-warnings.h"
+
+#include "PlanningTests.moc"
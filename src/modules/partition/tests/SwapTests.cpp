@@ -0,0 +1,92 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "core/PartitionActions.h"
+#include "jobs/ZRamSwapJob.h"
+
+#include "utils/CalamaresUtilsSystem.h"
+#include "utils/Logger.h"
+#include "utils/Units.h"
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+using namespace CalamaresUtils::Units;
+using SwapChoice = Config::SwapChoice;
+
+class SwapTests : public QObject
+{
+    Q_OBJECT
+public:
+    SwapTests();
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testNoSwap();
+    void testZRamSuggestion();
+    void testZRamJobNothingToDo();
+};
+
+SwapTests::SwapTests() {}
+
+void
+SwapTests::initTestCase()
+{
+    Logger::setupLogLevel( Logger::LOGDEBUG );
+    if ( !CalamaresUtils::System::instance() )
+    {
+        (void)new CalamaresUtils::System( false );
+    }
+}
+
+void
+SwapTests::testNoSwap()
+{
+    QCOMPARE( PartitionActions::swapSuggestion( 100_GiB, SwapChoice::NoSwap ), 0 );
+    QCOMPARE( PartitionActions::swapSuggestion( 100_GiB, SwapChoice::ReuseSwap ), 0 );
+}
+
+void
+SwapTests::testZRamSuggestion()
+{
+    const auto memory = CalamaresUtils::System::instance()->getTotalMemoryB();
+    if ( memory.first <= 0 )
+    {
+        QSKIP( "No memory size available" );
+    }
+    const qint64 expected = qMin( 8_GiB, qint64( memory.first * memory.second ) );
+
+    // The disk space does not matter for swap in RAM
+    QCOMPARE( PartitionActions::swapSuggestion( 0, SwapChoice::ZRamSwap ), expected );
+    QCOMPARE( PartitionActions::swapSuggestion( 1_GiB, SwapChoice::ZRamSwap ), expected );
+    QCOMPARE( PartitionActions::swapSuggestion( 1000_GiB, SwapChoice::ZRamSwap ), expected );
+    QVERIFY( PartitionActions::swapSuggestion( 0, SwapChoice::ZRamSwap ) <= 8_GiB );
+
+    // Swap on disk is limited by the space, unlike zram
+    QCOMPARE( PartitionActions::swapSuggestion( 0, SwapChoice::SmallSwap ), 0 );
+}
+
+void
+SwapTests::testZRamJobNothingToDo()
+{
+    // A size of 0 runs no commands, and is not an error
+    ZRamSwapJob job( 0 );
+    QVERIFY( !job.prettyName().isEmpty() );
+    QVERIFY( job.exec() );
+
+    ZRamSwapJob negative( -1 );
+    QVERIFY( negative.exec() );
+}
+
+QTEST_GUILESS_MAIN( SwapTests )
+
+#include "utils/moc-warnings.h"
+
+#include "SwapTests.moc"
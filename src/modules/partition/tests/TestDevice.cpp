@@ -0,0 +1,49 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2020 Corentin Noël <corentin.noel@collabora.com>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "TestDevice.h"
+
+#include <memory>
+
+class PartitionTable;
+class SmartStatus;
+
+#ifdef WITH_KPMCORE4API
+// TODO: Get a clean way to instantiate a test Device from KPMCore
+class DevicePrivate
+{
+public:
+    QString m_Name;
+    QString m_DeviceNode;
+    qint64 m_LogicalSectorSize;
+    qint64 m_TotalLogical;
+    PartitionTable* m_PartitionTable;
+    QString m_IconName;
+    std::shared_ptr< SmartStatus > m_SmartStatus;
+    Device::Type m_Type;
+};
+
+TestDevice::TestDevice( const QString& name, const qint64 logicalSectorSize, const qint64 totalLogicalSectors )
+    : Device( std::make_shared< DevicePrivate >(),
+              name,
+              QString( "node" ),
+              logicalSectorSize,
+              totalLogicalSectors,
+              QString(),
+              Device::Type::Unknown_Device )
+{
+}
+#else
+TestDevice::TestDevice( const QString& name, const qint64 logicalSectorSize, const qint64 totalLogicalSectors )
+    : Device( name, QString( "node" ), logicalSectorSize, totalLogicalSectors, QString(), Device::Type::Unknown_Device )
+{
+}
+#endif
+
+TestDevice::~TestDevice() {}
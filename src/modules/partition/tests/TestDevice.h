@@ -0,0 +1,27 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2020 Corentin Noël <corentin.noel@collabora.com>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef PARTITION_TESTS_TESTDEVICE_H
+#define PARTITION_TESTS_TESTDEVICE_H
+
+#include "partition/KPMHelper.h"
+
+/** @brief A Device that exists only in memory
+ *
+ * There is no disk behind it, so it can be used to plan
+ * partitions, but not to run any of the jobs.
+ */
+class TestDevice : public Device
+{
+public:
+    TestDevice( const QString& name, const qint64 logicalSectorSize, const qint64 totalLogicalSectors );
+    ~TestDevice() override;
+};
+
+#endif
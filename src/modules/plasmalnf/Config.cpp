@@ -13,6 +13,7 @@
 #include "ThemeInfo.h"
 
 #include "utils/CalamaresUtilsSystem.h"
+#include "utils/Executor.h"
 #include "utils/Logger.h"
 #include "utils/Variant.h"
 
@@ -21,7 +22,9 @@
 #include <KSharedConfig>
 #endif
 
+#include <QFutureWatcher>
 #include <QSortFilterProxyModel>
+#include <QTimer>
 
 static QString
 currentPlasmaTheme()
@@ -38,7 +41,12 @@ currentPlasmaTheme()
 Config::Config( QObject* parent )
     : QObject( parent )
     , m_themeModel( new ThemesModel( this ) )
+    , m_applyTimer( new QTimer( this ) )
 {
+    m_applyTimer->setSingleShot( true );
+    m_applyTimer->setInterval( 300 );
+    connect( m_applyTimer, &QTimer::timeout, this, &Config::applyTheme );
+
     auto* filter = new QSortFilterProxyModel( m_themeModel );
     filter->setFilterRole( ThemesModel::ShownRole );
     filter->setFilterFixedString( QStringLiteral( "true" ) );
@@ -138,27 +146,53 @@ Config::setTheme( const QString& id )
     }
     else
     {
-        QStringList command;
-        if ( !m_liveUser.isEmpty() )
+        m_applyTimer->start();  // Restarts it, if the previous selection was recent
+    }
+    m_themeModel->select( id );
+    emit themeChanged( id );
+}
+
+void
+Config::applyTheme()
+{
+    using namespace CalamaresUtils::Executor;
+
+    // An apply that is still running is for an older selection
+    m_applyCancellation.cancel();
+    m_applyCancellation = Cancellation();
+
+    const QString id = m_themeId;
+    QStringList command;
+    if ( !m_liveUser.isEmpty() )
+    {
+        command << "sudo"
+                << "-E"
+                << "-H"
+                << "-u" << m_liveUser;
+    }
+    command << lnfToolPath() << "--resetLayout"
+            << "--apply" << id;
+
+    const Cancellation cancellation = m_applyCancellation;
+    auto* watcher = new QFutureWatcher< int >( this );
+    connect( watcher, &QFutureWatcher< int >::finished, this, [ watcher, cancellation, id ]() {
+        if ( cancellation.isCancelled() )
         {
-            command << "sudo"
-                    << "-E"
-                    << "-H"
-                    << "-u" << m_liveUser;
+            cDebug() << "Plasma look-and-feel" << id << "superseded.";
         }
-        command << lnfToolPath() << "--resetLayout"
-                << "--apply" << id;
-        auto r = CalamaresUtils::System::instance()->runCommand( command, std::chrono::seconds( 10 ) );
-
-        if ( r.getExitCode() )
+        else if ( watcher->result() )
         {
-            cWarning() << "Failed (" << r.getExitCode() << ')';
+            cWarning() << "Failed (" << watcher->result() << ')';
         }
         else
         {
             cDebug() << "Plasma look-and-feel applied" << id;
         }
-    }
-    m_themeModel->select( id );
-    emit themeChanged( id );
+        watcher->deleteLater();
+    } );
+    watcher->setFuture( run( Lane::Interactive, "plasmalnf-apply", cancellation, [ command ]( const Cancellation& c ) {
+        // The command is stopped when a newer apply cancels this one
+        CancellationScope scope( c );
+        return CalamaresUtils::System::runCommand( command, std::chrono::seconds( 10 ) ).getExitCode();
+    } ) );
 }
@@ -14,8 +14,12 @@
 
 #include "ThemeInfo.h"
 
+#include "utils/Executor.h"
+
 #include <QObject>
 
+class QTimer;
+
 class Config : public QObject
 {
     Q_OBJECT
@@ -58,12 +62,22 @@ public:
     QAbstractItemModel* themeModel() const { return m_filteredModel; }
 
 public slots:
+    /** @brief Selects the theme @p id, and applies it to the live session
+     *
+     * Applying the theme runs the lnf tool, which takes a while; that
+     * happens in the background, once the selection has not changed
+     * for a moment. A newer selection cancels an apply that is still
+     * running, so clicking through the themes only applies the last one.
+     */
     void setTheme( const QString& id );
 
 signals:
     void themeChanged( const QString& id );
 
 private:
+    /// @brief Runs the lnf tool for the current theme, in the background
+    void applyTheme();
+
     QString m_lnfPath;  // Path to the lnf tool
     QString m_liveUser;  // Name of the live user (for OEM mode)
 
@@ -72,6 +86,9 @@ private:
 
     QAbstractItemModel* m_filteredModel = nullptr;
     ThemesModel* m_themeModel = nullptr;
+
+    QTimer* m_applyTimer = nullptr;  // Waits for the selection to settle
+    CalamaresUtils::Executor::Cancellation m_applyCancellation;  // Of the most recent apply
 };
 
 #endif
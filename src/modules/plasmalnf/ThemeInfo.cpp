@@ -10,6 +10,7 @@
 
 #include "Branding.h"
 #include "utils/CalamaresUtilsGui.h"
+#include "utils/ImageRegistry.h"
 #include "utils/Logger.h"
 
 #include <KPackage/Package>
@@ -32,7 +33,8 @@ struct ThemeInfo
     QString name;
     QString description;
     QString imagePath;
-    mutable QPixmap pixmap;
+    QPixmap pixmap;  // Loaded on first use, see ThemesModel::image()
+    bool loading = false;  // The image is being loaded in the background
     bool show = true;
     bool selected = false;
 
@@ -53,8 +55,8 @@ struct ThemeInfo
 
     bool isValid() const { return !id.isEmpty(); }
 
-    /// @brief Fill in the pixmap member based on imagePath
-    QPixmap loadImage() const;
+    /// @brief An image for when there is no screenshot (in some color based on the id)
+    QPixmap placeholderImage() const;
 };
 
 class ThemeInfoList : public QList< ThemeInfo >
@@ -69,6 +71,7 @@ public:
             {
                 return { index, &i };
             }
+            ++index;
         }
         return { -1, nullptr };
     }
@@ -144,7 +147,7 @@ ThemesModel::data( const QModelIndex& index, int role ) const
     case DescriptionRole:
         return item.description;
     case ImageRole:
-        return item.loadImage();
+        return image( index.row() );
     default:
         return QVariant();
     }
@@ -168,6 +171,7 @@ ThemesModel::setThemeImage( const QString& id, const QString& imagePath )
     if ( theme )
     {
         theme->imagePath = imagePath;
+        theme->pixmap = QPixmap();
         emit dataChanged( index( i, 0 ), index( i, 0 ), { ImageRole } );
     }
 }
@@ -289,31 +293,58 @@ ThemeInfo::ThemeInfo( const KPluginMetaData& data )
 }
 
 QPixmap
-ThemeInfo::loadImage() const
+ThemeInfo::placeholderImage() const
 {
-    if ( pixmap.isNull() )
+    // Not found or not specified, so convert the name into some (horrible, likely)
+    // color instead.
+    QPixmap image( ThemesModel::imageSize() );
+    auto hash_color = qHash( imagePath.isEmpty() ? id : imagePath );
+    cDebug() << Logger::SubEntry << "Theme image" << imagePath << "not found, hash" << hash_color;
+    image.fill( QColor( QRgb( hash_color ) ) );
+    return image;
+}
+
+QPixmap
+ThemesModel::image( int row ) const
+{
+    auto& item = ( *m_themes )[ row ];
+    if ( !item.pixmap.isNull() )
     {
+        return item.pixmap;
+    }
 
-        const QSize image_size( ThemesModel::imageSize() );
+    const QSize image_size( imageSize() );
+    const QString path = munge_imagepath( item.imagePath );
+    if ( path.isEmpty() )
+    {
+        item.pixmap = item.placeholderImage();
+        return item.pixmap;
+    }
 
-        const QString path = munge_imagepath( imagePath );
-        cDebug() << "Loading initial image for" << id << imagePath << "->" << path;
-        QPixmap image( path );
-        if ( image.isNull() )
-        {
-            // Not found or not specified, so convert the name into some (horrible, likely)
-            // color instead.
-            image = QPixmap( image_size );
-            auto hash_color = qHash( imagePath.isEmpty() ? id : imagePath );
-            cDebug() << Logger::SubEntry << "Theme image" << imagePath << "not found, hash" << hash_color;
-            image.fill( QColor( QRgb( hash_color ) ) );
-        }
-        else
+    auto* registry = ImageRegistry::instance();
+    if ( registry->isCached( path, image_size ) )
+    {
+        item.pixmap = registry->pixmap( path, image_size );
+        return item.pixmap;
+    }
+    if ( item.loading )
+    {
+        QPixmap transparent( image_size );
+        transparent.fill( Qt::transparent );
+        return transparent;
+    }
+
+    cDebug() << "Loading image for" << item.id << item.imagePath << "->" << path;
+    item.loading = true;
+    auto* self = const_cast< ThemesModel* >( this );
+    const QString id = item.id;
+    return registry->pixmapAsync( path, image_size, self, [ self, id ]( const QPixmap& pixmap ) {
+        auto [ i, theme ] = self->m_themes->indexById( id );
+        if ( theme )
         {
-            cDebug() << Logger::SubEntry << "Theme image" << image.size();
+            theme->loading = false;
+            theme->pixmap = pixmap.isNull() ? theme->placeholderImage() : pixmap;
+            emit self->dataChanged( self->index( i, 0 ), self->index( i, 0 ), { ImageRole } );
         }
-
-        pixmap = image.scaled( image_size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
-    }
-    return pixmap;
+    } );
 }
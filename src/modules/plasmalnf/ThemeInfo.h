@@ -14,6 +14,7 @@
 #include <QList>
 #include <QString>
 
+class QPixmap;
 class ThemeInfoList;
 
 class ThemesModel : public QAbstractListModel
@@ -68,6 +69,14 @@ public:
     static QSize imageSize();
 
 private:
+    /** @brief The image of the theme in @p row, loaded on first use
+     *
+     * Images are loaded (by the ImageRegistry, at imageSize()) in the
+     * background; until then this returns a transparent placeholder,
+     * and the model emits dataChanged() when the image is there.
+     */
+    QPixmap image( int row ) const;
+
     ThemeInfoList* m_themes;
 };
 
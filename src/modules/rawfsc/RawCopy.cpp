@@ -0,0 +1,431 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "RawCopy.h"
+
+#include "utils/Logger.h"
+#include "utils/Units.h"
+
+#include <QFile>
+#include <QSemaphore>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined( Q_OS_LINUX )
+#include <linux/falloc.h>
+#include <linux/fs.h>
+#endif
+
+using namespace CalamaresUtils::Units;
+
+namespace RawCopy
+{
+
+/// @brief Bytes per read (and write); a multiple of any sector size
+static constexpr qint64 chunkSize = 4_MiB;
+/// @brief Alignment of the buffers, and of O_DIRECT transfers
+static constexpr qint64 alignment = 4_KiB;
+/// @brief Chunks that can be read-ahead while writing
+static constexpr int queueDepth = 4;
+
+namespace
+{
+struct FreeDeleter
+{
+    void operator()( char* p ) const { ::free( p ); }
+};
+using Buffer = std::unique_ptr< char, FreeDeleter >;
+
+Buffer
+allocateBuffer()
+{
+    void* p = nullptr;
+    if ( posix_memalign( &p, alignment, chunkSize ) != 0 )
+    {
+        return Buffer();
+    }
+    return Buffer( static_cast< char* >( p ) );
+}
+
+QString
+errorMessage( const char* what, const QString& path, int error )
+{
+    return QStringLiteral( "%1 %2: %3" )
+        .arg( QString::fromLatin1( what ), path, QString::fromLocal8Bit( strerror( error ) ) );
+}
+
+/** @brief Opens @p path with O_DIRECT, if possible
+ *
+ * Not all filesystems support O_DIRECT (e.g. tmpfs), so it is
+ * opened without if that is refused; @p direct tells which it is.
+ */
+int
+openFile( const QString& path, int flags, bool& direct )
+{
+    const QByteArray name = QFile::encodeName( path );
+    int fd = -1;
+#if defined( O_DIRECT )
+    fd = ::open( name.constData(), flags | O_DIRECT | O_CLOEXEC );
+    direct = fd >= 0;
+    if ( fd >= 0 || errno != EINVAL )
+    {
+        return fd;
+    }
+#endif
+    direct = false;
+    fd = ::open( name.constData(), flags | O_CLOEXEC );
+    return fd;
+}
+
+bool
+isAllZero( const char* data, qint64 length )
+{
+    return length <= 0 || ( data[ 0 ] == 0 && memcmp( data, data + 1, size_t( length - 1 ) ) == 0 );
+}
+
+/// @brief Reads up to @p length bytes at @p offset; returns the number read or -1
+qint64
+readFully( int fd, char* data, qint64 length, qint64 offset )
+{
+    qint64 done = 0;
+    while ( done < length )
+    {
+        const auto r = ::pread( fd, data + done, size_t( length - done ), off_t( offset + done ) );
+        if ( r < 0 && errno == EINTR )
+        {
+            continue;
+        }
+        if ( r < 0 )
+        {
+            return -1;
+        }
+        if ( r == 0 )
+        {
+            break;
+        }
+        done += r;
+    }
+    return done;
+}
+
+/// @brief The destination side of copy()
+class Writer
+{
+public:
+    Writer( int fd, bool direct, const DeviceSize& device )
+        : m_fd( fd )
+        , m_direct( direct )
+        , m_device( device )
+    {
+    }
+
+    /// @brief Writes @p length bytes at @p offset; returns an errno, or 0 on success
+    int write( const char* data, qint64 length, qint64 offset )
+    {
+#if defined( O_DIRECT )
+        if ( m_direct && ( length % alignment || offset % alignment ) )
+        {
+            // The tail of the source; O_DIRECT needs whole blocks
+            const int flags = fcntl( m_fd, F_GETFL );
+            if ( flags < 0 || fcntl( m_fd, F_SETFL, flags & ~O_DIRECT ) < 0 )
+            {
+                return errno;
+            }
+            m_direct = false;
+        }
+#endif
+        qint64 done = 0;
+        while ( done < length )
+        {
+            const auto r = ::pwrite( m_fd, data + done, size_t( length - done ), off_t( offset + done ) );
+            if ( r < 0 && errno == EINTR )
+            {
+                continue;
+            }
+            if ( r <= 0 )
+            {
+                return r < 0 ? errno : ENOSPC;
+            }
+            done += r;
+        }
+        return 0;
+    }
+
+    /// @brief Makes @p length bytes at @p offset read as zero; returns an errno, or 0 on success
+    int zero( qint64 offset, qint64 length )
+    {
+#if defined( Q_OS_LINUX )
+        if ( m_device.isBlockDevice )
+        {
+            const qint64 aligned = length - length % qMax< qint64 >( 512, m_device.blockSize );
+            uint64_t range[ 2 ] = { uint64_t( offset ), uint64_t( aligned ) };
+            if ( aligned > 0 && ioctl( m_fd, BLKZEROOUT, range ) == 0 )
+            {
+                offset += aligned;
+                length -= aligned;
+            }
+        }
+        else if ( fallocate( m_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, length ) == 0 )
+        {
+            return 0;
+        }
+#endif
+        // Whatever could not be zeroed otherwise is written
+        while ( length > 0 )
+        {
+            if ( !m_zeroes )
+            {
+                m_zeroes = allocateBuffer();
+                if ( !m_zeroes )
+                {
+                    return ENOMEM;
+                }
+                memset( m_zeroes.get(), 0, size_t( chunkSize ) );
+            }
+            const qint64 n = qMin( length, chunkSize );
+            if ( int error = write( m_zeroes.get(), n, offset ) )
+            {
+                return error;
+            }
+            offset += n;
+            length -= n;
+        }
+        return 0;
+    }
+
+private:
+    int m_fd;
+    bool m_direct;
+    DeviceSize m_device;
+    Buffer m_zeroes;
+};
+
+/// @brief A chunk of the source, read-ahead
+struct Slot
+{
+    Buffer data;
+    qint64 offset = 0;
+    qint64 length = 0;  ///< Zero for the last one
+    int error = 0;  ///< If reading failed, errno
+};
+
+}  // namespace
+
+DeviceSize
+deviceSize( const QString& path )
+{
+    DeviceSize d;
+    struct stat st;
+    const QByteArray name = QFile::encodeName( path );
+    if ( ::stat( name.constData(), &st ) != 0 )
+    {
+        return d;
+    }
+    if ( !S_ISBLK( st.st_mode ) )
+    {
+        d.size = st.st_size;
+        return d;
+    }
+
+    d.isBlockDevice = true;
+#if defined( Q_OS_LINUX )
+    int fd = ::open( name.constData(), O_RDONLY | O_CLOEXEC );
+    if ( fd >= 0 )
+    {
+        uint64_t bytes = 0;
+        int sectorSize = 0;
+        if ( ioctl( fd, BLKGETSIZE64, &bytes ) == 0 )
+        {
+            d.size = qint64( bytes );
+        }
+        if ( ioctl( fd, BLKSSZGET, &sectorSize ) == 0 && sectorSize > 0 )
+        {
+            d.blockSize = sectorSize;
+        }
+        ::close( fd );
+    }
+#endif
+    return d;
+}
+
+Result
+copy( const QString& source, const QString& destination, const ProgressFunction& progress )
+{
+    Result result;
+    const DeviceSize sourceSize = deviceSize( source );
+    const DeviceSize destinationSize = deviceSize( destination );
+    if ( !sourceSize.isValid() || !destinationSize.isValid() )
+    {
+        result.message = errorMessage( "Cannot determine size of", sourceSize.isValid() ? destination : source, errno );
+        return result;
+    }
+    if ( destinationSize.size < sourceSize.size )
+    {
+        result.message = QStringLiteral( "%1 is too small to copy %2 on it" ).arg( destination, source );
+        return result;
+    }
+
+    bool sourceDirect = false;
+    bool destinationDirect = false;
+    const int in = openFile( source, O_RDONLY, sourceDirect );
+    if ( in < 0 )
+    {
+        result.message = errorMessage( "Cannot open", source, errno );
+        return result;
+    }
+    const int out = openFile( destination, O_WRONLY, destinationDirect );
+    if ( out < 0 )
+    {
+        result.message = errorMessage( "Cannot open", destination, errno );
+        ::close( in );
+        return result;
+    }
+
+    std::vector< Slot > slots( queueDepth );
+    for ( auto& s : slots )
+    {
+        s.data = allocateBuffer();
+        if ( !s.data )
+        {
+            result.message = errorMessage( "Cannot allocate buffers for", destination, ENOMEM );
+            ::close( in );
+            ::close( out );
+            return result;
+        }
+    }
+    cDebug() << "Copying" << sourceSize.size << "bytes from" << source << ( sourceDirect ? "(direct)" : "" ) << "to"
+             << destination << ( destinationDirect ? "(direct)" : "" );
+
+    QSemaphore freeSlots( queueDepth );
+    QSemaphore fullSlots( 0 );
+    std::atomic< bool > stop( false );
+    const qint64 size = sourceSize.size;
+
+    // Reads chunks into the free slots, until the end of the source
+    // (or an error, or being told to stop) which gets a slot of length 0.
+    auto reader = QtConcurrent::run( [&slots, &freeSlots, &fullSlots, &stop, in, size]() {
+        qint64 offset = 0;
+        for ( int i = 0;; i = ( i + 1 ) % queueDepth )
+        {
+            freeSlots.acquire();
+            Slot& s = slots[ size_t( i ) ];
+            s.offset = offset;
+            s.error = 0;
+            const qint64 want = qMin( chunkSize, size - offset );
+            qint64 got = 0;
+            if ( want > 0 && !stop )
+            {
+                // Ask for whole blocks, for O_DIRECT; it stops at the end anyway
+                const qint64 ask = qMin( chunkSize, ( want + alignment - 1 ) / alignment * alignment );
+                got = readFully( in, s.data.get(), ask, offset );
+                s.error = got < 0 ? errno : 0;
+                got = qBound< qint64 >( 0, got, want );
+            }
+            s.length = got;
+            fullSlots.release();
+            if ( got == 0 )
+            {
+                return;
+            }
+            offset += got;
+        }
+    } );
+
+    Writer writer( out, destinationDirect, destinationSize );
+    qint64 zeroStart = 0;
+    qint64 zeroLength = 0;
+    auto flushZeroes = [&writer, &result, &zeroStart, &zeroLength, &destination]() {
+        if ( zeroLength > 0 )
+        {
+            if ( int error = writer.zero( zeroStart, zeroLength ) )
+            {
+                result.message = errorMessage( "Cannot zero blocks on", destination, error );
+            }
+            result.zeroed += zeroLength;
+            zeroLength = 0;
+        }
+    };
+
+    for ( int i = 0;; i = ( i + 1 ) % queueDepth )
+    {
+        fullSlots.acquire();
+        const Slot& s = slots[ size_t( i ) ];
+        if ( s.length == 0 )
+        {
+            if ( s.error && result.isOk() )
+            {
+                result.message = errorMessage( "Cannot read", source, s.error );
+            }
+            freeSlots.release();
+            break;
+        }
+        if ( result.isOk() )
+        {
+            if ( isAllZero( s.data.get(), s.length ) )
+            {
+                if ( zeroLength == 0 )
+                {
+                    zeroStart = s.offset;
+                }
+                zeroLength += s.length;
+            }
+            else
+            {
+                flushZeroes();
+                if ( result.isOk() )
+                {
+                    if ( int error = writer.write( s.data.get(), s.length, s.offset ) )
+                    {
+                        result.message = errorMessage( "Cannot write", destination, error );
+                    }
+                    else
+                    {
+                        result.copied += s.length;
+                    }
+                }
+            }
+            if ( progress )
+            {
+                progress( s.offset + s.length, size );
+            }
+        }
+        if ( !result.isOk() )
+        {
+            stop = true;
+        }
+        freeSlots.release();
+    }
+    reader.waitForFinished();
+
+    if ( result.isOk() )
+    {
+        flushZeroes();
+    }
+    if ( result.isOk() && ::fsync( out ) != 0 )
+    {
+        result.message = errorMessage( "Cannot sync", destination, errno );
+    }
+    ::close( in );
+    ::close( out );
+    return result;
+}
+
+}  // namespace RawCopy
@@ -0,0 +1,67 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef RAWFSC_RAWCOPY_H
+#define RAWFSC_RAWCOPY_H
+
+#include <QString>
+
+#include <functional>
+
+namespace RawCopy
+{
+
+/** @brief Size and (logical) block size of a file or block device
+ *
+ * For block devices the block size is the logical sector size;
+ * for other files it is 1. The size is -1 if @p path cannot be opened.
+ */
+struct DeviceSize
+{
+    qint64 size = -1;
+    qint64 blockSize = 1;
+    bool isBlockDevice = false;
+
+    bool isValid() const { return size >= 0; }
+};
+
+DeviceSize deviceSize( const QString& path );
+
+/** @brief Outcome of copy()
+ *
+ * If @c message is not empty, the copy failed; @c copied and
+ * @c zeroed tell how far it got.
+ */
+struct Result
+{
+    qint64 copied = 0;  ///< Bytes actually written
+    qint64 zeroed = 0;  ///< Bytes of zero blocks not written (discarded or punched out)
+    QString message;
+
+    bool isOk() const { return message.isEmpty(); }
+};
+
+/// @brief Called with the bytes done so far and the total
+using ProgressFunction = std::function< void( qint64, qint64 ) >;
+
+/** @brief Copies the contents of @p source to the start of @p destination
+ *
+ * The destination must be at least as large as the source. Data is
+ * read in large aligned chunks (with O_DIRECT where the file allows),
+ * by a separate thread, so that reading and writing overlap. Chunks
+ * that are all zero are not written: on a block device the range is
+ * zeroed with BLKZEROOUT (which the device can do without transferring
+ * data, e.g. by unmapping on an SSD), on a file a hole is punched.
+ * Where that is not possible, zeroes are written after all.
+ */
+Result copy( const QString& source, const QString& destination, const ProgressFunction& progress = nullptr );
+
+}  // namespace RawCopy
+
+#endif
@@ -0,0 +1,212 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "RawFSCJob.h"
+
+#include "RawCopy.h"
+
+#include "GlobalStorage.h"
+#include "JobQueue.h"
+#include "utils/CalamaresUtilsSystem.h"
+#include "utils/Logger.h"
+#include "utils/Units.h"
+#include "utils/Variant.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+
+using CalamaresUtils::System;
+
+QString
+resolveSource( const QString& source, const QByteArray& mounts )
+{
+    const QFileInfo fi( source );
+    const QString path = fi.exists() ? fi.canonicalFilePath() : fi.absoluteFilePath();
+    for ( const auto& line : mounts.split( '\n' ) )
+    {
+        const auto fields = line.simplified().split( ' ' );
+        if ( fields.count() >= 2 && QString::fromLocal8Bit( fields.at( 1 ) ) == path )
+        {
+            return QString::fromLocal8Bit( fields.at( 0 ) );
+        }
+    }
+    return path;
+}
+
+RawFSCJob::RawFSCJob( QObject* parent )
+    : Calamares::CppJob( parent )
+{
+}
+
+RawFSCJob::~RawFSCJob() {}
+
+QString
+RawFSCJob::prettyName() const
+{
+    return tr( "Installing data." );
+}
+
+QString
+RawFSCJob::prettyStatusMessage() const
+{
+    return m_status.isEmpty() ? prettyName() : m_status;
+}
+
+/// @brief Stores the UUID of the filesystem on @p device in the partitions list
+static void
+updateGlobalStorage( QVariantList& partitions, const QString& device, const QString& source )
+{
+    for ( auto& p : partitions )
+    {
+        auto partition = p.toMap();
+        if ( partition.value( "device" ).toString() != device )
+        {
+            continue;
+        }
+        auto r = System::runCommand( { "blkid", "-s", "UUID", "-o", "value", device }, std::chrono::seconds( 30 ) );
+        if ( r.getExitCode() == 0 )
+        {
+            cDebug() << "Setting" << device << "UUID to" << r.getOutput();
+            partition.insert( "uuid", r.getOutput() );
+            partition.insert( "source", source );
+            p = partition;
+        }
+    }
+}
+
+Calamares::JobResult
+RawFSCJob::exec()
+{
+    Calamares::GlobalStorage* gs = Calamares::JobQueue::instance()->globalStorage();
+    QVariantList partitions = gs ? gs->value( "partitions" ).toList() : QVariantList();
+    if ( partitions.isEmpty() )
+    {
+        cWarning() << "partitions is empty.";
+        return Calamares::JobResult::error(
+            tr( "Configuration Error" ), tr( "No partitions are defined for <pre>%1</pre> to use." ).arg( "rawfsc" ) );
+    }
+
+    QByteArray mounts;
+    {
+        QFile procMounts( QStringLiteral( "/proc/mounts" ) );
+        if ( procMounts.open( QIODevice::ReadOnly ) )
+        {
+            mounts = procMounts.readAll();
+        }
+    }
+
+    struct Item
+    {
+        QString source;
+        QString destination;
+        QString fs;
+        bool resize;
+    };
+    QList< Item > items;
+    for ( const auto& p : qAsConst( partitions ) )
+    {
+        const auto partition = p.toMap();
+        const QString mountPoint = partition.value( "mountPoint" ).toString();
+        if ( mountPoint.isEmpty() )
+        {
+            continue;
+        }
+        for ( const auto& t : qAsConst( m_targets ) )
+        {
+            if ( t.mountPoint == mountPoint )
+            {
+                items.append( { resolveSource( t.source, mounts ),
+                                partition.value( "device" ).toString(),
+                                partition.value( "fs" ).toString(),
+                                t.resize } );
+            }
+        }
+    }
+    cDebug() << "Copying" << items.count() << "raw partitions.";
+
+    for ( int index = 0; index < items.count(); ++index )
+    {
+        const auto& item = items.at( index );
+        cDebug() << "Copying" << item.source << "to" << item.destination;
+        if ( !m_bogus )
+        {
+            QElapsedTimer timer;
+            timer.start();
+            qint64 lastReport = -1;
+            auto result = RawCopy::copy(
+                item.source,
+                item.destination,
+                [ this, &timer, &lastReport, &item, index, count = items.count() ]( qint64 done, qint64 total ) {
+                    // Report at most a few times a second
+                    const qint64 elapsed = timer.elapsed();
+                    if ( lastReport >= 0 && elapsed - lastReport < 250 && done < total )
+                    {
+                        return;
+                    }
+                    lastReport = elapsed;
+                    const double mibPerSecond
+                        = elapsed > 0 ? CalamaresUtils::BytesToMiB( done ) * 1000.0 / elapsed : 0.0;
+                    m_status = tr( "Copying %1 to %2, %3 MiB/s" )
+                                   .arg( item.source, item.destination )
+                                   .arg( mibPerSecond, 0, 'f', 1 );
+                    emit progress( ( index + ( total > 0 ? double( done ) / total : 1.0 ) ) / count );
+                } );
+            if ( !result.isOk() )
+            {
+                cWarning() << "Raw copy failed." << result.message;
+                if ( RawCopy::deviceSize( item.destination ).size < RawCopy::deviceSize( item.source ).size )
+                {
+                    return Calamares::JobResult::error(
+                        tr( "Not enough free space" ),
+                        tr( "%1 partition is too small to copy %2 on it" ).arg( item.destination, item.source ) );
+                }
+                return Calamares::JobResult::error(
+                    tr( "Could not copy %1 to %2" ).arg( item.source, item.destination ), result.message );
+            }
+            cDebug() << Logger::SubEntry << "Copied" << result.copied << "bytes, zeroed" << result.zeroed << "bytes in"
+                     << timer.elapsed() << "ms";
+
+            if ( item.resize && item.fs.contains( "ext" ) )
+            {
+                cDebug() << "Resizing filesystem on" << item.destination;
+                System::runCommand( { "e2fsck", "-f", "-y", item.destination }, std::chrono::seconds( 0 ) );
+                System::runCommand( { "resize2fs", item.destination }, std::chrono::seconds( 0 ) );
+            }
+        }
+        updateGlobalStorage( partitions, item.destination, item.source );
+    }
+    gs->insert( "partitions", partitions );
+    m_status.clear();
+
+    return Calamares::JobResult::ok();
+}
+
+void
+RawFSCJob::setConfigurationMap( const QVariantMap& configurationMap )
+{
+    m_targets.clear();
+    const auto targets = configurationMap.value( "targets" ).toList();
+    for ( const auto& t : targets )
+    {
+        const auto map = t.toMap();
+        Target target { CalamaresUtils::getString( map, "mountPoint" ),
+                        CalamaresUtils::getString( map, "source" ),
+                        CalamaresUtils::getBool( map, "resize", false ) };
+        if ( target.mountPoint.isEmpty() || target.source.isEmpty() )
+        {
+            cWarning() << "Skipping raw target without mountPoint or source" << map;
+            continue;
+        }
+        m_targets.append( target );
+    }
+    m_bogus = CalamaresUtils::getBool( configurationMap, "bogus", false );
+}
+
+CALAMARES_PLUGIN_FACTORY_DEFINITION( RawFSCJobFactory, registerPlugin< RawFSCJob >(); )
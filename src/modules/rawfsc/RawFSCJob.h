@@ -0,0 +1,68 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef RAWFSCJOB_H
+#define RAWFSCJOB_H
+
+#include "CppJob.h"
+#include "DllMacro.h"
+#include "utils/PluginFactory.h"
+
+#include <QList>
+#include <QObject>
+#include <QVariantMap>
+
+/** @brief Copies filesystem images, block-by-block, to partitions
+ *
+ * This does what the rawfs module does, with the same configuration:
+ * each of the *targets* is copied to the partition with the same
+ * mount point. See RawCopy::copy() for how the copying is done.
+ */
+class PLUGINDLLEXPORT RawFSCJob : public Calamares::CppJob
+{
+    Q_OBJECT
+
+public:
+    struct Target
+    {
+        QString mountPoint;
+        QString source;
+        bool resize = false;
+    };
+
+    explicit RawFSCJob( QObject* parent = nullptr );
+    ~RawFSCJob() override;
+
+    QString prettyName() const override;
+    QString prettyStatusMessage() const override;
+
+    Calamares::JobResult exec() override;
+
+    void setConfigurationMap( const QVariantMap& configurationMap ) override;
+
+    const QList< Target >& targets() const { return m_targets; }
+
+private:
+    QList< Target > m_targets;
+    bool m_bogus = false;
+
+    QString m_status;
+};
+
+/** @brief The device to copy from for @p source
+ *
+ * If @p source is a mount point, this is the device mounted there
+ * (according to @p mounts, in the format of /proc/mounts); otherwise
+ * it is @p source itself, with symlinks resolved.
+ */
+QString resolveSource( const QString& source, const QByteArray& mounts );
+
+CALAMARES_PLUGIN_FACTORY_DECLARATION( RawFSCJobFactory )
+
+#endif  // RAWFSCJOB_H
@@ -0,0 +1,170 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "RawCopy.h"
+#include "RawFSCJob.h"
+
+#include "utils/Logger.h"
+#include "utils/Units.h"
+#include "utils/Yaml.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+#include <utility>
+
+using namespace CalamaresUtils::Units;
+
+class RawFSCTests : public QObject
+{
+    Q_OBJECT
+public:
+    RawFSCTests() {}
+    ~RawFSCTests() override {}
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testConfig();
+    void testResolveSource();
+    void testCopy_data();
+    void testCopy();
+    void testTooSmall();
+};
+
+void
+RawFSCTests::initTestCase()
+{
+    Logger::setupLogLevel( Logger::LOGDEBUG );
+}
+
+void
+RawFSCTests::testConfig()
+{
+    // BUILD_AS_TEST is the source-directory path
+    const QFileInfo fi( QString( "%1/rawfsc.conf" ).arg( BUILD_AS_TEST ) );
+    QVERIFY( fi.exists() );
+    bool ok = false;
+    const auto map = CalamaresUtils::loadYaml( fi, &ok );
+    QVERIFY( ok );
+
+    RawFSCJob job;
+    job.setConfigurationMap( map );
+    QCOMPARE( job.targets().count(), 3 );
+    QCOMPARE( job.targets().at( 1 ).mountPoint, QStringLiteral( "/home" ) );
+    QCOMPARE( job.targets().at( 1 ).source, QStringLiteral( "/images/home.img" ) );
+    QVERIFY( job.targets().at( 1 ).resize );
+    QVERIFY( !job.targets().at( 2 ).resize );
+}
+
+void
+RawFSCTests::testResolveSource()
+{
+    const QByteArray mounts( "/dev/sda1 / ext4 rw,relatime 0 0\n"
+                             "proc /proc proc rw,nosuid,nodev,noexec,relatime 0 0\n"
+                             "/dev/mmcblk0p3 /run/data ext4 ro 0 0\n" );
+    QCOMPARE( resolveSource( "/", mounts ), QStringLiteral( "/dev/sda1" ) );
+    QCOMPARE( resolveSource( "/run/data", mounts ), QStringLiteral( "/dev/mmcblk0p3" ) );
+    QCOMPARE( resolveSource( "/images/home.img", mounts ), QStringLiteral( "/images/home.img" ) );
+    QCOMPARE( resolveSource( "/images/home.img", QByteArray() ), QStringLiteral( "/images/home.img" ) );
+}
+
+void
+RawFSCTests::testCopy_data()
+{
+    QTest::addColumn< QByteArray >( "pattern" );  // Per 1MiB: 'x' for data, '0' for zeroes
+    QTest::addColumn< qint64 >( "tail" );  // Extra bytes of data at the end
+
+    QTest::newRow( "data" ) << QByteArray( "xxxxxxxxxx" ) << qint64( 0 );
+    QTest::newRow( "zeroes" ) << QByteArray( "0000000000" ) << qint64( 0 );
+    QTest::newRow( "mixed" ) << QByteArray( "xx00000000x0000x" ) << qint64( 0 );
+    QTest::newRow( "odd-tail" ) << QByteArray( "x00000000" ) << qint64( 1234 );
+    QTest::newRow( "small" ) << QByteArray() << qint64( 17 );
+}
+
+void
+RawFSCTests::testCopy()
+{
+    QFETCH( QByteArray, pattern );
+    QFETCH( qint64, tail );
+
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+
+    QByteArray contents;
+    for ( int i = 0; i < pattern.count(); ++i )
+    {
+        // Make each MiB different, so misplaced chunks are noticed
+        contents.append( pattern.at( i ) == 'x' ? QByteArray( int( 1_MiB ), char( 'a' + i ) )
+                                                : QByteArray( int( 1_MiB ), 0 ) );
+    }
+    contents.append( QByteArray( int( tail ), 't' ) );
+
+    const QString source = dir.filePath( "source.img" );
+    const QString destination = dir.filePath( "destination.img" );
+    {
+        QFile f( source );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        QCOMPARE( f.write( contents ), qint64( contents.size() ) );
+    }
+    {
+        // Garbage in the destination, which must be overwritten (also by the zeroes)
+        QFile f( destination );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        QVERIFY( f.write( QByteArray( contents.size() + int( 1_MiB ), '?' ) ) > 0 );
+    }
+
+    qint64 lastDone = -1;
+    const auto result = RawCopy::copy( source, destination, [&lastDone]( qint64 done, qint64 total ) {
+        QVERIFY( done > lastDone );
+        QVERIFY( done <= total );
+        lastDone = done;
+    } );
+    QVERIFY2( result.isOk(), qPrintable( result.message ) );
+    QCOMPARE( result.copied + result.zeroed, qint64( contents.size() ) );
+    QCOMPARE( lastDone, qint64( contents.size() ) );
+
+    QFile f( destination );
+    QVERIFY( f.open( QIODevice::ReadOnly ) );
+    const QByteArray copied = f.readAll();
+    QCOMPARE( copied.size(), contents.size() + int( 1_MiB ) );
+    QVERIFY( copied.left( contents.size() ) == contents );
+    // Beyond the size of the source, nothing changes
+    QVERIFY( copied.mid( contents.size() ) == QByteArray( int( 1_MiB ), '?' ) );
+}
+
+void
+RawFSCTests::testTooSmall()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString source = dir.filePath( "source.img" );
+    const QString destination = dir.filePath( "destination.img" );
+    for ( const auto& [ name, size ] : { std::make_pair( source, 4096 ), std::make_pair( destination, 1024 ) } )
+    {
+        QFile f( name );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        f.write( QByteArray( size, 'x' ) );
+    }
+
+    const auto result = RawCopy::copy( source, destination );
+    QVERIFY( !result.isOk() );
+    QCOMPARE( result.copied, qint64( 0 ) );
+
+    QCOMPARE( RawCopy::deviceSize( source ).size, qint64( 4096 ) );
+    QVERIFY( !RawCopy::deviceSize( source ).isBlockDevice );
+    QVERIFY( !RawCopy::deviceSize( dir.filePath( "nonexistent" ) ).isValid() );
+}
+
+QTEST_GUILESS_MAIN( RawFSCTests )
+
+#include "utils/moc-warnings.h"
+
+#include "Tests.moc"
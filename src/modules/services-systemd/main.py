@@ -26,16 +26,13 @@ def pretty_name():
     return _("Configure systemd services")
 
 
-def systemctl(targets, command, suffix):
+def systemd_units(targets, suffix):
     """
-    For each entry in @p targets, run "systemctl <command> <thing>",
-    where <thing> is the entry's name plus the given @p suffix.
+    Returns a list of (unit, suffix, mandatory) tuples for the entries
+    in @p targets, where unit is the entry's name plus the given @p suffix.
     (No dot is added between name and suffix; suffix may be empty)
-
-    Returns a failure message, or None if this was successful.
-    Services that are not mandatory have their failures suppressed
-    silently.
     """
+    units = []
     for svc in targets:
         if isinstance(svc, str):
             name = svc
@@ -43,12 +40,35 @@ def systemctl(targets, command, suffix):
         else:
             name = svc["name"]
             mandatory = svc.get("mandatory", False)
+        units.append(("{}{}".format(name, suffix), suffix, mandatory))
+    return units
+
+
+def systemctl(units, command):
+    """
+    Run "systemctl <command> <unit> ..." once for all the @p units,
+    a list of (unit, suffix, mandatory) tuples as returned by systemd_units().
+
+    Returns a failure message, or None if this was successful.
+    Services that are not mandatory have their failures suppressed
+    silently.
+
+    If the combined call fails, each unit is tried on its own, so
+    that failures can be attributed to a unit. Those calls run one
+    after another (systemctl edits the same files in the target for
+    each of them), and stop at the first mandatory unit that fails.
+    """
+    if not units:
+        return None
 
-        ec = libcalamares.utils.target_env_call(
-            ['systemctl', command, "{}{}".format(name, suffix)]
-            )
+    ec = libcalamares.utils.target_env_call(['systemctl', command] + [unit for unit, _suffix, _mandatory in units])
+    if ec == 0:
+        return None
 
+    for unit, suffix, mandatory in units:
+        ec = libcalamares.utils.target_env_call(['systemctl', command, unit])
         if ec != 0:
+            name = unit[:len(unit) - len(suffix)]
             libcalamares.utils.warning(
                 "Cannot {} systemd {} {}".format(command, suffix, name)
                 )
@@ -88,24 +108,19 @@ def run():
     # here will work in a chroot; in fact, they are the only systemctl commands
     # that support that, see:
     # http://0pointer.de/blog/projects/changing-roots.html
-
-    r = systemctl(cfg.get("services", []), "enable", ".service")
-    if r is not None:
-        return r
-
-    r = systemctl(cfg.get("targets", []), "enable", ".target")
-    if r is not None:
-        return r
-
-    r = systemctl(cfg.get("disable", []), "disable", ".service")
+    #
+    # Each verb is one systemctl call, for all the units it applies to.
+    r = systemctl(systemd_units(cfg.get("services", []), ".service")
+                  + systemd_units(cfg.get("targets", []), ".target"), "enable")
     if r is not None:
         return r
 
-    r = systemctl(cfg.get("disable-targets", []), "disable", ".target")
+    r = systemctl(systemd_units(cfg.get("disable", []), ".service")
+                  + systemd_units(cfg.get("disable-targets", []), ".target"), "disable")
     if r is not None:
         return r
 
-    r = systemctl(cfg.get("mask", []), "mask", "")
+    r = systemctl(systemd_units(cfg.get("mask", []), ""), "mask")
     if r is not None:
         return r
 
@@ -42,6 +42,25 @@ ShellProcessJob::prettyName() const
 }
 
 
+QString
+ShellProcessJob::prettyDescription() const
+{
+    if ( !m_commands )
+    {
+        return QString();
+    }
+    auto* gs = Calamares::JobQueue::instanceGlobalStorage();
+    return m_commands->preview( gs ? gs->data() : QVariantMap() ).join( '\n' );
+}
+
+QString
+ShellProcessJob::prettyStatusMessage() const
+{
+    // Not the description: that is the commands themselves
+    return prettyName();
+}
+
+
 Calamares::JobResult
 ShellProcessJob::exec()
 {
@@ -74,6 +93,21 @@ ShellProcessJob::setConfigurationMap( const QVariantMap& configurationMap )
         {
             cDebug() << "ShellProcessJob: \"script\" contains no commands for" << moduleInstanceKey();
         }
+
+        QString modeName = CalamaresUtils::getString( configurationMap, "mode" );
+        if ( !modeName.isEmpty() )
+        {
+            bool ok = false;
+            auto mode = CalamaresUtils::CommandList::runModeNames().find( modeName, ok );
+            if ( ok )
+            {
+                m_commands->setRunMode( mode, CalamaresUtils::getInteger( configurationMap, "workers", 0 ) );
+            }
+            else
+            {
+                cWarning() << "ShellProcessJob: unknown mode" << modeName << "for" << moduleInstanceKey();
+            }
+        }
     }
     else
     {
@@ -31,6 +31,12 @@ public:
     ~ShellProcessJob() override;
 
     QString prettyName() const override;
+    /** @brief The commands, as they would run now
+     *
+     * @@ROOT@@ and @@USER@@ are replaced by their current values.
+     */
+    QString prettyDescription() const override;
+    QString prettyStatusMessage() const override;
 
     Calamares::JobResult exec() override;
 
@@ -194,3 +194,40 @@ script:
     gs->insert( "username", "`id -u`" );
     QVERIFY( bool( CommandList( userScript, false, 10s ).run() ) );
 }
+
+void
+ShellProcessTests::testPreview()
+{
+    QVariant script = CalamaresUtils::yamlMapToVariant( YAML::Load( R"(---
+script:
+    - "ls @@ROOT@@/home/@@USER@@"
+    - "echo @@@ROOT@@@ @@ @@USERS@@"
+    - "-rm @@USER@@@@USER@@"
+)" ) )
+                          .value( "script" );
+
+    QVariantMap data;
+    {
+        CommandList cl( script, false, 10s );
+        QCOMPARE( cl.count(), 3 );
+        QVERIFY( cl.at( 0 ).needsRoot() );
+        QVERIFY( cl.at( 0 ).needsUser() );
+        QVERIFY( !cl.at( 2 ).needsRoot() );
+        // Nothing is known, so nothing is replaced
+        QCOMPARE( cl.preview( data ),
+                  QStringList(
+                      { "ls @@ROOT@@/home/@@USER@@", "echo @@@ROOT@@@ @@ @@USERS@@", "-rm @@USER@@@@USER@@" } ) );
+
+        data.insert( "rootMountPoint", "/tmp/root" );
+        data.insert( "username", "alice" );
+        QCOMPARE( cl.preview( data ),
+                  QStringList(
+                      { "ls /tmp/root/home/alice", "echo @/tmp/root@ @@ @@USERS@@", "-rm alicealice" } ) );
+        QCOMPARE( cl.at( 1 ).expand( "R", "U" ), QStringLiteral( "echo @R@ @@ @@USERS@@" ) );
+    }
+    {
+        // In the target, the root is /
+        CommandList cl( script, true, 10s );
+        QCOMPARE( cl.preview( data ).first(), QStringLiteral( "ls //home/alice" ) );
+    }
+}
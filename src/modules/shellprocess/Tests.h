@@ -33,6 +33,7 @@ private Q_SLOTS:
     void testProcessListFromObject();
     // Check @@ROOT@@ substitution
     void testRootSubstitution();
+    void testPreview();
 };
 
 #endif
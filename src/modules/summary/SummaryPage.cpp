@@ -32,7 +32,6 @@ static const int SECTION_SPACING = 12;
 SummaryPage::SummaryPage( Config* config, const SummaryViewStep* thisViewStep, QWidget* parent )
     : QWidget()
     , m_thisViewStep( thisViewStep )
-    , m_contentWidget( nullptr )
     , m_scrollArea( new QScrollArea( this ) )
 {
     Q_UNUSED( parent )
@@ -58,6 +57,22 @@ SummaryPage::SummaryPage( Config* config, const SummaryViewStep* thisViewStep, Q
         Calamares::Branding::instance()->windowExpands() ? Qt::ScrollBarAsNeeded : Qt::ScrollBarAlwaysOn );
     m_scrollArea->setFrameStyle( QFrame::NoFrame );
     m_scrollArea->setContentsMargins( 0, 0, 0, 0 );
+
+    m_contentWidget = new QWidget;
+    m_layout = new QVBoxLayout( m_contentWidget );
+    CalamaresUtils::unmarginLayout( m_layout );
+    m_scrollArea->setWidget( m_contentWidget );
+
+    // A step that is shown again may be changed by the user, so its
+    // summary is rebuilt next time. Other steps keep their summary.
+    connect( Calamares::ViewManager::instance(), &Calamares::ViewManager::currentStepChanged, this, [ this ]() {
+        auto it = m_sections.find( Calamares::ViewManager::instance()->currentStep() );
+        if ( it != m_sections.end() )
+        {
+            it->dirty = true;
+        }
+    } );
+    CALAMARES_RETRANSLATE( for ( auto& section : m_sections ) { section.dirty = true; } );
 }
 
 
@@ -84,16 +99,43 @@ createBodyLabel( const QString& text, const QPalette& bodyPalette )
     return label;
 }
 
+/// @brief A section of the summary: the title and body for one step
+static QWidget*
+createSection( const QString& title,
+               const QString& text,
+               QWidget* widget,
+               const QFont& titleFont,
+               const QPalette& bodyPalette )
+{
+    QWidget* section = new QWidget;
+    QVBoxLayout* layout = new QVBoxLayout( section );
+    CalamaresUtils::unmarginLayout( layout );
+
+    layout->addWidget( createTitleLabel( title, titleFont ) );
+    QHBoxLayout* itemBodyLayout = new QHBoxLayout;
+    layout->addSpacing( CalamaresUtils::defaultFontHeight() / 2 );
+    layout->addLayout( itemBodyLayout );
+    itemBodyLayout->addSpacing( CalamaresUtils::defaultFontHeight() * 2 );
+    QVBoxLayout* itemBodyCoreLayout = new QVBoxLayout;
+    itemBodyLayout->addLayout( itemBodyCoreLayout );
+    CalamaresUtils::unmarginLayout( itemBodyLayout );
+    if ( !text.isEmpty() )
+    {
+        itemBodyCoreLayout->addWidget( createBodyLabel( text, bodyPalette ) );
+    }
+    if ( widget )
+    {
+        itemBodyCoreLayout->addWidget( widget );
+    }
+    itemBodyLayout->addSpacing( CalamaresUtils::defaultFontHeight() * 2 );
+    return section;
+}
+
 // Adds a widget for those ViewSteps that want a summary;
 // see SummaryPage documentation and also ViewStep docs.
 void
 SummaryPage::onActivate()
 {
-    delete m_contentWidget;  // It might have been created previously
-    m_contentWidget = new QWidget;
-    m_layout = new QVBoxLayout( m_contentWidget );
-    CalamaresUtils::unmarginLayout( m_layout );
-
     QFont titleFont = font();
     titleFont.setWeight( QFont::Light );
     titleFont.setPointSize( CalamaresUtils::defaultFontSize() * 2 );
@@ -101,15 +143,39 @@ SummaryPage::onActivate()
     QPalette bodyPalette( palette() );
     bodyPalette.setColor( WindowBackground, palette().window().color().lighter( 108 ) );
 
+    // The sections are put back in order below; this only
+    // deletes the spacers, not the section widgets.
+    while ( QLayoutItem* item = m_layout->takeAt( 0 ) )
+    {
+        delete item;
+    }
+
     bool first = true;
+    int rebuilt = 0;
     const Calamares::ViewStepList steps = stepsForSummary( Calamares::ViewManager::instance()->viewSteps() );
+    QHash< const Calamares::ViewStep*, Section > sections;
 
     for ( Calamares::ViewStep* step : steps )
     {
-        QString text = step->prettyStatus();
-        QWidget* widget = step->createSummaryWidget();
+        const QString title = step->prettyName();
+        const QString text = step->prettyStatus();
 
-        if ( text.isEmpty() && !widget )
+        Section section = m_sections.take( step );
+        if ( section.dirty || section.title != title || section.text != text )
+        {
+            delete section.widget;
+            QWidget* widget = step->createSummaryWidget();
+            section = Section { ( text.isEmpty() && !widget )
+                                    ? nullptr
+                                    : createSection( title, text, widget, titleFont, bodyPalette ),
+                                title,
+                                text,
+                                false };
+            ++rebuilt;
+        }
+        sections.insert( step, section );
+
+        if ( !section.widget )
         {
             continue;
         }
@@ -122,28 +188,17 @@ SummaryPage::onActivate()
         {
             m_layout->addSpacing( SECTION_SPACING );
         }
-
-        m_layout->addWidget( createTitleLabel( step->prettyName(), titleFont ) );
-        QHBoxLayout* itemBodyLayout = new QHBoxLayout;
-        m_layout->addSpacing( CalamaresUtils::defaultFontHeight() / 2 );
-        m_layout->addLayout( itemBodyLayout );
-        itemBodyLayout->addSpacing( CalamaresUtils::defaultFontHeight() * 2 );
-        QVBoxLayout* itemBodyCoreLayout = new QVBoxLayout;
-        itemBodyLayout->addLayout( itemBodyCoreLayout );
-        CalamaresUtils::unmarginLayout( itemBodyLayout );
-        if ( !text.isEmpty() )
-        {
-            itemBodyCoreLayout->addWidget( createBodyLabel( text, bodyPalette ) );
-        }
-        if ( widget )
-        {
-            itemBodyCoreLayout->addWidget( widget );
-        }
-        itemBodyLayout->addSpacing( CalamaresUtils::defaultFontHeight() * 2 );
+        m_layout->addWidget( section.widget );
     }
     m_layout->addStretch();
 
-    m_scrollArea->setWidget( m_contentWidget );
+    // Whatever is left is for steps that are no longer summarized
+    for ( const auto& section : qAsConst( m_sections ) )
+    {
+        delete section.widget;
+    }
+    m_sections = sections;
+    cDebug() << "Summary rebuilt" << rebuilt << "of" << steps.count() << "steps.";
 
     auto summarySize = m_contentWidget->sizeHint();
     if ( summarySize.height() > m_scrollArea->size().height() )
@@ -186,10 +241,3 @@ SummaryPage::stepsForSummary( const Calamares::ViewStepList& allSteps ) const
 
     return steps;
 }
-
-void
-SummaryPage::onLeave()
-{
-    delete m_contentWidget;
-    m_contentWidget = nullptr;
-}
@@ -12,6 +12,7 @@
 
 #include "viewpages/ViewStep.h"
 
+#include <QHash>
 #include <QWidget>
 
 class Config;
@@ -40,6 +41,10 @@ class QVBoxLayout;
 *
 * If neither a (non-empty) string nor a widget is returned, the
 * step is not named in the summary.
+*
+* The summary of each step is kept, and only made again when the
+* step's title or text changes, or the step has been shown since
+* (because the user may have changed something there).
 */
 class SummaryPage : public QWidget
 {
@@ -49,16 +54,24 @@ public:
 
     /// @brief Create contents showing all of the summary
     void onActivate();
-    /// @brief Clean up the widgets
-    void onLeave();
 
 private:
+    /// @brief The summary of one step
+    struct Section
+    {
+        QWidget* widget = nullptr;  ///< Title and body, or nullptr if there is nothing to show
+        QString title;
+        QString text;
+        bool dirty = true;  ///< Must be made again
+    };
+
     Calamares::ViewStepList stepsForSummary( const Calamares::ViewStepList& allSteps ) const;
 
     const SummaryViewStep* m_thisViewStep;
 
     QVBoxLayout* m_layout = nullptr;
     QWidget* m_contentWidget = nullptr;
+    QHash< const Calamares::ViewStep*, Section > m_sections;
 
     QScrollArea* m_scrollArea;
 };
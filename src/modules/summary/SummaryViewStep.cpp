@@ -88,9 +88,3 @@ SummaryViewStep::onActivate()
     m_widget->onActivate();
 }
 
-
-void
-SummaryViewStep::onLeave()
-{
-    m_widget->onLeave();
-}
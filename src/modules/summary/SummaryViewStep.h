@@ -39,7 +39,6 @@ public:
     Calamares::JobList jobs() const override;
 
     void onActivate() override;
-    void onLeave() override;
 
 private:
     Config* m_config = nullptr;
@@ -112,6 +112,14 @@ InstallTrackingConfig::setConfigurationMap( const QVariantMap& configurationMap
 
     m_installTrackingUrl = CalamaresUtils::getString( configurationMap, "url" );
     validateUrl( m_installTrackingUrl );
+
+    // This one is optional, so an invalid URL does not disable install-tracking
+    m_performanceUrl = CalamaresUtils::getString( configurationMap, "performance-url" );
+    if ( !m_performanceUrl.isEmpty() && !QUrl( m_performanceUrl ).isValid() )
+    {
+        cWarning() << "Performance URL" << m_performanceUrl << "is not valid; no performance report is sent.";
+        m_performanceUrl = QString();
+    }
 }
 
 MachineTrackingConfig::MachineTrackingConfig( QObject* parent )
@@ -91,7 +91,9 @@ private:
  * Install tracking will do a single GET on the given URL at
  * the end of installation. The information included in the GET
  * request depends on the URL configuration, see also the tracking
- * jobs.
+ * jobs. If a performance URL is configured as well, the timing and
+ * resource usage of the jobs (see performanceReport()) are POSTed
+ * there after the installation, with the same consent.
  */
 class InstallTrackingConfig : public TrackingStyleConfig
 {
@@ -101,9 +103,12 @@ public:
     void setConfigurationMap( const QVariantMap& configurationMap );
 
     QString installTrackingUrl() { return m_installTrackingUrl; }
+    /// @brief Where to POST the performance report; empty for none
+    QString performanceUrl() const { return m_performanceUrl; }
 
 private:
     QString m_installTrackingUrl;
+    QString m_performanceUrl;
 };
 
 /** @brief Machine tracking reports from the installed system
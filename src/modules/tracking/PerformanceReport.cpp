@@ -0,0 +1,72 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "PerformanceReport.h"
+
+#include "CalamaresVersion.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+QByteArray
+performanceReport( const QVariantList& jobStatistics, const QVariantMap& traceSummary )
+{
+    QJsonArray rows;
+    for ( const auto& v : jobStatistics )
+    {
+        const QVariantMap job = v.toMap();
+        auto number = [ &job ]( const char* key ) { return job.value( key ).toLongLong(); };
+        rows.append( QJsonArray { job.value( "module" ).toString(),
+                                  number( "moduleJob" ),
+                                  number( "wallTime" ),
+                                  number( "userTime" ) + number( "systemTime" ),
+                                  number( "childUserTime" ) + number( "childSystemTime" ),
+                                  number( "peakRss" ),
+                                  number( "bytesRead" ),
+                                  number( "bytesWritten" ),
+                                  job.value( "success" ).toBool() } );
+    }
+
+    QJsonObject report { { "format", 1 },
+                         { "version", QStringLiteral( CALAMARES_VERSION ) },
+                         { "jobs",
+                           QJsonObject { { "fields",
+                                           QJsonArray { "module",
+                                                        "moduleJob",
+                                                        "wallTime",
+                                                        "cpuTime",
+                                                        "childCpuTime",
+                                                        "peakRss",
+                                                        "bytesRead",
+                                                        "bytesWritten",
+                                                        "success" } },
+                                         { "rows", rows } } } };
+
+    if ( !traceSummary.isEmpty() )
+    {
+        QJsonArray spans;
+        for ( const auto& v : traceSummary.value( "spans" ).toList() )
+        {
+            const QVariantMap span = v.toMap();
+            spans.append( QJsonArray { span.value( "name" ).toString(),
+                                       span.value( "count" ).toLongLong(),
+                                       span.value( "duration" ).toLongLong() } );
+        }
+        QJsonArray instants;
+        for ( const auto& v : traceSummary.value( "instants" ).toList() )
+        {
+            const QVariantMap instant = v.toMap();
+            instants.append(
+                QJsonArray { instant.value( "name" ).toString(), instant.value( "at" ).toLongLong() } );
+        }
+        report.insert( "startup", QJsonObject { { "spans", spans }, { "instants", instants } } );
+    }
+    return QJsonDocument( report ).toJson( QJsonDocument::Compact );
+}
@@ -0,0 +1,39 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef TRACKING_PERFORMANCEREPORT_H
+#define TRACKING_PERFORMANCEREPORT_H
+
+#include <QByteArray>
+#include <QVariantList>
+#include <QVariantMap>
+
+/** @brief The performance report that install-tracking can send
+ *
+ * This is compact JSON, meant for collecting from many machines:
+ *  - *format* is 1, for this layout;
+ *  - *version* is the Calamares version;
+ *  - *jobs* has *fields*, the names of the columns, and *rows*, one
+ *    list of values per job in @p jobStatistics (the *jobStatistics*
+ *    from global storage). The columns are the module instance and
+ *    the index of the job in that module, the wall-clock time and CPU
+ *    time (of the job, and of its child processes) in milliseconds,
+ *    peak RSS and bytes read and written, and whether the job succeeded;
+ *  - *startup* has *spans* ( [name, count, duration] ) and *instants*
+ *    ( [name, at] ) from the @p traceSummary (see
+ *    CalamaresUtils::Trace::summary()); it is left out if tracing
+ *    was off.
+ *
+ * The translated job names are not included: the modules identify
+ * the jobs, whatever the language of the installation. Nothing
+ * identifies the machine or the user.
+ */
+QByteArray performanceReport( const QVariantList& jobStatistics, const QVariantMap& traceSummary );
+
+#endif
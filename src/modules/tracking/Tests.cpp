@@ -5,9 +5,13 @@
  */
 
 #include "Config.h"
+#include "PerformanceReport.h"
 
 #include "utils/Logger.h"
 
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QObject>
 #include <QtTest/QtTest>
 
@@ -21,6 +25,8 @@ public:
 private Q_SLOTS:
     void initTestCase();
     void testEmptyConfig();
+    void testPerformanceUrl();
+    void testPerformanceReport();
 };
 
 TrackingTests::TrackingTests()
@@ -51,6 +57,73 @@ TrackingTests::testEmptyConfig()
     delete c;  // also deletes the owned tracking-configs
 }
 
+void
+TrackingTests::testPerformanceUrl()
+{
+    Config c;
+    QVERIFY( c.installTracking()->performanceUrl().isEmpty() );
+
+    QVariantMap install { { "enabled", true },
+                          { "policy", "https://example.com/policy" },
+                          { "url", "https://example.com/install" } };
+    c.setConfigurationMap( { { "install", install }, { "default", "none" } } );
+    QVERIFY( c.installTracking()->isConfigurable() );
+    QVERIFY( c.installTracking()->performanceUrl().isEmpty() );
+
+    install.insert( "performance-url", "https://example.com/performance" );
+    c.setConfigurationMap( { { "install", install }, { "default", "install" } } );
+    QVERIFY( c.installTracking()->isEnabled() );
+    QCOMPARE( c.installTracking()->performanceUrl(), QStringLiteral( "https://example.com/performance" ) );
+
+    // A bad performance URL leaves install-tracking alone
+    install.insert( "performance-url", "http://[bad" );
+    c.setConfigurationMap( { { "install", install }, { "default", "install" } } );
+    QVERIFY( c.installTracking()->isEnabled() );
+    QVERIFY( c.installTracking()->performanceUrl().isEmpty() );
+}
+
+void
+TrackingTests::testPerformanceReport()
+{
+    const QVariantList statistics {
+        QVariantMap { { "name", "Unpacking" },  // Translated, not sent
+                      { "module", "unpackfs@unpackfs" },
+                      { "moduleJob", 0 },
+                      { "wallTime", 60000 },
+                      { "userTime", 100 },
+                      { "systemTime", 20 },
+                      { "childUserTime", 50000 },
+                      { "childSystemTime", 5000 },
+                      { "peakRss", 1000 },
+                      { "bytesRead", 2000 },
+                      { "bytesWritten", 3000 },
+                      { "success", true } },
+        QVariantMap { { "module", "bootloader@bootloader" }, { "moduleJob", 1 }, { "success", false } }
+    };
+
+    const auto withoutTrace = QJsonDocument::fromJson( performanceReport( statistics, QVariantMap() ) ).object();
+    QCOMPARE( withoutTrace.value( "format" ).toInt(), 1 );
+    QVERIFY( !withoutTrace.value( "version" ).toString().isEmpty() );
+    QVERIFY( !withoutTrace.contains( "startup" ) );
+    const auto jobs = withoutTrace.value( "jobs" ).toObject();
+    QCOMPARE( jobs.value( "fields" ).toArray().count(), 9 );
+    const auto rows = jobs.value( "rows" ).toArray();
+    QCOMPARE( rows.count(), 2 );
+    QCOMPARE( rows.at( 0 ).toArray(),
+              QJsonArray( { "unpackfs@unpackfs", 0, 60000, 120, 55000, 1000, 2000, 3000, true } ) );
+    QCOMPARE( rows.at( 1 ).toArray(), QJsonArray( { "bootloader@bootloader", 1, 0, 0, 0, 0, 0, 0, false } ) );
+    QVERIFY( !performanceReport( statistics, QVariantMap() ).contains( "Unpacking" ) );
+
+    const QVariantMap trace {
+        { "spans", QVariantList { QVariantMap { { "name", "loadModules" }, { "count", 1 }, { "duration", 800 } } } },
+        { "instants", QVariantList { QVariantMap { { "name", "window shown" }, { "at", 1200 } } } }
+    };
+    const auto withTrace = QJsonDocument::fromJson( performanceReport( statistics, trace ) ).object();
+    const auto startup = withTrace.value( "startup" ).toObject();
+    QCOMPARE( startup.value( "spans" ).toArray(), QJsonArray( { QJsonArray( { "loadModules", 1, 800 } ) } ) );
+    QCOMPARE( startup.value( "instants" ).toArray(), QJsonArray( { QJsonArray( { "window shown", 1200 } ) } ) );
+}
+
 
 QTEST_GUILESS_MAIN( TrackingTests )
 
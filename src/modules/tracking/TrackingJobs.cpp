@@ -10,16 +10,23 @@
 #include "TrackingJobs.h"
 
 #include "Config.h"
+#include "PerformanceReport.h"
 
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 #include "network/Manager.h"
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/Logger.h"
+#include "utils/Trace.h"
 
 #include <KMacroExpander>
 
+#include <QCoreApplication>
+#include <QNetworkReply>
+#include <QTimer>
+
 #include <chrono>
+#include <memory>
 
 
 // Namespace keeps all the actual jobs anonymous, the
@@ -27,11 +34,133 @@
 namespace
 {
 
+/** @brief Sends tracking requests in the background
+ *
+ * The requests are made from the main thread, so the jobs only need
+ * to queue them (with send()) and are done immediately. A request
+ * that fails is tried again a few times, with a growing delay, even
+ * after the installation is finished; if Calamares quits before
+ * then, the request is dropped. Tracking never makes the
+ * installation take longer.
+ */
+class TrackingSender : public QObject
+{
+    Q_OBJECT
+public:
+    /// @brief The sender, which lives in the main thread
+    static TrackingSender* instance();
+
+    /// @brief Queue a GET on @p url, from any thread
+    static void enqueue( const QString& url );
+    /// @brief POST the performance report to @p url once the job queue is done, from any thread
+    static void enqueueReport( const QString& url );
+
+public Q_SLOTS:
+    /// @brief GET @p url, or POST @p report to it if that is not empty
+    void send( const QString& url, const QByteArray& report = QByteArray(), int attempt = 0 );
+    /// @brief POST the performance report, when the JobQueue has finished
+    void sendReportWhenFinished( const QString& url );
+
+private:
+    static constexpr int maxAttempts = 5;  ///< The first try, and up to four retries
+    static constexpr int retryDelayMs = 2000;
+};
+
+TrackingSender*
+TrackingSender::instance()
+{
+    static TrackingSender* sender = []() {
+        auto* s = new TrackingSender;
+        s->moveToThread( QCoreApplication::instance()->thread() );
+        return s;
+    }();
+    return sender;
+}
+
+void
+TrackingSender::enqueue( const QString& url )
+{
+    QMetaObject::invokeMethod( instance(),
+                               "send",
+                               Qt::QueuedConnection,
+                               Q_ARG( QString, url ),
+                               Q_ARG( QByteArray, QByteArray() ),
+                               Q_ARG( int, 0 ) );
+}
+
+void
+TrackingSender::enqueueReport( const QString& url )
+{
+    QMetaObject::invokeMethod( instance(), "sendReportWhenFinished", Qt::QueuedConnection, Q_ARG( QString, url ) );
+}
+
+void
+TrackingSender::sendReportWhenFinished( const QString& url )
+{
+    // The statistics of this run are in global storage only after the queue is done;
+    // this is queued before the job queue finishes, so it never misses that.
+    auto connection = std::make_shared< QMetaObject::Connection >();
+    auto* queue = Calamares::JobQueue::instance();
+    *connection = connect( queue, &Calamares::JobQueue::finished, this, [ this, queue, url, connection ]() {
+        disconnect( *connection );
+        const QByteArray report
+            = performanceReport( queue->globalStorage()->value( QStringLiteral( "jobStatistics" ) ).toList(),
+                                 CalamaresUtils::Trace::summary() );
+        cDebug() << "Sending performance report of" << report.size() << "bytes.";
+        send( url, report );
+    } );
+}
+
+void
+TrackingSender::send( const QString& url, const QByteArray& report, int attempt )
+{
+    using CalamaresUtils::Network::Manager;
+    using CalamaresUtils::Network::RequestOptions;
+
+    auto retry = [ this, url, report, attempt ]() {
+        if ( attempt + 1 < maxAttempts )
+        {
+            QTimer::singleShot(
+                retryDelayMs << attempt, this, [ this, url, report, attempt ]() { send( url, report, attempt + 1 ); } );
+        }
+        else
+        {
+            cWarning() << "install-tracking request failed" << maxAttempts << "times, giving up.";
+        }
+    };
+
+    const RequestOptions options(
+        RequestOptions::FollowRedirect | RequestOptions::FakeUserAgent | RequestOptions::AllowHttp2,
+        RequestOptions::milliseconds( 5000 ) );
+    auto& manager = Manager::instance();
+    auto* reply = report.isEmpty()
+        ? manager.asynchronousGet( QUrl( url ), options )
+        : manager.asynchronousPost( QUrl( url ), QByteArrayLiteral( "application/json" ), report, options );
+    if ( !reply )
+    {
+        retry();
+        return;
+    }
+    connect( reply, &QNetworkReply::finished, this, [ reply, retry ]() {
+        reply->deleteLater();
+        if ( reply->error() != QNetworkReply::NoError )
+        {
+            cDebug() << "install-tracking request error" << reply->error() << reply->errorString();
+            retry();
+        }
+        else
+        {
+            cDebug() << "install-tracking request done.";
+        }
+    } );
+}
+
 /** @brief Install-tracking job (gets a URL)
  *
  * The install-tracking job (there is only one kind) does a GET
  * on a configured URL with some additional information about
- * the machine (if configured into the URL).
+ * the machine (if configured into the URL). The request is
+ * made in the background by TrackingSender.
  *
  * No persistent tracking is done.
  */
@@ -50,6 +179,29 @@ private:
     const QString m_url;
 };
 
+/** @brief Performance report job (POSTs to a URL)
+ *
+ * This sends the timing and resource usage of the jobs, and a summary
+ * of the startup trace, to a configured URL. Since the report should
+ * cover all the jobs, including the ones after this one, it is sent
+ * when the job queue is finished. It goes along with install-tracking,
+ * and the same consent.
+ */
+class TrackingPerformanceJob : public Calamares::Job
+{
+    Q_OBJECT
+public:
+    TrackingPerformanceJob( const QString& url );
+    ~TrackingPerformanceJob() override;
+
+    QString prettyName() const override;
+    QString prettyStatusMessage() const override;
+    Calamares::JobResult exec() override;
+
+private:
+    const QString m_url;
+};
+
 /** @brief Tracking machines, update-manager style
  *
  * The machine has a machine-id, and this is sed(1)'ed into the
@@ -111,20 +263,38 @@ TrackingInstallJob::prettyStatusMessage() const
 Calamares::JobResult
 TrackingInstallJob::exec()
 {
-    using CalamaresUtils::Network::Manager;
-    using CalamaresUtils::Network::RequestOptions;
-    using CalamaresUtils::Network::RequestStatus;
-
-    auto result = Manager::instance().synchronousPing(
-        QUrl( m_url ),
-        RequestOptions( RequestOptions::FollowRedirect | RequestOptions::FakeUserAgent,
-                        RequestOptions::milliseconds( 5000 ) ) );
-    if ( result.status == RequestStatus::Timeout )
+    if ( !QUrl( m_url ).isValid() )
     {
-        cWarning() << "install-tracking request timed out.";
-        return Calamares::JobResult::error( tr( "Internal error in install-tracking." ),
-                                            tr( "HTTP request timed out." ) );
+        cWarning() << "install-tracking URL" << m_url << "is not valid.";
+        return Calamares::JobResult::ok();
     }
+    TrackingSender::enqueue( m_url );
+    return Calamares::JobResult::ok();
+}
+
+TrackingPerformanceJob::TrackingPerformanceJob( const QString& url )
+    : m_url( url )
+{
+}
+
+TrackingPerformanceJob::~TrackingPerformanceJob() {}
+
+QString
+TrackingPerformanceJob::prettyName() const
+{
+    return tr( "Installation performance report" );
+}
+
+QString
+TrackingPerformanceJob::prettyStatusMessage() const
+{
+    return tr( "Preparing the installation performance report." );
+}
+
+Calamares::JobResult
+TrackingPerformanceJob::exec()
+{
+    TrackingSender::enqueueReport( m_url );
     return Calamares::JobResult::ok();
 }
 
@@ -243,6 +413,12 @@ addJob( Calamares::JobList& list, InstallTrackingConfig* config )
         cDebug() << Logger::SubEntry << "install-tracking URL" << installUrl;
 
         list.append( Calamares::job_ptr( new TrackingInstallJob( installUrl ) ) );
+
+        if ( !config->performanceUrl().isEmpty() )
+        {
+            cDebug() << Logger::SubEntry << "performance report URL" << config->performanceUrl();
+            list.append( Calamares::job_ptr( new TrackingPerformanceJob( config->performanceUrl() ) ) );
+        }
     }
 }
 
@@ -12,8 +12,10 @@
 #
 
 import os
+import signal
 import subprocess
 import shutil
+import time
 
 import libcalamares
 from libcalamares.utils import gettext_path, gettext_languages
@@ -49,6 +51,39 @@ def list_mounts(root_mount_point):
     return lst
 
 
+def stop_package_download():
+    """
+    Stops the background package download of the *packages* module
+    (see its *download_only* option), if it is still running: it keeps
+    the target busy. Its process group gets SIGTERM, and SIGKILL
+    after five seconds.
+    """
+    if not libcalamares.globalstorage.contains("packagesDownload"):
+        return
+    try:
+        pid = int(libcalamares.globalstorage.value("packagesDownload"))
+    except (ValueError, TypeError):
+        return
+    libcalamares.globalstorage.remove("packagesDownload")
+
+    libcalamares.utils.warning("Package download (pid {!s}) is still running, stopping it".format(pid))
+    try:
+        os.killpg(pid, signal.SIGTERM)
+    except ProcessLookupError:
+        pass
+    try:
+        for _attempt in range(50):
+            if os.waitpid(pid, os.WNOHANG)[0] == pid:
+                break
+            time.sleep(0.1)
+        else:
+            os.killpg(pid, signal.SIGKILL)
+            os.waitpid(pid, 0)
+    except (ChildProcessError, ProcessLookupError):
+        # Already reaped, or gone
+        pass
+
+
 def run():
     """ Unmounts given mountpoints in decreasing order.
 
@@ -84,6 +119,10 @@ def run():
                 "globalstorage[\"rootMountPoint\"] is \"{}\", which does not "
                 "exist, doing nothing".format(root_mount_point))
 
+    # A persistent shell, or a download, in the target keeps it busy
+    libcalamares.utils.stop_target_shells()
+    stop_package_download()
+
     lst = list_mounts(root_mount_point)
     # Sort the list by mount point in decreasing order. This way we can be sure
     # we unmount deeper dirs first.
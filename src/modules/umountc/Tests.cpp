@@ -0,0 +1,118 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "UmountCJob.h"
+
+#include "utils/Logger.h"
+#include "utils/Yaml.h"
+
+#include <QFileInfo>
+#include <QtTest/QtTest>
+
+class UmountCTests : public QObject
+{
+    Q_OBJECT
+public:
+    UmountCTests() {}
+    ~UmountCTests() override {}
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testConfig();
+    void testParse();
+    void testOrder();
+    void testUnwritten();
+};
+
+void
+UmountCTests::initTestCase()
+{
+    Logger::setupLogLevel( Logger::LOGDEBUG );
+}
+
+void
+UmountCTests::testConfig()
+{
+    // BUILD_AS_TEST is the source-directory path
+    const QFileInfo fi( QString( "%1/umountc.conf" ).arg( BUILD_AS_TEST ) );
+    QVERIFY( fi.exists() );
+    bool ok = false;
+    const auto map = CalamaresUtils::loadYaml( fi, &ok );
+    QVERIFY( ok );
+
+    UmountCJob job;
+    job.setConfigurationMap( map );
+    QCOMPARE( job.sourceLog(), QStringLiteral( "/root/.cache/calamares/session.log" ) );
+    QCOMPARE( job.destinationLog(), QStringLiteral( "/var/log/Calamares.log" ) );
+}
+
+// A live system with a target in /tmp/calamares-root, on btrfs with subvolumes,
+// an ESP, bind mounts of /dev and /proc, and a tmpfs mounted over /tmp in the target.
+static const QByteArray mountinfo(
+    "22 1 0:20 / / rw,relatime shared:1 - overlay overlay rw,lowerdir=/run/rootfsbase\n"
+    "25 22 0:5 / /dev rw,nosuid shared:2 - devtmpfs devtmpfs rw,size=4041248k\n"
+    "26 22 0:21 / /proc rw,nosuid,nodev,noexec,relatime shared:3 - proc proc rw\n"
+    "100 22 0:45 /@ /tmp/calamares-root rw,relatime shared:50 - btrfs /dev/sda2 rw,ssd,subvol=/@\n"
+    "101 100 0:45 /@home /tmp/calamares-root/home rw,relatime shared:51 - btrfs /dev/sda2 rw,ssd,subvol=/@home\n"
+    "102 100 8:1 / /tmp/calamares-root/boot/efi rw,relatime shared:52 - vfat /dev/sda1 rw,fmask=0077\n"
+    "103 100 0:5 / /tmp/calamares-root/dev rw,nosuid shared:2 - devtmpfs devtmpfs rw,size=4041248k\n"
+    "104 100 0:21 / /tmp/calamares-root/proc rw,nosuid shared:3 - proc proc rw\n"
+    "105 100 0:46 / /tmp/calamares-root/tmp rw shared:53 - tmpfs tmpfs rw\n"
+    "106 105 0:47 / /tmp/calamares-root/tmp rw shared:54 - tmpfs tmpfs rw\n"
+    "107 22 7:0 / /run/media/live\\040image ro,relatime shared:55 - squashfs /dev/loop0 ro\n"
+    "this line is garbage\n" );
+
+void
+UmountCTests::testParse()
+{
+    const auto mounts = parseMountInfo( mountinfo );
+    QCOMPARE( mounts.count(), 11 );
+    QCOMPARE( mounts.at( 3 ).id, 100 );
+    QCOMPARE( mounts.at( 3 ).parent, 22 );
+    QCOMPARE( mounts.at( 3 ).device, QStringLiteral( "0:45" ) );
+    QCOMPARE( mounts.at( 3 ).mountPoint, QStringLiteral( "/tmp/calamares-root" ) );
+    QVERIFY( mounts.at( 3 ).writable );
+    QCOMPARE( mounts.at( 10 ).mountPoint, QStringLiteral( "/run/media/live image" ) );
+    QVERIFY( !mounts.at( 10 ).writable );
+}
+
+void
+UmountCTests::testOrder()
+{
+    const auto mounts = unmountOrder( parseMountInfo( mountinfo ), QStringLiteral( "/tmp/calamares-root" ) );
+    QStringList order;
+    for ( const auto& m : mounts )
+    {
+        order.append( QString::number( m.id ) );
+    }
+    // The tmpfs on top of the other tmpfs first, the root last
+    QCOMPARE( order, QStringList( { "106", "105", "104", "103", "102", "101", "100" } ) );
+
+    // Not a prefix match on the name
+    QVERIFY( unmountOrder( parseMountInfo( mountinfo ), QStringLiteral( "/tmp/calamares" ) ).isEmpty() );
+    QCOMPARE( unmountOrder( parseMountInfo( mountinfo ), QStringLiteral( "/tmp/calamares-root/home" ) ).count(), 1 );
+}
+
+void
+UmountCTests::testUnwritten()
+{
+    QCOMPARE( unwrittenBytes( QByteArray() ), qint64( 0 ) );
+    const QByteArray meminfo( "MemTotal:       16303428 kB\n"
+                              "Dirty:              1024 kB\n"
+                              "Writeback:           512 kB\n"
+                              "WritebackTmp:          7 kB\n" );
+    QCOMPARE( unwrittenBytes( meminfo ), qint64( 1536 * 1024 ) );
+}
+
+QTEST_GUILESS_MAIN( UmountCTests )
+
+#include "utils/moc-warnings.h"
+
+#include "Tests.moc"
@@ -0,0 +1,349 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "UmountCJob.h"
+
+#include "GlobalStorage.h"
+#include "JobQueue.h"
+#include "utils/CalamaresUtilsSystem.h"
+#include "utils/Executor.h"
+#include "utils/FileCopy.h"
+#include "utils/Logger.h"
+#include "utils/Units.h"
+#include "utils/Variant.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutexLocker>
+#include <QSet>
+#include <QThread>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <csignal>
+#include <sys/mount.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/// @brief Decodes the octal escapes (e.g. \040 for space) in a mountinfo field
+static QString
+decodeField( const QByteArray& field )
+{
+    QByteArray path;
+    path.reserve( field.length() );
+    for ( int i = 0; i < field.length(); ++i )
+    {
+        if ( field.at( i ) == '\\' && i + 3 < field.length() )
+        {
+            bool ok = false;
+            const int c = field.mid( i + 1, 3 ).toInt( &ok, 8 );
+            if ( ok )
+            {
+                path.append( char( c ) );
+                i += 3;
+                continue;
+            }
+        }
+        path.append( field.at( i ) );
+    }
+    return QFile::decodeName( path );
+}
+
+QList< MountInfo >
+parseMountInfo( const QByteArray& mountinfo )
+{
+    QList< MountInfo > mounts;
+    for ( const auto& line : mountinfo.split( '\n' ) )
+    {
+        // id parent major:minor root mount-point options [optional..] - type source super-options
+        const auto fields = line.split( ' ' );
+        const int separator = fields.indexOf( "-" );
+        if ( fields.count() < 6 || separator < 6 || separator + 3 >= fields.count() )
+        {
+            continue;
+        }
+        MountInfo m;
+        m.id = fields.at( 0 ).toInt();
+        m.parent = fields.at( 1 ).toInt();
+        m.device = QString::fromLatin1( fields.at( 2 ) );
+        m.mountPoint = decodeField( fields.at( 4 ) );
+        m.writable = fields.at( separator + 3 ).split( ',' ).contains( "rw" );
+        mounts.append( m );
+    }
+    return mounts;
+}
+
+QList< MountInfo >
+unmountOrder( const QList< MountInfo >& mounts, const QString& root )
+{
+    const QString prefix = root.endsWith( '/' ) ? root : root + '/';
+    QList< MountInfo > below;
+    QHash< int, int > parentOf;
+    for ( const auto& m : mounts )
+    {
+        if ( m.mountPoint == root || m.mountPoint.startsWith( prefix ) )
+        {
+            below.append( m );
+            parentOf.insert( m.id, m.parent );
+        }
+    }
+
+    // The depth in the mount tree, counting only the mounts below root
+    QHash< int, int > depth;
+    for ( const auto& m : qAsConst( below ) )
+    {
+        int d = 0;
+        for ( int p = m.parent; parentOf.contains( p ) && d <= below.count(); p = parentOf.value( p ) )
+        {
+            ++d;
+        }
+        depth.insert( m.id, d );
+    }
+
+    // Deepest first; of equally deep ones, the last mounted first
+    std::reverse( below.begin(), below.end() );
+    std::stable_sort( below.begin(), below.end(), [ &depth ]( const MountInfo& a, const MountInfo& b ) {
+        return depth.value( a.id ) > depth.value( b.id );
+    } );
+    return below;
+}
+
+qint64
+unwrittenBytes( const QByteArray& meminfo )
+{
+    qint64 kiB = 0;
+    for ( const auto& line : meminfo.split( '\n' ) )
+    {
+        if ( line.startsWith( "Dirty:" ) || line.startsWith( "Writeback:" ) )
+        {
+            // e.g. "Dirty:             1234 kB"
+            kiB += line.simplified().split( ' ' ).value( 1 ).toLongLong();
+        }
+    }
+    return kiB * 1024;
+}
+
+static QByteArray
+readProcFile( const QString& path )
+{
+    QFile f( path );
+    return f.open( QIODevice::ReadOnly ) ? f.readAll() : QByteArray();
+}
+
+/// @brief Calls syncfs(2) for each of @p mountPoints
+static void
+syncFilesystems( const QStringList& mountPoints )
+{
+    for ( const auto& mountPoint : mountPoints )
+    {
+        const int fd = ::open( QFile::encodeName( mountPoint ).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+        if ( fd < 0 )
+        {
+            cWarning() << "Could not open" << mountPoint << "to sync it.";
+            continue;
+        }
+        if ( ::syncfs( fd ) != 0 )
+        {
+            cWarning() << "Could not sync" << mountPoint << std::strerror( errno );
+        }
+        ::close( fd );
+    }
+}
+
+UmountCJob::UmountCJob( QObject* parent )
+    : Calamares::CppJob( parent )
+{
+}
+
+UmountCJob::~UmountCJob() {}
+
+QString
+UmountCJob::prettyName() const
+{
+    return tr( "Unmount file systems." );
+}
+
+QString
+UmountCJob::prettyStatusMessage() const
+{
+    QMutexLocker lock( &m_statusMutex );
+    return m_status.isEmpty() ? prettyName() : m_status;
+}
+
+void
+UmountCJob::setStatus( const QString& status )
+{
+    QMutexLocker lock( &m_statusMutex );
+    m_status = status;
+}
+
+/** @brief Stops the background package download, if it is still running
+ *
+ * The *packages* module (with *download_only*) leaves a download running
+ * in the target, with its process ID in GlobalStorage; normally a later
+ * *packages* instance waits for it. Whatever is left keeps the target
+ * busy, so its process group gets SIGTERM, and SIGKILL after five seconds.
+ */
+static void
+stopPackageDownload( Calamares::GlobalStorage* gs )
+{
+    if ( !gs->contains( "packagesDownload" ) )
+    {
+        return;
+    }
+    bool ok = false;
+    const pid_t pid = pid_t( gs->value( "packagesDownload" ).toLongLong( &ok ) );
+    gs->remove( "packagesDownload" );
+    if ( !ok || pid <= 0 )
+    {
+        return;
+    }
+
+    cWarning() << "Package download" << pid << "is still running, stopping it.";
+    ::kill( -pid, SIGTERM );
+    for ( int attempt = 0; attempt < 50; ++attempt )
+    {
+        const pid_t r = ::waitpid( pid, nullptr, WNOHANG );
+        if ( r == pid || ( r < 0 && errno == ECHILD ) )
+        {
+            return;
+        }
+        QThread::msleep( 100 );
+    }
+    ::kill( -pid, SIGKILL );
+    ::waitpid( pid, nullptr, 0 );
+}
+
+Calamares::JobResult
+UmountCJob::exec()
+{
+    Calamares::GlobalStorage* gs = Calamares::JobQueue::instance()->globalStorage();
+    const QString rootMountPoint = gs ? gs->value( "rootMountPoint" ).toString() : QString();
+    if ( rootMountPoint.isEmpty() )
+    {
+        return Calamares::JobResult::error( tr( "No mount point for root partition in globalstorage" ),
+                                            tr( "globalstorage does not contain a \"rootMountPoint\" key." ) );
+    }
+    const QFileInfo rootInfo( rootMountPoint );
+    if ( !rootInfo.isDir() )
+    {
+        return Calamares::JobResult::error(
+            tr( "Bad mount point for root partition in globalstorage" ),
+            tr( "rootMountPoint is \"%1\", which does not exist." ).arg( rootMountPoint ) );
+    }
+    const QString root = rootInfo.canonicalFilePath();
+
+    if ( !m_sourceLog.isEmpty() && !m_destinationLog.isEmpty() && QFileInfo::exists( m_sourceLog ) )
+    {
+        const QString destination = QDir::cleanPath( root + '/' + m_destinationLog );
+        if ( !CalamaresUtils::copyFile( m_sourceLog, destination ) )
+        {
+            cWarning() << "Could not preserve file" << m_sourceLog;
+        }
+    }
+
+    // A persistent shell, or a download, in the target keeps it busy
+    CalamaresUtils::System::stopTargetShells();
+    stopPackageDownload( gs );
+    const auto mounts
+        = unmountOrder( parseMountInfo( readProcFile( QStringLiteral( "/proc/self/mountinfo" ) ) ), root );
+    cDebug() << "Unmounting" << mounts.count() << "mount points below" << root;
+
+    // One sync for each filesystem that can have data to write; bind
+    // mounts (e.g. btrfs subvolumes) of the same filesystem are synced once.
+    QStringList toSync;
+    QSet< QString > devices;
+    for ( const auto& m : mounts )
+    {
+        if ( m.writable && !devices.contains( m.device ) )
+        {
+            devices.insert( m.device );
+            toSync.append( m.mountPoint );
+        }
+    }
+
+    // The flush is most of the work, so it is most of the progress
+    static constexpr const qreal flushWeight = 0.9;
+    const qint64 unwrittenAtStart = unwrittenBytes( readProcFile( QStringLiteral( "/proc/meminfo" ) ) );
+    cDebug() << Logger::SubEntry << "Syncing" << toSync.count() << "filesystems," << unwrittenAtStart
+             << "bytes to write.";
+    setStatus( tr( "Writing data to disk." ) );
+    emit progress( 0.0 );
+    auto syncing = CalamaresUtils::Executor::run(
+        CalamaresUtils::Executor::Lane::Background, "umountc-sync", [ toSync ]() { syncFilesystems( toSync ); } );
+    qreal flushed = 0.0;
+    while ( !syncing.isFinished() )
+    {
+        QThread::msleep( 100 );
+        const qint64 unwritten = unwrittenBytes( readProcFile( QStringLiteral( "/proc/meminfo" ) ) );
+        if ( unwrittenAtStart > 0 )
+        {
+            // Other writes may add to it, but the progress never goes back
+            flushed = qMax( flushed, qBound( 0.0, 1.0 - qreal( unwritten ) / unwrittenAtStart, 1.0 ) );
+        }
+        setStatus( tr( "Writing data to disk, %1 MiB left." )
+                       .arg( qRound( CalamaresUtils::BytesToMiB( unwritten ) ) ) );
+        emit progress( flushWeight * flushed );
+    }
+    syncing.waitForFinished();
+    emit progress( flushWeight );
+
+    setStatus( tr( "Unmounting file systems." ) );
+    QStringList failed;
+    for ( int i = 0; i < mounts.count(); ++i )
+    {
+        const QString& mountPoint = mounts.at( i ).mountPoint;
+        const QByteArray target = QFile::encodeName( mountPoint );
+        if ( ::umount2( target.constData(), 0 ) != 0 )
+        {
+            const int error = errno;
+            if ( error == EINVAL || error == ENOENT )
+            {
+                // Gone already, e.g. with its parent when the mount was propagated
+                cDebug() << Logger::SubEntry << mountPoint << "is not mounted any more.";
+            }
+            else if ( error == EBUSY && ::umount2( target.constData(), MNT_DETACH ) == 0 )
+            {
+                // The data was synced above, a lazy unmount does not lose it
+                cWarning() << mountPoint << "is busy, detached it.";
+            }
+            else
+            {
+                cWarning() << "Could not unmount" << mountPoint << std::strerror( error );
+                failed.append( mountPoint );
+            }
+        }
+        emit progress( flushWeight + ( 1.0 - flushWeight ) * ( i + 1 ) / mounts.count() );
+    }
+    setStatus( QString() );
+    if ( !failed.isEmpty() )
+    {
+        return Calamares::JobResult::error( tr( "Could not unmount file systems." ), failed.join( '\n' ) );
+    }
+
+    if ( !QDir().rmdir( root ) )
+    {
+        cWarning() << "Could not remove" << root;
+    }
+    return Calamares::JobResult::ok();
+}
+
+void
+UmountCJob::setConfigurationMap( const QVariantMap& configurationMap )
+{
+    m_sourceLog = CalamaresUtils::getString( configurationMap, "srcLog" );
+    m_destinationLog = CalamaresUtils::getString( configurationMap, "destLog" );
+}
+
+CALAMARES_PLUGIN_FACTORY_DEFINITION( UmountCJobFactory, registerPlugin< UmountCJob >(); )
@@ -0,0 +1,85 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef UMOUNTCJOB_H
+#define UMOUNTCJOB_H
+
+#include "CppJob.h"
+#include "DllMacro.h"
+#include "utils/PluginFactory.h"
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QVariantMap>
+
+/** @brief Unmounts the target system
+ *
+ * This does what the umount module does, with the same configuration:
+ * it copies the log into the target system, and unmounts everything
+ * below rootMountPoint. Each filesystem is synced once, before any
+ * unmounting, while the progress shows how much data is still to be
+ * written. Then the mount points are unmounted with umount2(2) in the
+ * order of the mount tree, children before their parents.
+ */
+class PLUGINDLLEXPORT UmountCJob : public Calamares::CppJob
+{
+    Q_OBJECT
+
+public:
+    explicit UmountCJob( QObject* parent = nullptr );
+    ~UmountCJob() override;
+
+    QString prettyName() const override;
+    QString prettyStatusMessage() const override;
+
+    Calamares::JobResult exec() override;
+
+    void setConfigurationMap( const QVariantMap& configurationMap ) override;
+
+    QString sourceLog() const { return m_sourceLog; }
+    QString destinationLog() const { return m_destinationLog; }
+
+private:
+    void setStatus( const QString& status );
+
+    QString m_sourceLog;
+    QString m_destinationLog;
+
+    mutable QMutex m_statusMutex;
+    QString m_status;
+};
+
+/// @brief A line of /proc/self/mountinfo
+struct MountInfo
+{
+    int id = 0;
+    int parent = 0;
+    QString device;  ///< major:minor of the filesystem; bind mounts share it
+    QString mountPoint;
+    bool writable = false;  ///< The filesystem (not just this mount) is read-write
+};
+
+/// @brief Parses @p mountinfo, in the format of /proc/self/mountinfo
+QList< MountInfo > parseMountInfo( const QByteArray& mountinfo );
+
+/** @brief The mounts at, or below, @p root, in the order to unmount them
+ *
+ * A mount comes before the mount it is on (its parent); a mount that
+ * hides another one at the same mount point is its child, so it comes
+ * first as well.
+ */
+QList< MountInfo > unmountOrder( const QList< MountInfo >& mounts, const QString& root );
+
+/// @brief The data that is still to be written, from @p meminfo (/proc/meminfo): Dirty and Writeback
+qint64 unwrittenBytes( const QByteArray& meminfo );
+
+CALAMARES_PLUGIN_FACTORY_DECLARATION( UmountCJobFactory )
+
+#endif  // UMOUNTCJOB_H
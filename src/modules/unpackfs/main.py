@@ -15,9 +15,11 @@
 #   Calamares is Free Software: see the License-Identifier above.
 #
 
+import hashlib
 import os
 import re
 import shutil
+import struct
 import subprocess
 import sys
 import tempfile
@@ -49,7 +51,7 @@ class UnpackEntry:
     :param destination:
     """
     __slots__ = ('source', 'sourcefs', 'destination', 'copied', 'total', 'exclude', 'excludeFile',
-                 'mountPoint', 'weight')
+                 'mountPoint', 'weight', 'receive', 'delta', 'deltaChecksum', 'deltaDelete')
 
     def __init__(self, source, sourcefs, destination):
         """
@@ -72,6 +74,10 @@ class UnpackEntry:
         self.total = 0
         self.mountPoint = None
         self.weight = 1
+        self.receive = None
+        self.delta = False
+        self.deltaChecksum = False
+        self.deltaDelete = False
 
     def is_file(self):
         return self.sourcefs == "file"
@@ -79,9 +85,23 @@ class UnpackEntry:
     def do_count(self):
         """
         Counts the number of files this entry has.
+
+        A squashfs image records its number of inodes in the superblock,
+        and a directory (or other image) may have a pre-computed count
+        stored next to it, see cached_count(); only when neither is
+        available are the files listed and counted.
         """
         fslist = ""
 
+        count = cached_count(self.source)
+        if count is None and self.sourcefs == "squashfs":
+            superblock = squashfs_superblock(self.source)
+            if superblock is not None:
+                count = superblock[0]
+        if count is not None:
+            self.total = count
+            return self.total
+
         if self.sourcefs == "squashfs":
             fslist = subprocess.check_output(
                 ["unsquashfs", "-l", self.source]
@@ -137,6 +157,54 @@ class UnpackEntry:
 ON_POSIX = 'posix' in sys.builtin_module_names
 
 
+def squashfs_superblock(path):
+    """
+    Reads the superblock of the squashfs image @p path.
+
+    Returns a tuple (inodes, bytes_used) with the number of inodes
+    and the size of the image in bytes, or None if @p path is
+    not a (readable) squashfs 4 image.
+    """
+    try:
+        with open(path, "rb") as f:
+            superblock = f.read(48)
+    except OSError as e:
+        utils.warning("Could not read squashfs superblock of {}: {}".format(path, e))
+        return None
+    if len(superblock) < 48:
+        return None
+
+    # little-endian: magic, inodes, mkfs time, block size, fragments,
+    # compression, block log, flags, ids, major, minor, root inode, bytes used
+    magic, inodes = struct.unpack_from("<II", superblock, 0)
+    major = struct.unpack_from("<H", superblock, 28)[0]
+    bytes_used = struct.unpack_from("<Q", superblock, 40)[0]
+    if magic != 0x73717368 or major != 4:
+        return None
+    return (inodes, bytes_used)
+
+
+def cached_count(source):
+    """
+    Returns the number of files in @p source, if that has been stored
+    (e.g. when building the ISO) in a file next to it, named like the
+    source with ".count" appended (so "/run/rootfs.count" for a
+    source "/run/rootfs/"). The file holds just the number.
+
+    Returns None if there is no such file, or it does not hold a number.
+    """
+    count_file = source.rstrip("/") + ".count"
+    if not os.path.isfile(count_file):
+        return None
+    try:
+        with open(count_file, "r") as f:
+            count = int(f.read().strip())
+        return count if count > 0 else None
+    except (OSError, ValueError) as e:
+        utils.warning("Ignoring file count in {}: {}".format(count_file, e))
+        return None
+
+
 def global_excludes():
     """
     List excludes for rsync.
@@ -154,6 +222,201 @@ def global_excludes():
 
     return lst
 
+def mounted_filesystem(path):
+    """
+    Returns a tuple (device, fstype) for the filesystem that holds @p path,
+    or None if that cannot be determined. @p path need not exist yet;
+    its closest existing parent is used. The device does not include
+    the btrfs subvolume, so all the subvolumes of one btrfs filesystem
+    give the same device.
+    """
+    while path and not os.path.exists(path):
+        path = os.path.dirname(path.rstrip("/"))
+    if not path:
+        return None
+    try:
+        output = subprocess.check_output(
+            ["findmnt", "--noheadings", "--output", "SOURCE,FSTYPE", "--target", path],
+            stderr=subprocess.DEVNULL
+            ).decode()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+    fields = output.split()
+    if len(fields) != 2:
+        return None
+    return (fields[0].split("[")[0], fields[1])
+
+
+def can_reflink(source, entry):
+    """
+    Can @p source (the actual path to copy for @p entry) be copied
+    by reflinking (sharing the data blocks) instead of rsync?
+
+    That is if source and destination are on the same btrfs or xfs
+    filesystem, and there is nothing to exclude that is in the source:
+    cp has no excludes, so entry-specific excludes always need rsync,
+    and the extraMounts may not be there in the source (except
+    as empty directories, like a root filesystem has them).
+    """
+    if entry.exclude or entry.excludeFile:
+        return False
+    source_fs = mounted_filesystem(source)
+    if source_fs is None or source_fs[1] not in ("btrfs", "xfs"):
+        return False
+    if source_fs != mounted_filesystem(entry.destination):
+        return False
+
+    if os.path.isdir(source):
+        for extra_mount in globalstorage.value("extraMounts") or []:
+            mount_point = extra_mount["mountPoint"]
+            if not mount_point:
+                continue
+            path = os.path.join(source, mount_point.lstrip("/"))
+            if os.path.isdir(path) and not os.path.islink(path) and os.listdir(path):
+                return False
+            if os.path.exists(path) and not os.path.isdir(path):
+                return False
+    return True
+
+
+def reflink_copy(source, entry, progress_cb):
+    """
+    Copies @p source to the destination of @p entry with
+    cp --reflink, preserving hardlinks, ownership, xattrs and ACLs
+    like rsync -aHAX does. Where reflinking is not possible for
+    a file, cp falls back to a regular copy.
+
+    Returns None on success, or the error message if cp fails.
+    """
+    dest = entry.destination
+    if os.path.isdir(source):
+        # Copy what is in the directory, like rsync with a trailing /
+        source = source.rstrip("/") + "/."
+
+    at_env = dict(os.environ)
+    at_env["LC_ALL"] = "C"
+
+    args = ["cp", "--archive", "--reflink=auto", "--verbose", source, dest]
+    process = subprocess.Popen(
+        args, env=at_env,
+        stdout=subprocess.PIPE, close_fds=ON_POSIX
+        )
+
+    # cp --verbose prints one line per file or directory copied
+    num_files_copied = 0
+    last_num_files_copied = 0
+    file_count_chunk = 107
+    for line in iter(process.stdout.readline, b''):
+        num_files_copied += 1
+        if num_files_copied - last_num_files_copied >= file_count_chunk:
+            last_num_files_copied = num_files_copied
+            progress_cb(num_files_copied, max(entry.total, num_files_copied))
+
+    process.wait()
+
+    if process.returncode != 0:
+        utils.warning("cp failed with error code {}.".format(process.returncode))
+        return _("cp failed with error code {}.").format(process.returncode)
+
+    # cp has no excludes for xattrs, so remove afterwards what
+    # rsync leaves out with --filter=-x trusted.overlay.*
+    stripped = strip_overlay_xattrs(dest)
+    if stripped:
+        utils.debug("Removed overlayfs xattrs from {} files in {}".format(stripped, dest))
+    entry.copied = entry.total
+    progress_cb(entry.total, entry.total)
+    return None
+
+
+def strip_overlay_xattrs(path):
+    """
+    Removes the trusted.overlay.* extended attributes (which overlayfs
+    keeps in its layers, and which mean nothing in the target) from
+    @p path and everything below it, on the same filesystem.
+
+    Returns the number of files that had any.
+    """
+    try:
+        device = os.lstat(path).st_dev
+    except OSError:
+        return 0
+
+    def strip(name):
+        try:
+            attrs = [a for a in os.listxattr(name, follow_symlinks=False)
+                     if a.startswith("trusted.overlay.")]
+            for a in attrs:
+                os.removexattr(name, a, follow_symlinks=False)
+        except OSError:
+            return 0
+        return 1 if attrs else 0
+
+    count = strip(path)
+    for root, dirs, files in os.walk(path):
+        # Other filesystems in the target were not copied to
+        dirs[:] = [d for d in dirs if os.lstat(os.path.join(root, d)).st_dev == device]
+        for name in dirs + files:
+            count += strip(os.path.join(root, name))
+    return count
+
+
+# Directories of a delta destination that deltaDelete never removes
+# anything from, relative to the destination.
+USER_DATA = ["/home", "/root", "/srv"]
+
+
+def mounts_below(path):
+    """
+    Returns the mount points strictly below @p path (e.g. a separate
+    /home in the target system), relative to @p path and with a
+    leading /, from /proc/self/mounts.
+    """
+    base = os.path.abspath(path).rstrip("/") + "/"
+    mounts = []
+    try:
+        with open("/proc/self/mounts", "r") as f:
+            for line in f.readlines():
+                fields = line.split()
+                if len(fields) < 2:
+                    continue
+                # Spaces and such are escaped as octal, e.g. \040
+                mount_point = re.sub(r"\\([0-7]{3})", lambda m: chr(int(m.group(1), 8)), fields[1])
+                relative = mount_point[len(base):].strip("/") if mount_point.startswith(base) else None
+                if relative:
+                    mounts.append("/" + relative)
+    except OSError as e:
+        utils.warning("Could not read the mounts: {}".format(e))
+    return mounts
+
+
+def scan_target(destination):
+    """
+    Reads the metadata of everything in @p destination, one thread per
+    top-level directory, so that rsync -- which compares one file at
+    a time -- finds it in the kernel's caches. Returns the number of
+    files that were found.
+    """
+    from concurrent.futures import ThreadPoolExecutor
+
+    def scan(top):
+        count = 0
+        for root, dirs, files in os.walk(top):
+            for name in files:
+                try:
+                    os.lstat(os.path.join(root, name))
+                    count += 1
+                except OSError:
+                    pass
+        return count
+
+    try:
+        tops = [e.path for e in os.scandir(destination) if e.is_dir(follow_symlinks=False)]
+    except OSError:
+        return 0
+    with ThreadPoolExecutor(max_workers=min(8, 2 * (os.cpu_count() or 1))) as executor:
+        return sum(executor.map(scan, tops))
+
+
 def file_copy(source, entry, progress_cb):
     """
     Extract given image using rsync.
@@ -189,6 +452,19 @@ def file_copy(source, entry, progress_cb):
     if entry.exclude:
         for f in entry.exclude:
             args.extend(["--exclude", f])
+    if entry.delta:
+        # Keep what is the same on the target already; rsync skips files
+        # whose size and modification time match.
+        if os.path.isdir(dest):
+            utils.debug("Delta copy to {}, {} files there".format(dest, scan_target(dest)))
+        if entry.deltaChecksum:
+            args.append('--checksum')
+        if entry.deltaDelete:
+            # Remove what is not in the image, but never user data nor
+            # anything in other filesystems in the target.
+            args.append('--delete')
+            for protected in USER_DATA + mounts_below(dest):
+                args.extend(['--filter=P ' + protected.rstrip("/") + '/'])
     args.extend(['--progress', source, dest])
     process = subprocess.Popen(
         args, env=at_env,
@@ -204,6 +480,12 @@ def file_copy(source, entry, progress_cb):
     file_count_chunk = 107
 
     for line in iter(process.stdout.readline, b''):
+        if job.cancelled():
+            # Stop rsync now, rather than after the whole copy
+            process.terminate()
+            process.wait()
+            return _("The copy was cancelled.")
+
         # rsync outputs progress in parentheses. Each line will have an
         # xfer and a chk item (either ir-chk or to-chk) as follows:
         #
@@ -257,6 +539,140 @@ def file_copy(source, entry, progress_cb):
     return None
 
 
+def read_chunk_checksums(path):
+    """
+    Reads the chunk checksums of an image that is received, from @p path.
+
+    The first line of the file is the chunk size in bytes; then there
+    is one SHA-256 checksum (in hex) for each consecutive chunk of the
+    image. The last chunk may be shorter. Make such a file with, e.g.,
+
+        ( echo 4194304 ; split -b 4194304 --filter=sha256sum image | cut -d' ' -f1 ) > image.chunks
+
+    Returns a tuple (chunk size, list of checksums), or None if
+    the file can not be read.
+    """
+    try:
+        with open(path, "r") as f:
+            lines = [l.strip() for l in f.readlines() if l.strip()]
+        chunk_size = int(lines[0])
+    except (OSError, IndexError, ValueError) as e:
+        utils.warning("Could not read chunk checksums from {}: {}".format(path, e))
+        return None
+    if chunk_size <= 0:
+        utils.warning("Bad chunk size {} in {}".format(chunk_size, path))
+        return None
+    return (chunk_size, [l.lower() for l in lines[1:]])
+
+
+def repair_chunks(entry, fallback, chunk_size, checksums, bad_chunks):
+    """
+    Reads the chunks @p bad_chunks (indexes) of the image received for
+    @p entry again, from the image @p fallback (e.g. on a network share),
+    and writes them in place.
+
+    Returns None on success, or an error message.
+    """
+    utils.debug("Reading {} chunks of {} from {}".format(len(bad_chunks), entry.source, fallback))
+    try:
+        with open(fallback, "rb") as source, open(entry.source, "r+b") as out:
+            for index in bad_chunks:
+                source.seek(index * chunk_size)
+                chunk = source.read(chunk_size)
+                if hashlib.sha256(chunk).hexdigest() != checksums[index]:
+                    return _("Chunk {} of \"{}\" is damaged").format(index, fallback)
+                out.seek(index * chunk_size)
+                out.write(chunk)
+    except OSError as e:
+        return str(e)
+    return None
+
+
+def receive_image(entry, progress):
+    """
+    Receives the image for @p entry, which has a *receive* setting.
+
+    The *command* (e.g. udp-receiver from udpcast, where one sender
+    feeds all the machines in a room, or a peer-to-peer client) writes
+    the image to stdout; that is stored as the entry's source. With
+    *checksums*, each chunk is checked as it comes in; chunks that do
+    not match, or that are missing, are read from the *fallback* image
+    afterwards, so a damaged stream costs just those chunks over
+    the network. The progress of the job stays at @p progress.
+
+    Returns None on success, or an error message; then nothing of the
+    image is left in the target.
+    """
+    error_msg = _receive_image(entry, progress)
+    if error_msg:
+        try:
+            os.remove(entry.source)
+        except OSError:
+            pass
+    return error_msg
+
+
+def _receive_image(entry, progress):
+    """
+    Does the work of receive_image(), which cleans up after an error.
+    """
+    global status
+    chunk_size = 1024 * 1024
+    checksums = None
+    if entry.receive.get("checksums", None):
+        r = read_chunk_checksums(entry.receive["checksums"])
+        if r is None:
+            return _("Could not read the chunk checksums \"{}\"").format(entry.receive["checksums"])
+        chunk_size, checksums = r
+    fallback = entry.receive.get("fallback", None)
+
+    utils.debug("Receiving {} with {!r}".format(entry.source, entry.receive["command"]))
+    index = 0
+    received = 0
+    bad_chunks = []
+    process = None
+    try:
+        os.makedirs(os.path.dirname(entry.source), exist_ok=True)
+        with open(entry.source, "wb") as out:
+            process = subprocess.Popen(entry.receive["command"], stdout=subprocess.PIPE, close_fds=ON_POSIX)
+            while True:
+                chunk = process.stdout.read(chunk_size)
+                if not chunk:
+                    break
+                if checksums is not None:
+                    if index >= len(checksums):
+                        return _("The image received for \"{}\" is too large").format(entry.source)
+                    if hashlib.sha256(chunk).hexdigest() != checksums[index]:
+                        bad_chunks.append(index)
+                out.write(chunk)
+                index += 1
+                received += len(chunk)
+                status = _("Receiving image {}, {} MiB").format(entry.source, received // (1024 * 1024))
+                job.setprogress(progress)
+            exit_code = process.wait()
+    except OSError as e:
+        return str(e)
+    finally:
+        # On every way out early, do not leave the receiver running
+        if process is not None and process.poll() is None:
+            process.kill()
+            process.wait()
+
+    if exit_code != 0:
+        utils.warning("Receiving {} stopped with exit code {}".format(entry.source, exit_code))
+        if checksums is None or not fallback:
+            return _("Receiving the image \"{}\" failed").format(entry.source)
+    if checksums is not None:
+        bad_chunks += range(index, len(checksums))
+    if bad_chunks:
+        if not fallback:
+            return _("{} chunks of the image \"{}\" are damaged").format(len(bad_chunks), entry.source)
+        status = _("Repairing image {}").format(entry.source)
+        job.setprogress(progress)
+        return repair_chunks(entry, fallback, chunk_size, checksums, bad_chunks)
+    return None
+
+
 class UnpackOperation:
     """
     Extraction routine using unsquashfs.
@@ -314,11 +730,19 @@ class UnpackOperation:
             for entry in self.entries:
                 status = _("Starting to unpack {}").format(entry.source)
                 job.setprogress( ( 1.0 * complete ) / len(self.entries) )
+                if entry.receive:
+                    error_msg = receive_image(entry, ( 1.0 * complete ) / len(self.entries))
+                    if error_msg:
+                        return (_("Failed to receive image \"{}\"").format(entry.source),
+                                error_msg)
                 entry.do_mount(source_mount_path)
                 entry.do_count()  # Fill in the entry.total
 
                 self.report_progress()
                 error_msg = self.unpack_image(entry, entry.mountPoint)
+                if entry.receive:
+                    # The received copy is only needed for this
+                    os.remove(entry.source)
 
                 if error_msg:
                     return (_("Failed to unpack image \"{}\"").format(entry.source),
@@ -354,6 +778,14 @@ class UnpackOperation:
             else:
                 source = imgmountdir
 
+            if not entry.delta and can_reflink(source, entry):
+                utils.debug("Copying {} with reflinks".format(source))
+                error_msg = reflink_copy(source, entry, progress_cb)
+                if error_msg is None:
+                    return None
+                # Whatever was copied already is finished off by rsync
+                utils.debug(".. falling back to rsync.")
+                entry.copied = 0
             return file_copy(source, entry, progress_cb)
         finally:
             if not entry.is_file():
@@ -453,7 +885,13 @@ def run():
             utils.warning(" ... modprobe {} may solve the problem".format(sourcefs))
             return (_("Bad unsquash configuration"),
                     _("The filesystem for \"{}\" ({}) is not supported by your current kernel").format(source, sourcefs))
-        if not os.path.exists(source):
+        if entry.get("receive", None):
+            command = entry["receive"].get("command", None)
+            if not command or shutil.which(command[0]) is None:
+                utils.warning("The receive command {!r} for \"{}\" is not available".format(command, source))
+                return (_("Bad unsquash configuration"),
+                        _("The receive command for \"{}\" is not available").format(source))
+        elif not os.path.exists(source):
             utils.warning("The source filesystem \"{}\" does not exist".format(source))
             return (_("Bad unsquash configuration"),
                     _("The source filesystem \"{}\" does not exist").format(source))
@@ -487,6 +925,12 @@ def run():
         if entry.get("excludeFile", None):
             unpack[-1].excludeFile = entry["excludeFile"]
         unpack[-1].weight = extract_weight(entry)
+        if entry.get("receive", None):
+            unpack[-1].receive = entry["receive"]
+        if entry.get("delta", False):
+            unpack[-1].delta = True
+            unpack[-1].deltaChecksum = bool(entry.get("deltaChecksum", False))
+            unpack[-1].deltaDelete = bool(entry.get("deltaDelete", False))
 
         is_first = False
 
@@ -12,7 +12,7 @@ SRCDIR=$( dirname "$0" )
 # For test 3
 mkdir /tmp/unpackfs-test-run-rootdir3
 
-# For test 7
+# For tests 7 and 10
 mkdir /tmp/unpackfs-test-run-rootdir3/realdest
 
 # For test 9
@@ -30,8 +30,9 @@ if test 0 = $( id -u ) ; then
     umount /tmp/unpackfs-test-run-rootdir3/smalldest
 fi
 
-# Cleanup test 7
+# Cleanup tests 7 and 10
 rm -rf /tmp/unpackfs-test-run-rootdir3/realdest
+rm -rf /tmp/unpackfs-test-run-rootdir3/received
 
 # Cleanup test 3
 rmdir /tmp/unpackfs-test-run-rootdir3
@@ -0,0 +1,239 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "UnpackFSCJob.h"
+
+#include "GlobalStorage.h"
+#include "JobQueue.h"
+#include "utils/Logger.h"
+#include "utils/Yaml.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+#include <algorithm>
+#include <memory>
+
+class UnpackFSCTests : public QObject
+{
+    Q_OBJECT
+public:
+    UnpackFSCTests() {}
+    ~UnpackFSCTests() override {}
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testEntries();
+    void testConfig();
+    void testVersion();
+    void testUnsquashArguments();
+    void testCopy();
+    void testVerify();
+
+private:
+    std::unique_ptr< Calamares::JobQueue > m_jobQueue;
+};
+
+void
+UnpackFSCTests::initTestCase()
+{
+    Logger::setupLogLevel( Logger::LOGDEBUG );
+    m_jobQueue = std::make_unique< Calamares::JobQueue >( nullptr );
+}
+
+void
+UnpackFSCTests::testEntries()
+{
+    auto e = UnpackEntry::fromMap( { { "source", "/run/image.sqfs" }, { "sourcefs", "squashfs" } } );
+    QVERIFY( e.isValid() );
+    QVERIFY( e.isDirectUnsquash() );
+    QCOMPARE( e.weight, 1 );
+    QVERIFY( e.destination.isEmpty() );
+
+    e = UnpackEntry::fromMap( { { "source", "/run/image.sqfs" },
+                                { "sourcefs", "squashfs" },
+                                { "exclude", QStringList { "*.pyc" } },
+                                { "weight", 5 } } );
+    QVERIFY( !e.isDirectUnsquash() );
+    QCOMPARE( e.excludes, QStringList { "*.pyc" } );
+    QCOMPARE( e.weight, 5 );
+
+    e = UnpackEntry::fromMap(
+        { { "source", "/run/image.sqfs" }, { "sourcefs", "squashfs" }, { "excludeFile", "/x" }, { "weight", -2 } } );
+    QVERIFY( !e.isDirectUnsquash() );
+    QCOMPARE( e.weight, 1 );
+
+    e = UnpackEntry::fromMap( { { "source", "/run/image.img" }, { "sourcefs", "ext4" } } );
+    QVERIFY( !e.isDirectUnsquash() );
+
+    e = UnpackEntry::fromMap( { { "sourcefs", "ext4" }, { "destination", "/" } } );
+    QVERIFY( !e.isValid() );
+
+    QVERIFY( e.sha256.isEmpty() );
+    const QByteArray digest( "E3B0C44298FC1C149AFBF4C8996FB92427AE41E4649B934CA495991B7852B855" );
+    e = UnpackEntry::fromMap( { { "source", "/run/image.sqfs" }, { "sourcefs", "squashfs" }, { "sha256", digest } } );
+    QCOMPARE( e.sha256, digest.toLower() );
+}
+
+void
+UnpackFSCTests::testConfig()
+{
+    // BUILD_AS_TEST is the source-directory path
+    const QFileInfo fi( QString( "%1/unpackfsc.conf" ).arg( BUILD_AS_TEST ) );
+    QVERIFY( fi.exists() );
+    bool ok = false;
+    const auto map = CalamaresUtils::loadYaml( fi, &ok );
+    QVERIFY( ok );
+
+    UnpackFSCJob job;
+    job.setConfigurationMap( map );
+    QCOMPARE( job.entries().count(), 2 );
+    QCOMPARE( job.entries().at( 0 ).sourcefs, QStringLiteral( "file" ) );
+    QCOMPARE( job.entries().at( 0 ).weight, 1 );
+    QCOMPARE( job.entries().at( 1 ).excludes.count(), 2 );
+    QCOMPARE( job.entries().at( 1 ).weight, 5 );
+
+    // Entries without a destination are dropped
+    job.setConfigurationMap(
+        { { "unpack", QVariantList { QVariantMap { { "source", "/" }, { "sourcefs", "file" } } } } } );
+    QVERIFY( job.entries().isEmpty() );
+}
+
+void
+UnpackFSCTests::testVersion()
+{
+    QCOMPARE( unsquashfsVersion( "unsquashfs version 4.6.1 (2023/03/25)\ncopyright (C) 2023 Phillip Lougher" ),
+              QVersionNumber( 4, 6, 1 ) );
+    QCOMPARE( unsquashfsVersion( "unsquashfs version 4.4 (2019/08/29)" ), QVersionNumber( 4, 4 ) );
+    QVERIFY( unsquashfsVersion( "unsquashfs: invalid option" ).isNull() );
+    QVERIFY( unsquashfsVersion( QString() ).isNull() );
+}
+
+void
+UnpackFSCTests::testUnsquashArguments()
+{
+    const QString image = QStringLiteral( "/run/image.sqfs" );
+    const QString dest = QStringLiteral( "/tmp/calamares-root" );
+
+    // The image comes last, otherwise the options are names to extract
+    auto args = unsquashArguments( image, dest, {}, 4 );
+    QCOMPARE( args.first(), QStringLiteral( "unsquashfs" ) );
+    QCOMPARE( args.last(), image );
+    QVERIFY( !args.contains( QStringLiteral( "-exclude-list" ) ) );
+    QCOMPARE( args.at( args.indexOf( QStringLiteral( "-dest" ) ) + 1 ), dest );
+    QCOMPARE( args.at( args.indexOf( QStringLiteral( "-processors" ) ) + 1 ), QStringLiteral( "4" ) );
+
+    args = unsquashArguments( image, dest, { QStringLiteral( "/proc/*" ), QStringLiteral( "/home" ) }, 0 );
+    QCOMPARE( args.last(), image );
+    QCOMPARE( args.at( args.indexOf( QStringLiteral( "-processors" ) ) + 1 ), QStringLiteral( "1" ) );
+    const int list = args.indexOf( QStringLiteral( "-exclude-list" ) );
+    QVERIFY( list > 0 );
+    QCOMPARE( args.mid( list + 1, 3 ),
+              QStringList( { QStringLiteral( "/proc/*" ), QStringLiteral( "/home" ), QStringLiteral( ";" ) } ) );
+    QCOMPARE( args.indexOf( QStringLiteral( ";" ) ), args.count() - 2 );
+}
+
+void
+UnpackFSCTests::testCopy()
+{
+    if ( QStandardPaths::findExecutable( "rsync" ).isEmpty() )
+    {
+        QSKIP( "rsync is not available" );
+    }
+
+    QTemporaryDir source;
+    QTemporaryDir root;
+    QVERIFY( source.isValid() && root.isValid() );
+    QVERIFY( QDir( source.path() ).mkpath( "sub" ) );
+    for ( const auto& name : { "a.txt", "b.skip", "sub/c.txt" } )
+    {
+        QFile f( source.filePath( name ) );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        f.write( QByteArray( 4096, 'x' ) );
+    }
+    QVERIFY( QDir( root.path() ).mkpath( "target" ) );
+
+    Calamares::JobQueue::instance()->globalStorage()->insert( "rootMountPoint", root.path() );
+    UnpackFSCJob job;
+    job.setConfigurationMap( { { "unpack",
+                                 QVariantList { QVariantMap { { "source", source.path() },
+                                                              { "sourcefs", "file" },
+                                                              { "destination", "/target" },
+                                                              { "exclude", QStringList { "*.skip" } } } } } } );
+    QList< qreal > progress;
+    connect( &job, &Calamares::Job::progress, this, [&progress]( qreal p ) { progress.append( p ); } );
+    const auto r = job.exec();
+    QVERIFY( r );
+    QVERIFY( QFileInfo::exists( root.filePath( "target/a.txt" ) ) );
+    QVERIFY( QFileInfo::exists( root.filePath( "target/sub/c.txt" ) ) );
+    QVERIFY( !QFileInfo::exists( root.filePath( "target/b.skip" ) ) );
+    QVERIFY( !progress.isEmpty() );
+    QCOMPARE( progress.last(), 1.0 );
+    QVERIFY( std::is_sorted( progress.cbegin(), progress.cend() ) );
+}
+
+void
+UnpackFSCTests::testVerify()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    // More than one read of the verifier
+    const QByteArray data = QByteArray( 5 * 1024 * 1024, 'x' ) + QByteArray( "tail" );
+    QFile f( dir.filePath( "image.img" ) );
+    QVERIFY( f.open( QIODevice::WriteOnly ) );
+    QCOMPARE( f.write( data ), qint64( data.size() ) );
+    f.close();
+    const QByteArray digest = QCryptographicHash::hash( data, QCryptographicHash::Sha256 ).toHex();
+
+    {
+        ImageVerifier v( f.fileName(), digest );
+        QCOMPARE( v.wait(), ImageVerifier::State::Matched );
+        QVERIFY( !v.hasFailed() );
+    }
+    {
+        QByteArray wrong = digest;
+        wrong[ 0 ] = wrong[ 0 ] == '0' ? '1' : '0';
+        ImageVerifier v( f.fileName(), wrong );
+        QCOMPARE( v.wait(), ImageVerifier::State::Mismatched );
+        QVERIFY( v.hasFailed() );
+    }
+    {
+        ImageVerifier v( dir.filePath( "missing.img" ), digest );
+        QCOMPARE( v.wait(), ImageVerifier::State::Failed );
+        QVERIFY( v.hasFailed() );
+    }
+
+    // A damaged file source fails the job
+    if ( QStandardPaths::findExecutable( "rsync" ).isEmpty() )
+    {
+        QSKIP( "rsync is not available" );
+    }
+    QTemporaryDir root;
+    QVERIFY( root.isValid() );
+    Calamares::JobQueue::instance()->globalStorage()->insert( "rootMountPoint", root.path() );
+    UnpackFSCJob job;
+    job.setConfigurationMap( { { "unpack",
+                                 QVariantList { QVariantMap { { "source", f.fileName() },
+                                                              { "sourcefs", "file" },
+                                                              { "destination", "/image.img" },
+                                                              { "sha256", QString( 64, '0' ) } } } } } );
+    const auto r = job.exec();
+    QVERIFY( !r );
+    QVERIFY( r.details().contains( "checksum" ) );
+}
+
+QTEST_GUILESS_MAIN( UnpackFSCTests )
+
+#include "utils/moc-warnings.h"
+
+#include "Tests.moc"
@@ -0,0 +1,600 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "UnpackFSCJob.h"
+
+#include "GlobalStorage.h"
+#include "JobQueue.h"
+#include "partition/Mount.h"
+#include "utils/CalamaresUtilsSystem.h"
+#include "utils/Logger.h"
+#include "utils/Units.h"
+#include "utils/Variant.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QThread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+using CalamaresUtils::System;
+
+/// @brief unsquashfs can exclude paths and overlay xattrs since this version
+static const QVersionNumber unsquashfsMinimumVersion( 4, 6 );
+
+UnpackEntry
+UnpackEntry::fromMap( const QVariantMap& map )
+{
+    UnpackEntry e;
+    e.source = CalamaresUtils::getString( map, "source" );
+    if ( !e.source.isEmpty() )
+    {
+        e.source = QFileInfo( e.source ).absoluteFilePath();
+    }
+    e.sourcefs = CalamaresUtils::getString( map, "sourcefs" );
+    e.destination = CalamaresUtils::getString( map, "destination" );
+    e.excludeFile = CalamaresUtils::getString( map, "excludeFile" );
+    e.excludes = CalamaresUtils::getStringList( map, "exclude" );
+    e.sha256 = CalamaresUtils::getString( map, "sha256" ).trimmed().toLower().toLatin1();
+    if ( !e.sha256.isEmpty()
+         && ( e.sha256.length() != 64 || QByteArray::fromHex( e.sha256 ).toHex() != e.sha256 ) )
+    {
+        // Kept, so that the image fails to verify rather than be unpacked unchecked
+        cWarning() << "*sha256* setting" << map.value( "sha256" ) << "is not a SHA-256 digest.";
+    }
+
+    const qint64 weight = CalamaresUtils::getInteger( map, "weight", 1 );
+    if ( weight > 0 )
+    {
+        e.weight = int( weight );
+    }
+    else
+    {
+        cWarning() << "*weight* setting" << map.value( "weight" ) << "is not valid.";
+    }
+    return e;
+}
+
+bool
+UnpackEntry::isDirectUnsquash() const
+{
+    return sourcefs == QStringLiteral( "squashfs" ) && excludes.isEmpty() && excludeFile.isEmpty();
+}
+
+QVersionNumber
+unsquashfsVersion( const QString& output )
+{
+    static const QRegularExpression versionLine( QStringLiteral( "^unsquashfs version ([0-9.]+)" ),
+                                                 QRegularExpression::MultilineOption );
+    const auto match = versionLine.match( output );
+    return match.hasMatch() ? QVersionNumber::fromString( match.captured( 1 ) ) : QVersionNumber();
+}
+
+QStringList
+unsquashArguments( const QString& source, const QString& destination, const QStringList& excludes, int processors )
+{
+    QStringList args { QStringLiteral( "unsquashfs" ),
+                       QStringLiteral( "-force" ),
+                       QStringLiteral( "-dest" ),
+                       destination,
+                       QStringLiteral( "-processors" ),
+                       QString::number( qMax( 1, processors ) ),
+                       QStringLiteral( "-percentage" ),
+                       QStringLiteral( "-xattrs-exclude" ),
+                       QStringLiteral( "^trusted\\.overlay\\." ) };
+    if ( !excludes.isEmpty() )
+    {
+        // The list ends at the ";", and must come before the image
+        args << QStringLiteral( "-exclude-list" ) << excludes << QStringLiteral( ";" );
+    }
+    args << source;
+    return args;
+}
+
+/// @brief The names of the filesystems the kernel supports, and "file"
+static QStringList
+supportedFilesystems()
+{
+    QStringList names { QStringLiteral( "file" ) };
+    QFile procfs( QStringLiteral( "/proc/filesystems" ) );
+    if ( procfs.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        const auto lines = QString::fromLatin1( procfs.readAll() ).split( '\n' );
+        for ( const auto& line : lines )
+        {
+            // Lines are "nodev\tsysfs" or "\text4"
+            const QString name = line.section( '\t', -1 ).trimmed();
+            if ( !name.isEmpty() )
+            {
+                names.append( name );
+            }
+        }
+    }
+    return names;
+}
+
+/** @brief Sets / of the target system to 755 if it is 777
+ *
+ * Any other permission is left alone. This works around standard
+ * behavior from squashfs where permissions are (easily, accidentally) set to 777.
+ */
+static void
+repairRootPermissions( const QString& rootMountPoint )
+{
+    struct stat st;
+    const QByteArray path = QFile::encodeName( rootMountPoint );
+    if ( stat( path.constData(), &st ) == 0 && ( st.st_mode & 0777 ) == 0777 )
+    {
+        if ( chmod( path.constData(), 0755 ) != 0 )
+        {
+            cWarning() << "Could not set / to safe permissions.";
+        }
+    }
+}
+
+/// @brief The number of bytes in the files under @p path (or of @p path itself)
+static qint64
+sourceBytes( const QString& path )
+{
+    const QFileInfo fi( path );
+    if ( !fi.isDir() )
+    {
+        return fi.size();
+    }
+
+    qint64 bytes = 0;
+    QDirIterator it( path, QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot,
+                     QDirIterator::Subdirectories );
+    while ( it.hasNext() )
+    {
+        it.next();
+        if ( !it.fileInfo().isSymLink() )
+        {
+            bytes += it.fileInfo().size();
+        }
+    }
+    return bytes;
+}
+
+/// @brief Hashes @p path; the result is stored in @p state as well, for early checks
+static ImageVerifier::State
+verifyImage( const QString& path,
+             const QByteArray& expected,
+             const CalamaresUtils::Executor::Cancellation& cancellation,
+             const std::shared_ptr< std::atomic< int > >& state )
+{
+    using namespace CalamaresUtils::Units;
+    using State = ImageVerifier::State;
+
+    auto done = [ &state ]( State result ) {
+        state->store( int( result ) );
+        return result;
+    };
+
+    QFile image( path );
+    if ( !image.open( QIODevice::ReadOnly ) )
+    {
+        cWarning() << "Could not open" << path << "to verify it.";
+        return done( State::Failed );
+    }
+#if defined( POSIX_FADV_SEQUENTIAL )
+    posix_fadvise( image.handle(), 0, 0, POSIX_FADV_SEQUENTIAL );
+#endif
+
+    QCryptographicHash hash( QCryptographicHash::Sha256 );
+    QByteArray buffer( int( 4_MiB ), Qt::Uninitialized );
+    qint64 r = 0;
+    while ( ( r = image.read( buffer.data(), buffer.size() ) ) > 0 )
+    {
+        if ( cancellation.isCancelled() )
+        {
+            return State::Running;
+        }
+        hash.addData( buffer.constData(), int( r ) );
+    }
+    if ( r < 0 )
+    {
+        cWarning() << "Could not read" << path << "to verify it:" << image.errorString();
+        return done( State::Failed );
+    }
+
+    const QByteArray actual = hash.result().toHex();
+    if ( actual != expected )
+    {
+        cError() << "Image" << path << "has SHA-256" << actual << "instead of" << expected;
+        return done( State::Mismatched );
+    }
+    cDebug() << "Image" << path << "has the expected SHA-256.";
+    return done( State::Matched );
+}
+
+ImageVerifier::ImageVerifier( const QString& path, const QByteArray& expected )
+    : m_state( std::make_shared< std::atomic< int > >( int( State::Running ) ) )
+{
+    auto state = m_state;
+    m_future = CalamaresUtils::Executor::run(
+        CalamaresUtils::Executor::Lane::BulkIO,
+        "unpackfsc-verify",
+        m_cancellation,
+        [ path, expected, state ]( const CalamaresUtils::Executor::Cancellation& cancellation ) {
+            return verifyImage( path, expected, cancellation, state );
+        } );
+}
+
+ImageVerifier::~ImageVerifier()
+{
+    m_cancellation.cancel();
+    m_future.waitForFinished();
+}
+
+bool
+ImageVerifier::hasFailed() const
+{
+    const auto state = State( m_state->load() );
+    return state == State::Mismatched || state == State::Failed;
+}
+
+ImageVerifier::State
+ImageVerifier::wait()
+{
+    m_future.waitForFinished();
+    return State( m_state->load() );
+}
+
+UnpackFSCJob::UnpackFSCJob( QObject* parent )
+    : Calamares::CppJob( parent )
+{
+}
+
+UnpackFSCJob::~UnpackFSCJob() {}
+
+QString
+UnpackFSCJob::prettyName() const
+{
+    return tr( "Filling up filesystems." );
+}
+
+QString
+UnpackFSCJob::prettyStatusMessage() const
+{
+    if ( m_entries.isEmpty() )
+    {
+        return prettyName();
+    }
+    return tr( "Unpacking image %1/%2, %3% done" )
+        .arg( qMin( m_current + 1, m_entries.count() ) )
+        .arg( m_entries.count() )
+        .arg( m_percentage );
+}
+
+void
+UnpackFSCJob::reportProgress( double fraction )
+{
+    const int percentage = qBound( 0, int( fraction * 100 ), 100 );
+    if ( percentage == m_percentage && fraction > 0.0 )
+    {
+        return;
+    }
+    m_percentage = percentage;
+    const int weight = m_current < m_entries.count() ? m_entries.at( m_current ).weight : 0;
+    emit progress( ( m_completedWeight + weight * percentage / 100.0 ) / qMax( 1, m_totalWeight ) );
+}
+
+QString
+UnpackFSCJob::unsquash( const UnpackEntry& entry, const QString& destination, const QStringList& excludes )
+{
+    const QStringList args = unsquashArguments( entry.source, destination, excludes, QThread::idealThreadCount() );
+
+    auto r = System::runCommandStreaming(
+        System::RunLocation::RunInHost, args, [this]( System::OutputChannel channel, const QString& line ) {
+            bool ok = false;
+            const int percentage = line.trimmed().toInt( &ok );
+            if ( channel == System::OutputChannel::StdOut && ok )
+            {
+                reportProgress( percentage / 100.0 );
+            }
+            return !verifyFailed();
+        } );
+    // 2 means non-fatal errors, e.g. xattrs that cannot be set
+    // on a vfat /boot/efi, like rsync's 23.
+    if ( r.getExitCode() == 2 )
+    {
+        cWarning() << "unsquashfs had non-fatal errors:" << Logger::NoQuote << r.getOutput();
+    }
+    else if ( r.getExitCode() != 0 )
+    {
+        return tr( "unsquashfs failed with error code %1." ).arg( r.getExitCode() );
+    }
+    return QString();
+}
+
+QString
+UnpackFSCJob::copy( const UnpackEntry& entry,
+                    const QString& source,
+                    const QString& destination,
+                    const QStringList& excludes )
+{
+    // A trailing / on a directory copies what is in it, rather than the directory itself
+    const QString rsyncSource
+        = QFileInfo( source ).isDir() && !source.endsWith( '/' ) ? source + '/' : source;
+    const qint64 total = sourceBytes( source );
+
+    // Setting locale to C (fix issue with tr_TR locale)
+    QStringList args { QStringLiteral( "env" ),
+                       QStringLiteral( "LC_ALL=C" ),
+                       QStringLiteral( "rsync" ),
+                       QStringLiteral( "-aHAXr" ),
+                       QStringLiteral( "--filter=-x trusted.overlay.*" ) };
+    for ( const auto& path : excludes )
+    {
+        args << QStringLiteral( "--exclude" ) << QStringLiteral( "/%1/" ).arg( path );
+    }
+    if ( !entry.excludeFile.isEmpty() )
+    {
+        args << QStringLiteral( "--exclude-from=%1" ).arg( entry.excludeFile );
+    }
+    for ( const auto& pattern : entry.excludes )
+    {
+        args << QStringLiteral( "--exclude" ) << pattern;
+    }
+    // One line per file copied, with its size
+    args << QStringLiteral( "--out-format=%l" ) << rsyncSource << destination;
+
+    qint64 copied = 0;
+    auto r = System::runCommandStreaming(
+        System::RunLocation::RunInHost,
+        args,
+        [this, &copied, total]( System::OutputChannel channel, const QString& line ) {
+            bool ok = false;
+            const qint64 bytes = line.trimmed().toLongLong( &ok );
+            if ( channel == System::OutputChannel::StdOut && ok && total > 0 )
+            {
+                copied += bytes;
+                reportProgress( double( copied ) / total );
+            }
+            return !verifyFailed();
+        } );
+    // 23 is the return code rsync returns if it cannot write extended
+    // attributes (with -X) because the target filesystem does not support it,
+    // e.g., the FAT EFI system partition. We need -X because distributions
+    // using file system capabilities and/or SELinux require the extended
+    // attributes. But distributions using SELinux may also have SELinux labels
+    // set on files under /boot/efi, and rsync complains about those.
+    if ( r.getExitCode() != 0 && r.getExitCode() != 23 )
+    {
+        cWarning() << "rsync failed with error code" << r.getExitCode();
+        return tr( "rsync failed with error code %1." ).arg( r.getExitCode() );
+    }
+    return QString();
+}
+
+QString
+UnpackFSCJob::unpackEntry( const UnpackEntry& entry, const QString& destination, const QStringList& excludes )
+{
+    std::unique_ptr< ImageVerifier > verifier;
+    if ( !entry.sha256.isEmpty() )
+    {
+        if ( QFileInfo( entry.source ).isFile() )
+        {
+            verifier = std::make_unique< ImageVerifier >( entry.source, entry.sha256 );
+        }
+        else
+        {
+            cWarning() << "Ignoring *sha256* for" << entry.source << "which is not a file.";
+        }
+    }
+
+    m_verifier = verifier.get();
+    QString message = unpackSource( entry, destination, excludes );
+    m_verifier = nullptr;
+
+    // When the unpacking was stopped, it was (most likely) because of the verifier
+    if ( verifier && ( message.isEmpty() || verifier->hasFailed() ) )
+    {
+        switch ( verifier->wait() )
+        {
+        case ImageVerifier::State::Mismatched:
+            message = tr( "The image \"%1\" is damaged: its checksum does not match." ).arg( entry.source );
+            break;
+        case ImageVerifier::State::Failed:
+            message = tr( "The image \"%1\" could not be read to verify it." ).arg( entry.source );
+            break;
+        case ImageVerifier::State::Running:
+        case ImageVerifier::State::Matched:
+            break;
+        }
+    }
+    return message;
+}
+
+QString
+UnpackFSCJob::unpackSource( const UnpackEntry& entry, const QString& destination, const QStringList& excludes )
+{
+    if ( entry.isDirectUnsquash() && m_unsquashfsVersion >= unsquashfsMinimumVersion )
+    {
+        return unsquash( entry, destination, excludes );
+    }
+    if ( entry.sourcefs == QStringLiteral( "file" ) )
+    {
+        return copy( entry, entry.source, destination, excludes );
+    }
+
+    QString options;
+    if ( QFileInfo( entry.source ).isDir() )
+    {
+        options = QStringLiteral( "--bind" );
+    }
+    else if ( QFileInfo( entry.source ).isFile() )
+    {
+        options = QStringLiteral( "loop" );
+    }
+    CalamaresUtils::Partition::TemporaryMount mount(
+        entry.source, options == QStringLiteral( "--bind" ) ? QString() : entry.sourcefs, options );
+    if ( !mount.isValid() )
+    {
+        return tr( "Failed to mount \"%1\" (fs=%2)" ).arg( entry.source, entry.sourcefs );
+    }
+    return copy( entry, mount.path(), destination, excludes );
+}
+
+Calamares::JobResult
+UnpackFSCJob::exec()
+{
+    Calamares::GlobalStorage* gs = Calamares::JobQueue::instance()->globalStorage();
+    const QString rootMountPoint = gs ? gs->value( "rootMountPoint" ).toString() : QString();
+    if ( rootMountPoint.isEmpty() )
+    {
+        cWarning() << "No mount point for root partition";
+        return Calamares::JobResult::error(
+            tr( "No mount point for root partition" ),
+            tr( "globalstorage does not contain a \"rootMountPoint\" key, doing nothing" ) );
+    }
+    if ( !QDir( rootMountPoint ).exists() )
+    {
+        cWarning() << "Bad root mount point" << rootMountPoint;
+        return Calamares::JobResult::error(
+            tr( "Bad mount point for root partition" ),
+            tr( "rootMountPoint is \"%1\", which does not exist, doing nothing" ).arg( rootMountPoint ) );
+    }
+
+    // Bail out before we start when there are obvious problems
+    //   - unsupported filesystems
+    //   - non-existent sources
+    //   - missing tools for specific FS
+    const QStringList filesystems = supportedFilesystems();
+    const bool haveUnsquashfs = !QStandardPaths::findExecutable( QStringLiteral( "unsquashfs" ) ).isEmpty();
+    for ( const auto& entry : qAsConst( m_entries ) )
+    {
+        if ( !filesystems.contains( entry.sourcefs ) )
+        {
+            cWarning() << "The filesystem for" << entry.source << '(' << entry.sourcefs
+                       << ") is not supported by your current kernel";
+            cWarning() << Logger::SubEntry << "modprobe" << entry.sourcefs << "may solve the problem";
+            return Calamares::JobResult::error(
+                tr( "Bad unsquash configuration" ),
+                tr( "The filesystem for \"%1\" (%2) is not supported by your current kernel" )
+                    .arg( entry.source, entry.sourcefs ) );
+        }
+        if ( !QFileInfo::exists( entry.source ) )
+        {
+            cWarning() << "The source filesystem" << entry.source << "does not exist";
+            return Calamares::JobResult::error(
+                tr( "Bad unsquash configuration" ),
+                tr( "The source filesystem \"%1\" does not exist" ).arg( entry.source ) );
+        }
+        if ( entry.sourcefs == QStringLiteral( "squashfs" ) && !haveUnsquashfs )
+        {
+            cWarning() << "Failed to find unsquashfs";
+            return Calamares::JobResult::error(
+                tr( "Failed to unpack image \"%1\"" ).arg( entry.source ),
+                tr( "Failed to find unsquashfs, make sure you have the squashfs-tools package installed" ) );
+        }
+    }
+
+    QStringList destinations;
+    for ( const auto& entry : qAsConst( m_entries ) )
+    {
+        const QString destination = QDir::cleanPath( rootMountPoint + '/' + entry.destination );
+        if ( entry.sourcefs != QStringLiteral( "file" ) && !QFileInfo( destination ).isDir() )
+        {
+            cWarning() << "The destination" << destination << "in the target system is not a directory";
+            if ( destinations.isEmpty() )
+            {
+                return Calamares::JobResult::error(
+                    tr( "Bad unsquash configuration" ),
+                    tr( "The destination \"%1\" in the target system is not a directory" ).arg( destination ) );
+            }
+            cDebug() << Logger::SubEntry << "assuming that the previous targets will create that directory.";
+        }
+        destinations.append( destination );
+    }
+
+    // Don't copy over the things that are already mounted in the target
+    QStringList excludes;
+    const auto extraMounts = gs->value( "extraMounts" ).toList();
+    for ( const auto& m : extraMounts )
+    {
+        const QString mountPoint = CalamaresUtils::getString( m.toMap(), "mountPoint" );
+        const QString path = QDir::cleanPath( mountPoint ).mid( 1 );  // Relative to the root
+        if ( !mountPoint.isEmpty() && !path.isEmpty() )
+        {
+            excludes.append( path );
+        }
+    }
+
+    if ( haveUnsquashfs )
+    {
+        auto r = System::runCommand( System::RunLocation::RunInHost,
+                                     { QStringLiteral( "unsquashfs" ), QStringLiteral( "-version" ) } );
+        m_unsquashfsVersion = unsquashfsVersion( r.getOutput() );
+        cDebug() << "unsquashfs version" << m_unsquashfsVersion.toString() << "direct unpacking"
+                 << ( m_unsquashfsVersion >= unsquashfsMinimumVersion );
+    }
+
+    m_totalWeight = 0;
+    for ( const auto& entry : qAsConst( m_entries ) )
+    {
+        m_totalWeight += entry.weight;
+    }
+    m_completedWeight = 0;
+
+    repairRootPermissions( rootMountPoint );
+    Calamares::JobResult result = Calamares::JobResult::ok();
+    for ( m_current = 0; m_current < m_entries.count(); ++m_current )
+    {
+        const auto& entry = m_entries.at( m_current );
+        cDebug() << "Unpacking" << entry.source << "to" << destinations.at( m_current );
+        reportProgress( 0.0 );
+        const QString message = unpackEntry( entry, destinations.at( m_current ), excludes );
+        if ( !message.isEmpty() )
+        {
+            result = Calamares::JobResult::error( tr( "Failed to unpack image \"%1\"" ).arg( entry.source ), message );
+            break;
+        }
+        m_completedWeight += entry.weight;
+    }
+    repairRootPermissions( rootMountPoint );
+    if ( result )
+    {
+        emit progress( 1.0 );
+    }
+    return result;
+}
+
+void
+UnpackFSCJob::setConfigurationMap( const QVariantMap& configurationMap )
+{
+    m_entries.clear();
+    const auto unpack = configurationMap.value( "unpack" ).toList();
+    for ( const auto& item : unpack )
+    {
+        const auto map = item.toMap();
+        const auto entry = UnpackEntry::fromMap( map );
+        if ( entry.isValid() && map.contains( "destination" ) )
+        {
+            m_entries.append( entry );
+        }
+        else
+        {
+            cWarning() << "Skipping unpack entry without source, sourcefs or destination" << map;
+        }
+    }
+    if ( m_entries.isEmpty() )
+    {
+        cWarning() << "No *unpack* entries are configured.";
+    }
+}
+
+CALAMARES_PLUGIN_FACTORY_DEFINITION( UnpackFSCJobFactory, registerPlugin< UnpackFSCJob >(); )
@@ -0,0 +1,166 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef UNPACKFSCJOB_H
+#define UNPACKFSCJOB_H
+
+#include "CppJob.h"
+#include "DllMacro.h"
+#include "utils/Executor.h"
+#include "utils/PluginFactory.h"
+
+#include <QFuture>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVersionNumber>
+
+#include <atomic>
+#include <memory>
+
+/** @brief One item of the *unpack* list in the configuration
+ *
+ * The keys are the same as for the Python unpackfs module.
+ */
+struct UnpackEntry
+{
+    QString source;
+    QString sourcefs;
+    QString destination;
+    QString excludeFile;
+    QStringList excludes;
+    QByteArray sha256;  ///< Expected SHA-256 of the source (lower-case hex); empty to not verify
+    int weight = 1;
+
+    /// @brief Are the mandatory keys there? (*destination* may be empty)
+    bool isValid() const { return !source.isEmpty() && !sourcefs.isEmpty(); }
+    /** @brief Can this entry be unpacked by unsquashfs directly?
+     *
+     * That is a squashfs, without rsync-specific exclusions.
+     */
+    bool isDirectUnsquash() const;
+
+    static UnpackEntry fromMap( const QVariantMap& map );
+};
+
+/** @brief Finds the version in the output of `unsquashfs -version`
+ *
+ * Returns a null version if the output is not recognized.
+ */
+QVersionNumber unsquashfsVersion( const QString& output );
+
+/** @brief The command-line for unsquashfs to unpack @p source into @p destination
+ *
+ * All the options, including the @p excludes, come before the image:
+ * unsquashfs takes whatever follows the image as the (only) names
+ * to extract.
+ */
+QStringList unsquashArguments( const QString& source,
+                               const QString& destination,
+                               const QStringList& excludes,
+                               int processors );
+
+/** @brief Checks the SHA-256 of an image while it is unpacked
+ *
+ * The image is hashed in another thread (in the bulk-I/O lane), reading
+ * it from start to end while unsquashfs or rsync read it as well. The
+ * hash mostly stays ahead, so that the unpacking reads from the page
+ * cache what the hash read from the disk already: the image is read
+ * from the medium only once. A mismatch is known as soon as the whole
+ * image is hashed, which is usually long before the unpacking is done.
+ *
+ * Destroying the verifier stops the hashing.
+ */
+class ImageVerifier
+{
+public:
+    enum class State : int
+    {
+        Running,
+        Matched,
+        Mismatched,
+        Failed  ///< The image could not be read
+    };
+
+    /// @brief Starts hashing @p path, which should have SHA-256 @p expected (lower-case hex)
+    ImageVerifier( const QString& path, const QByteArray& expected );
+    ~ImageVerifier();
+
+    ImageVerifier( const ImageVerifier& ) = delete;
+    ImageVerifier& operator=( const ImageVerifier& ) = delete;
+
+    /// @brief Is it known already that the image is damaged (or unreadable)?
+    bool hasFailed() const;
+    /// @brief Waits for the whole image to be hashed, and returns the result
+    State wait();
+
+private:
+    CalamaresUtils::Executor::Cancellation m_cancellation;
+    std::shared_ptr< std::atomic< int > > m_state;
+    QFuture< ImageVerifier::State > m_future;
+};
+
+/** @brief Unpacks filesystem images into the target system
+ *
+ * This does what the unpackfs module does, with the same configuration,
+ * and (when possible) with unsquashfs doing the work instead of rsync
+ * from a loop-mounted image.
+ */
+class PLUGINDLLEXPORT UnpackFSCJob : public Calamares::CppJob
+{
+    Q_OBJECT
+
+public:
+    explicit UnpackFSCJob( QObject* parent = nullptr );
+    ~UnpackFSCJob() override;
+
+    QString prettyName() const override;
+    QString prettyStatusMessage() const override;
+
+    Calamares::JobResult exec() override;
+
+    void setConfigurationMap( const QVariantMap& configurationMap ) override;
+
+    const QList< UnpackEntry >& entries() const { return m_entries; }
+
+private:
+    /** @brief Unpacks @p entry into @p destination
+     *
+     * Returns an empty string on success, or a message explaining
+     * what went wrong. @p excludes are paths (from the root of the
+     * entry) not to be unpacked. If the entry has a *sha256*, the
+     * source is verified while it is unpacked.
+     */
+    QString unpackEntry( const UnpackEntry& entry, const QString& destination, const QStringList& excludes );
+    /// @brief Unpacks @p entry, without verifying it
+    QString unpackSource( const UnpackEntry& entry, const QString& destination, const QStringList& excludes );
+    QString unsquash( const UnpackEntry& entry, const QString& destination, const QStringList& excludes );
+    QString copy( const UnpackEntry& entry,
+                  const QString& source,
+                  const QString& destination,
+                  const QStringList& excludes );
+
+    /// @brief Reports @p fraction of the current entry done
+    void reportProgress( double fraction );
+    /// @brief Should the running command stop, because the image is damaged?
+    bool verifyFailed() const { return m_verifier && m_verifier->hasFailed(); }
+
+    QList< UnpackEntry > m_entries;
+    QVersionNumber m_unsquashfsVersion;
+    ImageVerifier* m_verifier = nullptr;  ///< Of the entry being unpacked, if it is verified
+    int m_current = 0;  ///< Index of the entry being unpacked
+    int m_completedWeight = 0;
+    int m_totalWeight = 0;
+    int m_percentage = 0;  ///< Of the current entry
+};
+
+CALAMARES_PLUGIN_FACTORY_DECLARATION( UnpackFSCJobFactory )
+
+#endif  // UNPACKFSCJOB_H
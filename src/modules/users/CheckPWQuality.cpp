@@ -16,7 +16,11 @@
 #include "utils/Logger.h"
 
 #include <QCoreApplication>
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QString>
+#include <QtConcurrent/QtConcurrentRun>
 
 #ifdef HAVE_LIBPWQUALITY
 #include <pwquality.h>
@@ -38,6 +42,115 @@ PasswordCheck::PasswordCheck( MessageFunc m, AcceptFunc a, Weight weight )
 {
 }
 
+/** @brief Applies @p checks to @p password, returns the first failure
+ *
+ * The libpwquality check keeps its explanation in shared state,
+ * so only one thread at a time runs the (slow) checks.
+ */
+static QString
+applyChecks( const PasswordCheckList& checks, const QString& password )
+{
+    static QMutex mutex;
+    QMutexLocker lock( &mutex );
+    for ( const auto& pc : checks )
+    {
+        QString message = pc.filter( password );
+        if ( !message.isEmpty() )
+        {
+            return message;
+        }
+    }
+    return QString();
+}
+
+PasswordChecker::PasswordChecker( const PasswordCheckList& checks, QObject* parent )
+    : QObject( parent )
+    , m_checks( checks )
+{
+    m_timer.setSingleShot( true );
+    m_timer.setInterval( int( delay().count() ) );
+    connect( &m_timer, &QTimer::timeout, this, &PasswordChecker::startSlowChecks );
+}
+
+PasswordChecker::~PasswordChecker() {}
+
+PasswordCheckList
+PasswordChecker::slowChecks() const
+{
+    PasswordCheckList l;
+    std::copy_if( m_checks.cbegin(),
+                  m_checks.cend(),
+                  std::back_inserter( l ),
+                  []( const PasswordCheck& pc ) { return pc.isSlow(); } );
+    return l;
+}
+
+void
+PasswordChecker::setPassword( const QString& password )
+{
+    m_password = password;
+    m_failure.clear();
+    m_checked = true;
+    m_pending = false;
+    ++m_generation;
+    m_timer.stop();
+
+    for ( const auto& pc : m_checks )
+    {
+        if ( pc.isSlow() )
+        {
+            // The checks are sorted, so only slow ones are left
+            m_pending = true;
+            m_timer.start();
+            return;
+        }
+        m_failure = pc.filter( password );
+        if ( !m_failure.isEmpty() )
+        {
+            return;
+        }
+    }
+}
+
+QString
+PasswordChecker::failure()
+{
+    if ( !m_checked )
+    {
+        setPassword( m_password );
+    }
+    if ( m_pending )
+    {
+        m_timer.stop();
+        ++m_generation;  // Whatever is running in the background is not needed
+        m_failure = applyChecks( slowChecks(), m_password );
+        m_pending = false;
+    }
+    return m_failure;
+}
+
+void
+PasswordChecker::startSlowChecks()
+{
+    const unsigned int generation = m_generation;
+    const QString password = m_password;
+    const PasswordCheckList checks = slowChecks();
+
+    auto* watcher = new QFutureWatcher< QString >( this );
+    connect( watcher, &QFutureWatcher< QString >::finished, this, [this, watcher, generation]() {
+        watcher->deleteLater();
+        if ( generation != m_generation )
+        {
+            // The password changed meanwhile
+            return;
+        }
+        m_failure = watcher->result();
+        m_pending = false;
+        emit checked();
+    } );
+    watcher->setFuture( QtConcurrent::run( [checks, password]() { return applyChecks( checks, password ); } ) );
+}
+
 DEFINE_CHECK_FUNC( minLength )
 {
     int minLength = -1;
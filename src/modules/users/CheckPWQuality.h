@@ -10,10 +10,13 @@
 #ifndef CHECKPWQUALITY_H
 #define CHECKPWQUALITY_H
 
+#include <QObject>
 #include <QString>
+#include <QTimer>
 #include <QVariant>
 #include <QVector>
 
+#include <chrono>
 #include <functional>
 
 /**
@@ -30,6 +33,12 @@ public:
     using MessageFunc = std::function< QString() >;
 
     using Weight = size_t;
+    /** @brief Checks with at least this weight are slow
+     *
+     * These are checks like libpwquality's dictionary lookups, which
+     * PasswordChecker runs in the background.
+     */
+    static constexpr Weight slowWeight = 100;
 
     /** @brief Generate a @p message if @p filter returns true
      *
@@ -51,6 +60,7 @@ public:
     QString filter( const QString& s ) const { return m_accept( s ) ? QString() : m_message(); }
 
     Weight weight() const { return m_weight; }
+    bool isSlow() const { return m_weight >= slowWeight; }
     bool operator<( const PasswordCheck& other ) const { return weight() < other.weight(); }
 
 private:
@@ -61,6 +71,57 @@ private:
 
 using PasswordCheckList = QVector< PasswordCheck >;
 
+/** @brief Applies a list of checks to one password
+ *
+ * When the password changes, the cheap checks are applied right away.
+ * If they all pass, the slow checks (see PasswordCheck::isSlow()) are
+ * applied in a worker thread, once the password has stayed the same
+ * for delay(); checked() is emitted when they are done. A newer password
+ * makes the results for an older one stale, and those are dropped.
+ *
+ * The @p checks are used by reference, so that they can be configured
+ * after the checker is created; they must be sorted by weight.
+ */
+class PasswordChecker : public QObject
+{
+    Q_OBJECT
+public:
+    PasswordChecker( const PasswordCheckList& checks, QObject* parent = nullptr );
+    ~PasswordChecker() override;
+
+    /// @brief How long the password must stay the same before the slow checks start
+    static constexpr std::chrono::milliseconds delay() { return std::chrono::milliseconds( 150 ); }
+
+    /// @brief Applies the checks to @p password (again, if the checks have changed)
+    void setPassword( const QString& password );
+
+    /// @brief Are the slow checks for the password still to be done?
+    bool isPending() const { return m_pending; }
+
+    /** @brief The message of the first check that fails, or empty if all pass
+     *
+     * If the slow checks are still pending, they are done
+     * now, in this thread, so the answer is always up-to-date.
+     */
+    QString failure();
+
+signals:
+    /// @brief The slow checks are done, and failure() has their result
+    void checked();
+
+private:
+    void startSlowChecks();
+    PasswordCheckList slowChecks() const;
+
+    const PasswordCheckList& m_checks;
+    QTimer m_timer;
+    QString m_password;
+    QString m_failure;
+    unsigned int m_generation = 0;  ///< Changes with each password, to spot stale results
+    bool m_pending = false;
+    bool m_checked = false;  ///< Has setPassword() been called at all?
+};
+
 /* Each of these functions adds a check (if possible) to the list
  * of checks; they use the configuration value(s) from the
  * variant. If the value doesn't make sense, each function
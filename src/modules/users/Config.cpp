@@ -16,6 +16,7 @@
 
 #include "GlobalStorage.h"
 #include "JobQueue.h"
+#include "utils/HardwareInfo.h"
 #include "utils/Logger.h"
 #include "utils/String.h"
 #include "utils/Variant.h"
@@ -24,6 +25,7 @@
 #include <QFile>
 #include <QMetaProperty>
 #include <QRegExp>
+#include <QSet>
 #include <QTimer>
 
 #ifdef HAVE_ICU
@@ -41,6 +43,7 @@ static const char TRANSLITERATOR_ID[] = "Russian-Latin/BGN;"
 #include <memory>
 
 static const QRegExp USERNAME_RX( "^[a-z_][a-z0-9_-]*[$]?$" );
+static const QRegExp USERNAME_FIRST_RX( "^[a-z_]" );
 static constexpr const int USERNAME_MAX_LENGTH = 31;
 
 static const QRegExp HOSTNAME_RX( "^[a-zA-Z0-9][-a-zA-Z0-9_]*$" );
@@ -105,6 +108,18 @@ Config::Config( QObject* parent )
     connect( this, &Config::rootPasswordStatusChanged, this, &Config::checkReady );
     connect( this, &Config::reuseUserPasswordForRootChanged, this, &Config::checkReady );
     connect( this, &Config::requireStrongPasswordsChanged, this, &Config::checkReady );
+
+    // The slow password checks report back later
+    m_userPasswordChecker = new PasswordChecker( m_passwordChecks, this );
+    m_rootPasswordChecker = new PasswordChecker( m_passwordChecks, this );
+    connect( m_userPasswordChecker, &PasswordChecker::checked, this, [this]() {
+        const auto p = userPasswordStatus();
+        emit userPasswordStatusChanged( p.first, p.second );
+    } );
+    connect( m_rootPasswordChecker, &PasswordChecker::checked, this, [this]() {
+        const auto p = rootPasswordStatus();
+        emit rootPasswordStatusChanged( p.first, p.second );
+    } );
 }
 
 Config::~Config() {}
@@ -203,6 +218,17 @@ Config::forbiddenLoginNames()
     return forbidden;
 }
 
+/// @brief The forbidden names in @p names, for lookups
+static QSet< QString >
+forbiddenSet( const QStringList& names )
+{
+#if QT_VERSION < QT_VERSION_CHECK( 5, 14, 0 )
+    return QSet< QString >::fromList( names );
+#else
+    return QSet< QString >( names.cbegin(), names.cend() );
+#endif
+}
+
 QString
 Config::loginNameStatus() const
 {
@@ -216,16 +242,13 @@ Config::loginNameStatus() const
     {
         return tr( "Your username is too long." );
     }
-    for ( const QString& badName : forbiddenLoginNames() )
+    static const QSet< QString > forbidden = forbiddenSet( forbiddenLoginNames() );
+    if ( forbidden.contains( m_loginName ) )
     {
-        if ( 0 == QString::compare( badName, m_loginName, Qt::CaseSensitive ) )
-        {
-            return tr( "'%1' is not allowed as username." ).arg( badName );
-        }
+        return tr( "'%1' is not allowed as username." ).arg( m_loginName );
     }
 
-    QRegExp validateFirstLetter( "^[a-z_]" );
-    if ( validateFirstLetter.indexIn( m_loginName ) != 0 )
+    if ( USERNAME_FIRST_RX.indexIn( m_loginName ) != 0 )
     {
         return tr( "Your username must start with a lowercase letter or underscore." );
     }
@@ -282,12 +305,10 @@ Config::hostNameStatus() const
     {
         return tr( "Your hostname is too long." );
     }
-    for ( const QString& badName : forbiddenHostNames() )
+    static const QSet< QString > forbidden = forbiddenSet( forbiddenHostNames() );
+    if ( forbidden.contains( m_hostName ) )
     {
-        if ( 0 == QString::compare( badName, m_hostName, Qt::CaseSensitive ) )
-        {
-            return tr( "'%1' is not allowed as hostname." ).arg( badName );
-        }
+        return tr( "'%1' is not allowed as hostname." ).arg( m_hostName );
     }
 
     if ( !HOSTNAME_RX.exactMatch( m_hostName ) )
@@ -314,15 +335,8 @@ guessProductName()
     {
         // yes validateHostnameText() but these files can be a mess
         QRegExp dmirx( "[^a-zA-Z0-9]", Qt::CaseInsensitive );
-        QFile dmiFile( QStringLiteral( "/sys/devices/virtual/dmi/id/product_name" ) );
-
-        if ( dmiFile.exists() && dmiFile.open( QIODevice::ReadOnly ) )
-        {
-            dmiProduct = QString::fromLocal8Bit( dmiFile.readAll().simplified().data() )
-                             .toLower()
-                             .replace( dmirx, " " )
-                             .remove( ' ' );
-        }
+        dmiProduct
+            = CalamaresUtils::HardwareInfo::instance().productName().toLower().replace( dmirx, " " ).remove( ' ' );
         if ( dmiProduct.isEmpty() )
         {
             dmiProduct = QStringLiteral( "pc" );
@@ -418,10 +432,11 @@ Config::setFullName( const QString& name )
         emit fullNameChanged( name );
 
         // Build login and hostname, if needed
-        static QRegExp rx( "[^a-zA-Z0-9 ]", Qt::CaseInsensitive );
+        static const QRegExp rx( "[^a-zA-Z0-9 ]", Qt::CaseInsensitive );
+        static const QRegExp dashes( "[-']" );
 
         QString cleanName = CalamaresUtils::removeDiacritics( transliterate( name ) )
-                                .replace( QRegExp( "[-']" ), "" )
+                                .replace( dashes, "" )
                                 .replace( rx, " " )
                                 .toLower()
                                 .simplified();
@@ -501,8 +516,13 @@ Config::setUserPassword( const QString& s )
     if ( s != m_userPassword )
     {
         m_userPassword = s;
-        const auto p = passwordStatus( m_userPassword, m_userPasswordSecondary );
-        emit userPasswordStatusChanged( p.first, p.second );
+        m_userPasswordChecker->setPassword( s );
+        // When the slow checks are still running, the status follows later
+        if ( m_userPassword != m_userPasswordSecondary || !m_userPasswordChecker->isPending() )
+        {
+            const auto p = passwordStatus( m_userPassword, m_userPasswordSecondary, m_userPasswordChecker );
+            emit userPasswordStatusChanged( p.first, p.second );
+        }
         emit userPasswordChanged( s );
     }
 }
@@ -513,8 +533,12 @@ Config::setUserPasswordSecondary( const QString& s )
     if ( s != m_userPasswordSecondary )
     {
         m_userPasswordSecondary = s;
-        const auto p = passwordStatus( m_userPassword, m_userPasswordSecondary );
-        emit userPasswordStatusChanged( p.first, p.second );
+        // When the slow checks are still running, the status follows later
+        if ( m_userPassword != m_userPasswordSecondary || !m_userPasswordChecker->isPending() )
+        {
+            const auto p = passwordStatus( m_userPassword, m_userPasswordSecondary, m_userPasswordChecker );
+            emit userPasswordStatusChanged( p.first, p.second );
+        }
         emit userPasswordSecondaryChanged( s );
     }
 }
@@ -523,26 +547,23 @@ Config::setUserPasswordSecondary( const QString& s )
  *
  * Given two copies of the password -- generally the password and
  * the secondary fields -- checks them for validity and returns
- * a pair of <validity, message>.
+ * a pair of <validity, message>. The @p checker has been given
+ * @p pw1 already, and may have checked it in the background.
  *
  */
 Config::PasswordStatus
-Config::passwordStatus( const QString& pw1, const QString& pw2 ) const
+Config::passwordStatus( const QString& pw1, const QString& pw2, PasswordChecker* checker ) const
 {
     if ( pw1 != pw2 )
     {
         return qMakePair( PasswordValidity::Invalid, tr( "Your passwords do not match!" ) );
     }
 
-    bool failureIsFatal = requireStrongPasswords();
-    for ( const auto& pc : m_passwordChecks )
+    const QString message = checker->failure();
+    if ( !message.isEmpty() )
     {
-        QString message = pc.filter( pw1 );
-
-        if ( !message.isEmpty() )
-        {
-            return qMakePair( failureIsFatal ? PasswordValidity::Invalid : PasswordValidity::Weak, message );
-        }
+        bool failureIsFatal = requireStrongPasswords();
+        return qMakePair( failureIsFatal ? PasswordValidity::Invalid : PasswordValidity::Weak, message );
     }
 
     return qMakePair( PasswordValidity::Valid, tr( "OK!" ) );
@@ -552,7 +573,7 @@ Config::passwordStatus( const QString& pw1, const QString& pw2 ) const
 Config::PasswordStatus
 Config::userPasswordStatus() const
 {
-    return passwordStatus( m_userPassword, m_userPasswordSecondary );
+    return passwordStatus( m_userPassword, m_userPasswordSecondary, m_userPasswordChecker );
 }
 
 int
@@ -576,8 +597,13 @@ Config::setRootPassword( const QString& s )
     if ( writeRootPassword() && s != m_rootPassword )
     {
         m_rootPassword = s;
-        const auto p = passwordStatus( m_rootPassword, m_rootPasswordSecondary );
-        emit rootPasswordStatusChanged( p.first, p.second );
+        m_rootPasswordChecker->setPassword( s );
+        // When the slow checks are still running, the status follows later
+        if ( m_rootPassword != m_rootPasswordSecondary || !m_rootPasswordChecker->isPending() )
+        {
+            const auto p = passwordStatus( m_rootPassword, m_rootPasswordSecondary, m_rootPasswordChecker );
+            emit rootPasswordStatusChanged( p.first, p.second );
+        }
         emit rootPasswordChanged( s );
     }
 }
@@ -588,8 +614,12 @@ Config::setRootPasswordSecondary( const QString& s )
     if ( writeRootPassword() && s != m_rootPasswordSecondary )
     {
         m_rootPasswordSecondary = s;
-        const auto p = passwordStatus( m_rootPassword, m_rootPasswordSecondary );
-        emit rootPasswordStatusChanged( p.first, p.second );
+        // When the slow checks are still running, the status follows later
+        if ( m_rootPassword != m_rootPasswordSecondary || !m_rootPasswordChecker->isPending() )
+        {
+            const auto p = passwordStatus( m_rootPassword, m_rootPasswordSecondary, m_rootPasswordChecker );
+            emit rootPasswordStatusChanged( p.first, p.second );
+        }
         emit rootPasswordSecondaryChanged( s );
     }
 }
@@ -627,7 +657,7 @@ Config::rootPasswordStatus() const
 {
     if ( writeRootPassword() && !reuseUserPasswordForRoot() )
     {
-        return passwordStatus( m_rootPassword, m_rootPasswordSecondary );
+        return passwordStatus( m_rootPassword, m_rootPasswordSecondary, m_rootPasswordChecker );
     }
     else
     {
@@ -655,8 +685,11 @@ Config::isReady() const
     bool readyFullName = !fullName().isEmpty();  // Needs some text
     bool readyHostname = hostNameStatus().isEmpty();  // .. no warning message
     bool readyUsername = !loginName().isEmpty() && loginNameStatus().isEmpty();  // .. no warning message
-    bool readyUserPassword = userPasswordValidity() != Config::PasswordValidity::Invalid;
-    bool readyRootPassword = rootPasswordValidity() != Config::PasswordValidity::Invalid;
+    // Not ready while the slow checks run; they report back with a status change
+    const bool rootPending = writeRootPassword() && !reuseUserPasswordForRoot() && m_rootPasswordChecker->isPending();
+    bool readyUserPassword
+        = !m_userPasswordChecker->isPending() && userPasswordValidity() != Config::PasswordValidity::Invalid;
+    bool readyRootPassword = !rootPending && rootPasswordValidity() != Config::PasswordValidity::Invalid;
     return readyFullName && readyHostname && readyUsername && readyUserPassword && readyRootPassword;
 }
 
@@ -869,6 +902,9 @@ Config::setConfigurationMap( const QVariantMap& configurationMap )
         addPasswordCheck( i.key(), i.value(), m_passwordChecks );
     }
     std::sort( m_passwordChecks.begin(), m_passwordChecks.end() );
+    // Check any passwords that were set already against the new checks
+    m_userPasswordChecker->setPassword( m_userPassword );
+    m_rootPasswordChecker->setPassword( m_rootPassword );
 
     updateGSAutoLogin( doAutoLogin(), loginName() );
     checkReady();
@@ -300,7 +300,7 @@ signals:
     void readyChanged( bool ) const;
 
 private:
-    PasswordStatus passwordStatus( const QString&, const QString& ) const;
+    PasswordStatus passwordStatus( const QString&, const QString&, PasswordChecker* ) const;
     void checkReady();
 
     QList< GroupDescription > m_defaultGroups;
@@ -331,6 +331,8 @@ private:
 
     HostNameActions m_hostNameActions;
     PasswordCheckList m_passwordChecks;
+    PasswordChecker* m_userPasswordChecker = nullptr;
+    PasswordChecker* m_rootPasswordChecker = nullptr;
 };
 
 #endif
@@ -17,11 +17,16 @@
 
 #include <QDateTime>
 #include <QDir>
+#include <QDirIterator>
 #include <QFile>
 #include <QFileInfo>
 #include <QProcess>
 #include <QTextStream>
 
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+
 
 CreateUserJob::CreateUserJob( const Config* config )
     : Calamares::Job()
@@ -50,8 +55,13 @@ CreateUserJob::prettyStatusMessage() const
     return m_status.isEmpty() ? tr( "Creating user %1" ).arg( m_config->loginName() ) : m_status;
 }
 
+/** @brief Creates the user, with its home directory and groups, in one go
+ *
+ * The @p groups are passed to useradd directly, rather than
+ * added afterwards with a usermod call for each.
+ */
 static Calamares::JobResult
-createUser( const QString& loginName, const QString& fullName, const QString& shell )
+createUser( const QString& loginName, const QString& fullName, const QString& shell, const QStringList& groups )
 {
     QStringList useraddCommand;
 #ifdef __FreeBSD__
@@ -63,6 +73,10 @@ createUser( const QString& loginName, const QString& fullName, const QString& sh
     {
         useraddCommand << "-s" << shell;
     }
+    if ( !groups.isEmpty() )
+    {
+        useraddCommand << "-G" << groups.join( ',' );
+    }
 #else
     useraddCommand << "useradd"
                    << "-m"
@@ -71,6 +85,10 @@ createUser( const QString& loginName, const QString& fullName, const QString& sh
     {
         useraddCommand << "-s" << shell;
     }
+    if ( !groups.isEmpty() )
+    {
+        useraddCommand << "-G" << groups.join( ',' );
+    }
     useraddCommand << "-c" << fullName;
     useraddCommand << loginName;
 #endif
@@ -84,26 +102,64 @@ createUser( const QString& loginName, const QString& fullName, const QString& sh
     return Calamares::JobResult::ok();
 }
 
-static Calamares::JobResult
-setUserGroups( const QString& loginName, const QStringList& groups )
+/** @brief Looks up the uid and primary gid of @p loginName in @p passwdPath
+ *
+ * This reads the target system's passwd file, so that the
+ * host's idea of users does not matter. Returns @c false
+ * if the user is not there.
+ */
+static bool
+lookupUser( const QString& passwdPath, const QString& loginName, uid_t& uid, gid_t& gid )
 {
-    QStringList setgroupsCommand;
-#ifdef __FreeBSD__
-    setgroupsCommand << "pw"
-                     << "usermod"
-                     << "-n" << loginName << "-G" << groups.join( ',' );
-#else
-    setgroupsCommand << "usermod"
-                     << "-aG" << groups.join( ',' ) << loginName;
-#endif
+    QFile passwd( passwdPath );
+    if ( !passwd.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        return false;
+    }
 
-    auto commandResult = CalamaresUtils::System::instance()->targetEnvCommand( setgroupsCommand );
-    if ( commandResult.getExitCode() )
+    QTextStream in( &passwd );
+    while ( !in.atEnd() )
     {
-        cError() << "usermod failed" << commandResult.getExitCode();
-        return commandResult.explainProcess( setgroupsCommand, std::chrono::seconds( 10 ) /* bogus timeout */ );
+        // name:password:uid:gid:gecos:home:shell
+        const QStringList fields = in.readLine().split( ':' );
+        if ( fields.count() >= 4 && fields.at( 0 ) == loginName )
+        {
+            bool uidOk = false;
+            bool gidOk = false;
+            uid = fields.at( 2 ).toUInt( &uidOk );
+            gid = fields.at( 3 ).toUInt( &gidOk );
+            return uidOk && gidOk;
+        }
     }
-    return Calamares::JobResult::ok();
+    return false;
+}
+
+/** @brief Gives everything under @p path (and @p path itself) to @p uid : @p gid
+ *
+ * This does what `chown -R` would, without starting a process in the
+ * target system. Symbolic links are not followed; the links themselves
+ * change owner. Returns the number of files that could not be changed.
+ */
+static int
+changeOwnerRecursive( const QString& path, uid_t uid, gid_t gid )
+{
+    int failures = 0;
+    auto changeOwner = [&failures, uid, gid]( const QString& p ) {
+        if ( fchownat( AT_FDCWD, QFile::encodeName( p ).constData(), uid, gid, AT_SYMLINK_NOFOLLOW ) )
+        {
+            cWarning() << "Could not change owner of" << p;
+            ++failures;
+        }
+    };
+
+    changeOwner( path );
+    QDirIterator it(
+        path, QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot, QDirIterator::Subdirectories );
+    while ( it.hasNext() )
+    {
+        changeOwner( it.next() );
+    }
+    return failures;
 }
 
 
@@ -142,29 +198,33 @@ CreateUserJob::exec()
 
     m_status = tr( "Creating user %1" ).arg( m_config->loginName() );
     emit progress( 0.5 );
-    auto useraddResult = createUser( m_config->loginName(), m_config->fullName(), m_config->userShell() );
+    auto useraddResult = createUser(
+        m_config->loginName(), m_config->fullName(), m_config->userShell(), m_config->groupsForThisUser() );
     if ( !useraddResult )
     {
         return useraddResult;
     }
 
-    m_status = tr( "Configuring user %1" ).arg( m_config->loginName() );
-    emit progress( 0.8 );
-    auto usergroupsResult = setUserGroups( m_config->loginName(), m_config->groupsForThisUser() );
-    if ( !usergroupsResult )
-    {
-        return usergroupsResult;
-    }
-
     m_status = tr( "Setting file permissions" );
     emit progress( 0.9 );
-    QString userGroup = QString( "%1:%2" ).arg( m_config->loginName() ).arg( m_config->loginName() );
-    QString homeDir = QString( "/home/%1" ).arg( m_config->loginName() );
-    auto commandResult = CalamaresUtils::System::instance()->targetEnvCommand( { "chown", "-R", userGroup, homeDir } );
-    if ( commandResult.getExitCode() )
+    auto* system = CalamaresUtils::System::instance();
+    uid_t uid = 0;
+    gid_t gid = 0;
+    if ( !lookupUser( system->targetPath( QStringLiteral( "/etc/passwd" ) ), m_config->loginName(), uid, gid ) )
+    {
+        cError() << "User" << m_config->loginName() << "not found after useradd.";
+        return Calamares::JobResult::error( tr( "Cannot set home directory ownership for user %1." )
+                                                .arg( m_config->loginName() ),
+                                            tr( "The user is missing from /etc/passwd." ) );
+    }
+    const QString homeDir = system->targetPath( QString( "/home/%1" ).arg( m_config->loginName() ) );
+    const int failures = changeOwnerRecursive( homeDir, uid, gid );
+    if ( failures )
     {
-        cError() << "chown failed" << commandResult.getExitCode();
-        return commandResult.explainProcess( "chown", std::chrono::seconds( 10 ) /* bogus timeout */ );
+        cError() << "chown failed for" << failures << "files under" << homeDir;
+        return Calamares::JobResult::error(
+            tr( "Cannot set home directory ownership for user %1." ).arg( m_config->loginName() ),
+            tr( "The owner of %1 files could not be changed." ).arg( failures ) );
     }
 
     return Calamares::JobResult::ok();
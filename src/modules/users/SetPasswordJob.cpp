@@ -92,10 +92,19 @@ SetPasswordJob::exec()
 
     QString encrypted = QString::fromLatin1( crypt( m_newPassword.toUtf8(), make_salt( 16 ).toUtf8() ) );
 
-    int ec = CalamaresUtils::System::instance()->targetEnvCall( { "usermod", "-p", encrypted, m_userName } );
+    // The hash goes in through stdin, so it does not show up in the process list
+#ifdef __FreeBSD__
+    const QStringList command { "pw", "usermod", "-n", m_userName, "-H", "0" };
+    const QString input = encrypted + '\n';
+#else
+    const QStringList command { "chpasswd", "-e" };
+    const QString input = m_userName + ':' + encrypted + '\n';
+#endif
+    int ec = CalamaresUtils::System::instance()->targetEnvCall( command, QString(), input );
     if ( ec )
-        return Calamares::JobResult::error( tr( "Cannot set password for user %1." ).arg( m_userName ),
-                                            tr( "usermod terminated with error code %1." ).arg( ec ) );
+        return Calamares::JobResult::error(
+            tr( "Cannot set password for user %1." ).arg( m_userName ),
+            tr( "%1 terminated with error code %2." ).arg( command.first() ).arg( ec ) );
 
     return Calamares::JobResult::ok();
 }
@@ -43,6 +43,7 @@ private Q_SLOTS:
     void testHostActions_data();
     void testHostActions();
     void testPasswordChecks();
+    void testPasswordChecker();
     void testUserPassword();
 
     void testAutoLogin_data();
@@ -263,6 +264,51 @@ UserTests::testPasswordChecks()
     }
 }
 
+void
+UserTests::testPasswordChecker()
+{
+    PasswordCheckList l;
+    QVERIFY( addPasswordCheck( "nonempty", QVariant( true ), l ) );
+    int slowCalls = 0;
+    l.append( PasswordCheck( []() { return QStringLiteral( "no x" ); },
+                             [&slowCalls]( const QString& s ) {
+                                 ++slowCalls;
+                                 return !s.contains( 'x' );
+                             },
+                             PasswordCheck::slowWeight ) );
+    std::sort( l.begin(), l.end() );
+
+    PasswordChecker checker( l );
+    QSignalSpy spy( &checker, &PasswordChecker::checked );
+
+    // Cheap checks answer right away
+    checker.setPassword( QString() );
+    QVERIFY( !checker.isPending() );
+    QVERIFY( !checker.failure().isEmpty() );
+    QCOMPARE( slowCalls, 0 );
+
+    // Slow checks happen later, for the last password only
+    checker.setPassword( "a" );
+    QVERIFY( checker.isPending() );
+    checker.setPassword( "ax" );
+    checker.setPassword( "axe" );
+    QVERIFY( checker.isPending() );
+    QVERIFY( spy.wait( 2000 ) );
+    QCOMPARE( spy.count(), 1 );
+    QCOMPARE( slowCalls, 1 );
+    QVERIFY( !checker.isPending() );
+    QCOMPARE( checker.failure(), QStringLiteral( "no x" ) );
+
+    // Asking while pending checks right now
+    checker.setPassword( "abc" );
+    QVERIFY( checker.isPending() );
+    QVERIFY( checker.failure().isEmpty() );
+    QVERIFY( !checker.isPending() );
+    QCOMPARE( slowCalls, 2 );
+    QVERIFY( !spy.wait( 2 * int( PasswordChecker::delay().count() ) ) );
+    QCOMPARE( spy.count(), 1 );
+}
+
 void
 UserTests::testUserPassword()
 {
@@ -32,6 +32,7 @@ public:
     QString prettyName() const override;
 
     QWidget* widget() override;
+    bool hasLazyWidget() const override { return true; }
 
     bool isNextEnabled() const override;
     bool isBackEnabled() const override;
@@ -10,6 +10,9 @@
 
 #include "WebViewStep.h"
 
+#include "utils/Logger.h"
+
+#include <QTimer>
 #include <QVariant>
 
 #ifdef WEBVIEW_WITH_WEBKIT
@@ -91,7 +94,12 @@ WebViewStep::isAtEnd() const
 void
 WebViewStep::onActivate()
 {
-    m_view->load( QUrl( m_url ) );
+    // The first visit shows the page that was loaded in the background
+    if ( !m_preloaded )
+    {
+        m_view->load( QUrl( m_url ) );
+    }
+    m_preloaded = false;
     m_view->show();
 }
 
@@ -115,4 +123,15 @@ WebViewStep::setConfigurationMap( const QVariantMap& configurationMap )
     {
         m_prettyName = configurationMap.value( "prettyName" ).toString();
     }
+
+    if ( !m_url.isEmpty() )
+    {
+        // Start the web engine, and load the page, once the event loop runs
+        // so that the page is there (or nearly) by the time it is shown.
+        QTimer::singleShot( 0, m_view, [this]() {
+            cDebug() << "Preloading web view" << m_url;
+            m_view->load( QUrl( m_url ) );
+            m_preloaded = true;
+        } );
+    }
 }
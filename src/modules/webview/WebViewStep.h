@@ -63,6 +63,7 @@ private:
     C_QWEBVIEW* m_view;
     QString m_url;
     QString m_prettyName;
+    bool m_preloaded = false;  ///< Set if m_url was loaded in the background
 };
 
 CALAMARES_PLUGIN_FACTORY_DECLARATION( WebViewStepFactory )
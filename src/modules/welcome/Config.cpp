@@ -14,6 +14,7 @@
 #include "JobQueue.h"
 #include "Settings.h"
 #include "geoip/Handler.h"
+#include "geoip/Prefetch.h"
 #include "locale/Global.h"
 #include "locale/Lookup.h"
 #include "modulesystem/ModuleManager.h"
@@ -34,6 +35,15 @@ Config::Config( QObject* parent )
     CALAMARES_RETRANSLATE_SLOT( &Config::retranslate );
     // But also when the requirements model changes, update the messages
     connect( requirementsModel(), &Calamares::RequirementsModel::progressMessageChanged, this, &Config::retranslate );
+    // Watched requirements may change later, e.g. if the power cable is plugged in
+    connect( m_requirementsChecker.get(),
+             &GeneralRequirements::requirementChanged,
+             requirementsModel(),
+             &Calamares::RequirementsModel::updateRequirement );
+    connect( requirementsModel(),
+             &Calamares::RequirementsModel::satisfiedRequirementsChanged,
+             this,
+             &Config::retranslate );
 }
 
 void
@@ -355,16 +365,31 @@ setCountry( Config* config, const QString& countryCode, CalamaresUtils::GeoIP::H
 static inline void
 setGeoIP( Config* config, const QVariantMap& configurationMap )
 {
+    // The application-wide lookup, if there is one, replaces ours
+    using Prefetch = CalamaresUtils::GeoIP::Prefetch;
+    auto& prefetch = Prefetch::instance();
+    if ( prefetch.state() == Prefetch::State::Finished )
+    {
+        ::setCountry( config, prefetch.countryCode(), nullptr );
+        return;
+    }
+    if ( prefetch.state() == Prefetch::State::Running )
+    {
+        QObject::connect( &prefetch, &Prefetch::finished, config, [config, &prefetch]() {
+            cDebug() << "GeoIP prefetch result for welcome=" << prefetch.countryCode();
+            ::setCountry( config, prefetch.countryCode(), nullptr );
+        } );
+        return;
+    }
+
     bool ok = false;
     QVariantMap geoip = CalamaresUtils::getSubMap( configurationMap, "geoip", ok );
     if ( ok )
     {
         using FWString = QFutureWatcher< QString >;
 
-        auto* handler = new CalamaresUtils::GeoIP::Handler( CalamaresUtils::getString( geoip, "style" ),
-                                                            CalamaresUtils::getString( geoip, "url" ),
-                                                            CalamaresUtils::getString( geoip, "selector" ) );
-        if ( handler->type() != CalamaresUtils::GeoIP::Handler::Type::None )
+        auto* handler = new CalamaresUtils::GeoIP::Handler( geoip );
+        if ( handler->isValid() )
         {
             auto* future = new FWString();
             QObject::connect( future, &FWString::finished, [config, future, handler]() {
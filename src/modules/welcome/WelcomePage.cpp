@@ -23,6 +23,7 @@
 #include "modulesystem/ModuleManager.h"
 #include "modulesystem/RequirementsModel.h"
 #include "utils/CalamaresUtilsGui.h"
+#include "utils/ImageRegistry.h"
 #include "utils/Logger.h"
 #include "utils/NamedEnum.h"
 #include "utils/Retranslator.h"
@@ -58,8 +59,9 @@ WelcomePage::WelcomePage( Config* config, QWidget* parent )
     QString bannerPath = Branding::instance()->imagePath( Branding::ProductBanner );
     if ( !bannerPath.isEmpty() )
     {
-        // If the name is not empty, the file exists -- Branding checks that at startup
-        QPixmap bannerPixmap = QPixmap( bannerPath );
+        // If the name is not empty, the file exists -- Branding checks that at startup,
+        // and has started decoding it already.
+        QPixmap bannerPixmap = ImageRegistry::instance()->pixmap( bannerPath, QSize( 0, 0 ) );
         if ( !bannerPixmap.isNull() )
         {
             QLabel* bannerLabel = new QLabel;
@@ -29,6 +29,10 @@ WelcomeViewStep::WelcomeViewStep( QObject* parent )
              &Calamares::ModuleManager::requirementsComplete,
              this,
              &WelcomeViewStep::nextStatusChanged );
+    connect( m_conf->requirementsModel(),
+             &Calamares::RequirementsModel::satisfiedMandatoryChanged,
+             this,
+             [ this ]() { emit nextStatusChanged( isNextEnabled() ); } );
     connect( m_conf, &Config::localeIndexChanged, m_widget, &WelcomePage::externallySelectedLanguage );
 }
 
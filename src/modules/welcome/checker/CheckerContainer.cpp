@@ -26,7 +26,6 @@ CheckerContainer::CheckerContainer( Config* config, QWidget* parent )
     : QWidget( parent )
     , m_waitingWidget( new WaitingWidget( QString(), this ) )
     , m_checkerWidget( nullptr )
-    , m_verdict( false )
     , m_config( config )
 {
     QBoxLayout* mainLayout = new QHBoxLayout;
@@ -68,7 +67,27 @@ CheckerContainer::requirementsComplete( bool ok )
     m_checkerWidget->setObjectName( "requirementsChecker" );
     layout()->addWidget( m_checkerWidget );
 
-    m_verdict = ok;
+    connect( m_config->requirementsModel(),
+             &Calamares::RequirementsModel::dataChanged,
+             this,
+             &CheckerContainer::requirementsChanged,
+             Qt::UniqueConnection );
+}
+
+void
+CheckerContainer::requirementsChanged()
+{
+    if ( !m_checkerWidget )
+    {
+        return;
+    }
+
+    // The list only shows the unsatisfied requirements, so start over
+    layout()->removeWidget( m_checkerWidget );
+    m_checkerWidget->deleteLater();
+    m_checkerWidget = new ResultsListWidget( m_config, this );
+    m_checkerWidget->setObjectName( "requirementsChecker" );
+    layout()->addWidget( m_checkerWidget );
 }
 
 void
@@ -83,5 +102,5 @@ CheckerContainer::requirementsProgress( const QString& message )
 bool
 CheckerContainer::verdict() const
 {
-    return m_verdict;
+    return m_checkerWidget && m_config->requirementsModel()->satisfiedMandatory();
 }
@@ -35,6 +35,11 @@ public:
     explicit CheckerContainer( Config* config, QWidget* parent = nullptr );
     ~CheckerContainer() override;
 
+    /** @brief Can the user continue?
+     *
+     * This is @c false until all the requirements are complete, and then
+     * follows the model, since some requirements are watched live.
+     */
     bool verdict() const;
 
 public slots:
@@ -43,12 +48,13 @@ public slots:
 
     void requirementsProgress( const QString& message );
 
+    /** @brief A requirement changed after completion, rebuild the list view */
+    void requirementsChanged();
+
 protected:
     WaitingWidget* m_waitingWidget;
     ResultsListWidget* m_checkerWidget;
 
-    bool m_verdict;
-
 private:
     Config* m_config = nullptr;
 };
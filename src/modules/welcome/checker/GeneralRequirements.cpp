@@ -20,6 +20,8 @@
 #include "network/Manager.h"
 #include "utils/CalamaresUtilsGui.h"
 #include "utils/CalamaresUtilsSystem.h"
+#include "utils/Executor.h"
+#include "utils/HardwareInfo.h"
 #include "utils/Logger.h"
 #include "utils/Retranslator.h"
 #include "utils/Units.h"
@@ -34,9 +36,16 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QFutureWatcher>
 #include <QGuiApplication>
 #include <QScreen>
 
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+
 #include <unistd.h>  //geteuid
 
 GeneralRequirements::GeneralRequirements( QObject* parent )
@@ -93,6 +102,52 @@ operator<<( QDebug& s, const MaybeChecked& c )
     return s;
 }
 
+/** @brief Starts @p check in a thread of its own
+ *
+ * The thread is detached: if the check takes longer than its
+ * deadline (see finishCheck()), it is left to finish in the
+ * background and its result is ignored. So @p check may outlive
+ * the GeneralRequirements that started it, and must not use it;
+ * the result is shared with the future only.
+ */
+static std::future< bool >
+startCheck( std::function< bool() > check )
+{
+    auto result = std::make_shared< std::promise< bool > >();
+    auto future = result->get_future();
+    std::thread( [ result, check ]() { result->set_value( check() ); } ).detach();
+    return future;
+}
+
+/** @brief Waits for the result of a check started with startCheck()
+ *
+ * If @p timeout is positive, waits at most until @p start + @p timeout;
+ * a check that has not finished by then counts as failed (and is
+ * returned as not-checked).
+ */
+static MaybeChecked
+finishCheck( const char* name,
+             std::future< bool >& future,
+             std::chrono::steady_clock::time_point start,
+             std::chrono::seconds timeout )
+{
+    MaybeChecked c;
+    if ( timeout <= std::chrono::seconds::zero() )
+    {
+        c = future.get();
+    }
+    else if ( future.wait_until( start + timeout ) == std::future_status::ready )
+    {
+        c = future.get();
+    }
+    else
+    {
+        // Leave it unchecked, so that it is not cached
+        cWarning() << "GeneralRequirements check" << name << "did not finish within" << timeout.count() << "seconds.";
+    }
+    return c;
+}
+
 Calamares::RequirementsList
 GeneralRequirements::checkRequirements()
 {
@@ -106,10 +161,39 @@ GeneralRequirements::checkRequirements()
     bool enoughScreen = availableSize.isValid() && ( availableSize.width() >= CalamaresUtils::windowMinimumWidth )
         && ( availableSize.height() >= CalamaresUtils::windowMinimumHeight );
 
+    auto fromCache = [ this ]( const QString& name, MaybeChecked& c ) {
+        QMutexLocker lock( &m_probeLock );
+        auto it = m_probeCache.constFind( name );
+        if ( it != m_probeCache.constEnd() )
+        {
+            c = it.value();
+            return true;
+        }
+        return false;
+    };
+    auto toCache = [ this ]( const QString& name, const MaybeChecked& c ) {
+        if ( c.hasBeenChecked )
+        {
+            QMutexLocker lock( &m_probeLock );
+            m_probeCache.insert( name, c.value );
+        }
+    };
+
+    // The slow checks (storage probes the disks, power asks UPower over
+    // DBus) run concurrently with the rest, each with its own deadline.
+    // Their results are cached, and refreshed by watchForChanges().
+    const auto start = std::chrono::steady_clock::now();
     qint64 requiredStorageB = CalamaresUtils::GiBtoBytes( m_requiredStorageGiB );
-    if ( m_entriesToCheck.contains( "storage" ) )
+    std::future< bool > storageResult;
+    if ( m_entriesToCheck.contains( "storage" ) && !fromCache( "storage", enoughStorage ) )
+    {
+        storageResult = startCheck( [ requiredStorageB ]() { return checkEnoughStorage( requiredStorageB ); } );
+    }
+
+    std::future< bool > powerResult;
+    if ( m_entriesToCheck.contains( "power" ) && !fromCache( "power", hasPower ) )
     {
-        enoughStorage = checkEnoughStorage( requiredStorageB );
+        powerResult = startCheck( []() { return checkHasPower(); } );
     }
 
     qint64 requiredRamB = CalamaresUtils::GiBtoBytes( m_requiredRamGiB );
@@ -118,19 +202,27 @@ GeneralRequirements::checkRequirements()
         enoughRam = checkEnoughRam( requiredRamB );
     }
 
-    if ( m_entriesToCheck.contains( "power" ) )
+    // The internet check is bounded by the network timeout, not by a thread
+    if ( m_entriesToCheck.contains( "internet" ) && !fromCache( "internet", hasInternet ) )
     {
-        hasPower = checkHasPower();
+        hasInternet = probe( "internet" );
+        toCache( "internet", hasInternet );
     }
 
-    if ( m_entriesToCheck.contains( "internet" ) )
+    if ( m_entriesToCheck.contains( "root" ) )
     {
-        hasInternet = checkHasInternet();
+        isRoot = checkIsRoot();
     }
 
-    if ( m_entriesToCheck.contains( "root" ) )
+    if ( storageResult.valid() )
     {
-        isRoot = checkIsRoot();
+        enoughStorage = finishCheck( "storage", storageResult, start, m_checkTimeouts.value( "storage" ) );
+        toCache( "storage", enoughStorage );
+    }
+    if ( powerResult.valid() )
+    {
+        hasPower = finishCheck( "power", powerResult, start, m_checkTimeouts.value( "power" ) );
+        toCache( "power", hasPower );
     }
 
     using TNum = Logger::DebugRow< const char*, qint64 >;
@@ -356,16 +448,192 @@ GeneralRequirements::setConfigurationMap( const QVariantMap& configurationMap )
 
     incompleteConfiguration |= getCheckInternetUrls( configurationMap );
 
+    m_checkTimeouts.clear();
+    const auto timeouts = configurationMap.value( "checkTimeout" ).toMap();
+    for ( auto it = timeouts.cbegin(); it != timeouts.cend(); ++it )
+    {
+        bool ok = false;
+        const int seconds = it.value().toInt( &ok );
+        if ( !ok || seconds < 0 )
+        {
+            cWarning() << "GeneralRequirements entry 'checkTimeout' has invalid timeout for" << it.key();
+            incompleteConfiguration = true;
+        }
+        else if ( it.key() == "internet" )
+        {
+            // Each URL gets the timeout, rather than the check as a whole
+            CalamaresUtils::Network::Manager::instance().setCheckHasInternetTimeout( std::chrono::seconds( seconds ) );
+        }
+        else if ( it.key() == "storage" || it.key() == "power" )
+        {
+            m_checkTimeouts.insert( it.key(), std::chrono::seconds( seconds ) );
+        }
+        else
+        {
+            cWarning() << "GeneralRequirements entry 'checkTimeout' does not support a timeout for" << it.key();
+        }
+    }
+
     if ( incompleteConfiguration )
     {
         cWarning() << "GeneralRequirements configuration map:" << Logger::DebugMap( configurationMap );
     }
+
+    {
+        QMutexLocker lock( &m_probeLock );
+        m_probeCache.clear();
+    }
+    watchForChanges();
+}
+
+void
+GeneralRequirements::watchForChanges()
+{
+    if ( m_watching )
+    {
+        return;
+    }
+    m_watching = true;
+
+    m_reprobeTimer = new QTimer( this );
+    m_reprobeTimer->setSingleShot( true );
+    m_reprobeTimer->setInterval( 500 );  // msec, events tend to come in bursts
+    connect( m_reprobeTimer, &QTimer::timeout, this, &GeneralRequirements::runReprobes );
+
+    auto bus = QDBusConnection::systemBus();
+    if ( m_entriesToCheck.contains( "storage" ) )
+    {
+        bus.connect( QStringLiteral( "org.freedesktop.UDisks2" ),
+                     QStringLiteral( "/org/freedesktop/UDisks2" ),
+                     QStringLiteral( "org.freedesktop.DBus.ObjectManager" ),
+                     QStringLiteral( "InterfacesAdded" ),
+                     this,
+                     SLOT( storageChanged() ) );
+        bus.connect( QStringLiteral( "org.freedesktop.UDisks2" ),
+                     QStringLiteral( "/org/freedesktop/UDisks2" ),
+                     QStringLiteral( "org.freedesktop.DBus.ObjectManager" ),
+                     QStringLiteral( "InterfacesRemoved" ),
+                     this,
+                     SLOT( storageChanged() ) );
+    }
+    if ( m_entriesToCheck.contains( "power" ) )
+    {
+        bus.connect( QStringLiteral( "org.freedesktop.UPower" ),
+                     QStringLiteral( "/org/freedesktop/UPower" ),
+                     QStringLiteral( "org.freedesktop.DBus.Properties" ),
+                     QStringLiteral( "PropertiesChanged" ),
+                     this,
+                     SLOT( powerChanged() ) );
+    }
+    if ( m_entriesToCheck.contains( "internet" ) )
+    {
+        bus.connect( QStringLiteral( "org.freedesktop.NetworkManager" ),
+                     QStringLiteral( "/org/freedesktop/NetworkManager" ),
+                     QStringLiteral( "org.freedesktop.NetworkManager" ),
+                     QStringLiteral( "StateChanged" ),
+                     this,
+                     SLOT( networkChanged() ) );
+    }
+}
+
+void
+GeneralRequirements::storageChanged()
+{
+    reprobe( QStringLiteral( "storage" ) );
+}
+
+void
+GeneralRequirements::powerChanged()
+{
+    reprobe( QStringLiteral( "power" ) );
+}
+
+void
+GeneralRequirements::networkChanged()
+{
+    reprobe( QStringLiteral( "internet" ) );
+}
+
+void
+GeneralRequirements::reprobe( const QString& name )
+{
+    if ( !m_pendingProbes.contains( name ) )
+    {
+        m_pendingProbes.append( name );
+    }
+    m_reprobeTimer->start();
+}
+
+void
+GeneralRequirements::runReprobes()
+{
+    const QStringList names = m_pendingProbes;
+    m_pendingProbes.clear();
+
+    // Once installation has started, the disks are being changed on purpose
+    // and the result doesn't matter anymore; don't probe them while busy.
+    if ( Calamares::JobQueue::instance() && Calamares::JobQueue::instance()->isRunning() )
+    {
+        return;
+    }
+
+    for ( const auto& name : names )
+    {
+        auto* watcher = new QFutureWatcher< bool >( this );
+        connect( watcher, &QFutureWatcher< bool >::finished, this, [ this, watcher, name ]() {
+            const bool satisfied = watcher->result();
+            bool changed = false;
+            {
+                QMutexLocker lock( &m_probeLock );
+                changed = m_probeCache.value( name, !satisfied ) != satisfied;
+                m_probeCache.insert( name, satisfied );
+            }
+            if ( changed )
+            {
+                emit requirementChanged( name, satisfied );
+            }
+            watcher->deleteLater();
+        } );
+        watcher->setFuture( CalamaresUtils::Executor::run( CalamaresUtils::Executor::Lane::Interactive,
+                                                           "requirement-probe",
+                                                           [ this, name ]() { return probe( name ); } ) );
+    }
+}
+
+bool
+GeneralRequirements::probe( const QString& name )
+{
+    if ( name == "storage" )
+    {
+        return checkEnoughStorage( CalamaresUtils::GiBtoBytes( m_requiredStorageGiB ) );
+    }
+    if ( name == "power" )
+    {
+        return checkHasPower();
+    }
+    if ( name == "internet" )
+    {
+        return checkHasInternet();
+    }
+    cWarning() << "GeneralRequirements has no probe" << name;
+    return false;
 }
 
 
 bool
 GeneralRequirements::checkEnoughStorage( qint64 requiredSpace )
 {
+    // The same disks that the partition module will look at, from sysfs;
+    // libparted (which opens every device) only when there is no sysfs.
+    // The checks run again later, so read the disks as they are now, in
+    // case a disk has been plugged in since startup.
+    const auto disks = CalamaresUtils::HardwareInfo::readDisks();
+    if ( !disks.isEmpty() )
+    {
+        return std::any_of( disks.cbegin(), disks.cend(), [ requiredSpace ]( const auto& d ) {
+            return !d.readOnly && !d.mediaDrive && d.sizeB >= requiredSpace;
+        } );
+    }
 #ifdef WITHOUT_LIBPARTED
     Q_UNUSED( requiredSpace )
     cWarning() << "GeneralRequirements is configured without libparted.";
@@ -389,29 +657,7 @@ GeneralRequirements::checkEnoughRam( qint64 requiredRam )
 bool
 GeneralRequirements::checkBatteryExists()
 {
-    const QFileInfo basePath( "/sys/class/power_supply" );
-
-    if ( !( basePath.exists() && basePath.isDir() ) )
-    {
-        return false;
-    }
-
-    QDir baseDir( basePath.absoluteFilePath() );
-    const auto entries = baseDir.entryList( QDir::AllDirs | QDir::Readable | QDir::NoDotAndDotDot );
-    for ( const auto& item : entries )
-    {
-        QFileInfo typePath( baseDir.absoluteFilePath( QString( "%1/type" ).arg( item ) ) );
-        QFile typeFile( typePath.absoluteFilePath() );
-        if ( typeFile.open( QIODevice::ReadOnly | QIODevice::Text ) )
-        {
-            if ( typeFile.readAll().startsWith( "Battery" ) )
-            {
-                return true;
-            }
-        }
-    }
-
-    return false;
+    return CalamaresUtils::HardwareInfo::instance().hasBattery();
 }
 
 
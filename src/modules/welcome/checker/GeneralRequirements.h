@@ -11,11 +11,17 @@
 #ifndef GENERALREQUIREMENTS_H
 #define GENERALREQUIREMENTS_H
 
+#include <QHash>
+#include <QMap>
+#include <QMutex>
 #include <QObject>
 #include <QStringList>
+#include <QTimer>
 
 #include "modulesystem/Requirement.h"
 
+#include <chrono>
+
 class GeneralRequirements : public QObject
 {
     Q_OBJECT
@@ -26,19 +32,54 @@ public:
 
     Calamares::RequirementsList checkRequirements();
 
+signals:
+    /** @brief A watched requirement has changed after it was checked
+     *
+     * The storage, power and internet checks are cached; the cache is
+     * refreshed when the system reports a change (from UDisks2, UPower
+     * and NetworkManager, respectively) and then this signal is emitted
+     * with the name of the requirement and its new satisfied-state.
+     */
+    void requirementChanged( const QString& name, bool satisfied );
+
+private Q_SLOTS:
+    void storageChanged();
+    void powerChanged();
+    void networkChanged();
+    /// @brief Re-run the probes that have changed since the last time
+    void runReprobes();
+
 private:
+    /// @brief Subscribe to change-events for the cached checks
+    void watchForChanges();
+    /// @brief Schedule a re-run of probe @p name (debounced)
+    void reprobe( const QString& name );
+    /// @brief Run the (slow) probe @p name, which is a key of the cache
+    bool probe( const QString& name );
+
     QStringList m_entriesToCheck;
     QStringList m_entriesToRequire;
 
-    bool checkEnoughStorage( qint64 requiredSpace );
+    /// Cached results of the storage, power and internet checks
+    QHash< QString, bool > m_probeCache;
+    QMutex m_probeLock;
+    QStringList m_pendingProbes;
+    QTimer* m_reprobeTimer = nullptr;
+    bool m_watching = false;
+
+    // These may outlive this object (see startCheck()), so they are static
+    static bool checkEnoughStorage( qint64 requiredSpace );
+    static bool checkBatteryExists();
+    static bool checkHasPower();
+
     bool checkEnoughRam( qint64 requiredRam );
-    bool checkBatteryExists();
-    bool checkHasPower();
     bool checkHasInternet();
     bool checkIsRoot();
 
     qreal m_requiredStorageGiB;
     qreal m_requiredRamGiB;
+    /// Deadline for each (slow) check, by name; missing means "no deadline"
+    QMap< QString, std::chrono::seconds > m_checkTimeouts;
 };
 
 #endif  // REQUIREMENTSCHECKER_H
@@ -15,6 +15,7 @@
 #include "Branding.h"
 #include "Settings.h"
 #include "utils/CalamaresUtilsGui.h"
+#include "utils/ImageRegistry.h"
 #include "utils/Logger.h"
 #include "utils/Retranslator.h"
 #include "widgets/FixedAspectRatioLabel.h"
@@ -197,8 +198,8 @@ ResultsListWidget::ResultsListWidget( Config* config, QWidget* parent )
     {
         if ( !Calamares::Branding::instance()->imagePath( Calamares::Branding::ProductWelcome ).isEmpty() )
         {
-            QPixmap theImage
-                = QPixmap( Calamares::Branding::instance()->imagePath( Calamares::Branding::ProductWelcome ) );
+            QPixmap theImage = ImageRegistry::instance()->pixmap(
+                Calamares::Branding::instance()->imagePath( Calamares::Branding::ProductWelcome ), QSize( 0, 0 ) );
             if ( !theImage.isNull() )
             {
                 QLabel* imageLabel;
@@ -38,10 +38,10 @@ Page
         Image {
             id: welcomeImage
             anchors.centerIn: parent
-            // imagePath() returns a full pathname, so make it refer to the filesystem
-            // .. otherwise the path is interpreted relative to the "call site", which
-            // .. might be the QRC file.
-            source: "file:/" + Branding.imagePath(Branding.ProductWelcome)
+            // imageUrl() refers to the filesystem, or to the branding bundle;
+            // .. a plain path would be interpreted relative to the "call site",
+            // .. which might be the QRC file.
+            source: Branding.imageUrl(Branding.ProductWelcome)
             sourceSize.width: width
             sourceSize.height: height
             fillMode: Image.PreserveAspectFit